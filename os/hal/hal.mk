@@ -65,6 +65,9 @@ endif
 ifneq ($(findstring HAL_USE_USB TRUE,$(HALCONF)),)
 HALSRC += $(CHIBIOS)/os/hal/src/usb.c
 endif
+ifneq ($(findstring HAL_USE_USB_MSD TRUE,$(HALCONF)),)
+HALSRC += $(CHIBIOS)/os/hal/src/usb_msd.c
+endif
 ifneq ($(findstring HAL_USE_WDG TRUE,$(HALCONF)),)
 HALSRC += $(CHIBIOS)/os/hal/src/wdg.c
 endif
@@ -93,6 +96,7 @@ HALSRC = $(CHIBIOS)/os/hal/src/hal.c \
          $(CHIBIOS)/os/hal/src/st.c \
          $(CHIBIOS)/os/hal/src/uart.c \
          $(CHIBIOS)/os/hal/src/usb.c \
+         $(CHIBIOS)/os/hal/src/usb_msd.c \
          $(CHIBIOS)/os/hal/src/wdg.c
 endif
 
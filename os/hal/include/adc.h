@@ -54,6 +54,14 @@
 #if !defined(ADC_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define ADC_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the streaming APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(ADC_USE_STREAMING) || defined(__DOXYGEN__)
+#define ADC_USE_STREAMING           FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -76,8 +84,100 @@ typedef enum {
   ADC_ERROR = 5                             /**< Conversion complete.       */
 } adcstate_t;
 
+/**
+ * @brief   Type of an ADC stream.
+ */
+typedef struct ADCStream ADCStream;
+
 #include "adc_lld.h"
 
+#if (ADC_USE_STREAMING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a block of an ADC stream.
+ */
+typedef struct {
+  /**
+   * @brief   Pointer to the block samples.
+   * @note    The samples are organized as in the conversion buffer, a matrix
+   *          of channels number per block depth elements.
+   */
+  adcsample_t               *samples;
+  /**
+   * @brief   Block sequence number.
+   * @details The sequence number is incremented for each converted block,
+   *          including the dropped ones, a gap means that samples were lost
+   *          because an overrun.
+   */
+  uint32_t                  seq;
+  /**
+   * @brief   Block completion time stamp.
+   * @note    Realtime counter value if the port supports it, system time
+   *          otherwise.
+   */
+  rtcnt_t                   stamp;
+} ADCStreamBlock;
+
+/**
+ * @brief   Structure representing an ADC stream.
+ * @details A stream is a ring of blocks filled by a continuous circular
+ *          conversion. The conversion runs on a double buffer, each
+ *          completed half is moved into the next free block of the ring
+ *          and the consumer accesses the filled blocks in place.
+ */
+struct ADCStream {
+  /**
+   * @brief   Array of the ring blocks descriptors.
+   */
+  ADCStreamBlock            *blocks;
+  /**
+   * @brief   Number of blocks in the ring.
+   */
+  size_t                    nblocks;
+  /**
+   * @brief   Ring samples buffer.
+   * @note    The buffer must be able to contain @p nblocks blocks.
+   */
+  adcsample_t               *ring;
+  /**
+   * @brief   Conversion double buffer.
+   * @note    The buffer must be able to contain two blocks.
+   */
+  adcsample_t               *dmabuf;
+  /**
+   * @brief   Depth of a block (matrix rows number).
+   */
+  size_t                    depth;
+  /**
+   * @brief   Index of the next block to be filled.
+   */
+  size_t                    head;
+  /**
+   * @brief   Index of the oldest filled block.
+   */
+  size_t                    tail;
+  /**
+   * @brief   Number of filled blocks.
+   */
+  size_t                    count;
+  /**
+   * @brief   Sequence number of the next block.
+   */
+  uint32_t                  seq;
+  /**
+   * @brief   Number of blocks dropped because the ring was full.
+   */
+  uint32_t                  overruns;
+  /**
+   * @brief   Stream active flag.
+   */
+  bool                      active;
+  /**
+   * @brief   Thread waiting for a block.
+   */
+  thread_reference_t        thread;
+};
+#endif /* ADC_USE_STREAMING == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -140,9 +240,63 @@ typedef enum {
 #define _adc_timeout_isr(adcp)
 #endif /* !ADC_USE_WAIT */
 
+#if (ADC_USE_STREAMING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Moves a completed half buffer into the stream, if any.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] buf       pointer to the completed half buffer
+ *
+ * @notapi
+ */
+#define _adc_stream_isr(adcp, buf) {                                        \
+  if ((adcp)->stream != NULL) {                                             \
+    _adc_stream_push(adcp, buf);                                            \
+  }                                                                         \
+}
+
+/**
+ * @brief   Terminates the stream, if any.
+ * @details The thread waiting for a block, if any, is resumed with the
+ *          specified message.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] msg       message for the waiting thread
+ *
+ * @notapi
+ */
+#define _adc_stream_reset_i(adcp, msg) {                                    \
+  if ((adcp)->stream != NULL) {                                             \
+    (adcp)->stream->active = false;                                         \
+    osalThreadResumeI(&(adcp)->stream->thread, msg);                        \
+    (adcp)->stream = NULL;                                                  \
+  }                                                                         \
+}
+
+/**
+ * @brief   Terminates the stream, if any, from ISR context.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] msg       message for the waiting thread
+ *
+ * @notapi
+ */
+#define _adc_stream_reset_isr(adcp, msg) {                                  \
+  osalSysLockFromISR();                                                     \
+  _adc_stream_reset_i(adcp, msg);                                           \
+  osalSysUnlockFromISR();                                                   \
+}
+
+#else /* !ADC_USE_STREAMING */
+#define _adc_stream_isr(adcp, buf)
+#define _adc_stream_reset_i(adcp, msg)
+#define _adc_stream_reset_isr(adcp, msg)
+#endif /* !ADC_USE_STREAMING */
+
 /**
  * @brief   Common ISR code, half buffer event.
  * @details This code handles the portable part of the ISR code:
+ *          - Stream block handling, if any.
  *          - Callback invocation.
  *          .
  * @note    This macro is meant to be used in the low level drivers
@@ -153,6 +307,7 @@ typedef enum {
  * @notapi
  */
 #define _adc_isr_half_code(adcp) {                                          \
+  _adc_stream_isr(adcp, (adcp)->samples);                                   \
   if ((adcp)->grpp->end_cb != NULL) {                                       \
     (adcp)->grpp->end_cb(adcp, (adcp)->samples, (adcp)->depth / 2);         \
   }                                                                         \
@@ -161,6 +316,7 @@ typedef enum {
 /**
  * @brief   Common ISR code, full buffer event.
  * @details This code handles the portable part of the ISR code:
+ *          - Stream block handling, if any.
  *          - Callback invocation.
  *          - Waiting thread wakeup, if any.
  *          - Driver state transitions.
@@ -174,6 +330,9 @@ typedef enum {
  */
 #define _adc_isr_full_code(adcp) {                                          \
   if ((adcp)->grpp->circular) {                                             \
+    /* Streaming handling, the stream buffer is always two blocks deep.*/   \
+    _adc_stream_isr(adcp, (adcp)->samples +                                 \
+                    ((adcp)->depth / 2) * (adcp)->grpp->num_channels);      \
     /* Callback handling.*/                                                 \
     if ((adcp)->grpp->end_cb != NULL) {                                     \
       if ((adcp)->depth > 1) {                                              \
@@ -212,6 +371,7 @@ typedef enum {
  * @brief   Common ISR code, error event.
  * @details This code handles the portable part of the ISR code:
  *          - Callback invocation.
+ *          - Stream termination, if any.
  *          - Waiting thread timeout signaling, if any.
  *          - Driver state transitions.
  *          .
@@ -232,6 +392,7 @@ typedef enum {
       (adcp)->state = ADC_READY;                                            \
   }                                                                         \
   (adcp)->grpp = NULL;                                                      \
+  _adc_stream_reset_isr(adcp, MSG_TIMEOUT);                                 \
   _adc_timeout_isr(adcp);                                                   \
 }
 /** @} */
@@ -267,6 +428,22 @@ extern "C" {
   void adcAcquireBus(ADCDriver *adcp);
   void adcReleaseBus(ADCDriver *adcp);
 #endif
+#if ADC_USE_STREAMING == TRUE
+  void adcStreamObjectInit(ADCStream *strp, ADCStreamBlock *blocks,
+                           size_t nblocks, adcsample_t *ring,
+                           adcsample_t *dmabuf, size_t depth);
+  void adcStartStream(ADCDriver *adcp,
+                      const ADCConversionGroup *grpp,
+                      ADCStream *strp);
+  void adcStartStreamI(ADCDriver *adcp,
+                       const ADCConversionGroup *grpp,
+                       ADCStream *strp);
+  msg_t adcStreamGet(ADCStream *strp, ADCStreamBlock **bpp,
+                     systime_t timeout);
+  void adcStreamRelease(ADCStream *strp);
+  uint32_t adcStreamGetOverruns(ADCStream *strp);
+  void _adc_stream_push(ADCDriver *adcp, const adcsample_t *buf);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -79,6 +79,16 @@
 #if !defined(CAN_USE_SLEEP_MODE) || defined(__DOXYGEN__)
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
+
+/**
+ * @brief   Software receive FIFO APIs inclusion switch.
+ * @details If enabled, drivers associated to a software FIFO move the
+ *          received frames from the hardware mailboxes into the FIFO
+ *          directly from the receive ISR.
+ */
+#if !defined(CAN_USE_RX_FIFO) || defined(__DOXYGEN__)
+#define CAN_USE_RX_FIFO             FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -100,8 +110,63 @@ typedef enum {
   CAN_SLEEP = 4                             /**< Sleep state.               */
 } canstate_t;
 
+/**
+ * @brief   Type of a CAN software receive FIFO.
+ */
+typedef struct CANRxFifo CANRxFifo;
+
 #include "can_lld.h"
 
+#if (CAN_USE_RX_FIFO == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a time stamped received frame.
+ */
+typedef struct {
+  /**
+   * @brief   Received frame.
+   */
+  CANRxFrame                frame;
+  /**
+   * @brief   Reception time stamp.
+   * @details Time at which the frame has been moved out of the hardware
+   *          mailbox.
+   * @note    Realtime counter value if the port supports it, system time
+   *          otherwise.
+   */
+  rtcnt_t                   stamp;
+} CANRxTimedFrame;
+
+/**
+ * @brief   Structure representing a CAN software receive FIFO.
+ */
+struct CANRxFifo {
+  /**
+   * @brief   Frames buffer.
+   */
+  CANRxTimedFrame           *buffer;
+  /**
+   * @brief   Frames buffer size.
+   */
+  size_t                    size;
+  /**
+   * @brief   Index of the next frame to be written.
+   */
+  size_t                    head;
+  /**
+   * @brief   Index of the next frame to be read.
+   */
+  size_t                    tail;
+  /**
+   * @brief   Number of frames in the FIFO.
+   */
+  size_t                    count;
+  /**
+   * @brief   Number of frames dropped because the FIFO was full.
+   */
+  uint32_t                  overruns;
+};
+#endif /* CAN_USE_RX_FIFO == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -116,6 +181,37 @@ typedef enum {
 #define CAN_MAILBOX_TO_MASK(mbx) (1U << ((mbx) - 1U))
 /** @} */
 
+/**
+ * @name    Low level driver helper macros
+ * @{
+ */
+#if (CAN_USE_RX_FIFO == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Checks if the driver is associated to a software FIFO.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ *
+ * @notapi
+ */
+#define _can_rx_fifo_active(canp) ((canp)->rxfifo != NULL)
+
+/**
+ * @brief   Moves the frames of a mailbox into the software FIFO.
+ * @note    This macro is meant to be used in the low level drivers receive
+ *          ISRs when @p _can_rx_fifo_active() is @p true.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number
+ *
+ * @notapi
+ */
+#define _can_rx_fifo_isr(canp, mailbox) _can_rx_fifo_fill(canp, mailbox)
+#else
+#define _can_rx_fifo_active(canp) false
+#define _can_rx_fifo_isr(canp, mailbox)
+#endif
+/** @} */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -145,6 +241,17 @@ extern "C" {
   void canSleep(CANDriver *canp);
   void canWakeup(CANDriver *canp);
 #endif
+#if CAN_USE_RX_FIFO == TRUE
+  void canRxFifoObjectInit(CANRxFifo *fifop, CANRxTimedFrame *buffer,
+                           size_t size);
+  void canSetRxFifo(CANDriver *canp, CANRxFifo *fifop);
+  size_t canReceiveMany(CANDriver *canp,
+                        CANRxTimedFrame *crfp,
+                        size_t n,
+                        systime_t timeout);
+  uint32_t canRxFifoGetOverruns(CANRxFifo *fifop);
+  void _can_rx_fifo_fill(CANDriver *canp, canmbx_t mailbox);
+#endif
 #ifdef __cplusplus
 }
 #endif
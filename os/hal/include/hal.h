@@ -36,6 +36,7 @@
 #include "hal_channels.h"
 #include "hal_files.h"
 #include "hal_ioblock.h"
+#include "hal_flash.h"
 #include "hal_mmcsd.h"
 
 /* Shared headers.*/
@@ -74,6 +75,7 @@
 /* Complex drivers.*/
 #include "mmc_spi.h"
 #include "serial_usb.h"
+#include "usb_msd.h"
 
 /* Community drivers.*/
 #if defined(HAL_USE_COMMUNITY) || defined(__DOXYGEN__)
@@ -77,11 +77,16 @@ struct io_buffers_queue {
    * @brief   Pointer to the buffers boundary.
    */
   uint8_t               *btop;
+  /**
+   * @brief   Array of the used size fields of the buffers.
+   * @note    The array is placed after the buffers boundary, aligned to
+   *          @p size_t.
+   */
+  size_t                *bsizes;
   /**
    * @brief   Size of buffers.
-   * @note    The buffer size must be not lower than <tt>sizeof(size_t) + 2</tt>
-   *          because the first bytes are used to store the used size of the
-   *          buffer.
+   * @note    The buffers are contiguous in memory so that sequences of
+   *          buffers can be moved by a single transfer.
    */
   size_t                bsize;
   /**
@@ -127,12 +132,15 @@ typedef io_buffers_queue_t output_buffers_queue_t;
 
 /**
  * @brief   Computes the size of a buffers queue buffer size.
+ * @note    The area includes the used size field of each buffer and the
+ *          padding required to align the size fields array, the area
+ *          itself can have any alignment.
  *
  * @param[in] n         number of buffers in the queue
  * @param[in] size      size of the buffers
  */
 #define BQ_BUFFER_SIZE(n, size)                                             \
-  (((size_t)(size) + sizeof (size_t)) * (size_t)(n))
+  ((((size_t)(size) + sizeof (size_t)) * (size_t)(n)) + sizeof (size_t) - 1U)
 
 /**
  * @name    Macro Functions
@@ -148,6 +156,16 @@ typedef io_buffers_queue_t output_buffers_queue_t;
  */
 #define bqSizeX(bqp) ((bqp)->bn)
 
+/**
+ * @brief   Returns the size of the queue's buffers.
+ *
+ * @param[in] bqp       pointer to an @p io_buffers_queue_t structure
+ * @return              The size of a single buffer.
+ *
+ * @xclass
+ */
+#define bqBufferSizeX(bqp) ((bqp)->bsize)
+
 /**
  * @brief   Return the ready buffers number.
  * @details Returns the number of filled buffers if used on an input queue
@@ -237,7 +255,10 @@ extern "C" {
                      bqnotify_t infy, void *link);
   void ibqResetI(input_buffers_queue_t *ibqp);
   uint8_t *ibqGetEmptyBufferI(input_buffers_queue_t *ibqp);
+  uint8_t *ibqGetEmptyBuffersI(input_buffers_queue_t *ibqp,
+                               size_t max, size_t *np);
   void ibqPostFullBufferI(input_buffers_queue_t *ibqp, size_t size);
+  void ibqPostFullBuffersI(input_buffers_queue_t *ibqp, size_t size);
   msg_t ibqGetFullBufferTimeout(input_buffers_queue_t *ibqp,
                                 systime_t timeout);
   msg_t ibqGetFullBufferTimeoutS(input_buffers_queue_t *ibqp,
@@ -253,7 +274,10 @@ extern "C" {
   void obqResetI(output_buffers_queue_t *obqp);
   uint8_t *obqGetFullBufferI(output_buffers_queue_t *obqp,
                              size_t *sizep);
+  uint8_t *obqGetFullBuffersI(output_buffers_queue_t *obqp, size_t max,
+                              size_t *sizep, size_t *np);
   void obqReleaseEmptyBufferI(output_buffers_queue_t *obqp);
+  void obqReleaseEmptyBuffersI(output_buffers_queue_t *obqp, size_t n);
   msg_t obqGetEmptyBufferTimeout(output_buffers_queue_t *obqp,
                                  systime_t timeout);
   msg_t obqGetEmptyBufferTimeoutS(output_buffers_queue_t *obqp,
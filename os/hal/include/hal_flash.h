@@ -0,0 +1,198 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_flash.h
+ * @brief   Flash devices access.
+ * @details This header defines an abstract interface useful to access generic
+ *          NOR flash devices in a standardized way.
+ *
+ * @addtogroup HAL_FLASH
+ * @details This module defines an abstract interface for accessing generic
+ *          NOR flash devices, internal or external.<br>
+ *          A flash device is an array of equally sized sectors, erasing a
+ *          sector sets all its bits to one, programming can only clear
+ *          bits. Note that no code is present, just abstract
+ *          interfaces-like structures, you should look at the system as to
+ *          a set of abstract C++ classes (even if written in C).
+ * @{
+ */
+
+#ifndef _HAL_FLASH_H_
+#define _HAL_FLASH_H_
+
+/**
+ * @name    Flash attributes
+ * @{
+ */
+/**
+ * @brief   The flash is memory mapped at the address in the descriptor.
+ */
+#define FLASH_ATTR_MEMORY_MAPPED        0x00000001U
+/**
+ * @brief   Already programmed locations can be programmed again clearing
+ *          more bits.
+ * @note    Flash memories protected by ECC usually do not allow this.
+ */
+#define FLASH_ATTR_REWRITABLE           0x00000002U
+/** @} */
+
+/**
+ * @brief   Type of a flash offset.
+ */
+typedef uint32_t flash_offset_t;
+
+/**
+ * @brief   Type of a flash sector number.
+ */
+typedef uint32_t flash_sector_t;
+
+/**
+ * @brief   Flash device descriptor.
+ */
+typedef struct {
+  /**
+   * @brief   Device attributes.
+   */
+  uint32_t              attributes;
+  /**
+   * @brief   Programming unit size in bytes.
+   * @details Program operations must be aligned to this size and their
+   *          length must be a multiple of it.
+   */
+  uint32_t              page_size;
+  /**
+   * @brief   Number of sectors in the device.
+   */
+  flash_sector_t        sectors_count;
+  /**
+   * @brief   Size of the sectors in bytes.
+   */
+  uint32_t              sectors_size;
+  /**
+   * @brief   Flash address if memory mapped or @p NULL.
+   */
+  const uint8_t         *address;
+} flash_descriptor_t;
+
+/**
+ * @brief   @p BaseFlash specific methods.
+ */
+#define _base_flash_methods                                                 \
+  /* Returns the device descriptor.*/                                       \
+  const flash_descriptor_t *(*get_descriptor)(void *instance);              \
+  /* Reads data.*/                                                          \
+  bool (*read)(void *instance, flash_offset_t offset,                       \
+               uint8_t *rp, size_t n);                                      \
+  /* Programs data.*/                                                       \
+  bool (*program)(void *instance, flash_offset_t offset,                    \
+                  const uint8_t *pp, size_t n);                             \
+  /* Erases a sector.*/                                                     \
+  bool (*erase_sector)(void *instance, flash_sector_t sector);
+
+/**
+ * @brief   @p BaseFlash specific data.
+ * @note    It is empty because @p BaseFlash is only an interface without
+ *          implementation.
+ */
+#define _base_flash_data
+
+/**
+ * @brief   @p BaseFlash virtual methods table.
+ */
+struct BaseFlashVMT {
+  _base_flash_methods
+};
+
+/**
+ * @brief   Base flash class.
+ * @details This class represents a generic, sector-erasable, device.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BaseFlashVMT *vmt;
+  _base_flash_data
+} BaseFlash;
+
+/**
+ * @name    Macro Functions (BaseFlash)
+ * @{
+ */
+/**
+ * @brief   Returns the device descriptor.
+ *
+ * @param[in] ip        pointer to a @p BaseFlash or derived class
+ * @return              Pointer to a @p flash_descriptor_t structure.
+ *
+ * @api
+ */
+#define flashGetDescriptor(ip) ((ip)->vmt->get_descriptor(ip))
+
+/**
+ * @brief   Reads data.
+ *
+ * @param[in] ip        pointer to a @p BaseFlash or derived class
+ * @param[in] offset    flash offset
+ * @param[out] rp       pointer to the read buffer
+ * @param[in] n         number of bytes to be read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define flashRead(ip, offset, rp, n)                                        \
+  ((ip)->vmt->read(ip, offset, rp, n))
+
+/**
+ * @brief   Programs data.
+ * @pre     The area must have been erased, unless the device has the
+ *          @p FLASH_ATTR_REWRITABLE attribute.
+ *
+ * @param[in] ip        pointer to a @p BaseFlash or derived class
+ * @param[in] offset    flash offset, aligned to the page size
+ * @param[in] pp        pointer to the data to be programmed
+ * @param[in] n         number of bytes to be programmed, multiple of the
+ *                      page size
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define flashProgram(ip, offset, pp, n)                                     \
+  ((ip)->vmt->program(ip, offset, pp, n))
+
+/**
+ * @brief   Erases a sector.
+ *
+ * @param[in] ip        pointer to a @p BaseFlash or derived class
+ * @param[in] sector    sector to be erased
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+#define flashEraseSector(ip, sector) ((ip)->vmt->erase_sector(ip, sector))
+/** @} */
+
+#endif /* _HAL_FLASH_H_ */
+
+/** @} */
@@ -93,6 +93,7 @@
 #define MMCSD_CMD_LOCK_UNLOCK           42U
 #define MMCSD_CMD_APP_CMD               55U
 #define MMCSD_CMD_READ_OCR              58U
+#define MMCSD_CMD_CRC_ON_OFF            59U
 /** @} */
 
 /**
@@ -62,6 +62,22 @@
 #define I2C_USE_MUTUAL_EXCLUSION    TRUE
 #endif
 
+/**
+ * @brief   Enables the transactions queue APIs.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE               FALSE
+#endif
+
+/**
+ * @brief   Delay between the attempts to start a queued transaction.
+ * @details Queued transactions finding the bus busy are retried after this
+ *          number of system ticks until their timeout expires.
+ */
+#if !defined(I2C_QUEUE_RETRY_DELAY) || defined(__DOXYGEN__)
+#define I2C_QUEUE_RETRY_DELAY       1
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -82,12 +98,220 @@ typedef enum {
   I2C_LOCKED = 5                            /**> Bus or driver locked.      */
 } i2cstate_t;
 
+/**
+ * @brief   Type of a queued I2C transaction.
+ */
+typedef struct I2CTransaction I2CTransaction;
+
+/**
+ * @brief   I2C transactions queue statistics.
+ * @note    Durations are expressed in realtime counter cycles if the port
+ *          supports it, in system ticks otherwise.
+ */
+typedef struct {
+  /**
+   * @brief   System time of the last statistics reset.
+   */
+  systime_t                 start;
+  /**
+   * @brief   Number of completed transactions.
+   */
+  uint32_t                  completed;
+  /**
+   * @brief   Number of transactions terminated by errors or timeouts.
+   */
+  uint32_t                  failed;
+  /**
+   * @brief   Cumulative time spent executing transactions.
+   */
+  uint64_t                  busy;
+  /**
+   * @brief   Cumulative time spent by transactions in the queue.
+   */
+  uint64_t                  wait;
+  /**
+   * @brief   Longest time spent by a transaction in the queue.
+   */
+  rtcnt_t                   max_wait;
+} i2c_queue_stats_t;
+
+/**
+ * @brief   I2C transactions queue.
+ */
+typedef struct {
+  /**
+   * @brief   Pending transactions, ordered by priority.
+   */
+  I2CTransaction            *head;
+  /**
+   * @brief   Transaction in progress or @p NULL.
+   * @note    Only used by drivers supporting callbacks.
+   */
+  I2CTransaction            *current;
+  /**
+   * @brief   Thread serving the queue.
+   * @note    Only used by drivers not supporting callbacks.
+   */
+  thread_reference_t        server;
+  /**
+   * @brief   Start time of the transaction in progress.
+   */
+  rtcnt_t                   start;
+  /**
+   * @brief   Queue statistics.
+   */
+  i2c_queue_stats_t         stats;
+#if (defined(OSAL_SUPPORTS_TIMERS) && (OSAL_SUPPORTS_TIMERS == TRUE)) ||     \
+    defined(__DOXYGEN__)
+  /**
+   * @brief   Retries and timeouts timer.
+   * @note    Only used when the queue is served from ISR context.
+   */
+  virtual_timer_t           timer;
+  /**
+   * @brief   System time of the first start attempt of the transaction in
+   *          progress.
+   * @note    Only used when the queue is served from ISR context.
+   */
+  systime_t                 time;
+#endif
+} i2c_queue_t;
+
 #include "i2c_lld.h"
 
+/**
+ * @brief   Asynchronous operations support in the low level driver.
+ * @details Low level drivers supporting callbacks export this switch as
+ *          @p TRUE and implement @p i2c_lld_start_transmit(),
+ *          @p i2c_lld_start_receive() and @p i2c_lld_reset().
+ */
+#if !defined(I2C_SUPPORTS_CALLBACKS) || defined(__DOXYGEN__)
+#define I2C_SUPPORTS_CALLBACKS      FALSE
+#endif
+
+/**
+ * @brief   Transactions queue served from ISR context.
+ * @details Queued transactions are chained from the completion interrupts
+ *          if the low level driver supports callbacks and the OSAL provides
+ *          virtual timers, used for the bus busy retries and for the
+ *          transactions timeouts. Otherwise the queue is served by a thread
+ *          invoking @p i2cQueueServe().
+ */
+#if ((I2C_SUPPORTS_CALLBACKS == TRUE) && defined(OSAL_SUPPORTS_TIMERS) &&   \
+     (OSAL_SUPPORTS_TIMERS == TRUE)) || defined(__DOXYGEN__)
+#define I2C_QUEUE_USE_ISR           TRUE
+#else
+#define I2C_QUEUE_USE_ISR           FALSE
+#endif
+
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   I2C transaction notification callback type.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] trp       pointer to the completed @p I2CTransaction object
+ */
+typedef void (*i2ctrcallback_t)(I2CDriver *i2cp, I2CTransaction *trp);
+
+/**
+ * @brief   Structure representing a queued I2C transaction.
+ * @details A transaction is a write, a read or a write followed by a read
+ *          with repeated start.
+ * @note    The structure must not be modified while queued.
+ */
+struct I2CTransaction {
+  /**
+   * @brief   Next transaction in the queue.
+   */
+  I2CTransaction            *next;
+  /**
+   * @brief   Transaction priority, higher values are served first.
+   * @note    Transactions with the same priority are served in FIFO
+   *          order.
+   */
+  uint32_t                  prio;
+  /**
+   * @brief   Slave device address (7 bits) without R/W bit.
+   */
+  i2caddr_t                 addr;
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const uint8_t             *txbuf;
+  /**
+   * @brief   Number of bytes to be transmitted, zero for a read.
+   */
+  size_t                    txbytes;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief   Number of bytes to be received, zero for a write.
+   */
+  size_t                    rxbytes;
+  /**
+   * @brief   Transaction timeout.
+   * @details When the queue is served from ISR context the timeout starts
+   *          at the first start attempt and also covers the retries on a
+   *          busy bus. After a timeout the driver is reset in order to
+   *          recover it for the next transactions.
+   * @note    @a TIME_IMMEDIATE is not allowed.
+   */
+  systime_t                 timeout;
+  /**
+   * @brief   Completion callback or @p NULL.
+   * @note    The callback is invoked from ISR context when the queue is
+   *          served from ISR context.
+   */
+  i2ctrcallback_t           cb;
+  /**
+   * @brief   Transaction result.
+   */
+  msg_t                     result;
+  /**
+   * @brief   Errors mask of the transaction.
+   */
+  i2cflags_t                errors;
+  /**
+   * @brief   Waiting thread.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   Submission time.
+   * @note    Realtime counter value if the port supports it, system time
+   *          otherwise.
+   */
+  rtcnt_t                   stamp;
+};
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+#if (I2C_SUPPORTS_CALLBACKS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Terminates an asynchronous operation.
+ * @details If the operation has been started by @p i2cStartTransmitI() or
+ *          @p i2cStartReceiveI() then the driver goes back to the ready
+ *          state and the callback is invoked. The callback can start a new
+ *          operation.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+#define _i2c_isr_invoke_cb(i2cp) do {                                       \
+  if ((i2cp)->end_cb != NULL) {                                             \
+    i2ccallback_t cb = (i2cp)->end_cb;                                      \
+    (i2cp)->end_cb = NULL;                                                  \
+    (i2cp)->state = I2C_READY;                                              \
+    cb(i2cp);                                                               \
+  }                                                                         \
+} while(0)
+#endif
+
 /**
  * @brief   Wakes up the waiting thread notifying no errors.
  *
@@ -95,11 +319,20 @@ typedef enum {
  *
  * @notapi
  */
+#if (I2C_SUPPORTS_CALLBACKS == TRUE) || defined(__DOXYGEN__)
 #define _i2c_wakeup_isr(i2cp) do {                                          \
+  _i2c_isr_invoke_cb(i2cp);                                                 \
   osalSysLockFromISR();                                                     \
   osalThreadResumeI(&(i2cp)->thread, MSG_OK);                               \
   osalSysUnlockFromISR();                                                   \
 } while(0)
+#else
+#define _i2c_wakeup_isr(i2cp) do {                                          \
+  osalSysLockFromISR();                                                     \
+  osalThreadResumeI(&(i2cp)->thread, MSG_OK);                               \
+  osalSysUnlockFromISR();                                                   \
+} while(0)
+#endif
 
 /**
  * @brief   Wakes up the waiting thread notifying errors.
@@ -108,11 +341,20 @@ typedef enum {
  *
  * @notapi
  */
+#if (I2C_SUPPORTS_CALLBACKS == TRUE) || defined(__DOXYGEN__)
+#define _i2c_wakeup_error_isr(i2cp) do {                                    \
+  _i2c_isr_invoke_cb(i2cp);                                                 \
+  osalSysLockFromISR();                                                     \
+  osalThreadResumeI(&(i2cp)->thread, MSG_RESET);                            \
+  osalSysUnlockFromISR();                                                   \
+} while(0)
+#else
 #define _i2c_wakeup_error_isr(i2cp) do {                                    \
   osalSysLockFromISR();                                                     \
   osalThreadResumeI(&(i2cp)->thread, MSG_RESET);                            \
   osalSysUnlockFromISR();                                                   \
 } while(0)
+#endif
 
 /**
  * @brief   Wrap i2cMasterTransmitTimeout function with TIME_INFINITE timeout.
@@ -150,10 +392,39 @@ extern "C" {
                                 i2caddr_t addr,
                                 uint8_t *rxbuf, size_t rxbytes,
                                 systime_t timeout);
+#if I2C_SUPPORTS_CALLBACKS == TRUE
+  msg_t i2cStartTransmitI(I2CDriver *i2cp,
+                          i2caddr_t addr,
+                          const uint8_t *txbuf, size_t txbytes,
+                          uint8_t *rxbuf, size_t rxbytes,
+                          i2ccallback_t end_cb);
+  msg_t i2cStartTransmit(I2CDriver *i2cp,
+                         i2caddr_t addr,
+                         const uint8_t *txbuf, size_t txbytes,
+                         uint8_t *rxbuf, size_t rxbytes,
+                         i2ccallback_t end_cb);
+  msg_t i2cStartReceiveI(I2CDriver *i2cp,
+                         i2caddr_t addr,
+                         uint8_t *rxbuf, size_t rxbytes,
+                         i2ccallback_t end_cb);
+  msg_t i2cStartReceive(I2CDriver *i2cp,
+                        i2caddr_t addr,
+                        uint8_t *rxbuf, size_t rxbytes,
+                        i2ccallback_t end_cb);
+#endif
 #if I2C_USE_MUTUAL_EXCLUSION == TRUE
   void i2cAcquireBus(I2CDriver *i2cp);
   void i2cReleaseBus(I2CDriver *i2cp);
 #endif
+#if I2C_USE_QUEUE == TRUE
+  msg_t i2cQueueSubmitI(I2CDriver *i2cp, I2CTransaction *trp);
+  msg_t i2cQueueSubmit(I2CDriver *i2cp, I2CTransaction *trp);
+  msg_t i2cQueueTransfer(I2CDriver *i2cp, I2CTransaction *trp);
+#if I2C_QUEUE_USE_ISR == FALSE
+  msg_t i2cQueueServe(I2CDriver *i2cp, systime_t timeout);
+#endif
+  void i2cQueueGetStats(I2CDriver *i2cp, i2c_queue_stats_t *statsp);
+#endif
 
 #ifdef __cplusplus
 }
@@ -30,6 +30,18 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Checksum offload flags
+ * @note    Only meaningful on implementations defining
+ *          @p MAC_SUPPORTS_CHECKSUM_OFFLOAD as @p TRUE.
+ * @{
+ */
+#define MAC_CHECKSUM_GEN_IP         (1U << 0)   /**< IP header, transmit.   */
+#define MAC_CHECKSUM_GEN_PROTO      (1U << 1)   /**< TCP/UDP/ICMP, transmit.*/
+#define MAC_CHECKSUM_CHECK_IP       (1U << 2)   /**< IP header, receive.    */
+#define MAC_CHECKSUM_CHECK_PROTO    (1U << 3)   /**< TCP/UDP/ICMP, receive. */
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -51,6 +63,16 @@
 #if !defined(MAC_USE_EVENTS) || defined(__DOXYGEN__)
 #define MAC_USE_EVENTS              TRUE
 #endif
+
+/**
+ * @brief   Enables the receive interrupt mitigation.
+ * @details The receive interrupt is disabled when it fires and is enabled
+ *          again only when the consumer finds the receive ring empty, the
+ *          frames arriving in the meanwhile are collected by polling.
+ */
+#if !defined(MAC_USE_RX_MITIGATION) || defined(__DOXYGEN__)
+#define MAC_USE_RX_MITIGATION       FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -70,6 +92,28 @@ typedef enum {
   MAC_ACTIVE = 2                    /**< Active.                            */
 } macstate_t;
 
+/**
+ * @brief   Type of the receive interrupt mitigation statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Number of receive interrupts served.
+   */
+  uint32_t                  interrupts;
+  /**
+   * @brief   Number of frames received.
+   */
+  uint32_t                  frames;
+  /**
+   * @brief   Frames received since the last receive interrupt.
+   */
+  uint32_t                  burst;
+  /**
+   * @brief   Maximum number of frames received per interrupt.
+   */
+  uint32_t                  max_burst;
+} mac_rx_stats_t;
+
 /**
  * @brief   Type of a structure representing a MAC driver.
  */
@@ -77,6 +121,14 @@ typedef struct MACDriver MACDriver;
 
 #include "mac_lld.h"
 
+#if !defined(MAC_SUPPORTS_RX_MITIGATION) || defined(__DOXYGEN__)
+#define MAC_SUPPORTS_RX_MITIGATION  FALSE
+#endif
+
+#if !defined(MAC_SUPPORTS_CHECKSUM_OFFLOAD) || defined(__DOXYGEN__)
+#define MAC_SUPPORTS_CHECKSUM_OFFLOAD FALSE
+#endif
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -97,6 +149,20 @@ typedef struct MACDriver MACDriver;
 #define macGetReceiveEventSource(macp)  (&(macp)->rdevent)
 #endif
 
+#if (MAC_USE_RX_MITIGATION == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the receive interrupt mitigation statistics.
+ * @note    The average number of frames per interrupt is given by
+ *          @p frames divided by @p interrupts.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The pointer to the @p mac_rx_stats_t structure.
+ *
+ * @api
+ */
+#define macGetReceiveStatistics(macp)   (&(macp)->rxstats)
+#endif
+
 /**
  * @brief   Writes to a transmit descriptor's stream.
  *
@@ -170,6 +236,56 @@ typedef struct MACDriver MACDriver;
 #endif /* MAC_USE_ZERO_COPY */
 /** @} */
 
+/**
+ * @name    Low level driver helper macros
+ * @{
+ */
+/**
+ * @brief   Common ISR code for the receive interrupt.
+ * @details The threads waiting for frames are woken up and the event
+ *          source is broadcasted. When the mitigation is enabled the
+ *          interrupt is accounted in the statistics, the LLD must also
+ *          disable the receive interrupt source and must not invoke this
+ *          code for receive events latched while the source was disabled.
+ * @note    This macro is meant to be used in the low level drivers
+ *          implementation only.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+#if (MAC_USE_RX_MITIGATION == TRUE) || defined(__DOXYGEN__)
+#define _mac_isr_receive_code(macp) {                                       \
+  osalSysLockFromISR();                                                     \
+  (macp)->rxstats.interrupts++;                                             \
+  (macp)->rxstats.burst = 0U;                                               \
+  osalThreadDequeueAllI(&(macp)->rdqueue, MSG_RESET);                       \
+  _mac_isr_broadcast(macp);                                                 \
+  osalSysUnlockFromISR();                                                   \
+}
+#else
+#define _mac_isr_receive_code(macp) {                                       \
+  osalSysLockFromISR();                                                     \
+  osalThreadDequeueAllI(&(macp)->rdqueue, MSG_RESET);                       \
+  _mac_isr_broadcast(macp);                                                 \
+  osalSysUnlockFromISR();                                                   \
+}
+#endif
+
+/**
+ * @brief   Broadcasts the receive event source.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+#if (MAC_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+#define _mac_isr_broadcast(macp) osalEventBroadcastFlagsI(&(macp)->rdevent, 0)
+#else
+#define _mac_isr_broadcast(macp)
+#endif
+/** @} */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
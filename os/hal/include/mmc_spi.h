@@ -35,6 +35,8 @@
 #define MMC_CMD1_RETRY              100U
 #define MMC_ACMD41_RETRY            100U
 #define MMC_WAIT_DATA               10000U
+#define MMC_POLL_BYTES              8U
+#define MMC_CRC_RETRY               3U
 
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
@@ -55,6 +57,19 @@
 #if !defined(MMC_NICE_WAITING) || defined(__DOXYGEN__)
 #define MMC_NICE_WAITING            TRUE
 #endif
+
+/**
+ * @brief   Data CRC checking.
+ * @details If enabled the CRC checking is activated on the card, the
+ *          received data blocks are verified and the transmitted data
+ *          blocks carry a valid CRC. The CRC-16 is calculated using a
+ *          lookup table.
+ * @note    The data blocks failing the CRC check, on either side, are
+ *          transferred again up to @p MMC_CRC_RETRY times.
+ */
+#if !defined(MMC_USE_DATA_CRC) || defined(__DOXYGEN__)
+#define MMC_USE_DATA_CRC            FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -121,6 +136,10 @@ typedef struct {
    * @brief Addresses use blocks instead of bytes.
    */
   bool                  block_addresses;
+  /**
+   * @brief Next block of the sequential operation in progress.
+   */
+  uint32_t              nextblk;
 } MMCDriver;
 
 /*===========================================================================*/
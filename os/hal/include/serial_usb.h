@@ -55,10 +55,31 @@
 /**
  * @brief   Serial over USB number of buffers.
  * @note    The default is 2 buffers.
+ * @note    If set to zero then the driver objects do not embed buffers and
+ *          must be initialized using @p sduObjectInitBuffers().
  */
 #if !defined(SERIAL_USB_BUFFERS_NUMBER) || defined(__DOXYGEN__)
 #define SERIAL_USB_BUFFERS_NUMBER   2
 #endif
+
+/**
+ * @brief   Maximum number of buffers moved by a single bulk transaction.
+ * @details Contiguous buffers of the queues are chained into multi-packet
+ *          transactions up to this number, reducing the number of
+ *          transactions to be served.
+ * @note    Setting this value to one disables the chaining, this is the
+ *          default.
+ * @warning An OUT transaction is completed only by a short packet or when
+ *          the whole armed size has been received. CDC hosts do not send
+ *          zero length packets so a host write ending on a packet size
+ *          multiple stays in the endpoint until more data arrives, the
+ *          chaining multiplies the armed size and makes this much more
+ *          likely. Enable the chaining only if the host protocol always
+ *          terminates its transfers with a short packet.
+ */
+#if !defined(SERIAL_USB_MAX_CHAINED_BUFFERS) || defined(__DOXYGEN__)
+#define SERIAL_USB_MAX_CHAINED_BUFFERS  1
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -69,6 +90,10 @@
 #error "Serial over USB Driver requires HAL_USE_USB"
 #endif
 
+#if SERIAL_USB_MAX_CHAINED_BUFFERS < 1
+#error "invalid SERIAL_USB_MAX_CHAINED_BUFFERS value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -113,6 +138,21 @@ typedef struct {
   usbep_t                   int_in;
 } SerialUSBConfig;
 
+#if (SERIAL_USB_BUFFERS_NUMBER > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   @p SerialDriver embedded buffers.
+ */
+#define _serial_usb_driver_buffers                                          \
+  /* Input buffer.*/                                                        \
+  uint8_t                   ib[BQ_BUFFER_SIZE(SERIAL_USB_BUFFERS_NUMBER,    \
+                                              SERIAL_USB_BUFFERS_SIZE)];    \
+  /* Output buffer.*/                                                       \
+  uint8_t                   ob[BQ_BUFFER_SIZE(SERIAL_USB_BUFFERS_NUMBER,    \
+                                              SERIAL_USB_BUFFERS_SIZE)];
+#else
+#define _serial_usb_driver_buffers
+#endif
+
 /**
  * @brief   @p SerialDriver specific data.
  */
@@ -124,15 +164,12 @@ typedef struct {
   input_buffers_queue_t     ibqueue;                                        \
   /* Output queue.*/                                                        \
   output_buffers_queue_t    obqueue;                                        \
-  /* Input buffer.*/                                                        \
-  uint8_t                   ib[BQ_BUFFER_SIZE(SERIAL_USB_BUFFERS_NUMBER,    \
-                                              SERIAL_USB_BUFFERS_SIZE)];    \
-  /* Output buffer.*/                                                       \
-  uint8_t                   ob[BQ_BUFFER_SIZE(SERIAL_USB_BUFFERS_NUMBER,    \
-                                              SERIAL_USB_BUFFERS_SIZE)];    \
+  _serial_usb_driver_buffers                                                \
   /* End of the mandatory fields.*/                                         \
   /* Current configuration data.*/                                          \
-  const SerialUSBConfig     *config;
+  const SerialUSBConfig     *config;                                        \
+  /* Number of output buffers in the IN transaction in progress.*/          \
+  size_t                    txbuffers;
 
 /**
  * @brief   @p SerialUSBDriver specific methods.
@@ -175,6 +212,8 @@ extern "C" {
 #endif
   void sduInit(void);
   void sduObjectInit(SerialUSBDriver *sdup);
+  void sduObjectInitBuffers(SerialUSBDriver *sdup, uint8_t *ib, uint8_t *ob,
+                            size_t size, size_t n);
   void sduStart(SerialUSBDriver *sdup, const SerialUSBConfig *config);
   void sduStop(SerialUSBDriver *sdup);
   void sduDisconnectI(SerialUSBDriver *sdup);
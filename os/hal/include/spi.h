@@ -31,6 +31,20 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Transfer list segment flags
+ * @{
+ */
+/**
+ * @brief   The slave is selected before starting the segment.
+ */
+#define SPI_SEGMENT_SELECT          1U
+/**
+ * @brief   The slave is unselected after the segment end.
+ */
+#define SPI_SEGMENT_UNSELECT        2U
+/** @} */
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -54,12 +68,32 @@
 #if !defined(SPI_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the @p spiStartTransferList() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_TRANSFER_LIST) || defined(__DOXYGEN__)
+#define SPI_USE_TRANSFER_LIST       FALSE
+#endif
+
+/**
+ * @brief   Enables the transactions queue APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (SPI_USE_QUEUE == TRUE) && (SPI_USE_TRANSFER_LIST == FALSE)
+#error "SPI_USE_QUEUE requires SPI_USE_TRANSFER_LIST"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -75,8 +109,161 @@ typedef enum {
   SPI_COMPLETE = 4                  /**< Asynchronous operation complete.   */
 } spistate_t;
 
+/**
+ * @brief   Segment of a transfer list.
+ * @details The operation performed depends on the buffers specified:
+ *          - Both buffers, exchange.
+ *          - Only @p txbuf, send.
+ *          - Only @p rxbuf, receive.
+ *          - No buffers, ignore.
+ *          .
+ * @note    The buffers are organized as uint8_t arrays for data sizes below
+ *          or equal to 8 bits else it is organized as uint16_t arrays.
+ */
+typedef struct {
+  /**
+   * @brief   Transmit buffer or @p NULL.
+   */
+  const void                *txbuf;
+  /**
+   * @brief   Receive buffer or @p NULL.
+   */
+  void                      *rxbuf;
+  /**
+   * @brief   Number of words of the segment.
+   */
+  size_t                    n;
+  /**
+   * @brief   Slave select handling flags.
+   */
+  uint32_t                  flags;
+} SPISegment;
+
+/**
+ * @brief   Type of a queued SPI transaction.
+ */
+typedef struct SPITransaction SPITransaction;
+
+/**
+ * @brief   SPI transactions queue statistics.
+ * @note    Durations are expressed in realtime counter cycles if the port
+ *          supports it, in system ticks otherwise.
+ */
+typedef struct {
+  /**
+   * @brief   System time of the last statistics reset.
+   */
+  systime_t                 start;
+  /**
+   * @brief   Number of completed transactions.
+   */
+  uint32_t                  completed;
+  /**
+   * @brief   Cumulative time spent executing transactions.
+   */
+  uint64_t                  busy;
+  /**
+   * @brief   Cumulative time spent by transactions in the queue.
+   */
+  uint64_t                  wait;
+  /**
+   * @brief   Longest time spent by a transaction in the queue.
+   */
+  rtcnt_t                   max_wait;
+} spi_queue_stats_t;
+
+/**
+ * @brief   SPI transactions queue.
+ */
+typedef struct {
+  /**
+   * @brief   Pending transactions, ordered by priority.
+   */
+  SPITransaction            *head;
+  /**
+   * @brief   Transaction in progress or @p NULL.
+   */
+  SPITransaction            *current;
+  /**
+   * @brief   Start time of the transaction in progress.
+   */
+  rtcnt_t                   start;
+  /**
+   * @brief   Queue statistics.
+   */
+  spi_queue_stats_t         stats;
+} spi_queue_t;
+
 #include "spi_lld.h"
 
+/**
+ * @brief   Reconfiguration from ISR context support in the low level
+ *          driver.
+ * @details Low level drivers whose @p spi_lld_start() can switch an active
+ *          driver to another configuration from ISR context export this
+ *          switch as @p TRUE. Other drivers can only serve queued
+ *          transactions using the configuration passed to @p spiStart().
+ */
+#if !defined(SPI_SUPPORTS_ISR_RECONFIG) || defined(__DOXYGEN__)
+#define SPI_SUPPORTS_ISR_RECONFIG   FALSE
+#endif
+
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   SPI transaction notification callback type.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] trp       pointer to the completed @p SPITransaction object
+ */
+typedef void (*spitrcallback_t)(SPIDriver *spip, SPITransaction *trp);
+
+/**
+ * @brief   Structure representing a queued SPI transaction.
+ * @note    The structure must not be modified while queued.
+ */
+struct SPITransaction {
+  /**
+   * @brief   Next transaction in the queue.
+   */
+  SPITransaction            *next;
+  /**
+   * @brief   Transaction priority, higher values are served first.
+   * @note    Transactions with the same priority are served in FIFO
+   *          order.
+   */
+  uint32_t                  prio;
+  /**
+   * @brief   Configuration used for the transaction.
+   */
+  const SPIConfig           *config;
+  /**
+   * @brief   Transfer list to be executed.
+   */
+  const SPISegment          *list;
+  /**
+   * @brief   Number of segments in the transfer list.
+   */
+  size_t                    n;
+  /**
+   * @brief   Completion callback or @p NULL.
+   * @note    The callback is invoked from ISR context.
+   */
+  spitrcallback_t           cb;
+#if (SPI_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Waiting thread.
+   */
+  thread_reference_t        thread;
+#endif
+  /**
+   * @brief   Submission time.
+   * @note    Realtime counter value if the port supports it, system time
+   *          otherwise.
+   */
+  rtcnt_t                   stamp;
+};
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
@@ -225,6 +412,44 @@ typedef enum {
 #define _spi_wakeup_isr(spip)
 #endif /* !SPI_USE_WAIT */
 
+#if (SPI_USE_TRANSFER_LIST == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transfer list step.
+ * @details If a transfer list is in progress then the next segment is
+ *          started.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The transfer list state.
+ * @retval false        if there is no transfer list in progress or if the
+ *                      last segment has been completed.
+ * @retval true         if the next segment has been started.
+ *
+ * @notapi
+ */
+#define _spi_list_next_isr(spip)                                            \
+  (((spip)->segp != NULL) && _spi_list_next(spip))
+#else /* !SPI_USE_TRANSFER_LIST */
+#define _spi_list_next_isr(spip) false
+#endif /* !SPI_USE_TRANSFER_LIST */
+
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Transactions queue step.
+ * @details Completes the queued transaction in progress, if any, and starts
+ *          the next pending one.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+#define _spi_queue_next_isr(spip) {                                         \
+  if (((spip)->queue.current != NULL) || ((spip)->queue.head != NULL))      \
+    _spi_queue_next(spip);                                                  \
+}
+#else /* !SPI_USE_QUEUE */
+#define _spi_queue_next_isr(spip)
+#endif /* !SPI_USE_QUEUE */
+
 /**
  * @brief   Common ISR code.
  * @details This code handles the portable part of the ISR code:
@@ -240,15 +465,18 @@ typedef enum {
  * @notapi
  */
 #define _spi_isr_code(spip) {                                               \
-  if ((spip)->config->end_cb) {                                             \
-    (spip)->state = SPI_COMPLETE;                                           \
-    (spip)->config->end_cb(spip);                                           \
-    if ((spip)->state == SPI_COMPLETE)                                      \
+  if (!_spi_list_next_isr(spip)) {                                          \
+    if ((spip)->config->end_cb) {                                           \
+      (spip)->state = SPI_COMPLETE;                                         \
+      (spip)->config->end_cb(spip);                                         \
+      if ((spip)->state == SPI_COMPLETE)                                    \
+        (spip)->state = SPI_READY;                                          \
+    }                                                                       \
+    else                                                                    \
       (spip)->state = SPI_READY;                                            \
+    _spi_wakeup_isr(spip);                                                  \
+    _spi_queue_next_isr(spip);                                              \
   }                                                                         \
-  else                                                                      \
-    (spip)->state = SPI_READY;                                              \
-  _spi_wakeup_isr(spip);                                                    \
 }
 /** @} */
 
@@ -276,6 +504,25 @@ extern "C" {
   void spiSend(SPIDriver *spip, size_t n, const void *txbuf);
   void spiReceive(SPIDriver *spip, size_t n, void *rxbuf);
 #endif
+#if SPI_USE_TRANSFER_LIST == TRUE
+  void spiStartTransferListI(SPIDriver *spip,
+                             const SPISegment *list, size_t n);
+  void spiStartTransferList(SPIDriver *spip,
+                            const SPISegment *list, size_t n);
+#if SPI_USE_WAIT == TRUE
+  void spiTransferList(SPIDriver *spip, const SPISegment *list, size_t n);
+#endif
+  bool _spi_list_next(SPIDriver *spip);
+#endif
+#if SPI_USE_QUEUE == TRUE
+  void spiQueueSubmitI(SPIDriver *spip, SPITransaction *trp);
+  void spiQueueSubmit(SPIDriver *spip, SPITransaction *trp);
+#if SPI_USE_WAIT == TRUE
+  void spiQueueTransfer(SPIDriver *spip, SPITransaction *trp);
+#endif
+  void spiQueueGetStats(SPIDriver *spip, spi_queue_stats_t *statsp);
+  void _spi_queue_next(SPIDriver *spip);
+#endif
 #if SPI_USE_MUTUAL_EXCLUSION == TRUE
   void spiAcquireBus(SPIDriver *spip);
   void spiReleaseBus(SPIDriver *spip);
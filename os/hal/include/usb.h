@@ -217,6 +217,33 @@
   USB_DESC_BYTE(bmAttributes),                                              \
   USB_DESC_WORD(wMaxPacketSize),                                            \
   USB_DESC_BYTE(bInterval)
+
+/**
+ * @brief   Vendor specific bulk function descriptors size.
+ */
+#define USB_DESC_VENDOR_BULK_FUNCTION_SIZE                                  \
+  (USB_DESC_INTERFACE_SIZE + (2U * USB_DESC_ENDPOINT_SIZE))
+
+/**
+ * @brief   Vendor specific bulk function descriptors helper macro.
+ * @details Interface and endpoints descriptors of a vendor class interface
+ *          with a pair of bulk endpoints. The function can be served by a
+ *          Serial over USB driver without interrupt endpoint.
+ *
+ * @param[in] bInterfaceNumber  number of the interface
+ * @param[in] iInterface        interface string index
+ * @param[in] bulk_in           bulk IN endpoint number
+ * @param[in] bulk_out          bulk OUT endpoint number
+ * @param[in] wMaxPacketSize    bulk endpoints maximum packet size
+ */
+#define USB_DESC_VENDOR_BULK_FUNCTION(bInterfaceNumber, iInterface,         \
+                                      bulk_in, bulk_out, wMaxPacketSize)    \
+  USB_DESC_INTERFACE(bInterfaceNumber, 0x00, 0x02, 0xFF, 0x00, 0x00,        \
+                     iInterface),                                           \
+  USB_DESC_ENDPOINT((bulk_in) | 0x80U, USB_EP_MODE_TYPE_BULK,               \
+                    wMaxPacketSize, 0x00),                                  \
+  USB_DESC_ENDPOINT(bulk_out, USB_EP_MODE_TYPE_BULK,                        \
+                    wMaxPacketSize, 0x00)
 /** @} */
 
 /**
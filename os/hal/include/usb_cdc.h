@@ -86,6 +86,73 @@
 #define CDC_UNION                           0x06U
 /** @} */
 
+/**
+ * @name    Helper macros for composite device descriptors
+ * @{
+ */
+/**
+ * @brief   CDC-ACM function descriptors size.
+ */
+#define USB_DESC_CDC_ACM_FUNCTION_SIZE                                      \
+  (USB_DESC_INTERFACE_ASSOCIATION_SIZE + (2U * USB_DESC_INTERFACE_SIZE) +   \
+   19U + (3U * USB_DESC_ENDPOINT_SIZE))
+
+/**
+ * @brief   CDC-ACM function descriptors helper macro.
+ * @details Interface Association, communication interface with its
+ *          functional descriptors and data interface. The function takes
+ *          two interface numbers starting from @p bFirstInterface.
+ * @note    Devices exposing interface associations must declare the
+ *          Miscellaneous Device class (0xEF, 0x02, 0x01) in the device
+ *          descriptor.
+ *
+ * @param[in] bFirstInterface   number of the communication interface
+ * @param[in] iFunction         function string index
+ * @param[in] int_in            interrupt IN endpoint number
+ * @param[in] bulk_in           bulk IN endpoint number
+ * @param[in] bulk_out          bulk OUT endpoint number
+ * @param[in] wMaxPacketSize    bulk endpoints maximum packet size
+ */
+#define USB_DESC_CDC_ACM_FUNCTION(bFirstInterface, iFunction, int_in,       \
+                                  bulk_in, bulk_out, wMaxPacketSize)        \
+  USB_DESC_INTERFACE_ASSOCIATION(bFirstInterface, 0x02,                     \
+                                 CDC_COMMUNICATION_INTERFACE_CLASS,         \
+                                 CDC_ABSTRACT_CONTROL_MODEL, 0x01,          \
+                                 iFunction),                                \
+  USB_DESC_INTERFACE(bFirstInterface, 0x00, 0x01,                           \
+                     CDC_COMMUNICATION_INTERFACE_CLASS,                     \
+                     CDC_ABSTRACT_CONTROL_MODEL, 0x01, 0x00),               \
+  /* Header Functional Descriptor.*/                                        \
+  USB_DESC_BYTE(5),                                                         \
+  USB_DESC_BYTE(CDC_CS_INTERFACE),                                          \
+  USB_DESC_BYTE(CDC_HEADER),                                                \
+  USB_DESC_BCD(0x0110),                                                     \
+  /* Call Management Functional Descriptor.*/                               \
+  USB_DESC_BYTE(5),                                                         \
+  USB_DESC_BYTE(CDC_CS_INTERFACE),                                          \
+  USB_DESC_BYTE(CDC_CALL_MANAGEMENT),                                       \
+  USB_DESC_BYTE(0x00),                                                      \
+  USB_DESC_BYTE((bFirstInterface) + 1U),                                    \
+  /* ACM Functional Descriptor.*/                                           \
+  USB_DESC_BYTE(4),                                                         \
+  USB_DESC_BYTE(CDC_CS_INTERFACE),                                          \
+  USB_DESC_BYTE(CDC_ABSTRACT_CONTROL_MANAGEMENT),                           \
+  USB_DESC_BYTE(0x02),                                                      \
+  /* Union Functional Descriptor.*/                                         \
+  USB_DESC_BYTE(5),                                                         \
+  USB_DESC_BYTE(CDC_CS_INTERFACE),                                          \
+  USB_DESC_BYTE(CDC_UNION),                                                 \
+  USB_DESC_BYTE(bFirstInterface),                                           \
+  USB_DESC_BYTE((bFirstInterface) + 1U),                                    \
+  USB_DESC_ENDPOINT((int_in) | 0x80U, USB_EP_MODE_TYPE_INTR, 0x0008, 0xFF), \
+  USB_DESC_INTERFACE((bFirstInterface) + 1U, 0x00, 0x02,                    \
+                     CDC_DATA_INTERFACE_CLASS, 0x00, 0x00, 0x00),           \
+  USB_DESC_ENDPOINT((bulk_in) | 0x80U, USB_EP_MODE_TYPE_BULK,               \
+                    wMaxPacketSize, 0x00),                                  \
+  USB_DESC_ENDPOINT(bulk_out, USB_EP_MODE_TYPE_BULK,                        \
+                    wMaxPacketSize, 0x00)
+/** @} */
+
 /**
  * @name    Line Control bit definitions.
  * @{
@@ -0,0 +1,326 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    usb_msd.h
+ * @brief   USB Mass Storage Driver macros and structures.
+ *
+ * @addtogroup USB_MSD
+ * @{
+ */
+
+#ifndef _USB_MSD_H_
+#define _USB_MSD_H_
+
+/* The driver is disabled if the switch is not present in halconf.h.*/
+#if !defined(HAL_USE_USB_MSD)
+#define HAL_USE_USB_MSD                     FALSE
+#endif
+
+#if (HAL_USE_USB_MSD == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Mass Storage class codes
+ * @{
+ */
+#define MSD_INTERFACE_CLASS                 0x08U
+#define MSD_SUBCLASS_SCSI_TRANSPARENT       0x06U
+#define MSD_PROTOCOL_BULK_ONLY              0x50U
+/** @} */
+
+/**
+ * @name    Bulk-Only Transport class requests
+ * @{
+ */
+#define MSD_REQ_RESET                       0xFFU
+#define MSD_REQ_GET_MAX_LUN                 0xFEU
+/** @} */
+
+/**
+ * @name    Bulk-Only Transport wrappers
+ * @{
+ */
+#define MSD_CBW_SIGNATURE                   0x43425355U
+#define MSD_CBW_SIZE                        31U
+#define MSD_CSW_SIGNATURE                   0x53425355U
+#define MSD_CSW_SIZE                        13U
+
+#define MSD_CSW_STATUS_PASSED               0x00U
+#define MSD_CSW_STATUS_FAILED               0x01U
+#define MSD_CSW_STATUS_PHASE_ERROR          0x02U
+/** @} */
+
+/**
+ * @name    Supported SCSI commands
+ * @{
+ */
+#define SCSI_CMD_TEST_UNIT_READY            0x00U
+#define SCSI_CMD_REQUEST_SENSE              0x03U
+#define SCSI_CMD_INQUIRY                    0x12U
+#define SCSI_CMD_MODE_SENSE_6               0x1AU
+#define SCSI_CMD_START_STOP_UNIT            0x1BU
+#define SCSI_CMD_PREVENT_ALLOW_REMOVAL      0x1EU
+#define SCSI_CMD_READ_CAPACITY_10           0x25U
+#define SCSI_CMD_READ_10                    0x28U
+#define SCSI_CMD_WRITE_10                   0x2AU
+#define SCSI_CMD_VERIFY_10                  0x2FU
+#define SCSI_CMD_SYNCHRONIZE_CACHE_10       0x35U
+/** @} */
+
+/**
+ * @name    SCSI sense keys
+ * @{
+ */
+#define SCSI_SENSE_NO_SENSE                 0x00U
+#define SCSI_SENSE_NOT_READY                0x02U
+#define SCSI_SENSE_MEDIUM_ERROR             0x03U
+#define SCSI_SENSE_ILLEGAL_REQUEST          0x05U
+#define SCSI_SENSE_DATA_PROTECT             0x07U
+/** @} */
+
+/**
+ * @name    SCSI additional sense codes
+ * @{
+ */
+#define SCSI_ASC_NONE                       0x00U
+#define SCSI_ASC_WRITE_FAULT                0x03U
+#define SCSI_ASC_READ_ERROR                 0x11U
+#define SCSI_ASC_INVALID_COMMAND            0x20U
+#define SCSI_ASC_LBA_OUT_OF_RANGE           0x21U
+#define SCSI_ASC_INVALID_FIELD_IN_CDB       0x24U
+#define SCSI_ASC_LUN_NOT_SUPPORTED          0x25U
+#define SCSI_ASC_WRITE_PROTECTED            0x27U
+#define SCSI_ASC_MEDIUM_NOT_PRESENT         0x3AU
+/** @} */
+
+/**
+ * @name    Helper macros for composite device descriptors
+ * @{
+ */
+/**
+ * @brief   Mass Storage function descriptors size.
+ */
+#define USB_DESC_MSD_FUNCTION_SIZE                                          \
+  (USB_DESC_INTERFACE_SIZE + (2U * USB_DESC_ENDPOINT_SIZE))
+
+/**
+ * @brief   Mass Storage function descriptors helper macro.
+ * @details Interface and endpoints descriptors of a SCSI transparent,
+ *          Bulk-Only Transport, interface. The function takes a single
+ *          interface number.
+ *
+ * @param[in] bInterfaceNumber  number of the interface
+ * @param[in] iInterface        interface string index
+ * @param[in] bulk_in           bulk IN endpoint number
+ * @param[in] bulk_out          bulk OUT endpoint number
+ * @param[in] wMaxPacketSize    bulk endpoints maximum packet size
+ */
+#define USB_DESC_MSD_FUNCTION(bInterfaceNumber, iInterface, bulk_in,        \
+                              bulk_out, wMaxPacketSize)                     \
+  USB_DESC_INTERFACE(bInterfaceNumber, 0x00, 0x02, MSD_INTERFACE_CLASS,     \
+                     MSD_SUBCLASS_SCSI_TRANSPARENT, MSD_PROTOCOL_BULK_ONLY, \
+                     iInterface),                                           \
+  USB_DESC_ENDPOINT((bulk_in) | 0x80U, USB_EP_MODE_TYPE_BULK,               \
+                    wMaxPacketSize, 0x00),                                  \
+  USB_DESC_ENDPOINT(bulk_out, USB_EP_MODE_TYPE_BULK,                        \
+                    wMaxPacketSize, 0x00)
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    USB_MSD configuration options
+ * @{
+ */
+/**
+ * @brief   Mass Storage transfer buffers size.
+ * @details Two buffers of this size are embedded in each driver object,
+ *          the block device is accessed on one buffer while the other one
+ *          is transferred over USB.
+ * @note    The size must be a multiple of the block size of the block
+ *          devices served and of the bulk endpoints maximum packet size.
+ */
+#if !defined(USB_MSD_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define USB_MSD_BUFFERS_SIZE        2048
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if HAL_USE_USB == FALSE
+#error "USB Mass Storage Driver requires HAL_USE_USB"
+#endif
+
+#if (USB_MSD_BUFFERS_SIZE < 512) || ((USB_MSD_BUFFERS_SIZE % 512) != 0)
+#error "USB_MSD_BUFFERS_SIZE must be a multiple of 512"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief Driver state machine possible states.
+ */
+typedef enum {
+  MSD_UNINIT = 0,                   /**< Not initialized.                   */
+  MSD_STOP = 1,                     /**< Stopped.                           */
+  MSD_READY = 2,                    /**< Ready, waiting for a command.      */
+  MSD_ACTIVE = 3,                   /**< Serving a command.                 */
+  MSD_HALTED = 4                    /**< Waiting for a reset recovery.      */
+} msdstate_t;
+
+/**
+ * @brief   Mass Storage Driver configuration structure.
+ * @details An instance of this structure must be passed to @p msdStart()
+ *          in order to configure and start the driver operations.
+ */
+typedef struct {
+  /**
+   * @brief   USB driver to use.
+   */
+  USBDriver                 *usbp;
+  /**
+   * @brief   Bulk IN endpoint used for outgoing data transfer.
+   */
+  usbep_t                   bulk_in;
+  /**
+   * @brief   Bulk OUT endpoint used for incoming data transfer.
+   */
+  usbep_t                   bulk_out;
+  /**
+   * @brief   Interface number of the function.
+   * @details Class requests are only served if addressed to this
+   *          interface.
+   */
+  uint8_t                   ifnum;
+  /**
+   * @brief   Block device exported as logical unit zero.
+   */
+  BaseBlockDevice           *bbdp;
+  /**
+   * @brief   Vendor identification string, up to 8 characters.
+   */
+  const char                *vendor;
+  /**
+   * @brief   Product identification string, up to 16 characters.
+   */
+  const char                *product;
+  /**
+   * @brief   Product revision string, up to 4 characters.
+   */
+  const char                *revision;
+} USBMassStorageConfig;
+
+/**
+ * @brief   Structure representing an USB Mass Storage driver.
+ */
+typedef struct {
+  /**
+   * @brief   Driver state.
+   */
+  msdstate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const USBMassStorageConfig *config;
+  /**
+   * @brief   Waiting thread.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   Current media information.
+   */
+  BlockDeviceInfo           info;
+  /**
+   * @brief   Data phase bytes not yet transferred.
+   */
+  uint32_t                  residue;
+  /**
+   * @brief   Buffer of the OUT transaction in progress.
+   */
+  uint8_t                   *rxbuf;
+  /**
+   * @brief   Transfer buffers.
+   * @note    The buffers and the CSW follow the word-sized fields in order
+   *          to be word aligned, USB drivers moving data by DMA require it.
+   */
+  uint8_t                   buf[2][USB_MSD_BUFFERS_SIZE];
+  /**
+   * @brief   Command Status Wrapper of the command being served.
+   */
+  uint8_t                   csw[MSD_CSW_SIZE];
+  /**
+   * @brief   Command Block Wrapper of the command being served.
+   */
+  uint8_t                   cbw[MSD_CBW_SIZE];
+  /**
+   * @brief   Sense key of the last failed command.
+   */
+  uint8_t                   sense_key;
+  /**
+   * @brief   Additional sense code of the last failed command.
+   */
+  uint8_t                   sense_asc;
+  /**
+   * @brief   Highest logical unit number, returned by the Get Max LUN
+   *          request.
+   * @note    Only logical unit zero is supported. The value is kept in
+   *          the driver because it is sent by reference in the control
+   *          transfer.
+   */
+  uint8_t                   max_lun;
+} USBMassStorageDriver;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void msdInit(void);
+  void msdObjectInit(USBMassStorageDriver *msdp);
+  void msdStart(USBMassStorageDriver *msdp,
+                const USBMassStorageConfig *config);
+  void msdStop(USBMassStorageDriver *msdp);
+  void msdDisconnectI(USBMassStorageDriver *msdp);
+  void msdConfigureHookI(USBMassStorageDriver *msdp);
+  bool msdRequestsHook(USBMassStorageDriver *msdp);
+  msg_t msdServeCommand(USBMassStorageDriver *msdp);
+  void msdDataTransmitted(USBDriver *usbp, usbep_t ep);
+  void msdDataReceived(USBDriver *usbp, usbep_t ep);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_USB_MSD == TRUE */
+
+#endif /* _USB_MSD_H_ */
+
+/** @} */
@@ -0,0 +1,316 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkcache.c
+ * @brief   Block cache code.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "blkcache.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static blkcache_line_t *line_lookup(BlockCache *bcp, uint32_t blk) {
+  unsigned i;
+
+  for (i = 0U; i < bcp->nlines; i++) {
+    if (bcp->lines[i].blk == blk)
+      return &bcp->lines[i];
+  }
+  return NULL;
+}
+
+static blkcache_line_t *line_victim(BlockCache *bcp) {
+  blkcache_line_t *lp = &bcp->lines[0];
+  unsigned i;
+
+  /* Free lines are preferred, then the least recently used one.*/
+  for (i = 0U; i < bcp->nlines; i++) {
+    if (bcp->lines[i].blk == BLK_CACHE_INVALID)
+      return &bcp->lines[i];
+    if ((bcp->lines[i].stamp - lp->stamp) > 0x80000000U)
+      lp = &bcp->lines[i];
+  }
+  return lp;
+}
+
+static void lines_update(BlockCache *bcp, uint32_t startblk,
+                         const uint8_t *buf, uint32_t n, bool valid) {
+  unsigned i;
+
+  /* Cached copies of blocks written to the device are updated, they are
+     discarded if the write failed because the device content is no more
+     known.*/
+  for (i = 0U; i < bcp->nlines; i++) {
+    uint32_t blk = bcp->lines[i].blk;
+
+    if ((blk != BLK_CACHE_INVALID) && (blk >= startblk) &&
+        (blk < startblk + n)) {
+      if (valid)
+        memcpy(bcp->lines[i].data,
+               buf + ((blk - startblk) * BLK_CACHE_BLOCK_SIZE),
+               BLK_CACHE_BLOCK_SIZE);
+      else
+        bcp->lines[i].blk = BLK_CACHE_INVALID;
+    }
+  }
+}
+
+static uint8_t *wbuf_lookup(BlockCache *bcp, uint32_t blk) {
+
+  if ((bcp->wcount > 0U) && (blk >= bcp->wstart) &&
+      (blk < bcp->wstart + bcp->wcount))
+    return bcp->wbuf + ((blk - bcp->wstart) * BLK_CACHE_BLOCK_SIZE);
+  return NULL;
+}
+
+static bool cache_is_inserted(void *ip) {
+
+  return blkIsInserted(((BlockCache *)ip)->bdp);
+}
+
+static bool cache_is_protected(void *ip) {
+
+  return blkIsWriteProtected(((BlockCache *)ip)->bdp);
+}
+
+static bool cache_connect(void *ip) {
+  BlockCache *bcp = ip;
+
+  if (blkConnect(bcp->bdp))
+    return HAL_FAILED;
+  bcacheInvalidate(bcp);
+  bcp->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+static bool cache_disconnect(void *ip) {
+  BlockCache *bcp = ip;
+  bool err;
+
+  err = bcacheFlush(bcp);
+  bcacheInvalidate(bcp);
+  bcp->state = BLK_ACTIVE;
+  if (blkDisconnect(bcp->bdp))
+    return HAL_FAILED;
+  return err;
+}
+
+static bool cache_read(void *ip, uint32_t startblk,
+                       uint8_t *buf, uint32_t n) {
+  BlockCache *bcp = ip;
+  blkcache_line_t *lp;
+  const uint8_t *p;
+  uint32_t i;
+
+  if ((n == 1U) && (bcp->nlines > 0U)) {
+    /* Single block reads, usually FAT and directory sectors, are served
+       by the cache.*/
+    p = wbuf_lookup(bcp, startblk);
+    if (p == NULL) {
+      lp = line_lookup(bcp, startblk);
+      if (lp == NULL) {
+        lp = line_victim(bcp);
+        lp->blk = BLK_CACHE_INVALID;
+        if (blkRead(bcp->bdp, startblk, lp->data, 1U))
+          return HAL_FAILED;
+        lp->blk = startblk;
+        bcp->stats.misses++;
+      }
+      else
+        bcp->stats.hits++;
+      lp->stamp = bcp->clock++;
+      p = lp->data;
+    }
+    else
+      bcp->stats.hits++;
+    memcpy(buf, p, BLK_CACHE_BLOCK_SIZE);
+    return HAL_SUCCESS;
+  }
+
+  /* Multi-block reads go directly to the device, the cache lines always
+     match the device content so only the blocks still waiting in the
+     write-behind buffer need to be overlaid.*/
+  if (blkRead(bcp->bdp, startblk, buf, n))
+    return HAL_FAILED;
+  bcp->stats.misses += n;
+  for (i = 0U; i < n; i++) {
+    p = wbuf_lookup(bcp, startblk + i);
+    if (p != NULL)
+      memcpy(buf + (i * BLK_CACHE_BLOCK_SIZE), p, BLK_CACHE_BLOCK_SIZE);
+  }
+  return HAL_SUCCESS;
+}
+
+static bool cache_write(void *ip, uint32_t startblk,
+                        const uint8_t *buf, uint32_t n) {
+  BlockCache *bcp = ip;
+  bool err;
+
+  /* Blocks overwriting or extending the write-behind buffer content are
+     merged into it, the cache lines are updated when the buffer is
+     written to the device.*/
+  if ((bcp->wcount > 0U) && (startblk >= bcp->wstart) &&
+      (startblk <= bcp->wstart + bcp->wcount) &&
+      (startblk + n <= bcp->wstart + bcp->wsize)) {
+    memcpy(bcp->wbuf + ((startblk - bcp->wstart) * BLK_CACHE_BLOCK_SIZE),
+           buf, n * BLK_CACHE_BLOCK_SIZE);
+    if (startblk + n - bcp->wstart > bcp->wcount)
+      bcp->wcount = startblk + n - bcp->wstart;
+    return HAL_SUCCESS;
+  }
+
+  /* Not mergeable, the previous content is written first.*/
+  if (bcacheFlush(bcp))
+    return HAL_FAILED;
+
+  /* Writes not fitting the write-behind buffer go directly to the
+     device.*/
+  if (n >= bcp->wsize) {
+    err = blkWrite(bcp->bdp, startblk, buf, n);
+    lines_update(bcp, startblk, buf, n, !err);
+    if (err)
+      return HAL_FAILED;
+    bcp->stats.writes++;
+    bcp->stats.written += n;
+    return HAL_SUCCESS;
+  }
+
+  memcpy(bcp->wbuf, buf, n * BLK_CACHE_BLOCK_SIZE);
+  bcp->wstart = startblk;
+  bcp->wcount = n;
+  return HAL_SUCCESS;
+}
+
+static bool cache_sync(void *ip) {
+  BlockCache *bcp = ip;
+
+  if (bcacheFlush(bcp))
+    return HAL_FAILED;
+  return blkSync(bcp->bdp);
+}
+
+static bool cache_get_info(void *ip, BlockDeviceInfo *bdip) {
+
+  return blkGetInfo(((BlockCache *)ip)->bdp, bdip);
+}
+
+static const struct BlockCacheVMT vmt = {
+  cache_is_inserted, cache_is_protected, cache_connect, cache_disconnect,
+  cache_read, cache_write, cache_sync, cache_get_info
+};
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Block cache object initialization.
+ * @note    The cached device state is not changed, if it is already
+ *          connected the cache can be used immediately.
+ *
+ * @param[out] bcp      pointer to a @p BlockCache object to be initialized
+ * @param[in] bdp       pointer to the @p BaseBlockDevice to be cached
+ * @param[in] lines     pointer to an array of read cache lines
+ * @param[in] nlines    number of read cache lines, zero disables the read
+ *                      cache
+ * @param[in] wbuf      pointer to the write-behind buffer
+ * @param[in] wsize     size of the write-behind buffer in blocks, zero
+ *                      disables the write-behind
+ *
+ * @init
+ */
+void bcacheObjectInit(BlockCache *bcp, BaseBlockDevice *bdp,
+                      blkcache_line_t *lines, unsigned nlines,
+                      uint8_t *wbuf, uint32_t wsize) {
+
+  bcp->vmt    = &vmt;
+  bcp->state  = blkGetDriverState(bdp) == BLK_READY ? BLK_READY : BLK_ACTIVE;
+  bcp->bdp    = bdp;
+  bcp->lines  = lines;
+  bcp->nlines = nlines;
+  bcp->clock  = 0U;
+  bcp->wbuf   = wbuf;
+  bcp->wsize  = wsize;
+  bcacheInvalidate(bcp);
+  memset(&bcp->stats, 0, sizeof (blkcache_stats_t));
+}
+
+/**
+ * @brief   Writes the write-behind buffer content to the device.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed, the buffer content is retained
+ *                      and the cache lines of the involved blocks are
+ *                      discarded.
+ *
+ * @api
+ */
+bool bcacheFlush(BlockCache *bcp) {
+  bool err;
+
+  if (bcp->wcount > 0U) {
+    err = blkWrite(bcp->bdp, bcp->wstart, bcp->wbuf, bcp->wcount);
+    lines_update(bcp, bcp->wstart, bcp->wbuf, bcp->wcount, !err);
+    if (err)
+      return HAL_FAILED;
+    bcp->stats.writes++;
+    bcp->stats.written += bcp->wcount;
+    bcp->wcount = 0U;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Discards the whole cache content.
+ * @note    Blocks not yet written to the device are lost, it is meant to be
+ *          used after a media change.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ *
+ * @api
+ */
+void bcacheInvalidate(BlockCache *bcp) {
+  unsigned i;
+
+  for (i = 0U; i < bcp->nlines; i++)
+    bcp->lines[i].blk = BLK_CACHE_INVALID;
+  bcp->wcount = 0U;
+}
+
+/** @} */
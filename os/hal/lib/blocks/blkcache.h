@@ -0,0 +1,183 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkcache.h
+ * @brief   Block cache structures and macros.
+ *
+ * @addtogroup block_cache
+ * @{
+ */
+
+#ifndef _BLKCACHE_H_
+#define _BLKCACHE_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Block number marking an unused cache line.
+ */
+#define BLK_CACHE_INVALID           0xFFFFFFFFU
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Block cache configuration options
+ * @{
+ */
+/**
+ * @brief   Size of the cached blocks.
+ * @note    Must match the block size of the cached devices.
+ */
+#if !defined(BLK_CACHE_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define BLK_CACHE_BLOCK_SIZE        512U
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a read cache line.
+ */
+typedef struct {
+  /**
+   * @brief   Cached block number or @p BLK_CACHE_INVALID.
+   */
+  uint32_t              blk;
+  /**
+   * @brief   Time stamp of the last access, used for LRU replacement.
+   */
+  uint32_t              stamp;
+  /**
+   * @brief   Block data.
+   */
+  uint8_t               data[BLK_CACHE_BLOCK_SIZE];
+} blkcache_line_t;
+
+/**
+ * @brief   Type of the block cache statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Blocks served from the cache or the write buffer.
+   */
+  uint32_t              hits;
+  /**
+   * @brief   Blocks read from the device.
+   */
+  uint32_t              misses;
+  /**
+   * @brief   Write operations issued to the device.
+   */
+  uint32_t              writes;
+  /**
+   * @brief   Blocks written to the device.
+   */
+  uint32_t              written;
+} blkcache_stats_t;
+
+/**
+ * @brief   @p BlockCache specific data.
+ */
+#define _block_cache_data                                                   \
+  _base_block_device_data                                                   \
+  /* Cached block device.*/                                                 \
+  BaseBlockDevice       *bdp;                                               \
+  /* Read cache lines.*/                                                    \
+  blkcache_line_t       *lines;                                             \
+  /* Number of read cache lines.*/                                          \
+  unsigned              nlines;                                             \
+  /* LRU clock.*/                                                           \
+  uint32_t              clock;                                              \
+  /* Write-behind buffer.*/                                                 \
+  uint8_t               *wbuf;                                              \
+  /* Size of the write-behind buffer in blocks.*/                           \
+  uint32_t              wsize;                                              \
+  /* First block held in the write-behind buffer.*/                         \
+  uint32_t              wstart;                                             \
+  /* Number of blocks held in the write-behind buffer.*/                    \
+  uint32_t              wcount;                                             \
+  /* Statistics.*/                                                          \
+  blkcache_stats_t      stats;
+
+/**
+ * @brief   @p BlockCache virtual methods table.
+ */
+struct BlockCacheVMT {
+  _base_block_device_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Block cache object.
+ * @details A block device caching another block device. Single block reads
+ *          are served by a LRU cache, contiguous writes are collected into
+ *          a write-behind buffer and written as a single multi-block
+ *          operation when a non adjacent block is written, the buffer is
+ *          full or on @p blkSync().
+ * @note    The object is not thread safe, accesses must be serialized by
+ *          the user, FatFS does it when @p _FS_REENTRANT is enabled.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BlockCacheVMT *vmt;
+  _block_cache_data
+} BlockCache;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the cache statistics.
+ *
+ * @param[in] bcp       pointer to the @p BlockCache object
+ * @return              Pointer to a @p blkcache_stats_t structure.
+ *
+ * @api
+ */
+#define bcacheGetStatistics(bcp) (&(bcp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bcacheObjectInit(BlockCache *bcp, BaseBlockDevice *bdp,
+                        blkcache_line_t *lines, unsigned nlines,
+                        uint8_t *wbuf, uint32_t wsize);
+  bool bcacheFlush(BlockCache *bcp);
+  void bcacheInvalidate(BlockCache *bcp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BLKCACHE_H_ */
+
+/** @} */
@@ -0,0 +1,345 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkqueue.c
+ * @brief   Block requests queue code.
+ *
+ * @addtogroup block_queue
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "blkqueue.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pending request submitted before and overlapping the
+ *          specified one.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @param[in] rqp       pointer to the request
+ * @return              The overlapping request or @p NULL.
+ */
+static blk_request_t *bq_older_overlapping(BlockQueue *bqp,
+                                           blk_request_t *rqp) {
+  blk_request_t *p;
+
+  for (p = bqp->head; p != NULL; p = p->next) {
+    if ((p != rqp) && ((int32_t)(p->seq - rqp->seq) < 0) &&
+        (p->startblk < rqp->startblk + rqp->n) &&
+        (rqp->startblk < p->startblk + p->n))
+      return p;
+  }
+  return NULL;
+}
+
+/**
+ * @brief   Removes a request from the queue.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @param[in] rqp       pointer to the request
+ * @return              The request following the removed one.
+ */
+static blk_request_t *bq_remove(BlockQueue *bqp, blk_request_t *rqp) {
+  blk_request_t **pp = &bqp->head;
+
+  while (*pp != rqp)
+    pp = &(*pp)->next;
+  *pp = rqp->next;
+  rqp->next = NULL;
+  return *pp;
+}
+
+/**
+ * @brief   Submits a request.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @param[in] rqp       pointer to the request
+ */
+static void bq_submit(BlockQueue *bqp, blk_request_t *rqp) {
+  blk_request_t **pp;
+
+  osalSysLock();
+
+  rqp->seq  = bqp->seq++;
+  rqp->done = false;
+
+  /* A request resubmitted by its callback keeps its waiting thread.*/
+  if (rqp != bqp->completing)
+    rqp->thread = NULL;
+
+  /* Sorted insertion, after the requests starting at the same block.*/
+  pp = &bqp->head;
+  while ((*pp != NULL) && ((*pp)->startblk <= rqp->startblk))
+    pp = &(*pp)->next;
+  rqp->next = *pp;
+  *pp = rqp;
+
+  osalThreadDequeueNextI(&bqp->waiting, MSG_OK);
+  osalOsRescheduleS();
+
+  osalSysUnlock();
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Block queue object initialization.
+ *
+ * @param[out] bqp      pointer to a @p BlockQueue object to be initialized
+ * @param[in] bdp       pointer to the @p BaseBlockDevice to be served
+ * @param[in] buf       pointer to the merge buffer, it must satisfy the
+ *                      alignment requirements of the device driver
+ * @param[in] nblocks   merge buffer size in blocks, zero disables the
+ *                      requests merging
+ *
+ * @init
+ */
+void bqObjectInit(BlockQueue *bqp, BaseBlockDevice *bdp,
+                  uint8_t *buf, uint32_t nblocks) {
+
+  bqp->bdp        = bdp;
+  bqp->buf        = buf;
+  bqp->nblocks    = nblocks;
+  bqp->head       = NULL;
+  bqp->pos        = 0U;
+  bqp->seq        = 0U;
+  bqp->completing = NULL;
+  osalThreadQueueObjectInit(&bqp->waiting);
+  memset(&bqp->stats, 0, sizeof (blkqueue_stats_t));
+}
+
+/**
+ * @brief   Starts an asynchronous read.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @param[out] rqp      pointer to the request object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @api
+ */
+void bqStartRead(BlockQueue *bqp, blk_request_t *rqp, uint32_t startblk,
+                 uint8_t *buf, uint32_t n, blkcallback_t callback) {
+
+  osalDbgCheck((bqp != NULL) && (rqp != NULL) && (buf != NULL) && (n > 0U));
+
+  rqp->op       = BLK_REQ_READ;
+  rqp->startblk = startblk;
+  rqp->n        = n;
+  rqp->buf      = buf;
+  rqp->callback = callback;
+  bq_submit(bqp, rqp);
+}
+
+/**
+ * @brief   Starts an asynchronous write.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @param[out] rqp      pointer to the request object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer, it must not be modified
+ *                      until completion
+ * @param[in] n         number of blocks to write
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @api
+ */
+void bqStartWrite(BlockQueue *bqp, blk_request_t *rqp, uint32_t startblk,
+                  const uint8_t *buf, uint32_t n, blkcallback_t callback) {
+
+  osalDbgCheck((bqp != NULL) && (rqp != NULL) && (buf != NULL) && (n > 0U));
+
+  rqp->op       = BLK_REQ_WRITE;
+  rqp->startblk = startblk;
+  rqp->n        = n;
+  rqp->buf      = (uint8_t *)buf;
+  rqp->callback = callback;
+  bq_submit(bqp, rqp);
+}
+
+/**
+ * @brief   Waits for the completion of a request.
+ * @note    Only one thread can wait for a request.
+ * @note    If the request is resubmitted by its callback then the function
+ *          returns at the completion of the last operation.
+ *
+ * @param[in] rqp       pointer to the request object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool bqWaitRequest(blk_request_t *rqp) {
+
+  osalSysLock();
+  if (!rqp->done)
+    (void) osalThreadSuspendS(&rqp->thread);
+  osalSysUnlock();
+
+  return rqp->result;
+}
+
+/**
+ * @brief   Serves the queued requests.
+ * @details Waits for pending requests then executes the next one, merged
+ *          with the adjacent requests of the same kind, on the block
+ *          device. This function is meant to be called in a loop by a
+ *          dedicated thread.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if requests have been served.
+ * @retval MSG_TIMEOUT  if no request has been submitted before the timeout.
+ *
+ * @api
+ */
+msg_t bqServe(BlockQueue *bqp, systime_t timeout) {
+  blk_request_t *first, *last, *rqp, *older;
+  uint32_t n;
+  bool result;
+
+  osalSysLock();
+
+  while (bqp->head == NULL) {
+    msg_t msg = osalThreadEnqueueTimeoutS(&bqp->waiting, timeout);
+
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+
+  /* First pending request at or after the current position, wrapping
+     around to the lowest one.*/
+  first = bqp->head;
+  for (rqp = bqp->head; rqp != NULL; rqp = rqp->next) {
+    if (rqp->startblk >= bqp->pos) {
+      first = rqp;
+      break;
+    }
+  }
+
+  /* Overlapping requests are served in submission order.*/
+  while ((older = bq_older_overlapping(bqp, first)) != NULL)
+    first = older;
+  rqp = bq_remove(bqp, first);
+
+  /* Adjacent requests of the same kind are merged while they fit the merge
+     buffer.*/
+  last = first;
+  n    = first->n;
+  while ((rqp != NULL) && (rqp->op == first->op) &&
+         (rqp->startblk == first->startblk + n) &&
+         (n + rqp->n <= bqp->nblocks) &&
+         (bq_older_overlapping(bqp, rqp) == NULL)) {
+    blk_request_t *next = bq_remove(bqp, rqp);
+
+    last->next = rqp;
+    last = rqp;
+    n += rqp->n;
+    bqp->stats.merged++;
+    rqp = next;
+  }
+  bqp->pos = first->startblk + n;
+
+  osalSysUnlock();
+
+  /* Device operation.*/
+  if (first == last) {
+    if (first->op == BLK_REQ_READ)
+      result = blkRead(bqp->bdp, first->startblk, first->buf, n);
+    else
+      result = blkWrite(bqp->bdp, first->startblk, first->buf, n);
+  }
+  else {
+    uint8_t *p = bqp->buf;
+
+    if (first->op == BLK_REQ_READ) {
+      result = blkRead(bqp->bdp, first->startblk, bqp->buf, n);
+      for (rqp = first; rqp != NULL; rqp = rqp->next) {
+        memcpy(rqp->buf, p, rqp->n * BLK_QUEUE_BLOCK_SIZE);
+        p += rqp->n * BLK_QUEUE_BLOCK_SIZE;
+      }
+    }
+    else {
+      for (rqp = first; rqp != NULL; rqp = rqp->next) {
+        memcpy(p, rqp->buf, rqp->n * BLK_QUEUE_BLOCK_SIZE);
+        p += rqp->n * BLK_QUEUE_BLOCK_SIZE;
+      }
+      result = blkWrite(bqp->bdp, first->startblk, bqp->buf, n);
+    }
+  }
+  bqp->stats.operations++;
+
+  /* Completion of all the served requests, the callback is invoked first
+     and the request is done only if it has not been resubmitted by the
+     callback.*/
+  rqp = first;
+  while (rqp != NULL) {
+    blk_request_t *next = rqp->next;
+    uint32_t seq = rqp->seq;
+
+    bqp->stats.requests++;
+    rqp->result = result;
+    if (rqp->callback != NULL) {
+      osalSysLock();
+      bqp->completing = rqp;
+      osalSysUnlock();
+      rqp->callback(rqp);
+    }
+    osalSysLock();
+    bqp->completing = NULL;
+    if (rqp->seq == seq) {
+      rqp->done = true;
+      osalThreadResumeS(&rqp->thread, MSG_OK);
+    }
+    osalSysUnlock();
+    rqp = next;
+  }
+
+  return MSG_OK;
+}
+
+/** @} */
@@ -0,0 +1,252 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    blkqueue.h
+ * @brief   Block requests queue structures and macros.
+ *
+ * @addtogroup block_queue
+ * @{
+ */
+
+#ifndef _BLKQUEUE_H_
+#define _BLKQUEUE_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Request operations
+ * @{
+ */
+#define BLK_REQ_READ                0U
+#define BLK_REQ_WRITE               1U
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Block queue configuration options
+ * @{
+ */
+/**
+ * @brief   Size of the blocks.
+ * @note    Must match the block size of the served devices.
+ */
+#if !defined(BLK_QUEUE_BLOCK_SIZE) || defined(__DOXYGEN__)
+#define BLK_QUEUE_BLOCK_SIZE        512U
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a block request.
+ */
+typedef struct blk_request blk_request_t;
+
+/**
+ * @brief   Type of a request completion callback.
+ * @note    The callback is invoked from the serving thread before marking
+ *          the request as done and waking up the thread waiting for it,
+ *          the operation result is already available.
+ * @note    The request can be resubmitted from within the callback, in
+ *          this case it is not marked as done and the waiting thread keeps
+ *          waiting for the completion of the new operation. The request
+ *          object must not be released from within the callback.
+ *
+ * @param[in] rqp       pointer to the completed request
+ */
+typedef void (*blkcallback_t)(blk_request_t *rqp);
+
+/**
+ * @brief   Structure representing a block request.
+ * @note    The request object must be kept allocated until completion.
+ */
+struct blk_request {
+  /**
+   * @brief   Next request in the queue.
+   */
+  blk_request_t         *next;
+  /**
+   * @brief   Submission sequence number.
+   */
+  uint32_t              seq;
+  /**
+   * @brief   Request operation.
+   */
+  unsigned              op;
+  /**
+   * @brief   First block.
+   */
+  uint32_t              startblk;
+  /**
+   * @brief   Number of blocks.
+   */
+  uint32_t              n;
+  /**
+   * @brief   Data buffer.
+   */
+  uint8_t               *buf;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  blkcallback_t         callback;
+  /**
+   * @brief   Completion flag.
+   */
+  volatile bool         done;
+  /**
+   * @brief   Operation result, @p HAL_SUCCESS or @p HAL_FAILED.
+   */
+  bool                  result;
+  /**
+   * @brief   Thread waiting for the completion.
+   */
+  thread_reference_t    thread;
+  /**
+   * @brief   User data.
+   */
+  void                  *arg;
+};
+
+/**
+ * @brief   Type of the block queue statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Served requests.
+   */
+  uint32_t              requests;
+  /**
+   * @brief   Operations issued to the device.
+   */
+  uint32_t              operations;
+  /**
+   * @brief   Requests merged into a previous one.
+   */
+  uint32_t              merged;
+} blkqueue_stats_t;
+
+/**
+ * @brief   Structure representing a block requests queue.
+ * @details Requests are kept sorted by block number and served in ascending
+ *          order starting from the position of the last served request,
+ *          wrapping around at the end (C-LOOK). Adjacent requests of the
+ *          same kind are merged into a single multi-block operation using
+ *          the merge buffer. Overlapping requests are always served in
+ *          submission order.
+ * @note    Any @p BaseBlockDevice can be served, for example @p SDCDriver
+ *          and @p MMCDriver, the device operations are executed by the
+ *          thread calling @p bqServe() so the submitting threads can
+ *          overlap their work with the I/O.
+ */
+typedef struct {
+  /**
+   * @brief   Served block device.
+   */
+  BaseBlockDevice       *bdp;
+  /**
+   * @brief   Merge buffer.
+   */
+  uint8_t               *buf;
+  /**
+   * @brief   Merge buffer size in blocks.
+   */
+  uint32_t              nblocks;
+  /**
+   * @brief   Pending requests sorted by block number.
+   */
+  blk_request_t         *head;
+  /**
+   * @brief   Block following the last served request.
+   */
+  uint32_t              pos;
+  /**
+   * @brief   Next submission sequence number.
+   */
+  uint32_t              seq;
+  /**
+   * @brief   Request whose callback is in progress or @p NULL.
+   */
+  blk_request_t         *completing;
+  /**
+   * @brief   Serving threads queue.
+   */
+  threads_queue_t       waiting;
+  /**
+   * @brief   Statistics.
+   */
+  blkqueue_stats_t      stats;
+} BlockQueue;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the queue statistics.
+ *
+ * @param[in] bqp       pointer to the @p BlockQueue object
+ * @return              Pointer to a @p blkqueue_stats_t structure.
+ *
+ * @api
+ */
+#define bqGetStatistics(bqp) (&(bqp)->stats)
+
+/**
+ * @brief   Checks for the completion of a request.
+ *
+ * @param[in] rqp       pointer to the @p blk_request_t object
+ * @return              The request status.
+ * @retval false        if the request is still pending.
+ * @retval true         if the request is completed.
+ *
+ * @special
+ */
+#define bqIsRequestDone(rqp) ((rqp)->done)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void bqObjectInit(BlockQueue *bqp, BaseBlockDevice *bdp,
+                    uint8_t *buf, uint32_t nblocks);
+  void bqStartRead(BlockQueue *bqp, blk_request_t *rqp, uint32_t startblk,
+                   uint8_t *buf, uint32_t n, blkcallback_t callback);
+  void bqStartWrite(BlockQueue *bqp, blk_request_t *rqp, uint32_t startblk,
+                    const uint8_t *buf, uint32_t n, blkcallback_t callback);
+  bool bqWaitRequest(blk_request_t *rqp);
+  msg_t bqServe(BlockQueue *bqp, systime_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BLKQUEUE_H_ */
+
+/** @} */
@@ -0,0 +1,1003 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    flfs.c
+ * @brief   Flash log file system code.
+ *
+ * @addtogroup flash_log_fs
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "flfs.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Directory header magic number.
+ */
+#define DIR_MAGIC                   0x52494446U
+
+/**
+ * @brief   Data sector header magic number.
+ */
+#define SECTOR_MAGIC                0x53464C46U
+
+/**
+ * @brief   Frame commit word, the frame size is xored to it.
+ */
+#define FRAME_COMMIT                0x544D4D43U
+
+/**
+ * @brief   Identifier of no file.
+ */
+#define NO_FILE                     0U
+
+/**
+ * @brief   First data sector, the first two sectors hold the directory.
+ */
+#define FIRST_DATA                  2U
+
+/**
+ * @brief   Directory header.
+ */
+typedef struct {
+  uint32_t              magic;
+  uint32_t              seq;
+  uint32_t              nextid;
+  uint32_t              files;
+  uint32_t              crc;
+} flfs_dir_header_t;
+
+/**
+ * @brief   Directory entry.
+ */
+typedef struct {
+  uint32_t              id;
+  char                  name[FLFS_NAME_SIZE];
+} flfs_dir_entry_t;
+
+/**
+ * @brief   Data sector header.
+ */
+typedef struct {
+  uint32_t              magic;
+  uint32_t              id;
+  uint32_t              start;
+  uint32_t              seq;
+  uint32_t              crc;
+} flfs_sector_header_t;
+
+/**
+ * @brief   Frame header, followed by the data and by the commit word.
+ */
+typedef struct {
+  uint16_t              size;
+  uint16_t              nsize;
+} flfs_frame_header_t;
+
+/**
+ * @brief   Rounds a size to the flash programming alignment.
+ */
+#define ALIGN(fsp, n) (((n) + (fsp)->align - 1U) & ~((fsp)->align - 1U))
+
+/**
+ * @brief   Size of the directory header area.
+ */
+#define DIR_DATA(fsp) ALIGN(fsp, sizeof (flfs_dir_header_t))
+
+/**
+ * @brief   Size of the data sector header area.
+ */
+#define SECTOR_DATA(fsp) ALIGN(fsp, sizeof (flfs_sector_header_t))
+
+/**
+ * @brief   Maximum data in a frame.
+ */
+#define FRAME_DATA(fsp)                                                     \
+  (FLFS_BUFFER_SIZE - (fsp)->align - sizeof (flfs_frame_header_t))
+
+/**
+ * @brief   Flash offset of a sector position.
+ */
+#define FLASH_OFFSET(fsp, sector, pos)                                      \
+  ((((fsp)->config->first_sector + (sector)) * (fsp)->sector_size) + (pos))
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Lookup table for CRC-32, four bits at time.
+ */
+static const uint32_t crc32_lookup_table[16] = {
+  0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+  0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+  0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+  0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t crc32(uint32_t crc, const void *p, size_t n) {
+  const uint8_t *bp = p;
+
+  while (n > 0U) {
+    crc ^= *bp++;
+    crc = (crc >> 4) ^ crc32_lookup_table[crc & 15U];
+    crc = (crc >> 4) ^ crc32_lookup_table[crc & 15U];
+    n--;
+  }
+  return crc;
+}
+
+static bool is_erased(const void *p, size_t n) {
+  const uint8_t *bp = p;
+
+  while (n > 0U) {
+    if (*bp++ != 0xFFU)
+      return false;
+    n--;
+  }
+  return true;
+}
+
+static bool flfs_read(FLFS *fsp, unsigned sector, uint32_t pos,
+                      void *p, size_t n) {
+
+  return flashRead(fsp->config->flp, FLASH_OFFSET(fsp, sector, pos), p, n);
+}
+
+static bool flfs_program(FLFS *fsp, unsigned sector, uint32_t pos,
+                         const void *p, size_t n) {
+
+  return flashProgram(fsp->config->flp, FLASH_OFFSET(fsp, sector, pos),
+                      p, n);
+}
+
+static bool flfs_erase(FLFS *fsp, unsigned sector) {
+
+  return flashEraseSector(fsp->config->flp,
+                          fsp->config->first_sector + sector);
+}
+
+static bool valid_name(const char *name) {
+  size_t n = strlen(name);
+
+  return (n > 0U) && (n < FLFS_NAME_SIZE);
+}
+
+/**
+ * @brief   Programs data sequentially in a sector.
+ * @details The data is collected in the transfer buffer and programmed in
+ *          buffer sized chunks, the last chunk is padded to the programming
+ *          alignment when @p n is zero.
+ */
+static bool flfs_append(FLFS *fsp, unsigned sector, uint32_t *posp,
+                        size_t *fillp, const void *p, size_t n) {
+  const uint8_t *bp = p;
+  size_t fill = *fillp;
+
+  do {
+    size_t chunk;
+
+    if (n == 0U) {
+      /* Flushing the remaining data.*/
+      if (fill == 0U)
+        break;
+      chunk = ALIGN(fsp, fill);
+      memset(&fsp->u.buf[fill], 0xFF, chunk - fill);
+      fill = chunk;
+    }
+    else {
+      chunk = FLFS_BUFFER_SIZE - fill;
+      if (chunk > n)
+        chunk = n;
+      memcpy(&fsp->u.buf[fill], bp, chunk);
+      fill += chunk;
+      bp   += chunk;
+      n    -= chunk;
+      if (fill < FLFS_BUFFER_SIZE)
+        break;
+    }
+
+    if (flfs_program(fsp, sector, *posp, fsp->u.buf, fill))
+      return HAL_FAILED;
+    *posp += fill;
+    fill = 0U;
+  } while (n > 0U);
+
+  *fillp = fill;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks the directory copy in a sector.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] sector    directory sector
+ * @param[out] dhp      directory header
+ * @return              The directory state.
+ * @retval false        if the directory is not valid.
+ * @retval true         if the directory is valid.
+ */
+static bool dir_check(FLFS *fsp, unsigned sector, flfs_dir_header_t *dhp) {
+  uint32_t crc = 0xFFFFFFFFU, pos = DIR_DATA(fsp);
+  size_t n;
+
+  if (flfs_read(fsp, sector, 0U, dhp, sizeof (flfs_dir_header_t)) ||
+      (dhp->magic != DIR_MAGIC) ||
+      (dhp->files > (fsp->sector_size - pos) / sizeof (flfs_dir_entry_t)))
+    return false;
+
+  for (n = dhp->files * sizeof (flfs_dir_entry_t); n > 0U; ) {
+    size_t chunk = n < FLFS_BUFFER_SIZE ? n : FLFS_BUFFER_SIZE;
+
+    if (flfs_read(fsp, sector, pos, fsp->u.buf, chunk))
+      return false;
+    crc = crc32(crc, fsp->u.buf, chunk);
+    pos += chunk;
+    n   -= chunk;
+  }
+  crc = crc32(crc, &dhp->seq, 3U * sizeof (uint32_t));
+  return ~crc == dhp->crc;
+}
+
+/**
+ * @brief   Finds a file in the directory.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] name      file name
+ * @param[out] idp      file identifier or @p NO_FILE if not found
+ * @return              The operation status.
+ */
+static bool dir_find(FLFS *fsp, const char *name, uint32_t *idp) {
+  flfs_dir_entry_t de;
+  uint32_t i;
+
+  *idp = NO_FILE;
+  for (i = 0U; i < fsp->files; i++) {
+    if (flfs_read(fsp, fsp->dir, DIR_DATA(fsp) + (i * sizeof de),
+                  &de, sizeof de))
+      return HAL_FAILED;
+    if (strncmp(de.name, name, FLFS_NAME_SIZE) == 0) {
+      *idp = de.id;
+      break;
+    }
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks if a file identifier is in use.
+ * @note    Read errors are reported as in use.
+ */
+static bool dir_has_id(FLFS *fsp, uint32_t id) {
+  flfs_dir_entry_t de;
+  uint32_t i;
+
+  for (i = 0U; i < fsp->files; i++) {
+    if (flfs_read(fsp, fsp->dir, DIR_DATA(fsp) + (i * sizeof de),
+                  &de, sizeof de) || (de.id == id))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief   Writes a modified directory copy.
+ * @details The new copy is written over the older copy and the header,
+ *          which validates it, is programmed last.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] name      file name or @p NULL
+ * @param[in] id        new identifier of the file, @p NO_FILE removes
+ *                      the file from the directory
+ * @return              The operation status.
+ */
+static bool dir_update(FLFS *fsp, const char *name, uint32_t id) {
+  flfs_dir_header_t dh;
+  flfs_dir_entry_t de;
+  unsigned target = 1U - fsp->dir;
+  uint32_t i, files = 0U, pos = DIR_DATA(fsp), crc = 0xFFFFFFFFU;
+  size_t fill = 0U;
+  bool found = false;
+
+  if (flfs_erase(fsp, target))
+    return HAL_FAILED;
+
+  for (i = 0U; i <= fsp->files; i++) {
+    if (i < fsp->files) {
+      if (flfs_read(fsp, fsp->dir, DIR_DATA(fsp) + (i * sizeof de),
+                    &de, sizeof de))
+        return HAL_FAILED;
+      if ((name != NULL) && (strncmp(de.name, name, FLFS_NAME_SIZE) == 0)) {
+        found = true;
+        if (id == NO_FILE)
+          continue;
+        de.id = id;
+      }
+    }
+    else {
+      /* New entry at the end.*/
+      if (found || (name == NULL) || (id == NO_FILE))
+        break;
+      de.id = id;
+      strncpy(de.name, name, FLFS_NAME_SIZE);
+    }
+
+    if (pos + sizeof de > fsp->sector_size)
+      return HAL_FAILED;
+    crc = crc32(crc, &de, sizeof de);
+    if (flfs_append(fsp, target, &pos, &fill, &de, sizeof de))
+      return HAL_FAILED;
+    files++;
+  }
+  if (flfs_append(fsp, target, &pos, &fill, NULL, 0U))
+    return HAL_FAILED;
+
+  dh.magic  = DIR_MAGIC;
+  dh.seq    = fsp->dirseq + 1U;
+  dh.nextid = fsp->nextid;
+  dh.files  = files;
+  dh.crc    = ~crc32(crc, &dh.seq, 3U * sizeof (uint32_t));
+  memset(fsp->u.buf, 0xFF, DIR_DATA(fsp));
+  memcpy(fsp->u.buf, &dh, sizeof dh);
+  if (flfs_program(fsp, target, 0U, fsp->u.buf, DIR_DATA(fsp)))
+    return HAL_FAILED;
+
+  fsp->dir    = target;
+  fsp->dirseq = dh.seq;
+  fsp->files  = files;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Reads and checks a data sector header.
+ */
+static bool sector_check(FLFS *fsp, unsigned sector,
+                         flfs_sector_header_t *shp) {
+
+  return !flfs_read(fsp, sector, 0U, shp, sizeof (flfs_sector_header_t)) &&
+         (shp->magic == SECTOR_MAGIC) &&
+         (shp->crc == ~crc32(0xFFFFFFFFU, shp,
+                             sizeof (flfs_sector_header_t) - 4U));
+}
+
+/**
+ * @brief   Erases the data sectors of a file.
+ */
+static bool sector_reclaim(FLFS *fsp, uint32_t id) {
+  flfs_sector_header_t sh;
+  unsigned i;
+
+  for (i = FIRST_DATA; i < fsp->config->sectors; i++) {
+    if (sector_check(fsp, i, &sh) && (sh.id == id) && flfs_erase(fsp, i))
+      return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks if a data sector is fully erased.
+ * @note    Read errors are reported as not erased.
+ */
+static bool sector_is_erased(FLFS *fsp, unsigned sector) {
+  uint32_t pos;
+
+  for (pos = 0U; pos < fsp->sector_size; pos += FLFS_BUFFER_SIZE) {
+    if (flfs_read(fsp, sector, pos, fsp->u.buf, FLFS_BUFFER_SIZE) ||
+        !is_erased(fsp->u.buf, FLFS_BUFFER_SIZE))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * @brief   Allocates a new data sector to a file.
+ * @details Sectors are allocated in circular order, erased sectors and
+ *          sectors not belonging to any file are free. A sector is used
+ *          without erasing it only if it is fully erased, an interrupted
+ *          erase can leave the header erased and data in the rest of the
+ *          sector.
+ */
+static bool sector_allocate(FLFSFile *fp) {
+  FLFS *fsp = fp->fsp;
+  flfs_sector_header_t sh;
+  unsigned i, sector = FIRST_DATA;
+  unsigned n = fsp->config->sectors - FIRST_DATA;
+
+  for (i = 0U; i < n; i++) {
+    sector = FIRST_DATA + ((fsp->cursor - FIRST_DATA + i) % n);
+    if (flfs_read(fsp, sector, 0U, &sh, sizeof sh)) {
+      fp->error = FLFS_ERR_FLASH;
+      return HAL_FAILED;
+    }
+    if (is_erased(&sh, sizeof sh) && sector_is_erased(fsp, sector))
+      break;
+    if (!sector_check(fsp, sector, &sh) || !dir_has_id(fsp, sh.id)) {
+      if (flfs_erase(fsp, sector)) {
+        fp->error = FLFS_ERR_FLASH;
+        return HAL_FAILED;
+      }
+      break;
+    }
+  }
+  if (i >= n) {
+    fp->error = FLFS_ERR_FULL;
+    return HAL_FAILED;
+  }
+  fsp->cursor = sector + 1U < fsp->config->sectors ? sector + 1U : FIRST_DATA;
+
+  sh.magic = SECTOR_MAGIC;
+  sh.id    = fp->id;
+  sh.start = fp->size - fp->fill;
+  sh.seq   = fsp->nextseq++;
+  sh.crc   = ~crc32(0xFFFFFFFFU, &sh, sizeof sh - 4U);
+  memset(fsp->u.buf, 0xFF, SECTOR_DATA(fsp));
+  memcpy(fsp->u.buf, &sh, sizeof sh);
+  if (flfs_program(fsp, sector, 0U, fsp->u.buf, SECTOR_DATA(fsp))) {
+    fp->error = FLFS_ERR_FLASH;
+    return HAL_FAILED;
+  }
+  fp->tail = sector;
+  fp->wpos = SECTOR_DATA(fsp);
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks the frame at the specified position.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] sector    data sector
+ * @param[in] pos       frame position
+ * @param[out] sizep    size of the frame data
+ * @return              The frame size on flash, zero if there is no valid
+ *                      frame.
+ */
+static uint32_t frame_check(FLFS *fsp, unsigned sector, uint32_t pos,
+                            uint32_t *sizep) {
+  flfs_frame_header_t fh;
+  uint32_t len, commit;
+
+  if ((pos + sizeof fh > fsp->sector_size) ||
+      flfs_read(fsp, sector, pos, &fh, sizeof fh) ||
+      ((fh.size ^ fh.nsize) != 0xFFFFU) ||
+      (fh.size == 0U) || (fh.size > FRAME_DATA(fsp)))
+    return 0U;
+
+  len = ALIGN(fsp, sizeof fh + fh.size);
+  if ((pos + len + fsp->align > fsp->sector_size) ||
+      flfs_read(fsp, sector, pos + len, &commit, sizeof commit) ||
+      (commit != (FRAME_COMMIT ^ fh.size)))
+    return 0U;
+
+  *sizep = fh.size;
+  return len + fsp->align;
+}
+
+/**
+ * @brief   Finds the last sector of a file and its size.
+ * @details The file is truncated to the last complete frame, if there are
+ *          incomplete data after it the sector is not written anymore.
+ */
+static bool file_open_tail(FLFSFile *fp) {
+  FLFS *fsp = fp->fsp;
+  flfs_sector_header_t sh;
+  uint32_t seq = 0U, pos, len, size;
+  unsigned i;
+
+  fp->tail = fsp->config->sectors;
+  fp->wpos = fsp->sector_size;
+  fp->size = 0U;
+  for (i = FIRST_DATA; i < fsp->config->sectors; i++) {
+    if (sector_check(fsp, i, &sh) && (sh.id == fp->id) &&
+        ((fp->tail == fsp->config->sectors) || (sh.seq > seq))) {
+      fp->tail = i;
+      fp->size = sh.start;
+      seq = sh.seq;
+    }
+  }
+  if (fp->tail == fsp->config->sectors)
+    return HAL_SUCCESS;
+
+  pos = SECTOR_DATA(fsp);
+  while ((len = frame_check(fsp, fp->tail, pos, &size)) > 0U) {
+    fp->size += size;
+    pos += len;
+  }
+
+  /* Writing continues in the sector only if it is clean after the last
+     frame.*/
+  if (pos + sizeof (flfs_frame_header_t) <= fsp->sector_size) {
+    if (flfs_read(fsp, fp->tail, pos, fsp->u.buf,
+                  sizeof (flfs_frame_header_t)))
+      return HAL_FAILED;
+    if (is_erased(fsp->u.buf, sizeof (flfs_frame_header_t)))
+      fp->wpos = pos;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Positions the read cursor on the sector containing an offset.
+ */
+static bool file_locate(FLFSFile *fp, fileoffset_t offset) {
+  FLFS *fsp = fp->fsp;
+  flfs_sector_header_t sh;
+  uint32_t seq = 0U;
+  unsigned i;
+
+  fp->rsector = fsp->config->sectors;
+  for (i = FIRST_DATA; i < fsp->config->sectors; i++) {
+    if (sector_check(fsp, i, &sh) && (sh.id == fp->id) &&
+        (sh.start <= offset) &&
+        ((fp->rsector == fsp->config->sectors) || (sh.start > fp->roffset) ||
+         ((sh.start == fp->roffset) && (sh.seq > seq)))) {
+      fp->rsector = i;
+      fp->roffset = sh.start;
+      seq = sh.seq;
+    }
+  }
+  fp->rpos = SECTOR_DATA(fsp);
+  return fp->rsector == fsp->config->sectors ? HAL_FAILED : HAL_SUCCESS;
+}
+
+/**
+ * @brief   Programs the frame in the write buffer.
+ */
+static bool file_flush(FLFSFile *fp) {
+  FLFS *fsp = fp->fsp;
+  flfs_frame_header_t fh;
+  uint32_t len, commit;
+
+  if (fp->fill == 0U)
+    return HAL_SUCCESS;
+
+  len = ALIGN(fsp, sizeof fh + fp->fill);
+  if ((fp->wpos + len + fsp->align > fsp->sector_size) &&
+      sector_allocate(fp))
+    return HAL_FAILED;
+
+  /* Frame header, data, padding and commit word, the commit word is
+     programmed last and validates the frame.*/
+  fh.size  = (uint16_t)fp->fill;
+  fh.nsize = (uint16_t)~fp->fill;
+  commit   = FRAME_COMMIT ^ fp->fill;
+  memcpy(fp->u.buf, &fh, sizeof fh);
+  memset(&fp->u.buf[sizeof fh + fp->fill], 0xFF,
+         len + fsp->align - sizeof fh - fp->fill);
+  memcpy(&fp->u.buf[len], &commit, sizeof commit);
+  if (flfs_program(fsp, fp->tail, fp->wpos, fp->u.buf, len) ||
+      flfs_program(fsp, fp->tail, fp->wpos + len, &fp->u.buf[len],
+                   fsp->align)) {
+    /* The rest of the sector is no more usable.*/
+    fp->wpos  = fsp->sector_size;
+    fp->error = FLFS_ERR_FLASH;
+    return HAL_FAILED;
+  }
+  fp->wpos += len + fsp->align;
+  fp->fill  = 0U;
+  return HAL_SUCCESS;
+}
+
+static size_t file_write(void *ip, const uint8_t *bp, size_t n) {
+  FLFSFile *fp = ip;
+  size_t done = 0U;
+
+  if ((fp->fsp == NULL) || (fp->mode == FLFS_READ)) {
+    fp->error = FLFS_ERR_MODE;
+    return 0U;
+  }
+
+  while (n > 0U) {
+    size_t chunk = FRAME_DATA(fp->fsp) - fp->fill;
+
+    if (chunk == 0U) {
+      if (file_flush(fp))
+        break;
+      continue;
+    }
+    if (chunk > n)
+      chunk = n;
+    memcpy(&fp->u.buf[sizeof (flfs_frame_header_t) + fp->fill], bp, chunk);
+    fp->fill += chunk;
+    fp->size += chunk;
+    bp       += chunk;
+    n        -= chunk;
+    done     += chunk;
+  }
+  fp->position = fp->size;
+  return done;
+}
+
+static size_t file_read(void *ip, uint8_t *bp, size_t n) {
+  FLFSFile *fp = ip;
+  FLFS *fsp = fp->fsp;
+  fileoffset_t committed;
+  uint32_t len, size;
+  size_t done = 0U;
+
+  if (fsp == NULL) {
+    fp->error = FLFS_ERR_MODE;
+    return 0U;
+  }
+
+  committed = fp->size - fp->fill;
+  while ((n > 0U) && (fp->position < fp->size)) {
+    size_t chunk;
+
+    if (fp->position >= committed) {
+      /* Data still in the write buffer.*/
+      chunk = fp->size - fp->position;
+      if (chunk > n)
+        chunk = n;
+      memcpy(bp, &fp->u.buf[sizeof (flfs_frame_header_t) +
+                            (fp->position - committed)], chunk);
+    }
+    else {
+      if ((fp->rsector >= fsp->config->sectors) ||
+          (fp->position < fp->roffset)) {
+        if (file_locate(fp, fp->position)) {
+          fp->error = FLFS_ERR_CORRUPT;
+          break;
+        }
+      }
+
+      len = frame_check(fsp, fp->rsector, fp->rpos, &size);
+      if (len == 0U) {
+        /* End of the sector, the data continues in another sector.*/
+        unsigned sector = fp->rsector;
+
+        if (file_locate(fp, fp->position) || (fp->rsector == sector)) {
+          fp->rsector = fsp->config->sectors;
+          fp->error = FLFS_ERR_CORRUPT;
+          break;
+        }
+        continue;
+      }
+      if (fp->position >= fp->roffset + size) {
+        fp->rpos    += len;
+        fp->roffset += size;
+        continue;
+      }
+
+      chunk = (fp->roffset + size) - fp->position;
+      if (chunk > n)
+        chunk = n;
+      if (flfs_read(fsp, fp->rsector,
+                    fp->rpos + sizeof (flfs_frame_header_t) +
+                    (fp->position - fp->roffset), bp, chunk)) {
+        fp->error = FLFS_ERR_FLASH;
+        break;
+      }
+    }
+    fp->position += chunk;
+    bp           += chunk;
+    n            -= chunk;
+    done         += chunk;
+  }
+  return done;
+}
+
+static msg_t file_put(void *ip, uint8_t b) {
+
+  return file_write(ip, &b, 1U) == 1U ? FILE_OK : FILE_ERROR;
+}
+
+static msg_t file_get(void *ip) {
+  FLFSFile *fp = ip;
+  uint8_t b;
+
+  if ((fp->fsp != NULL) && (fp->position >= fp->size))
+    return FILE_EOF;
+  return file_read(ip, &b, 1U) == 1U ? (msg_t)b : FILE_ERROR;
+}
+
+static msg_t file_close(void *ip) {
+  FLFSFile *fp = ip;
+  bool result;
+
+  if (fp->fsp == NULL)
+    return FILE_ERROR;
+  result = file_flush(fp);
+  fp->fsp = NULL;
+  return result ? FILE_ERROR : FILE_OK;
+}
+
+static msg_t file_geterror(void *ip) {
+
+  return ((FLFSFile *)ip)->error;
+}
+
+static msg_t file_getsize(void *ip) {
+
+  return (msg_t)((FLFSFile *)ip)->size;
+}
+
+static msg_t file_getposition(void *ip) {
+
+  return (msg_t)((FLFSFile *)ip)->position;
+}
+
+static msg_t file_lseek(void *ip, fileoffset_t offset) {
+  FLFSFile *fp = ip;
+
+  if ((fp->fsp == NULL) || (offset > fp->size))
+    return FILE_ERROR;
+  fp->position = offset;
+  return FILE_OK;
+}
+
+static const struct FLFSFileVMT vmt = {
+  file_write, file_read, file_put, file_get,
+  file_close, file_geterror, file_getsize, file_getposition, file_lseek
+};
+
+/**
+ * @brief   Checks the geometry and initializes the file system fields.
+ */
+static bool flfs_setup(FLFS *fsp, const FLFSConfig *config) {
+  const flash_descriptor_t *fdp = flashGetDescriptor(config->flp);
+
+  if ((config->sectors <= FIRST_DATA) ||
+      (config->first_sector + config->sectors > fdp->sectors_count) ||
+      ((FLFS_BUFFER_SIZE % fdp->page_size) != 0U) ||
+      (fdp->page_size > FLFS_BUFFER_SIZE / 4U) ||
+      ((fdp->sectors_size % FLFS_BUFFER_SIZE) != 0U) ||
+      (fdp->sectors_size < 2U * FLFS_BUFFER_SIZE))
+    return HAL_FAILED;
+
+  fsp->config      = config;
+  fsp->sector_size = fdp->sectors_size;
+  fsp->align       = fdp->page_size < 4U ? 4U : fdp->page_size;
+  fsp->cursor      = FIRST_DATA;
+  return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   File system object initialization.
+ *
+ * @param[out] fsp      pointer to a @p FLFS object to be initialized
+ *
+ * @init
+ */
+void flfsObjectInit(FLFS *fsp) {
+
+  fsp->state  = FLFS_STOP;
+  fsp->config = NULL;
+}
+
+/**
+ * @brief   Mounts a file system.
+ * @note    Mounting only reads the directory and the data sectors headers,
+ *          the recovery after a power loss happens when files are opened
+ *          and sectors allocated.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] config    pointer to the @p FLFSConfig object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   invalid geometry or no valid file system.
+ *
+ * @api
+ */
+bool flfsMount(FLFS *fsp, const FLFSConfig *config) {
+  flfs_dir_header_t dh0, dh1;
+  flfs_sector_header_t sh;
+  bool valid0, valid1;
+  unsigned i;
+
+  osalDbgCheck((fsp != NULL) && (config != NULL));
+  osalDbgAssert(fsp->state == FLFS_STOP, "invalid state");
+
+  if (flfs_setup(fsp, config))
+    return HAL_FAILED;
+
+  /* The valid directory copy with the highest sequence number is the
+     current one.*/
+  valid0 = dir_check(fsp, 0U, &dh0);
+  valid1 = dir_check(fsp, 1U, &dh1);
+  if (!valid0 && !valid1)
+    return HAL_FAILED;
+  if (valid0 && (!valid1 || (dh0.seq > dh1.seq))) {
+    fsp->dir = 0U;
+    dh1 = dh0;
+  }
+  else
+    fsp->dir = 1U;
+  fsp->dirseq = dh1.seq;
+  fsp->files  = dh1.files;
+  fsp->nextid = dh1.nextid;
+
+  /* Allocation restarts after the last allocated sector.*/
+  fsp->nextseq = 0U;
+  for (i = FIRST_DATA; i < config->sectors; i++) {
+    if (sector_check(fsp, i, &sh) && (sh.seq >= fsp->nextseq)) {
+      fsp->nextseq = sh.seq + 1U;
+      fsp->cursor  = i + 1U < config->sectors ? i + 1U : FIRST_DATA;
+    }
+  }
+
+  fsp->state = FLFS_READY;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Unmounts a file system.
+ * @pre     All the files must have been closed.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ *
+ * @api
+ */
+void flfsUnmount(FLFS *fsp) {
+
+  osalDbgCheck(fsp != NULL);
+
+  fsp->state = FLFS_STOP;
+}
+
+/**
+ * @brief   Creates an empty file system and mounts it.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] config    pointer to the @p FLFSConfig object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool flfsFormat(FLFS *fsp, const FLFSConfig *config) {
+  unsigned i;
+
+  osalDbgCheck((fsp != NULL) && (config != NULL));
+  osalDbgAssert(fsp->state == FLFS_STOP, "invalid state");
+
+  if (flfs_setup(fsp, config))
+    return HAL_FAILED;
+
+  for (i = 0U; i < config->sectors; i++) {
+    if (flfs_erase(fsp, i))
+      return HAL_FAILED;
+  }
+
+  /* Empty directory in the first sector.*/
+  fsp->dir    = 1U;
+  fsp->dirseq = 0U;
+  fsp->files  = 0U;
+  fsp->nextid = NO_FILE + 1U;
+  if (dir_update(fsp, NULL, NO_FILE))
+    return HAL_FAILED;
+
+  return flfsMount(fsp, config);
+}
+
+/**
+ * @brief   Opens a file.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[out] fp       pointer to the @p FLFSFile object
+ * @param[in] name      file name
+ * @param[in] mode      open mode, one of @p FLFS_READ, @p FLFS_APPEND or
+ *                      @p FLFS_WRITE
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   file not found, directory full or flash error.
+ *
+ * @api
+ */
+bool flfsOpen(FLFS *fsp, FLFSFile *fp, const char *name, unsigned mode) {
+  uint32_t id;
+
+  osalDbgCheck((fsp != NULL) && (fp != NULL) && (name != NULL) &&
+               (mode <= FLFS_WRITE));
+  osalDbgAssert(fsp->state == FLFS_READY, "invalid state");
+
+  if (!valid_name(name) || dir_find(fsp, name, &id) ||
+      ((mode == FLFS_READ) && (id == NO_FILE)))
+    return HAL_FAILED;
+
+  if ((mode == FLFS_WRITE) || (id == NO_FILE)) {
+    /* New file identifier, the data of the replaced file is discarded
+       atomically with the directory update.*/
+    uint32_t oldid = id;
+
+    id = fsp->nextid++;
+    if (dir_update(fsp, name, id))
+      return HAL_FAILED;
+    if (oldid != NO_FILE)
+      (void) sector_reclaim(fsp, oldid);
+  }
+
+  fp->vmt     = &vmt;
+  fp->fsp     = fsp;
+  fp->id      = id;
+  fp->mode    = mode;
+  fp->error   = FLFS_NO_ERROR;
+  fp->fill    = 0U;
+  fp->rsector = fsp->config->sectors;
+  fp->roffset = 0U;
+  fp->rpos    = 0U;
+  if (file_open_tail(fp)) {
+    fp->fsp = NULL;
+    return HAL_FAILED;
+  }
+  fp->position = mode == FLFS_READ ? 0U : fp->size;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Removes a file.
+ * @pre     The file must not be open.
+ *
+ * @param[in] fsp       pointer to the @p FLFS object
+ * @param[in] name      file name
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   file not found or flash error.
+ *
+ * @api
+ */
+bool flfsRemove(FLFS *fsp, const char *name) {
+  uint32_t id;
+
+  osalDbgCheck((fsp != NULL) && (name != NULL));
+  osalDbgAssert(fsp->state == FLFS_READY, "invalid state");
+
+  if (!valid_name(name) || dir_find(fsp, name, &id) || (id == NO_FILE) ||
+      dir_update(fsp, name, NO_FILE))
+    return HAL_FAILED;
+
+  /* Sectors left behind by a power loss are reclaimed on allocation.*/
+  (void) sector_reclaim(fsp, id);
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Commits the buffered data of a file.
+ *
+ * @param[in] fp        pointer to the @p FLFSFile object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed, see @p fileStreamGetError().
+ *
+ * @api
+ */
+bool flfsSync(FLFSFile *fp) {
+
+  osalDbgCheck((fp != NULL) && (fp->fsp != NULL));
+
+  return file_flush(fp);
+}
+
+/** @} */
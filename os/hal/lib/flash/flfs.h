@@ -0,0 +1,285 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    flfs.h
+ * @brief   Flash log file system structures and macros.
+ *
+ * @addtogroup flash_log_fs
+ * @{
+ */
+
+#ifndef _FLFS_H_
+#define _FLFS_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    File open modes
+ * @{
+ */
+/**
+ * @brief   Opens an existing file for reading.
+ */
+#define FLFS_READ                   0U
+/**
+ * @brief   Opens a file for appending, the file is created if missing.
+ */
+#define FLFS_APPEND                 1U
+/**
+ * @brief   Creates a file replacing an existing one.
+ */
+#define FLFS_WRITE                  2U
+/** @} */
+
+/**
+ * @name    File error codes
+ * @{
+ */
+#define FLFS_NO_ERROR               0
+#define FLFS_ERR_FLASH              1
+#define FLFS_ERR_FULL               2
+#define FLFS_ERR_MODE               3
+#define FLFS_ERR_CORRUPT            4
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Flash log file system configuration options
+ * @{
+ */
+/**
+ * @brief   Maximum size of a file name including the terminator.
+ * @note    Must be a multiple of four.
+ */
+#if !defined(FLFS_NAME_SIZE) || defined(__DOXYGEN__)
+#define FLFS_NAME_SIZE              28U
+#endif
+
+/**
+ * @brief   Size of the files and file system buffers.
+ * @details Data is written in frames of up to this size including the
+ *          frame overhead, larger buffers reduce the overhead at the cost
+ *          of RAM.
+ * @note    Must be a multiple of the flash page size and a divisor of the
+ *          sector size.
+ */
+#if !defined(FLFS_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define FLFS_BUFFER_SIZE            256U
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (FLFS_NAME_SIZE < 4U) || ((FLFS_NAME_SIZE % 4U) != 0U)
+#error "invalid FLFS_NAME_SIZE value"
+#endif
+
+#if (FLFS_BUFFER_SIZE < 64U) || ((FLFS_BUFFER_SIZE % 4U) != 0U)
+#error "invalid FLFS_BUFFER_SIZE value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   File system state machine possible states.
+ */
+typedef enum {
+  FLFS_UNINIT = 0,                  /**< Not initialized.                   */
+  FLFS_STOP = 1,                    /**< Not mounted.                       */
+  FLFS_READY = 2                    /**< Mounted.                           */
+} flfsstate_t;
+
+/**
+ * @brief   File system configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Flash device.
+   */
+  BaseFlash             *flp;
+  /**
+   * @brief   First flash sector used by the file system.
+   */
+  flash_sector_t        first_sector;
+  /**
+   * @brief   Number of flash sectors used by the file system, at least
+   *          three.
+   */
+  unsigned              sectors;
+} FLFSConfig;
+
+/**
+ * @brief   Structure representing a flash log file system.
+ * @details The first two sectors hold two copies of the directory, the
+ *          directory is never modified in place, each change writes a new
+ *          copy over the older one and the copy with the highest valid
+ *          sequence number is used.<br>
+ *          The remaining sectors are allocated to files in circular order,
+ *          a file is a set of sectors each one tagged with the file
+ *          identifier and the file offset of its first byte. Data is
+ *          appended to the sectors in frames, a frame is valid only after
+ *          its commit word has been programmed so data interrupted by a
+ *          power loss is discarded and the file is truncated to the last
+ *          complete frame. Replacing a file assigns it a new identifier,
+ *          the sectors of the old file are reclaimed when found.
+ * @note    The file system is not thread safe, accesses must be serialized
+ *          by the user.
+ */
+typedef struct {
+  /**
+   * @brief   File system state.
+   */
+  flfsstate_t           state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const FLFSConfig      *config;
+  /**
+   * @brief   Flash sectors size.
+   */
+  uint32_t              sector_size;
+  /**
+   * @brief   Flash programming alignment.
+   */
+  uint32_t              align;
+  /**
+   * @brief   Current directory sector, zero or one.
+   */
+  unsigned              dir;
+  /**
+   * @brief   Sequence number of the current directory.
+   */
+  uint32_t              dirseq;
+  /**
+   * @brief   Number of files in the current directory.
+   */
+  uint32_t              files;
+  /**
+   * @brief   Identifier of the next created file.
+   */
+  uint32_t              nextid;
+  /**
+   * @brief   Sequence number of the next allocated sector.
+   */
+  uint32_t              nextseq;
+  /**
+   * @brief   Sector where the next allocation starts.
+   */
+  unsigned              cursor;
+  /**
+   * @brief   Transfer buffer.
+   */
+  union {
+    uint32_t            alignment;
+    uint8_t             buf[FLFS_BUFFER_SIZE];
+  } u;
+} FLFS;
+
+/**
+ * @brief   @p FLFSFile specific data.
+ */
+#define _flfs_file_data                                                     \
+  _file_stream_data                                                         \
+  /* File system, NULL if closed.*/                                         \
+  FLFS                  *fsp;                                               \
+  /* File identifier.*/                                                     \
+  uint32_t              id;                                                 \
+  /* Open mode.*/                                                           \
+  unsigned              mode;                                               \
+  /* Last error.*/                                                          \
+  msg_t                 error;                                              \
+  /* File size including the buffered data.*/                               \
+  fileoffset_t          size;                                               \
+  /* Current position.*/                                                    \
+  fileoffset_t          position;                                           \
+  /* Last sector of the file or the sectors number if none.*/               \
+  unsigned              tail;                                               \
+  /* Write position inside the last sector.*/                               \
+  uint32_t              wpos;                                               \
+  /* Read cursor sector.*/                                                  \
+  unsigned              rsector;                                            \
+  /* Read cursor frame position inside the sector.*/                        \
+  uint32_t              rpos;                                               \
+  /* File offset of the read cursor frame.*/                                \
+  fileoffset_t          roffset;                                            \
+  /* Bytes in the write buffer.*/                                           \
+  size_t                fill;                                               \
+  /* Write buffer, it holds the frame being built.*/                        \
+  union {                                                                   \
+    uint32_t            alignment;                                          \
+    uint8_t             buf[FLFS_BUFFER_SIZE];                              \
+  } u;
+
+/**
+ * @extends FileStreamVMT
+ *
+ * @brief   @p FLFSFile virtual methods table.
+ */
+struct FLFSFileVMT {
+  _file_stream_methods
+};
+
+/**
+ * @extends FileStream
+ *
+ * @brief   Flash log file system file object.
+ * @details Writes are always appended at the end of the file, seeking is
+ *          only meaningful for reading. Data is buffered and committed to
+ *          the flash when a frame is full, on @p flfsSync() and on close.
+ * @note    A file must not be opened more than once if one of the opens
+ *          is for writing.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct FLFSFileVMT *vmt;
+  _flfs_file_data
+} FLFSFile;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void flfsObjectInit(FLFS *fsp);
+  bool flfsMount(FLFS *fsp, const FLFSConfig *config);
+  void flfsUnmount(FLFS *fsp);
+  bool flfsFormat(FLFS *fsp, const FLFSConfig *config);
+  bool flfsOpen(FLFS *fsp, FLFSFile *fp, const char *name, unsigned mode);
+  bool flfsRemove(FLFS *fsp, const char *name);
+  bool flfsSync(FLFSFile *fp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FLFS_H_ */
+
+/** @} */
@@ -0,0 +1,737 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    kvstore.c
+ * @brief   Flash key/value store code.
+ *
+ * @addtogroup kv_store
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "kvstore.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Sector header magic number.
+ */
+#define SECTOR_MAGIC                0x3153564BU
+
+/**
+ * @brief   Sequence number of an erased sector.
+ */
+#define FREE_SECTOR                 0xFFFFFFFFU
+
+/**
+ * @brief   Sector header.
+ */
+typedef struct {
+  uint32_t              magic;
+  uint32_t              seq;
+  uint32_t              nseq;
+} kvs_sector_header_t;
+
+/**
+ * @brief   Collection mark.
+ * @details Programmed in the sector opened by the garbage collector once
+ *          the live records of the collected sector have been copied.
+ */
+typedef struct {
+  uint32_t              seq;
+  uint32_t              nseq;
+} kvs_collect_mark_t;
+
+/**
+ * @brief   Record header, followed by the value.
+ * @note    A record with zero size deletes the key.
+ */
+typedef struct {
+  kvs_key_t             key;
+  uint16_t              size;
+  uint32_t              crc;
+} kvs_record_header_t;
+
+/**
+ * @brief   Rounds a size to the records alignment.
+ */
+#define ALIGN(kvp, n) (((n) + (kvp)->align - 1U) & ~((kvp)->align - 1U))
+
+/**
+ * @brief   Position of the collection mark in a sector.
+ */
+#define SECTOR_MARK(kvp) ALIGN(kvp, sizeof (kvs_sector_header_t))
+
+/**
+ * @brief   Size of the sector header area.
+ */
+#define SECTOR_DATA(kvp)                                                    \
+  (SECTOR_MARK(kvp) + ALIGN(kvp, sizeof (kvs_collect_mark_t)))
+
+/**
+ * @brief   Flash offset of a store position.
+ */
+#define FLASH_OFFSET(kvp, pos)                                              \
+  (((kvp)->config->first_sector * (kvp)->sector_size) + (pos))
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Lookup table for CRC-32, four bits at time.
+ */
+static const uint32_t crc32_lookup_table[16] = {
+  0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+  0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+  0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+  0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t crc32(uint32_t crc, const uint8_t *p, size_t n) {
+
+  while (n > 0U) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ crc32_lookup_table[crc & 15U];
+    crc = (crc >> 4) ^ crc32_lookup_table[crc & 15U];
+    n--;
+  }
+  return crc;
+}
+
+static bool is_erased(const uint8_t *p, size_t n) {
+
+  while (n > 0U) {
+    if (*p++ != 0xFFU)
+      return false;
+    n--;
+  }
+  return true;
+}
+
+static bool kvs_read(KVStore *kvp, uint32_t pos, void *p, size_t n) {
+
+  return flashRead(kvp->config->flp, FLASH_OFFSET(kvp, pos), p, n);
+}
+
+/**
+ * @brief   Programs data at the log head.
+ * @details The data is collected in the transfer buffer and programmed in
+ *          buffer sized chunks, the last chunk is padded to the records
+ *          alignment when @p n is zero.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in,out] fillp pointer to the transfer buffer fill level
+ * @param[in] p         pointer to the data
+ * @param[in] n         number of bytes or zero for flushing
+ * @return              The operation status.
+ */
+static bool kvs_append(KVStore *kvp, size_t *fillp, const void *p, size_t n) {
+  const uint8_t *bp = p;
+  size_t fill = *fillp;
+
+  do {
+    size_t chunk;
+
+    if (n == 0U) {
+      /* Flushing the remaining data.*/
+      if (fill == 0U)
+        break;
+      chunk = ALIGN(kvp, fill);
+      memset(&kvp->u.buf[fill], 0xFF, chunk - fill);
+      fill = chunk;
+    }
+    else {
+      chunk = KVS_BUFFER_SIZE - fill;
+      if (chunk > n)
+        chunk = n;
+      memcpy(&kvp->u.buf[fill], bp, chunk);
+      fill += chunk;
+      bp   += chunk;
+      n    -= chunk;
+      if (fill < KVS_BUFFER_SIZE)
+        break;
+    }
+
+    if (flashProgram(kvp->config->flp,
+                     FLASH_OFFSET(kvp, (kvp->head * kvp->sector_size) +
+                                       kvp->wpos),
+                     kvp->u.buf, fill)) {
+      /* The rest of the sector is no more usable.*/
+      kvp->wpos = kvp->sector_size;
+      return HAL_FAILED;
+    }
+    kvp->wpos += fill;
+    kvp->stats.programmed += fill;
+    fill = 0U;
+  } while (n > 0U);
+
+  *fillp = fill;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Checks the record at the specified position.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] pos       record position
+ * @param[out] rhp      record header
+ * @return              The record size, zero at the end of the valid
+ *                      records in the sector.
+ */
+static uint32_t kvs_check_record(KVStore *kvp, uint32_t pos,
+                                 kvs_record_header_t *rhp) {
+  uint32_t end = ((pos / kvp->sector_size) + 1U) * kvp->sector_size;
+  uint32_t len, crc;
+  size_t n;
+
+  if ((pos + sizeof (kvs_record_header_t) > end) ||
+      kvs_read(kvp, pos, rhp, sizeof (kvs_record_header_t)) ||
+      (rhp->size > KVS_MAX_VALUE_SIZE))
+    return 0U;
+
+  len = ALIGN(kvp, sizeof (kvs_record_header_t) + rhp->size);
+  if (pos + len > end)
+    return 0U;
+
+  /* The CRC covers key, size and value.*/
+  crc = crc32(0xFFFFFFFFU, (const uint8_t *)rhp, 4U);
+  pos += sizeof (kvs_record_header_t);
+  for (n = rhp->size; n > 0U; ) {
+    size_t chunk = n < KVS_BUFFER_SIZE ? n : KVS_BUFFER_SIZE;
+
+    if (kvs_read(kvp, pos, kvp->u.buf, chunk))
+      return 0U;
+    crc = crc32(crc, kvp->u.buf, chunk);
+    pos += chunk;
+    n   -= chunk;
+  }
+  if (~crc != rhp->crc)
+    return 0U;
+
+  return len;
+}
+
+/**
+ * @brief   Erases a sector.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] sector    store sector
+ * @return              The operation status.
+ */
+static bool kvs_erase(KVStore *kvp, unsigned sector) {
+
+  kvp->seq[sector] = FREE_SECTOR;
+  if (flashEraseSector(kvp->config->flp,
+                       kvp->config->first_sector + sector))
+    return HAL_FAILED;
+  kvp->stats.erased++;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Opens the next free sector as log head.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @return              The operation status.
+ */
+static bool kvs_open(KVStore *kvp) {
+  kvs_sector_header_t sh;
+  unsigned i, sector = 0U;
+  size_t fill = 0U;
+
+  /* Circular order starting after the current head.*/
+  for (i = 1U; i <= kvp->config->sectors; i++) {
+    sector = (kvp->head + i) % kvp->config->sectors;
+    if (kvp->seq[sector] == FREE_SECTOR)
+      break;
+  }
+  if (i > kvp->config->sectors)
+    return HAL_FAILED;
+
+  sh.magic = SECTOR_MAGIC;
+  sh.seq   = kvp->nextseq;
+  sh.nseq  = ~kvp->nextseq;
+  kvp->head = sector;
+  kvp->wpos = 0U;
+  kvp->seq[sector] = kvp->nextseq++;
+  if (kvs_append(kvp, &fill, &sh, sizeof sh) ||
+      kvs_append(kvp, &fill, NULL, 0U))
+    return HAL_FAILED;
+
+  /* The collection mark is left erased.*/
+  kvp->wpos = SECTOR_DATA(kvp);
+  return HAL_SUCCESS;
+}
+
+static unsigned kvs_free_sectors(KVStore *kvp) {
+  unsigned i, n = 0U;
+
+  for (i = 0U; i < kvp->config->sectors; i++) {
+    if (kvp->seq[i] == FREE_SECTOR)
+      n++;
+  }
+  return n;
+}
+
+/**
+ * @brief   Checks the copies left by an interrupted collection.
+ * @details The records in the sector opened by the collector are copies of
+ *          live records of the collected sector, in the same order. Each
+ *          copy must still be found, passing the CRC check, in the
+ *          collected sector.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] old       sector being collected
+ * @param[in] copy      sector opened by the collector
+ * @return              The check result.
+ * @retval false        if a record is only present in @p copy.
+ * @retval true         if @p old contains all the records.
+ */
+static bool kvs_check_copies(KVStore *kvp, unsigned old, unsigned copy) {
+  kvs_record_header_t rh, orh;
+  uint32_t pos, opos, len, olen;
+
+  pos  = (copy * kvp->sector_size) + SECTOR_DATA(kvp);
+  opos = (old * kvp->sector_size) + SECTOR_DATA(kvp);
+  while ((len = kvs_check_record(kvp, pos, &rh)) > 0U) {
+    do {
+      olen = kvs_check_record(kvp, opos, &orh);
+      if (olen == 0U)
+        return false;
+      opos += olen;
+    } while ((orh.key != rh.key) || (orh.size != rh.size) ||
+             (orh.crc != rh.crc));
+    pos += len;
+  }
+  return true;
+}
+
+/**
+ * @brief   Reclaims the oldest sector.
+ * @details The live records of the oldest sector are moved to the log head
+ *          then the sector is erased. If the collector had to open a new
+ *          sector then, before erasing, the collection mark is programmed
+ *          in it so that an interrupted erase can be recognized on mount.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @return              The operation status.
+ */
+static bool kvs_collect(KVStore *kvp) {
+  kvs_record_header_t rh;
+  kvs_collect_mark_t mark;
+  unsigned i, old = kvp->head, head = kvp->head;
+  uint32_t pos, len;
+
+  for (i = 0U; i < kvp->config->sectors; i++) {
+    if ((kvp->seq[i] != FREE_SECTOR) && (kvp->seq[i] < kvp->seq[old]))
+      old = i;
+  }
+  if ((old == kvp->head) && kvs_open(kvp))
+    return HAL_FAILED;
+
+  pos = (old * kvp->sector_size) + SECTOR_DATA(kvp);
+  while ((len = kvs_check_record(kvp, pos, &rh)) > 0U) {
+    if ((rh.key < kvp->config->keys) && (kvp->config->index[rh.key] == pos)) {
+      uint32_t src = pos, n = len, dst;
+
+      if ((kvp->wpos + len > kvp->sector_size) && kvs_open(kvp))
+        return HAL_FAILED;
+
+      /* Records are moved as they are, aligned chunks of the transfer
+         buffer size.*/
+      dst = (kvp->head * kvp->sector_size) + kvp->wpos;
+      while (n > 0U) {
+        size_t chunk = n < KVS_BUFFER_SIZE ? n : KVS_BUFFER_SIZE;
+
+        if (kvs_read(kvp, src, kvp->u.buf, chunk))
+          return HAL_FAILED;
+        if (flashProgram(kvp->config->flp,
+                         FLASH_OFFSET(kvp, (kvp->head * kvp->sector_size) +
+                                           kvp->wpos),
+                         kvp->u.buf, chunk)) {
+          kvp->wpos = kvp->sector_size;
+          return HAL_FAILED;
+        }
+        kvp->wpos += chunk;
+        kvp->stats.programmed += chunk;
+        src += chunk;
+        n   -= chunk;
+      }
+      kvp->config->index[rh.key] = dst;
+    }
+    pos += len;
+  }
+
+  if (kvp->head != head) {
+    mark.seq  = kvp->seq[old];
+    mark.nseq = ~kvp->seq[old];
+    memset(kvp->u.buf, 0xFF, KVS_BUFFER_SIZE);
+    memcpy(kvp->u.buf, &mark, sizeof mark);
+    if (flashProgram(kvp->config->flp,
+                     FLASH_OFFSET(kvp, (kvp->head * kvp->sector_size) +
+                                       SECTOR_MARK(kvp)),
+                     kvp->u.buf, ALIGN(kvp, sizeof mark)))
+      return HAL_FAILED;
+    kvp->stats.programmed += ALIGN(kvp, sizeof mark);
+  }
+
+  kvp->stats.collected++;
+  return kvs_erase(kvp, old);
+}
+
+/**
+ * @brief   Writes a record at the log head.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] key       the key
+ * @param[in] buf       pointer to the value
+ * @param[in] size      value size, zero for deleting the key
+ * @return              The operation status.
+ */
+static bool kvs_write(KVStore *kvp, kvs_key_t key,
+                      const uint8_t *buf, size_t size) {
+  kvs_record_header_t rh;
+  uint32_t len, pos;
+  unsigned attempts = 0U;
+  size_t fill = 0U;
+
+  len = ALIGN(kvp, sizeof (kvs_record_header_t) + size);
+  if (len > kvp->sector_size - SECTOR_DATA(kvp))
+    return HAL_FAILED;
+
+  /* Making space at the log head, the last free sector is reserved to the
+     garbage collector.*/
+  while (kvp->wpos + len > kvp->sector_size) {
+    if (kvs_free_sectors(kvp) > 1U) {
+      if (kvs_open(kvp))
+        return HAL_FAILED;
+    }
+    else if ((attempts++ >= kvp->config->sectors) || kvs_collect(kvp))
+      return HAL_FAILED;
+  }
+
+  rh.key  = key;
+  rh.size = (uint16_t)size;
+  rh.crc  = ~crc32(crc32(0xFFFFFFFFU, (const uint8_t *)&rh, 4U), buf, size);
+  pos = (kvp->head * kvp->sector_size) + kvp->wpos;
+  if (kvs_append(kvp, &fill, &rh, sizeof rh) ||
+      kvs_append(kvp, &fill, buf, size) ||
+      kvs_append(kvp, &fill, NULL, 0U))
+    return HAL_FAILED;
+
+  kvp->config->index[key] = size > 0U ? pos : KVS_NO_RECORD;
+  kvp->stats.written += size;
+  return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Key/value store object initialization.
+ *
+ * @param[out] kvp      pointer to a @p KVStore object to be initialized
+ *
+ * @init
+ */
+void kvsObjectInit(KVStore *kvp) {
+
+  kvp->state  = KVS_STOP;
+  kvp->config = NULL;
+}
+
+/**
+ * @brief   Mounts a store.
+ * @details The sectors are scanned in log order building the index, the
+ *          records left incomplete by a power loss are discarded and the
+ *          sectors left half erased are erased again. A garbage collection
+ *          interrupted by a power loss is completed or rolled back. An
+ *          empty flash area is formatted.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] config    pointer to the @p KVSConfig object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool kvsMount(KVStore *kvp, const KVSConfig *config) {
+  const flash_descriptor_t *fdp;
+  kvs_sector_header_t sh;
+  kvs_record_header_t rh;
+  kvs_collect_mark_t mark;
+  uint32_t last, pos, len;
+  unsigned i, j, k, found;
+
+  osalDbgCheck((kvp != NULL) && (config != NULL));
+  osalDbgAssert(kvp->state == KVS_STOP, "invalid state");
+
+  fdp = flashGetDescriptor(config->flp);
+  if ((config->sectors < 2U) || (config->sectors > KVS_MAX_SECTORS) ||
+      (config->first_sector + config->sectors > fdp->sectors_count) ||
+      (config->keys > 0xFFFFU) ||
+      ((KVS_BUFFER_SIZE % fdp->page_size) != 0U) ||
+      ((fdp->sectors_size % KVS_BUFFER_SIZE) != 0U))
+    return HAL_FAILED;
+
+  kvp->config      = config;
+  kvp->sector_size = fdp->sectors_size;
+  kvp->align       = fdp->page_size < 4U ? 4U : fdp->page_size;
+  kvp->head        = 0U;
+  kvp->wpos        = kvp->sector_size;
+  kvp->nextseq     = 0U;
+  memset(&kvp->stats, 0, sizeof (kvs_stats_t));
+  for (i = 0U; i < config->keys; i++)
+    config->index[i] = KVS_NO_RECORD;
+
+  /* Sectors state.*/
+  for (i = 0U; i < config->sectors; i++) {
+    pos = i * kvp->sector_size;
+    if (kvs_read(kvp, pos, &sh, sizeof sh))
+      return HAL_FAILED;
+    if ((sh.magic == SECTOR_MAGIC) && (sh.seq == ~sh.nseq) &&
+        (sh.seq != FREE_SECTOR)) {
+      kvp->seq[i] = sh.seq;
+      if (sh.seq >= kvp->nextseq)
+        kvp->nextseq = sh.seq + 1U;
+      continue;
+    }
+
+    /* Not a valid sector, it must be fully erased.*/
+    kvp->seq[i] = FREE_SECTOR;
+    for (len = 0U; len < kvp->sector_size; len += KVS_BUFFER_SIZE) {
+      if (kvs_read(kvp, pos + len, kvp->u.buf, KVS_BUFFER_SIZE))
+        return HAL_FAILED;
+      if (!is_erased(kvp->u.buf, KVS_BUFFER_SIZE)) {
+        if (kvs_erase(kvp, i))
+          return HAL_FAILED;
+        break;
+      }
+    }
+  }
+
+  /* The last free sector is only taken by the garbage collector, if there
+     are no free sectors then the collection of the oldest sector has been
+     interrupted.*/
+  if (kvs_free_sectors(kvp) == 0U) {
+    j = 0U;
+    k = 0U;
+    for (i = 1U; i < config->sectors; i++) {
+      if (kvp->seq[i] > kvp->seq[j])
+        j = i;
+      if (kvp->seq[i] < kvp->seq[k])
+        k = i;
+    }
+    if (kvs_read(kvp, (j * kvp->sector_size) + SECTOR_MARK(kvp),
+                 &mark, sizeof mark))
+      return HAL_FAILED;
+    if ((mark.seq == kvp->seq[k]) && (mark.seq == ~mark.nseq)) {
+      /* The copy was complete and the erase of the oldest sector has been
+         interrupted, its content is no more reliable and it is erased
+         again.*/
+      if (kvs_erase(kvp, k))
+        return HAL_FAILED;
+    }
+    else if (kvs_check_copies(kvp, k, j)) {
+      /* The copy was incomplete and the oldest sector still holds all the
+         records, the newest sector is discarded and the collection
+         restarted later.*/
+      if (kvs_erase(kvp, j))
+        return HAL_FAILED;
+    }
+    /* Else the oldest sector is damaged and both sectors are kept, the
+       copies take precedence being scanned last.*/
+  }
+
+  /* Building the index scanning the sectors in log order.*/
+  last = 0U;
+  found = 0U;
+  while (true) {
+    j = config->sectors;
+    for (i = 0U; i < config->sectors; i++) {
+      if ((kvp->seq[i] != FREE_SECTOR) && (kvp->seq[i] >= last) &&
+          ((j == config->sectors) || (kvp->seq[i] < kvp->seq[j])))
+        j = i;
+    }
+    if (j == config->sectors)
+      break;
+    last = kvp->seq[j] + 1U;
+    found++;
+
+    pos = (j * kvp->sector_size) + SECTOR_DATA(kvp);
+    while ((len = kvs_check_record(kvp, pos, &rh)) > 0U) {
+      if (rh.key < config->keys)
+        config->index[rh.key] = rh.size > 0U ? pos : KVS_NO_RECORD;
+      pos += len;
+    }
+
+    /* The newest sector is the log head, writing restarts after the last
+       valid record unless it has been left incomplete.*/
+    kvp->head = j;
+    kvp->wpos = kvp->sector_size;
+    if ((kvs_read(kvp, pos, kvp->u.buf, sizeof (kvs_record_header_t)) ==
+         HAL_SUCCESS) &&
+        is_erased(kvp->u.buf, sizeof (kvs_record_header_t)))
+      kvp->wpos = pos - (j * kvp->sector_size);
+  }
+
+  if ((found == 0U) && kvs_open(kvp))
+    return HAL_FAILED;
+
+  kvp->state = KVS_READY;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Unmounts a store.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ *
+ * @api
+ */
+void kvsUnmount(KVStore *kvp) {
+
+  osalDbgCheck(kvp != NULL);
+
+  kvp->state = KVS_STOP;
+}
+
+/**
+ * @brief   Erases all the store sectors and mounts the empty store.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] config    pointer to the @p KVSConfig object
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool kvsFormat(KVStore *kvp, const KVSConfig *config) {
+  unsigned i;
+
+  osalDbgCheck((kvp != NULL) && (config != NULL));
+  osalDbgAssert(kvp->state == KVS_STOP, "invalid state");
+
+  for (i = 0U; i < config->sectors; i++) {
+    if (flashEraseSector(config->flp, config->first_sector + i))
+      return HAL_FAILED;
+  }
+  return kvsMount(kvp, config);
+}
+
+/**
+ * @brief   Reads the value of a key.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] key       the key
+ * @param[out] buf      pointer to the value buffer
+ * @param[in] size      size of the buffer, a value larger than the buffer
+ *                      is truncated
+ * @return              The size of the value.
+ * @retval 0            if the key has no value or the read failed.
+ *
+ * @api
+ */
+size_t kvsGet(KVStore *kvp, kvs_key_t key, uint8_t *buf, size_t size) {
+  kvs_record_header_t rh;
+  uint32_t pos;
+
+  osalDbgCheck((kvp != NULL) && ((buf != NULL) || (size == 0U)));
+  osalDbgAssert(kvp->state == KVS_READY, "invalid state");
+
+  if (key >= kvp->config->keys)
+    return 0U;
+  pos = kvp->config->index[key];
+  if ((pos == KVS_NO_RECORD) ||
+      kvs_read(kvp, pos, &rh, sizeof rh))
+    return 0U;
+
+  if (size > rh.size)
+    size = rh.size;
+  if ((size > 0U) &&
+      kvs_read(kvp, pos + sizeof (kvs_record_header_t), buf, size))
+    return 0U;
+  return rh.size;
+}
+
+/**
+ * @brief   Writes the value of a key.
+ * @details The update is atomic, after a power loss the key has either the
+ *          new or the previous value.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] key       the key
+ * @param[in] buf       pointer to the value
+ * @param[in] size      value size, from one to @p KVS_MAX_VALUE_SIZE and
+ *                      fitting a sector
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed or store full.
+ *
+ * @api
+ */
+bool kvsPut(KVStore *kvp, kvs_key_t key, const uint8_t *buf, size_t size) {
+
+  osalDbgCheck((kvp != NULL) && (buf != NULL) &&
+               (size > 0U) && (size <= KVS_MAX_VALUE_SIZE));
+  osalDbgAssert(kvp->state == KVS_READY, "invalid state");
+
+  if (key >= kvp->config->keys)
+    return HAL_FAILED;
+  return kvs_write(kvp, key, buf, size);
+}
+
+/**
+ * @brief   Deletes the value of a key.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] key       the key
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed or store full.
+ *
+ * @api
+ */
+bool kvsDelete(KVStore *kvp, kvs_key_t key) {
+
+  osalDbgCheck(kvp != NULL);
+  osalDbgAssert(kvp->state == KVS_READY, "invalid state");
+
+  if (key >= kvp->config->keys)
+    return HAL_FAILED;
+  if (kvp->config->index[key] == KVS_NO_RECORD)
+    return HAL_SUCCESS;
+  return kvs_write(kvp, key, NULL, 0U);
+}
+
+/** @} */
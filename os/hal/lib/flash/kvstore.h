@@ -0,0 +1,252 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    kvstore.h
+ * @brief   Flash key/value store structures and macros.
+ *
+ * @addtogroup kv_store
+ * @{
+ */
+
+#ifndef _KVSTORE_H_
+#define _KVSTORE_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Index entry of a key without value.
+ */
+#define KVS_NO_RECORD               0xFFFFFFFFU
+
+/**
+ * @brief   Maximum size of a value.
+ */
+#define KVS_MAX_VALUE_SIZE          0xFFFEU
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Key/value store configuration options
+ * @{
+ */
+/**
+ * @brief   Maximum number of flash sectors used by a store.
+ */
+#if !defined(KVS_MAX_SECTORS) || defined(__DOXYGEN__)
+#define KVS_MAX_SECTORS             16U
+#endif
+
+/**
+ * @brief   Size of the transfer buffer.
+ * @note    Must be a multiple of the flash page size and a divisor of
+ *          the sector size.
+ */
+#if !defined(KVS_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define KVS_BUFFER_SIZE             32U
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (KVS_MAX_SECTORS < 2U) || (KVS_BUFFER_SIZE < 16U) ||                    \
+    ((KVS_BUFFER_SIZE % 4U) != 0U)
+#error "invalid key/value store settings"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a key.
+ */
+typedef uint16_t kvs_key_t;
+
+/**
+ * @brief   Store state machine possible states.
+ */
+typedef enum {
+  KVS_UNINIT = 0,                   /**< Not initialized.                   */
+  KVS_STOP = 1,                     /**< Not mounted.                       */
+  KVS_READY = 2                     /**< Mounted.                           */
+} kvsstate_t;
+
+/**
+ * @brief   Store configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Flash device.
+   */
+  BaseFlash             *flp;
+  /**
+   * @brief   First flash sector used by the store.
+   */
+  flash_sector_t        first_sector;
+  /**
+   * @brief   Number of flash sectors used by the store, at least two.
+   */
+  unsigned              sectors;
+  /**
+   * @brief   Index array, one entry for each key.
+   */
+  uint32_t              *index;
+  /**
+   * @brief   Number of keys, the valid keys are from zero to this value
+   *          minus one.
+   */
+  unsigned              keys;
+} KVSConfig;
+
+/**
+ * @brief   Type of the store statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Value bytes written by the application.
+   */
+  uint32_t              written;
+  /**
+   * @brief   Bytes programmed on the flash, records headers and records
+   *          moved by the garbage collector included.
+   */
+  uint32_t              programmed;
+  /**
+   * @brief   Sectors erased.
+   */
+  uint32_t              erased;
+  /**
+   * @brief   Garbage collector runs.
+   */
+  uint32_t              collected;
+} kvs_stats_t;
+
+/**
+ * @brief   Structure representing a key/value store.
+ * @details Values are appended to a log spanning a set of flash sectors,
+ *          each record is protected by a CRC so an update interrupted by a
+ *          power loss is discarded as a whole and the previous value is
+ *          retained. The location of the current value of each key is kept
+ *          in a RAM index built when mounting. When the free sectors are
+ *          exhausted the oldest sector is reclaimed by moving its live
+ *          records to the log head, sectors are used in circular order
+ *          spreading the wear evenly.
+ * @note    One sector is always kept free for the garbage collector so the
+ *          total size of the values must fit the remaining sectors.
+ * @note    The object is not thread safe, accesses must be serialized by
+ *          the user.
+ */
+typedef struct {
+  /**
+   * @brief   Store state.
+   */
+  kvsstate_t            state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const KVSConfig       *config;
+  /**
+   * @brief   Flash sectors size.
+   */
+  uint32_t              sector_size;
+  /**
+   * @brief   Records alignment.
+   */
+  uint32_t              align;
+  /**
+   * @brief   Sequence number of each sector, all ones if erased.
+   */
+  uint32_t              seq[KVS_MAX_SECTORS];
+  /**
+   * @brief   Sequence number of the next opened sector.
+   */
+  uint32_t              nextseq;
+  /**
+   * @brief   Sector at the log head.
+   */
+  unsigned              head;
+  /**
+   * @brief   Write position inside the log head sector.
+   */
+  uint32_t              wpos;
+  /**
+   * @brief   Transfer buffer.
+   */
+  union {
+    uint32_t            alignment;
+    uint8_t             buf[KVS_BUFFER_SIZE];
+  } u;
+  /**
+   * @brief   Statistics.
+   */
+  kvs_stats_t           stats;
+} KVStore;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the store statistics.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @return              Pointer to a @p kvs_stats_t structure.
+ *
+ * @api
+ */
+#define kvsGetStatistics(kvp) (&(kvp)->stats)
+
+/**
+ * @brief   Checks if a key has a value.
+ *
+ * @param[in] kvp       pointer to the @p KVStore object
+ * @param[in] key       the key
+ * @return              The key state.
+ * @retval false        if the key has no value.
+ * @retval true         if the key has a value.
+ *
+ * @api
+ */
+#define kvsHasKey(kvp, key) ((kvp)->config->index[key] != KVS_NO_RECORD)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void kvsObjectInit(KVStore *kvp);
+  bool kvsMount(KVStore *kvp, const KVSConfig *config);
+  void kvsUnmount(KVStore *kvp);
+  bool kvsFormat(KVStore *kvp, const KVSConfig *config);
+  size_t kvsGet(KVStore *kvp, kvs_key_t key, uint8_t *buf, size_t size);
+  bool kvsPut(KVStore *kvp, kvs_key_t key, const uint8_t *buf, size_t size);
+  bool kvsDelete(KVStore *kvp, kvs_key_t key);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _KVSTORE_H_ */
+
+/** @} */
@@ -0,0 +1,189 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    ramflash.c
+ * @brief   RAM emulated flash code.
+ *
+ * @addtogroup ram_flash
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "ramflash.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static const flash_descriptor_t *rflash_get_descriptor(void *ip) {
+
+  return &((RAMFlash *)ip)->descriptor;
+}
+
+static bool rflash_read(void *ip, flash_offset_t offset,
+                        uint8_t *rp, size_t n) {
+  RAMFlash *rfp = ip;
+
+  if (rfp->lost ||
+      (offset + n > rfp->descriptor.sectors_count *
+                    rfp->descriptor.sectors_size))
+    return HAL_FAILED;
+
+  memcpy(rp, rfp->buffer + offset, n);
+  rfp->stats.read += n;
+  return HAL_SUCCESS;
+}
+
+static bool rflash_program(void *ip, flash_offset_t offset,
+                           const uint8_t *pp, size_t n) {
+  RAMFlash *rfp = ip;
+  uint32_t page = rfp->descriptor.page_size;
+  uint8_t *p = rfp->buffer + offset;
+  size_t i;
+
+  osalDbgAssert(((offset % page) == 0U) && ((n % page) == 0U),
+                "unaligned program");
+
+  if (rfp->lost ||
+      (offset + n > rfp->descriptor.sectors_count *
+                    rfp->descriptor.sectors_size))
+    return HAL_FAILED;
+
+  /* Pages already programmed cannot be programmed again on devices not
+     having the FLASH_ATTR_REWRITABLE attribute.*/
+  if ((rfp->descriptor.attributes & FLASH_ATTR_REWRITABLE) == 0U) {
+    for (i = 0U; i < n; i++) {
+      if (p[i] != 0xFFU)
+        return HAL_FAILED;
+    }
+  }
+
+  for (i = 0U; i < n; i++) {
+    if ((i % page) == 0U) {
+      if (rfp->budget == 0U) {
+        /* Power lost in the middle of the page.*/
+        rfp->lost = true;
+        n = i + (page / 2U);
+      }
+      else if (rfp->budget != RFLASH_NO_POWER_LOSS)
+        rfp->budget--;
+    }
+
+    /* Programming can only clear bits.*/
+    p[i] &= pp[i];
+    rfp->stats.programmed++;
+  }
+  return rfp->lost ? HAL_FAILED : HAL_SUCCESS;
+}
+
+static bool rflash_erase_sector(void *ip, flash_sector_t sector) {
+  RAMFlash *rfp = ip;
+
+  uint32_t page = rfp->descriptor.page_size;
+  uint8_t *p;
+  uint32_t i;
+
+  if (rfp->lost || (sector >= rfp->descriptor.sectors_count))
+    return HAL_FAILED;
+
+  p = rfp->buffer + (sector * rfp->descriptor.sectors_size);
+  if (rfp->budget == 0U) {
+    /* Power lost during the erase, a pseudo-random subset of the pages is
+       erased.*/
+    rfp->lost = true;
+    for (i = 0U; i < rfp->descriptor.sectors_size; i += page) {
+      rfp->seed = (rfp->seed * 1103515245U) + 12345U;
+      if ((rfp->seed & 0x10000U) != 0U)
+        memset(p + i, 0xFF, page);
+    }
+    return HAL_FAILED;
+  }
+  if (rfp->budget != RFLASH_NO_POWER_LOSS)
+    rfp->budget--;
+
+  memset(p, 0xFF, rfp->descriptor.sectors_size);
+  rfp->stats.erased++;
+  return HAL_SUCCESS;
+}
+
+static const struct RAMFlashVMT vmt = {
+  rflash_get_descriptor, rflash_read, rflash_program, rflash_erase_sector
+};
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   RAM emulated flash object initialization.
+ * @note    The buffer content is not modified, a buffer holding the image
+ *          of a previous session can be used.
+ *
+ * @param[out] rfp      pointer to a @p RAMFlash object to be initialized
+ * @param[in] fdp       pointer to the descriptor of the emulated device,
+ *                      the @p address field is ignored
+ * @param[in] buffer    pointer to the flash content buffer, it must be
+ *                      @p sectors_count * @p sectors_size bytes large
+ *
+ * @init
+ */
+void rflashObjectInit(RAMFlash *rfp, const flash_descriptor_t *fdp,
+                      uint8_t *buffer) {
+
+  osalDbgCheck((fdp != NULL) && (buffer != NULL) && (fdp->page_size > 0U) &&
+               ((fdp->sectors_size % fdp->page_size) == 0U));
+
+  rfp->vmt                   = &vmt;
+  rfp->descriptor            = *fdp;
+  rfp->descriptor.attributes |= FLASH_ATTR_MEMORY_MAPPED;
+  rfp->descriptor.address    = buffer;
+  rfp->buffer                = buffer;
+  rfp->budget                = RFLASH_NO_POWER_LOSS;
+  rfp->lost                  = false;
+  rfp->seed                  = 1U;
+  memset(&rfp->stats, 0, sizeof (ramflash_stats_t));
+}
+
+/**
+ * @brief   Erases the whole emulated flash.
+ * @note    The operation is not counted in the statistics.
+ *
+ * @param[in] rfp       pointer to the @p RAMFlash object
+ *
+ * @api
+ */
+void rflashErase(RAMFlash *rfp) {
+
+  memset(rfp->buffer, 0xFF,
+         rfp->descriptor.sectors_count * rfp->descriptor.sectors_size);
+}
+
+/** @} */
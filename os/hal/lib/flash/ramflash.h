@@ -0,0 +1,157 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    ramflash.h
+ * @brief   RAM emulated flash structures and macros.
+ *
+ * @addtogroup ram_flash
+ * @{
+ */
+
+#ifndef _RAMFLASH_H_
+#define _RAMFLASH_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Power loss budget value disabling the power loss emulation.
+ */
+#define RFLASH_NO_POWER_LOSS        0xFFFFFFFFU
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of the emulated flash statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Bytes read.
+   */
+  uint32_t              read;
+  /**
+   * @brief   Bytes programmed.
+   */
+  uint32_t              programmed;
+  /**
+   * @brief   Sectors erased.
+   */
+  uint32_t              erased;
+} ramflash_stats_t;
+
+/**
+ * @brief   @p RAMFlash specific data.
+ */
+#define _ram_flash_data                                                     \
+  _base_flash_data                                                          \
+  /* Device descriptor.*/                                                   \
+  flash_descriptor_t    descriptor;                                         \
+  /* Flash content.*/                                                       \
+  uint8_t               *buffer;                                            \
+  /* Pages and erases allowed before the emulated power loss.*/             \
+  uint32_t              budget;                                             \
+  /* Power lost, all the operations fail.*/                                 \
+  bool                  lost;                                               \
+  /* Generator of the pages erased by an interrupted erase.*/               \
+  uint32_t              seed;                                               \
+  /* Statistics.*/                                                          \
+  ramflash_stats_t      stats;
+
+/**
+ * @brief   @p RAMFlash virtual methods table.
+ */
+struct RAMFlashVMT {
+  _base_flash_methods
+};
+
+/**
+ * @extends BaseFlash
+ *
+ * @brief   RAM emulated flash object.
+ * @details A flash device emulated in a RAM buffer, programming can only
+ *          clear bits like on a real NOR flash. It is meant for testing
+ *          and benchmarking the flash based modules on the simulators.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct RAMFlashVMT *vmt;
+  _ram_flash_data
+} RAMFlash;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the emulated flash statistics.
+ *
+ * @param[in] rfp       pointer to the @p RAMFlash object
+ * @return              Pointer to a @p ramflash_stats_t structure.
+ *
+ * @api
+ */
+#define rflashGetStatistics(rfp) (&(rfp)->stats)
+
+/**
+ * @brief   Schedules an emulated power loss.
+ * @details After the specified number of programmed pages and erased
+ *          sectors the power is lost during the next operation and all
+ *          the following operations fail. The interrupted operation is
+ *          left incomplete, the page being programmed is half programmed
+ *          and the sector being erased has a pseudo-random subset of its
+ *          pages erased while the other pages retain their content.
+ * @note    Scheduling again the power loss restores the power.
+ *
+ * @param[in] rfp       pointer to the @p RAMFlash object
+ * @param[in] n         number of operations before the power loss or
+ *                      @p RFLASH_NO_POWER_LOSS
+ *
+ * @api
+ */
+#define rflashSetPowerLoss(rfp, n) do {                                     \
+  (rfp)->budget = (n);                                                      \
+  (rfp)->lost   = false;                                                    \
+} while (false)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void rflashObjectInit(RAMFlash *rfp, const flash_descriptor_t *fdp,
+                        uint8_t *buffer);
+  void rflashErase(RAMFlash *rfp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RAMFLASH_H_ */
+
+/** @} */
@@ -627,6 +627,21 @@ static inline systime_t osalOsGetSystemTimeX(void) {
   return chVTGetSystemTimeX();
 }
 
+/**
+ * @brief   Current value of the realtime counter.
+ * @note    The counter can reach its maximum and then restart from zero.
+ *
+ * @return              The realtime counter value.
+ *
+ * @xclass
+ */
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+static inline rtcnt_t osalOsGetRealtimeCounterX(void) {
+
+  return chSysGetRealtimeCounterX();
+}
+#endif
+
 /**
  * @brief   Checks if the specified time is within the specified time window.
  * @note    When start==end then the function returns always true because the
@@ -105,6 +105,12 @@
 #endif
 /** @} */
 
+/**
+ * @brief   Virtual timers support.
+ * @details The OSAL implements the @p osalTimer*() functions.
+ */
+#define OSAL_SUPPORTS_TIMERS                TRUE
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -618,6 +624,21 @@ static inline systime_t osalOsGetSystemTimeX(void) {
   return chVTGetSystemTimeX();
 }
 
+/**
+ * @brief   Current value of the realtime counter.
+ * @note    The counter can reach its maximum and then restart from zero.
+ *
+ * @return              The realtime counter value.
+ *
+ * @xclass
+ */
+#if (PORT_SUPPORTS_RT == TRUE) || defined(__DOXYGEN__)
+static inline rtcnt_t osalOsGetRealtimeCounterX(void) {
+
+  return chSysGetRealtimeCounterX();
+}
+#endif
+
 /**
  * @brief   Checks if the specified time is within the specified time window.
  * @note    When start==end then the function returns always true because the
@@ -743,6 +764,66 @@ static inline void osalThreadResumeS(thread_reference_t *trp, msg_t msg) {
   chThdResumeS(trp, msg);
 }
 
+/**
+ * @brief   Initializes a virtual timer object.
+ *
+ * @param[out] vtp      pointer to the @p virtual_timer_t object
+ *
+ * @init
+ */
+static inline void osalTimerObjectInit(virtual_timer_t *vtp) {
+
+  chVTObjectInit(vtp);
+}
+
+/**
+ * @brief   Arms a virtual timer.
+ * @details If the timer was already armed then it is re-armed using the
+ *          new parameters.
+ * @note    The callback is invoked from ISR context outside the critical
+ *          zone.
+ *
+ * @param[in] vtp       pointer to the @p virtual_timer_t object
+ * @param[in] delay     the delay in system ticks, @a TIME_IMMEDIATE is not
+ *                      allowed
+ * @param[in] vtfunc    the timer callback function
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+static inline void osalTimerSetI(virtual_timer_t *vtp, systime_t delay,
+                                 vtfunc_t vtfunc, void *par) {
+
+  chVTSetI(vtp, delay, vtfunc, par);
+}
+
+/**
+ * @brief   Disarms a virtual timer.
+ * @note    The timer is disarmed only if armed.
+ *
+ * @param[in] vtp       pointer to the @p virtual_timer_t object
+ *
+ * @iclass
+ */
+static inline void osalTimerResetI(virtual_timer_t *vtp) {
+
+  chVTResetI(vtp);
+}
+
+/**
+ * @brief   Returns @p true if the specified timer is armed.
+ *
+ * @param[in] vtp       pointer to the @p virtual_timer_t object
+ * @return              true if the timer is armed.
+ *
+ * @iclass
+ */
+static inline bool osalTimerIsArmedI(virtual_timer_t *vtp) {
+
+  return chVTIsArmedI(vtp);
+}
+
 /**
  * @brief   Initializes a threads queue object.
  *
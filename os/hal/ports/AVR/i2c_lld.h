@@ -130,6 +130,12 @@ struct I2CDriver {
    */
   mutex_t                   mutex;
 #endif /* I2C_USE_MUTUAL_EXCLUSION */
+#if I2C_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief   Transactions queue.
+   */
+  i2c_queue_t               queue;
+#endif /* I2C_USE_QUEUE */
 #if defined(I2C_DRIVER_EXT_FIELDS)
   I2C_DRIVER_EXT_FIELDS
 #endif
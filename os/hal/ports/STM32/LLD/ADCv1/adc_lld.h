@@ -382,6 +382,12 @@ struct ADCDriver {
    */
   mutex_t                   mutex;
 #endif /* ADC_USE_MUTUAL_EXCLUSION */
+#if ADC_USE_STREAMING || defined(__DOXYGEN__)
+  /**
+   * @brief Stream being fed or @p NULL.
+   */
+  ADCStream                 *stream;
+#endif /* ADC_USE_STREAMING */
 #if defined(ADC_DRIVER_EXT_FIELDS)
   ADC_DRIVER_EXT_FIELDS
 #endif
@@ -57,6 +57,12 @@ CANDriver CAND2;
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Mask of the filters allocated by @p canSTM32AddFilter() or
+ *          programmed by @p canSTM32SetFilters().
+ */
+static uint32_t can_filters_used;
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -134,6 +140,83 @@ static void can_lld_set_filters(uint32_t can2sb,
   rccDisableCAN1(FALSE);
 }
 
+/**
+ * @brief   Returns the mask of the filters assigned to a CAN.
+ * @note    The CAN1 clock must be enabled.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @return              The mask of the filters.
+ *
+ * @notapi
+ */
+static uint32_t can_lld_filters_mask(CANDriver *canp) {
+  uint32_t can2sb = (CAN1->FMR >> 8) & 0x3FU;
+  uint32_t mask = (1U << can2sb) - 1U;
+
+#if STM32_CAN_USE_CAN2
+  if (&CAND2 == canp) {
+    return ((1U << STM32_CAN_MAX_FILTERS) - 1U) & ~mask;
+  }
+#else
+  (void)canp;
+#endif
+  return mask;
+}
+
+/**
+ * @brief   Returns the number of the first filter in a mask.
+ *
+ * @param[in] mask      mask of filters, must not be zero
+ * @return              The number of the first filter.
+ *
+ * @notapi
+ */
+static uint32_t can_lld_first_filter(uint32_t mask) {
+  uint32_t filter = 0U;
+
+  while ((mask & 1U) == 0U) {
+    mask >>= 1;
+    filter++;
+  }
+  return filter;
+}
+
+/**
+ * @brief   Programs a single filter.
+ * @note    The CAN1 clock must be enabled and the filters must be in
+ *          initialization mode.
+ *
+ * @param[in] filter    number of the filter to be programmed
+ * @param[in] cfp       pointer to the filter descriptor or @p NULL for a
+ *                      default filter that enables everything
+ *
+ * @notapi
+ */
+static void can_lld_program_filter(uint32_t filter, const CANFilter *cfp) {
+  uint32_t fmask = 1U << filter;
+
+  CAN1->FA1R &= ~fmask;
+  CAN1->FM1R &= ~fmask;
+  CAN1->FS1R &= ~fmask;
+  CAN1->FFA1R &= ~fmask;
+  if (cfp != NULL) {
+    if (cfp->mode)
+      CAN1->FM1R |= fmask;
+    if (cfp->scale)
+      CAN1->FS1R |= fmask;
+    if (cfp->assignment)
+      CAN1->FFA1R |= fmask;
+    CAN1->sFilterRegister[filter].FR1 = cfp->register1;
+    CAN1->sFilterRegister[filter].FR2 = cfp->register2;
+  }
+  else {
+    CAN1->FS1R |= fmask;
+    CAN1->sFilterRegister[filter].FR1 = 0;
+    CAN1->sFilterRegister[filter].FR2 = 0;
+  }
+  CAN1->FA1R |= fmask;
+}
+
 /**
  * @brief   Common TX ISR handler.
  *
@@ -201,12 +284,19 @@ static void can_lld_rx0_handler(CANDriver *canp) {
 
   rf0r = canp->can->RF0R;
   if ((rf0r & CAN_RF0R_FMP0) > 0) {
-    /* No more receive events until the queue 0 has been emptied.*/
-    canp->can->IER &= ~CAN_IER_FMPIE0;
-    osalSysLockFromISR();
-    osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
-    osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(1U));
-    osalSysUnlockFromISR();
+    if (_can_rx_fifo_active(canp)) {
+      /* Frames moved into the software FIFO, the receive events remain
+         enabled.*/
+      _can_rx_fifo_isr(canp, 1U);
+    }
+    else {
+      /* No more receive events until the queue 0 has been emptied.*/
+      canp->can->IER &= ~CAN_IER_FMPIE0;
+      osalSysLockFromISR();
+      osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
+      osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(1U));
+      osalSysUnlockFromISR();
+    }
   }
   if ((rf0r & CAN_RF0R_FOVR0) > 0) {
     /* Overflow events handling.*/
@@ -229,12 +319,19 @@ static void can_lld_rx1_handler(CANDriver *canp) {
 
   rf1r = canp->can->RF1R;
   if ((rf1r & CAN_RF1R_FMP1) > 0) {
-    /* No more receive events until the queue 0 has been emptied.*/
-    canp->can->IER &= ~CAN_IER_FMPIE1;
-    osalSysLockFromISR();
-    osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
-    osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(2U));
-    osalSysUnlockFromISR();
+    if (_can_rx_fifo_active(canp)) {
+      /* Frames moved into the software FIFO, the receive events remain
+         enabled.*/
+      _can_rx_fifo_isr(canp, 2U);
+    }
+    else {
+      /* No more receive events until the queue 1 has been emptied.*/
+      canp->can->IER &= ~CAN_IER_FMPIE1;
+      osalSysLockFromISR();
+      osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
+      osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(2U));
+      osalSysUnlockFromISR();
+    }
   }
   if ((rf1r & CAN_RF1R_FOVR1) > 0) {
     /* Overflow events handling.*/
@@ -840,6 +937,107 @@ void canSTM32SetFilters(uint32_t can2sb, uint32_t num, const CANFilter *cfp) {
 #endif
 
   can_lld_set_filters(can2sb, num, cfp);
+
+  /* The programmed filters are no more available to the allocator.*/
+  can_filters_used = 0U;
+  while (num > 0U) {
+    can_filters_used |= 1U << cfp->filter;
+    cfp++;
+    num--;
+  }
+}
+
+/**
+ * @brief   Allocates and programs a filter.
+ * @details A free filter is taken among the filters assigned to the
+ *          specified CAN and programmed with the specified descriptor. The
+ *          default filter enabling everything is removed when the first
+ *          filter of a CAN is allocated.
+ * @note    This is an STM32-specific API, it can be used while the driver
+ *          is active, reception on both CANs is briefly suspended while the
+ *          filter is programmed.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in,out] cfp   pointer to the filter descriptor, the @p filter field
+ *                      is set to the number of the allocated filter
+ * @return              The operation result.
+ * @retval false        Filter allocated.
+ * @retval true         No free filters.
+ *
+ * @api
+ */
+bool canSTM32AddFilter(CANDriver *canp, CANFilter *cfp) {
+  uint32_t mask, avail;
+
+  osalDbgCheck((canp != NULL) && (cfp != NULL));
+
+  osalSysLock();
+  rccEnableCAN1(FALSE);
+
+  /* Searching for a free filter among the ones assigned to this CAN.*/
+  mask = can_lld_filters_mask(canp);
+  avail = mask & ~can_filters_used;
+  if (avail == 0U) {
+    if (CAND1.state == CAN_STOP)
+      rccDisableCAN1(FALSE);
+    osalSysUnlock();
+    return true;
+  }
+  cfp->filter = can_lld_first_filter(avail);
+
+  CAN1->FMR |= CAN_FMR_FINIT;
+
+  /* The first allocation removes the default filter.*/
+  if ((can_filters_used & mask) == 0U)
+    CAN1->FA1R &= ~mask;
+
+  can_lld_program_filter(cfp->filter, cfp);
+  can_filters_used |= 1U << cfp->filter;
+  CAN1->FMR &= ~CAN_FMR_FINIT;
+
+  if (CAND1.state == CAN_STOP)
+    rccDisableCAN1(FALSE);
+  osalSysUnlock();
+
+  return false;
+}
+
+/**
+ * @brief   Releases a filter.
+ * @details The filter is deactivated and returned to the allocator, when
+ *          the last filter of a CAN is released the default filter enabling
+ *          everything is restored.
+ * @note    This is an STM32-specific API.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] filter    number of the filter to be released
+ *
+ * @api
+ */
+void canSTM32RemoveFilter(CANDriver *canp, uint32_t filter) {
+  uint32_t mask;
+
+  osalDbgCheck((canp != NULL) && (filter < STM32_CAN_MAX_FILTERS));
+
+  osalSysLock();
+  rccEnableCAN1(FALSE);
+
+  mask = can_lld_filters_mask(canp);
+  osalDbgAssert((mask & can_filters_used & (1U << filter)) != 0U,
+                "filter not allocated");
+
+  CAN1->FMR |= CAN_FMR_FINIT;
+  CAN1->FA1R &= ~(1U << filter);
+  can_filters_used &= ~(1U << filter);
+
+  /* Restoring the default filter on the first filter of this CAN.*/
+  if ((can_filters_used & mask) == 0U)
+    can_lld_program_filter(can_lld_first_filter(mask), NULL);
+  CAN1->FMR &= ~CAN_FMR_FINIT;
+
+  if (CAND1.state == CAN_STOP)
+    rccDisableCAN1(FALSE);
+  osalSysUnlock();
 }
 
 #endif /* HAL_USE_CAN */
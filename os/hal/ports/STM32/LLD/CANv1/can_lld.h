@@ -216,6 +216,7 @@ typedef struct {
 typedef struct {
   /**
    * @brief   Number of the filter to be programmed.
+   * @note    This field is assigned by @p canSTM32AddFilter().
    */
   uint32_t                  filter;
   /**
@@ -324,6 +325,12 @@ typedef struct {
    */
   event_source_t            wakeup_event;
 #endif /* CAN_USE_SLEEP_MODE */
+#if CAN_USE_RX_FIFO || defined(__DOXYGEN__)
+  /**
+   * @brief   Software receive FIFO or @p NULL.
+   */
+  CANRxFifo                 *rxfifo;
+#endif /* CAN_USE_RX_FIFO */
   /* End of the mandatory fields.*/
   /**
    * @brief   Pointer to the CAN registers.
@@ -366,6 +373,8 @@ extern "C" {
   void can_lld_wakeup(CANDriver *canp);
 #endif /* CAN_USE_SLEEP_MODE */
   void canSTM32SetFilters(uint32_t can2sb, uint32_t num, const CANFilter *cfp);
+  bool canSTM32AddFilter(CANDriver *canp, CANFilter *cfp);
+  void canSTM32RemoveFilter(CANDriver *canp, uint32_t filter);
 #ifdef __cplusplus
 }
 #endif
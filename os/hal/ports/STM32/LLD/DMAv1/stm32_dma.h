@@ -393,6 +393,28 @@ typedef struct {
   (dmastp)->dma->IFCR = STM32_DMA_ISR_MASK << (dmastp)->shift;              \
 }
 
+/**
+ * @brief   DMA stream interrupt flags read and clear.
+ * @details The specified flags are read from the ISR register and cleared,
+ *          this allows to poll stream events outside the stream ISR.
+ * @note    This function can be invoked in both ISR or thread context.
+ * @pre     The stream must have been allocated using @p dmaStreamAllocate().
+ *
+ * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
+ * @param[in] mask      mask of the flags to be read and cleared
+ * @return              The pending flags among the specified ones, aligned
+ *                      to bit zero like the flags passed to the stream ISR.
+ *
+ * @special
+ */
+static inline uint32_t dmaStreamGetAndClearFlags(const stm32_dma_stream_t *dmastp,
+                                                 uint32_t mask) {
+  uint32_t flags = (dmastp->dma->ISR >> dmastp->shift) & mask;
+
+  dmastp->dma->IFCR = flags << dmastp->shift;
+  return flags;
+}
+
 /**
  * @brief   Starts a memory to memory operation using the specified stream.
  * @note    The default transfer data mode is "byte to byte" but it can be
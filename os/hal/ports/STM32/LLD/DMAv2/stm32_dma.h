@@ -605,6 +605,30 @@ typedef void (*stm32_dmaisr_t)(void *p, uint32_t flags);
   *(dmastp)->ifcr = STM32_DMA_ISR_MASK << (dmastp)->ishift;                 \
 }
 
+/**
+ * @brief   DMA stream interrupt flags read and clear.
+ * @details The specified flags are read from the xISR register and cleared,
+ *          this allows to poll stream events outside the stream ISR.
+ * @note    This function can be invoked in both ISR or thread context.
+ * @note    The xISR registers are located two words before the associated
+ *          xIFCR registers.
+ * @pre     The stream must have been allocated using @p dmaStreamAllocate().
+ *
+ * @param[in] dmastp    pointer to a stm32_dma_stream_t structure
+ * @param[in] mask      mask of the flags to be read and cleared
+ * @return              The pending flags among the specified ones, aligned
+ *                      to bit zero like the flags passed to the stream ISR.
+ *
+ * @special
+ */
+static inline uint32_t dmaStreamGetAndClearFlags(const stm32_dma_stream_t *dmastp,
+                                                 uint32_t mask) {
+  uint32_t flags = (*(dmastp->ifcr - 2U) >> dmastp->ishift) & mask;
+
+  *dmastp->ifcr = flags << dmastp->ishift;
+  return flags;
+}
+
 /**
  * @brief   Starts a memory to memory operation using the specified stream.
  * @note    The default transfer data mode is "byte to byte" but it can be
@@ -85,6 +85,18 @@
   ((uint16_t)(I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR |      \
               I2C_SR1_PECERR | I2C_SR1_TIMEOUT | I2C_SR1_SMBALERT))
 
+/**
+ * @brief   Checks if the bus is free for a new operation.
+ * @details The bus is free if it is not busy and there is no pending STOP
+ *          condition from a previous operation.
+ *
+ * @param[in] dp        pointer to the I2C registers block
+ *
+ * @notapi
+ */
+#define i2c_lld_is_bus_free(dp)                                             \
+  ((((dp)->SR2 & I2C_SR2_BUSY) == 0U) && (((dp)->CR1 & I2C_CR1_STOP) == 0U))
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -688,6 +700,129 @@ void i2c_lld_stop(I2CDriver *i2cp) {
   }
 }
 
+/**
+ * @brief   Aborts the operation in progress and resets the peripheral.
+ * @details The peripheral is reinitialized with the current configuration,
+ *          the end callback is not invoked.
+ * @note    This function can be called from ISR context.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_reset(I2CDriver *i2cp) {
+
+  i2c_lld_abort_operation(i2cp);
+
+  /* The driver is not in stopped state so only the registers are
+     initialized again.*/
+  i2c_lld_start(i2cp);
+}
+
+/**
+ * @brief   Starts a reception via the I2C bus as master.
+ * @details Number of receiving bytes must be more than 1 on STM32F1x. This is
+ *          hardware restriction.
+ * @note    The operation is terminated from the interrupt handlers.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_start_receive(I2CDriver *i2cp, i2caddr_t addr,
+                            uint8_t *rxbuf, size_t rxbytes) {
+  I2C_TypeDef *dp = i2cp->i2c;
+
+#if defined(STM32F1XX_I2C)
+  osalDbgCheck(rxbytes > 1);
+#endif
+
+  /* The bus could be still busy, as an example because the STOP condition
+     of the previous operation is still pending, the caller retries.*/
+  if (!i2c_lld_is_bus_free(dp))
+    return MSG_TIMEOUT;
+
+  /* Resetting error flags for this transfer.*/
+  i2cp->errors = I2C_NO_ERROR;
+
+  /* Initializes driver fields, LSB = 1 -> receive.*/
+  i2cp->addr = (addr << 1) | 0x01;
+
+  /* RX DMA setup.*/
+  dmaStreamSetMode(i2cp->dmarx, i2cp->rxdmamode);
+  dmaStreamSetMemory0(i2cp->dmarx, rxbuf);
+  dmaStreamSetTransactionSize(i2cp->dmarx, rxbytes);
+
+  /* Starts the operation.*/
+  dp->CR2 |= I2C_CR2_ITEVTEN;
+  dp->CR1 |= I2C_CR1_START | I2C_CR1_ACK;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Starts a transmission via the I2C bus as master.
+ * @details Number of receiving bytes must be 0 or more than 1 on STM32F1x.
+ *          This is hardware restriction.
+ * @note    The operation is terminated from the interrupt handlers, the
+ *          receive phase, if any, is started from the interrupt handlers
+ *          at the end of the transmit phase.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_start_transmit(I2CDriver *i2cp, i2caddr_t addr,
+                             const uint8_t *txbuf, size_t txbytes,
+                             uint8_t *rxbuf, size_t rxbytes) {
+  I2C_TypeDef *dp = i2cp->i2c;
+
+#if defined(STM32F1XX_I2C)
+  osalDbgCheck((rxbytes == 0) || ((rxbytes > 1) && (rxbuf != NULL)));
+#endif
+
+  /* The bus could be still busy, as an example because the STOP condition
+     of the previous operation is still pending, the caller retries.*/
+  if (!i2c_lld_is_bus_free(dp))
+    return MSG_TIMEOUT;
+
+  /* Resetting error flags for this transfer.*/
+  i2cp->errors = I2C_NO_ERROR;
+
+  /* Initializes driver fields, LSB = 0 -> transmit.*/
+  i2cp->addr = (addr << 1);
+
+  /* TX DMA setup.*/
+  dmaStreamSetMode(i2cp->dmatx, i2cp->txdmamode);
+  dmaStreamSetMemory0(i2cp->dmatx, txbuf);
+  dmaStreamSetTransactionSize(i2cp->dmatx, txbytes);
+
+  /* RX DMA setup.*/
+  dmaStreamSetMode(i2cp->dmarx, i2cp->rxdmamode);
+  dmaStreamSetMemory0(i2cp->dmarx, rxbuf);
+  dmaStreamSetTransactionSize(i2cp->dmarx, rxbytes);
+
+  /* Starts the operation.*/
+  dp->CR2 |= I2C_CR2_ITEVTEN;
+  dp->CR1 |= I2C_CR1_START;
+
+  return MSG_OK;
+}
+
 /**
  * @brief   Receives data via the I2C bus as master.
  * @details Number of receiving bytes must be more than 1 on STM32F1x. This is
@@ -717,24 +852,9 @@ msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
   I2C_TypeDef *dp = i2cp->i2c;
   systime_t start, end;
 
-#if defined(STM32F1XX_I2C)
-  osalDbgCheck(rxbytes > 1);
-#endif
-
-  /* Resetting error flags for this transfer.*/
-  i2cp->errors = I2C_NO_ERROR;
-
-  /* Initializes driver fields, LSB = 1 -> receive.*/
-  i2cp->addr = (addr << 1) | 0x01;
-
   /* Releases the lock from high level driver.*/
   osalSysUnlock();
 
-  /* RX DMA setup.*/
-  dmaStreamSetMode(i2cp->dmarx, i2cp->rxdmamode);
-  dmaStreamSetMemory0(i2cp->dmarx, rxbuf);
-  dmaStreamSetTransactionSize(i2cp->dmarx, rxbytes);
-
   /* Calculating the time window for the timeout on the busy bus condition.*/
   start = osalOsGetSystemTimeX();
   end = start + OSAL_MS2ST(STM32_I2C_BUSY_TIMEOUT);
@@ -744,9 +864,10 @@ msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
   while (true) {
     osalSysLock();
 
-    /* If the bus is not busy then the operation can continue, note, the
+    /* If the bus is not busy then the operation is started, note, the
        loop is exited in the locked state.*/
-    if (!(dp->SR2 & I2C_SR2_BUSY) && !(dp->CR1 & I2C_CR1_STOP))
+    if (i2c_lld_is_bus_free(dp) &&
+        (i2c_lld_start_receive(i2cp, addr, rxbuf, rxbytes) == MSG_OK))
       break;
 
     /* If the system time went outside the allowed window then a timeout
@@ -757,10 +878,6 @@ msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
     osalSysUnlock();
   }
 
-  /* Starts the operation.*/
-  dp->CR2 |= I2C_CR2_ITEVTEN;
-  dp->CR1 |= I2C_CR1_START | I2C_CR1_ACK;
-
   /* Waits for the operation completion or a timeout.*/
   return osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
 }
@@ -797,29 +914,9 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
   I2C_TypeDef *dp = i2cp->i2c;
   systime_t start, end;
 
-#if defined(STM32F1XX_I2C)
-  osalDbgCheck((rxbytes == 0) || ((rxbytes > 1) && (rxbuf != NULL)));
-#endif
-
-  /* Resetting error flags for this transfer.*/
-  i2cp->errors = I2C_NO_ERROR;
-
-  /* Initializes driver fields, LSB = 0 -> transmit.*/
-  i2cp->addr = (addr << 1);
-
   /* Releases the lock from high level driver.*/
   osalSysUnlock();
 
-  /* TX DMA setup.*/
-  dmaStreamSetMode(i2cp->dmatx, i2cp->txdmamode);
-  dmaStreamSetMemory0(i2cp->dmatx, txbuf);
-  dmaStreamSetTransactionSize(i2cp->dmatx, txbytes);
-
-  /* RX DMA setup.*/
-  dmaStreamSetMode(i2cp->dmarx, i2cp->rxdmamode);
-  dmaStreamSetMemory0(i2cp->dmarx, rxbuf);
-  dmaStreamSetTransactionSize(i2cp->dmarx, rxbytes);
-
   /* Calculating the time window for the timeout on the busy bus condition.*/
   start = osalOsGetSystemTimeX();
   end = start + OSAL_MS2ST(STM32_I2C_BUSY_TIMEOUT);
@@ -829,9 +926,11 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
   while (true) {
     osalSysLock();
 
-    /* If the bus is not busy then the operation can continue, note, the
+    /* If the bus is not busy then the operation is started, note, the
        loop is exited in the locked state.*/
-    if (!(dp->SR2 & I2C_SR2_BUSY) && !(dp->CR1 & I2C_CR1_STOP))
+    if (i2c_lld_is_bus_free(dp) &&
+        (i2c_lld_start_transmit(i2cp, addr, txbuf, txbytes,
+                                rxbuf, rxbytes) == MSG_OK))
       break;
 
     /* If the system time went outside the allowed window then a timeout
@@ -842,10 +941,6 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
     osalSysUnlock();
   }
 
-  /* Starts the operation.*/
-  dp->CR2 |= I2C_CR2_ITEVTEN;
-  dp->CR1 |= I2C_CR1_START;
-
   /* Waits for the operation completion or a timeout.*/
   return osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
 }
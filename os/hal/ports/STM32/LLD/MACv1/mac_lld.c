@@ -36,6 +36,38 @@
 
 #define BUFFER_SIZE ((((STM32_MAC_BUFFERS_SIZE - 1) | 3) + 1) / 4)
 
+/* Buffers size in bytes, rounded to a word multiple.*/
+#define BUFFER_BYTES (BUFFER_SIZE * 4)
+
+/* Number of descriptors required by the largest frame.*/
+#define FRAME_DESCRIPTORS                                                   \
+  ((STM32_MAC_MAX_FRAME_SIZE + BUFFER_BYTES - 1) / BUFFER_BYTES)
+
+#if FRAME_DESCRIPTORS > STM32_MAC_TRANSMIT_BUFFERS
+#error "STM32_MAC_TRANSMIT_BUFFERS too low for STM32_MAC_MAX_FRAME_SIZE"
+#endif
+
+#if FRAME_DESCRIPTORS > STM32_MAC_RECEIVE_BUFFERS
+#error "STM32_MAC_RECEIVE_BUFFERS too low for STM32_MAC_MAX_FRAME_SIZE"
+#endif
+
+/* Checksum offload flags implied by the static setting.*/
+#if STM32_MAC_IP_CHECKSUM_OFFLOAD == 0
+#define CHECKSUM_STATIC 0U
+#elif STM32_MAC_IP_CHECKSUM_OFFLOAD == 1
+#define CHECKSUM_STATIC (MAC_CHECKSUM_GEN_IP | MAC_CHECKSUM_CHECK_IP)
+#else
+#define CHECKSUM_STATIC (MAC_CHECKSUM_GEN_IP | MAC_CHECKSUM_GEN_PROTO |     \
+                         MAC_CHECKSUM_CHECK_IP | MAC_CHECKSUM_CHECK_PROTO)
+#endif
+
+/* Watchdog and jabber timers limit the frames to 2048 bytes.*/
+#if STM32_MAC_MAX_FRAME_SIZE > 2048
+#define MACCR_JUMBO (ETH_MACCR_WD | ETH_MACCR_JD)
+#else
+#define MACCR_JUMBO 0U
+#endif
+
 /* MII divider optimal value.*/
 #if (STM32_HCLK >= 150000000)
 #define MACMIIDR_CR ETH_MACMIIAR_CR_Div102
@@ -73,6 +105,13 @@ static stm32_eth_tx_descriptor_t __eth_td[STM32_MAC_TRANSMIT_BUFFERS];
 static uint32_t __eth_rb[STM32_MAC_RECEIVE_BUFFERS][BUFFER_SIZE];
 static uint32_t __eth_tb[STM32_MAC_TRANSMIT_BUFFERS][BUFFER_SIZE];
 
+/* Receive descriptors returned to the upper layer and not yet released,
+   they are not owned by the DMA but they do not contain a new frame.*/
+static bool rx_lent[STM32_MAC_RECEIVE_BUFFERS];
+
+/* Checks if a receive descriptor has been returned and not yet released.*/
+#define RX_LENT(rdes) rx_lent[(rdes) - __eth_rd]
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -169,6 +208,30 @@ static void mac_lld_set_address(const uint8_t *p) {
   ETH->MACHTLR   = 0;
 }
 
+/**
+ * @brief   Checks for a complete frame in the receive ring.
+ * @note    The scan stops on descriptors owned by the DMA and on
+ *          descriptors returned to the upper layer and not yet released.
+ *
+ * @param[in] rdes      pointer to the first descriptor to be checked
+ * @return              The ring status.
+ * @retval false        if the ring is empty or the frame is incomplete.
+ * @retval true         if a frame, or an invalid descriptor to be purged,
+ *                      is pending.
+ */
+static bool mac_lld_rx_frame_pending(stm32_eth_rx_descriptor_t *rdes) {
+  unsigned n;
+
+  for (n = 0U; n < STM32_MAC_RECEIVE_BUFFERS; n++) {
+    if ((rdes->rdes0 & STM32_RDES0_OWN) || RX_LENT(rdes))
+      return false;
+    if (rdes->rdes0 & STM32_RDES0_LS)
+      return true;
+    rdes = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+  }
+  return true;
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -181,15 +244,22 @@ OSAL_IRQ_HANDLER(STM32_ETH_HANDLER) {
   dmasr = ETH->DMASR;
   ETH->DMASR = dmasr; /* Clear status bits.*/
 
+#if MAC_USE_RX_MITIGATION
+  /* The RS flag is latched even while the receive interrupt is disabled,
+     it is served only if the receive interrupt is enabled, the frames
+     received meanwhile are collected by the consumer polling the ring.*/
+  if ((dmasr & ETH_DMASR_RS) && (ETH->DMAIER & ETH_DMAIER_RIE)) {
+    /* Data Received, the receive interrupt stays disabled until the
+       consumer empties the ring.*/
+    ETH->DMAIER &= ~ETH_DMAIER_RIE;
+    _mac_isr_receive_code(&ETHD1);
+  }
+#else
   if (dmasr & ETH_DMASR_RS) {
     /* Data Received.*/
-    osalSysLockFromISR();
-    osalThreadDequeueAllI(&ETHD1.rdqueue, MSG_RESET);
-#if MAC_USE_EVENTS
-    osalEventBroadcastFlagsI(&ETHD1.rdevent, 0);
-#endif
-    osalSysUnlockFromISR();
+    _mac_isr_receive_code(&ETHD1);
   }
+#endif
 
   if (dmasr & ETH_DMASR_TS) {
     /* Data Transmitted.*/
@@ -219,7 +289,7 @@ void mac_lld_init(void) {
   /* Descriptor tables are initialized in chained mode, note that the first
      word is not initialized here but in mac_lld_start().*/
   for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
-    __eth_rd[i].rdes1 = STM32_RDES1_RCH | STM32_MAC_BUFFERS_SIZE;
+    __eth_rd[i].rdes1 = STM32_RDES1_RCH | BUFFER_BYTES;
     __eth_rd[i].rdes2 = (uint32_t)__eth_rb[i];
     __eth_rd[i].rdes3 = (uint32_t)&__eth_rd[(i + 1) % STM32_MAC_RECEIVE_BUFFERS];
   }
@@ -289,15 +359,34 @@ void mac_lld_init(void) {
  * @notapi
  */
 void mac_lld_start(MACDriver *macp) {
+  uint32_t csum;
   unsigned i;
 
   /* Resets the state of all descriptors.*/
-  for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++)
+  for (i = 0; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
     __eth_rd[i].rdes0 = STM32_RDES0_OWN;
+    rx_lent[i] = false;
+  }
   macp->rxptr = (stm32_eth_rx_descriptor_t *)__eth_rd;
   for (i = 0; i < STM32_MAC_TRANSMIT_BUFFERS; i++)
     __eth_td[i].tdes0 = STM32_TDES0_TCH;
   macp->txptr = (stm32_eth_tx_descriptor_t *)__eth_td;
+  macp->txbusy = false;
+
+  /* Checksum offload settings, the static setting is merged with the
+     configured one.*/
+  csum = macp->config->checksum | CHECKSUM_STATIC;
+  if (csum & MAC_CHECKSUM_GEN_PROTO)
+    macp->txcic = STM32_TDES0_CIC(3U);
+  else if (csum & MAC_CHECKSUM_GEN_IP)
+    macp->txcic = STM32_TDES0_CIC(1U);
+  else
+    macp->txcic = 0U;
+  macp->rxcsum = 0U;
+  if (csum & MAC_CHECKSUM_CHECK_IP)
+    macp->rxcsum |= STM32_RDES0_IPHCE;
+  if (csum & MAC_CHECKSUM_CHECK_PROTO)
+    macp->rxcsum |= STM32_RDES0_PCE;
 
   /* MAC clocks activation and commanded reset procedure.*/
   rccEnableETH(false);
@@ -329,11 +418,10 @@ void mac_lld_start(MACDriver *macp) {
   /* Transmitter and receiver enabled.
      Note that the complete setup of the MAC is performed when the link
      status is detected.*/
-#if STM32_MAC_IP_CHECKSUM_OFFLOAD
-  ETH->MACCR = ETH_MACCR_IPCO | ETH_MACCR_RE | ETH_MACCR_TE;
-#else
-  ETH->MACCR =                  ETH_MACCR_RE | ETH_MACCR_TE;
-#endif
+  if (macp->rxcsum != 0U)
+    ETH->MACCR = MACCR_JUMBO | ETH_MACCR_IPCO | ETH_MACCR_RE | ETH_MACCR_TE;
+  else
+    ETH->MACCR = MACCR_JUMBO |                  ETH_MACCR_RE | ETH_MACCR_TE;
 
   /* DMA configuration:
      Descriptor chains pointers.*/
@@ -388,8 +476,9 @@ void mac_lld_stop(MACDriver *macp) {
 
 /**
  * @brief   Returns a transmission descriptor.
- * @details One of the available transmission descriptors is locked and
- *          returned.
+ * @details Enough transmission descriptors to hold the largest frame are
+ *          reserved and returned, only one descriptor at time can be
+ *          composed.
  *
  * @param[in] macp      pointer to the @p MACDriver object
  * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
@@ -402,34 +491,41 @@ void mac_lld_stop(MACDriver *macp) {
 msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
                                       MACTransmitDescriptor *tdp) {
   stm32_eth_tx_descriptor_t *tdes;
+  unsigned i;
 
   if (!macp->link_up)
     return MSG_TIMEOUT;
 
   osalSysLock();
 
-  /* Get Current TX descriptor.*/
-  tdes = macp->txptr;
-
-  /* Ensure that descriptor isn't owned by the Ethernet DMA or locked by
-     another thread.*/
-  if (tdes->tdes0 & (STM32_TDES0_OWN | STM32_TDES0_LOCKED)) {
+  /* Another descriptor is being composed.*/
+  if (macp->txbusy) {
     osalSysUnlock();
     return MSG_TIMEOUT;
   }
 
-  /* Marks the current descriptor as locked using a reserved bit.*/
-  tdes->tdes0 |= STM32_TDES0_LOCKED;
+  /* Ensure that the descriptors required by the largest frame are not
+     owned by the Ethernet DMA.*/
+  tdes = macp->txptr;
+  for (i = 0U; i < FRAME_DESCRIPTORS; i++) {
+    if (tdes->tdes0 & STM32_TDES0_OWN) {
+      osalSysUnlock();
+      return MSG_TIMEOUT;
+    }
+    tdes = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  }
 
-  /* Next TX descriptor to use.*/
-  macp->txptr = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+  /* The descriptors are reserved until the release, the transmit pointer
+     is advanced by the number of descriptors actually used.*/
+  macp->txbusy = true;
 
   osalSysUnlock();
 
   /* Set the buffer size and configuration.*/
   tdp->offset   = 0;
-  tdp->size     = STM32_MAC_BUFFERS_SIZE;
-  tdp->physdesc = tdes;
+  tdp->size     = STM32_MAC_MAX_FRAME_SIZE;
+  tdp->physdesc = macp->txptr;
+  tdp->current  = macp->txptr;
 
   return MSG_OK;
 }
@@ -443,17 +539,44 @@ msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
  * @notapi
  */
 void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+  MACDriver *macp = &ETHD1;
+  stm32_eth_tx_descriptor_t *tdes;
+  size_t left;
+  uint32_t tdes0, first;
 
   osalDbgAssert(!(tdp->physdesc->tdes0 & STM32_TDES0_OWN),
               "attempt to release descriptor already owned by DMA");
 
   osalSysLock();
 
-  /* Unlocks the descriptor and returns it to the DMA engine.*/
-  tdp->physdesc->tdes1 = tdp->offset;
-  tdp->physdesc->tdes0 = STM32_TDES0_CIC(STM32_MAC_IP_CHECKSUM_OFFLOAD) |
-                         STM32_TDES0_IC | STM32_TDES0_LS | STM32_TDES0_FS |
-                         STM32_TDES0_TCH | STM32_TDES0_OWN;
+  /* The descriptors following the first one are returned to the DMA engine
+     first, the first descriptor is given back last so that the DMA cannot
+     start processing a partial frame.*/
+  tdes  = tdp->physdesc;
+  left  = tdp->offset;
+  tdes0 = macp->txcic | STM32_TDES0_TCH | STM32_TDES0_FS;
+  first = 0U;
+  do {
+    size_t n = left > BUFFER_BYTES ? BUFFER_BYTES : left;
+
+    left -= n;
+    tdes->tdes1 = n;
+    if (left == 0U)
+      tdes0 |= STM32_TDES0_IC | STM32_TDES0_LS;
+    if (tdes == tdp->physdesc)
+      first = tdes0;
+    else
+      tdes->tdes0 = tdes0 | STM32_TDES0_OWN;
+    tdes  = (stm32_eth_tx_descriptor_t *)tdes->tdes3;
+    tdes0 = macp->txcic | STM32_TDES0_TCH;
+  } while (left > 0U);
+  tdp->physdesc->tdes0 = first | STM32_TDES0_OWN;
+
+  /* Next TX descriptor to use, the unused reserved descriptors are made
+     available again.*/
+  macp->txptr  = tdes;
+  macp->txbusy = false;
+  osalThreadDequeueAllI(&macp->tdqueue, MSG_RESET);
 
   /* If the DMA engine is stalled then a restart request is issued.*/
   if ((ETH->DMASR & ETH_DMASR_TPS) == ETH_DMASR_TPS_Suspended) {
@@ -461,11 +584,18 @@ void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
     ETH->DMATPDR = ETH_DMASR_TBUS; /* Any value is OK.*/
   }
 
+  osalOsRescheduleS();
   osalSysUnlock();
 }
 
 /**
  * @brief   Returns a receive descriptor.
+ * @details A frame can span multiple descriptors, frames not yet completely
+ *          received are left in the ring.
+ * @note    The descriptors of the returned frame are lent to the caller
+ *          until they are released, the ring scan stops on them so that
+ *          the frame is not returned twice if the ring wraps before the
+ *          release. The DMA stops on them too.
  *
  * @param[in] macp      pointer to the @p MACDriver object
  * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
@@ -477,7 +607,8 @@ void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
  */
 msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
                                      MACReceiveDescriptor *rdp) {
-  stm32_eth_rx_descriptor_t *rdes;
+  stm32_eth_rx_descriptor_t *rdes, *ldes, *next;
+  unsigned n;
 
   osalSysLock();
 
@@ -486,25 +617,61 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
 
   /* Iterates through received frames until a valid one is found, invalid
      frames are discarded.*/
-  while (!(rdes->rdes0 & STM32_RDES0_OWN)) {
-    if (!(rdes->rdes0 & (STM32_RDES0_AFM | STM32_RDES0_ES))
-#if STM32_MAC_IP_CHECKSUM_OFFLOAD
-        && (rdes->rdes0 & STM32_RDES0_FT)
-        && !(rdes->rdes0 & (STM32_RDES0_IPHCE | STM32_RDES0_PCE))
-#endif
-        && (rdes->rdes0 & STM32_RDES0_FS) && (rdes->rdes0 & STM32_RDES0_LS)) {
-      /* Found a valid one.*/
-      rdp->offset   = 0;
-      rdp->size     = ((rdes->rdes0 & STM32_RDES0_FL_MASK) >> 16) - 4;
-      rdp->physdesc = rdes;
-      macp->rxptr   = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+  while (!(rdes->rdes0 & STM32_RDES0_OWN) && !RX_LENT(rdes)) {
+    ldes = rdes;
+    n = 1U;
+    if (rdes->rdes0 & STM32_RDES0_FS) {
+      /* Searching the last descriptor of the frame.*/
+      while (!(ldes->rdes0 & STM32_RDES0_LS) &&
+             (n < STM32_MAC_RECEIVE_BUFFERS)) {
+        next = (stm32_eth_rx_descriptor_t *)ldes->rdes3;
+        if ((next->rdes0 & STM32_RDES0_OWN) || RX_LENT(next)) {
+          /* The frame is still being received.*/
+          macp->rxptr = rdes;
+
+          osalSysUnlock();
+          return MSG_TIMEOUT;
+        }
+        if (next->rdes0 & STM32_RDES0_FS) {
+          /* Truncated frame.*/
+          break;
+        }
+        ldes = next;
+        n++;
+      }
 
-      osalSysUnlock();
-      return MSG_OK;
+      if ((ldes->rdes0 & STM32_RDES0_LS) &&
+          !(ldes->rdes0 & (STM32_RDES0_AFM | STM32_RDES0_ES)) &&
+          ((macp->rxcsum == 0U) ||
+           ((ldes->rdes0 & STM32_RDES0_FT) &&
+            !(ldes->rdes0 & macp->rxcsum)))) {
+        /* Found a valid one.*/
+        rdp->offset   = 0;
+        rdp->size     = ((ldes->rdes0 & STM32_RDES0_FL_MASK) >> 16) - 4;
+        rdp->physdesc = rdes;
+        rdp->current  = rdes;
+        rdp->ndesc    = n;
+        macp->rxptr   = (stm32_eth_rx_descriptor_t *)ldes->rdes3;
+
+        /* The descriptors are lent until released.*/
+        while (n > 0U) {
+          RX_LENT(rdes) = true;
+          rdes = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+          n--;
+        }
+
+        osalSysUnlock();
+        return MSG_OK;
+      }
     }
+
     /* Invalid frame found, purging.*/
-    rdes->rdes0 = STM32_RDES0_OWN;
-    rdes = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+    while (n > 0U) {
+      next = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+      rdes->rdes0 = STM32_RDES0_OWN;
+      rdes = next;
+      n--;
+    }
   }
 
   /* Next descriptor to check.*/
@@ -516,22 +683,31 @@ msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
 
 /**
  * @brief   Releases a receive descriptor.
- * @details The descriptor and its buffer are made available for more incoming
- *          frames.
+ * @details The descriptors and their buffers are made available for more
+ *          incoming frames.
  *
  * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
  *
  * @notapi
  */
 void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+  stm32_eth_rx_descriptor_t *rdes;
+  unsigned n;
 
   osalDbgAssert(!(rdp->physdesc->rdes0 & STM32_RDES0_OWN),
               "attempt to release descriptor already owned by DMA");
+  osalDbgAssert(RX_LENT(rdp->physdesc),
+              "attempt to release descriptor not lent");
 
   osalSysLock();
 
-  /* Give buffer back to the Ethernet DMA.*/
-  rdp->physdesc->rdes0 = STM32_RDES0_OWN;
+  /* Give buffers back to the Ethernet DMA.*/
+  rdes = rdp->physdesc;
+  for (n = 0U; n < rdp->ndesc; n++) {
+    RX_LENT(rdes) = false;
+    rdes->rdes0 = STM32_RDES0_OWN;
+    rdes = (stm32_eth_rx_descriptor_t *)rdes->rdes3;
+  }
 
   /* If the DMA engine is stalled then a restart request is issued.*/
   if ((ETH->DMASR & ETH_DMASR_RPS) == ETH_DMASR_RPS_Suspended) {
@@ -628,6 +804,7 @@ bool mac_lld_poll_link_status(MACDriver *macp) {
 size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
                                          uint8_t *buf,
                                          size_t size) {
+  size_t done;
 
   osalDbgAssert(!(tdp->physdesc->tdes0 & STM32_TDES0_OWN),
               "attempt to write descriptor already owned by DMA");
@@ -635,9 +812,20 @@ size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
   if (size > tdp->size - tdp->offset)
     size = tdp->size - tdp->offset;
 
-  if (size > 0) {
-    memcpy((uint8_t *)(tdp->physdesc->tdes2) + tdp->offset, buf, size);
-    tdp->offset += size;
+  done = 0U;
+  while (done < size) {
+    size_t pos = tdp->offset % BUFFER_BYTES;
+    size_t n = BUFFER_BYTES - pos;
+
+    if (n > size - done)
+      n = size - done;
+    memcpy((uint8_t *)(tdp->current->tdes2) + pos, buf + done, n);
+    done        += n;
+    tdp->offset += n;
+
+    /* Moving to the next buffer of the chain.*/
+    if (pos + n == BUFFER_BYTES)
+      tdp->current = (stm32_eth_tx_descriptor_t *)tdp->current->tdes3;
   }
   return size;
 }
@@ -658,6 +846,7 @@ size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
 size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
                                        uint8_t *buf,
                                        size_t size) {
+  size_t done;
 
   osalDbgAssert(!(rdp->physdesc->rdes0 & STM32_RDES0_OWN),
               "attempt to read descriptor already owned by DMA");
@@ -665,13 +854,52 @@ size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
   if (size > rdp->size - rdp->offset)
     size = rdp->size - rdp->offset;
 
-  if (size > 0) {
-    memcpy(buf, (uint8_t *)(rdp->physdesc->rdes2) + rdp->offset, size);
-    rdp->offset += size;
+  done = 0U;
+  while (done < size) {
+    size_t pos = rdp->offset % BUFFER_BYTES;
+    size_t n = BUFFER_BYTES - pos;
+
+    if (n > size - done)
+      n = size - done;
+    memcpy(buf + done, (uint8_t *)(rdp->current->rdes2) + pos, n);
+    done        += n;
+    rdp->offset += n;
+
+    /* Moving to the next buffer of the chain.*/
+    if (pos + n == BUFFER_BYTES)
+      rdp->current = (stm32_eth_rx_descriptor_t *)rdp->current->rdes3;
   }
   return size;
 }
 
+#if MAC_USE_RX_MITIGATION || defined(__DOXYGEN__)
+/**
+ * @brief   Enables the receive interrupt again.
+ * @details Invoked when the consumer found the receive ring empty. If a
+ *          frame has been completely received meanwhile the interrupt is
+ *          left disabled and the consumer must keep polling.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The ring status.
+ * @retval false        if the interrupt has been enabled.
+ * @retval true         if frames are pending in the ring.
+ *
+ * @notapi
+ */
+bool mac_lld_resume_receive_interrupt(MACDriver *macp) {
+  bool pending;
+
+  osalSysLock();
+  ETH->DMAIER |= ETH_DMAIER_RIE;
+  pending = mac_lld_rx_frame_pending(macp->rxptr);
+  if (pending)
+    ETH->DMAIER &= ~ETH_DMAIER_RIE;
+  osalSysUnlock();
+
+  return pending;
+}
+#endif /* MAC_USE_RX_MITIGATION */
+
 #if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
 /**
  * @brief   Returns a pointer to the next transmit buffer in the descriptor
@@ -698,10 +926,20 @@ uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
                                           size_t size,
                                           size_t *sizep) {
 
-  if (tdp->offset == 0) {
-    *sizep      = tdp->size;
-    tdp->offset = size;
-    return (uint8_t *)tdp->physdesc->tdes2;
+  if (size > tdp->size - tdp->offset)
+    size = tdp->size - tdp->offset;
+
+  if (size > 0) {
+    size_t pos = tdp->offset % BUFFER_BYTES;
+    uint8_t *p = (uint8_t *)(tdp->current->tdes2) + pos;
+
+    if (size > BUFFER_BYTES - pos)
+      size = BUFFER_BYTES - pos;
+    tdp->offset += size;
+    if (pos + size == BUFFER_BYTES)
+      tdp->current = (stm32_eth_tx_descriptor_t *)tdp->current->tdes3;
+    *sizep = size;
+    return p;
   }
   *sizep = 0;
   return NULL;
@@ -724,11 +962,18 @@ uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
 const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                size_t *sizep) {
 
-  if (rdp->size > 0) {
-    *sizep      = rdp->size;
-    rdp->offset = rdp->size;
-    rdp->size   = 0;
-    return (uint8_t *)rdp->physdesc->rdes2;
+  if (rdp->offset < rdp->size) {
+    size_t pos = rdp->offset % BUFFER_BYTES;
+    size_t n = rdp->size - rdp->offset;
+    const uint8_t *p = (uint8_t *)(rdp->current->rdes2) + pos;
+
+    if (n > BUFFER_BYTES - pos)
+      n = BUFFER_BYTES - pos;
+    rdp->offset += n;
+    if (pos + n == BUFFER_BYTES)
+      rdp->current = (stm32_eth_rx_descriptor_t *)rdp->current->rdes3;
+    *sizep = n;
+    return p;
   }
   *sizep = 0;
   return NULL;
@@ -36,6 +36,16 @@
  */
 #define MAC_SUPPORTS_ZERO_COPY      TRUE
 
+/**
+ * @brief   This implementation supports the receive interrupt mitigation.
+ */
+#define MAC_SUPPORTS_RX_MITIGATION  TRUE
+
+/**
+ * @brief   This implementation supports the checksum offload.
+ */
+#define MAC_SUPPORTS_CHECKSUM_OFFLOAD TRUE
+
 /**
  * @name    RDES0 constants
  * @{
@@ -136,12 +146,26 @@
 #endif
 
 /**
- * @brief   Maximum supported frame size.
+ * @brief   Size of the transmit and receive buffers.
+ * @details Frames larger than a buffer are split across multiple chained
+ *          descriptors.
  */
 #if !defined(STM32_MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
 #define STM32_MAC_BUFFERS_SIZE              1522
 #endif
 
+/**
+ * @brief   Maximum supported frame size.
+ * @details Sizes above 2048 enable the reception and transmission of jumbo
+ *          frames up to 16384 bytes, the MAC watchdog and jabber timers are
+ *          disabled.
+ * @note    The number of transmit and receive buffers must be enough to
+ *          hold a frame of this size.
+ */
+#if !defined(STM32_MAC_MAX_FRAME_SIZE) || defined(__DOXYGEN__)
+#define STM32_MAC_MAX_FRAME_SIZE            STM32_MAC_BUFFERS_SIZE
+#endif
+
 /**
  * @brief   PHY detection timeout.
  * @details Timeout for PHY address detection, the scan for a PHY is performed
@@ -170,7 +194,8 @@
 
 /**
  * @brief   IP checksum offload.
- * @details The following modes are available:
+ * @details Static setting, it is merged with the @p checksum field of the
+ *          @p MACConfig structure. The following modes are available:
  *          - 0 Function disabled.
  *          - 1 Only IP header checksum calculation and insertion are enabled.
  *          - 2 IP header checksum and payload checksum calculation and
@@ -194,6 +219,15 @@
 #error "STM32_MAC_PHY_TIMEOUT requires the realtime counter service"
 #endif
 
+#if (STM32_MAC_BUFFERS_SIZE < 64) || (STM32_MAC_BUFFERS_SIZE > 8188)
+#error "invalid STM32_MAC_BUFFERS_SIZE value"
+#endif
+
+#if (STM32_MAC_MAX_FRAME_SIZE < STM32_MAC_BUFFERS_SIZE) ||                  \
+    (STM32_MAC_MAX_FRAME_SIZE > 16384)
+#error "invalid STM32_MAC_MAX_FRAME_SIZE value"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -227,6 +261,15 @@ typedef struct {
    */
   uint8_t               *mac_address;
   /* End of the mandatory fields.*/
+  /**
+   * @brief Checksum offload flags.
+   * @details A combination of the @p MAC_CHECKSUM_ flags, the checksums
+   *          selected here are inserted or verified by the MAC.
+   * @note  Received frames with a wrong checksum, or whose checksum cannot
+   *        be verified by the MAC, are discarded when the verification is
+   *        enabled.
+   */
+  uint32_t              checksum;
 } MACConfig;
 
 /**
@@ -254,6 +297,12 @@ struct MACDriver {
    * @brief Receive event.
    */
   event_source_t        rdevent;
+#endif
+#if MAC_USE_RX_MITIGATION || defined(__DOXYGEN__)
+  /**
+   * @brief Receive interrupt mitigation statistics.
+   */
+  mac_rx_stats_t        rxstats;
 #endif
   /* End of the mandatory fields.*/
   /**
@@ -272,6 +321,18 @@ struct MACDriver {
    * @brief Transmit next frame pointer.
    */
   stm32_eth_tx_descriptor_t *txptr;
+  /**
+   * @brief Transmit descriptor being composed.
+   */
+  bool                  txbusy;
+  /**
+   * @brief TDES0 checksum insertion bits.
+   */
+  uint32_t              txcic;
+  /**
+   * @brief RDES0 checksum errors causing a frame to be discarded.
+   */
+  uint32_t              rxcsum;
 };
 
 /**
@@ -288,9 +349,13 @@ typedef struct {
   size_t                    size;
   /* End of the mandatory fields.*/
   /**
-   * @brief Pointer to the physical descriptor.
+   * @brief Pointer to the first physical descriptor.
    */
   stm32_eth_tx_descriptor_t *physdesc;
+  /**
+   * @brief Pointer to the physical descriptor at the write offset.
+   */
+  stm32_eth_tx_descriptor_t *current;
 } MACTransmitDescriptor;
 
 /**
@@ -307,9 +372,17 @@ typedef struct {
   size_t                size;
   /* End of the mandatory fields.*/
   /**
-   * @brief Pointer to the physical descriptor.
+   * @brief Pointer to the first physical descriptor.
    */
   stm32_eth_rx_descriptor_t *physdesc;
+  /**
+   * @brief Pointer to the physical descriptor at the read offset.
+   */
+  stm32_eth_rx_descriptor_t *current;
+  /**
+   * @brief Number of physical descriptors holding the frame.
+   */
+  unsigned              ndesc;
 } MACReceiveDescriptor;
 
 /*===========================================================================*/
@@ -352,6 +425,9 @@ extern "C" {
   const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
                                                  size_t *sizep);
 #endif /* MAC_USE_ZERO_COPY */
+#if MAC_USE_RX_MITIGATION
+  bool mac_lld_resume_receive_interrupt(MACDriver *macp);
+#endif
 #ifdef __cplusplus
 }
 #endif
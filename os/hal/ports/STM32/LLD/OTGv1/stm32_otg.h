@@ -76,7 +76,8 @@ typedef struct {
   volatile uint32_t resvdC;
   volatile uint32_t DIEPTSIZ;   /**< @brief Device IN endpoint transfer size
                                             register.                       */
-  volatile uint32_t resvd14;
+  volatile uint32_t DIEPDMA;    /**< @brief Device IN endpoint DMA address
+                                            register (HS only).             */
   volatile uint32_t DTXFSTS;    /**< @brief Device IN endpoint transmit FIFO
                                             status register.                */
   volatile uint32_t resvd1C;
@@ -94,7 +95,8 @@ typedef struct {
   volatile uint32_t resvdC;
   volatile uint32_t DOEPTSIZ;   /**< @brief Device OUT endpoint transfer
                                             size register.                  */
-  volatile uint32_t resvd14;
+  volatile uint32_t DOEPDMA;    /**< @brief Device OUT endpoint DMA address
+                                            register (HS only).             */
   volatile uint32_t resvd18;
   volatile uint32_t resvd1C;
 } stm32_otg_out_ep_t;
@@ -231,6 +233,11 @@ typedef struct {
                                                  only).                     */
 #define GAHBCFG_HBSTLEN(n)      ((n)<<1)    /**< Burst length/type (HS
                                                  only).                     */
+#define GAHBCFG_HBSTLEN_SINGLE  (0U<<1)     /**< Single transfers.          */
+#define GAHBCFG_HBSTLEN_INCR    (1U<<1)     /**< Unspecified length bursts. */
+#define GAHBCFG_HBSTLEN_INCR4   (3U<<1)     /**< 4 words bursts.            */
+#define GAHBCFG_HBSTLEN_INCR8   (5U<<1)     /**< 8 words bursts.            */
+#define GAHBCFG_HBSTLEN_INCR16  (7U<<1)     /**< 16 words bursts.           */
 #define GAHBCFG_GINTMSK         (1U<<0)     /**< Global interrupt mask.     */
 /** @} */
 
@@ -38,6 +38,17 @@
 #define EP0_MAX_INSIZE          64
 #define EP0_MAX_OUTSIZE         64
 
+#define OTG_DMA_ENABLED         (STM32_USB_USE_OTG2 && STM32_USB_OTG2_USE_DMA)
+
+/**
+ * @brief   Checks if a driver uses the OTG internal DMA.
+ */
+#if OTG_DMA_ENABLED
+#define otg_use_dma(usbp)       ((usbp) == &USBD2)
+#else
+#define otg_use_dma(usbp)       false
+#endif
+
 #if defined(STM32F7XX)
 #define GCCFG_INIT_VALUE        GCCFG_PWRDWN
 #else
@@ -105,6 +116,28 @@ static const USBEndpointConfig ep0config = {
   ep0setup_buffer
 };
 
+#if OTG_DMA_ENABLED || defined(__DOXYGEN__)
+/**
+ * @brief   Memory area for the EP0 DMA buffers.
+ * @note    The area is oversized in order to align the buffers to a cache
+ *          line boundary.
+ */
+static uint32_t ep0_dma_area[(32 + 32 + EP0_MAX_OUTSIZE) / 4];
+
+/**
+ * @brief   EP0 setup packets DMA buffer.
+ * @note    The core can write up to three back-to-back setup packets.
+ */
+static uint8_t *ep0_dma_setup;
+
+/**
+ * @brief   EP0 data stages DMA buffer.
+ * @details Control transfers use application buffers without alignment
+ *          or size constraints, the data is copied through this buffer.
+ */
+static uint8_t *ep0_dma_data;
+#endif
+
 #if STM32_USB_USE_OTG1
 static const stm32_otg_params_t fsparams = {
   STM32_USB_OTG1_RX_FIFO_SIZE / 4,
@@ -262,6 +295,62 @@ static void otg_fifo_read_to_buffer(volatile uint32_t *fifop,
   }
 }
 
+#if OTG_DMA_ENABLED || defined(__DOXYGEN__)
+/**
+ * @brief   Prepares the EP0 for setup packets reception in DMA mode.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+static void otg_dma_ep0_setup_prepare(USBDriver *usbp) {
+  stm32_otg_t *otgp = usbp->otg;
+
+  dmaBufferFlush(ep0_dma_setup, 32U);
+  otgp->oe[0].DOEPTSIZ = DOEPTSIZ_STUPCNT(3) | DOEPTSIZ_PKTCNT(1) |
+                         DOEPTSIZ_XFRSIZ(3 * 8);
+  otgp->oe[0].DOEPDMA  = (uint32_t)ep0_dma_setup;
+  otgp->oe[0].DOEPCTL |= DOEPCTL_EPENA;
+}
+
+/**
+ * @brief   Updates the OUT endpoint state after a DMA transaction.
+ * @details The received size is obtained from the remaining transfer size,
+ *          data received on the endpoint zero is copied in the application
+ *          buffer.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+static void otg_dma_out_complete(USBDriver *usbp, usbep_t ep) {
+  USBOutEndpointState *osp = usbp->epc[ep]->out_state;
+  uint32_t pcnt, size, n;
+
+  /* Programmed transfer size, same rounding of usb_lld_start_out().*/
+  pcnt = (osp->rxsize + usbp->epc[ep]->out_maxsize - 1U) /
+         usbp->epc[ep]->out_maxsize;
+  size = (pcnt * usbp->epc[ep]->out_maxsize + 3U) & 0xFFFFFFFCU;
+  n    = size - (usbp->otg->oe[ep].DOEPTSIZ & DOEPTSIZ_XFRSIZ_MASK);
+
+  if (ep == 0) {
+    dmaBufferInvalidate(ep0_dma_data, EP0_MAX_OUTSIZE);
+    if (n > osp->rxsize) {
+      n = osp->rxsize;
+    }
+    if (n > 0) {
+      memcpy(osp->rxbuf, ep0_dma_data, n);
+    }
+  }
+  else {
+    dmaBufferInvalidate(osp->rxbuf, n);
+  }
+  osp->rxbuf += n;
+  osp->rxcnt += n;
+}
+#endif /* OTG_DMA_ENABLED */
+
 /**
  * @brief   Incoming packets handler.
  *
@@ -363,6 +452,12 @@ static void otg_epin_handler(USBDriver *usbp, usbep_t ep) {
     /* Transmit transfer complete.*/
     USBInEndpointState *isp = usbp->epc[ep]->in_state;
 
+    if (otg_use_dma(usbp)) {
+      /* The core fetched the whole transaction from memory.*/
+      isp->txbuf += isp->txsize;
+      isp->txcnt  = isp->txsize;
+    }
+
     if (isp->txsize < isp->totsize) {
       /* In case the transaction covered only part of the total transfer
          then another transaction is immediately started in order to
@@ -405,15 +500,48 @@ static void otg_epout_handler(USBDriver *usbp, usbep_t ep) {
   otgp->oe[ep].DOEPINT = epint;
 
   if ((epint & DOEPINT_STUP) && (otgp->DOEPMSK & DOEPMSK_STUPM)) {
+#if OTG_DMA_ENABLED
+    if (otg_use_dma(usbp)) {
+      /* The core wrote the setup packet in memory, the last one received
+         is just before the current DMA address.*/
+      uint8_t *sp = (uint8_t *)(otgp->oe[ep].DOEPDMA - 8U);
+
+      dmaBufferInvalidate(sp, 8U);
+      memcpy(usbp->epc[ep]->setup_buf, sp, 8);
+    }
+#endif
     /* Setup packets handling, setup packets are handled using a
        specific callback.*/
     _usb_isr_invoke_setup_cb(usbp, ep);
 
+#if OTG_DMA_ENABLED
+    /* If a data stage has not been started then the endpoint is made
+       ready for the next setup packet.*/
+    if (otg_use_dma(usbp) &&
+        ((otgp->oe[ep].DOEPCTL & DOEPCTL_EPENA) == 0)) {
+      otg_dma_ep0_setup_prepare(usbp);
+    }
+#endif
   }
   if ((epint & DOEPINT_XFRC) && (otgp->DOEPMSK & DOEPMSK_XFRCM)) {
     /* Receive transfer complete.*/
     USBOutEndpointState *osp = usbp->epc[ep]->out_state;
 
+#if OTG_DMA_ENABLED
+    if (otg_use_dma(usbp)) {
+      if (((epint & DOEPINT_STUP) != 0) ||
+          ((usbp->receiving & (1 << ep)) == 0)) {
+        /* Completion of a setup stage, there is no data to be
+           handled.*/
+        if ((otgp->oe[ep].DOEPCTL & DOEPCTL_EPENA) == 0) {
+          otg_dma_ep0_setup_prepare(usbp);
+        }
+        return;
+      }
+      otg_dma_out_complete(usbp, ep);
+    }
+#endif
+
     /* A short packet always terminates a transaction.*/
     if (((osp->rxcnt % usbp->epc[ep]->out_maxsize) == 0) &&
         (osp->rxsize < osp->totsize)) {
@@ -429,6 +557,14 @@ static void otg_epout_handler(USBDriver *usbp, usbep_t ep) {
     else {
       /* End on OUT transfer.*/
       _usb_isr_invoke_out_cb(usbp, ep);
+
+#if OTG_DMA_ENABLED
+      /* Endpoint zero goes back to setup packets reception.*/
+      if (otg_use_dma(usbp) && (ep == 0) &&
+          ((otgp->oe[ep].DOEPCTL & DOEPCTL_EPENA) == 0)) {
+        otg_dma_ep0_setup_prepare(usbp);
+      }
+#endif
     }
   }
 }
@@ -706,6 +842,12 @@ void usb_lld_init(void) {
   USBD2.otg       = OTG_HS;
   USBD2.otgparams = &hsparams;
 
+#if OTG_DMA_ENABLED
+  /* EP0 DMA buffers aligned to a cache line boundary.*/
+  ep0_dma_setup = (uint8_t *)(((uint32_t)ep0_dma_area + 31U) & ~31U);
+  ep0_dma_data  = ep0_dma_setup + 32U;
+#endif
+
 #if defined(_CHIBIOS_RT_)
   USBD2.tr = NULL;
   /* Filling the thread working area here because the function
@@ -834,8 +976,14 @@ void usb_lld_start(USBDriver *usbp) {
     /* Soft core reset.*/
     otg_core_reset(usbp);
 
-    /* Interrupts on TXFIFOs half empty.*/
-    otgp->GAHBCFG = 0;
+    /* Interrupts on TXFIFOs half empty, the internal DMA uses 4 words
+       bursts.*/
+    if (otg_use_dma(usbp)) {
+      otgp->GAHBCFG = GAHBCFG_DMAEN | GAHBCFG_HBSTLEN_INCR4;
+    }
+    else {
+      otgp->GAHBCFG = 0;
+    }
 
     /* Endpoints re-initialization.*/
     otg_disable_ep(usbp);
@@ -859,8 +1007,9 @@ void usb_lld_start(USBDriver *usbp) {
     otgp->GINTSTS  = 0xFFFFFFFF;
 
 #if defined(_CHIBIOS_RT_)
-    /* Creates the data pump thread. Note, it is created only once.*/
-    if (usbp->tr == NULL) {
+    /* Creates the data pump thread. Note, it is created only once and it
+       is not required when the FIFOs are served by the internal DMA.*/
+    if (!otg_use_dma(usbp) && (usbp->tr == NULL)) {
       usbp->tr = chThdCreateI(usbp->wa_pump, sizeof usbp->wa_pump,
                               STM32_USB_OTG_THREAD_PRIO,
                               usb_lld_pump, usbp);
@@ -952,8 +1101,12 @@ void usb_lld_reset(USBDriver *usbp) {
   /* Resets the device address to zero.*/
   otgp->DCFG = (otgp->DCFG & ~DCFG_DAD_MASK) | DCFG_DAD(0);
 
-  /* Enables also EP-related interrupt sources.*/
-  otgp->GINTMSK  |= GINTMSK_RXFLVLM | GINTMSK_OEPM  | GINTMSK_IEPM;
+  /* Enables also EP-related interrupt sources, the RX FIFO is not served
+     by software in DMA mode.*/
+  otgp->GINTMSK  |= GINTMSK_OEPM  | GINTMSK_IEPM;
+  if (!otg_use_dma(usbp)) {
+    otgp->GINTMSK |= GINTMSK_RXFLVLM;
+  }
   otgp->DIEPMSK   = DIEPMSK_TOCM    | DIEPMSK_XFRCM;
   otgp->DOEPMSK   = DOEPMSK_STUPM   | DOEPMSK_XFRCM;
 
@@ -968,6 +1121,14 @@ void usb_lld_reset(USBDriver *usbp) {
   otgp->DIEPTXF0 = DIEPTXF_INEPTXFD(ep0config.in_maxsize / 4) |
                    DIEPTXF_INEPTXSA(otg_ram_alloc(usbp,
                                                   ep0config.in_maxsize / 4));
+
+#if OTG_DMA_ENABLED
+  /* In DMA mode setup packets are only received if the endpoint is
+     enabled.*/
+  if (otg_use_dma(usbp)) {
+    otg_dma_ep0_setup_prepare(usbp);
+  }
+#endif
 }
 
 /**
@@ -1163,6 +1324,23 @@ void usb_lld_start_out(USBDriver *usbp, usbep_t ep) {
   usbp->otg->oe[ep].DOEPTSIZ = DOEPTSIZ_STUPCNT(3) | DOEPTSIZ_PKTCNT(pcnt) |
                                DOEPTSIZ_XFRSIZ(rxsize);
 
+#if OTG_DMA_ENABLED
+  /* In DMA mode the core writes directly in the application buffer except
+     for the endpoint zero.*/
+  if (otg_use_dma(usbp)) {
+    if (ep == 0) {
+      dmaBufferFlush(ep0_dma_data, EP0_MAX_OUTSIZE);
+      usbp->otg->oe[ep].DOEPDMA = (uint32_t)ep0_dma_data;
+    }
+    else {
+      osalDbgAssert(((uint32_t)osp->rxbuf & 3U) == 0U, "unaligned buffer");
+
+      dmaBufferFlush(osp->rxbuf, rxsize);
+      usbp->otg->oe[ep].DOEPDMA = (uint32_t)osp->rxbuf;
+    }
+  }
+#endif
+
   /* Special case of isochronous endpoint.*/
   if ((usbp->epc[ep]->ep_mode & USB_EP_MODE_TYPE) == USB_EP_MODE_TYPE_ISOC) {
     /* Odd/even bit toggling for isochronous endpoint.*/
@@ -1214,9 +1392,32 @@ void usb_lld_start_in(USBDriver *usbp, usbep_t ep) {
       usbp->otg->ie[ep].DIEPCTL |= DIEPCTL_SODDFRM;
   }
 
-  /* Starting operation.*/
+#if OTG_DMA_ENABLED
+  /* In DMA mode the core reads directly from the application buffer except
+     for the endpoint zero.*/
+  if (otg_use_dma(usbp)) {
+    if (ep == 0) {
+      if (isp->txsize > 0) {
+        memcpy(ep0_dma_data, isp->txbuf, isp->txsize);
+      }
+      dmaBufferFlush(ep0_dma_data, EP0_MAX_INSIZE);
+      usbp->otg->ie[ep].DIEPDMA = (uint32_t)ep0_dma_data;
+    }
+    else {
+      osalDbgAssert(((uint32_t)isp->txbuf & 3U) == 0U, "unaligned buffer");
+
+      dmaBufferFlush(isp->txbuf, isp->txsize);
+      usbp->otg->ie[ep].DIEPDMA = (uint32_t)isp->txbuf;
+    }
+  }
+#endif
+
+  /* Starting operation, in DMA mode the TXFIFO is not filled by the
+     pump thread.*/
   usbp->otg->ie[ep].DIEPCTL |= DIEPCTL_EPENA | DIEPCTL_CNAK;
-  usbp->otg->DIEPEMPMSK |= DIEPEMPMSK_INEPTXFEM(ep);
+  if (!otg_use_dma(usbp)) {
+    usbp->otg->DIEPEMPMSK |= DIEPEMPMSK_INEPTXFEM(ep);
+  }
 }
 
 /**
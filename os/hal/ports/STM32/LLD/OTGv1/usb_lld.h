@@ -109,6 +109,23 @@
 #define STM32_USE_USB_OTG2_HS               TRUE
 #endif
 
+/**
+ * @brief   Enables the OTG2 internal DMA.
+ * @details If set to @p TRUE the OTG_HS core moves the endpoints data
+ *          directly from/to the application buffers, the FIFOs are no
+ *          more served by the data pump thread.
+ * @note    Buffers must be aligned to a word boundary, OUT buffers must
+ *          also be large enough to accommodate a whole number of packets.
+ * @note    On devices with data cache, buffers should be aligned to a
+ *          cache line boundary and have a size multiple of the cache line
+ *          size.
+ * @note    The endpoint zero uses an internal buffer so there are no
+ *          restrictions on control transfers.
+ */
+#if !defined(STM32_USB_OTG2_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_USB_OTG2_USE_DMA              FALSE
+#endif
+
 /**
  * @brief   Dedicated data pump threads priority.
  */
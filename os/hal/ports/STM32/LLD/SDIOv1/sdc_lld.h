@@ -99,6 +99,25 @@
 #if !defined(STM32_SDC_SDIO_UNALIGNED_SUPPORT) || defined(__DOXYGEN__)
 #define STM32_SDC_SDIO_UNALIGNED_SUPPORT    TRUE
 #endif
+
+/**
+ * @brief   Size of the unaligned transfers bounce buffer in blocks.
+ * @details Unaligned transfers are performed through a word aligned buffer
+ *          in multi-block chunks of this size.
+ */
+#if !defined(STM32_SDC_SDIO_UNALIGNED_BLOCKS) || defined(__DOXYGEN__)
+#define STM32_SDC_SDIO_UNALIGNED_BLOCKS     4
+#endif
+
+/**
+ * @brief   Number of retries of a transfer failed because of a CRC error.
+ * @details The data clock frequency is halved before each retry, the
+ *          full speed is restored on the next card connection. Zero
+ *          disables the retries.
+ */
+#if !defined(STM32_SDC_SDIO_CRC_RETRIES) || defined(__DOXYGEN__)
+#define STM32_SDC_SDIO_CRC_RETRIES          2
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -131,6 +150,10 @@
 #endif
 #endif /* STM32_ADVANCED_DMA */
 
+#if STM32_SDC_SDIO_UNALIGNED_BLOCKS < 1
+#error "invalid STM32_SDC_SDIO_UNALIGNED_BLOCKS value"
+#endif
+
 #if !defined(STM32_DMA_REQUIRED)
 #define STM32_DMA_REQUIRED
 #endif
@@ -266,6 +289,10 @@ struct SDCDriver {
    * @brief Thread waiting for I/O completion IRQ.
    */
   thread_reference_t        thread;
+  /**
+   * @brief     Current data clock divider.
+   */
+  uint32_t                  clkdiv;
   /**
    * @brief     DMA mode bit mask.
    */
@@ -312,6 +339,10 @@ extern "C" {
                                  uint32_t *resp);
   bool sdc_lld_read_special(SDCDriver *sdcp, uint8_t *buf, size_t bytes,
                             uint8_t cmd, uint32_t argument);
+  bool sdc_lld_read_aligned(SDCDriver *sdcp, uint32_t startblk,
+                            uint8_t *buf, uint32_t blocks);
+  bool sdc_lld_write_aligned(SDCDriver *sdcp, uint32_t startblk,
+                             const uint8_t *buf, uint32_t blocks);
   bool sdc_lld_read(SDCDriver *sdcp, uint32_t startblk,
                     uint8_t *buf, uint32_t blocks);
   bool sdc_lld_write(SDCDriver *sdcp, uint32_t startblk,
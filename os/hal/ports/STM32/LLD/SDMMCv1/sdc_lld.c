@@ -84,7 +84,7 @@ SDCDriver SDCD1;
  */
 static union {
   uint32_t  alignment;
-  uint8_t   buf[MMCSD_BLOCK_SIZE];
+  uint8_t   buf[MMCSD_BLOCK_SIZE * STM32_SDC_SDMMC_UNALIGNED_BLOCKS];
 } u;
 #endif /* STM32_SDC_SDMMC_UNALIGNED_SUPPORT */
 
@@ -316,6 +316,101 @@ static void sdc_lld_error_cleanup(SDCDriver *sdcp,
     sdc_lld_send_cmd_short_crc(sdcp, MMCSD_CMD_STOP_TRANSMISSION, 0, resp);
 }
 
+/**
+ * @brief   Decides if a failed transfer has to be retried.
+ * @details Transfers failed because of a CRC error are retried after halving
+ *          the data clock frequency.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] errors    error flags preceding the failed transfer
+ * @param[in] n         number of retries already performed
+ * @return              The retry condition.
+ * @retval false        the transfer must not be retried.
+ * @retval true         the transfer can be retried.
+ *
+ * @notapi
+ */
+static bool sdc_lld_retry(SDCDriver *sdcp, sdcflags_t errors, unsigned n) {
+  sdcflags_t raised = sdcp->errors;
+  uint32_t div;
+
+  sdcp->errors |= errors;
+  if ((n >= STM32_SDC_SDMMC_CRC_RETRIES) ||
+      ((raised & (SDC_CMD_CRC_ERROR | SDC_DATA_CRC_ERROR)) == 0) ||
+      (sdcp->clkdiv >= SDMMC_CLKDIV_LS))
+    return false;
+
+  /* The card clock is the kernel clock divided by (div + 2).*/
+  div = (sdcp->clkdiv * 2U) + 2U;
+  if (div > SDMMC_CLKDIV_LS)
+    div = SDMMC_CLKDIV_LS;
+  sdcp->clkdiv = div;
+  sdcp->sdmmc->CLKCR = (sdcp->sdmmc->CLKCR & 0xFFFFFF00U) | div;
+  return true;
+}
+
+/**
+ * @brief   Reads one or more blocks retrying on CRC errors.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer, it must be word aligned
+ * @param[in] blocks    number of blocks to read
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_lld_read_retry(SDCDriver *sdcp, uint32_t startblk,
+                               uint8_t *buf, uint32_t blocks) {
+  unsigned n = 0U;
+
+  while (true) {
+    sdcflags_t errors = sdcp->errors;
+
+    sdcp->errors = SDC_NO_ERROR;
+    if (sdc_lld_read_aligned(sdcp, startblk, buf, blocks) == HAL_SUCCESS) {
+      sdcp->errors |= errors;
+      return HAL_SUCCESS;
+    }
+    if (!sdc_lld_retry(sdcp, errors, n++))
+      return HAL_FAILED;
+  }
+}
+
+/**
+ * @brief   Writes one or more blocks retrying on CRC errors.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] buf       pointer to the write buffer, it must be word aligned
+ * @param[in] blocks    number of blocks to write
+ *
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool sdc_lld_write_retry(SDCDriver *sdcp, uint32_t startblk,
+                                const uint8_t *buf, uint32_t blocks) {
+  unsigned n = 0U;
+
+  while (true) {
+    sdcflags_t errors = sdcp->errors;
+
+    sdcp->errors = SDC_NO_ERROR;
+    if (sdc_lld_write_aligned(sdcp, startblk, buf, blocks) == HAL_SUCCESS) {
+      sdcp->errors |= errors;
+      return HAL_SUCCESS;
+    }
+    if (!sdc_lld_retry(sdcp, errors, n++))
+      return HAL_FAILED;
+  }
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -472,7 +567,8 @@ void sdc_lld_set_data_clk(SDCDriver *sdcp, sdcbusclk_t clk) {
 #else
   (void)clk;
 
-  sdcp->sdmmc->CLKCR = (sdcp->sdmmc->CLKCR & 0xFFFFFF00U) | SDMMC_CLKDIV_HS;
+  sdcp->clkdiv = SDMMC_CLKDIV_HS;
+  sdcp->sdmmc->CLKCR = (sdcp->sdmmc->CLKCR & 0xFFFFFF00U) | sdcp->clkdiv;
 #endif
 }
 
@@ -815,18 +911,21 @@ bool sdc_lld_read(SDCDriver *sdcp, uint32_t startblk,
 
 #if STM32_SDC_SDMMC_UNALIGNED_SUPPORT
   if (((unsigned)buf & 3) != 0) {
-    uint32_t i;
-    for (i = 0; i < blocks; i++) {
-      if (sdc_lld_read_aligned(sdcp, startblk, u.buf, 1))
+    while (blocks > 0) {
+      uint32_t n = blocks < STM32_SDC_SDMMC_UNALIGNED_BLOCKS ?
+                   blocks : STM32_SDC_SDMMC_UNALIGNED_BLOCKS;
+
+      if (sdc_lld_read_retry(sdcp, startblk, u.buf, n))
         return HAL_FAILED;
-      memcpy(buf, u.buf, MMCSD_BLOCK_SIZE);
-      buf += MMCSD_BLOCK_SIZE;
-      startblk++;
+      memcpy(buf, u.buf, n * MMCSD_BLOCK_SIZE);
+      buf += n * MMCSD_BLOCK_SIZE;
+      startblk += n;
+      blocks -= n;
     }
     return HAL_SUCCESS;
   }
 #endif /* STM32_SDC_SDMMC_UNALIGNED_SUPPORT */
-  return sdc_lld_read_aligned(sdcp, startblk, buf, blocks);
+  return sdc_lld_read_retry(sdcp, startblk, buf, blocks);
 }
 
 /**
@@ -848,18 +947,21 @@ bool sdc_lld_write(SDCDriver *sdcp, uint32_t startblk,
 
 #if STM32_SDC_SDMMC_UNALIGNED_SUPPORT
   if (((unsigned)buf & 3) != 0) {
-    uint32_t i;
-    for (i = 0; i < blocks; i++) {
-      memcpy(u.buf, buf, MMCSD_BLOCK_SIZE);
-      buf += MMCSD_BLOCK_SIZE;
-      if (sdc_lld_write_aligned(sdcp, startblk, u.buf, 1))
+    while (blocks > 0) {
+      uint32_t n = blocks < STM32_SDC_SDMMC_UNALIGNED_BLOCKS ?
+                   blocks : STM32_SDC_SDMMC_UNALIGNED_BLOCKS;
+
+      memcpy(u.buf, buf, n * MMCSD_BLOCK_SIZE);
+      if (sdc_lld_write_retry(sdcp, startblk, u.buf, n))
         return HAL_FAILED;
-      startblk++;
+      buf += n * MMCSD_BLOCK_SIZE;
+      startblk += n;
+      blocks -= n;
     }
     return HAL_SUCCESS;
   }
 #endif /* STM32_SDC_SDMMC_UNALIGNED_SUPPORT */
-  return sdc_lld_write_aligned(sdcp, startblk, buf, blocks);
+  return sdc_lld_write_retry(sdcp, startblk, buf, blocks);
 }
 
 /**
@@ -31,6 +31,13 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Reconfiguration from ISR context support in the driver.
+ * @note    Reconfiguring an active driver only rewrites the DMA modes and
+ *          the SPI control registers.
+ */
+#define SPI_SUPPORTS_ISR_RECONFIG   TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -464,6 +471,22 @@ struct SPIDriver {
    */
   mutex_t                   mutex;
 #endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if SPI_USE_TRANSFER_LIST || defined(__DOXYGEN__)
+  /**
+   * @brief   Segment of the transfer list in progress or @p NULL.
+   */
+  const SPISegment          *segp;
+  /**
+   * @brief   Segments of the transfer list not yet completed.
+   */
+  size_t                    segcnt;
+#endif /* SPI_USE_TRANSFER_LIST */
+#if SPI_USE_QUEUE || defined(__DOXYGEN__)
+  /**
+   * @brief   Transactions queue.
+   */
+  spi_queue_t               queue;
+#endif /* SPI_USE_QUEUE */
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -30,6 +30,46 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if STM32_SERIAL_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   DMA stream mode for a USART and direction.
+ * @note    The DMA streams and channels are shared with the UART driver
+ *          settings.
+ *
+ * @param[in] usart     USART name, for example @p USART1
+ * @param[in] dir       transfer direction, @p RX or @p TX
+ */
+#define SERIAL_DMA_MODE(usart, dir)                                         \
+  (STM32_DMA_CR_DMEIE | STM32_DMA_CR_TEIE |                                 \
+   STM32_DMA_CR_CHSEL(STM32_DMA_GETCHANNEL(                                 \
+                        STM32_UART_##usart##_##dir##_DMA_STREAM,            \
+                        STM32_##usart##_##dir##_DMA_CHN)) |                 \
+   STM32_DMA_CR_PL(STM32_SERIAL_##usart##_DMA_PRIORITY))
+
+/**
+ * @brief   Associates the DMA streams of a USART to its driver.
+ *
+ * @param[in] sd        the @p SerialDriver object
+ * @param[in] usart     USART name, for example @p USART1
+ * @param[in] buf       RX DMA circular buffer
+ */
+#define SERIAL_DMA_INIT(sd, usart, buf) {                                   \
+  (sd).dmarx = STM32_DMA_STREAM(STM32_UART_##usart##_RX_DMA_STREAM);        \
+  (sd).dmatx = STM32_DMA_STREAM(STM32_UART_##usart##_TX_DMA_STREAM);        \
+  (sd).rxbuf = (buf);                                                       \
+}
+
+/**
+ * @brief   Marks a driver as operating in interrupt mode.
+ *
+ * @param[in] sd        the @p SerialDriver object
+ */
+#define SERIAL_DMA_INIT_NONE(sd) {                                          \
+  (sd).dmarx = NULL;                                                        \
+  (sd).dmatx = NULL;                                                        \
+}
+#endif /* STM32_SERIAL_USE_DMA */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -87,10 +127,241 @@ static const SerialConfig default_config =
   0
 };
 
+#if STM32_SERIAL_USART1_USE_DMA || defined(__DOXYGEN__)
+/** @brief USART1 RX DMA circular buffer.*/
+static uint8_t sd1_rxbuf[STM32_SERIAL_DMA_RX_BUFFER_SIZE];
+#endif
+
+#if STM32_SERIAL_USART2_USE_DMA || defined(__DOXYGEN__)
+/** @brief USART2 RX DMA circular buffer.*/
+static uint8_t sd2_rxbuf[STM32_SERIAL_DMA_RX_BUFFER_SIZE];
+#endif
+
+#if STM32_SERIAL_USART3_USE_DMA || defined(__DOXYGEN__)
+/** @brief USART3 RX DMA circular buffer.*/
+static uint8_t sd3_rxbuf[STM32_SERIAL_DMA_RX_BUFFER_SIZE];
+#endif
+
+#if STM32_SERIAL_UART4_USE_DMA || defined(__DOXYGEN__)
+/** @brief UART4 RX DMA circular buffer.*/
+static uint8_t sd4_rxbuf[STM32_SERIAL_DMA_RX_BUFFER_SIZE];
+#endif
+
+#if STM32_SERIAL_UART5_USE_DMA || defined(__DOXYGEN__)
+/** @brief UART5 RX DMA circular buffer.*/
+static uint8_t sd5_rxbuf[STM32_SERIAL_DMA_RX_BUFFER_SIZE];
+#endif
+
+#if STM32_SERIAL_USART6_USE_DMA || defined(__DOXYGEN__)
+/** @brief USART6 RX DMA circular buffer.*/
+static uint8_t sd6_rxbuf[STM32_SERIAL_DMA_RX_BUFFER_SIZE];
+#endif
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if STM32_SERIAL_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the RX DMA on the circular buffer.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ */
+static void dma_rx_start(SerialDriver *sdp) {
+
+  dmaStreamDisable(sdp->dmarx);
+  sdp->rxpos = 0U;
+  sdp->rxlate = 0U;
+  dmaStreamSetMemory0(sdp->dmarx, sdp->rxbuf);
+  dmaStreamSetTransactionSize(sdp->dmarx, STM32_SERIAL_DMA_RX_BUFFER_SIZE);
+  dmaStreamSetMode(sdp->dmarx, sdp->rxdmamode  | STM32_DMA_CR_DIR_P2M |
+                               STM32_DMA_CR_MINC | STM32_DMA_CR_CIRC  |
+                               STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE);
+  dmaStreamEnable(sdp->dmarx);
+}
+
+/**
+ * @brief   Moves the data written by the RX DMA into the input queue.
+ * @details Everything between the last consumed position and the current
+ *          DMA position is transferred in a single step, the input queue
+ *          events are generated once for the whole chunk.<br>
+ *          The half and full transfer flags raised by the DMA are compared
+ *          with the buffer boundaries crossed by the consumed span, a flag
+ *          not explained by the span means that the DMA lapped the unread
+ *          data. In that case the buffer content is no more consistent,
+ *          it is discarded and @p SD_OVERRUN_ERROR is reported.
+ * @note    Must be invoked from a locked context.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] flags     RX DMA flags already read and cleared by the caller
+ */
+static void dma_rx_drain(SerialDriver *sdp, uint32_t flags) {
+  size_t wrpos, end;
+  uint32_t crossed;
+  bool overrun = false;
+
+  /* The flags must be sampled before the DMA position, a boundary crossed
+     between the two reads is accounted as late and expected later.*/
+  flags |= dmaStreamGetAndClearFlags(sdp->dmarx,
+                                     STM32_DMA_ISR_HTIF | STM32_DMA_ISR_TCIF);
+  flags &= STM32_DMA_ISR_HTIF | STM32_DMA_ISR_TCIF;
+  wrpos = STM32_SERIAL_DMA_RX_BUFFER_SIZE -
+          (size_t)dmaStreamGetTransactionSize(sdp->dmarx);
+  if (wrpos >= STM32_SERIAL_DMA_RX_BUFFER_SIZE)
+    wrpos = 0U;
+
+  /* Boundaries crossed going from the consumed position to the current
+     DMA position.*/
+  end = wrpos;
+  if (end < sdp->rxpos)
+    end += STM32_SERIAL_DMA_RX_BUFFER_SIZE;
+  crossed = 0U;
+  if (((sdp->rxpos < STM32_SERIAL_DMA_RX_BUFFER_SIZE / 2U) &&
+       (end >= STM32_SERIAL_DMA_RX_BUFFER_SIZE / 2U)) ||
+      (end >= STM32_SERIAL_DMA_RX_BUFFER_SIZE +
+              STM32_SERIAL_DMA_RX_BUFFER_SIZE / 2U))
+    crossed |= STM32_DMA_ISR_HTIF;
+  if (end >= STM32_SERIAL_DMA_RX_BUFFER_SIZE)
+    crossed |= STM32_DMA_ISR_TCIF;
+
+  /* Lap detection, the unread data has been overwritten.*/
+  if ((flags & ~(crossed | sdp->rxlate)) != 0U) {
+    sdp->rxpos = wrpos;
+    sdp->rxlate = 0U;
+    chnAddFlagsI(sdp, SD_OVERRUN_ERROR);
+    return;
+  }
+  sdp->rxlate = (sdp->rxlate | crossed) & ~flags;
+
+  if (wrpos == sdp->rxpos)
+    return;
+
+  if (iqIsEmptyI(&sdp->iqueue))
+    chnAddFlagsI(sdp, CHN_INPUT_AVAILABLE);
+  do {
+    if (iqPutI(&sdp->iqueue, sdp->rxbuf[sdp->rxpos]) < Q_OK)
+      overrun = true;
+    if (++sdp->rxpos >= STM32_SERIAL_DMA_RX_BUFFER_SIZE)
+      sdp->rxpos = 0U;
+  } while (sdp->rxpos != wrpos);
+  if (overrun)
+    chnAddFlagsI(sdp, SD_OVERRUN_ERROR);
+}
+
+/**
+ * @brief   Starts a TX DMA transfer if there is pending data.
+ * @details The DMA reads directly from the output queue buffer, the largest
+ *          contiguous span is transferred. The span is given back to the
+ *          queue only after the transfer completed.
+ * @note    Must be invoked from a locked context.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ */
+static void dma_tx_start(SerialDriver *sdp) {
+  output_queue_t *oqp = &sdp->oqueue;
+  size_t n;
+
+  if (sdp->txn > 0U)
+    return;
+  n = oqGetFullI(oqp);
+  if (n == 0U)
+    return;
+  if (n > (size_t)(oqp->q_top - oqp->q_rdptr))
+    n = (size_t)(oqp->q_top - oqp->q_rdptr);
+
+  sdp->txn = n;
+  sdp->usart->SR = ~USART_SR_TC;
+  dmaStreamSetMemory0(sdp->dmatx, oqp->q_rdptr);
+  dmaStreamSetTransactionSize(sdp->dmatx, n);
+  dmaStreamSetMode(sdp->dmatx, sdp->txdmamode  | STM32_DMA_CR_DIR_M2P |
+                               STM32_DMA_CR_MINC | STM32_DMA_CR_TCIE);
+  dmaStreamEnable(sdp->dmatx);
+}
+
+/**
+ * @brief   RX DMA half and full transfer service routine.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ */
+static void serve_rx_dma_irq(SerialDriver *sdp, uint32_t flags) {
+
+  /* DMA errors handling.*/
+#if defined(STM32_SERIAL_DMA_ERROR_HOOK)
+  if ((flags & (STM32_DMA_ISR_TEIF | STM32_DMA_ISR_DMEIF)) != 0) {
+    STM32_SERIAL_DMA_ERROR_HOOK(sdp);
+  }
+#endif
+
+  osalSysLockFromISR();
+  dma_rx_drain(sdp, flags);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   TX DMA end of transfer service routine.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] flags     pre-shifted content of the ISR register
+ */
+static void serve_tx_dma_irq(SerialDriver *sdp, uint32_t flags) {
+  output_queue_t *oqp = &sdp->oqueue;
+
+  /* DMA errors handling.*/
+#if defined(STM32_SERIAL_DMA_ERROR_HOOK)
+  if ((flags & (STM32_DMA_ISR_TEIF | STM32_DMA_ISR_DMEIF)) != 0) {
+    STM32_SERIAL_DMA_ERROR_HOOK(sdp);
+  }
+#else
+  (void)flags;
+#endif
+
+  osalSysLockFromISR();
+  dmaStreamDisable(sdp->dmatx);
+
+  /* The transmitted span is returned to the writers.*/
+  oqp->q_rdptr += sdp->txn;
+  if (oqp->q_rdptr >= oqp->q_top)
+    oqp->q_rdptr = oqp->q_buffer;
+  oqp->q_counter += sdp->txn;
+  sdp->txn = 0U;
+  osalThreadDequeueAllI(&oqp->q_waiting, Q_OK);
+
+  /* Next span, if the queue is empty then the physical transmission end
+     is notified by the USART TC interrupt.*/
+  dma_tx_start(sdp);
+  if (sdp->txn == 0U) {
+    chnAddFlagsI(sdp, CHN_OUTPUT_EMPTY);
+    sdp->usart->CR1 |= USART_CR1_TCIE;
+  }
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Allocates and prepares the DMA streams of a driver.
+ *
+ * @param[in] sdp       pointer to a @p SerialDriver object
+ * @param[in] priority  IRQ priority of the DMA streams
+ * @param[in] rxmode    RX DMA stream mode bit mask
+ * @param[in] txmode    TX DMA stream mode bit mask
+ */
+static void dma_allocate(SerialDriver *sdp, uint32_t priority,
+                         uint32_t rxmode, uint32_t txmode) {
+  bool b;
+
+  b = dmaStreamAllocate(sdp->dmarx, priority,
+                        (stm32_dmaisr_t)serve_rx_dma_irq, (void *)sdp);
+  osalDbgAssert(!b, "stream already allocated");
+  b = dmaStreamAllocate(sdp->dmatx, priority,
+                        (stm32_dmaisr_t)serve_tx_dma_irq, (void *)sdp);
+  osalDbgAssert(!b, "stream already allocated");
+  sdp->rxdmamode = rxmode;
+  sdp->txdmamode = txmode;
+  dmaStreamSetPeripheral(sdp->dmarx, &sdp->usart->DR);
+  dmaStreamSetPeripheral(sdp->dmatx, &sdp->usart->DR);
+}
+#endif /* STM32_SERIAL_USE_DMA */
+
 /**
  * @brief   USART initialization.
  * @details This function must be invoked with interrupts disabled.
@@ -113,13 +384,34 @@ static void usart_init(SerialDriver *sdp, const SerialConfig *config) {
 
   /* Note that some bits are enforced.*/
   u->CR2 = config->cr2 | USART_CR2_LBDIE;
-  u->CR3 = config->cr3 | USART_CR3_EIE;
-  u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
-                         USART_CR1_RXNEIE | USART_CR1_TE |
-                         USART_CR1_RE;
+#if STM32_SERIAL_USE_DMA
+  if (sdp->dmarx != NULL) {
+    /* The receiver DMA runs continuously on the circular buffer, bursts
+       shorter than half buffer are caught by the idle line interrupt.
+       A transmission interrupted by a restart is sent again.*/
+    dmaStreamDisable(sdp->dmatx);
+    sdp->txn = 0U;
+    dma_rx_start(sdp);
+    u->CR3 = config->cr3 | USART_CR3_EIE | USART_CR3_DMAR | USART_CR3_DMAT;
+    u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
+                           USART_CR1_IDLEIE | USART_CR1_TE |
+                           USART_CR1_RE;
+  }
+  else
+#endif
+  {
+    u->CR3 = config->cr3 | USART_CR3_EIE;
+    u->CR1 = config->cr1 | USART_CR1_UE | USART_CR1_PEIE |
+                           USART_CR1_RXNEIE | USART_CR1_TE |
+                           USART_CR1_RE;
+  }
   u->SR = 0;
   (void)u->SR;  /* SR reset step 1.*/
   (void)u->DR;  /* SR reset step 2.*/
+#if STM32_SERIAL_USE_DMA
+  if (sdp->dmatx != NULL)
+    dma_tx_start(sdp);
+#endif
 }
 
 /**
@@ -173,21 +465,44 @@ static void serve_interrupt(SerialDriver *sdp) {
     osalSysUnlockFromISR();
   }
 
-  /* Data available.*/
-  osalSysLockFromISR();
-  while (sr & (USART_SR_RXNE | USART_SR_ORE | USART_SR_NE | USART_SR_FE |
-               USART_SR_PE)) {
-    uint8_t b;
-
-    /* Error condition detection.*/
-    if (sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE  | USART_SR_PE))
-      set_error(sdp, sr);
-    b = u->DR;
-    if (sr & USART_SR_RXNE)
-      sdIncomingDataI(sdp, b);
-    sr = u->SR;
+#if STM32_SERIAL_USE_DMA
+  if (sdp->dmarx != NULL) {
+    /* Data is moved by the DMA, errors and idle line are both cleared by
+       the SR-DR read sequence. The DR read is performed by the DMA when a
+       character is pending, an explicit read is done only if RXNE is
+       clear after the SR access, this way no character can be stolen
+       from the DMA except in the few cycles between the two accesses.*/
+    if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE |
+              USART_SR_PE)) {
+      osalSysLockFromISR();
+      if (sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE  | USART_SR_PE))
+        set_error(sdp, sr);
+      if ((u->SR & USART_SR_RXNE) == 0U)
+        (void)u->DR;
+      if (sr & USART_SR_IDLE)
+        dma_rx_drain(sdp, 0U);
+      osalSysUnlockFromISR();
+    }
+  }
+  else
+#endif
+  {
+    /* Data available.*/
+    osalSysLockFromISR();
+    while (sr & (USART_SR_RXNE | USART_SR_ORE | USART_SR_NE | USART_SR_FE |
+                 USART_SR_PE)) {
+      uint8_t b;
+
+      /* Error condition detection.*/
+      if (sr & (USART_SR_ORE | USART_SR_NE | USART_SR_FE  | USART_SR_PE))
+        set_error(sdp, sr);
+      b = u->DR;
+      if (sr & USART_SR_RXNE)
+        sdIncomingDataI(sdp, b);
+      sr = u->SR;
+    }
+    osalSysUnlockFromISR();
   }
-  osalSysUnlockFromISR();
 
   /* Transmission buffer empty.*/
   if ((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)) {
@@ -218,7 +533,11 @@ static void serve_interrupt(SerialDriver *sdp) {
 static void notify1(io_queue_t *qp) {
 
   (void)qp;
+#if STM32_SERIAL_USART1_USE_DMA
+  dma_tx_start(&SD1);
+#else
   USART1->CR1 |= USART_CR1_TXEIE;
+#endif
 }
 #endif
 
@@ -226,7 +545,11 @@ static void notify1(io_queue_t *qp) {
 static void notify2(io_queue_t *qp) {
 
   (void)qp;
+#if STM32_SERIAL_USART2_USE_DMA
+  dma_tx_start(&SD2);
+#else
   USART2->CR1 |= USART_CR1_TXEIE;
+#endif
 }
 #endif
 
@@ -234,7 +557,11 @@ static void notify2(io_queue_t *qp) {
 static void notify3(io_queue_t *qp) {
 
   (void)qp;
+#if STM32_SERIAL_USART3_USE_DMA
+  dma_tx_start(&SD3);
+#else
   USART3->CR1 |= USART_CR1_TXEIE;
+#endif
 }
 #endif
 
@@ -242,7 +569,11 @@ static void notify3(io_queue_t *qp) {
 static void notify4(io_queue_t *qp) {
 
   (void)qp;
+#if STM32_SERIAL_UART4_USE_DMA
+  dma_tx_start(&SD4);
+#else
   UART4->CR1 |= USART_CR1_TXEIE;
+#endif
 }
 #endif
 
@@ -250,7 +581,11 @@ static void notify4(io_queue_t *qp) {
 static void notify5(io_queue_t *qp) {
 
   (void)qp;
+#if STM32_SERIAL_UART5_USE_DMA
+  dma_tx_start(&SD5);
+#else
   UART5->CR1 |= USART_CR1_TXEIE;
+#endif
 }
 #endif
 
@@ -258,7 +593,11 @@ static void notify5(io_queue_t *qp) {
 static void notify6(io_queue_t *qp) {
 
   (void)qp;
+#if STM32_SERIAL_USART6_USE_DMA
+  dma_tx_start(&SD6);
+#else
   USART6->CR1 |= USART_CR1_TXEIE;
+#endif
 }
 #endif
 
@@ -448,31 +787,61 @@ void sd_lld_init(void) {
 #if STM32_SERIAL_USE_USART1
   sdObjectInit(&SD1, NULL, notify1);
   SD1.usart = USART1;
+#if STM32_SERIAL_USART1_USE_DMA
+  SERIAL_DMA_INIT(SD1, USART1, sd1_rxbuf);
+#elif STM32_SERIAL_USE_DMA
+  SERIAL_DMA_INIT_NONE(SD1);
+#endif
 #endif
 
 #if STM32_SERIAL_USE_USART2
   sdObjectInit(&SD2, NULL, notify2);
   SD2.usart = USART2;
+#if STM32_SERIAL_USART2_USE_DMA
+  SERIAL_DMA_INIT(SD2, USART2, sd2_rxbuf);
+#elif STM32_SERIAL_USE_DMA
+  SERIAL_DMA_INIT_NONE(SD2);
+#endif
 #endif
 
 #if STM32_SERIAL_USE_USART3
   sdObjectInit(&SD3, NULL, notify3);
   SD3.usart = USART3;
+#if STM32_SERIAL_USART3_USE_DMA
+  SERIAL_DMA_INIT(SD3, USART3, sd3_rxbuf);
+#elif STM32_SERIAL_USE_DMA
+  SERIAL_DMA_INIT_NONE(SD3);
+#endif
 #endif
 
 #if STM32_SERIAL_USE_UART4
   sdObjectInit(&SD4, NULL, notify4);
   SD4.usart = UART4;
+#if STM32_SERIAL_UART4_USE_DMA
+  SERIAL_DMA_INIT(SD4, UART4, sd4_rxbuf);
+#elif STM32_SERIAL_USE_DMA
+  SERIAL_DMA_INIT_NONE(SD4);
+#endif
 #endif
 
 #if STM32_SERIAL_USE_UART5
   sdObjectInit(&SD5, NULL, notify5);
   SD5.usart = UART5;
+#if STM32_SERIAL_UART5_USE_DMA
+  SERIAL_DMA_INIT(SD5, UART5, sd5_rxbuf);
+#elif STM32_SERIAL_USE_DMA
+  SERIAL_DMA_INIT_NONE(SD5);
+#endif
 #endif
 
 #if STM32_SERIAL_USE_USART6
   sdObjectInit(&SD6, NULL, notify6);
   SD6.usart = USART6;
+#if STM32_SERIAL_USART6_USE_DMA
+  SERIAL_DMA_INIT(SD6, USART6, sd6_rxbuf);
+#elif STM32_SERIAL_USE_DMA
+  SERIAL_DMA_INIT_NONE(SD6);
+#endif
 #endif
 
 #if STM32_SERIAL_USE_UART7
@@ -504,36 +873,60 @@ void sd_lld_start(SerialDriver *sdp, const SerialConfig *config) {
   if (sdp->state == SD_STOP) {
 #if STM32_SERIAL_USE_USART1
     if (&SD1 == sdp) {
+#if STM32_SERIAL_USART1_USE_DMA
+      dma_allocate(sdp, STM32_SERIAL_USART1_PRIORITY,
+                   SERIAL_DMA_MODE(USART1, RX), SERIAL_DMA_MODE(USART1, TX));
+#endif
       rccEnableUSART1(FALSE);
       nvicEnableVector(STM32_USART1_NUMBER, STM32_SERIAL_USART1_PRIORITY);
     }
 #endif
 #if STM32_SERIAL_USE_USART2
     if (&SD2 == sdp) {
+#if STM32_SERIAL_USART2_USE_DMA
+      dma_allocate(sdp, STM32_SERIAL_USART2_PRIORITY,
+                   SERIAL_DMA_MODE(USART2, RX), SERIAL_DMA_MODE(USART2, TX));
+#endif
       rccEnableUSART2(FALSE);
       nvicEnableVector(STM32_USART2_NUMBER, STM32_SERIAL_USART2_PRIORITY);
     }
 #endif
 #if STM32_SERIAL_USE_USART3
     if (&SD3 == sdp) {
+#if STM32_SERIAL_USART3_USE_DMA
+      dma_allocate(sdp, STM32_SERIAL_USART3_PRIORITY,
+                   SERIAL_DMA_MODE(USART3, RX), SERIAL_DMA_MODE(USART3, TX));
+#endif
       rccEnableUSART3(FALSE);
       nvicEnableVector(STM32_USART3_NUMBER, STM32_SERIAL_USART3_PRIORITY);
     }
 #endif
 #if STM32_SERIAL_USE_UART4
     if (&SD4 == sdp) {
+#if STM32_SERIAL_UART4_USE_DMA
+      dma_allocate(sdp, STM32_SERIAL_UART4_PRIORITY,
+                   SERIAL_DMA_MODE(UART4, RX), SERIAL_DMA_MODE(UART4, TX));
+#endif
       rccEnableUART4(FALSE);
       nvicEnableVector(STM32_UART4_NUMBER, STM32_SERIAL_UART4_PRIORITY);
     }
 #endif
 #if STM32_SERIAL_USE_UART5
     if (&SD5 == sdp) {
+#if STM32_SERIAL_UART5_USE_DMA
+      dma_allocate(sdp, STM32_SERIAL_UART5_PRIORITY,
+                   SERIAL_DMA_MODE(UART5, RX), SERIAL_DMA_MODE(UART5, TX));
+#endif
       rccEnableUART5(FALSE);
       nvicEnableVector(STM32_UART5_NUMBER, STM32_SERIAL_UART5_PRIORITY);
     }
 #endif
 #if STM32_SERIAL_USE_USART6
     if (&SD6 == sdp) {
+#if STM32_SERIAL_USART6_USE_DMA
+      dma_allocate(sdp, STM32_SERIAL_USART6_PRIORITY,
+                   SERIAL_DMA_MODE(USART6, RX), SERIAL_DMA_MODE(USART6, TX));
+#endif
       rccEnableUSART6(FALSE);
       nvicEnableVector(STM32_USART6_NUMBER, STM32_SERIAL_USART6_PRIORITY);
     }
@@ -567,6 +960,15 @@ void sd_lld_stop(SerialDriver *sdp) {
 
   if (sdp->state == SD_READY) {
     usart_deinit(sdp->usart);
+#if STM32_SERIAL_USE_DMA
+    if (sdp->dmarx != NULL) {
+      dmaStreamDisable(sdp->dmarx);
+      dmaStreamDisable(sdp->dmatx);
+      dmaStreamRelease(sdp->dmarx);
+      dmaStreamRelease(sdp->dmatx);
+      sdp->txn = 0U;
+    }
+#endif
 #if STM32_SERIAL_USE_USART1
     if (&SD1 == sdp) {
       rccDisableUSART1(FALSE);
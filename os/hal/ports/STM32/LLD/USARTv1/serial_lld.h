@@ -166,6 +166,138 @@
 #if !defined(STM32_SERIAL_UART8_PRIORITY) || defined(__DOXYGEN__)
 #define STM32_SERIAL_UART8_PRIORITY         12
 #endif
+
+/**
+ * @brief   USART1 DMA mode enable switch.
+ * @details If set to @p TRUE the USART1 serial driver moves data using the
+ *          DMA streams also used by the UART driver on USART1, instead
+ *          of taking an interrupt for each byte.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(STM32_SERIAL_USART1_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART1_USE_DMA         FALSE
+#endif
+
+/**
+ * @brief   USART2 DMA mode enable switch.
+ * @details If set to @p TRUE the USART2 serial driver moves data using the
+ *          DMA streams also used by the UART driver on USART2, instead
+ *          of taking an interrupt for each byte.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(STM32_SERIAL_USART2_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART2_USE_DMA         FALSE
+#endif
+
+/**
+ * @brief   USART3 DMA mode enable switch.
+ * @details If set to @p TRUE the USART3 serial driver moves data using the
+ *          DMA streams also used by the UART driver on USART3, instead
+ *          of taking an interrupt for each byte.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(STM32_SERIAL_USART3_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART3_USE_DMA         FALSE
+#endif
+
+/**
+ * @brief   UART4 DMA mode enable switch.
+ * @details If set to @p TRUE the UART4 serial driver moves data using the
+ *          DMA streams also used by the UART driver on UART4, instead
+ *          of taking an interrupt for each byte.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(STM32_SERIAL_UART4_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_UART4_USE_DMA          FALSE
+#endif
+
+/**
+ * @brief   UART5 DMA mode enable switch.
+ * @details If set to @p TRUE the UART5 serial driver moves data using the
+ *          DMA streams also used by the UART driver on UART5, instead
+ *          of taking an interrupt for each byte.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(STM32_SERIAL_UART5_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_UART5_USE_DMA          FALSE
+#endif
+
+/**
+ * @brief   USART6 DMA mode enable switch.
+ * @details If set to @p TRUE the USART6 serial driver moves data using the
+ *          DMA streams also used by the UART driver on USART6, instead
+ *          of taking an interrupt for each byte.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(STM32_SERIAL_USART6_USE_DMA) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART6_USE_DMA         FALSE
+#endif
+
+/**
+ * @brief   USART1 DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_SERIAL_USART1_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART1_DMA_PRIORITY    0
+#endif
+
+/**
+ * @brief   USART2 DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_SERIAL_USART2_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART2_DMA_PRIORITY    0
+#endif
+
+/**
+ * @brief   USART3 DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_SERIAL_USART3_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART3_DMA_PRIORITY    0
+#endif
+
+/**
+ * @brief   UART4 DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_SERIAL_UART4_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_UART4_DMA_PRIORITY     0
+#endif
+
+/**
+ * @brief   UART5 DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_SERIAL_UART5_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_UART5_DMA_PRIORITY     0
+#endif
+
+/**
+ * @brief   USART6 DMA priority (0..3|lowest..highest).
+ */
+#if !defined(STM32_SERIAL_USART6_DMA_PRIORITY) || defined(__DOXYGEN__)
+#define STM32_SERIAL_USART6_DMA_PRIORITY    0
+#endif
+
+/**
+ * @brief   Size of the RX DMA circular buffer.
+ * @details The DMA notifies the driver each time half of this buffer has
+ *          been filled, idle line events cover the shorter bursts.
+ * @note    Must be an even number.
+ * @note    If the buffer is overwritten before being drained, because the
+ *          DMA interrupt has been delayed by more than half buffer, then
+ *          the unread data is discarded and @p SD_OVERRUN_ERROR is
+ *          reported. Delays longer than one and half buffers may go
+ *          undetected.
+ */
+#if !defined(STM32_SERIAL_DMA_RX_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define STM32_SERIAL_DMA_RX_BUFFER_SIZE     64
+#endif
+
+/**
+ * @brief   Serial DMA error hook.
+ * @note    The default action for DMA errors is a system halt because DMA
+ *          error can only happen because programming errors.
+ */
+#if !defined(STM32_SERIAL_DMA_ERROR_HOOK) || defined(__DOXYGEN__)
+#define STM32_SERIAL_DMA_ERROR_HOOK(sdp)    osalSysHalt("DMA failure")
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -251,6 +383,193 @@
 #error "Invalid IRQ priority assigned to UART8"
 #endif
 
+/**
+ * @brief   At least one USART operates in DMA mode.
+ */
+#define STM32_SERIAL_USE_DMA        (STM32_SERIAL_USART1_USE_DMA ||         \
+                                     STM32_SERIAL_USART2_USE_DMA ||         \
+                                     STM32_SERIAL_USART3_USE_DMA ||         \
+                                     STM32_SERIAL_UART4_USE_DMA  ||         \
+                                     STM32_SERIAL_UART5_USE_DMA  ||         \
+                                     STM32_SERIAL_USART6_USE_DMA)
+
+#if STM32_SERIAL_USART1_USE_DMA && !STM32_SERIAL_USE_USART1
+#error "USART1 DMA mode enabled but USART1 not assigned"
+#endif
+
+#if STM32_SERIAL_USART2_USE_DMA && !STM32_SERIAL_USE_USART2
+#error "USART2 DMA mode enabled but USART2 not assigned"
+#endif
+
+#if STM32_SERIAL_USART3_USE_DMA && !STM32_SERIAL_USE_USART3
+#error "USART3 DMA mode enabled but USART3 not assigned"
+#endif
+
+#if STM32_SERIAL_UART4_USE_DMA && !STM32_SERIAL_USE_UART4
+#error "UART4 DMA mode enabled but UART4 not assigned"
+#endif
+
+#if STM32_SERIAL_UART5_USE_DMA && !STM32_SERIAL_USE_UART5
+#error "UART5 DMA mode enabled but UART5 not assigned"
+#endif
+
+#if STM32_SERIAL_USART6_USE_DMA && !STM32_SERIAL_USE_USART6
+#error "USART6 DMA mode enabled but USART6 not assigned"
+#endif
+
+#if STM32_SERIAL_USART1_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_PRIORITY(STM32_SERIAL_USART1_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to USART1"
+#endif
+
+#if STM32_SERIAL_USART2_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_PRIORITY(STM32_SERIAL_USART2_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to USART2"
+#endif
+
+#if STM32_SERIAL_USART3_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_PRIORITY(STM32_SERIAL_USART3_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to USART3"
+#endif
+
+#if STM32_SERIAL_UART4_USE_DMA &&                                           \
+    !STM32_DMA_IS_VALID_PRIORITY(STM32_SERIAL_UART4_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to UART4"
+#endif
+
+#if STM32_SERIAL_UART5_USE_DMA &&                                           \
+    !STM32_DMA_IS_VALID_PRIORITY(STM32_SERIAL_UART5_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to UART5"
+#endif
+
+#if STM32_SERIAL_USART6_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_PRIORITY(STM32_SERIAL_USART6_DMA_PRIORITY)
+#error "Invalid DMA priority assigned to USART6"
+#endif
+
+#if STM32_SERIAL_USART1_USE_DMA &&                                          \
+    (!defined(STM32_UART_USART1_RX_DMA_STREAM) ||                           \
+     !defined(STM32_UART_USART1_TX_DMA_STREAM))
+#error "USART1 DMA streams not defined"
+#endif
+
+#if STM32_SERIAL_USART2_USE_DMA &&                                          \
+    (!defined(STM32_UART_USART2_RX_DMA_STREAM) ||                           \
+     !defined(STM32_UART_USART2_TX_DMA_STREAM))
+#error "USART2 DMA streams not defined"
+#endif
+
+#if STM32_SERIAL_USART3_USE_DMA &&                                          \
+    (!defined(STM32_UART_USART3_RX_DMA_STREAM) ||                           \
+     !defined(STM32_UART_USART3_TX_DMA_STREAM))
+#error "USART3 DMA streams not defined"
+#endif
+
+#if STM32_SERIAL_UART4_USE_DMA &&                                           \
+    (!defined(STM32_UART_UART4_RX_DMA_STREAM) ||                            \
+     !defined(STM32_UART_UART4_TX_DMA_STREAM))
+#error "UART4 DMA streams not defined"
+#endif
+
+#if STM32_SERIAL_UART5_USE_DMA &&                                           \
+    (!defined(STM32_UART_UART5_RX_DMA_STREAM) ||                            \
+     !defined(STM32_UART_UART5_TX_DMA_STREAM))
+#error "UART5 DMA streams not defined"
+#endif
+
+#if STM32_SERIAL_USART6_USE_DMA &&                                          \
+    (!defined(STM32_UART_USART6_RX_DMA_STREAM) ||                           \
+     !defined(STM32_UART_USART6_TX_DMA_STREAM))
+#error "USART6 DMA streams not defined"
+#endif
+
+#if STM32_SERIAL_USE_DMA
+#if (STM32_SERIAL_DMA_RX_BUFFER_SIZE < 2) ||                                \
+    ((STM32_SERIAL_DMA_RX_BUFFER_SIZE & 1) != 0)
+#error "STM32_SERIAL_DMA_RX_BUFFER_SIZE must be an even number"
+#endif
+
+#if STM32_ADVANCED_DMA || defined(__DOXYGEN__)
+/* Check on the validity of the assigned DMA channels.*/
+
+#if STM32_SERIAL_USART1_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART1_RX_DMA_STREAM,                 \
+                           STM32_USART1_RX_DMA_MSK)
+#error "invalid DMA stream associated to USART1 RX"
+#endif
+
+#if STM32_SERIAL_USART1_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART1_TX_DMA_STREAM,                 \
+                           STM32_USART1_TX_DMA_MSK)
+#error "invalid DMA stream associated to USART1 TX"
+#endif
+
+#if STM32_SERIAL_USART2_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART2_RX_DMA_STREAM,                 \
+                           STM32_USART2_RX_DMA_MSK)
+#error "invalid DMA stream associated to USART2 RX"
+#endif
+
+#if STM32_SERIAL_USART2_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART2_TX_DMA_STREAM,                 \
+                           STM32_USART2_TX_DMA_MSK)
+#error "invalid DMA stream associated to USART2 TX"
+#endif
+
+#if STM32_SERIAL_USART3_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART3_RX_DMA_STREAM,                 \
+                           STM32_USART3_RX_DMA_MSK)
+#error "invalid DMA stream associated to USART3 RX"
+#endif
+
+#if STM32_SERIAL_USART3_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART3_TX_DMA_STREAM,                 \
+                           STM32_USART3_TX_DMA_MSK)
+#error "invalid DMA stream associated to USART3 TX"
+#endif
+
+#if STM32_SERIAL_UART4_USE_DMA &&                                           \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_UART4_RX_DMA_STREAM,                  \
+                           STM32_UART4_RX_DMA_MSK)
+#error "invalid DMA stream associated to UART4 RX"
+#endif
+
+#if STM32_SERIAL_UART4_USE_DMA &&                                           \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_UART4_TX_DMA_STREAM,                  \
+                           STM32_UART4_TX_DMA_MSK)
+#error "invalid DMA stream associated to UART4 TX"
+#endif
+
+#if STM32_SERIAL_UART5_USE_DMA &&                                           \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_UART5_RX_DMA_STREAM,                  \
+                           STM32_UART5_RX_DMA_MSK)
+#error "invalid DMA stream associated to UART5 RX"
+#endif
+
+#if STM32_SERIAL_UART5_USE_DMA &&                                           \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_UART5_TX_DMA_STREAM,                  \
+                           STM32_UART5_TX_DMA_MSK)
+#error "invalid DMA stream associated to UART5 TX"
+#endif
+
+#if STM32_SERIAL_USART6_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART6_RX_DMA_STREAM,                 \
+                           STM32_USART6_RX_DMA_MSK)
+#error "invalid DMA stream associated to USART6 RX"
+#endif
+
+#if STM32_SERIAL_USART6_USE_DMA &&                                          \
+    !STM32_DMA_IS_VALID_ID(STM32_UART_USART6_TX_DMA_STREAM,                 \
+                           STM32_USART6_TX_DMA_MSK)
+#error "invalid DMA stream associated to USART6 TX"
+#endif
+#endif /* STM32_ADVANCED_DMA */
+
+#if !defined(STM32_DMA_REQUIRED)
+#define STM32_DMA_REQUIRED
+#endif
+#endif /* STM32_SERIAL_USE_DMA */
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -283,6 +602,31 @@ typedef struct {
   uint16_t                  cr3;
 } SerialConfig;
 
+#if STM32_SERIAL_USE_DMA || defined(__DOXYGEN__)
+/**
+ * @brief   @p SerialDriver DMA mode specific data.
+ */
+#define _serial_driver_dma_data                                             \
+  /* RX DMA stream, NULL if the USART operates in interrupt mode.*/         \
+  const stm32_dma_stream_t  *dmarx;                                         \
+  /* TX DMA stream.*/                                                       \
+  const stm32_dma_stream_t  *dmatx;                                         \
+  /* RX DMA stream mode bit mask.*/                                         \
+  uint32_t                  rxdmamode;                                      \
+  /* TX DMA stream mode bit mask.*/                                         \
+  uint32_t                  txdmamode;                                      \
+  /* RX DMA circular buffer.*/                                              \
+  uint8_t                   *rxbuf;                                         \
+  /* Next RX buffer position to be moved into the input queue.*/            \
+  size_t                    rxpos;                                          \
+  /* RX DMA HT/TC flags accounted by the last drain but not yet raised.*/   \
+  uint32_t                  rxlate;                                         \
+  /* Output queue bytes owned by the TX DMA, zero if idle.*/                \
+  size_t                    txn;
+#else
+#define _serial_driver_dma_data
+#endif
+
 /**
  * @brief   @p SerialDriver specific data.
  */
@@ -300,7 +644,8 @@ typedef struct {
   uint8_t                   ob[SERIAL_BUFFERS_SIZE];                        \
   /* End of the mandatory fields.*/                                         \
   /* Pointer to the USART registers block.*/                                \
-  USART_TypeDef             *usart;
+  USART_TypeDef             *usart;                                         \
+  _serial_driver_dma_data
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
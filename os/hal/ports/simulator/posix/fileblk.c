@@ -0,0 +1,202 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fileblk.c
+ * @brief   Posix simulator file-backed block device code.
+ *
+ * @addtogroup POSIX_FILEBLK
+ * @{
+ */
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "hal.h"
+#include "fileblk.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool fbd_is_inserted(void *ip) {
+
+  (void)ip;
+
+  return true;
+}
+
+static bool fbd_is_protected(void *ip) {
+
+  (void)ip;
+
+  return false;
+}
+
+static bool fbd_connect(void *ip) {
+  FileBlockDevice *fbdp = ip;
+  off_t size = (off_t)fbdp->blk_num * FILEBLK_BLOCK_SIZE;
+  struct stat st;
+
+  if (fbdp->state == BLK_READY)
+    return HAL_SUCCESS;
+
+  fbdp->fd = open(fbdp->path, O_RDWR | O_CREAT, 0644);
+  if (fbdp->fd < 0)
+    return HAL_FAILED;
+
+  /* The file is extended to the device size if required.*/
+  if ((fstat(fbdp->fd, &st) < 0) ||
+      ((st.st_size < size) && (ftruncate(fbdp->fd, size) < 0))) {
+    close(fbdp->fd);
+    fbdp->fd = -1;
+    return HAL_FAILED;
+  }
+
+  fbdp->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+static bool fbd_disconnect(void *ip) {
+  FileBlockDevice *fbdp = ip;
+
+  if (fbdp->state == BLK_READY) {
+    close(fbdp->fd);
+    fbdp->fd = -1;
+    fbdp->state = BLK_ACTIVE;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool fbd_read(void *ip, uint32_t startblk,
+                     uint8_t *buf, uint32_t n) {
+  FileBlockDevice *fbdp = ip;
+  size_t size = (size_t)n * FILEBLK_BLOCK_SIZE;
+  off_t offset = (off_t)startblk * FILEBLK_BLOCK_SIZE;
+
+  if ((fbdp->state != BLK_READY) || (startblk + n > fbdp->blk_num))
+    return HAL_FAILED;
+
+  fbdp->state = BLK_READING;
+  while (size > 0U) {
+    ssize_t done = pread(fbdp->fd, buf, size, offset);
+
+    if (done <= 0) {
+      fbdp->state = BLK_READY;
+      return HAL_FAILED;
+    }
+    buf    += done;
+    offset += done;
+    size   -= (size_t)done;
+  }
+  fbdp->state = BLK_READY;
+
+  fbdp->stats.reads++;
+  fbdp->stats.blocks_read += n;
+  return HAL_SUCCESS;
+}
+
+static bool fbd_write(void *ip, uint32_t startblk,
+                      const uint8_t *buf, uint32_t n) {
+  FileBlockDevice *fbdp = ip;
+  size_t size = (size_t)n * FILEBLK_BLOCK_SIZE;
+  off_t offset = (off_t)startblk * FILEBLK_BLOCK_SIZE;
+
+  if ((fbdp->state != BLK_READY) || (startblk + n > fbdp->blk_num))
+    return HAL_FAILED;
+
+  fbdp->state = BLK_WRITING;
+  while (size > 0U) {
+    ssize_t done = pwrite(fbdp->fd, buf, size, offset);
+
+    if (done <= 0) {
+      fbdp->state = BLK_READY;
+      return HAL_FAILED;
+    }
+    buf    += done;
+    offset += done;
+    size   -= (size_t)done;
+  }
+  fbdp->state = BLK_READY;
+
+  fbdp->stats.writes++;
+  fbdp->stats.blocks_written += n;
+  return HAL_SUCCESS;
+}
+
+static bool fbd_sync(void *ip) {
+  FileBlockDevice *fbdp = ip;
+
+  if (fbdp->state != BLK_READY)
+    return HAL_FAILED;
+
+  return fdatasync(fbdp->fd) < 0 ? HAL_FAILED : HAL_SUCCESS;
+}
+
+static bool fbd_get_info(void *ip, BlockDeviceInfo *bdip) {
+  FileBlockDevice *fbdp = ip;
+
+  bdip->blk_size = FILEBLK_BLOCK_SIZE;
+  bdip->blk_num  = fbdp->blk_num;
+  return HAL_SUCCESS;
+}
+
+static const struct FileBlockDeviceVMT vmt = {
+  fbd_is_inserted, fbd_is_protected, fbd_connect, fbd_disconnect,
+  fbd_read, fbd_write, fbd_sync, fbd_get_info
+};
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   File-backed block device object initialization.
+ *
+ * @param[out] fbdp     pointer to a @p FileBlockDevice object to be
+ *                      initialized
+ * @param[in] path      path of the host file
+ * @param[in] blk_num   device size in blocks
+ *
+ * @init
+ */
+void fbdObjectInit(FileBlockDevice *fbdp, const char *path,
+                   uint32_t blk_num) {
+
+  fbdp->vmt     = &vmt;
+  fbdp->state   = BLK_ACTIVE;
+  fbdp->path    = path;
+  fbdp->blk_num = blk_num;
+  fbdp->fd      = -1;
+  memset(&fbdp->stats, 0, sizeof (fileblk_stats_t));
+}
+
+/** @} */
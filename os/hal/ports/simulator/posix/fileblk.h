@@ -0,0 +1,135 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    fileblk.h
+ * @brief   Posix simulator file-backed block device header.
+ * @details The block device is stored into a host file, the file is
+ *          created if not present, it can be used as backing store for
+ *          FatFS or for benchmarking the block device stack.
+ *
+ * @addtogroup POSIX_FILEBLK
+ * @{
+ */
+
+#ifndef _FILEBLK_H_
+#define _FILEBLK_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Block size of the file-backed devices.
+ */
+#define FILEBLK_BLOCK_SIZE          512U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of the file-backed device statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Read operations.
+   */
+  uint32_t              reads;
+  /**
+   * @brief   Write operations.
+   */
+  uint32_t              writes;
+  /**
+   * @brief   Blocks read.
+   */
+  uint32_t              blocks_read;
+  /**
+   * @brief   Blocks written.
+   */
+  uint32_t              blocks_written;
+} fileblk_stats_t;
+
+/**
+ * @brief   @p FileBlockDevice specific data.
+ */
+#define _file_block_device_data                                             \
+  _base_block_device_data                                                   \
+  /* Host file path.*/                                                      \
+  const char            *path;                                              \
+  /* Device size in blocks.*/                                               \
+  uint32_t              blk_num;                                            \
+  /* Host file descriptor.*/                                                \
+  int                   fd;                                                 \
+  /* Statistics.*/                                                          \
+  fileblk_stats_t       stats;
+
+/**
+ * @brief   @p FileBlockDevice virtual methods table.
+ */
+struct FileBlockDeviceVMT {
+  _base_block_device_methods
+};
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   File-backed block device object.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct FileBlockDeviceVMT *vmt;
+  _file_block_device_data
+} FileBlockDevice;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the device statistics.
+ *
+ * @param[in] fbdp      pointer to the @p FileBlockDevice object
+ * @return              Pointer to a @p fileblk_stats_t structure.
+ *
+ * @api
+ */
+#define fbdGetStatistics(fbdp) (&(fbdp)->stats)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void fbdObjectInit(FileBlockDevice *fbdp, const char *path,
+                     uint32_t blk_num);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FILEBLK_H_ */
+
+/** @} */
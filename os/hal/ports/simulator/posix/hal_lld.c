@@ -0,0 +1,101 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_lld.c
+ * @brief   Posix simulator HAL subsystem low level driver code.
+ *
+ * @addtogroup POSIX_HAL
+ * @{
+ */
+
+#include <sys/time.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static struct timeval nextcnt;
+static struct timeval tick = {0UL, 1000000UL / CH_CFG_ST_FREQUENCY};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief Low level HAL driver initialization.
+ */
+void hal_lld_init(void) {
+
+  printf("ChibiOS/RT simulator (Linux)\n");
+  gettimeofday(&nextcnt, NULL);
+  timeradd(&nextcnt, &tick, &nextcnt);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief   Interrupt simulation.
+ */
+void _sim_check_for_interrupts(void) {
+  struct timeval tv;
+
+#if HAL_USE_MAC
+  /* The timer is checked anyway, under a continuous traffic the system
+     time would not advance.*/
+  if (mac_lld_interrupt_pending()) {
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+  }
+#endif
+
+  /* Interrupt Timer simulation.*/
+  gettimeofday(&tv, NULL);
+  if (timercmp(&tv, &nextcnt, >=)) {
+    timeradd(&nextcnt, &tick, &nextcnt);
+
+    CH_IRQ_PROLOGUE();
+
+    chSysLockFromISR();
+    chSysTimerHandlerI();
+    chSysUnlockFromISR();
+
+    CH_IRQ_EPILOGUE();
+
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+  }
+}
+
+/** @} */
@@ -0,0 +1,503 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    mac_lld.c
+ * @brief   Posix simulator MAC subsystem low level driver source.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "hal.h"
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief MAC driver 1 identifier.*/
+#if USE_SIM_MAC1 || defined(__DOXYGEN__)
+MACDriver ETHD1;
+#endif
+/** @brief MAC driver 2 identifier.*/
+#if USE_SIM_MAC2 || defined(__DOXYGEN__)
+MACDriver ETHD2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static void init(MACDriver *macp, const char *tap_name) {
+
+  macObjectInit(macp);
+  macp->tap_name = tap_name;
+  macp->fd       = -1;
+}
+
+static void tap_open(MACDriver *macp) {
+  struct ifreq ifr;
+
+  macp->fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+  if (macp->fd < 0) {
+    printf("%s: Unable to open /dev/net/tun\n", macp->tap_name);
+    goto abort;
+  }
+
+  memset(&ifr, 0, sizeof(ifr));
+  ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+  strncpy(ifr.ifr_name, macp->tap_name, IFNAMSIZ - 1);
+  if (ioctl(macp->fd, TUNSETIFF, &ifr) < 0) {
+    printf("%s: Unable to attach to the TAP device\n", macp->tap_name);
+    goto abort;
+  }
+  printf("MAC attached to TAP device %s\n", macp->tap_name);
+  fflush(stdout);
+  return;
+
+abort:
+  if (macp->fd >= 0)
+    close(macp->fd);
+  exit(1);
+}
+
+static bool rxint(MACDriver *macp) {
+  bool received = false;
+
+  if ((macp->state != MAC_ACTIVE) || (macp->fd < 0))
+    return false;
+
+  /* Frames are moved from the TAP device into the free receive buffers,
+     when the ring is full the frames are left queued in the host.*/
+  while (macp->rxbufs[macp->rxwr].state == SIM_MAC_BUFFER_FREE) {
+    sim_mac_buffer_t *bufp = &macp->rxbufs[macp->rxwr];
+    ssize_t n = read(macp->fd, bufp->data, sizeof(bufp->data));
+
+    if (n <= 0)
+      break;
+    bufp->size  = (size_t)n;
+    bufp->state = SIM_MAC_BUFFER_FILLED;
+    macp->rxwr  = (macp->rxwr + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+    received    = true;
+  }
+
+  if (!received || !macp->rxie)
+    return false;
+
+#if MAC_USE_RX_MITIGATION
+  macp->rxie = false;
+#endif
+  _mac_isr_receive_code(macp);
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level MAC initialization.
+ *
+ * @notapi
+ */
+void mac_lld_init(void) {
+
+#if USE_SIM_MAC1
+  init(&ETHD1, SIM_MAC1_TAP_NAME);
+#endif
+#if USE_SIM_MAC2
+  init(&ETHD2, SIM_MAC2_TAP_NAME);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_start(MACDriver *macp) {
+  unsigned i;
+
+  for (i = 0; i < SIM_MAC_RECEIVE_BUFFERS; i++)
+    macp->rxbufs[i].state = SIM_MAC_BUFFER_FREE;
+  for (i = 0; i < SIM_MAC_TRANSMIT_BUFFERS; i++)
+    macp->txbufs[i].state = SIM_MAC_BUFFER_FREE;
+  macp->rxie  = true;
+  macp->rxwr  = 0;
+  macp->rxrd  = 0;
+  macp->txptr = 0;
+
+  if (macp->fd < 0)
+    tap_open(macp);
+}
+
+/**
+ * @brief   Deactivates the MAC peripheral.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ *
+ * @notapi
+ */
+void mac_lld_stop(MACDriver *macp) {
+
+  if (macp->fd >= 0) {
+    close(macp->fd);
+    macp->fd = -1;
+  }
+}
+
+/**
+ * @brief   Returns a transmission descriptor.
+ * @details One of the available transmission descriptors is locked and
+ *          returned.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] tdp      pointer to a @p MACTransmitDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                      MACTransmitDescriptor *tdp) {
+  sim_mac_buffer_t *bufp;
+
+  osalSysLock();
+
+  bufp = &macp->txbufs[macp->txptr];
+  if (bufp->state != SIM_MAC_BUFFER_FREE) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+  bufp->state = SIM_MAC_BUFFER_LOCKED;
+  macp->txptr = (macp->txptr + 1U) % SIM_MAC_TRANSMIT_BUFFERS;
+
+  osalSysUnlock();
+
+  tdp->offset = 0;
+  tdp->size   = SIM_MAC_BUFFERS_SIZE;
+  tdp->macp   = macp;
+  tdp->bufp   = bufp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a transmit descriptor and starts the transmission of the
+ *          enqueued data as a single frame.
+ * @note    The frame is written to the TAP device synchronously, frames
+ *          refused by the host are dropped as if lost on the wire.
+ *
+ * @param[in] tdp       the pointer to the @p MACTransmitDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp) {
+
+  osalDbgAssert(tdp->bufp->state == SIM_MAC_BUFFER_LOCKED,
+                "attempt to release a free descriptor");
+
+  (void)write(tdp->macp->fd, tdp->bufp->data, tdp->offset);
+
+  osalSysLock();
+  tdp->bufp->state = SIM_MAC_BUFFER_FREE;
+  osalThreadDequeueAllI(&tdp->macp->tdqueue, MSG_RESET);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns a receive descriptor.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                     MACReceiveDescriptor *rdp) {
+  sim_mac_buffer_t *bufp;
+
+  osalSysLock();
+
+  bufp = &macp->rxbufs[macp->rxrd];
+  if (bufp->state != SIM_MAC_BUFFER_FILLED) {
+    osalSysUnlock();
+    return MSG_TIMEOUT;
+  }
+  bufp->state = SIM_MAC_BUFFER_LOCKED;
+  macp->rxrd  = (macp->rxrd + 1U) % SIM_MAC_RECEIVE_BUFFERS;
+
+  osalSysUnlock();
+
+  rdp->offset = 0;
+  rdp->size   = bufp->size;
+  rdp->bufp   = bufp;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Releases a receive descriptor.
+ * @details The descriptor and its buffer are made available for more incoming
+ *          frames.
+ *
+ * @param[in] rdp       the pointer to the @p MACReceiveDescriptor structure
+ *
+ * @notapi
+ */
+void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp) {
+
+  osalDbgAssert(rdp->bufp->state == SIM_MAC_BUFFER_LOCKED,
+                "attempt to release a free descriptor");
+
+  osalSysLock();
+  rdp->bufp->state = SIM_MAC_BUFFER_FREE;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Updates and returns the link status.
+ * @details The link is reported up while the host side of the TAP device
+ *          is up.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The link status.
+ * @retval true         if the link is active.
+ * @retval false        if the link is down.
+ *
+ * @notapi
+ */
+bool mac_lld_poll_link_status(MACDriver *macp) {
+  struct ifreq ifr;
+  int sock;
+  bool up = false;
+
+  sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0)
+    return false;
+
+  memset(&ifr, 0, sizeof(ifr));
+  strncpy(ifr.ifr_name, macp->tap_name, IFNAMSIZ - 1);
+  if (ioctl(sock, SIOCGIFFLAGS, &ifr) == 0)
+    up = (ifr.ifr_flags & IFF_UP) != 0;
+  close(sock);
+
+  return up;
+}
+
+/**
+ * @brief   Writes to a transmit descriptor's stream.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] buf       pointer to the buffer containing the data to be
+ *                      written
+ * @param[in] size      number of bytes to be written
+ * @return              The number of bytes written into the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if the maximum
+ *                      frame size is reached.
+ *
+ * @notapi
+ */
+size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                         uint8_t *buf,
+                                         size_t size) {
+
+  if (size > tdp->size - tdp->offset)
+    size = tdp->size - tdp->offset;
+
+  if (size > 0) {
+    memcpy(tdp->bufp->data + tdp->offset, buf, size);
+    tdp->offset += size;
+  }
+  return size;
+}
+
+/**
+ * @brief   Reads from a receive descriptor's stream.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[in] buf       pointer to the buffer that will receive the read data
+ * @param[in] size      number of bytes to be read
+ * @return              The number of bytes read from the descriptor's
+ *                      stream, this value can be less than the amount
+ *                      specified in the parameter @p size if there are
+ *                      no more bytes to read.
+ *
+ * @notapi
+ */
+size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                       uint8_t *buf,
+                                       size_t size) {
+
+  if (size > rdp->size - rdp->offset)
+    size = rdp->size - rdp->offset;
+
+  if (size > 0) {
+    memcpy(buf, rdp->bufp->data + rdp->offset, size);
+    rdp->offset += size;
+  }
+  return size;
+}
+
+#if MAC_USE_RX_MITIGATION || defined(__DOXYGEN__)
+/**
+ * @brief   Enables the receive interrupt again.
+ * @details Invoked when the consumer found the receive ring empty. If a
+ *          frame has been received meanwhile the interrupt is left
+ *          disabled and the consumer must keep polling.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @return              The ring status.
+ * @retval false        if the interrupt has been enabled.
+ * @retval true         if frames are pending in the ring.
+ *
+ * @notapi
+ */
+bool mac_lld_resume_receive_interrupt(MACDriver *macp) {
+  bool pending;
+
+  osalSysLock();
+  pending = macp->rxbufs[macp->rxrd].state == SIM_MAC_BUFFER_FILLED;
+  macp->rxie = !pending;
+  osalSysUnlock();
+
+  return pending;
+}
+#endif /* MAC_USE_RX_MITIGATION */
+
+#if MAC_USE_ZERO_COPY || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a pointer to the next transmit buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that enough buffers can be requested to fill
+ *          a whole frame.
+ *
+ * @param[in] tdp       pointer to a @p MACTransmitDescriptor structure
+ * @param[in] size      size of the requested buffer. Specify the frame size
+ *                      on the first call then scale the value down subtracting
+ *                      the amount of data already copied into the previous
+ *                      buffers.
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                          size_t size,
+                                          size_t *sizep) {
+
+  if (tdp->offset == 0) {
+    if (size > tdp->size)
+      size = tdp->size;
+    *sizep      = tdp->size;
+    tdp->offset = size;
+    return tdp->bufp->data;
+  }
+  *sizep = 0;
+  return NULL;
+}
+
+/**
+ * @brief   Returns a pointer to the next receive buffer in the descriptor
+ *          chain.
+ * @note    The API guarantees that the descriptor chain contains a whole
+ *          frame.
+ *
+ * @param[in] rdp       pointer to a @p MACReceiveDescriptor structure
+ * @param[out] sizep    pointer to variable receiving the buffer size, it is
+ *                      zero when the last buffer has already been returned.
+ * @return              Pointer to the returned buffer.
+ * @retval NULL         if the buffer chain has been entirely scanned.
+ *
+ * @notapi
+ */
+const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                               size_t *sizep) {
+
+  if (rdp->size > 0) {
+    *sizep      = rdp->size;
+    rdp->offset = rdp->size;
+    rdp->size   = 0;
+    return rdp->bufp->data;
+  }
+  *sizep = 0;
+  return NULL;
+}
+#endif /* MAC_USE_ZERO_COPY */
+
+/**
+ * @brief   MAC interrupts simulation.
+ * @details Moves the frames received by the TAP devices into the receive
+ *          buffers and wakes up the waiting threads.
+ *
+ * @return              The interrupt status.
+ * @retval true         if frames have been received.
+ * @retval false        if there was no activity.
+ *
+ * @notapi
+ */
+bool mac_lld_interrupt_pending(void) {
+  bool b = false;
+
+  CH_IRQ_PROLOGUE();
+
+#if USE_SIM_MAC1
+  b = rxint(&ETHD1) || b;
+#endif
+#if USE_SIM_MAC2
+  b = rxint(&ETHD2) || b;
+#endif
+
+  CH_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_MAC */
+
+/** @} */
@@ -0,0 +1,317 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    mac_lld.h
+ * @brief   Posix simulator MAC subsystem low level driver header.
+ * @details The simulated interfaces are attached to Linux TAP devices, the
+ *          host side of each interface can be bridged or configured as any
+ *          other network interface.
+ *
+ * @addtogroup POSIX_MAC
+ * @{
+ */
+
+#ifndef _MAC_LLD_H_
+#define _MAC_LLD_H_
+
+#if HAL_USE_MAC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   This implementation supports the zero-copy mode API.
+ */
+#define MAC_SUPPORTS_ZERO_COPY      TRUE
+
+/**
+ * @brief   This implementation supports the receive interrupt mitigation.
+ */
+#define MAC_SUPPORTS_RX_MITIGATION  TRUE
+
+/**
+ * @name    Simulated buffer states
+ * @{
+ */
+#define SIM_MAC_BUFFER_FREE         0U
+#define SIM_MAC_BUFFER_FILLED       1U
+#define SIM_MAC_BUFFER_LOCKED       2U
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   ETHD1 driver enable switch.
+ */
+#if !defined(USE_SIM_MAC1) || defined(__DOXYGEN__)
+#define USE_SIM_MAC1                        TRUE
+#endif
+
+/**
+ * @brief   ETHD2 driver enable switch.
+ */
+#if !defined(USE_SIM_MAC2) || defined(__DOXYGEN__)
+#define USE_SIM_MAC2                        FALSE
+#endif
+
+/**
+ * @brief   TAP device attached to ETHD1.
+ */
+#if !defined(SIM_MAC1_TAP_NAME) || defined(__DOXYGEN__)
+#define SIM_MAC1_TAP_NAME                   "tap0"
+#endif
+
+/**
+ * @brief   TAP device attached to ETHD2.
+ */
+#if !defined(SIM_MAC2_TAP_NAME) || defined(__DOXYGEN__)
+#define SIM_MAC2_TAP_NAME                   "tap1"
+#endif
+
+/**
+ * @brief   Number of available transmit buffers.
+ */
+#if !defined(SIM_MAC_TRANSMIT_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_TRANSMIT_BUFFERS            2
+#endif
+
+/**
+ * @brief   Number of available receive buffers.
+ */
+#if !defined(SIM_MAC_RECEIVE_BUFFERS) || defined(__DOXYGEN__)
+#define SIM_MAC_RECEIVE_BUFFERS             4
+#endif
+
+/**
+ * @brief   Maximum supported frame size.
+ */
+#if !defined(SIM_MAC_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define SIM_MAC_BUFFERS_SIZE                1522
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if !USE_SIM_MAC1 && !USE_SIM_MAC2
+#error "MAC driver activated but no simulated interface assigned"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a simulated frame buffer.
+ */
+typedef struct {
+  /**
+   * @brief Buffer state.
+   */
+  uint8_t               state;
+  /**
+   * @brief Size of the frame in the buffer.
+   */
+  size_t                size;
+  /**
+   * @brief Frame data.
+   */
+  uint8_t               data[SIM_MAC_BUFFERS_SIZE];
+} sim_mac_buffer_t;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief MAC address.
+   */
+  uint8_t               *mac_address;
+  /* End of the mandatory fields.*/
+} MACConfig;
+
+/**
+ * @brief   Structure representing a MAC driver.
+ */
+struct MACDriver {
+  /**
+   * @brief Driver state.
+   */
+  macstate_t            state;
+  /**
+   * @brief Current configuration data.
+   */
+  const MACConfig       *config;
+  /**
+   * @brief Transmit semaphore.
+   */
+  threads_queue_t       tdqueue;
+  /**
+   * @brief Receive semaphore.
+   */
+  threads_queue_t       rdqueue;
+#if MAC_USE_EVENTS || defined(__DOXYGEN__)
+  /**
+   * @brief Receive event.
+   */
+  event_source_t        rdevent;
+#endif
+#if MAC_USE_RX_MITIGATION || defined(__DOXYGEN__)
+  /**
+   * @brief Receive interrupt mitigation statistics.
+   */
+  mac_rx_stats_t        rxstats;
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief TAP device name.
+   */
+  const char            *tap_name;
+  /**
+   * @brief TAP device file descriptor.
+   */
+  int                   fd;
+  /**
+   * @brief Simulated receive interrupt enable.
+   */
+  bool                  rxie;
+  /**
+   * @brief Next receive buffer to be filled.
+   */
+  unsigned              rxwr;
+  /**
+   * @brief Next receive buffer to be returned.
+   */
+  unsigned              rxrd;
+  /**
+   * @brief Next transmit buffer to be returned.
+   */
+  unsigned              txptr;
+  /**
+   * @brief Receive buffers.
+   */
+  sim_mac_buffer_t      rxbufs[SIM_MAC_RECEIVE_BUFFERS];
+  /**
+   * @brief Transmit buffers.
+   */
+  sim_mac_buffer_t      txbufs[SIM_MAC_TRANSMIT_BUFFERS];
+};
+
+/**
+ * @brief   Structure representing a transmit descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current write offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available space size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Owner driver.
+   */
+  MACDriver             *macp;
+  /**
+   * @brief Pointer to the buffer.
+   */
+  sim_mac_buffer_t      *bufp;
+} MACTransmitDescriptor;
+
+/**
+ * @brief   Structure representing a receive descriptor.
+ */
+typedef struct {
+  /**
+   * @brief Current read offset.
+   */
+  size_t                offset;
+  /**
+   * @brief Available data size.
+   */
+  size_t                size;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief Pointer to the buffer.
+   */
+  sim_mac_buffer_t      *bufp;
+} MACReceiveDescriptor;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if USE_SIM_MAC1 && !defined(__DOXYGEN__)
+extern MACDriver ETHD1;
+#endif
+#if USE_SIM_MAC2 && !defined(__DOXYGEN__)
+extern MACDriver ETHD2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mac_lld_init(void);
+  void mac_lld_start(MACDriver *macp);
+  void mac_lld_stop(MACDriver *macp);
+  msg_t mac_lld_get_transmit_descriptor(MACDriver *macp,
+                                        MACTransmitDescriptor *tdp);
+  void mac_lld_release_transmit_descriptor(MACTransmitDescriptor *tdp);
+  msg_t mac_lld_get_receive_descriptor(MACDriver *macp,
+                                       MACReceiveDescriptor *rdp);
+  void mac_lld_release_receive_descriptor(MACReceiveDescriptor *rdp);
+  bool mac_lld_poll_link_status(MACDriver *macp);
+  size_t mac_lld_write_transmit_descriptor(MACTransmitDescriptor *tdp,
+                                           uint8_t *buf,
+                                           size_t size);
+  size_t mac_lld_read_receive_descriptor(MACReceiveDescriptor *rdp,
+                                         uint8_t *buf,
+                                         size_t size);
+#if MAC_USE_ZERO_COPY
+  uint8_t *mac_lld_get_next_transmit_buffer(MACTransmitDescriptor *tdp,
+                                            size_t size,
+                                            size_t *sizep);
+  const uint8_t *mac_lld_get_next_receive_buffer(MACReceiveDescriptor *rdp,
+                                                 size_t *sizep);
+#endif /* MAC_USE_ZERO_COPY */
+#if MAC_USE_RX_MITIGATION
+  bool mac_lld_resume_receive_interrupt(MACDriver *macp);
+#endif
+  bool mac_lld_interrupt_pending(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_MAC */
+
+#endif /* _MAC_LLD_H_ */
+
+/** @} */
@@ -0,0 +1,11 @@
+# List of all the Posix platform files.
+PLATFORMSRC = ${CHIBIOS}/os/hal/ports/simulator/posix/hal_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/posix/mac_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/posix/fileblk.c \
+              ${CHIBIOS}/os/hal/ports/simulator/console.c \
+              ${CHIBIOS}/os/hal/ports/simulator/pal_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/st_lld.c
+
+# Required include directories
+PLATFORMINC = ${CHIBIOS}/os/hal/ports/simulator/posix \
+              ${CHIBIOS}/os/hal/ports/simulator
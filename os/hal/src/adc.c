@@ -22,6 +22,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 
 #if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
@@ -30,6 +32,20 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if (ADC_USE_STREAMING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Stream blocks time stamp.
+ * @details The realtime counter is used if supported by the port, the
+ *          system time otherwise.
+ */
+#if (defined(PORT_SUPPORTS_RT) && (PORT_SUPPORTS_RT == TRUE)) ||             \
+    defined(__DOXYGEN__)
+#define ADC_STREAM_STAMP()          osalOsGetRealtimeCounterX()
+#else
+#define ADC_STREAM_STAMP()          ((rtcnt_t)osalOsGetSystemTimeX())
+#endif
+#endif /* ADC_USE_STREAMING == TRUE */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -75,6 +91,9 @@ void adcObjectInit(ADCDriver *adcp) {
 #if ADC_USE_WAIT == TRUE
   adcp->thread   = NULL;
 #endif
+#if ADC_USE_STREAMING == TRUE
+  adcp->stream   = NULL;
+#endif
 #if ADC_USE_MUTUAL_EXCLUSION == TRUE
   osalMutexObjectInit(&adcp->mutex);
 #endif
@@ -210,6 +229,10 @@ void adcStopConversion(ADCDriver *adcp) {
     adcp->grpp  = NULL;
     adcp->state = ADC_READY;
     _adc_reset_s(adcp);
+#if ADC_USE_STREAMING == TRUE
+    _adc_stream_reset_i(adcp, MSG_RESET);
+    osalOsRescheduleS();
+#endif
   }
   osalSysUnlock();
 }
@@ -238,6 +261,7 @@ void adcStopConversionI(ADCDriver *adcp) {
     adcp->grpp  = NULL;
     adcp->state = ADC_READY;
     _adc_reset_i(adcp);
+    _adc_stream_reset_i(adcp, MSG_RESET);
   }
 }
 
@@ -316,6 +340,229 @@ void adcReleaseBus(ADCDriver *adcp) {
 }
 #endif /* ADC_USE_MUTUAL_EXCLUSION == TRUE */
 
+#if (ADC_USE_STREAMING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an @p ADCStream object.
+ * @note    The ring buffer must be able to contain @p nblocks blocks and
+ *          the conversion buffer two blocks, a block is a matrix of
+ *          channels number per @p depth samples.
+ *
+ * @param[out] strp     pointer to the @p ADCStream object
+ * @param[in] blocks    pointer to an array of @p nblocks block descriptors
+ * @param[in] nblocks   number of blocks in the ring
+ * @param[in] ring      pointer to the ring samples buffer
+ * @param[in] dmabuf    pointer to the conversion double buffer
+ * @param[in] depth     depth of a block (matrix rows number)
+ *
+ * @init
+ */
+void adcStreamObjectInit(ADCStream *strp, ADCStreamBlock *blocks,
+                         size_t nblocks, adcsample_t *ring,
+                         adcsample_t *dmabuf, size_t depth) {
+
+  osalDbgCheck((strp != NULL) && (blocks != NULL) && (nblocks > 0U) &&
+               (ring != NULL) && (dmabuf != NULL) && (depth > 0U));
+
+  strp->blocks   = blocks;
+  strp->nblocks  = nblocks;
+  strp->ring     = ring;
+  strp->dmabuf   = dmabuf;
+  strp->depth    = depth;
+  strp->head     = 0U;
+  strp->tail     = 0U;
+  strp->count    = 0U;
+  strp->seq      = 0U;
+  strp->overruns = 0U;
+  strp->active   = false;
+  strp->thread   = NULL;
+}
+
+/**
+ * @brief   Starts an ADC stream.
+ * @details Starts a continuous circular conversion feeding the stream ring,
+ *          the filled blocks are retrieved using @p adcStreamGet().
+ * @post    The conversion group callback, if any, is invoked for each
+ *          completed half of the conversion buffer.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] grpp      pointer to a circular @p ADCConversionGroup object
+ * @param[in] strp      pointer to the @p ADCStream object
+ *
+ * @api
+ */
+void adcStartStream(ADCDriver *adcp,
+                    const ADCConversionGroup *grpp,
+                    ADCStream *strp) {
+
+  osalSysLock();
+  adcStartStreamI(adcp, grpp, strp);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Starts an ADC stream.
+ * @details Starts a continuous circular conversion feeding the stream ring,
+ *          the filled blocks are retrieved using @p adcStreamGet().
+ * @post    The conversion group callback, if any, is invoked for each
+ *          completed half of the conversion buffer.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] grpp      pointer to a circular @p ADCConversionGroup object
+ * @param[in] strp      pointer to the @p ADCStream object
+ *
+ * @iclass
+ */
+void adcStartStreamI(ADCDriver *adcp,
+                     const ADCConversionGroup *grpp,
+                     ADCStream *strp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((adcp != NULL) && (grpp != NULL) && (strp != NULL) &&
+               grpp->circular);
+  osalDbgAssert(!strp->active, "stream already active");
+
+  strp->head     = 0U;
+  strp->tail     = 0U;
+  strp->count    = 0U;
+  strp->seq      = 0U;
+  strp->overruns = 0U;
+  strp->active   = true;
+  adcStartConversionI(adcp, grpp, strp->dmabuf, strp->depth * 2U);
+  adcp->stream   = strp;
+}
+
+/**
+ * @brief   Gets the oldest filled block of a stream.
+ * @details The block is accessed in place, it is not overwritten by the
+ *          conversion until it is returned using @p adcStreamRelease().
+ *          Invoking this function again without releasing the block
+ *          returns the same block.
+ * @note    After the stream has been stopped the remaining filled blocks
+ *          can still be retrieved.
+ *
+ * @param[in] strp      pointer to the @p ADCStream object
+ * @param[out] bpp      pointer to a block descriptor pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation result.
+ * @retval MSG_OK       if a block has been returned.
+ * @retval MSG_RESET    if the stream has been stopped using
+ *                      @p adcStopConversion() or @p adcStopConversionI().
+ * @retval MSG_TIMEOUT  if a timeout occurred or if the stream has been
+ *                      stopped because an hardware error.
+ *
+ * @api
+ */
+msg_t adcStreamGet(ADCStream *strp, ADCStreamBlock **bpp,
+                   systime_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((strp != NULL) && (bpp != NULL));
+
+  osalSysLock();
+  if (strp->count == 0U) {
+    if (!strp->active) {
+      osalSysUnlock();
+      return MSG_RESET;
+    }
+    msg = osalThreadSuspendTimeoutS(&strp->thread, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+  *bpp = &strp->blocks[strp->tail];
+  osalSysUnlock();
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Returns the oldest filled block to the stream ring.
+ *
+ * @param[in] strp      pointer to the @p ADCStream object
+ *
+ * @api
+ */
+void adcStreamRelease(ADCStream *strp) {
+
+  osalDbgCheck(strp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(strp->count > 0U, "no block");
+  if (++strp->tail >= strp->nblocks) {
+    strp->tail = 0U;
+  }
+  strp->count--;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Returns the number of blocks dropped since the stream start.
+ * @details Blocks are dropped when the conversion completes a block while
+ *          the ring is full because the consumer is lagging.
+ *
+ * @param[in] strp      pointer to the @p ADCStream object
+ * @return              The number of dropped blocks.
+ *
+ * @xclass
+ */
+uint32_t adcStreamGetOverruns(ADCStream *strp) {
+
+  osalDbgCheck(strp != NULL);
+
+  return strp->overruns;
+}
+
+/**
+ * @brief   Moves a completed half buffer into the stream ring.
+ * @details The samples are copied into the next free block, if the ring is
+ *          full then the block is dropped and accounted as an overrun.
+ * @note    This function is meant to be invoked from the low level drivers
+ *          ISR code through @p _adc_stream_isr().
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[in] buf       pointer to the completed half buffer
+ *
+ * @notapi
+ */
+void _adc_stream_push(ADCDriver *adcp, const adcsample_t *buf) {
+  ADCStream *strp = adcp->stream;
+  size_t n = strp->depth * (size_t)adcp->grpp->num_channels;
+  rtcnt_t stamp = ADC_STREAM_STAMP();
+  ADCStreamBlock *bp;
+
+  osalSysLockFromISR();
+  if (strp->count >= strp->nblocks) {
+    strp->overruns++;
+    strp->seq++;
+    osalSysUnlockFromISR();
+    return;
+  }
+  bp = &strp->blocks[strp->head];
+  osalSysUnlockFromISR();
+
+  /* The block at the head is not visible to the consumer until the count
+     is incremented so the copy is performed outside the critical zone.*/
+  bp->samples = strp->ring + (strp->head * n);
+  bp->seq     = strp->seq;
+  bp->stamp   = stamp;
+  memcpy(bp->samples, buf, n * sizeof(adcsample_t));
+
+  osalSysLockFromISR();
+  strp->seq++;
+  if (++strp->head >= strp->nblocks) {
+    strp->head = 0U;
+  }
+  strp->count++;
+  osalThreadResumeI(&strp->thread, MSG_OK);
+  osalSysUnlockFromISR();
+}
+#endif /* ADC_USE_STREAMING == TRUE */
+
 #endif /* HAL_USE_ADC == TRUE */
 
 /** @} */
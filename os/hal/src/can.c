@@ -30,6 +30,20 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if (CAN_USE_RX_FIFO == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Received frames time stamp.
+ * @details The realtime counter is used if supported by the port, the
+ *          system time otherwise.
+ */
+#if (defined(PORT_SUPPORTS_RT) && (PORT_SUPPORTS_RT == TRUE)) ||             \
+    defined(__DOXYGEN__)
+#define CAN_RX_STAMP()              osalOsGetRealtimeCounterX()
+#else
+#define CAN_RX_STAMP()              ((rtcnt_t)osalOsGetSystemTimeX())
+#endif
+#endif /* CAN_USE_RX_FIFO == TRUE */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -42,6 +56,26 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (CAN_USE_RX_FIFO == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Fetches a frame from a software FIFO.
+ * @pre     The FIFO must not be empty.
+ *
+ * @param[in] fifop     pointer to the @p CANRxFifo object
+ * @param[out] crfp     pointer to the buffer where the frame is copied
+ *
+ * @notapi
+ */
+static void can_rx_fifo_get(CANRxFifo *fifop, CANRxTimedFrame *crfp) {
+
+  *crfp = fifop->buffer[fifop->tail];
+  if (++fifop->tail >= fifop->size) {
+    fifop->tail = 0U;
+  }
+  fifop->count--;
+}
+#endif /* CAN_USE_RX_FIFO == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -78,6 +112,9 @@ void canObjectInit(CANDriver *canp) {
   osalEventObjectInit(&canp->sleep_event);
   osalEventObjectInit(&canp->wakeup_event);
 #endif
+#if CAN_USE_RX_FIFO == TRUE
+  canp->rxfifo = NULL;
+#endif
 }
 
 /**
@@ -103,6 +140,15 @@ void canStart(CANDriver *canp, const CANConfig *config) {
   canp->state = CAN_STARTING;
   canp->config = config;
 
+#if CAN_USE_RX_FIFO == TRUE
+  /* Frames left from a previous session are discarded.*/
+  if (canp->rxfifo != NULL) {
+    canp->rxfifo->head  = 0U;
+    canp->rxfifo->tail  = 0U;
+    canp->rxfifo->count = 0U;
+  }
+#endif
+
   /* Low level initialization, could be a slow process and sleeps could
      be performed inside.*/
   can_lld_start(canp);
@@ -197,6 +243,22 @@ bool canTryReceiveI(CANDriver *canp,
   osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
                 "invalid state");
 
+#if CAN_USE_RX_FIFO == TRUE
+  /* Frames are fetched from the software FIFO, if any.*/
+  if (canp->rxfifo != NULL) {
+    CANRxTimedFrame crf;
+
+    osalDbgAssert(mailbox == CAN_ANY_MAILBOX, "FIFO is not per mailbox");
+
+    if (canp->rxfifo->count == 0U) {
+      return true;
+    }
+    can_rx_fifo_get(canp->rxfifo, &crf);
+    *crfp = crf.frame;
+    return false;
+  }
+#endif
+
   /* If the RX mailbox is empty then the function fails.*/
   if (!can_lld_is_rx_nonempty(canp, mailbox)) {
     return true;
@@ -289,6 +351,27 @@ msg_t canReceive(CANDriver *canp,
   osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
                 "invalid state");
 
+#if CAN_USE_RX_FIFO == TRUE
+  /* Frames are fetched from the software FIFO, if any.*/
+  if (canp->rxfifo != NULL) {
+    CANRxTimedFrame crf;
+
+    osalDbgAssert(mailbox == CAN_ANY_MAILBOX, "FIFO is not per mailbox");
+
+    while ((canp->state == CAN_SLEEP) || (canp->rxfifo->count == 0U)) {
+      msg_t msg = osalThreadEnqueueTimeoutS(&canp->rxqueue, timeout);
+      if (msg != MSG_OK) {
+        osalSysUnlock();
+        return msg;
+      }
+    }
+    can_rx_fifo_get(canp->rxfifo, &crf);
+    osalSysUnlock();
+    *crfp = crf.frame;
+    return MSG_OK;
+  }
+#endif
+
   /*lint -save -e9007 [13.5] Right side is supposed to be pure.*/
   while ((canp->state == CAN_SLEEP) || !can_lld_is_rx_nonempty(canp, mailbox)) {
   /*lint -restore*/
@@ -356,6 +439,175 @@ void canWakeup(CANDriver *canp) {
 }
 #endif /* CAN_USE_SLEEP_MODE == TRUE */
 
+#if (CAN_USE_RX_FIFO == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a @p CANRxFifo object.
+ *
+ * @param[out] fifop    pointer to the @p CANRxFifo object
+ * @param[in] buffer    pointer to the frames buffer
+ * @param[in] size      number of frames in the buffer, this is the FIFO depth
+ *
+ * @init
+ */
+void canRxFifoObjectInit(CANRxFifo *fifop, CANRxTimedFrame *buffer,
+                         size_t size) {
+
+  osalDbgCheck((fifop != NULL) && (buffer != NULL) && (size > 0U));
+
+  fifop->buffer   = buffer;
+  fifop->size     = size;
+  fifop->head     = 0U;
+  fifop->tail     = 0U;
+  fifop->count    = 0U;
+  fifop->overruns = 0U;
+}
+
+/**
+ * @brief   Associates a software receive FIFO to the driver.
+ * @details While a FIFO is associated the receive ISR moves the frames from
+ *          the hardware mailboxes into the FIFO as soon they are received,
+ *          @p canReceive(), @p canTryReceiveI() and @p canReceiveMany()
+ *          fetch the frames from the FIFO.
+ * @note    The @p rxfull_event event is broadcasted each time frames are
+ *          moved into the FIFO.
+ * @note    The FIFO is not per mailbox, receive functions must be invoked
+ *          using @p CAN_ANY_MAILBOX.
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] fifop     pointer to the @p CANRxFifo object or @p NULL for
+ *                      no FIFO
+ *
+ * @api
+ */
+void canSetRxFifo(CANDriver *canp, CANRxFifo *fifop) {
+
+  osalDbgCheck(canp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(canp->state == CAN_STOP, "invalid state");
+  canp->rxfifo = fifop;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Can frames batched receive.
+ * @details The function waits until at least a frame is available in the
+ *          software FIFO then fetches all the available frames up to the
+ *          specified number.
+ * @pre     A software FIFO must be associated to the driver using
+ *          @p canSetRxFifo().
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[out] crfp     pointer to an array of @p n time stamped frames
+ * @param[in] n         maximum number of frames to be fetched
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of frames fetched, zero if the operation
+ *                      timed out or if the driver has been stopped while
+ *                      waiting.
+ *
+ * @api
+ */
+size_t canReceiveMany(CANDriver *canp,
+                      CANRxTimedFrame *crfp,
+                      size_t n,
+                      systime_t timeout) {
+  size_t i;
+
+  osalDbgCheck((canp != NULL) && (crfp != NULL) && (n > 0U));
+
+  osalSysLock();
+  osalDbgAssert((canp->state == CAN_READY) || (canp->state == CAN_SLEEP),
+                "invalid state");
+  osalDbgAssert(canp->rxfifo != NULL, "no FIFO");
+
+  while ((canp->state == CAN_SLEEP) || (canp->rxfifo->count == 0U)) {
+    msg_t msg = osalThreadEnqueueTimeoutS(&canp->rxqueue, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return 0U;
+    }
+  }
+
+  /* Frames are fetched one at time in order to not keep the critical zone
+     for too long.*/
+  i = 0U;
+  while ((i < n) && (canp->rxfifo->count > 0U)) {
+    can_rx_fifo_get(canp->rxfifo, &crfp[i]);
+    i++;
+    osalSysUnlock();
+    osalSysLock();
+  }
+  osalSysUnlock();
+
+  return i;
+}
+
+/**
+ * @brief   Returns the number of frames dropped because the FIFO was full.
+ *
+ * @param[in] fifop     pointer to the @p CANRxFifo object
+ * @return              The number of dropped frames.
+ *
+ * @xclass
+ */
+uint32_t canRxFifoGetOverruns(CANRxFifo *fifop) {
+
+  osalDbgCheck(fifop != NULL);
+
+  return fifop->overruns;
+}
+
+/**
+ * @brief   Moves the frames of a mailbox into the software FIFO.
+ * @details All the frames in the hardware mailbox are fetched and time
+ *          stamped, frames not fitting in the FIFO are dropped and counted
+ *          as overruns.
+ * @note    This function is meant to be invoked from the low level drivers
+ *          receive ISRs through @p _can_rx_fifo_isr().
+ *
+ * @param[in] canp      pointer to the @p CANDriver object
+ * @param[in] mailbox   mailbox number
+ *
+ * @notapi
+ */
+void _can_rx_fifo_fill(CANDriver *canp, canmbx_t mailbox) {
+  CANRxFifo *fifop = canp->rxfifo;
+  eventflags_t errors = (eventflags_t)0;
+
+  osalSysLockFromISR();
+  while (can_lld_is_rx_nonempty(canp, mailbox)) {
+    if (fifop->count < fifop->size) {
+      CANRxTimedFrame *p = &fifop->buffer[fifop->head];
+
+      can_lld_receive(canp, mailbox, &p->frame);
+      p->stamp = CAN_RX_STAMP();
+      if (++fifop->head >= fifop->size) {
+        fifop->head = 0U;
+      }
+      fifop->count++;
+    }
+    else {
+      CANRxFrame crf;
+
+      /* FIFO full, the frame is dropped.*/
+      can_lld_receive(canp, mailbox, &crf);
+      fifop->overruns++;
+      errors = CAN_OVERFLOW_ERROR;
+    }
+  }
+  osalThreadDequeueAllI(&canp->rxqueue, MSG_OK);
+  osalEventBroadcastFlagsI(&canp->rxfull_event, CAN_MAILBOX_TO_MASK(mailbox));
+  if (errors != (eventflags_t)0) {
+    osalEventBroadcastFlagsI(&canp->error_event, errors);
+  }
+  osalSysUnlockFromISR();
+}
+#endif /* CAN_USE_RX_FIFO == TRUE */
+
 #endif /* HAL_USE_CAN == TRUE */
 
 /** @} */
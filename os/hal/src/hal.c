@@ -115,6 +115,9 @@ void halInit(void) {
 #if (HAL_USE_SERIAL_USB == TRUE) || defined(__DOXYGEN__)
   sduInit();
 #endif
+#if (HAL_USE_USB_MSD == TRUE) || defined(__DOXYGEN__)
+  msdInit();
+#endif
 #if (HAL_USE_RTC == TRUE) || defined(__DOXYGEN__)
   rtcInit();
 #endif
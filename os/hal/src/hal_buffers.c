@@ -44,6 +44,29 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns a pointer to the used size field of a buffer.
+ * @details The buffers are contiguous in memory, the size fields are stored
+ *          in an array placed after the last buffer.
+ *
+ * @param[in] bqp       pointer to an @p io_buffers_queue_t structure
+ * @param[in] bp        pointer to a buffer of the queue
+ * @return              Pointer to the buffer size field.
+ */
+#define bq_size_field(bqp, bp)                                              \
+  ((bqp)->bsizes + ((size_t)((bp) - (bqp)->buffers) / (bqp)->bsize))
+
+/**
+ * @brief   Returns the first @p size_t aligned address at or after a
+ *          pointer.
+ *
+ * @param[in] p         pointer to be aligned
+ * @return              The aligned pointer.
+ */
+#define bq_align_sizes(p)                                                   \
+  ((size_t *)(((uintptr_t)(p) + (sizeof (size_t) - 1U)) &                   \
+              ~(uintptr_t)(sizeof (size_t) - 1U)))
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -82,8 +105,9 @@ void ibqObjectInit(input_buffers_queue_t *ibqp, uint8_t *bp,
   ibqp->bcounter = 0;
   ibqp->brdptr   = bp;
   ibqp->bwrptr   = bp;
-  ibqp->btop     = bp + ((size + sizeof (size_t)) * n);
-  ibqp->bsize    = size + sizeof (size_t);
+  ibqp->btop     = bp + (size * n);
+  ibqp->bsizes   = bq_align_sizes(ibqp->btop);
+  ibqp->bsize    = size;
   ibqp->bn       = n;
   ibqp->buffers  = bp;
   ibqp->ptr      = NULL;
@@ -133,7 +157,45 @@ uint8_t *ibqGetEmptyBufferI(input_buffers_queue_t *ibqp) {
     return NULL;
   }
 
-  return ibqp->bwrptr + sizeof (size_t);
+  return ibqp->bwrptr;
+}
+
+/**
+ * @brief   Gets the next empty buffers from the queue.
+ * @details The returned buffers are contiguous in memory and can be filled
+ *          by a single transfer, their number is limited by the empty
+ *          buffers in the queue and by the end of the buffers area.
+ * @note    The function always returns the same buffers if called repeatedly.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[in] max       maximum number of buffers to be returned
+ * @param[out] np       number of contiguous empty buffers
+ * @return              A pointer to the first buffer to be filled.
+ * @retval NULL         if the queue is full.
+ *
+ * @iclass
+ */
+uint8_t *ibqGetEmptyBuffersI(input_buffers_queue_t *ibqp,
+                             size_t max, size_t *np) {
+  size_t n;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((max > 0U) && (np != NULL));
+
+  if (ibqIsFullI(ibqp)) {
+    return NULL;
+  }
+
+  n = bqSizeX(ibqp) - bqSpaceI(ibqp);
+  if (n > ((size_t)(ibqp->btop - ibqp->bwrptr) / ibqp->bsize)) {
+    n = (size_t)(ibqp->btop - ibqp->bwrptr) / ibqp->bsize;
+  }
+  if (n > max) {
+    n = max;
+  }
+  *np = n;
+
+  return ibqp->bwrptr;
 }
 
 /**
@@ -148,11 +210,11 @@ void ibqPostFullBufferI(input_buffers_queue_t *ibqp, size_t size) {
 
   osalDbgCheckClassI();
 
-  osalDbgCheck((size > 0U) && (size <= (ibqp->bsize - sizeof (size_t))));
+  osalDbgCheck((size > 0U) && (size <= ibqp->bsize));
   osalDbgAssert(!ibqIsFullI(ibqp), "buffers queue full");
 
-  /* Writing size field in the buffer.*/
-  *((size_t *)ibqp->bwrptr) = size;
+  /* Writing size field of the buffer.*/
+  *bq_size_field(ibqp, ibqp->bwrptr) = size;
 
   /* Posting the buffer in the queue.*/
   ibqp->bcounter++;
@@ -165,6 +227,29 @@ void ibqPostFullBufferI(input_buffers_queue_t *ibqp, size_t size) {
   osalThreadDequeueNextI(&ibqp->waiting, MSG_OK);
 }
 
+/**
+ * @brief   Posts the data of a multiple buffers transfer to the queue.
+ * @details The data is assumed to be written starting from the buffer
+ *          returned by @p ibqGetEmptyBuffersI(), all buffers are posted
+ *          full except the last one.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[in] size      total size of the received data, cannot be zero
+ *
+ * @iclass
+ */
+void ibqPostFullBuffersI(input_buffers_queue_t *ibqp, size_t size) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck(size > 0U);
+
+  while (size > ibqp->bsize) {
+    ibqPostFullBufferI(ibqp, ibqp->bsize);
+    size -= ibqp->bsize;
+  }
+  ibqPostFullBufferI(ibqp, size);
+}
+
 /**
  * @brief   Gets the next filled buffer from the queue.
  * @note    The function always acquires the same buffer if called repeatedly.
@@ -231,8 +316,8 @@ msg_t ibqGetFullBufferTimeout(input_buffers_queue_t *ibqp,
   osalDbgAssert(!ibqIsEmptyI(ibqp), "still empty");
 
   /* Setting up the "current" buffer and its boundary.*/
-  ibqp->ptr = ibqp->brdptr + sizeof (size_t);
-  ibqp->top = ibqp->ptr + *((size_t *)ibqp->brdptr);
+  ibqp->ptr = ibqp->brdptr;
+  ibqp->top = ibqp->ptr + *bq_size_field(ibqp, ibqp->brdptr);
 
   return MSG_OK;
 }
@@ -453,8 +538,9 @@ void obqObjectInit(output_buffers_queue_t *obqp, uint8_t *bp,
   obqp->bcounter = n;
   obqp->brdptr   = bp;
   obqp->bwrptr   = bp;
-  obqp->btop     = bp + ((size + sizeof (size_t)) * n);
-  obqp->bsize    = size + sizeof (size_t);
+  obqp->btop     = bp + (size * n);
+  obqp->bsizes   = bq_align_sizes(obqp->btop);
+  obqp->bsize    = size;
   obqp->bn       = n;
   obqp->buffers  = bp;
   obqp->ptr      = NULL;
@@ -507,9 +593,61 @@ uint8_t *obqGetFullBufferI(output_buffers_queue_t *obqp,
   }
 
   /* Buffer size.*/
-  *sizep = *((size_t *)obqp->brdptr);
+  *sizep = *bq_size_field(obqp, obqp->brdptr);
+
+  return obqp->brdptr;
+}
+
+/**
+ * @brief   Gets the next filled buffers from the queue.
+ * @details The returned buffers are contiguous in memory and can be sent by
+ *          a single transfer. The sequence ends at the first partially
+ *          filled buffer, at the end of the buffers area or after @p max
+ *          buffers.
+ * @note    The function always returns the same buffers if called repeatedly.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[in] max       maximum number of buffers to be returned
+ * @param[out] sizep    pointer to the total size of the filled buffers
+ * @param[out] np       pointer to the number of returned buffers
+ * @return              A pointer to the first filled buffer.
+ * @retval NULL         if the queue is empty.
+ *
+ * @iclass
+ */
+uint8_t *obqGetFullBuffersI(output_buffers_queue_t *obqp, size_t max,
+                            size_t *sizep, size_t *np) {
+  size_t full, n, size;
+  uint8_t *bp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((max > 0U) && (sizep != NULL) && (np != NULL));
+
+  if (obqIsEmptyI(obqp)) {
+    return NULL;
+  }
 
-  return obqp->brdptr + sizeof (size_t);
+  full = bqSizeX(obqp) - bqSpaceI(obqp);
+  bp   = obqp->brdptr;
+  n    = 0U;
+  size = 0U;
+  do {
+    size_t bsize = *bq_size_field(obqp, bp);
+
+    size += bsize;
+    bp   += obqp->bsize;
+    n++;
+
+    /* A partially filled buffer terminates the sequence.*/
+    if (bsize < obqp->bsize) {
+      break;
+    }
+  } while ((n < full) && (n < max) && (bp < obqp->btop));
+
+  *sizep = size;
+  *np    = n;
+
+  return obqp->brdptr;
 }
 
 /**
@@ -535,6 +673,24 @@ void obqReleaseEmptyBufferI(output_buffers_queue_t *obqp) {
   osalThreadDequeueNextI(&obqp->waiting, MSG_OK);
 }
 
+/**
+ * @brief   Releases a sequence of filled buffers back in the queue.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[in] n         number of buffers to be released
+ *
+ * @iclass
+ */
+void obqReleaseEmptyBuffersI(output_buffers_queue_t *obqp, size_t n) {
+
+  osalDbgCheckClassI();
+
+  while (n > 0U) {
+    obqReleaseEmptyBufferI(obqp);
+    n--;
+  }
+}
+
 /**
  * @brief   Gets the next empty buffer from the queue.
  * @note    The function always acquires the same buffer if called repeatedly.
@@ -601,7 +757,7 @@ msg_t obqGetEmptyBufferTimeout(output_buffers_queue_t *obqp,
   osalDbgAssert(!obqIsFullI(obqp), "still full");
 
   /* Setting up the "current" buffer and its boundary.*/
-  obqp->ptr = obqp->bwrptr + sizeof (size_t);
+  obqp->ptr = obqp->bwrptr;
   obqp->top = obqp->bwrptr + obqp->bsize;
 
   return MSG_OK;
@@ -635,11 +791,11 @@ void obqPostFullBuffer(output_buffers_queue_t *obqp, size_t size) {
 void obqPostFullBufferS(output_buffers_queue_t *obqp, size_t size) {
 
   osalDbgCheckClassS();
-  osalDbgCheck((size > 0U) && (size <= (obqp->bsize - sizeof (size_t))));
+  osalDbgCheck((size > 0U) && (size <= obqp->bsize));
   osalDbgAssert(!obqIsFullI(obqp), "buffers queue full");
 
-  /* Writing size field in the buffer.*/
-  *((size_t *)obqp->bwrptr) = size;
+  /* Writing size field of the buffer.*/
+  *bq_size_field(obqp, obqp->bwrptr) = size;
 
   /* Posting the buffer in the queue.*/
   obqp->bcounter--;
@@ -698,7 +854,7 @@ msg_t obqPutTimeout(output_buffers_queue_t *obqp, uint8_t b,
   /* If the current buffer has been fully written then it is posted as
      full in the queue.*/
   if (obqp->ptr >= obqp->top) {
-    obqPostFullBufferS(obqp, obqp->bsize - sizeof (size_t));
+    obqPostFullBufferS(obqp, obqp->bsize);
   }
 
   osalSysUnlock();
@@ -797,7 +953,7 @@ size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
 
     /* Has the current data buffer been finished? if so then release it.*/
     if (obqp->ptr >= obqp->top) {
-      obqPostFullBufferS(obqp, obqp->bsize - sizeof (size_t));
+      obqPostFullBufferS(obqp, obqp->bsize);
     }
 
     /* Giving a preemption chance.*/
@@ -829,12 +985,12 @@ bool obqTryFlushI(output_buffers_queue_t *obqp) {
   /* If queue is empty and there is a buffer partially filled and
      it is not being written.*/
   if (obqIsEmptyI(obqp) && (obqp->ptr != NULL)) {
-    size_t size = (size_t)obqp->ptr - ((size_t)obqp->bwrptr + sizeof (size_t));
+    size_t size = (size_t)obqp->ptr - (size_t)obqp->bwrptr;
 
     if (size > 0U) {
 
-      /* Writing size field in the buffer.*/
-      *((size_t *)obqp->bwrptr) = size;
+      /* Writing size field of the buffer.*/
+      *bq_size_field(obqp, obqp->bwrptr) = size;
 
       /* Posting the buffer in the queue.*/
       obqp->bcounter--;
@@ -33,6 +33,20 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Queue statistics time stamp.
+ * @details The realtime counter is used if supported by the port, the
+ *          system time otherwise.
+ */
+#if (defined(PORT_SUPPORTS_RT) && (PORT_SUPPORTS_RT == TRUE)) ||             \
+    defined(__DOXYGEN__)
+#define I2C_QUEUE_STAMP()           osalOsGetRealtimeCounterX()
+#else
+#define I2C_QUEUE_STAMP()           ((rtcnt_t)osalOsGetSystemTimeX())
+#endif
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -45,6 +59,249 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Resets the queue statistics.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_reset_stats(I2CDriver *i2cp) {
+
+  i2cp->queue.stats.start     = osalOsGetSystemTimeX();
+  i2cp->queue.stats.completed = 0U;
+  i2cp->queue.stats.failed    = 0U;
+  i2cp->queue.stats.busy      = 0U;
+  i2cp->queue.stats.wait      = 0U;
+  i2cp->queue.stats.max_wait  = (rtcnt_t)0;
+}
+
+/**
+ * @brief   Accounts the queue wait of a transaction being started.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] trp       pointer to the @p I2CTransaction object
+ *
+ * @notapi
+ */
+static void i2c_queue_account_wait(I2CDriver *i2cp, I2CTransaction *trp) {
+  rtcnt_t wait;
+
+  i2cp->queue.start = I2C_QUEUE_STAMP();
+  wait = i2cp->queue.start - trp->stamp;
+  i2cp->queue.stats.wait += wait;
+  if (wait > i2cp->queue.stats.max_wait) {
+    i2cp->queue.stats.max_wait = wait;
+  }
+}
+
+/**
+ * @brief   Accounts the completion of a transaction.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] msg       the transaction result
+ *
+ * @notapi
+ */
+static void i2c_queue_account_end(I2CDriver *i2cp, msg_t msg) {
+
+  i2cp->queue.stats.completed++;
+  if (msg != MSG_OK) {
+    i2cp->queue.stats.failed++;
+  }
+  i2cp->queue.stats.busy += (rtcnt_t)(I2C_QUEUE_STAMP() - i2cp->queue.start);
+}
+
+#if (I2C_QUEUE_USE_ISR == TRUE) || defined(__DOXYGEN__)
+static void i2c_queue_end_cb(I2CDriver *i2cp);
+static void i2c_queue_retry_cb(void *p);
+static void i2c_queue_timeout_cb(void *p);
+
+/**
+ * @brief   Attempts to start the queued transaction in progress.
+ * @details If the bus is busy then a new attempt is scheduled after
+ *          @p I2C_QUEUE_RETRY_DELAY ticks, else the timer is armed for the
+ *          remaining part of the transaction timeout.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @return              The operation status.
+ * @retval MSG_OK       if the transaction has been started or a new attempt
+ *                      has been scheduled.
+ * @retval MSG_TIMEOUT  if the bus is busy and the transaction timeout
+ *                      expired.
+ *
+ * @notapi
+ */
+static msg_t i2c_queue_attempt(I2CDriver *i2cp) {
+  I2CTransaction *trp = i2cp->queue.current;
+  systime_t elapsed;
+  msg_t msg;
+
+  msg = MSG_TIMEOUT;
+  if (i2cp->state == I2C_READY) {
+    if (trp->txbytes > 0U) {
+      msg = i2cStartTransmitI(i2cp, trp->addr,
+                              trp->txbuf, trp->txbytes,
+                              trp->rxbuf, trp->rxbytes,
+                              i2c_queue_end_cb);
+    }
+    else {
+      msg = i2cStartReceiveI(i2cp, trp->addr,
+                             trp->rxbuf, trp->rxbytes,
+                             i2c_queue_end_cb);
+    }
+  }
+
+  elapsed = osalOsGetSystemTimeX() - i2cp->queue.time;
+  if (msg == MSG_OK) {
+    if (trp->timeout != TIME_INFINITE) {
+      osalTimerSetI(&i2cp->queue.timer,
+                    elapsed < trp->timeout ? trp->timeout - elapsed :
+                                             (systime_t)1,
+                    i2c_queue_timeout_cb, i2cp);
+    }
+    return MSG_OK;
+  }
+
+  if ((trp->timeout != TIME_INFINITE) && (elapsed >= trp->timeout)) {
+    return MSG_TIMEOUT;
+  }
+  osalTimerSetI(&i2cp->queue.timer, (systime_t)I2C_QUEUE_RETRY_DELAY,
+                i2c_queue_retry_cb, i2cp);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Starts a queued transaction.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] trp       pointer to the @p I2CTransaction object
+ *
+ * @notapi
+ */
+static void i2c_queue_start(I2CDriver *i2cp, I2CTransaction *trp) {
+
+  i2c_queue_account_wait(i2cp, trp);
+  i2cp->queue.current = trp;
+  i2cp->queue.time    = osalOsGetSystemTimeX();
+
+  /* The first attempt cannot time out.*/
+  (void) i2c_queue_attempt(i2cp);
+}
+
+/**
+ * @brief   Completes the queued transaction in progress.
+ * @details The next pending transaction, if any, is then started.
+ * @note    This function is invoked from ISR context outside the critical
+ *          zone.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] msg       the transaction result
+ *
+ * @notapi
+ */
+static void i2c_queue_complete(I2CDriver *i2cp, msg_t msg) {
+  I2CTransaction *trp = i2cp->queue.current;
+
+  trp->result = msg;
+  trp->errors = i2cp->errors;
+
+  /* The transaction callback is invoked outside the critical zone like
+     the driver callback.*/
+  if (trp->cb != NULL) {
+    trp->cb(i2cp, trp);
+  }
+
+  osalSysLockFromISR();
+  i2cp->queue.current = NULL;
+  i2c_queue_account_end(i2cp, msg);
+  osalThreadResumeI(&trp->thread, msg);
+
+  /* Next transaction, if the callback started another operation then it
+     is retried until the driver is ready again.*/
+  if (i2cp->queue.head != NULL) {
+    trp = i2cp->queue.head;
+    i2cp->queue.head = trp->next;
+    i2c_queue_start(i2cp, trp);
+  }
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Queued transactions completion callback.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_end_cb(I2CDriver *i2cp) {
+
+  osalSysLockFromISR();
+  osalTimerResetI(&i2cp->queue.timer);
+  osalSysUnlockFromISR();
+
+  i2c_queue_complete(i2cp,
+                     i2cp->errors == I2C_NO_ERROR ? MSG_OK : MSG_RESET);
+}
+
+/**
+ * @brief   Busy bus retry timer callback.
+ * @details The transaction is completed with a @p MSG_TIMEOUT result if
+ *          the bus is still busy when its timeout expires.
+ *
+ * @param[in] p         pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_retry_cb(void *p) {
+  I2CDriver *i2cp = (I2CDriver *)p;
+  msg_t msg;
+
+  osalSysLockFromISR();
+  msg = i2c_queue_attempt(i2cp);
+  osalSysUnlockFromISR();
+
+  if (msg != MSG_OK) {
+    i2cp->errors = I2C_NO_ERROR;
+    i2c_queue_complete(i2cp, MSG_TIMEOUT);
+  }
+}
+
+/**
+ * @brief   Transaction timeout timer callback.
+ * @details The operation in progress is aborted and the driver is reset in
+ *          order to recover it for the next transactions.
+ *
+ * @param[in] p         pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+static void i2c_queue_timeout_cb(void *p) {
+  I2CDriver *i2cp = (I2CDriver *)p;
+
+  osalSysLockFromISR();
+
+  /* Nothing to do if the transaction completed in the meantime, the timer
+     is armed again if the next one has already been started.*/
+  if ((i2cp->end_cb != i2c_queue_end_cb) ||
+      (i2cp->queue.current->timeout == TIME_INFINITE) ||
+      osalTimerIsArmedI(&i2cp->queue.timer)) {
+    osalSysUnlockFromISR();
+    return;
+  }
+
+  i2c_lld_reset(i2cp);
+  i2cp->end_cb = NULL;
+  i2cp->state  = I2C_READY;
+  osalSysUnlockFromISR();
+
+  i2c_queue_complete(i2cp, MSG_TIMEOUT);
+}
+#endif /* I2C_QUEUE_USE_ISR == TRUE */
+#endif /* I2C_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -73,10 +330,26 @@ void i2cObjectInit(I2CDriver *i2cp) {
   i2cp->state  = I2C_STOP;
   i2cp->config = NULL;
 
+#if I2C_SUPPORTS_CALLBACKS == TRUE
+  i2cp->end_cb = NULL;
+#endif
+
 #if I2C_USE_MUTUAL_EXCLUSION == TRUE
   osalMutexObjectInit(&i2cp->mutex);
 #endif
 
+#if I2C_USE_QUEUE == TRUE
+  i2cp->queue.head    = NULL;
+  i2cp->queue.current = NULL;
+  i2cp->queue.server  = NULL;
+  i2cp->queue.start   = (rtcnt_t)0;
+  i2c_queue_reset_stats(i2cp);
+#if I2C_QUEUE_USE_ISR == TRUE
+  osalTimerObjectInit(&i2cp->queue.timer);
+  i2cp->queue.time    = (systime_t)0;
+#endif
+#endif
+
 #if defined(I2C_DRIVER_EXT_INIT_HOOK)
   I2C_DRIVER_EXT_INIT_HOOK(i2cp);
 #endif
@@ -278,6 +551,392 @@ void i2cReleaseBus(I2CDriver *i2cp) {
 }
 #endif /* I2C_USE_MUTUAL_EXCLUSION == TRUE */
 
+#if (I2C_SUPPORTS_CALLBACKS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transmission on the I2C bus.
+ * @details Function designed to realize "read-through-write" transfer
+ *          paradigm. If you want transmit data without any further read,
+ *          than set @b rxbytes field to 0.
+ * @post    At the end of the operation the callback is invoked from ISR
+ *          context, the errors can be retrieved using @p i2cGetErrors().
+ * @note    There is no timeout on asynchronous operations, in case of a
+ *          bus lockup the driver must be stopped and restarted.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address (7 bits) without R/W bit
+ * @param[in] txbuf     pointer to transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to receive buffer
+ * @param[in] rxbytes   number of bytes to be received, set it to 0 if
+ *                      you want transmit only
+ * @param[in] end_cb    operation complete callback
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy and the operation could not be
+ *                      started.
+ *
+ * @iclass
+ */
+msg_t i2cStartTransmitI(I2CDriver *i2cp,
+                        i2caddr_t addr,
+                        const uint8_t *txbuf,
+                        size_t txbytes,
+                        uint8_t *rxbuf,
+                        size_t rxbytes,
+                        i2ccallback_t end_cb) {
+  msg_t msg;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((i2cp != NULL) && (addr != 0U) &&
+               (txbytes > 0U) && (txbuf != NULL) &&
+               ((rxbytes == 0U) || ((rxbytes > 0U) && (rxbuf != NULL))) &&
+               (end_cb != NULL));
+  osalDbgAssert(i2cp->state == I2C_READY, "not ready");
+
+  i2cp->errors = I2C_NO_ERROR;
+  i2cp->end_cb = end_cb;
+  i2cp->state  = I2C_ACTIVE_TX;
+  msg = i2c_lld_start_transmit(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes);
+  if (msg != MSG_OK) {
+    i2cp->end_cb = NULL;
+    i2cp->state  = I2C_READY;
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Starts a transmission on the I2C bus.
+ * @details Function designed to realize "read-through-write" transfer
+ *          paradigm. If you want transmit data without any further read,
+ *          than set @b rxbytes field to 0.
+ * @post    At the end of the operation the callback is invoked from ISR
+ *          context, the errors can be retrieved using @p i2cGetErrors().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address (7 bits) without R/W bit
+ * @param[in] txbuf     pointer to transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to receive buffer
+ * @param[in] rxbytes   number of bytes to be received, set it to 0 if
+ *                      you want transmit only
+ * @param[in] end_cb    operation complete callback
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy and the operation could not be
+ *                      started.
+ *
+ * @api
+ */
+msg_t i2cStartTransmit(I2CDriver *i2cp,
+                       i2caddr_t addr,
+                       const uint8_t *txbuf,
+                       size_t txbytes,
+                       uint8_t *rxbuf,
+                       size_t rxbytes,
+                       i2ccallback_t end_cb) {
+  msg_t msg;
+
+  osalSysLock();
+  msg = i2cStartTransmitI(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes, end_cb);
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Starts a reception from the I2C bus.
+ * @post    At the end of the operation the callback is invoked from ISR
+ *          context, the errors can be retrieved using @p i2cGetErrors().
+ * @note    There is no timeout on asynchronous operations, in case of a
+ *          bus lockup the driver must be stopped and restarted.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address (7 bits) without R/W bit
+ * @param[out] rxbuf    pointer to receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] end_cb    operation complete callback
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy and the operation could not be
+ *                      started.
+ *
+ * @iclass
+ */
+msg_t i2cStartReceiveI(I2CDriver *i2cp,
+                       i2caddr_t addr,
+                       uint8_t *rxbuf,
+                       size_t rxbytes,
+                       i2ccallback_t end_cb) {
+  msg_t msg;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((i2cp != NULL) && (addr != 0U) &&
+               (rxbytes > 0U) && (rxbuf != NULL) && (end_cb != NULL));
+  osalDbgAssert(i2cp->state == I2C_READY, "not ready");
+
+  i2cp->errors = I2C_NO_ERROR;
+  i2cp->end_cb = end_cb;
+  i2cp->state  = I2C_ACTIVE_RX;
+  msg = i2c_lld_start_receive(i2cp, addr, rxbuf, rxbytes);
+  if (msg != MSG_OK) {
+    i2cp->end_cb = NULL;
+    i2cp->state  = I2C_READY;
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Starts a reception from the I2C bus.
+ * @post    At the end of the operation the callback is invoked from ISR
+ *          context, the errors can be retrieved using @p i2cGetErrors().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address (7 bits) without R/W bit
+ * @param[out] rxbuf    pointer to receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] end_cb    operation complete callback
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy and the operation could not be
+ *                      started.
+ *
+ * @api
+ */
+msg_t i2cStartReceive(I2CDriver *i2cp,
+                      i2caddr_t addr,
+                      uint8_t *rxbuf,
+                      size_t rxbytes,
+                      i2ccallback_t end_cb) {
+  msg_t msg;
+
+  osalSysLock();
+  msg = i2cStartReceiveI(i2cp, addr, rxbuf, rxbytes, end_cb);
+  osalSysUnlock();
+
+  return msg;
+}
+#endif /* I2C_SUPPORTS_CALLBACKS == TRUE */
+
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Submits a transaction to the driver queue.
+ * @details The transaction is inserted in the queue according to its
+ *          priority. When the queue is served from ISR context the
+ *          transaction is started immediately if the queue is idle and the
+ *          pending ones are started back-to-back from the completion
+ *          interrupt of the previous one, transactions finding the bus busy
+ *          are retried from a virtual timer. Otherwise the thread serving
+ *          the queue is awakened.
+ * @post    At the end of the transaction its callback is invoked.
+ * @note    A driver whose queue is served from ISR context must not be
+ *          accessed using the other APIs at the same time.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] trp       pointer to the @p I2CTransaction object
+ * @return              The operation status.
+ * @retval MSG_OK       if the transaction has been started or queued.
+ *
+ * @iclass
+ */
+msg_t i2cQueueSubmitI(I2CDriver *i2cp, I2CTransaction *trp) {
+  I2CTransaction **pp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((i2cp != NULL) && (trp != NULL) && (trp->addr != 0U) &&
+               ((trp->txbytes > 0U) || (trp->rxbytes > 0U)) &&
+               (trp->timeout != TIME_IMMEDIATE));
+
+  trp->stamp  = I2C_QUEUE_STAMP();
+  trp->thread = NULL;
+
+#if I2C_QUEUE_USE_ISR == TRUE
+  /* Queue idle, the transaction is started immediately.*/
+  if (i2cp->queue.current == NULL) {
+    i2c_queue_start(i2cp, trp);
+    return MSG_OK;
+  }
+#endif
+
+  /* Inserted after the transactions with the same or higher priority.*/
+  pp = &i2cp->queue.head;
+  while ((*pp != NULL) && ((*pp)->prio >= trp->prio)) {
+    pp = &(*pp)->next;
+  }
+  trp->next = *pp;
+  *pp = trp;
+
+#if I2C_QUEUE_USE_ISR == FALSE
+  osalThreadResumeI(&i2cp->queue.server, MSG_OK);
+#endif
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Submits a transaction to the driver queue.
+ * @details The transaction is inserted in the queue according to its
+ *          priority. When the queue is served from ISR context the
+ *          transaction is started immediately if the queue is idle and the
+ *          pending ones are started back-to-back from the completion
+ *          interrupt of the previous one, transactions finding the bus busy
+ *          are retried from a virtual timer. Otherwise the thread serving
+ *          the queue is awakened.
+ * @post    At the end of the transaction its callback is invoked.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] trp       pointer to the @p I2CTransaction object
+ * @return              The operation status.
+ * @retval MSG_OK       if the transaction has been started or queued.
+ *
+ * @api
+ */
+msg_t i2cQueueSubmit(I2CDriver *i2cp, I2CTransaction *trp) {
+  msg_t msg;
+
+  osalSysLock();
+  msg = i2cQueueSubmitI(i2cp, trp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Performs a queued transaction.
+ * @details The transaction is submitted to the driver queue and the
+ *          invoking thread waits for its completion.
+ * @note    This function must not be invoked by the thread serving the
+ *          queue.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] trp       pointer to the @p I2CTransaction object
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors are
+ *                      stored in the transaction object.
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @api
+ */
+msg_t i2cQueueTransfer(I2CDriver *i2cp, I2CTransaction *trp) {
+  msg_t msg;
+
+  osalSysLock();
+  msg = i2cQueueSubmitI(i2cp, trp);
+  if (msg == MSG_OK) {
+    msg = osalThreadSuspendS(&trp->thread);
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+#if (I2C_QUEUE_USE_ISR == FALSE) || defined(__DOXYGEN__)
+/**
+ * @brief   Serves the driver queue.
+ * @details Waits for a transaction then executes it. Pending transactions
+ *          are served back-to-back, the bus is acquired for the duration of
+ *          each transaction so the queue can coexist with other bus users.
+ * @pre     This function is only available if the queue is not served from
+ *          ISR context, see @p I2C_QUEUE_USE_ISR.
+ * @note    This function is meant to be invoked in a loop by a single
+ *          thread dedicated to the bus.
+ * @note    After a timeout the driver is stopped and restarted in order to
+ *          recover it for the next transactions.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a transaction has been served successfully.
+ * @retval MSG_RESET    if a transaction has been served and one or more I2C
+ *                      errors occurred.
+ * @retval MSG_TIMEOUT  if there were no transactions to be served within the
+ *                      specified time or if a transaction timed out.
+ *
+ * @api
+ */
+msg_t i2cQueueServe(I2CDriver *i2cp, systime_t timeout) {
+  I2CTransaction *trp;
+  msg_t msg;
+
+  osalDbgCheck(i2cp != NULL);
+
+  osalSysLock();
+  if (i2cp->queue.head == NULL) {
+    msg = osalThreadSuspendTimeoutS(&i2cp->queue.server, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+  trp = i2cp->queue.head;
+  i2cp->queue.head = trp->next;
+  i2c_queue_account_wait(i2cp, trp);
+  osalSysUnlock();
+
+#if I2C_USE_MUTUAL_EXCLUSION == TRUE
+  i2cAcquireBus(i2cp);
+#endif
+  if (trp->txbytes > 0U) {
+    msg = i2cMasterTransmitTimeout(i2cp, trp->addr,
+                                   trp->txbuf, trp->txbytes,
+                                   trp->rxbuf, trp->rxbytes,
+                                   trp->timeout);
+  }
+  else {
+    msg = i2cMasterReceiveTimeout(i2cp, trp->addr,
+                                  trp->rxbuf, trp->rxbytes,
+                                  trp->timeout);
+  }
+  trp->result = msg;
+  trp->errors = i2cGetErrors(i2cp);
+  if (msg == MSG_TIMEOUT) {
+    i2cStop(i2cp);
+    i2cStart(i2cp, i2cp->config);
+  }
+#if I2C_USE_MUTUAL_EXCLUSION == TRUE
+  i2cReleaseBus(i2cp);
+#endif
+
+  if (trp->cb != NULL) {
+    trp->cb(i2cp, trp);
+  }
+
+  osalSysLock();
+  i2c_queue_account_end(i2cp, msg);
+  osalThreadResumeS(&trp->thread, msg);
+  osalSysUnlock();
+
+  return msg;
+}
+#endif /* I2C_QUEUE_USE_ISR == FALSE */
+
+/**
+ * @brief   Returns the queue statistics.
+ * @details The statistics are reset after being read.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[out] statsp   pointer to the statistics to be filled
+ *
+ * @api
+ */
+void i2cQueueGetStats(I2CDriver *i2cp, i2c_queue_stats_t *statsp) {
+
+  osalDbgCheck((i2cp != NULL) && (statsp != NULL));
+
+  osalSysLock();
+  *statsp = i2cp->queue.stats;
+  i2c_queue_reset_stats(i2cp);
+  osalSysUnlock();
+}
+#endif /* I2C_USE_QUEUE == TRUE */
+
 #endif /* HAL_USE_I2C == TRUE */
 
 /** @} */
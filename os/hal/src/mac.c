@@ -34,6 +34,10 @@
 #error "MAC_USE_ZERO_COPY not supported by this implementation"
 #endif
 
+#if (MAC_USE_RX_MITIGATION == TRUE) && (MAC_SUPPORTS_RX_MITIGATION == FALSE)
+#error "MAC_USE_RX_MITIGATION not supported by this implementation"
+#endif
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -46,6 +50,45 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Gets a receive descriptor from the low level driver.
+ * @details When the receive interrupt mitigation is enabled and the ring
+ *          is empty the receive interrupt is enabled again, if frames
+ *          arrived in the meanwhile the ring is scanned again.
+ *
+ * @param[in] macp      pointer to the @p MACDriver object
+ * @param[out] rdp      pointer to a @p MACReceiveDescriptor structure
+ * @return              The operation status.
+ * @retval MSG_OK       the descriptor has been obtained.
+ * @retval MSG_TIMEOUT  descriptor not available.
+ *
+ * @notapi
+ */
+static msg_t mac_get_receive_descriptor(MACDriver *macp,
+                                        MACReceiveDescriptor *rdp) {
+#if MAC_USE_RX_MITIGATION == TRUE
+  msg_t msg;
+
+  do {
+    msg = mac_lld_get_receive_descriptor(macp, rdp);
+    if (msg == MSG_OK) {
+      osalSysLock();
+      macp->rxstats.frames++;
+      macp->rxstats.burst++;
+      if (macp->rxstats.burst > macp->rxstats.max_burst) {
+        macp->rxstats.max_burst = macp->rxstats.burst;
+      }
+      osalSysUnlock();
+      break;
+    }
+  } while (mac_lld_resume_receive_interrupt(macp));
+
+  return msg;
+#else
+  return mac_lld_get_receive_descriptor(macp, rdp);
+#endif
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -82,6 +125,12 @@ void macObjectInit(MACDriver *macp) {
 #if MAC_USE_EVENTS == TRUE
   osalEventObjectInit(&macp->rdevent);
 #endif
+#if MAC_USE_RX_MITIGATION == TRUE
+  macp->rxstats.interrupts = 0U;
+  macp->rxstats.frames     = 0U;
+  macp->rxstats.burst      = 0U;
+  macp->rxstats.max_burst  = 0U;
+#endif
 }
 
 /**
@@ -212,7 +261,7 @@ msg_t macWaitReceiveDescriptor(MACDriver *macp,
   osalDbgCheck((macp != NULL) && (rdp != NULL));
   osalDbgAssert(macp->state == MAC_ACTIVE, "not active");
 
-  while (((msg = mac_lld_get_receive_descriptor(macp, rdp)) != MSG_OK) &&
+  while (((msg = mac_get_receive_descriptor(macp, rdp)) != MSG_OK) &&
          (timeout > (systime_t)0)) {
     osalSysLock();
     now = osalOsGetSystemTimeX();
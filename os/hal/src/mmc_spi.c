@@ -35,6 +35,11 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Command CRC error bit of the R1 response.
+ */
+#define MMC_R1_COM_CRC_ERROR        0x08U
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -91,6 +96,46 @@ static const uint8_t crc7_lookup_table[256] = {
   0x62, 0x6b, 0x70, 0x79
 };
 
+#if (MMC_USE_DATA_CRC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Lookup table for CRC-16 ( based on polynomial x^16 + x^12 + x^5 + 1).
+ */
+static const uint16_t crc16_lookup_table[256] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+  0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+  0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+  0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+  0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+  0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+  0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+  0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+  0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+  0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+  0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+  0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+  0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+  0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+  0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+  0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+  0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+  0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+  0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+  0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+  0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+  0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
+};
+#endif
+
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
@@ -154,8 +199,31 @@ static uint8_t crc7(uint8_t crc, const uint8_t *buffer, size_t len) {
   return crc;
 }
 
+#if (MMC_USE_DATA_CRC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief Calculate the MMC standard CRC-16 based on a lookup table.
+ *
+ * @param[in] crc       start value for CRC
+ * @param[in] buffer    pointer to data buffer
+ * @param[in] len       length of data
+ * @return              Calculated CRC
+ */
+static uint16_t crc16(uint16_t crc, const uint8_t *buffer, size_t len) {
+
+  while (len > 0U) {
+    crc = (uint16_t)(crc << 8) ^ crc16_lookup_table[(crc >> 8) ^ (*buffer++)];
+    len--;
+  }
+  return crc;
+}
+#endif
+
 /**
  * @brief   Waits an idle condition.
+ * @details The card keeps the line low while busy, the line is polled in
+ *          bursts of @p MMC_POLL_BYTES bytes in order to reduce the number
+ *          of SPI operations, the last byte of each burst tells the
+ *          current state.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
  *
@@ -163,18 +231,24 @@ static uint8_t crc7(uint8_t crc, const uint8_t *buffer, size_t len) {
  */
 static void wait(MMCDriver *mmcp) {
   int i;
-  uint8_t buf[4];
+  uint8_t buf[MMC_POLL_BYTES];
+
+  /* The bus is usually idle already.*/
+  spiReceive(mmcp->config->spip, 1, buf);
+  if (buf[0] == 0xFFU) {
+    return;
+  }
 
   for (i = 0; i < 16; i++) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFFU) {
+    spiReceive(mmcp->config->spip, MMC_POLL_BYTES, buf);
+    if (buf[MMC_POLL_BYTES - 1U] == 0xFFU) {
       return;
     }
   }
   /* Looks like it is a long wait.*/
   while (true) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFFU) {
+    spiReceive(mmcp->config->spip, MMC_POLL_BYTES, buf);
+    if (buf[MMC_POLL_BYTES - 1U] == 0xFFU) {
       break;
     }
 #if MMC_NICE_WAITING == TRUE
@@ -233,22 +307,31 @@ static uint8_t recvr1(MMCDriver *mmcp) {
 }
 
 /**
- * @brief   Receives a three byte response.
+ * @brief   Sends a command and receives the R1 response.
+ * @details The command is sent again if the card reports a CRC error in
+ *          the command frame, up to @p MMC_CRC_RETRY times.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
- * @param[out] buffer   pointer to four bytes wide buffer
- * @return              First response byte as an @p uint8_t value.
+ * @param[in] cmd       the command id
+ * @param[in] arg       the command argument
+ * @return              The response as an @p uint8_t value.
  * @retval 0xFF         timed out.
  *
  * @notapi
  */
-static uint8_t recvr3(MMCDriver *mmcp, uint8_t* buffer) {
+static uint8_t send_cmd(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
+  unsigned i;
   uint8_t r1;
 
-  r1 = recvr1(mmcp);
-  spiReceive(mmcp->config->spip, 4, buffer);
-
-  return r1;
+  i = 0U;
+  while (true) {
+    send_hdr(mmcp, cmd, arg);
+    r1 = recvr1(mmcp);
+    if ((r1 == 0xFFU) || ((r1 & MMC_R1_COM_CRC_ERROR) == 0U) ||
+        (++i > MMC_CRC_RETRY)) {
+      return r1;
+    }
+  }
 }
 
 /**
@@ -266,8 +349,7 @@ static uint8_t send_command_R1(MMCDriver *mmcp, uint8_t cmd, uint32_t arg) {
   uint8_t r1;
 
   spiSelect(mmcp->config->spip);
-  send_hdr(mmcp, cmd, arg);
-  r1 = recvr1(mmcp);
+  r1 = send_cmd(mmcp, cmd, arg);
   spiUnselect(mmcp->config->spip);
   return r1;
 }
@@ -290,14 +372,71 @@ static uint8_t send_command_R3(MMCDriver *mmcp, uint8_t cmd, uint32_t arg,
   uint8_t r1;
 
   spiSelect(mmcp->config->spip);
-  send_hdr(mmcp, cmd, arg);
-  r1 = recvr3(mmcp, response);
+  r1 = send_cmd(mmcp, cmd, arg);
+  spiReceive(mmcp->config->spip, 4, response);
   spiUnselect(mmcp->config->spip);
   return r1;
 }
 
+/**
+ * @brief   Receives a data block.
+ * @details The start token is searched in bursts of @p MMC_POLL_BYTES
+ *          bytes, the data bytes already received after the token are
+ *          moved into the buffer and the rest of the block is received
+ *          with a single SPI operation.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[out] buffer   pointer to the data buffer
+ * @param[in] n         size of the data block, it must be greater than
+ *                      @p MMC_POLL_BYTES
+ * @param[out] crcerrp  set to @p true if the block has been received with
+ *                      a CRC error
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   timeout, error token or CRC error.
+ *
+ * @notapi
+ */
+static bool recv_block(MMCDriver *mmcp, uint8_t *buffer, size_t n,
+                       bool *crcerrp) {
+  unsigned i, j, k;
+  uint8_t buf[MMC_POLL_BYTES];
+
+  *crcerrp = false;
+  for (i = 0U; i < MMC_WAIT_DATA; i += MMC_POLL_BYTES) {
+    spiReceive(mmcp->config->spip, MMC_POLL_BYTES, buf);
+    for (j = 0U; j < MMC_POLL_BYTES; j++) {
+      if (buf[j] != 0xFFU) {
+        break;
+      }
+    }
+    if (j < MMC_POLL_BYTES) {
+      /* Anything else than a start token is an error token.*/
+      if (buf[j] != 0xFEU) {
+        return HAL_FAILED;
+      }
+      for (k = 0U, j++; j < MMC_POLL_BYTES; k++, j++) {
+        buffer[k] = buf[j];
+      }
+      spiReceive(mmcp->config->spip, n - k, buffer + k);
+      spiReceive(mmcp->config->spip, 2, buf);
+#if MMC_USE_DATA_CRC == TRUE
+      if (crc16(0U, buffer, n) !=
+          (uint16_t)(((uint16_t)buf[0] << 8U) | (uint16_t)buf[1])) {
+        *crcerrp = true;
+        return HAL_FAILED;
+      }
+#endif
+      return HAL_SUCCESS;
+    }
+  }
+  return HAL_FAILED;
+}
+
 /**
  * @brief   Reads the CSD.
+ * @details The register is read again if it is received with a CRC error,
+ *          up to @p MMC_CRC_RETRY times.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
  * @param[out] cmd      command
@@ -311,37 +450,77 @@ static uint8_t send_command_R3(MMCDriver *mmcp, uint8_t cmd, uint32_t arg,
  */
 static bool read_CxD(MMCDriver *mmcp, uint8_t cmd, uint32_t cxd[4]) {
   unsigned i;
+  bool crcerr;
+  uint32_t *wp;
   uint8_t *bp, buf[16];
 
   spiSelect(mmcp->config->spip);
-  send_hdr(mmcp, cmd, 0);
-  if (recvr1(mmcp) != 0x00U) {
-    spiUnselect(mmcp->config->spip);
-    return HAL_FAILED;
+  i = 0U;
+  while (true) {
+    if (send_cmd(mmcp, cmd, 0) != 0x00U) {
+      spiUnselect(mmcp->config->spip);
+      return HAL_FAILED;
+    }
+    if (recv_block(mmcp, buf, sizeof buf, &crcerr) == HAL_SUCCESS) {
+      break;
+    }
+    if (!crcerr || (++i > MMC_CRC_RETRY)) {
+      spiUnselect(mmcp->config->spip);
+      return HAL_FAILED;
+    }
   }
+  spiUnselect(mmcp->config->spip);
 
-  /* Wait for data availability.*/
-  for (i = 0U; i < MMC_WAIT_DATA; i++) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFEU) {
-      uint32_t *wp;
-
-      spiReceive(mmcp->config->spip, 16, buf);
-      bp = buf;
-      for (wp = &cxd[3]; wp >= cxd; wp--) {
-        *wp = ((uint32_t)bp[0] << 24U) | ((uint32_t)bp[1] << 16U) |
-              ((uint32_t)bp[2] << 8U)  | (uint32_t)bp[3];
-        bp += 4;
-      }
+  bp = buf;
+  for (wp = &cxd[3]; wp >= cxd; wp--) {
+    *wp = ((uint32_t)bp[0] << 24U) | ((uint32_t)bp[1] << 16U) |
+          ((uint32_t)bp[2] << 8U)  | (uint32_t)bp[3];
+    bp += 4;
+  }
+  return HAL_SUCCESS;
+}
 
-      /* CRC ignored then end of transaction. */
-      spiIgnore(mmcp->config->spip, 2);
-      spiUnselect(mmcp->config->spip);
+/**
+ * @brief   Starts a multiple blocks transfer from the next block.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @param[in] cmd       the read or write multiple block command
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  the operation succeeded.
+ * @retval HAL_FAILED   the operation failed.
+ *
+ * @notapi
+ */
+static bool start_multiple(MMCDriver *mmcp, uint8_t cmd) {
+  uint32_t addr;
 
-      return HAL_SUCCESS;
-    }
+  addr = mmcp->nextblk;
+  if (!mmcp->block_addresses) {
+    addr *= MMCSD_BLOCK_SIZE;
   }
-  return HAL_FAILED;
+  if (send_cmd(mmcp, cmd, addr) != 0x00U) {
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Stops a multiple blocks read transfer.
+ * @note    The slave is left selected.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ *
+ * @notapi
+ */
+static void stop_read(MMCDriver *mmcp) {
+  static const uint8_t stopcmd[] = {
+    (uint8_t)(0x40U | MMCSD_CMD_STOP_TRANSMISSION), 0, 0, 0, 0, 0x61, 0xFF
+  };
+
+  spiSend(mmcp->config->spip, sizeof(stopcmd), stopcmd);
+/*  result = recvr1(mmcp) != 0x00U;*/
+  /* Note, ignored r1 response, it can be not zero, unknown issue.*/
+  (void) recvr1(mmcp);
 }
 
 /**
@@ -352,19 +531,9 @@ static bool read_CxD(MMCDriver *mmcp, uint8_t cmd, uint32_t cxd[4]) {
  * @notapi
  */
 static void sync(MMCDriver *mmcp) {
-  uint8_t buf[1];
 
   spiSelect(mmcp->config->spip);
-  while (true) {
-    spiReceive(mmcp->config->spip, 1, buf);
-    if (buf[0] == 0xFFU) {
-      break;
-    }
-#if MMC_NICE_WAITING == TRUE
-    /* Trying to be nice with the other threads.*/
-    osalThreadSleepMilliseconds(1);
-#endif
-  }
+  wait(mmcp);
   spiUnselect(mmcp->config->spip);
 }
 
@@ -396,6 +565,7 @@ void mmcObjectInit(MMCDriver *mmcp) {
   mmcp->state = BLK_STOP;
   mmcp->config = NULL;
   mmcp->block_addresses = false;
+  mmcp->nextblk = 0U;
 }
 
 /**
@@ -530,6 +700,13 @@ bool mmcConnect(MMCDriver *mmcp) {
   /* Initialization complete, full speed.*/
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
 
+#if MMC_USE_DATA_CRC == TRUE
+  /* Enabling the CRC checking on the card side.*/
+  if (send_command_R1(mmcp, MMCSD_CMD_CRC_ON_OFF, 1) != 0x00U) {
+    goto failed;
+  }
+#endif
+
   /* Setting block size.*/
   if (send_command_R1(mmcp, MMCSD_CMD_SET_BLOCKLEN,
                       MMCSD_BLOCK_SIZE) != 0x00U) {
@@ -620,14 +797,9 @@ bool mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
   spiSelect(mmcp->config->spip);
 
-  if (mmcp->block_addresses) {
-    send_hdr(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK, startblk);
-  }
-  else {
-    send_hdr(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK, startblk * MMCSD_BLOCK_SIZE);
-  }
-
-  if (recvr1(mmcp) != 0x00U) {
+  mmcp->nextblk = startblk;
+  if (start_multiple(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK)) {
+    spiUnselect(mmcp->config->spip);
     spiStop(mmcp->config->spip);
     mmcp->state = BLK_READY;
     return HAL_FAILED;
@@ -637,6 +809,9 @@ bool mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
 
 /**
  * @brief   Reads a block within a sequential read operation.
+ * @note    A block received with a CRC error is read again, up to
+ *          @p MMC_CRC_RETRY times, restarting the transmission from the
+ *          same block.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
  * @param[out] buffer   pointer to the read buffer
@@ -649,6 +824,7 @@ bool mmcStartSequentialRead(MMCDriver *mmcp, uint32_t startblk) {
  */
 bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
   unsigned i;
+  bool crcerr;
 
   osalDbgCheck((mmcp != NULL) && (buffer != NULL));
 
@@ -656,19 +832,24 @@ bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
     return HAL_FAILED;
   }
 
-  for (i = 0; i < MMC_WAIT_DATA; i++) {
-    spiReceive(mmcp->config->spip, 1, buffer);
-    if (buffer[0] == 0xFEU) {
-      spiReceive(mmcp->config->spip, MMCSD_BLOCK_SIZE, buffer);
-      /* CRC ignored. */
-      spiIgnore(mmcp->config->spip, 2);
-      return HAL_SUCCESS;
+  i = 0U;
+  while (recv_block(mmcp, buffer, MMCSD_BLOCK_SIZE, &crcerr) != HAL_SUCCESS) {
+    if (!crcerr || (++i > MMC_CRC_RETRY)) {
+      goto failed;
+    }
+    stop_read(mmcp);
+    if (start_multiple(mmcp, MMCSD_CMD_READ_MULTIPLE_BLOCK)) {
+      goto failed;
     }
   }
-  /* Timeout.*/
-  spiUnselect(mmcp->config->spip);
+  mmcp->nextblk++;
+  return HAL_SUCCESS;
+
+  /* Error, the card could still be sending data so the transfer is
+     stopped before releasing the bus.*/
+failed:
+  (void) mmcStopSequentialRead(mmcp);
   spiStop(mmcp->config->spip);
-  mmcp->state = BLK_READY;
   return HAL_FAILED;
 }
 
@@ -684,9 +865,6 @@ bool mmcSequentialRead(MMCDriver *mmcp, uint8_t *buffer) {
  * @api
  */
 bool mmcStopSequentialRead(MMCDriver *mmcp) {
-  static const uint8_t stopcmd[] = {
-    (uint8_t)(0x40U | MMCSD_CMD_STOP_TRANSMISSION), 0, 0, 0, 0, 1, 0xFF
-  };
 
   osalDbgCheck(mmcp != NULL);
 
@@ -694,10 +872,7 @@ bool mmcStopSequentialRead(MMCDriver *mmcp) {
     return HAL_FAILED;
   }
 
-  spiSend(mmcp->config->spip, sizeof(stopcmd), stopcmd);
-/*  result = recvr1(mmcp) != 0x00U;*/
-  /* Note, ignored r1 response, it can be not zero, unknown issue.*/
-  (void) recvr1(mmcp);
+  stop_read(mmcp);
 
   /* Read operation finished.*/
   spiUnselect(mmcp->config->spip);
@@ -727,15 +902,10 @@ bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
 
   spiStart(mmcp->config->spip, mmcp->config->hscfg);
   spiSelect(mmcp->config->spip);
-  if (mmcp->block_addresses) {
-    send_hdr(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK, startblk);
-  }
-  else {
-    send_hdr(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK,
-             startblk * MMCSD_BLOCK_SIZE);
-  }
 
-  if (recvr1(mmcp) != 0x00U) {
+  mmcp->nextblk = startblk;
+  if (start_multiple(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK)) {
+    spiUnselect(mmcp->config->spip);
     spiStop(mmcp->config->spip);
     mmcp->state = BLK_READY;
     return HAL_FAILED;
@@ -745,6 +915,12 @@ bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
 
 /**
  * @brief   Writes a block within a sequential write operation.
+ * @note    The function returns as soon as the block has been accepted by
+ *          the card, the end of the programming is awaited before sending
+ *          the next block so the caller can prepare it meanwhile.
+ * @note    A block rejected by the card because of a CRC error is sent
+ *          again, up to @p MMC_CRC_RETRY times, restarting the
+ *          transmission from the same block.
  *
  * @param[in] mmcp      pointer to the @p MMCDriver object
  * @param[out] buffer   pointer to the write buffer
@@ -757,7 +933,12 @@ bool mmcStartSequentialWrite(MMCDriver *mmcp, uint32_t startblk) {
  */
 bool mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
   static const uint8_t start[] = {0xFF, 0xFC};
-  uint8_t b[1];
+  static const uint8_t stop[] = {0xFD, 0xFF};
+  uint8_t b[2];
+#if MMC_USE_DATA_CRC == TRUE
+  unsigned i;
+  uint16_t crc;
+#endif
 
   osalDbgCheck((mmcp != NULL) && (buffer != NULL));
 
@@ -765,16 +946,45 @@ bool mmcSequentialWrite(MMCDriver *mmcp, const uint8_t *buffer) {
     return HAL_FAILED;
   }
 
-  spiSend(mmcp->config->spip, sizeof(start), start);    /* Data prologue.   */
-  spiSend(mmcp->config->spip, MMCSD_BLOCK_SIZE, buffer);/* Data.            */
-  spiIgnore(mmcp->config->spip, 2);                     /* CRC ignored.     */
-  spiReceive(mmcp->config->spip, 1, b);
-  if ((b[0] & 0x1FU) == 0x05U) {
+#if MMC_USE_DATA_CRC == TRUE
+  crc = crc16(0U, buffer, MMCSD_BLOCK_SIZE);
+  i = 0U;
+#endif
+  while (true) {
+    /* Waiting for the previous block to be programmed.*/
     wait(mmcp);
-    return HAL_SUCCESS;
+
+    spiSend(mmcp->config->spip, sizeof(start), start);     /* Data prologue.*/
+    spiSend(mmcp->config->spip, MMCSD_BLOCK_SIZE, buffer); /* Data.         */
+#if MMC_USE_DATA_CRC == TRUE
+    b[0] = (uint8_t)(crc >> 8U);
+    b[1] = (uint8_t)crc;
+    spiSend(mmcp->config->spip, 2, b);                     /* CRC.          */
+#else
+    spiIgnore(mmcp->config->spip, 2);                      /* CRC ignored.  */
+#endif
+    spiReceive(mmcp->config->spip, 1, b);
+    if ((b[0] & 0x1FU) == 0x05U) {
+      mmcp->nextblk++;
+      return HAL_SUCCESS;
+    }
+#if MMC_USE_DATA_CRC == TRUE
+    /* CRC error, the transmission is stopped and restarted from the
+       rejected block.*/
+    if (((b[0] & 0x1FU) == 0x0BU) && (++i <= MMC_CRC_RETRY)) {
+      spiSend(mmcp->config->spip, sizeof(stop), stop);
+      if (start_multiple(mmcp, MMCSD_CMD_WRITE_MULTIPLE_BLOCK) ==
+          HAL_SUCCESS) {
+        continue;
+      }
+    }
+#endif
+    break;
   }
 
-  /* Error.*/
+  /* Error, the card is still waiting for data so the transmission is
+     stopped before releasing the bus.*/
+  spiSend(mmcp->config->spip, sizeof(stop), stop);
   spiUnselect(mmcp->config->spip);
   spiStop(mmcp->config->spip);
   mmcp->state = BLK_READY;
@@ -801,6 +1011,8 @@ bool mmcStopSequentialWrite(MMCDriver *mmcp) {
     return HAL_FAILED;
   }
 
+  /* Waiting for the last block to be programmed.*/
+  wait(mmcp);
   spiSend(mmcp->config->spip, sizeof(stop), stop);
   spiUnselect(mmcp->config->spip);
 
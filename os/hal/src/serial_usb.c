@@ -133,6 +133,56 @@ static const struct SerialUSBDriverVMT vmt = {
   putt, gett, writet, readt
 };
 
+/**
+ * @brief   Starts an OUT transaction on the free input buffers.
+ * @details Contiguous empty buffers are chained into a single transaction.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @return              The operation status.
+ * @retval false        if there are no free buffers.
+ * @retval true         if a transaction has been started.
+ */
+static bool sdu_start_receive(SerialUSBDriver *sdup) {
+  size_t n;
+  uint8_t *buf;
+
+  buf = ibqGetEmptyBuffersI(&sdup->ibqueue, SERIAL_USB_MAX_CHAINED_BUFFERS,
+                            &n);
+  if (buf == NULL) {
+    return false;
+  }
+
+  usbStartReceiveI(sdup->config->usbp, sdup->config->bulk_out,
+                   buf, n * bqBufferSizeX(&sdup->ibqueue));
+
+  return true;
+}
+
+/**
+ * @brief   Starts an IN transaction on the filled output buffers.
+ * @details Contiguous filled buffers are chained into a single transaction.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @return              The operation status.
+ * @retval false        if there are no filled buffers.
+ * @retval true         if a transaction has been started.
+ */
+static bool sdu_start_transmit(SerialUSBDriver *sdup) {
+  size_t n, size;
+  uint8_t *buf;
+
+  buf = obqGetFullBuffersI(&sdup->obqueue, SERIAL_USB_MAX_CHAINED_BUFFERS,
+                           &size, &n);
+  if (buf == NULL) {
+    return false;
+  }
+
+  sdup->txbuffers = n;
+  usbStartTransmitI(sdup->config->usbp, sdup->config->bulk_in, buf, size);
+
+  return true;
+}
+
 /**
  * @brief   Notification of empty buffer released into the input buffers queue.
  *
@@ -148,15 +198,10 @@ static void ibnotify(io_buffers_queue_t *bqp) {
     return;
   }
 
-  /* Checking if there is already a transaction ongoing on the endpoint.*/
+  /* Checking if there is already a transaction ongoing on the endpoint,
+     if not then trying to start one on the free buffers.*/
   if (!usbGetReceiveStatusI(sdup->config->usbp, sdup->config->bulk_out)) {
-    /* Trying to get a free buffer.*/
-    uint8_t *buf = ibqGetEmptyBufferI(&sdup->ibqueue);
-    if (buf != NULL) {
-      /* Buffer found, starting a new transaction.*/
-      usbStartReceiveI(sdup->config->usbp, sdup->config->bulk_out,
-                       buf, SERIAL_USB_BUFFERS_SIZE);
-    }
+    (void)sdu_start_receive(sdup);
   }
 }
 
@@ -166,7 +211,6 @@ static void ibnotify(io_buffers_queue_t *bqp) {
  * @param[in] bqp       the buffers queue pointer.
  */
 static void obnotify(io_buffers_queue_t *bqp) {
-  size_t n;
   SerialUSBDriver *sdup = bqGetLinkX(bqp);
 
   /* If the USB driver is not in the appropriate state then transactions
@@ -176,14 +220,10 @@ static void obnotify(io_buffers_queue_t *bqp) {
     return;
   }
 
-  /* Checking if there is already a transaction ongoing on the endpoint.*/
+  /* Checking if there is already a transaction ongoing on the endpoint,
+     if not then trying to start one on the filled buffers.*/
   if (!usbGetTransmitStatusI(sdup->config->usbp, sdup->config->bulk_in)) {
-    /* Trying to get a full buffer.*/
-    uint8_t *buf = obqGetFullBufferI(&sdup->obqueue, &n);
-    if (buf != NULL) {
-      /* Buffer found, starting a new transaction.*/
-      usbStartTransmitI(sdup->config->usbp, sdup->config->bulk_in, buf, n);
-    }
+    (void)sdu_start_transmit(sdup);
   }
 }
 
@@ -201,6 +241,7 @@ static void obnotify(io_buffers_queue_t *bqp) {
 void sduInit(void) {
 }
 
+#if (SERIAL_USB_BUFFERS_NUMBER > 0) || defined(__DOXYGEN__)
 /**
  * @brief   Initializes a generic full duplex driver object.
  * @details The HW dependent part of the initialization has to be performed
@@ -212,15 +253,39 @@ void sduInit(void) {
  */
 void sduObjectInit(SerialUSBDriver *sdup) {
 
+  sduObjectInitBuffers(sdup, sdup->ib, sdup->ob,
+                       SERIAL_USB_BUFFERS_SIZE, SERIAL_USB_BUFFERS_NUMBER);
+}
+#endif
+
+/**
+ * @brief   Initializes a generic full duplex driver object using external
+ *          buffers.
+ * @details This variant allows buffers size and number to be chosen for
+ *          each driver instance.
+ *
+ * @param[out] sdup     pointer to a @p SerialUSBDriver structure
+ * @param[in] ib        input buffers area, it must be large
+ *                      <tt>BQ_BUFFER_SIZE(n, size)</tt> bytes
+ * @param[in] ob        output buffers area, it must be large
+ *                      <tt>BQ_BUFFER_SIZE(n, size)</tt> bytes
+ * @param[in] size      buffers size, it must be a multiple of the USB data
+ *                      endpoints maximum packet size
+ * @param[in] n         number of buffers for each direction
+ *
+ * @init
+ */
+void sduObjectInitBuffers(SerialUSBDriver *sdup, uint8_t *ib, uint8_t *ob,
+                          size_t size, size_t n) {
+
+  osalDbgCheck((sdup != NULL) && (n > 0U));
+
   sdup->vmt = &vmt;
   osalEventObjectInit(&sdup->event);
   sdup->state = SDU_STOP;
-  ibqObjectInit(&sdup->ibqueue, sdup->ib,
-                SERIAL_USB_BUFFERS_SIZE, SERIAL_USB_BUFFERS_NUMBER,
-                ibnotify, sdup);
-  obqObjectInit(&sdup->obqueue, sdup->ob,
-                SERIAL_USB_BUFFERS_SIZE, SERIAL_USB_BUFFERS_NUMBER,
-                obnotify, sdup);
+  sdup->txbuffers = 0U;
+  ibqObjectInit(&sdup->ibqueue, ib, size, n, ibnotify, sdup);
+  obqObjectInit(&sdup->obqueue, ob, size, n, obnotify, sdup);
 }
 
 /**
@@ -296,6 +361,7 @@ void sduDisconnectI(SerialUSBDriver *sdup) {
   chnAddFlagsI(sdup, CHN_DISCONNECTED);
   ibqResetI(&sdup->ibqueue);
   obqResetI(&sdup->obqueue);
+  sdup->txbuffers = 0U;
 }
 
 /**
@@ -306,19 +372,18 @@ void sduDisconnectI(SerialUSBDriver *sdup) {
  * @iclass
  */
 void sduConfigureHookI(SerialUSBDriver *sdup) {
-  uint8_t *buf;
+  bool started;
 
   ibqResetI(&sdup->ibqueue);
   obqResetI(&sdup->obqueue);
+  sdup->txbuffers = 0U;
   chnAddFlagsI(sdup, CHN_CONNECTED);
 
   /* Starts the first OUT transaction immediately.*/
-  buf = ibqGetEmptyBufferI(&sdup->ibqueue);
-
-  osalDbgAssert(buf != NULL, "no free buffer");
+  started = sdu_start_receive(sdup);
 
-  usbStartReceiveI(sdup->config->usbp, sdup->config->bulk_out,
-                   buf, SERIAL_USB_BUFFERS_SIZE);
+  osalDbgAssert(started, "no free buffer");
+  (void)started;
 }
 
 /**
@@ -384,12 +449,10 @@ void sduSOFHookI(SerialUSBDriver *sdup) {
   /* Checking if there only a buffer partially filled, if so then it is
      enforced in the queue and transmitted.*/
   if (obqTryFlushI(&sdup->obqueue)) {
-    size_t n;
-    uint8_t *buf = obqGetFullBufferI(&sdup->obqueue, &n);
-
-    osalDbgAssert(buf != NULL, "queue is empty");
+    bool started = sdu_start_transmit(sdup);
 
-    usbStartTransmitI(sdup->config->usbp, sdup->config->bulk_in, buf, n);
+    osalDbgAssert(started, "queue is empty");
+    (void)started;
   }
 }
 
@@ -402,8 +465,6 @@ void sduSOFHookI(SerialUSBDriver *sdup) {
  * @param[in] ep        IN endpoint number
  */
 void sduDataTransmitted(USBDriver *usbp, usbep_t ep) {
-  uint8_t *buf;
-  size_t n;
   SerialUSBDriver *sdup = usbp->in_params[ep - 1U];
 
   if (sdup == NULL) {
@@ -415,18 +476,16 @@ void sduDataTransmitted(USBDriver *usbp, usbep_t ep) {
   /* Signaling that space is available in the output queue.*/
   chnAddFlagsI(sdup, CHN_OUTPUT_EMPTY);
 
-  /* Freeing the buffer just transmitted, if it was not a zero size packet.*/
-  if (usbp->epc[ep]->in_state->txsize > 0U) {
-    obqReleaseEmptyBufferI(&sdup->obqueue);
-  }
-
-  /* Checking if there is a buffer ready for transmission.*/
-  buf = obqGetFullBufferI(&sdup->obqueue, &n);
+  /* Freeing the buffers just transmitted, none if it was a zero size
+     packet.*/
+  obqReleaseEmptyBuffersI(&sdup->obqueue, sdup->txbuffers);
+  sdup->txbuffers = 0U;
 
-  if (buf != NULL) {
-    /* The endpoint cannot be busy, we are in the context of the callback,
-       so it is safe to transmit without a check.*/
-    usbStartTransmitI(usbp, ep, buf, n);
+  /* Checking if there are buffers ready for transmission. The endpoint
+     cannot be busy, we are in the context of the callback, so it is safe
+     to transmit without a check.*/
+  if (sdu_start_transmit(sdup)) {
+    /* Transmission started.*/
   }
   else if ((usbp->epc[ep]->in_state->txsize > 0U) &&
            ((usbp->epc[ep]->in_state->txsize &
@@ -454,7 +513,7 @@ void sduDataTransmitted(USBDriver *usbp, usbep_t ep) {
  * @param[in] ep        OUT endpoint number
  */
 void sduDataReceived(USBDriver *usbp, usbep_t ep) {
-  uint8_t *buf;
+  size_t size;
   SerialUSBDriver *sdup = usbp->out_params[ep - 1U];
 
   if (sdup == NULL) {
@@ -463,23 +522,21 @@ void sduDataReceived(USBDriver *usbp, usbep_t ep) {
 
   osalSysLockFromISR();
 
-  /* Signaling that data is available in the input queue.*/
-  chnAddFlagsI(sdup, CHN_INPUT_AVAILABLE);
+  /* Posting the filled buffers in the queue, a zero size packet does not
+     carry data.*/
+  size = usbGetReceiveTransactionSizeX(sdup->config->usbp,
+                                       sdup->config->bulk_out);
+  if (size > 0U) {
+    /* Signaling that data is available in the input queue.*/
+    chnAddFlagsI(sdup, CHN_INPUT_AVAILABLE);
 
-  /* Posting the filled buffer in the queue.*/
-  ibqPostFullBufferI(&sdup->ibqueue,
-                     usbGetReceiveTransactionSizeX(sdup->config->usbp,
-                                                   sdup->config->bulk_out));
+    ibqPostFullBuffersI(&sdup->ibqueue, size);
+  }
 
   /* The endpoint cannot be busy, we are in the context of the callback,
-     so a packet is in the buffer for sure. Trying to get a free buffer
+     so a packet is in the buffer for sure. Trying to get free buffers
      for the next transaction.*/
-  buf = ibqGetEmptyBufferI(&sdup->ibqueue);
-  if (buf != NULL) {
-    /* Buffer found, starting a new transaction.*/
-    usbStartReceiveI(sdup->config->usbp, sdup->config->bulk_out,
-                     buf, SERIAL_USB_BUFFERS_SIZE);
-  }
+  (void)sdu_start_receive(sdup);
   osalSysUnlockFromISR();
 }
 
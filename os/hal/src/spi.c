@@ -30,6 +30,20 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Queue statistics time stamp.
+ * @details The realtime counter is used if supported by the port, the
+ *          system time otherwise.
+ */
+#if (defined(PORT_SUPPORTS_RT) && (PORT_SUPPORTS_RT == TRUE)) ||             \
+    defined(__DOXYGEN__)
+#define SPI_QUEUE_STAMP()           osalOsGetRealtimeCounterX()
+#else
+#define SPI_QUEUE_STAMP()           ((rtcnt_t)osalOsGetSystemTimeX())
+#endif
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -42,6 +56,88 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (SPI_USE_TRANSFER_LIST == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transfer list segment.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] sgp       pointer to the @p SPISegment to be started
+ *
+ * @notapi
+ */
+static void spi_segment_start(SPIDriver *spip, const SPISegment *sgp) {
+
+  osalDbgCheck(sgp->n > 0U);
+
+  if ((sgp->flags & SPI_SEGMENT_SELECT) != 0U) {
+    spi_lld_select(spip);
+  }
+  if (sgp->txbuf != NULL) {
+    if (sgp->rxbuf != NULL) {
+      spi_lld_exchange(spip, sgp->n, sgp->txbuf, sgp->rxbuf);
+    }
+    else {
+      spi_lld_send(spip, sgp->n, sgp->txbuf);
+    }
+  }
+  else if (sgp->rxbuf != NULL) {
+    spi_lld_receive(spip, sgp->n, sgp->rxbuf);
+  }
+  else {
+    spi_lld_ignore(spip, sgp->n);
+  }
+}
+#endif /* SPI_USE_TRANSFER_LIST == TRUE */
+
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Resets the queue statistics.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+static void spi_queue_reset_stats(SPIDriver *spip) {
+
+  spip->queue.stats.start     = osalOsGetSystemTimeX();
+  spip->queue.stats.completed = 0U;
+  spip->queue.stats.busy      = 0U;
+  spip->queue.stats.wait      = 0U;
+  spip->queue.stats.max_wait  = (rtcnt_t)0;
+}
+
+/**
+ * @brief   Starts a queued transaction.
+ * @details The driver is reconfigured if the transaction configuration
+ *          differs from the current one, this only happens with low level
+ *          drivers supporting reconfiguration from ISR context.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] trp       pointer to the @p SPITransaction object
+ *
+ * @notapi
+ */
+static void spi_queue_start(SPIDriver *spip, SPITransaction *trp) {
+  rtcnt_t now = SPI_QUEUE_STAMP();
+  rtcnt_t wait = now - trp->stamp;
+
+  spip->queue.current = trp;
+  spip->queue.start   = now;
+  spip->queue.stats.wait += wait;
+  if (wait > spip->queue.stats.max_wait) {
+    spip->queue.stats.max_wait = wait;
+  }
+
+#if SPI_SUPPORTS_ISR_RECONFIG == TRUE
+  if (spip->config != trp->config) {
+    spip->config = trp->config;
+    spi_lld_start(spip);
+  }
+#endif
+  spiStartTransferListI(spip, trp->list, trp->n);
+}
+#endif /* SPI_USE_QUEUE == TRUE */
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -72,6 +168,16 @@ void spiObjectInit(SPIDriver *spip) {
 #if SPI_USE_WAIT == TRUE
   spip->thread = NULL;
 #endif
+#if SPI_USE_TRANSFER_LIST == TRUE
+  spip->segp = NULL;
+  spip->segcnt = 0U;
+#endif
+#if SPI_USE_QUEUE == TRUE
+  spip->queue.head = NULL;
+  spip->queue.current = NULL;
+  spip->queue.start = (rtcnt_t)0;
+  spi_queue_reset_stats(spip);
+#endif
 #if SPI_USE_MUTUAL_EXCLUSION == TRUE
   osalMutexObjectInit(&spip->mutex);
 #endif
@@ -375,6 +481,287 @@ void spiReceive(SPIDriver *spip, size_t n, void *rxbuf) {
 }
 #endif /* SPI_USE_WAIT == TRUE */
 
+#if (SPI_USE_TRANSFER_LIST == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a transfer list.
+ * @details The segments of the list are executed back-to-back, each segment
+ *          is started from the completion interrupt of the previous one.
+ *          The slave select line is handled according to the flags of
+ *          each segment.
+ * @post    At the end of the last segment the configured callback is
+ *          invoked.
+ * @note    The list must remain valid until the operation is complete.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] list      pointer to an array of @p SPISegment structures
+ * @param[in] n         number of segments in the list
+ *
+ * @iclass
+ */
+void spiStartTransferListI(SPIDriver *spip,
+                           const SPISegment *list, size_t n) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((spip != NULL) && (list != NULL) && (n > 0U));
+  osalDbgAssert(spip->state == SPI_READY, "not ready");
+
+  spip->state  = SPI_ACTIVE;
+  spip->segp   = list;
+  spip->segcnt = n;
+  spi_segment_start(spip, list);
+}
+
+/**
+ * @brief   Starts a transfer list.
+ * @details The segments of the list are executed back-to-back, each segment
+ *          is started from the completion interrupt of the previous one.
+ *          The slave select line is handled according to the flags of
+ *          each segment.
+ * @post    At the end of the last segment the configured callback is
+ *          invoked.
+ * @note    The list must remain valid until the operation is complete.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] list      pointer to an array of @p SPISegment structures
+ * @param[in] n         number of segments in the list
+ *
+ * @api
+ */
+void spiStartTransferList(SPIDriver *spip,
+                          const SPISegment *list, size_t n) {
+
+  osalDbgCheck((spip != NULL) && (list != NULL) && (n > 0U));
+
+  osalSysLock();
+  spiStartTransferListI(spip, list, n);
+  osalSysUnlock();
+}
+
+#if (SPI_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Performs a transfer list.
+ * @details The segments of the list are executed back-to-back, each segment
+ *          is started from the completion interrupt of the previous one.
+ *          The slave select line is handled according to the flags of
+ *          each segment.
+ * @pre     In order to use this function the option @p SPI_USE_WAIT must be
+ *          enabled.
+ * @pre     In order to use this function the driver must have been configured
+ *          without callbacks (@p end_cb = @p NULL).
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] list      pointer to an array of @p SPISegment structures
+ * @param[in] n         number of segments in the list
+ *
+ * @api
+ */
+void spiTransferList(SPIDriver *spip, const SPISegment *list, size_t n) {
+
+  osalDbgCheck((spip != NULL) && (list != NULL) && (n > 0U));
+
+  osalSysLock();
+  osalDbgAssert(spip->config->end_cb == NULL, "has callback");
+  spiStartTransferListI(spip, list, n);
+  (void) osalThreadSuspendS(&spip->thread);
+  osalSysUnlock();
+}
+#endif /* SPI_USE_WAIT == TRUE */
+
+/**
+ * @brief   Transfer list step.
+ * @details Terminates the current segment and starts the next one, if any.
+ * @note    This function is meant to be invoked from the low level drivers
+ *          completion interrupt through @p _spi_isr_code().
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @return              The transfer list state.
+ * @retval false        if the last segment has been completed.
+ * @retval true         if the next segment has been started.
+ *
+ * @notapi
+ */
+bool _spi_list_next(SPIDriver *spip) {
+  const SPISegment *sgp = spip->segp;
+
+  if ((sgp->flags & SPI_SEGMENT_UNSELECT) != 0U) {
+    spi_lld_unselect(spip);
+  }
+
+  spip->segcnt--;
+  if (spip->segcnt == 0U) {
+    spip->segp = NULL;
+    return false;
+  }
+
+  /* Next segment started immediately, the peripheral is kept busy.*/
+  sgp++;
+  spip->segp = sgp;
+  spi_segment_start(spip, sgp);
+
+  return true;
+}
+#endif /* SPI_USE_TRANSFER_LIST == TRUE */
+
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Submits a transaction to the driver queue.
+ * @details If the bus is idle then the transaction is started immediately
+ *          else it is inserted in the queue according to its priority.
+ *          Queued transactions are started back-to-back from the
+ *          completion interrupt of the previous one.
+ * @pre     The driver must have been started using @p spiStart().
+ * @post    At the end of the transaction its callback is invoked.
+ * @note    With low level drivers exporting @p SPI_SUPPORTS_ISR_RECONFIG
+ *          the driver is reconfigured, from ISR context, when a transaction
+ *          uses a configuration different from the current one, with the
+ *          other drivers all the transactions must use the configuration
+ *          passed to @p spiStart().
+ * @note    The slave select line is handled by the transfer list segment
+ *          flags.
+ * @note    A driver used through the queue must not be accessed using the
+ *          other APIs at the same time.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] trp       pointer to the @p SPITransaction object
+ *
+ * @iclass
+ */
+void spiQueueSubmitI(SPIDriver *spip, SPITransaction *trp) {
+  SPITransaction **pp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck((spip != NULL) && (trp != NULL) && (trp->config != NULL) &&
+               (trp->list != NULL) && (trp->n > 0U));
+  osalDbgAssert((spip->state == SPI_READY) || (spip->state == SPI_ACTIVE) ||
+                (spip->state == SPI_COMPLETE), "not ready");
+#if SPI_SUPPORTS_ISR_RECONFIG == FALSE
+  osalDbgAssert(trp->config == spip->config, "reconfiguration not supported");
+#endif
+
+  trp->stamp = SPI_QUEUE_STAMP();
+#if SPI_USE_WAIT == TRUE
+  trp->thread = NULL;
+#endif
+
+  /* Bus idle, the transaction is started immediately.*/
+  if ((spip->queue.current == NULL) && (spip->state == SPI_READY)) {
+    spi_queue_start(spip, trp);
+    return;
+  }
+
+  /* Inserted after the transactions with the same or higher priority.*/
+  pp = &spip->queue.head;
+  while ((*pp != NULL) && ((*pp)->prio >= trp->prio)) {
+    pp = &(*pp)->next;
+  }
+  trp->next = *pp;
+  *pp = trp;
+}
+
+/**
+ * @brief   Submits a transaction to the driver queue.
+ * @details If the bus is idle then the transaction is started immediately
+ *          else it is inserted in the queue according to its priority.
+ *          Queued transactions are started back-to-back from the
+ *          completion interrupt of the previous one.
+ * @pre     The driver must have been started using @p spiStart().
+ * @post    At the end of the transaction its callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] trp       pointer to the @p SPITransaction object
+ *
+ * @api
+ */
+void spiQueueSubmit(SPIDriver *spip, SPITransaction *trp) {
+
+  osalSysLock();
+  spiQueueSubmitI(spip, trp);
+  osalSysUnlock();
+}
+
+#if (SPI_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Performs a queued transaction.
+ * @details The transaction is submitted to the driver queue and the
+ *          invoking thread waits for its completion.
+ * @pre     In order to use this function the option @p SPI_USE_WAIT must be
+ *          enabled.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] trp       pointer to the @p SPITransaction object
+ *
+ * @api
+ */
+void spiQueueTransfer(SPIDriver *spip, SPITransaction *trp) {
+
+  osalSysLock();
+  spiQueueSubmitI(spip, trp);
+  (void) osalThreadSuspendS(&trp->thread);
+  osalSysUnlock();
+}
+#endif /* SPI_USE_WAIT == TRUE */
+
+/**
+ * @brief   Returns the queue statistics.
+ * @details The statistics are reset after being read.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[out] statsp   pointer to the statistics to be filled
+ *
+ * @api
+ */
+void spiQueueGetStats(SPIDriver *spip, spi_queue_stats_t *statsp) {
+
+  osalDbgCheck((spip != NULL) && (statsp != NULL));
+
+  osalSysLock();
+  *statsp = spip->queue.stats;
+  spi_queue_reset_stats(spip);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Transactions queue step.
+ * @details Completes the queued transaction in progress, if any, then the
+ *          next pending transaction is started.
+ * @note    This function is meant to be invoked from the low level drivers
+ *          completion interrupt through @p _spi_isr_code().
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void _spi_queue_next(SPIDriver *spip) {
+  SPITransaction *trp = spip->queue.current;
+
+  /* The transaction callback is invoked outside the critical zone like
+     the driver callback.*/
+  if ((trp != NULL) && (trp->cb != NULL)) {
+    trp->cb(spip, trp);
+  }
+
+  osalSysLockFromISR();
+  if (trp != NULL) {
+    spip->queue.current = NULL;
+    spip->queue.stats.completed++;
+    spip->queue.stats.busy += (rtcnt_t)(SPI_QUEUE_STAMP() -
+                                        spip->queue.start);
+#if SPI_USE_WAIT == TRUE
+    osalThreadResumeI(&trp->thread, MSG_OK);
+#endif
+  }
+
+  /* Next transaction, unless the callback started another operation.*/
+  if ((spip->queue.head != NULL) && (spip->queue.current == NULL) &&
+      (spip->state == SPI_READY)) {
+    trp = spip->queue.head;
+    spip->queue.head = trp->next;
+    spi_queue_start(spip, trp);
+  }
+  osalSysUnlockFromISR();
+}
+#endif /* SPI_USE_QUEUE == TRUE */
+
 #if (SPI_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Gains exclusive access to the SPI bus.
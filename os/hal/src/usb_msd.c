@@ -0,0 +1,919 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    usb_msd.c
+ * @brief   USB Mass Storage Driver code.
+ *
+ * @addtogroup USB_MSD
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if (HAL_USE_USB_MSD == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @name    Command Block Wrapper fields offsets
+ * @{
+ */
+#define CBW_SIGNATURE                       0U
+#define CBW_TAG                             4U
+#define CBW_DATA_LENGTH                     8U
+#define CBW_FLAGS                           12U
+#define CBW_LUN                             13U
+#define CBW_CB_LENGTH                       14U
+#define CBW_CB                              15U
+
+#define CBW_FLAGS_DATA_IN                   0x80U
+#define CBW_CB_MAX_LENGTH                   16U
+/** @} */
+
+/**
+ * @name    Command Status Wrapper fields offsets
+ * @{
+ */
+#define CSW_SIGNATURE                       0U
+#define CSW_TAG                             4U
+#define CSW_DATA_RESIDUE                    8U
+#define CSW_STATUS                          12U
+/** @} */
+
+/**
+ * @name    Response sizes
+ * @{
+ */
+#define INQUIRY_SIZE                        36U
+#define REQUEST_SENSE_SIZE                  18U
+#define MODE_SENSE_6_SIZE                   4U
+#define READ_CAPACITY_10_SIZE               8U
+/** @} */
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint32_t get_le32(const uint8_t *p) {
+
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void put_be32(uint8_t *p, uint32_t v) {
+
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+/**
+ * @brief   Copies a string into a fixed size, space padded, field.
+ */
+static void copy_padded(uint8_t *dp, const char *s, size_t n) {
+
+  while (n > 0U) {
+    if ((s != NULL) && (*s != '\0')) {
+      *dp = (uint8_t)*s;
+      s++;
+    }
+    else {
+      *dp = (uint8_t)' ';
+    }
+    dp++;
+    n--;
+  }
+}
+
+/**
+ * @brief   Sets the sense data and fails the current command.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[in] key       the sense key
+ * @param[in] asc       the additional sense code
+ * @return              The command status.
+ */
+static uint8_t msd_fail(USBMassStorageDriver *msdp, uint8_t key, uint8_t asc) {
+
+  msdp->sense_key = key;
+  msdp->sense_asc = asc;
+
+  return MSD_CSW_STATUS_FAILED;
+}
+
+/**
+ * @brief   Starts an IN transaction on the bulk IN endpoint.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[in] buf       buffer to be transmitted
+ * @param[in] n         number of bytes to be transmitted
+ * @return              The operation status.
+ * @retval MSG_OK       if the transaction has been started.
+ * @retval MSG_RESET    if the driver has been reset or disconnected.
+ */
+static msg_t msd_start_transmit(USBMassStorageDriver *msdp,
+                                const uint8_t *buf, size_t n) {
+  USBDriver *usbp = msdp->config->usbp;
+  msg_t msg = MSG_RESET;
+
+  osalSysLock();
+  if ((usbGetDriverStateI(usbp) == USB_ACTIVE) &&
+      (msdp->state == MSD_ACTIVE) &&
+      !usbGetTransmitStatusI(usbp, msdp->config->bulk_in)) {
+    usbStartTransmitI(usbp, msdp->config->bulk_in, buf, n);
+    msg = MSG_OK;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Starts an OUT transaction on the bulk OUT endpoint.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[out] buf      buffer for the incoming data
+ * @param[in] n         maximum number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the transaction has been started.
+ * @retval MSG_RESET    if the driver has been reset or disconnected.
+ */
+static msg_t msd_start_receive(USBMassStorageDriver *msdp,
+                               uint8_t *buf, size_t n) {
+  USBDriver *usbp = msdp->config->usbp;
+  msg_t msg = MSG_RESET;
+
+  osalSysLock();
+  if ((usbGetDriverStateI(usbp) == USB_ACTIVE) &&
+      ((msdp->state == MSD_READY) || (msdp->state == MSD_ACTIVE)) &&
+      !usbGetReceiveStatusI(usbp, msdp->config->bulk_out)) {
+    msdp->rxbuf = buf;
+    usbStartReceiveI(usbp, msdp->config->bulk_out, buf, n);
+    msg = MSG_OK;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Waits for the IN transaction in progress, if any, to complete.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @return              The operation status.
+ * @retval MSG_OK       if the endpoint is idle.
+ * @retval MSG_RESET    if the driver has been reset or disconnected.
+ */
+static msg_t msd_wait_transmit(USBMassStorageDriver *msdp) {
+  USBDriver *usbp = msdp->config->usbp;
+  msg_t msg = MSG_OK;
+
+  osalSysLock();
+  while ((msg == MSG_OK) &&
+         usbGetTransmitStatusI(usbp, msdp->config->bulk_in)) {
+    msg = osalThreadSuspendS(&msdp->thread);
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Waits for the OUT transaction in progress, if any, to complete.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @return              The operation status.
+ * @retval MSG_OK       if the endpoint is idle.
+ * @retval MSG_RESET    if the driver has been reset or disconnected.
+ */
+static msg_t msd_wait_receive(USBMassStorageDriver *msdp) {
+  USBDriver *usbp = msdp->config->usbp;
+  msg_t msg = MSG_OK;
+
+  osalSysLock();
+  while ((msg == MSG_OK) &&
+         usbGetReceiveStatusI(usbp, msdp->config->bulk_out)) {
+    msg = osalThreadSuspendS(&msdp->thread);
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Sends a command response as data phase.
+ * @details The response is truncated to the length expected by the host.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[in] n         size of the response in the first buffer
+ * @return              The operation status.
+ */
+static msg_t msd_send_response(USBMassStorageDriver *msdp, size_t n) {
+  msg_t msg;
+
+  if ((msdp->cbw[CBW_FLAGS] & CBW_FLAGS_DATA_IN) == 0U) {
+    /* The host is not expecting data, the data phase is skipped.*/
+    return MSG_OK;
+  }
+  if (n > msdp->residue) {
+    n = (size_t)msdp->residue;
+  }
+  if (n == 0U) {
+    return MSG_OK;
+  }
+
+  msg = msd_start_transmit(msdp, msdp->buf[0], n);
+  if (msg == MSG_OK) {
+    msg = msd_wait_transmit(msdp);
+    msdp->residue -= (uint32_t)n;
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Verifies that the media is present and usable.
+ * @details The block device is connected if required and the media
+ *          information is updated.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @return              The media status.
+ * @retval true         if the media is ready.
+ * @retval false        if the media is not ready, the sense data is set.
+ */
+static bool msd_media_ready(USBMassStorageDriver *msdp) {
+  BaseBlockDevice *bbdp = msdp->config->bbdp;
+
+  if (!blkIsInserted(bbdp)) {
+    (void)msd_fail(msdp, SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+    return false;
+  }
+
+  if ((blkGetDriverState(bbdp) != BLK_READY) &&
+      (blkConnect(bbdp) == HAL_FAILED)) {
+    (void)msd_fail(msdp, SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+    return false;
+  }
+
+  /* The transfer buffers must contain an integral number of blocks.*/
+  if ((blkGetInfo(bbdp, &msdp->info) == HAL_FAILED) ||
+      (msdp->info.blk_size == 0U) ||
+      (((uint32_t)USB_MSD_BUFFERS_SIZE % msdp->info.blk_size) != 0U)) {
+    (void)msd_fail(msdp, SCSI_SENSE_NOT_READY, SCSI_ASC_MEDIUM_NOT_PRESENT);
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Validates the range of a READ(10) or WRITE(10) command.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[in] dir_in    expected direction of the data phase
+ * @param[out] lbap     first block of the transfer
+ * @param[out] np       number of blocks of the transfer
+ * @return              The command status, @p MSD_CSW_STATUS_PASSED if the
+ *                      transfer can be performed.
+ */
+static uint8_t msd_check_transfer(USBMassStorageDriver *msdp, bool dir_in,
+                                  uint32_t *lbap, uint32_t *np) {
+  const uint8_t *cb = &msdp->cbw[CBW_CB];
+
+  *lbap = get_be32(&cb[2]);
+  *np   = ((uint32_t)cb[7] << 8) | (uint32_t)cb[8];
+
+  if (!msd_media_ready(msdp)) {
+    return MSD_CSW_STATUS_FAILED;
+  }
+
+  if ((*lbap >= msdp->info.blk_num) ||
+      (*np > (msdp->info.blk_num - *lbap))) {
+    return msd_fail(msdp, SCSI_SENSE_ILLEGAL_REQUEST,
+                    SCSI_ASC_LBA_OUT_OF_RANGE);
+  }
+
+  /* The data phase must have the right direction and be large enough.*/
+  if ((*np > 0U) &&
+      ((((msdp->cbw[CBW_FLAGS] & CBW_FLAGS_DATA_IN) != 0U) != dir_in) ||
+       (*np > (msdp->residue / msdp->info.blk_size)))) {
+    return msd_fail(msdp, SCSI_SENSE_ILLEGAL_REQUEST,
+                    SCSI_ASC_INVALID_FIELD_IN_CDB);
+  }
+
+  return MSD_CSW_STATUS_PASSED;
+}
+
+/**
+ * @brief   READ(10) command.
+ * @details The block device is read into a buffer while the previous
+ *          buffer is being transmitted.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[out] statusp  the command status
+ * @return              The operation status.
+ */
+static msg_t msd_cmd_read(USBMassStorageDriver *msdp, uint8_t *statusp) {
+  uint32_t lba, nblk, per;
+  unsigned i = 0U;
+  msg_t msg;
+
+  *statusp = msd_check_transfer(msdp, true, &lba, &nblk);
+  if (*statusp != MSD_CSW_STATUS_PASSED) {
+    return MSG_OK;
+  }
+
+  per = (uint32_t)USB_MSD_BUFFERS_SIZE / msdp->info.blk_size;
+  while (nblk > 0U) {
+    uint32_t n = nblk < per ? nblk : per;
+
+    if (blkRead(msdp->config->bbdp, lba, msdp->buf[i], n) == HAL_FAILED) {
+      *statusp = msd_fail(msdp, SCSI_SENSE_MEDIUM_ERROR, SCSI_ASC_READ_ERROR);
+      break;
+    }
+
+    /* The previous buffer must have been transmitted before starting
+       with the next one.*/
+    msg = msd_wait_transmit(msdp);
+    if (msg == MSG_OK) {
+      msg = msd_start_transmit(msdp, msdp->buf[i], n * msdp->info.blk_size);
+    }
+    if (msg != MSG_OK) {
+      return msg;
+    }
+
+    msdp->residue -= n * msdp->info.blk_size;
+    lba  += n;
+    nblk -= n;
+    i ^= 1U;
+  }
+
+  return msd_wait_transmit(msdp);
+}
+
+/**
+ * @brief   WRITE(10) command.
+ * @details The next buffer is received while the previous buffer is
+ *          being written into the block device.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[out] statusp  the command status
+ * @return              The operation status.
+ */
+static msg_t msd_cmd_write(USBMassStorageDriver *msdp, uint8_t *statusp) {
+  uint32_t lba, nblk, per, n;
+  unsigned i = 0U;
+  msg_t msg;
+
+  *statusp = msd_check_transfer(msdp, false, &lba, &nblk);
+  if (*statusp != MSD_CSW_STATUS_PASSED) {
+    return MSG_OK;
+  }
+  if (blkIsWriteProtected(msdp->config->bbdp)) {
+    *statusp = msd_fail(msdp, SCSI_SENSE_DATA_PROTECT,
+                        SCSI_ASC_WRITE_PROTECTED);
+    return MSG_OK;
+  }
+  if (nblk == 0U) {
+    return MSG_OK;
+  }
+
+  per = (uint32_t)USB_MSD_BUFFERS_SIZE / msdp->info.blk_size;
+  n = nblk < per ? nblk : per;
+  msg = msd_start_receive(msdp, msdp->buf[0], n * msdp->info.blk_size);
+  while (msg == MSG_OK) {
+    uint32_t next;
+
+    msg = msd_wait_receive(msdp);
+    if (msg != MSG_OK) {
+      break;
+    }
+    if (usbGetReceiveTransactionSizeX(msdp->config->usbp,
+                                      msdp->config->bulk_out) !=
+        (size_t)(n * msdp->info.blk_size)) {
+      /* Short data phase, the host aborted the transfer.*/
+      *statusp = MSD_CSW_STATUS_PHASE_ERROR;
+      break;
+    }
+    msdp->residue -= n * msdp->info.blk_size;
+    nblk -= n;
+
+    /* Receiving the next buffer while writing this one.*/
+    next = nblk < per ? nblk : per;
+    if (next > 0U) {
+      msg = msd_start_receive(msdp, msdp->buf[i ^ 1U],
+                              next * msdp->info.blk_size);
+    }
+
+    if ((*statusp == MSD_CSW_STATUS_PASSED) &&
+        (blkWrite(msdp->config->bbdp, lba, msdp->buf[i], n) == HAL_FAILED)) {
+      /* The remaining data is still accepted, the failure is reported
+         in the status phase.*/
+      *statusp = msd_fail(msdp, SCSI_SENSE_MEDIUM_ERROR,
+                          SCSI_ASC_WRITE_FAULT);
+    }
+
+    if (next == 0U) {
+      break;
+    }
+    lba += n;
+    n = next;
+    i ^= 1U;
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Executes the SCSI command in the current Command Block Wrapper.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[out] statusp  the command status
+ * @return              The operation status.
+ */
+static msg_t msd_execute(USBMassStorageDriver *msdp, uint8_t *statusp) {
+  const uint8_t *cb = &msdp->cbw[CBW_CB];
+  uint8_t *rp = msdp->buf[0];
+
+  *statusp = MSD_CSW_STATUS_PASSED;
+
+  switch (cb[0]) {
+  case SCSI_CMD_TEST_UNIT_READY:
+    if (!msd_media_ready(msdp)) {
+      *statusp = MSD_CSW_STATUS_FAILED;
+    }
+    return MSG_OK;
+  case SCSI_CMD_REQUEST_SENSE:
+    memset(rp, 0, REQUEST_SENSE_SIZE);
+    rp[0]  = 0x70U;                     /* Current errors, fixed format.   */
+    rp[2]  = msdp->sense_key;
+    rp[7]  = REQUEST_SENSE_SIZE - 8U;
+    rp[12] = msdp->sense_asc;
+    msdp->sense_key = SCSI_SENSE_NO_SENSE;
+    msdp->sense_asc = SCSI_ASC_NONE;
+    return msd_send_response(msdp, cb[4] < REQUEST_SENSE_SIZE ?
+                                   (size_t)cb[4] : REQUEST_SENSE_SIZE);
+  case SCSI_CMD_INQUIRY:
+    if ((cb[1] & 0x01U) != 0U) {
+      /* Vital product data pages are not supported.*/
+      *statusp = msd_fail(msdp, SCSI_SENSE_ILLEGAL_REQUEST,
+                          SCSI_ASC_INVALID_FIELD_IN_CDB);
+      return MSG_OK;
+    }
+    memset(rp, 0, INQUIRY_SIZE);
+    rp[1] = 0x80U;                      /* Removable medium.               */
+    rp[2] = 0x04U;                      /* SPC-2.                          */
+    rp[3] = 0x02U;                      /* Response data format.           */
+    rp[4] = INQUIRY_SIZE - 5U;
+    copy_padded(&rp[8], msdp->config->vendor, 8U);
+    copy_padded(&rp[16], msdp->config->product, 16U);
+    copy_padded(&rp[32], msdp->config->revision, 4U);
+    return msd_send_response(msdp, cb[4] < INQUIRY_SIZE ?
+                                   (size_t)cb[4] : INQUIRY_SIZE);
+  case SCSI_CMD_MODE_SENSE_6:
+    rp[0] = MODE_SENSE_6_SIZE - 1U;
+    rp[1] = 0x00U;
+    rp[2] = 0x00U;
+    rp[3] = 0x00U;
+    if (blkIsInserted(msdp->config->bbdp) &&
+        blkIsWriteProtected(msdp->config->bbdp)) {
+      rp[2] = 0x80U;                    /* Write protected.                */
+    }
+    return msd_send_response(msdp, cb[4] < MODE_SENSE_6_SIZE ?
+                                   (size_t)cb[4] : MODE_SENSE_6_SIZE);
+  case SCSI_CMD_START_STOP_UNIT:
+  case SCSI_CMD_PREVENT_ALLOW_REMOVAL:
+    return MSG_OK;
+  case SCSI_CMD_READ_CAPACITY_10:
+    if (!msd_media_ready(msdp)) {
+      *statusp = MSD_CSW_STATUS_FAILED;
+      return MSG_OK;
+    }
+    put_be32(&rp[0], msdp->info.blk_num - 1U);
+    put_be32(&rp[4], msdp->info.blk_size);
+    return msd_send_response(msdp, READ_CAPACITY_10_SIZE);
+  case SCSI_CMD_READ_10:
+    return msd_cmd_read(msdp, statusp);
+  case SCSI_CMD_WRITE_10:
+    return msd_cmd_write(msdp, statusp);
+  case SCSI_CMD_VERIFY_10:
+    if (!msd_media_ready(msdp)) {
+      *statusp = MSD_CSW_STATUS_FAILED;
+    }
+    return MSG_OK;
+  case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+    if (!msd_media_ready(msdp)) {
+      *statusp = MSD_CSW_STATUS_FAILED;
+    }
+    else if (blkSync(msdp->config->bbdp) == HAL_FAILED) {
+      *statusp = msd_fail(msdp, SCSI_SENSE_MEDIUM_ERROR,
+                          SCSI_ASC_WRITE_FAULT);
+    }
+    return MSG_OK;
+  default:
+    *statusp = msd_fail(msdp, SCSI_SENSE_ILLEGAL_REQUEST,
+                        SCSI_ASC_INVALID_COMMAND);
+    return MSG_OK;
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Mass Storage Driver initialization.
+ * @note    This function is implicitly invoked by @p halInit(), there is
+ *          no need to explicitly initialize the driver.
+ *
+ * @init
+ */
+void msdInit(void) {
+}
+
+/**
+ * @brief   Initializes a generic Mass Storage driver object.
+ *
+ * @param[out] msdp     pointer to a @p USBMassStorageDriver structure
+ *
+ * @init
+ */
+void msdObjectInit(USBMassStorageDriver *msdp) {
+
+  osalDbgCheck(msdp != NULL);
+
+  msdp->state     = MSD_STOP;
+  msdp->config    = NULL;
+  msdp->thread    = NULL;
+  msdp->residue   = 0U;
+  msdp->rxbuf     = NULL;
+  msdp->sense_key = SCSI_SENSE_NO_SENSE;
+  msdp->sense_asc = SCSI_ASC_NONE;
+  msdp->max_lun   = 0U;
+}
+
+/**
+ * @brief   Configures and starts the driver.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @param[in] config    the Mass Storage driver configuration
+ *
+ * @api
+ */
+void msdStart(USBMassStorageDriver *msdp,
+              const USBMassStorageConfig *config) {
+  USBDriver *usbp;
+
+  osalDbgCheck((msdp != NULL) && (config != NULL) && (config->bbdp != NULL));
+
+  usbp = config->usbp;
+  osalSysLock();
+  osalDbgAssert((msdp->state == MSD_STOP) || (msdp->state == MSD_READY),
+                "invalid state");
+  usbp->in_params[config->bulk_in - 1U]   = msdp;
+  usbp->out_params[config->bulk_out - 1U] = msdp;
+  msdp->config = config;
+  msdp->state = MSD_READY;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Stops the driver.
+ * @details A thread serving commands is awakened with the message
+ *          @p MSG_RESET.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ *
+ * @api
+ */
+void msdStop(USBMassStorageDriver *msdp) {
+  USBDriver *usbp;
+
+  osalDbgCheck(msdp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(msdp->state != MSD_UNINIT, "invalid state");
+
+  /* The configuration is not set if the driver has never been started.*/
+  if (msdp->config != NULL) {
+    usbp = msdp->config->usbp;
+    usbp->in_params[msdp->config->bulk_in - 1U]   = NULL;
+    usbp->out_params[msdp->config->bulk_out - 1U] = NULL;
+  }
+  msdp->state = MSD_STOP;
+  osalThreadResumeS(&msdp->thread, MSG_RESET);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   USB device disconnection handler.
+ * @details The command in progress, if any, is aborted.
+ * @note    If this function is not called from an ISR then an explicit call
+ *          to @p osalOsRescheduleS() in necessary afterward.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ *
+ * @iclass
+ */
+void msdDisconnectI(USBMassStorageDriver *msdp) {
+
+  if (msdp->state > MSD_STOP) {
+    msdp->state = MSD_READY;
+    msdp->rxbuf = NULL;
+    osalThreadResumeI(&msdp->thread, MSG_RESET);
+  }
+}
+
+/**
+ * @brief   USB device configured handler.
+ * @details A thread waiting in @p msdServeCommand() for the device
+ *          configuration starts receiving commands.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ *
+ * @iclass
+ */
+void msdConfigureHookI(USBMassStorageDriver *msdp) {
+
+  if (msdp->state > MSD_STOP) {
+    msdp->state = MSD_READY;
+    msdp->rxbuf = NULL;
+    msdp->sense_key = SCSI_SENSE_NO_SENSE;
+    msdp->sense_asc = SCSI_ASC_NONE;
+    osalThreadResumeI(&msdp->thread, MSG_OK);
+  }
+}
+
+/**
+ * @brief   Mass Storage requests hook.
+ * @details Applications can call this function from the requests hook in
+ *          the USB configuration, the class requests addressed to the
+ *          driver interface are handled:
+ *          - MSD_REQ_RESET.
+ *          - MSD_REQ_GET_MAX_LUN.
+ *          .
+ * @note    In composite devices the requests hook calls the hook of each
+ *          function until one of them handles the request.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @return              The hook status.
+ * @retval true         Message handled internally.
+ * @retval false        Message not handled.
+ */
+bool msdRequestsHook(USBMassStorageDriver *msdp) {
+  USBDriver *usbp;
+
+  if (msdp->state <= MSD_STOP) {
+    return false;
+  }
+
+  usbp = msdp->config->usbp;
+  if (((usbp->setup[0] & USB_RTYPE_TYPE_MASK) != USB_RTYPE_TYPE_CLASS) ||
+      ((usbp->setup[0] & USB_RTYPE_RECIPIENT_MASK) !=
+       USB_RTYPE_RECIPIENT_INTERFACE) ||
+      (usbp->setup[4] != msdp->config->ifnum)) {
+    return false;
+  }
+
+  switch (usbp->setup[1]) {
+  case MSD_REQ_RESET:
+    /* Reset recovery, the command in progress is aborted and the driver
+       gets ready for the next Command Block Wrapper.*/
+    osalSysLockFromISR();
+    msdp->state = MSD_READY;
+    osalThreadResumeI(&msdp->thread, MSG_RESET);
+    osalSysUnlockFromISR();
+    usbSetupTransfer(usbp, NULL, 0, NULL);
+    return true;
+  case MSD_REQ_GET_MAX_LUN:
+    usbSetupTransfer(usbp, &msdp->max_lun, 1, NULL);
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief   Serves a single Mass Storage command.
+ * @details The function waits for a Command Block Wrapper, executes the
+ *          SCSI command accessing the block device and sends the Command
+ *          Status Wrapper. If the USB device is not configured then the
+ *          function waits for the configuration.
+ * @note    The function is meant to be called in a loop from a dedicated
+ *          thread.
+ * @note    Transactions pending on a Bulk-Only reset are not aborted, the
+ *          driver resumes using the received data on the next command.
+ *
+ * @param[in] msdp      pointer to a @p USBMassStorageDriver object
+ * @return              The operation status.
+ * @retval MSG_OK       if a command has been served.
+ * @retval MSG_RESET    if the driver has been stopped, reset or the USB
+ *                      device disconnected.
+ *
+ * @api
+ */
+msg_t msdServeCommand(USBMassStorageDriver *msdp) {
+  USBDriver *usbp;
+  uint8_t status;
+  size_t n;
+  msg_t msg;
+
+  osalDbgCheck(msdp != NULL);
+
+  osalSysLock();
+  osalDbgAssert(msdp->state != MSD_UNINIT, "invalid state");
+  if (msdp->state == MSD_STOP) {
+    osalSysUnlock();
+    return MSG_RESET;
+  }
+  usbp = msdp->config->usbp;
+  if (usbGetDriverStateI(usbp) != USB_ACTIVE) {
+    /* Waiting for the device to be configured.*/
+    msg = osalThreadSuspendS(&msdp->thread);
+    if ((msg != MSG_OK) || (usbGetDriverStateI(usbp) != USB_ACTIVE)) {
+      osalSysUnlock();
+      return MSG_RESET;
+    }
+  }
+  osalSysUnlock();
+
+  /* Waiting for a Command Block Wrapper, a transaction still pending after
+     a reset recovery is used if present.*/
+  msg = msd_start_receive(msdp, msdp->buf[0], USB_MSD_BUFFERS_SIZE);
+  if (msg != MSG_OK) {
+    osalSysLock();
+    if ((msdp->state != MSD_READY) || (msdp->rxbuf == NULL) ||
+        !usbGetReceiveStatusI(usbp, msdp->config->bulk_out)) {
+      osalSysUnlock();
+      return msg;
+    }
+    osalSysUnlock();
+  }
+  msg = msd_wait_receive(msdp);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  n = usbGetReceiveTransactionSizeX(usbp, msdp->config->bulk_out);
+  if ((n != MSD_CBW_SIZE) ||
+      (get_le32(&msdp->rxbuf[CBW_SIGNATURE]) != MSD_CBW_SIGNATURE)) {
+    /* Invalid Command Block Wrapper, both endpoints are halted until a
+       reset recovery, see BOT 6.6.1.*/
+    osalSysLock();
+    msdp->rxbuf = NULL;
+    msdp->state = MSD_HALTED;
+    (void)usbStallTransmitI(usbp, msdp->config->bulk_in);
+    (void)usbStallReceiveI(usbp, msdp->config->bulk_out);
+    while (msdp->state == MSD_HALTED) {
+      (void)osalThreadSuspendS(&msdp->thread);
+    }
+    osalSysUnlock();
+    return MSG_RESET;
+  }
+  memcpy(msdp->cbw, msdp->rxbuf, MSD_CBW_SIZE);
+  msdp->rxbuf = NULL;
+
+  /* Command execution.*/
+  osalSysLock();
+  if (msdp->state != MSD_READY) {
+    osalSysUnlock();
+    return MSG_RESET;
+  }
+  msdp->state = MSD_ACTIVE;
+  osalSysUnlock();
+  msdp->residue = get_le32(&msdp->cbw[CBW_DATA_LENGTH]);
+  if (msdp->cbw[CBW_LUN] > msdp->max_lun) {
+    /* Not meaningful Command Block Wrapper, the command is not executed,
+       see BOT 6.2.2.*/
+    status = msd_fail(msdp, SCSI_SENSE_ILLEGAL_REQUEST,
+                      SCSI_ASC_LUN_NOT_SUPPORTED);
+  }
+  else if ((msdp->cbw[CBW_CB_LENGTH] < 1U) ||
+           (msdp->cbw[CBW_CB_LENGTH] > CBW_CB_MAX_LENGTH)) {
+    status = msd_fail(msdp, SCSI_SENSE_ILLEGAL_REQUEST,
+                      SCSI_ASC_INVALID_FIELD_IN_CDB);
+  }
+  else {
+    msg = msd_execute(msdp, &status);
+    if (msg != MSG_OK) {
+      return msg;
+    }
+  }
+
+  /* Any data phase not completed is terminated by halting the endpoint,
+     the host clears the halt before reading the status.*/
+  if (msdp->residue > 0U) {
+    osalSysLock();
+    if ((msdp->cbw[CBW_FLAGS] & CBW_FLAGS_DATA_IN) != 0U) {
+      (void)usbStallTransmitI(usbp, msdp->config->bulk_in);
+    }
+    else {
+      (void)usbStallReceiveI(usbp, msdp->config->bulk_out);
+    }
+    osalSysUnlock();
+  }
+
+  /* Status phase.*/
+  put_le32(&msdp->csw[CSW_SIGNATURE], MSD_CSW_SIGNATURE);
+  memcpy(&msdp->csw[CSW_TAG], &msdp->cbw[CBW_TAG], 4U);
+  put_le32(&msdp->csw[CSW_DATA_RESIDUE], msdp->residue);
+  msdp->csw[CSW_STATUS] = status;
+  msg = msd_start_transmit(msdp, msdp->csw, MSD_CSW_SIZE);
+  if (msg == MSG_OK) {
+    msg = msd_wait_transmit(msdp);
+  }
+
+  osalSysLock();
+  if (msdp->state == MSD_ACTIVE) {
+    msdp->state = MSD_READY;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Default data transmitted callback.
+ * @details The application must use this function as callback for the IN
+ *          data endpoint.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        IN endpoint number
+ */
+void msdDataTransmitted(USBDriver *usbp, usbep_t ep) {
+  USBMassStorageDriver *msdp = usbp->in_params[ep - 1U];
+
+  if (msdp == NULL) {
+    return;
+  }
+
+  osalSysLockFromISR();
+  osalThreadResumeI(&msdp->thread, MSG_OK);
+  osalSysUnlockFromISR();
+}
+
+/**
+ * @brief   Default data received callback.
+ * @details The application must use this function as callback for the OUT
+ *          data endpoint.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        OUT endpoint number
+ */
+void msdDataReceived(USBDriver *usbp, usbep_t ep) {
+  USBMassStorageDriver *msdp = usbp->out_params[ep - 1U];
+
+  if (msdp == NULL) {
+    return;
+  }
+
+  osalSysLockFromISR();
+  osalThreadResumeI(&msdp->thread, MSG_OK);
+  osalSysUnlockFromISR();
+}
+
+#endif /* HAL_USE_USB_MSD == TRUE */
+
+/** @} */
@@ -174,6 +174,12 @@ struct ADCDriver {
    */
   mutex_t                   mutex;
 #endif
+#if (ADC_USE_STREAMING == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief Stream being fed or @p NULL.
+   */
+  ADCStream                 *stream;
+#endif
 #if defined(ADC_DRIVER_EXT_FIELDS)
   ADC_DRIVER_EXT_FIELDS
 #endif
@@ -183,6 +183,12 @@ typedef struct {
    * @brief   Exiting sleep state event.
    */
   event_source_t            wakeup_event;
+#endif
+#if (CAN_USE_RX_FIFO == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Software receive FIFO or @p NULL.
+   */
+  CANRxFifo                 *rxfifo;
 #endif
   /* End of the mandatory fields.*/
 } CANDriver;
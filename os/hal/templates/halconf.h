@@ -166,6 +166,13 @@
 #define HAL_USE_USB                 TRUE
 #endif
 
+/**
+ * @brief   Enables the USB Mass Storage subsystem.
+ */
+#if !defined(HAL_USE_USB_MSD) || defined(__DOXYGEN__)
+#define HAL_USE_USB_MSD             FALSE
+#endif
+
 /**
  * @brief   Enables the WDG subsystem.
  */
@@ -196,6 +203,14 @@
 #if !defined(ADC_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define ADC_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the streaming APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(ADC_USE_STREAMING) || defined(__DOXYGEN__)
+#define ADC_USE_STREAMING           FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -211,6 +226,13 @@
 #if !defined(CAN_USE_SLEEP_MODE) || defined(__DOXYGEN__)
 #define CAN_USE_SLEEP_MODE          TRUE
 #endif
+
+/**
+ * @brief   Software receive FIFO APIs inclusion switch.
+ */
+#if !defined(CAN_USE_RX_FIFO) || defined(__DOXYGEN__)
+#define CAN_USE_RX_FIFO             FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -226,6 +248,13 @@
 #if !defined(I2C_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define I2C_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the transactions queue APIs.
+ */
+#if !defined(I2C_USE_QUEUE) || defined(__DOXYGEN__)
+#define I2C_USE_QUEUE               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -248,6 +277,13 @@
 #if !defined(MAC_USE_EVENTS) || defined(__DOXYGEN__)
 #define MAC_USE_EVENTS              TRUE
 #endif
+
+/**
+ * @brief   Enables the receive interrupt mitigation.
+ */
+#if !defined(MAC_USE_RX_MITIGATION) || defined(__DOXYGEN__)
+#define MAC_USE_RX_MITIGATION       FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -358,6 +394,16 @@
 #if !defined(SERIAL_USB_BUFFERS_NUMBER) || defined(__DOXYGEN__)
 #define SERIAL_USB_BUFFERS_NUMBER   2
 #endif
+
+/**
+ * @brief   Maximum number of buffers moved by a single bulk transaction.
+ * @note    Setting this value to one disables the chaining. Chained OUT
+ *          transactions are only completed by short packets, do not
+ *          enable it for hosts that do not terminate their transfers.
+ */
+#if !defined(SERIAL_USB_MAX_CHAINED_BUFFERS) || defined(__DOXYGEN__)
+#define SERIAL_USB_MAX_CHAINED_BUFFERS  1
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -382,6 +428,23 @@
 #if !defined(SPI_USE_MUTUAL_EXCLUSION) || defined(__DOXYGEN__)
 #define SPI_USE_MUTUAL_EXCLUSION    TRUE
 #endif
+
+/**
+ * @brief   Enables the @p spiStartTransferList() APIs.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_TRANSFER_LIST) || defined(__DOXYGEN__)
+#define SPI_USE_TRANSFER_LIST       FALSE
+#endif
+
+/**
+ * @brief   Enables the transactions queue APIs.
+ * @note    Requires @p SPI_USE_TRANSFER_LIST.
+ * @note    Disabling this option saves both code and data space.
+ */
+#if !defined(SPI_USE_QUEUE) || defined(__DOXYGEN__)
+#define SPI_USE_QUEUE               FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -424,6 +487,22 @@
 #endif
 /** @} */
 
+/*===========================================================================*/
+/**
+ * @name USB_MSD driver related setting
+ * @{
+ */
+/*===========================================================================*/
+
+/**
+ * @brief   Mass Storage transfer buffers size.
+ * @note    The size must be a multiple of the block size.
+ */
+#if !defined(USB_MSD_BUFFERS_SIZE) || defined(__DOXYGEN__)
+#define USB_MSD_BUFFERS_SIZE        2048
+#endif
+/** @} */
+
 #endif /* _HALCONF_H_ */
 
 /** @} */
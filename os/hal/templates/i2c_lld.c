@@ -182,6 +182,78 @@ msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
   return MSG_OK;
 }
 
+/**
+ * @brief   Starts a transmission via the I2C bus as master.
+ * @details The operation is terminated from the interrupt handlers using
+ *          @p _i2c_wakeup_isr() or @p _i2c_wakeup_error_isr().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_start_transmit(I2CDriver *i2cp, i2caddr_t addr,
+                             const uint8_t *txbuf, size_t txbytes,
+                             uint8_t *rxbuf, size_t rxbytes) {
+
+  (void)i2cp;
+  (void)addr;
+  (void)txbuf;
+  (void)txbytes;
+  (void)rxbuf;
+  (void)rxbytes;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Starts a reception via the I2C bus as master.
+ * @details The operation is terminated from the interrupt handlers using
+ *          @p _i2c_wakeup_isr() or @p _i2c_wakeup_error_isr().
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_start_receive(I2CDriver *i2cp, i2caddr_t addr,
+                            uint8_t *rxbuf, size_t rxbytes) {
+
+  (void)i2cp;
+  (void)addr;
+  (void)rxbuf;
+  (void)rxbytes;
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Aborts the operation in progress and resets the peripheral.
+ * @details The peripheral is reinitialized with the current configuration,
+ *          the end callback is not invoked.
+ * @note    This function can be called from ISR context.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_reset(I2CDriver *i2cp) {
+
+  (void)i2cp;
+}
+
 #endif /* HAL_USE_I2C == TRUE */
 
 /** @} */
@@ -31,6 +31,11 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Callback support in the driver.
+ */
+#define I2C_SUPPORTS_CALLBACKS      TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -82,6 +87,14 @@ typedef struct {
  */
 typedef struct I2CDriver I2CDriver;
 
+/**
+ * @brief   I2C notification callback type.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object triggering the
+ *                      callback
+ */
+typedef void (*i2ccallback_t)(I2CDriver *i2cp);
+
 /**
  * @brief   Structure representing an I2C driver.
  */
@@ -98,9 +111,19 @@ struct I2CDriver {
    * @brief   Error flags.
    */
   i2cflags_t                errors;
+  /**
+   * @brief   Asynchronous operation end callback or @p NULL.
+   */
+  i2ccallback_t             end_cb;
 #if (I2C_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
   mutex_t                   mutex;
 #endif
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transactions queue.
+   */
+  i2c_queue_t               queue;
+#endif
 #if defined(I2C_DRIVER_EXT_FIELDS)
   I2C_DRIVER_EXT_FIELDS
 #endif
@@ -141,6 +164,12 @@ extern "C" {
   msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
                                        uint8_t *rxbuf, size_t rxbytes,
                                        systime_t timeout);
+  msg_t i2c_lld_start_transmit(I2CDriver *i2cp, i2caddr_t addr,
+                               const uint8_t *txbuf, size_t txbytes,
+                               uint8_t *rxbuf, size_t rxbytes);
+  msg_t i2c_lld_start_receive(I2CDriver *i2cp, i2caddr_t addr,
+                              uint8_t *rxbuf, size_t rxbytes);
+  void i2c_lld_reset(I2CDriver *i2cp);
 #ifdef __cplusplus
 }
 #endif
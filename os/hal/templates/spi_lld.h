@@ -31,6 +31,11 @@
 /* Driver constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Reconfiguration from ISR context support in the driver.
+ */
+#define SPI_SUPPORTS_ISR_RECONFIG   TRUE
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -109,6 +114,22 @@ struct SPIDriver {
    */
   mutex_t                   mutex;
 #endif
+#if (SPI_USE_TRANSFER_LIST == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Segment of the transfer list in progress or @p NULL.
+   */
+  const SPISegment          *segp;
+  /**
+   * @brief   Segments of the transfer list not yet completed.
+   */
+  size_t                    segcnt;
+#endif
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transactions queue.
+   */
+  spi_queue_t               queue;
+#endif
 #if defined(SPI_DRIVER_EXT_FIELDS)
   SPI_DRIVER_EXT_FIELDS
 #endif
@@ -141,6 +141,7 @@ typedef struct {
 #define _dbg_check_leave_isr()
 #define chDbgCheckClassI()
 #define chDbgCheckClassS()
+#define chDbgCheckClassX()
 #endif
 
 /* When the trace feature is disabled this function is replaced by an empty
@@ -221,6 +222,7 @@ extern "C" {
   void _dbg_check_leave_isr(void);
   void chDbgCheckClassI(void);
   void chDbgCheckClassS(void);
+  void chDbgCheckClassX(void);
 #endif
 #if (CH_DBG_ENABLE_TRACE == TRUE) || defined(__DOXYGEN__)
   void _dbg_trace_init(void);
@@ -103,6 +103,7 @@ extern "C" {
   void *chHeapAlloc(memory_heap_t *heapp, size_t size);
   void chHeapFree(void *p);
   size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep);
+  bool chHeapIntegrityCheck(memory_heap_t *heapp);
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,13 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Priority ceiling mutexes.
+ */
+#if !defined(CH_CFG_USE_MUTEXES_CEILING) || defined(__DOXYGEN__)
+#define CH_CFG_USE_MUTEXES_CEILING          FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -64,6 +71,11 @@ struct ch_mutex {
 #if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
   cnt_t                 m_cnt;      /**< @brief Mutex recursion counter.    */
 #endif
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+  tprio_t               m_ceiling;  /**< @brief Mutex priority ceiling or
+                                                @p NOPRIO for priority
+                                                inheritance.                */
+#endif
 };
 
 /*===========================================================================*/
@@ -77,7 +89,9 @@ struct ch_mutex {
  *
  * @param[in] name      the name of the mutex variable
  */
-#if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+#define _MUTEX_DATA(name) _MUTEX_CEILING_DATA(name, NOPRIO)
+#elif CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
 #define _MUTEX_DATA(name) {_THREADS_QUEUE_DATA(name.m_queue), NULL, NULL, 0}
 #else
 #define _MUTEX_DATA(name) {_THREADS_QUEUE_DATA(name.m_queue), NULL, NULL}
@@ -92,6 +106,35 @@ struct ch_mutex {
  */
 #define MUTEX_DECL(name) mutex_t name = _MUTEX_DATA(name)
 
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Data part of a static priority ceiling mutex initializer.
+ * @details This macro should be used when statically initializing a
+ *          priority ceiling mutex that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the mutex priority ceiling
+ */
+#if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_THREADS_QUEUE_DATA(name.m_queue), NULL, NULL, 0, ceiling}
+#else
+#define _MUTEX_CEILING_DATA(name, ceiling)                                  \
+  {_THREADS_QUEUE_DATA(name.m_queue), NULL, NULL, ceiling}
+#endif
+
+/**
+ * @brief   Static priority ceiling mutex initializer.
+ * @details Statically initialized mutexes require no explicit initialization
+ *          using @p chMtxObjectInitCeiling().
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] ceiling   the mutex priority ceiling
+ */
+#define MUTEX_CEILING_DECL(name, ceiling)                                   \
+  mutex_t name = _MUTEX_CEILING_DATA(name, ceiling)
+#endif /* CH_CFG_USE_MUTEXES_CEILING == TRUE */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -101,6 +144,9 @@ struct ch_mutex {
 extern "C" {
 #endif
   void chMtxObjectInit(mutex_t *mp);
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  void chMtxObjectInitCeiling(mutex_t *mp, tprio_t ceiling);
+#endif
   void chMtxLock(mutex_t *mp);
   void chMtxLockS(mutex_t *mp);
   bool chMtxTryLock(mutex_t *mp);
@@ -108,6 +154,9 @@ extern "C" {
   void chMtxUnlock(mutex_t *mp);
   void chMtxUnlockS(mutex_t *mp);
   void chMtxUnlockAll(void);
+#if CH_CFG_USE_CONDVARS == TRUE
+  void chMtxMorphI(mutex_t *mp, thread_t *tp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,10 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_REGISTRY_HASH_SIZE & (CH_CFG_REGISTRY_HASH_SIZE - 1)) != 0
+#error "CH_CFG_REGISTRY_HASH_SIZE must be zero or a power of two"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -72,6 +76,29 @@ typedef struct {
   uint8_t   cf_off_time;            /**< @brief Offset of @p p_time field.  */
 } chdebug_t;
 
+/**
+ * @brief   Thread information record.
+ * @details Copy of the thread status taken by @p chRegSnapshot().
+ */
+typedef struct {
+  thread_t              *ti_tp;     /**< @brief Thread pointer, it is an
+                                                identifier only, no
+                                                reference is held.          */
+  const char            *ti_name;   /**< @brief Thread name or @p NULL.     */
+  tprio_t               ti_prio;    /**< @brief Current priority.           */
+#if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
+  tprio_t               ti_realprio;/**< @brief Base priority.              */
+#endif
+  tstate_t              ti_state;   /**< @brief Thread state.               */
+  tmode_t               ti_flags;   /**< @brief Thread flags.               */
+#if (CH_CFG_USE_DYNAMIC == TRUE) || defined(__DOXYGEN__)
+  trefs_t               ti_refs;    /**< @brief References counter.         */
+#endif
+#if (CH_DBG_THREADS_PROFILING == TRUE) || defined(__DOXYGEN__)
+  systime_t             ti_time;    /**< @brief Consumed ticks.             */
+#endif
+} thread_info_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -82,10 +109,20 @@ typedef struct {
  *
  * @param[in] tp        thread to remove from the registry
  */
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+#define REG_REMOVE(tp) {                                                    \
+  (tp)->p_older->p_newer = (tp)->p_newer;                                   \
+  (tp)->p_newer->p_older = (tp)->p_older;                                   \
+  ch.rlist.r_reggen++;                                                      \
+  _reg_unhash(tp);                                                          \
+}
+#else
 #define REG_REMOVE(tp) {                                                    \
   (tp)->p_older->p_newer = (tp)->p_newer;                                   \
   (tp)->p_newer->p_older = (tp)->p_older;                                   \
+  ch.rlist.r_reggen++;                                                      \
 }
+#endif
 
 /**
  * @brief   Adds a thread to the registry list.
@@ -98,6 +135,7 @@ typedef struct {
   (tp)->p_older = ch.rlist.r_older;                                         \
   (tp)->p_older->p_newer = (tp);                                            \
   ch.rlist.r_older = (tp);                                                  \
+  ch.rlist.r_reggen++;                                                      \
 }
 
 /*===========================================================================*/
@@ -110,6 +148,13 @@ extern "C" {
   extern ROMCONST chdebug_t ch_debug;
   thread_t *chRegFirstThread(void);
   thread_t *chRegNextThread(thread_t *tp);
+  thread_t *chRegFindThreadByName(const char *name);
+  thread_t *chRegFindThreadByWorkingArea(void *wa);
+  size_t chRegSnapshot(thread_info_t *tip, size_t n);
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  void _reg_unhash(thread_t *tp);
+  void _reg_set_name(thread_t *tp, const char *name);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -132,7 +177,11 @@ extern "C" {
 static inline void chRegSetThreadName(const char *name) {
 
 #if CH_CFG_USE_REGISTRY == TRUE
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  _reg_set_name(ch.rlist.r_current, name);
+#else
   ch.rlist.r_current->p_name = name;
+#endif
 #else
   (void)name;
 #endif
@@ -172,7 +221,11 @@ static inline const char *chRegGetThreadNameX(thread_t *tp) {
 static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 
 #if CH_CFG_USE_REGISTRY == TRUE
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  _reg_set_name(tp, name);
+#else
   tp->p_name = name;
+#endif
 #else
   (void)tp;
   (void)name;
@@ -162,6 +162,15 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Size of the registry names index.
+ * @details Defined here because it affects the @p thread_t structure, see
+ *          the registry module.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_REGISTRY_HASH_SIZE           0
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -209,6 +218,13 @@ struct ch_thread {
    */
   const char            *p_name;
 #endif
+#if ((CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)) ||   \
+    defined(__DOXYGEN__)
+  /**
+   * @brief Next thread in the same registry names index bucket.
+   */
+  thread_t              *p_hnext;
+#endif
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief Thread stack boundary.
@@ -394,6 +410,8 @@ struct ch_virtual_timers_list {
   systime_t             vt_lasttime;/**< @brief System time of the last
                                                 tick event.                 */
 #endif
+  ucnt_t                vt_gen;     /**< @brief Timers list modifications
+                                                counter.                    */
 };
 
 /**
@@ -412,6 +430,12 @@ struct ch_ready_list {
   /* End of the fields shared with the thread_t structure.*/
   thread_t              *r_current; /**< @brief The currently running
                                                 thread.                     */
+  ucnt_t                r_gen;      /**< @brief Ready list modifications
+                                                counter.                    */
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+  ucnt_t                r_reggen;   /**< @brief Registry modifications
+                                                counter.                    */
+#endif
 };
 
 /**
@@ -42,16 +42,44 @@
 #define CH_INTEGRITY_VTLIST                 2U
 #define CH_INTEGRITY_REGISTRY               4U
 #define CH_INTEGRITY_PORT                   8U
+#define CH_INTEGRITY_STACKS                 16U
+#define CH_INTEGRITY_HEAP                   32U
 /** @} */
 
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Lock-free fast paths for semaphores and mutexes.
+ */
+#if !defined(CH_CFG_USE_ATOMIC_FASTPATH) || defined(__DOXYGEN__)
+#define CH_CFG_USE_ATOMIC_FASTPATH          FALSE
+#endif
+
+/**
+ * @brief   Number of list nodes validated by each integrity check step.
+ * @details This is the maximum number of nodes scanned by
+ *          @p chSysIntegrityCheckStep() within a single critical zone.
+ */
+#if !defined(CH_CFG_INTEGRITY_STEP_NODES) || defined(__DOXYGEN__)
+#define CH_CFG_INTEGRITY_STEP_NODES         4
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_CFG_USE_ATOMIC_FASTPATH == TRUE
+#if !defined(PORT_SUPPORTS_EXCLUSIVE) || (PORT_SUPPORTS_EXCLUSIVE == FALSE)
+#error "CH_CFG_USE_ATOMIC_FASTPATH requires exclusive access support in the port"
+#endif
+#endif
+
+#if CH_CFG_INTEGRITY_STEP_NODES < 1
+#error "invalid CH_CFG_INTEGRITY_STEP_NODES value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -277,6 +305,7 @@ extern "C" {
   void chSysInit(void);
   void chSysHalt(const char *reason);
   bool chSysIntegrityCheckI(unsigned testmask);
+  bool chSysIntegrityCheckStep(void);
   void chSysTimerHandlerI(void);
   syssts_t chSysGetStatusAndLockX(void);
   void chSysRestoreStatusX(syssts_t sts);
@@ -517,6 +517,7 @@ static inline void chVTDoTickI(void) {
       vtp->vt_func = NULL;
       vtp->vt_next->vt_prev = (virtual_timer_t *)&ch.vtlist;
       ch.vtlist.vt_next = vtp->vt_next;
+      ch.vtlist.vt_gen++;
       chSysUnlockFromISR();
       fn(vtp->vt_par);
       chSysLockFromISR();
@@ -542,6 +543,7 @@ static inline void chVTDoTickI(void) {
 
     vtp->vt_next->vt_prev = (virtual_timer_t *)&ch.vtlist;
     ch.vtlist.vt_next = vtp->vt_next;
+    ch.vtlist.vt_gen++;
     fn = vtp->vt_func;
     vtp->vt_func = NULL;
 
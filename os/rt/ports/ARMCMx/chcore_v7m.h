@@ -37,6 +37,11 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports exclusive load/store operations.
+ */
+#define PORT_SUPPORTS_EXCLUSIVE         TRUE
+
 /**
  * @brief   Disabled value for BASEPRI register.
  */
@@ -570,6 +575,79 @@ static inline rtcnt_t port_rt_get_counter_value(void) {
   return DWT->CYCCNT;
 }
 
+/**
+ * @brief   Exclusive load of a counter.
+ * @details Loads a counter and tags the location for exclusive access.
+ * @note    Implemented as an inlined @p LDREX instruction, @p cnt_t is
+ *          a 32 bits type in this port.
+ *
+ * @param[in] p         pointer to the counter
+ * @return              The loaded value.
+ */
+static inline cnt_t port_load_exclusive_cnt(volatile cnt_t *p) {
+
+  return (cnt_t)__LDREXW((volatile uint32_t *)p);
+}
+
+/**
+ * @brief   Exclusive store of a counter.
+ * @details The store is performed only if the location is still tagged for
+ *          exclusive access, the tag is lost on exception entry and return
+ *          so a preemption between load and store makes the store fail.
+ * @note    Implemented as an inlined @p STREX instruction.
+ *
+ * @param[in] p         pointer to the counter
+ * @param[in] value     the value to be stored
+ * @return              The operation status.
+ * @retval false        if the store failed.
+ * @retval true         if the store succeeded.
+ */
+static inline bool port_store_exclusive_cnt(volatile cnt_t *p, cnt_t value) {
+
+  return __STREXW((uint32_t)value, (volatile uint32_t *)p) == 0U;
+}
+
+/**
+ * @brief   Exclusive load of a pointer.
+ * @details Loads a pointer and tags the location for exclusive access.
+ * @note    Implemented as an inlined @p LDREX instruction, pointers are
+ *          32 bits wide in this architecture.
+ *
+ * @param[in] p         pointer to the pointer
+ * @return              The loaded value.
+ */
+static inline void *port_load_exclusive_ptr(void * volatile *p) {
+
+  return (void *)__LDREXW((volatile uint32_t *)p);
+}
+
+/**
+ * @brief   Exclusive store of a pointer.
+ * @details The store is performed only if the location is still tagged for
+ *          exclusive access, the tag is lost on exception entry and return
+ *          so a preemption between load and store makes the store fail.
+ * @note    Implemented as an inlined @p STREX instruction.
+ *
+ * @param[in] p         pointer to the pointer
+ * @param[in] value     the value to be stored
+ * @return              The operation status.
+ * @retval false        if the store failed.
+ * @retval true         if the store succeeded.
+ */
+static inline bool port_store_exclusive_ptr(void * volatile *p, void *value) {
+
+  return __STREXW((uint32_t)value, (volatile uint32_t *)p) == 0U;
+}
+
+/**
+ * @brief   Clears a pending exclusive access.
+ * @note    Implemented as an inlined @p CLREX instruction.
+ */
+static inline void port_clear_exclusive(void) {
+
+  __CLREX();
+}
+
 #endif /* !defined(_FROM_ASM_) */
 
 #endif /* _CHCORE_V7M_H_ */
@@ -25,7 +25,11 @@
  * @{
  */
 
+#if defined(WIN32)
 #include <windows.h>
+#else
+#include <sys/time.h>
+#endif
 
 #include "ch.h"
 
@@ -39,6 +43,7 @@
 
 bool port_isr_context_flag;
 syssts_t port_irq_sts;
+bool port_exclusive_tag;
 
 /*===========================================================================*/
 /* Module local types.                                                       */
@@ -110,11 +115,19 @@ void _port_thread_start(msg_t (*pf)(void *), void *p) {
  * @return              The realtime counter value.
  */
 rtcnt_t port_rt_get_counter_value(void) {
+#if defined(WIN32)
   LARGE_INTEGER n;
 
   QueryPerformanceCounter(&n);
 
   return (rtcnt_t)(n.QuadPart / 1000LL);
+#else
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return (rtcnt_t)((tv.tv_sec * 1000000LL) + tv.tv_usec);
+#endif
 }
 
 /** @} */
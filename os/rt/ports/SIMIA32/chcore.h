@@ -62,6 +62,13 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports exclusive load/store operations.
+ * @details The exclusive monitor is emulated, interrupts can preempt the
+ *          sequence between the load and the store and make the store fail.
+ */
+#define PORT_SUPPORTS_EXCLUSIVE         TRUE
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -206,6 +213,7 @@ struct context {
  */
 #define PORT_IRQ_PROLOGUE() {                                               \
   port_isr_context_flag = true;                                             \
+  port_exclusive_tag = false;                                               \
 }
 
 /**
@@ -238,6 +246,7 @@ struct context {
 
 extern bool port_isr_context_flag;
 extern syssts_t port_irq_sts;
+extern bool port_exclusive_tag;
 
 #ifdef __cplusplus
 extern "C" {
@@ -264,6 +273,7 @@ static inline void port_init(void) {
 
   port_irq_sts = (syssts_t)0;
   port_isr_context_flag = false;
+  port_exclusive_tag = false;
 }
 
 /**
@@ -377,6 +387,90 @@ static inline void port_wait_for_interrupt(void) {
   _sim_check_for_interrupts();
 }
 
+/**
+ * @brief   Exclusive load of a counter.
+ * @details The location is tagged for exclusive access then pending
+ *          interrupts are served, this opens a preemption window between
+ *          the load and the store like on a real core.
+ *
+ * @param[in] p         pointer to the counter
+ * @return              The loaded value.
+ */
+static inline cnt_t port_load_exclusive_cnt(volatile cnt_t *p) {
+  cnt_t value = *p;
+
+  port_exclusive_tag = true;
+  _sim_check_for_interrupts();
+  return value;
+}
+
+/**
+ * @brief   Exclusive store of a counter.
+ * @details The store is performed only if the location is still tagged for
+ *          exclusive access, the tag is lost when an interrupt is served.
+ *
+ * @param[in] p         pointer to the counter
+ * @param[in] value     the value to be stored
+ * @return              The operation status.
+ * @retval false        if the store failed.
+ * @retval true         if the store succeeded.
+ */
+static inline bool port_store_exclusive_cnt(volatile cnt_t *p, cnt_t value) {
+
+  if (!port_exclusive_tag) {
+    return false;
+  }
+  port_exclusive_tag = false;
+  *p = value;
+  return true;
+}
+
+/**
+ * @brief   Exclusive load of a pointer.
+ * @details The location is tagged for exclusive access then pending
+ *          interrupts are served, this opens a preemption window between
+ *          the load and the store like on a real core.
+ *
+ * @param[in] p         pointer to the pointer
+ * @return              The loaded value.
+ */
+static inline void *port_load_exclusive_ptr(void * volatile *p) {
+  void *value = *p;
+
+  port_exclusive_tag = true;
+  _sim_check_for_interrupts();
+  return value;
+}
+
+/**
+ * @brief   Exclusive store of a pointer.
+ * @details The store is performed only if the location is still tagged for
+ *          exclusive access, the tag is lost when an interrupt is served.
+ *
+ * @param[in] p         pointer to the pointer
+ * @param[in] value     the value to be stored
+ * @return              The operation status.
+ * @retval false        if the store failed.
+ * @retval true         if the store succeeded.
+ */
+static inline bool port_store_exclusive_ptr(void * volatile *p, void *value) {
+
+  if (!port_exclusive_tag) {
+    return false;
+  }
+  port_exclusive_tag = false;
+  *p = value;
+  return true;
+}
+
+/**
+ * @brief   Clears a pending exclusive access.
+ */
+static inline void port_clear_exclusive(void) {
+
+  port_exclusive_tag = false;
+}
+
 #endif /* _CHCORE_H_ */
 
 /** @} */
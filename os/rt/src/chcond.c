@@ -32,6 +32,14 @@
  *          The condition variable is a synchronization object meant to be
  *          used inside a zone protected by a mutex. Mutexes and condition
  *          variables together can implement a Monitor construct.
+ *          <h2>Wait morphing</h2>
+ *          A broadcast does not make the waiting threads ready, it moves
+ *          them directly on the queue of the associated mutex preserving
+ *          the priority order. Threads are then resumed one at time as the
+ *          mutex is released, this avoids the burst of context switches
+ *          caused by all the threads contending for the mutex at once.
+ *          All the threads waiting on a condition variable must use the
+ *          same mutex.
  * @pre     In order to use the condition variable APIs the @p CH_CFG_USE_CONDVARS
  *          option must be enabled in @p chconf.h.
  * @{
@@ -77,6 +85,7 @@ void chCondObjectInit(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   queue_init(&cp->c_queue);
+  cp->c_mtxp = NULL;
 }
 
 /**
@@ -151,11 +160,13 @@ void chCondBroadcastI(condition_variable_t *cp) {
   chDbgCheckClassI();
   chDbgCheck(cp != NULL);
 
-  /* Empties the condition variable queue and inserts all the threads into the
-     ready list in FIFO order. The wakeup message is set to @p MSG_RESET in
+  /* Empties the condition variable queue and moves all the threads on the
+     mutex queue in priority order, the threads are resumed one at time when
+     the mutex is released. The threads detect a broadcast by finding
+     themselves already owners of the mutex, @p MSG_RESET is returned in
      order to make a chCondBroadcast() detectable from a chCondSignal().*/
   while (queue_notempty(&cp->c_queue)) {
-    chSchReadyI(queue_fifo_remove(&cp->c_queue))->p_u.rdymsg = MSG_RESET;
+    chMtxMorphI(cp->c_mtxp, queue_fifo_remove(&cp->c_queue));
   }
 }
 
@@ -213,15 +224,25 @@ msg_t chCondWaitS(condition_variable_t *cp) {
 
   /* Getting "current" mutex and releasing it.*/
   mp = chMtxGetNextMutexS();
+  chDbgAssert(queue_isempty(&cp->c_queue) || (cp->c_mtxp == mp),
+              "different mutex");
   chMtxUnlockS(mp);
 
   /* Start waiting on the condition variable, on exit the mutex is taken
      again.*/
+  cp->c_mtxp = mp;
   ctp->p_u.wtobjp = cp;
   queue_prio_insert(ctp, &cp->c_queue);
   chSchGoSleepS(CH_STATE_WTCOND);
-  msg = ctp->p_u.rdymsg;
-  chMtxLockS(mp);
+
+  /* After a broadcast the mutex has already been assigned to this thread.*/
+  if (mp->m_owner == ctp) {
+    msg = MSG_RESET;
+  }
+  else {
+    msg = ctp->p_u.rdymsg;
+    chMtxLockS(mp);
+  }
 
   return msg;
 }
@@ -303,16 +324,28 @@ msg_t chCondWaitTimeoutS(condition_variable_t *cp, systime_t time) {
 
   /* Getting "current" mutex and releasing it.*/
   mp = chMtxGetNextMutexS();
+  chDbgAssert(queue_isempty(&cp->c_queue) || (cp->c_mtxp == mp),
+              "different mutex");
   chMtxUnlockS(mp);
 
   /* Start waiting on the condition variable, on exit the mutex is taken
      again.*/
+  cp->c_mtxp = mp;
   currp->p_u.wtobjp = cp;
   queue_prio_insert(currp, &cp->c_queue);
   msg = chSchGoSleepTimeoutS(CH_STATE_WTCOND, time);
-  if (msg != MSG_TIMEOUT) {
+
+  /* After a broadcast the mutex has already been assigned to this thread,
+     a timeout firing while queued on the mutex is ignored.*/
+  if (mp->m_owner == currp) {
+    msg = MSG_RESET;
+  }
+  else if (msg != MSG_TIMEOUT) {
     chMtxLockS(mp);
   }
+  else {
+    /* Timeout, the mutex is not re-acquired.*/
+  }
 
   return msg;
 }
@@ -68,6 +68,10 @@
  *            - SV#11, misplaced S-class function.
  *              - S-class function not called from within a critical zone.
  *              - Called from an ISR.
+ *              .
+ *            - SV#12, misplaced normal API function.
+ *              - Called from an ISR.
+ *              - Called from within a critical zone.
  *            .
  *          - Trace buffer.
  *          - Parameters check.
@@ -254,6 +258,22 @@ void chDbgCheckClassS(void) {
   }
 }
 
+/**
+ * @brief   Normal API functions context check.
+ * @details Verifies that the system is in an appropriate state for invoking
+ *          a normal API function that can complete without entering the
+ *          kernel, for example through an exclusive access fast path. A
+ *          panic is generated if the state is not compatible.
+ *
+ * @api
+ */
+void chDbgCheckClassX(void) {
+
+  if ((ch.dbg.isr_cnt != (cnt_t)0) || (ch.dbg.lock_cnt != (cnt_t)0)) {
+    chSysHalt("SV#12");
+  }
+}
+
 #endif /* CH_DBG_SYSTEM_STATE_CHECK == TRUE */
 
 #if (CH_DBG_ENABLE_TRACE == TRUE) || defined(__DOXYGEN__)
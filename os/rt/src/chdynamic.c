@@ -105,7 +105,9 @@ void chThdRelease(thread_t *tp) {
 #if CH_CFG_USE_HEAP == TRUE
     case CH_FLAG_MODE_HEAP:
 #if CH_CFG_USE_REGISTRY == TRUE
+      chSysLock();
       REG_REMOVE(tp);
+      chSysUnlock();
 #endif
       chHeapFree(tp);
       break;
@@ -113,7 +115,9 @@ void chThdRelease(thread_t *tp) {
 #if CH_CFG_USE_MEMPOOLS == TRUE
     case CH_FLAG_MODE_MPOOL:
 #if CH_CFG_USE_REGISTRY == TRUE
+      chSysLock();
       REG_REMOVE(tp);
+      chSysUnlock();
 #endif
       chPoolFree(tp->p_mpool, tp);
       break;
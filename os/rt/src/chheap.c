@@ -46,9 +46,11 @@
  */
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
 #define H_LOCK(h)       chMtxLock(&(h)->h_mtx)
+#define H_TRYLOCK(h)    chMtxTryLock(&(h)->h_mtx)
 #define H_UNLOCK(h)     chMtxUnlock(&(h)->h_mtx)
 #else
 #define H_LOCK(h)       (void) chSemWait(&(h)->h_sem)
+#define H_TRYLOCK(h)    (chSemWaitTimeout(&(h)->h_sem, TIME_IMMEDIATE) == MSG_OK)
 #define H_UNLOCK(h)     chSemSignal(&(h)->h_sem)
 #endif
 
@@ -289,6 +291,48 @@ size_t chHeapStatus(memory_heap_t *heapp, size_t *sizep) {
   return n;
 }
 
+/**
+ * @brief   Heap integrity check.
+ * @details Verifies that the free blocks list is ordered by address and
+ *          that the free blocks do not overlap, adjacent free blocks are
+ *          also reported because they would have been merged.
+ * @note    The function never waits for the heap to become available, if
+ *          the heap is in use then the check is skipped and reported as
+ *          passed. This makes the function usable from the idle thread.
+ *
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @return              The test result.
+ * @retval false        The test succeeded or it has been skipped.
+ * @retval true         Test failed.
+ *
+ * @api
+ */
+bool chHeapIntegrityCheck(memory_heap_t *heapp) {
+  union heap_header *qp;
+  bool result = false;
+
+  if (heapp == NULL) {
+    heapp = &default_heap;
+  }
+
+  if (!H_TRYLOCK(heapp)) {
+    return false;
+  }
+
+  qp = heapp->h_free.h.u.next;
+  while ((qp != NULL) && (qp->h.u.next != NULL)) {
+    if (LIMIT(qp) >= qp->h.u.next) {
+      result = true;
+      break;
+    }
+    qp = qp->h.u.next;
+  }
+  H_UNLOCK(heapp);
+
+  return result;
+}
+
 #endif /* CH_CFG_USE_HEAP == TRUE */
 
 /** @} */
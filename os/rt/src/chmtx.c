@@ -62,6 +62,17 @@
  *          The mechanism works with any number of nested mutexes and any
  *          number of involved threads. The algorithm complexity (worst case)
  *          is N with N equal to the number of nested mutexes.
+ *
+ *          <h2>Priority ceiling mode</h2>
+ *          If the option @p CH_CFG_USE_MUTEXES_CEILING is enabled then
+ *          mutexes initialized using @p chMtxObjectInitCeiling() implement
+ *          the immediate priority ceiling protocol instead. The owner of the
+ *          mutex is raised to the ceiling priority as soon the mutex is
+ *          taken and is restored on unlock, the ceiling must be equal or
+ *          higher than the priority of any thread using the mutex.<br>
+ *          Lock and unlock operations do not need to explore the
+ *          thread-mutex dependencies chain so their cost does not depend
+ *          on the mutexes nesting.
  * @pre     In order to use the mutex APIs the @p CH_CFG_USE_MUTEXES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling mutexes requires 5-12 (depending on the architecture)
@@ -73,6 +84,47 @@
 
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
 
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Mutexes lock-free fast path enable switch.
+ * @details The fast path only changes the owner field with an exclusive
+ *          load/store sequence, the owned mutexes list of the current
+ *          thread is updated outside of it. This is safe because the
+ *          @p p_mtxlist field of a thread is only accessed:
+ *          - by the thread itself while running, a thread never reads
+ *            the list of another thread.
+ *          - by the thread releasing a mutex to a waiter, the waiter is
+ *            suspended in @p chMtxLockS() at that time so it cannot be
+ *            inside a fast path sequence.
+ *          .
+ *          A thread preempted after the owner field has been written and
+ *          before the list update completes can get its priority raised
+ *          by a thread blocking on the mutex, the list becomes consistent
+ *          as soon as the thread is resumed and before it can unlock any
+ *          mutex so the priority recalculated on unlock is still correct.
+ * @note    Recursive mutexes always use the normal path.
+ */
+#define MTX_USE_FASTPATH    ((CH_CFG_USE_ATOMIC_FASTPATH == TRUE) &&        \
+                             (CH_CFG_USE_MUTEXES_RECURSIVE == FALSE))
+
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Raises a new mutex owner to the mutex ceiling.
+ * @note    Mutexes not using the priority ceiling protocol have a
+ *          @p NOPRIO ceiling so the priority is never changed.
+ */
+#define mtx_ceiling_raise(mp, tp) {                                         \
+  if ((tp)->p_prio < (mp)->m_ceiling) {                                     \
+    (tp)->p_prio = (mp)->m_ceiling;                                         \
+  }                                                                         \
+}
+#else
+#define mtx_ceiling_raise(mp, tp)
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -89,6 +141,186 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Priority inheritance walk.
+ * @details Explores the thread-mutex dependencies starting from the specified
+ *          mutex owner, boosting the priority of all the affected threads to
+ *          equal the specified priority.
+ *
+ * @param[in] tp        the mutex owner thread
+ * @param[in] prio      the priority to be inherited
+ *
+ * @notapi
+ */
+static void mtx_prio_inherit(thread_t *tp, tprio_t prio) {
+
+  /* Does the requesting thread have higher priority than the mutex
+     owning thread? */
+  while (tp->p_prio < prio) {
+    /* Make priority of thread tp match the requesting thread's priority.*/
+    tp->p_prio = prio;
+
+    /* The following states need priority queues reordering.*/
+    switch (tp->p_state) {
+    case CH_STATE_WTMTX:
+      /* Re-enqueues the mutex owner with its new priority.*/
+      queue_prio_insert(queue_dequeue(tp), &tp->p_u.wtmtxp->m_queue);
+      tp = tp->p_u.wtmtxp->m_owner;
+      /*lint -e{9042} [16.1] Continues the while.*/
+      continue;
+#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
+    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
+     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
+    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
+     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
+#if CH_CFG_USE_CONDVARS == TRUE
+    case CH_STATE_WTCOND:
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
+    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
+    case CH_STATE_WTSEM:
+#endif
+#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
+    case CH_STATE_SNDMSGQ:
+#endif
+      /* Re-enqueues tp with its new priority on the queue.*/
+      queue_prio_insert(queue_dequeue(tp), &tp->p_u.wtmtxp->m_queue);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->p_state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      (void) chSchReadyI(queue_dequeue(tp));
+      break;
+    default:
+      /* Nothing to do for other states.*/
+      break;
+    }
+    break;
+  }
+}
+
+/**
+ * @brief   Recalculates the priority of a mutexes owner.
+ * @details The priority is the highest among the thread base priority, the
+ *          priorities of the threads waiting on the owned mutexes and the
+ *          ceilings of the owned priority ceiling mutexes.
+ *
+ * @param[in] tp        the mutexes owner thread
+ * @return              The thread priority.
+ *
+ * @notapi
+ */
+static tprio_t mtx_owner_prio(thread_t *tp) {
+  tprio_t prio = tp->p_realprio;
+  mutex_t *lmp = tp->p_mtxlist;
+
+  while (lmp != NULL) {
+    /* If the highest priority thread waiting in the mutexes list has a
+       greater priority than the current thread base priority then the
+       final priority will have at least that priority.*/
+    if (chMtxQueueNotEmptyS(lmp) &&
+        (lmp->m_queue.p_next->p_prio > prio)) {
+      prio = lmp->m_queue.p_next->p_prio;
+    }
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+    if (lmp->m_ceiling > prio) {
+      prio = lmp->m_ceiling;
+    }
+#endif
+    lmp = lmp->m_next;
+  }
+
+  return prio;
+}
+
+#if (MTX_USE_FASTPATH == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Lock-free lock operation.
+ * @details The mutex is taken only if not owned, this is the uncontended
+ *          case where no priority inheritance is involved.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @return              The operation status.
+ * @retval false        if the mutex is owned, the normal path must be used.
+ * @retval true         if the mutex has been taken.
+ *
+ * @notapi
+ */
+static inline bool mtx_fast_lock(mutex_t *mp) {
+  void * volatile *ownerp = (void * volatile *)&mp->m_owner;
+  thread_t *ctp = currp;
+
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  /* Priority ceiling mutexes always use the normal path.*/
+  if (mp->m_ceiling != NOPRIO) {
+    return false;
+  }
+#endif
+
+  do {
+    if (port_load_exclusive_ptr(ownerp) != NULL) {
+      port_clear_exclusive();
+      return false;
+    }
+  } while (!port_store_exclusive_ptr(ownerp, (void *)ctp));
+
+  /* The list is updated after taking the mutex, see the note about the
+     owned mutexes list at the top of this module.*/
+  mp->m_next = ctp->p_mtxlist;
+  ctp->p_mtxlist = mp;
+
+  return true;
+}
+
+/**
+ * @brief   Lock-free unlock operation.
+ * @details The mutex is released only if there are no waiting threads, this
+ *          is the uncontended case where no priority change is involved.
+ *          A thread queued between the exclusive load and store makes the
+ *          store fail because a context switch happened in between.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @return              The operation status.
+ * @retval false        if there are waiting threads, the normal path must
+ *                      be used.
+ * @retval true         if the mutex has been released.
+ *
+ * @notapi
+ */
+static inline bool mtx_fast_unlock(mutex_t *mp) {
+  void * volatile *ownerp = (void * volatile *)&mp->m_owner;
+  thread_t *ctp = currp;
+  mutex_t *next = mp->m_next;
+
+  chDbgAssert(ctp->p_mtxlist == mp, "not next in list");
+
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  /* Priority ceiling mutexes always use the normal path.*/
+  if (mp->m_ceiling != NOPRIO) {
+    return false;
+  }
+#endif
+
+  do {
+    (void) port_load_exclusive_ptr(ownerp);
+    if (queue_notempty(&mp->m_queue)) {
+      port_clear_exclusive();
+      return false;
+    }
+  } while (!port_store_exclusive_ptr(ownerp, NULL));
+
+  /* The next field must not be accessed after releasing the mutex because
+     another thread could have taken it in the meanwhile.*/
+  ctp->p_mtxlist = next;
+
+  return true;
+}
+#endif /* MTX_USE_FASTPATH == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -109,7 +341,30 @@ void chMtxObjectInit(mutex_t *mp) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   mp->m_cnt = (cnt_t)0;
 #endif
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  mp->m_ceiling = NOPRIO;
+#endif
+}
+
+#if (CH_CFG_USE_MUTEXES_CEILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes s @p mutex_t structure as priority ceiling mutex.
+ * @note    The ceiling must be equal or greater than the priority of all
+ *          the threads using the mutex.
+ *
+ * @param[out] mp       pointer to a @p mutex_t structure
+ * @param[in] ceiling   the mutex priority ceiling
+ *
+ * @init
+ */
+void chMtxObjectInitCeiling(mutex_t *mp, tprio_t ceiling) {
+
+  chDbgCheck((ceiling > NOPRIO) && (ceiling <= HIGHPRIO));
+
+  chMtxObjectInit(mp);
+  mp->m_ceiling = ceiling;
 }
+#endif /* CH_CFG_USE_MUTEXES_CEILING == TRUE */
 
 /**
  * @brief   Locks the specified mutex.
@@ -122,6 +377,15 @@ void chMtxObjectInit(mutex_t *mp) {
  */
 void chMtxLock(mutex_t *mp) {
 
+  chDbgCheckClassX();
+  chDbgCheck(mp != NULL);
+
+#if MTX_USE_FASTPATH == TRUE
+  if (mtx_fast_lock(mp)) {
+    return;
+  }
+#endif
+
   chSysLock();
   chMtxLockS(mp);
   chSysUnlock();
@@ -141,6 +405,10 @@ void chMtxLockS(mutex_t *mp) {
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  chDbgAssert((mp->m_ceiling == NOPRIO) || (ctp->p_realprio <= mp->m_ceiling),
+              "ceiling violation");
+#endif
 
   /* Is the mutex already locked? */
   if (mp->m_owner != NULL) {
@@ -157,56 +425,10 @@ void chMtxLockS(mutex_t *mp) {
 #endif
       /* Priority inheritance protocol; explores the thread-mutex dependencies
          boosting the priority of all the affected threads to equal the
-         priority of the running thread requesting the mutex.*/
-      thread_t *tp = mp->m_owner;
-
-      /* Does the running thread have higher priority than the mutex
-         owning thread? */
-      while (tp->p_prio < ctp->p_prio) {
-        /* Make priority of thread tp match the running thread's priority.*/
-        tp->p_prio = ctp->p_prio;
-
-        /* The following states need priority queues reordering.*/
-        switch (tp->p_state) {
-        case CH_STATE_WTMTX:
-          /* Re-enqueues the mutex owner with its new priority.*/
-          queue_prio_insert(queue_dequeue(tp), &tp->p_u.wtmtxp->m_queue);
-          tp = tp->p_u.wtmtxp->m_owner;
-          /*lint -e{9042} [16.1] Continues the while.*/
-          continue;
-#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
-    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
-     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
-    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
-     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
-#if CH_CFG_USE_CONDVARS == TRUE
-        case CH_STATE_WTCOND:
-#endif
-#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
-    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
-        case CH_STATE_WTSEM:
-#endif
-#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
-        case CH_STATE_SNDMSGQ:
-#endif
-          /* Re-enqueues tp with its new priority on the queue.*/
-          queue_prio_insert(queue_dequeue(tp), &tp->p_u.wtmtxp->m_queue);
-          break;
-#endif
-        case CH_STATE_READY:
-#if CH_DBG_ENABLE_ASSERTS == TRUE
-          /* Prevents an assertion in chSchReadyI().*/
-          tp->p_state = CH_STATE_CURRENT;
-#endif
-          /* Re-enqueues tp with its new priority on the ready list.*/
-          (void) chSchReadyI(queue_dequeue(tp));
-          break;
-        default:
-          /* Nothing to do for other states.*/
-          break;
-        }
-        break;
-      }
+         priority of the running thread requesting the mutex. The owner of
+         a priority ceiling mutex is normally already running at an equal
+         or higher priority so the walk ends immediately.*/
+      mtx_prio_inherit(mp->m_owner, ctp->p_prio);
 
       /* Sleep on the mutex.*/
       queue_prio_insert(ctp, &mp->m_queue);
@@ -232,6 +454,7 @@ void chMtxLockS(mutex_t *mp) {
     mp->m_owner = ctp;
     mp->m_next = ctp->p_mtxlist;
     ctp->p_mtxlist = mp;
+    mtx_ceiling_raise(mp, ctp);
   }
 }
 
@@ -255,6 +478,15 @@ void chMtxLockS(mutex_t *mp) {
 bool chMtxTryLock(mutex_t *mp) {
   bool b;
 
+  chDbgCheckClassX();
+  chDbgCheck(mp != NULL);
+
+#if MTX_USE_FASTPATH == TRUE
+  if (mtx_fast_lock(mp)) {
+    return true;
+  }
+#endif
+
   chSysLock();
   b = chMtxTryLockS(mp);
   chSysUnlock();
@@ -283,6 +515,11 @@ bool chMtxTryLockS(mutex_t *mp) {
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+  chDbgAssert((mp->m_ceiling == NOPRIO) ||
+              (currp->p_realprio <= mp->m_ceiling),
+              "ceiling violation");
+#endif
 
   if (mp->m_owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
@@ -305,6 +542,7 @@ bool chMtxTryLockS(mutex_t *mp) {
   mp->m_owner = currp;
   mp->m_next = currp->p_mtxlist;
   currp->p_mtxlist = mp;
+  mtx_ceiling_raise(mp, currp);
   return true;
 }
 
@@ -322,10 +560,18 @@ bool chMtxTryLockS(mutex_t *mp) {
  */
 void chMtxUnlock(mutex_t *mp) {
   thread_t *ctp = currp;
-  mutex_t *lmp;
 
+  chDbgCheckClassX();
   chDbgCheck(mp != NULL);
 
+#if MTX_USE_FASTPATH == TRUE
+  chDbgAssert(mp->m_owner == ctp, "ownership failure");
+
+  if (mtx_fast_unlock(mp)) {
+    return;
+  }
+#endif
+
   chSysLock();
 
   chDbgAssert(ctp->p_mtxlist != NULL, "owned mutexes list empty");
@@ -348,23 +594,9 @@ void chMtxUnlock(mutex_t *mp) {
       thread_t *tp;
 
       /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = ctp->p_realprio;
-      lmp = ctp->p_mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) &&
-            (lmp->m_queue.p_next->p_prio > newprio)) {
-          newprio = lmp->m_queue.p_next->p_prio;
-        }
-        lmp = lmp->m_next;
-      }
-
-      /* Assigns to the current thread the highest priority among all the
-         waiting threads.*/
-      ctp->p_prio = newprio;
+         mutexes list, the current thread gets the highest priority among
+         all the waiting threads.*/
+      ctp->p_prio = mtx_owner_prio(ctp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
@@ -375,6 +607,7 @@ void chMtxUnlock(mutex_t *mp) {
       mp->m_owner = tp;
       mp->m_next = tp->p_mtxlist;
       tp->p_mtxlist = mp;
+      mtx_ceiling_raise(mp, tp);
 
       /* Note, not using chSchWakeupS() becuase that function expects the
          current thread to have the higher or equal priority than the ones
@@ -385,6 +618,13 @@ void chMtxUnlock(mutex_t *mp) {
     }
     else {
       mp->m_owner = NULL;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+      /* The priority raised by a priority ceiling mutex is restored.*/
+      if (mp->m_ceiling != NOPRIO) {
+        ctp->p_prio = mtx_owner_prio(ctp);
+        chSchRescheduleS();
+      }
+#endif
     }
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   }
@@ -409,7 +649,6 @@ void chMtxUnlock(mutex_t *mp) {
  */
 void chMtxUnlockS(mutex_t *mp) {
   thread_t *ctp = currp;
-  mutex_t *lmp;
 
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
@@ -434,23 +673,9 @@ void chMtxUnlockS(mutex_t *mp) {
       thread_t *tp;
 
       /* Recalculates the optimal thread priority by scanning the owned
-         mutexes list.*/
-      tprio_t newprio = ctp->p_realprio;
-      lmp = ctp->p_mtxlist;
-      while (lmp != NULL) {
-        /* If the highest priority thread waiting in the mutexes list has a
-           greater priority than the current thread base priority then the
-           final priority will have at least that priority.*/
-        if (chMtxQueueNotEmptyS(lmp) &&
-            (lmp->m_queue.p_next->p_prio > newprio)) {
-          newprio = lmp->m_queue.p_next->p_prio;
-        }
-        lmp = lmp->m_next;
-      }
-
-      /* Assigns to the current thread the highest priority among all the
-         waiting threads.*/
-      ctp->p_prio = newprio;
+         mutexes list, the current thread gets the highest priority among
+         all the waiting threads.*/
+      ctp->p_prio = mtx_owner_prio(ctp);
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
@@ -461,16 +686,71 @@ void chMtxUnlockS(mutex_t *mp) {
       mp->m_owner = tp;
       mp->m_next = tp->p_mtxlist;
       tp->p_mtxlist = mp;
+      mtx_ceiling_raise(mp, tp);
       (void) chSchReadyI(tp);
     }
     else {
       mp->m_owner = NULL;
+#if CH_CFG_USE_MUTEXES_CEILING == TRUE
+      /* The priority raised by a priority ceiling mutex is restored.*/
+      if (mp->m_ceiling != NOPRIO) {
+        ctp->p_prio = mtx_owner_prio(ctp);
+      }
+#endif
     }
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   }
 #endif
 }
 
+#if (CH_CFG_USE_CONDVARS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Moves a sleeping thread on a mutex.
+ * @details The specified thread, just removed from a condition variable
+ *          queue, is made to wait on the mutex as if it called
+ *          @p chMtxLockS() itself. If the mutex is not owned then the thread
+ *          becomes the owner and is made ready, else it is queued on the
+ *          mutex and the owner inherits its priority.
+ * @note    This function is used by condition variables broadcasts in order
+ *          to avoid waking up threads that would immediately go to sleep
+ *          again on the mutex (wait morphing).
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the thread to be moved
+ *
+ * @iclass
+ */
+void chMtxMorphI(mutex_t *mp, thread_t *tp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mp != NULL) && (tp != NULL));
+  chDbgAssert(mp->m_owner != tp, "already owner");
+
+  if (mp->m_owner != NULL) {
+    /* Sleeps on the mutex on behalf of the thread.*/
+    queue_prio_insert(tp, &mp->m_queue);
+    tp->p_state = CH_STATE_WTMTX;
+    tp->p_u.wtmtxp = mp;
+    mtx_prio_inherit(mp->m_owner, tp->p_prio);
+  }
+  else {
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+    chDbgAssert(mp->m_cnt == (cnt_t)0, "counter is not zero");
+
+    mp->m_cnt++;
+#endif
+    /* It was not owned, the thread becomes the owner and is readied.*/
+    mp->m_owner = tp;
+    mp->m_next = tp->p_mtxlist;
+    tp->p_mtxlist = mp;
+    mtx_ceiling_raise(mp, tp);
+    (void) chSchReadyI(tp);
+  }
+}
+#endif /* CH_CFG_USE_CONDVARS == TRUE */
+
 /**
  * @brief   Unlocks all mutexes owned by the invoking thread.
  * @post    The stack of owned mutexes is emptied and all the found
@@ -498,6 +778,7 @@ void chMtxUnlockAll(void) {
         mp->m_owner = tp;
         mp->m_next = tp->p_mtxlist;
         tp->p_mtxlist = mp;
+        mtx_ceiling_raise(mp, tp);
         (void) chSchReadyI(tp);
       }
       else {
@@ -31,7 +31,18 @@
  *            in the system.
  *          - <b>Next</b>, returns the next, in creation order, active thread
  *            in the system.
+ *          - <b>Find</b>, returns the thread having the specified name or
+ *            working area.
+ *          - <b>Snapshot</b>, copies the status of all the threads under a
+ *            single critical zone.
  *          .
+ *          Lookups by name scan the whole registry unless the names index
+ *          is enabled by setting @p CH_CFG_REGISTRY_HASH_SIZE to a non-zero
+ *          power of two, in that case named threads are also linked into a
+ *          hash table indexed by name. Thread names are meant to be
+ *          constant strings, the index is updated only when a name is
+ *          assigned using @p chRegSetThreadName() or
+ *          @p chRegSetThreadNameX().
  *          The registry is meant to be mainly a debug feature, for example,
  *          using the registry a debugger can enumerate the active threads
  *          in any given moment or the shell can print the active threads
@@ -44,6 +55,8 @@
  *          option must be enabled in @p chconf.h.
  * @{
  */
+#include <string.h>
+
 #include "ch.h"
 
 #if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
@@ -60,6 +73,13 @@
 /* Module local variables.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Registry names index.
+ */
+static thread_t *reg_hash[CH_CFG_REGISTRY_HASH_SIZE];
+#endif
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
@@ -70,6 +90,43 @@
   ((size_t)((char *)&((st *)0)->m - (char *)0))                             \
   /*lint -restore*/
 
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the names index bucket for the specified name.
+ * @note    FNV-1a hash function.
+ *
+ * @param[in] name      thread name as a zero terminated string
+ * @return              The bucket index.
+ *
+ * @notapi
+ */
+static unsigned reg_hash_name(const char *name) {
+  uint32_t h = 2166136261U;
+
+  while (*name != '\0') {
+    h ^= (uint32_t)(uint8_t)*name;
+    h *= 16777619U;
+    name++;
+  }
+
+  return (unsigned)(h & ((uint32_t)CH_CFG_REGISTRY_HASH_SIZE - 1U));
+}
+#endif
+
+/**
+ * @brief   Returns @p true if the thread has the specified name.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] name      thread name as a zero terminated string
+ * @return              The comparison result.
+ *
+ * @notapi
+ */
+static bool reg_name_match(thread_t *tp, const char *name) {
+
+  return (tp->p_name != NULL) && (strcmp(tp->p_name, name) == 0);
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -176,6 +233,206 @@ thread_t *chRegNextThread(thread_t *tp) {
   return ntp;
 }
 
+/**
+ * @brief   Returns the thread having the specified name.
+ * @details The search is performed in a single critical zone, a reference is
+ *          added to the returned thread in order to make sure its status is
+ *          not lost.
+ * @note    If more threads share the same name then any of them can be
+ *          returned.
+ * @note    The search is performed using the names index if enabled, else
+ *          the whole registry is scanned.
+ *
+ * @param[in] name      thread name as a zero terminated string
+ * @return              A reference to the found thread.
+ * @retval NULL         if a thread with the specified name does not exist.
+ *
+ * @api
+ */
+thread_t *chRegFindThreadByName(const char *name) {
+  thread_t *tp;
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  unsigned i;
+#endif
+
+  chDbgCheck(name != NULL);
+
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  i = reg_hash_name(name);
+#endif
+
+  chSysLock();
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  tp = reg_hash[i];
+  while ((tp != NULL) && !reg_name_match(tp, name)) {
+    tp = tp->p_hnext;
+  }
+#else
+  tp = ch.rlist.r_newer;
+  /*lint -save -e9087 -e740 [11.3, 1.3] Cast required by list handling.*/
+  while ((tp != (thread_t *)&ch.rlist) && !reg_name_match(tp, name)) {
+    tp = tp->p_newer;
+  }
+  if (tp == (thread_t *)&ch.rlist) {
+  /*lint -restore*/
+    tp = NULL;
+  }
+#endif
+#if CH_CFG_USE_DYNAMIC == TRUE
+  if (tp != NULL) {
+    chDbgAssert(tp->p_refs < (trefs_t)255, "too many references");
+    tp->p_refs++;
+  }
+#endif
+  chSysUnlock();
+
+  return tp;
+}
+
+/**
+ * @brief   Returns the thread using the specified working area.
+ * @details The search is performed in a single critical zone, a reference is
+ *          added to the returned thread in order to make sure its status is
+ *          not lost.
+ *
+ * @param[in] wa        pointer to a static or dynamic working area
+ * @return              A reference to the found thread.
+ * @retval NULL         if a thread using the specified working area does
+ *                      not exist.
+ *
+ * @api
+ */
+thread_t *chRegFindThreadByWorkingArea(void *wa) {
+  thread_t *tp;
+
+  chDbgCheck(wa != NULL);
+
+  chSysLock();
+  /* The thread structure is laid out in the lower part of the working
+     area.*/
+  tp = ch.rlist.r_newer;
+  /*lint -save -e9087 -e740 [11.3, 1.3] Cast required by list handling.*/
+  while ((tp != (thread_t *)&ch.rlist) && ((void *)tp != wa)) {
+    tp = tp->p_newer;
+  }
+  if (tp == (thread_t *)&ch.rlist) {
+  /*lint -restore*/
+    tp = NULL;
+  }
+#if CH_CFG_USE_DYNAMIC == TRUE
+  else {
+    chDbgAssert(tp->p_refs < (trefs_t)255, "too many references");
+    tp->p_refs++;
+  }
+#endif
+  chSysUnlock();
+
+  return tp;
+}
+
+/**
+ * @brief   Copies the status of the registered threads.
+ * @details The registry is scanned in creation order in a single critical
+ *          zone, no references are added to the threads so this function
+ *          is suitable for bulk reporting without the per-thread locking
+ *          overhead of @p chRegFirstThread() and @p chRegNextThread().
+ * @note    The critical zone duration is proportional to the number of
+ *          copied records.
+ *
+ * @param[out] tip      pointer to an array of @p thread_info_t records
+ * @param[in] n         number of records in the array
+ * @return              The number of records actually written.
+ *
+ * @api
+ */
+size_t chRegSnapshot(thread_info_t *tip, size_t n) {
+  thread_t *tp;
+  size_t i = (size_t)0;
+
+  chDbgCheck((tip != NULL) || (n == (size_t)0));
+
+  chSysLock();
+  tp = ch.rlist.r_newer;
+  /*lint -save -e9087 -e740 [11.3, 1.3] Cast required by list handling.*/
+  while ((tp != (thread_t *)&ch.rlist) && (i < n)) {
+  /*lint -restore*/
+    tip[i].ti_tp       = tp;
+    tip[i].ti_name     = tp->p_name;
+    tip[i].ti_prio     = tp->p_prio;
+#if CH_CFG_USE_MUTEXES == TRUE
+    tip[i].ti_realprio = tp->p_realprio;
+#endif
+    tip[i].ti_state    = tp->p_state;
+    tip[i].ti_flags    = tp->p_flags;
+#if CH_CFG_USE_DYNAMIC == TRUE
+    tip[i].ti_refs     = tp->p_refs;
+#endif
+#if CH_DBG_THREADS_PROFILING == TRUE
+    tip[i].ti_time     = tp->p_time;
+#endif
+    i++;
+    tp = tp->p_newer;
+  }
+  chSysUnlock();
+
+  return i;
+}
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Removes a thread from the names index.
+ * @note    This function is not meant for use in application code.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void _reg_unhash(thread_t *tp) {
+
+  if (tp->p_name != NULL) {
+    thread_t **tpp = &reg_hash[reg_hash_name(tp->p_name)];
+
+    while (*tpp != NULL) {
+      if (*tpp == tp) {
+        *tpp = tp->p_hnext;
+        break;
+      }
+      tpp = &(*tpp)->p_hnext;
+    }
+  }
+}
+
+/**
+ * @brief   Changes the name of a thread updating the names index.
+ * @note    This function is not meant for use in application code, use
+ *          @p chRegSetThreadNameX() instead.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] name      thread name as a zero terminated string
+ *
+ * @xclass
+ */
+void _reg_set_name(thread_t *tp, const char *name) {
+  syssts_t sts;
+  unsigned i = 0U;
+
+  if (name != NULL) {
+    i = reg_hash_name(name);
+  }
+
+  sts = chSysGetStatusAndLockX();
+  _reg_unhash(tp);
+  tp->p_name = name;
+
+  /* Terminated static threads are no more in the registry.*/
+  if ((name != NULL) && (tp->p_state != CH_STATE_FINAL)) {
+    tp->p_hnext = reg_hash[i];
+    reg_hash[i] = tp;
+  }
+  chSysRestoreStatusX(sts);
+}
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 #endif /* CH_CFG_USE_REGISTRY == TRUE */
 
 /** @} */
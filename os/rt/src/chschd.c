@@ -66,9 +66,11 @@ void _scheduler_init(void) {
 
   queue_init(&ch.rlist.r_queue);
   ch.rlist.r_prio = NOPRIO;
+  ch.rlist.r_gen = (ucnt_t)0;
 #if CH_CFG_USE_REGISTRY == TRUE
   ch.rlist.r_newer = (thread_t *)&ch.rlist;
   ch.rlist.r_older = (thread_t *)&ch.rlist;
+  ch.rlist.r_reggen = (ucnt_t)0;
 #endif
 }
 
@@ -225,6 +227,7 @@ thread_t *chSchReadyI(thread_t *tp) {
               "invalid state");
 
   tp->p_state = CH_STATE_READY;
+  ch.rlist.r_gen++;
   cp = (thread_t *)&ch.rlist.r_queue;
   do {
     cp = cp->p_next;
@@ -260,6 +263,7 @@ void chSchGoSleepS(tstate_t newstate) {
   otp->p_preempt = (tslices_t)CH_CFG_TIME_QUANTUM;
 #endif
   setcurrp(queue_fifo_remove(&ch.rlist.r_queue));
+  ch.rlist.r_gen++;
 #if defined(CH_CFG_IDLE_ENTER_HOOK)
   if (currp->p_prio == IDLEPRIO) {
     CH_CFG_IDLE_ENTER_HOOK();
@@ -282,6 +286,14 @@ static void wakeup(void *p) {
        another thread with higher priority.*/
     chSysUnlockFromISR();
     return;
+#if (CH_CFG_USE_CONDVARS == TRUE) && (CH_CFG_USE_CONDVARS_TIMEOUT == TRUE)
+  case CH_STATE_WTMTX:
+    /* Handling the special case where the thread has been moved from a
+       condition variable to a mutex queue by a broadcast, mutex waits have
+       no timeout.*/
+    chSysUnlockFromISR();
+    return;
+#endif
   case CH_STATE_SUSPENDED:
     *tp->p_u.wttrp = NULL;
     break;
@@ -458,6 +470,7 @@ void chSchDoRescheduleBehind(void) {
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
   setcurrp(queue_fifo_remove(&ch.rlist.r_queue));
+  ch.rlist.r_gen++;
 #if defined(CH_CFG_IDLE_LEAVE_HOOK)
   if (otp->p_prio == IDLEPRIO) {
     CH_CFG_IDLE_LEAVE_HOOK();
@@ -486,6 +499,7 @@ void chSchDoRescheduleAhead(void) {
   otp = currp;
   /* Picks the first thread from the ready queue and makes it current.*/
   setcurrp(queue_fifo_remove(&ch.rlist.r_queue));
+  ch.rlist.r_gen++;
 #if defined(CH_CFG_IDLE_LEAVE_HOOK)
   if (otp->p_prio == IDLEPRIO) {
     CH_CFG_IDLE_LEAVE_HOOK();
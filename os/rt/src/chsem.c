@@ -81,6 +81,62 @@
 #define sem_insert(tp, qp) queue_insert(tp, qp)
 #endif
 
+#if (CH_CFG_USE_ATOMIC_FASTPATH == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Lock-free wait operation.
+ * @details The counter is decremented only if positive, this is the
+ *          uncontended case where the invoking thread would not sleep.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @return              The operation status.
+ * @retval false        if the counter was not positive, the normal path
+ *                      must be used.
+ * @retval true         if the semaphore has been taken.
+ *
+ * @notapi
+ */
+static inline bool sem_fast_wait(semaphore_t *sp) {
+  cnt_t cnt;
+
+  do {
+    cnt = port_load_exclusive_cnt(&sp->s_cnt);
+    if (cnt <= (cnt_t)0) {
+      port_clear_exclusive();
+      return false;
+    }
+  } while (!port_store_exclusive_cnt(&sp->s_cnt, cnt - (cnt_t)1));
+
+  return true;
+}
+
+/**
+ * @brief   Lock-free signal operation.
+ * @details The counter is incremented only if non-negative, this is the
+ *          uncontended case where there are no threads to be awakened.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @return              The operation status.
+ * @retval false        if there are waiting threads, the normal path must
+ *                      be used.
+ * @retval true         if the semaphore has been signaled.
+ *
+ * @notapi
+ */
+static inline bool sem_fast_signal(semaphore_t *sp) {
+  cnt_t cnt;
+
+  do {
+    cnt = port_load_exclusive_cnt(&sp->s_cnt);
+    if (cnt < (cnt_t)0) {
+      port_clear_exclusive();
+      return false;
+    }
+  } while (!port_store_exclusive_cnt(&sp->s_cnt, cnt + (cnt_t)1));
+
+  return true;
+}
+#endif /* CH_CFG_USE_ATOMIC_FASTPATH == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -175,6 +231,15 @@ void chSemResetI(semaphore_t *sp, cnt_t n) {
 msg_t chSemWait(semaphore_t *sp) {
   msg_t msg;
 
+  chDbgCheckClassX();
+  chDbgCheck(sp != NULL);
+
+#if CH_CFG_USE_ATOMIC_FASTPATH == TRUE
+  if (sem_fast_wait(sp)) {
+    return MSG_OK;
+  }
+#endif
+
   chSysLock();
   msg = chSemWaitS(sp);
   chSysUnlock();
@@ -235,6 +300,15 @@ msg_t chSemWaitS(semaphore_t *sp) {
 msg_t chSemWaitTimeout(semaphore_t *sp, systime_t time) {
   msg_t msg;
 
+  chDbgCheckClassX();
+  chDbgCheck(sp != NULL);
+
+#if CH_CFG_USE_ATOMIC_FASTPATH == TRUE
+  if (sem_fast_wait(sp)) {
+    return MSG_OK;
+  }
+#endif
+
   chSysLock();
   msg = chSemWaitTimeoutS(sp, time);
   chSysUnlock();
@@ -293,11 +367,18 @@ msg_t chSemWaitTimeoutS(semaphore_t *sp, systime_t time) {
  */
 void chSemSignal(semaphore_t *sp) {
 
+  chDbgCheckClassX();
   chDbgCheck(sp != NULL);
   chDbgAssert(((sp->s_cnt >= (cnt_t)0) && queue_isempty(&sp->s_queue)) ||
               ((sp->s_cnt < (cnt_t)0) && queue_notempty(&sp->s_queue)),
               "inconsistent semaphore");
 
+#if CH_CFG_USE_ATOMIC_FASTPATH == TRUE
+  if (sem_fast_signal(sp)) {
+    return;
+  }
+#endif
+
   chSysLock();
   if (++sp->s_cnt <= (cnt_t)0) {
     chSchWakeupS(queue_fifo_remove(&sp->s_queue), MSG_OK);
@@ -29,6 +29,7 @@
  *          - Power Management.
  *          - Abnormal Termination.
  *          - Realtime counter.
+ *          - Integrity checks.
  *          .
  * @{
  */
@@ -43,14 +44,223 @@
 /* Module local types.                                                       */
 /*===========================================================================*/
 
+/**
+ * @brief   Incremental integrity checker state.
+ */
+typedef struct {
+  unsigned              phase;      /**< @brief Check being performed, one
+                                                of the @p CH_INTEGRITY_
+                                                masks.                      */
+  void                  *cursor;    /**< @brief Last validated node or
+                                                @p NULL if the scan has yet
+                                                to start.                   */
+  ucnt_t                gen;        /**< @brief Modifications counter of
+                                                the scanned list when the
+                                                cursor was saved.           */
+} integrity_state_t;
+
 /*===========================================================================*/
 /* Module local variables.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Incremental integrity checker state.
+ */
+static integrity_state_t integrity = {CH_INTEGRITY_RLIST, NULL, (ucnt_t)0};
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_DBG_FILL_THREADS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Verifies the stack canary of a thread.
+ * @details The lowest part of the stack area must still contain the fill
+ *          pattern written on thread creation, if not then the stack has
+ *          been exhausted.
+ * @note    The main thread is not checked because its stack is not part of
+ *          a working area.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The test result.
+ * @retval false        The test succeeded.
+ * @retval true         Test failed.
+ *
+ * @notapi
+ */
+static bool stack_check(thread_t *tp) {
+  const uint8_t *p = (const uint8_t *)(tp + 1);
+  unsigned i;
+
+  if (tp == &ch.mainthread) {
+    return false;
+  }
+
+  for (i = 0U; i < sizeof (stkalign_t); i++) {
+    if (p[i] != (uint8_t)CH_DBG_STACK_FILL_VALUE) {
+      return true;
+    }
+  }
+
+  return false;
+}
+#endif /* CH_DBG_FILL_THREADS == TRUE */
+
+/**
+ * @brief   Moves the incremental integrity checker to the specified check.
+ *
+ * @param[in] phase     the check to be started
+ *
+ * @notapi
+ */
+static void integrity_next(unsigned phase) {
+
+  integrity.phase  = phase;
+  integrity.cursor = NULL;
+}
+
+/**
+ * @brief   Ready list incremental check.
+ * @details Each scanned thread must be linked in both directions, must be
+ *          in the ready state and the list must be ordered by priority.
+ *
+ * @return              The mask of the failed checks, zero if none failed.
+ *
+ * @notapi
+ */
+static unsigned integrity_rlist_step(void) {
+  thread_t *head = (thread_t *)&ch.rlist.r_queue;
+  thread_t *tp, *ntp;
+  unsigned n;
+
+  /* Resuming from the last validated thread, if the ready list has been
+     modified since then the thread could have been removed or even freed
+     so the scan is restarted.*/
+  tp = (thread_t *)integrity.cursor;
+  if ((tp == NULL) || (integrity.gen != ch.rlist.r_gen)) {
+    tp = head;
+  }
+
+  for (n = 0U; n < (unsigned)CH_CFG_INTEGRITY_STEP_NODES; n++) {
+    ntp = tp->p_next;
+    if (ntp->p_prev != tp) {
+      return CH_INTEGRITY_RLIST;
+    }
+    if (ntp == head) {
+      integrity_next(CH_INTEGRITY_VTLIST);
+      return 0U;
+    }
+    if ((ntp->p_state != CH_STATE_READY) ||
+        ((tp != head) && (ntp->p_prio > tp->p_prio))) {
+      return CH_INTEGRITY_RLIST;
+    }
+    tp = ntp;
+  }
+  integrity.cursor = tp;
+  integrity.gen    = ch.rlist.r_gen;
+
+  return 0U;
+}
+
+/**
+ * @brief   Virtual timers list incremental check.
+ * @details Each scanned timer must be linked in both directions and must be
+ *          armed.
+ *
+ * @return              The mask of the failed checks, zero if none failed.
+ *
+ * @notapi
+ */
+static unsigned integrity_vtlist_step(void) {
+  virtual_timer_t *head = (virtual_timer_t *)&ch.vtlist;
+  virtual_timer_t *vtp, *nvtp;
+  unsigned n;
+
+  /* Resuming from the last validated timer, if the list has been modified
+     since then the timer could have been removed so the scan is
+     restarted.*/
+  vtp = (virtual_timer_t *)integrity.cursor;
+  if ((vtp == NULL) || (integrity.gen != ch.vtlist.vt_gen)) {
+    vtp = head;
+  }
+
+  for (n = 0U; n < (unsigned)CH_CFG_INTEGRITY_STEP_NODES; n++) {
+    nvtp = vtp->vt_next;
+    if (nvtp->vt_prev != vtp) {
+      return CH_INTEGRITY_VTLIST;
+    }
+    if (nvtp == head) {
+#if CH_CFG_USE_REGISTRY == TRUE
+      integrity_next(CH_INTEGRITY_REGISTRY);
+#elif CH_CFG_USE_HEAP == TRUE
+      integrity_next(CH_INTEGRITY_HEAP);
+#else
+      integrity_next(CH_INTEGRITY_RLIST);
+#endif
+      return 0U;
+    }
+    if (nvtp->vt_func == NULL) {
+      return CH_INTEGRITY_VTLIST;
+    }
+    vtp = nvtp;
+  }
+  integrity.cursor = vtp;
+  integrity.gen    = ch.vtlist.vt_gen;
+
+  return 0U;
+}
+
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Registry incremental check.
+ * @details Each scanned thread must be linked in both directions, the
+ *          stack canary is also verified if @p CH_DBG_FILL_THREADS is
+ *          enabled.
+ *
+ * @return              The mask of the failed checks, zero if none failed.
+ *
+ * @notapi
+ */
+static unsigned integrity_registry_step(void) {
+  thread_t *head = (thread_t *)&ch.rlist;
+  thread_t *tp, *ntp;
+  unsigned n;
+
+  /* Resuming from the last validated thread, if the registry has been
+     modified since then the thread could have been removed or even freed
+     so the scan is restarted.*/
+  tp = (thread_t *)integrity.cursor;
+  if ((tp == NULL) || (integrity.gen != ch.rlist.r_reggen)) {
+    tp = head;
+  }
+
+  for (n = 0U; n < (unsigned)CH_CFG_INTEGRITY_STEP_NODES; n++) {
+    ntp = tp->p_newer;
+    if (ntp->p_older != tp) {
+      return CH_INTEGRITY_REGISTRY;
+    }
+    if (ntp == head) {
+#if CH_CFG_USE_HEAP == TRUE
+      integrity_next(CH_INTEGRITY_HEAP);
+#else
+      integrity_next(CH_INTEGRITY_RLIST);
+#endif
+      return 0U;
+    }
+#if CH_DBG_FILL_THREADS == TRUE
+    if (stack_check(ntp)) {
+      return CH_INTEGRITY_STACKS;
+    }
+#endif
+    tp = ntp;
+  }
+  integrity.cursor = tp;
+  integrity.gen    = ch.rlist.r_reggen;
+
+  return 0U;
+}
+#endif /* CH_CFG_USE_REGISTRY == TRUE */
+
 #if (CH_CFG_NO_IDLE_THREAD == FALSE) || defined(__DOXYGEN__)
 /**
  * @brief   This function implements the idle thread infinite loop.
@@ -284,6 +494,21 @@ bool chSysIntegrityCheckI(unsigned testmask) {
   }
 #endif /* CH_CFG_USE_REGISTRY == TRUE */
 
+#if (CH_CFG_USE_REGISTRY == TRUE) && (CH_DBG_FILL_THREADS == TRUE)
+  if ((testmask & CH_INTEGRITY_STACKS) != 0U) {
+    thread_t *tp;
+
+    /* Scanning the registry checking the stack canaries.*/
+    tp = ch.rlist.r_newer;
+    while (tp != (thread_t *)&ch.rlist) {
+      if (stack_check(tp)) {
+        return true;
+      }
+      tp = tp->p_newer;
+    }
+  }
+#endif
+
 #if defined(PORT_INTEGRITY_CHECK)
   if ((testmask & CH_INTEGRITY_PORT) != 0U) {
     PORT_INTEGRITY_CHECK();
@@ -293,6 +518,79 @@ bool chSysIntegrityCheckI(unsigned testmask) {
   return false;
 }
 
+/**
+ * @brief   Incremental system integrity check.
+ * @details Performs a bounded step of the integrity check of the
+ *          ChibiOS/RT data structures, the ready list, the virtual timers
+ *          list, the registry, the threads stack canaries and the default
+ *          heap are checked in sequence. Each step validates at most
+ *          @p CH_CFG_INTEGRITY_STEP_NODES list nodes within a critical zone
+ *          so the impact on the system response time is bounded.
+ * @note    This function is meant to be invoked from
+ *          @p CH_CFG_IDLE_LOOP_HOOK() in order to have a continuous check
+ *          of the system state, it never waits.
+ * @note    Between steps the lists can change, each list has a modifications
+ *          counter and if it changed since the previous step then the scan
+ *          of that list is restarted from its head.
+ * @note    In case of failure @p CH_CFG_INTEGRITY_CHECK_HOOK() is invoked
+ *          from within the critical zone with the mask of the failed check
+ *          as parameter, if the hook is not defined then the system is
+ *          halted.
+ * @note    The stack canaries are checked only if @p CH_DBG_FILL_THREADS
+ *          is enabled, threads created using @p chThdCreateI() must have
+ *          their working area filled by the caller.
+ *
+ * @return              The step result.
+ * @retval false        The step succeeded.
+ * @retval true         The step failed.
+ *
+ * @api
+ */
+bool chSysIntegrityCheckStep(void) {
+  unsigned failed = 0U;
+
+#if CH_CFG_USE_HEAP == TRUE
+  /* The heap is protected by its own lock, it is checked outside the
+     critical zone.*/
+  if (integrity.phase == CH_INTEGRITY_HEAP) {
+    if (chHeapIntegrityCheck(NULL)) {
+      failed = CH_INTEGRITY_HEAP;
+    }
+  }
+#endif
+
+  chSysLock();
+  switch (integrity.phase) {
+  case CH_INTEGRITY_RLIST:
+    failed = integrity_rlist_step();
+    break;
+  case CH_INTEGRITY_VTLIST:
+    failed = integrity_vtlist_step();
+    break;
+#if CH_CFG_USE_REGISTRY == TRUE
+  case CH_INTEGRITY_REGISTRY:
+    failed = integrity_registry_step();
+    break;
+#endif
+  default:
+    /* Heap check already performed or unknown state, restarting.*/
+    integrity_next(CH_INTEGRITY_RLIST);
+    break;
+  }
+
+  if (failed != 0U) {
+    integrity_next(CH_INTEGRITY_RLIST);
+#if defined(CH_CFG_INTEGRITY_CHECK_HOOK) || defined(__DOXYGEN__)
+    CH_CFG_INTEGRITY_CHECK_HOOK(failed);
+#else
+    chSysHalt("integrity check failed");
+#endif
+  }
+  chSysUnlock();
+
+  return failed != 0U;
+}
+
 /**
  * @brief   Handles time ticks for round robin preemption and timer increments.
  * @details Decrements the remaining time quantum of the running thread
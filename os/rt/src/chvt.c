@@ -63,6 +63,7 @@ void _vt_init(void) {
   ch.vtlist.vt_next = (virtual_timer_t *)&ch.vtlist;
   ch.vtlist.vt_prev = (virtual_timer_t *)&ch.vtlist;
   ch.vtlist.vt_delta = (systime_t)-1;
+  ch.vtlist.vt_gen = (ucnt_t)0;
 #if CH_CFG_ST_TIMEDELTA == 0
   ch.vtlist.vt_systime = (systime_t)0;
 #else /* CH_CFG_ST_TIMEDELTA > 0 */
@@ -102,6 +103,7 @@ void chVTDoSetI(virtual_timer_t *vtp, systime_t delay,
 
   vtp->vt_par = par;
   vtp->vt_func = vtfunc;
+  ch.vtlist.vt_gen++;
 
 #if CH_CFG_ST_TIMEDELTA > 0
   {
@@ -180,6 +182,8 @@ void chVTDoResetI(virtual_timer_t *vtp) {
   chDbgCheck(vtp != NULL);
   chDbgAssert(vtp->vt_func != NULL, "timer not set or already triggered");
 
+  ch.vtlist.vt_gen++;
+
 #if CH_CFG_ST_TIMEDELTA == 0
 
   /* The delta of the timer is added to the next timer.*/
@@ -25,6 +25,36 @@ extern SDCDriver SDCD1;
 extern RTCDriver RTCD1;
 #endif
 
+/*
+ * Block cache settings, number of read cache lines and size in sectors of
+ * the write-behind buffer. The cache is disabled if both are zero.
+ */
+#if !defined(FATFS_CACHE_LINES)
+#define FATFS_CACHE_LINES           0
+#endif
+
+#if !defined(FATFS_CACHE_WRITE_BLOCKS)
+#define FATFS_CACHE_WRITE_BLOCKS    0
+#endif
+
+#define FATFS_USE_CACHE ((FATFS_CACHE_LINES > 0) ||                         \
+                         (FATFS_CACHE_WRITE_BLOCKS > 0))
+
+#if FATFS_USE_CACHE
+#include "blkcache.h"
+
+#if BLK_CACHE_BLOCK_SIZE != MMCSD_BLOCK_SIZE
+#error "BLK_CACHE_BLOCK_SIZE must be equal to MMCSD_BLOCK_SIZE"
+#endif
+
+static BlockCache cache;
+static blkcache_line_t cache_lines[FATFS_CACHE_LINES > 0 ?
+                                   FATFS_CACHE_LINES : 1];
+static uint32_t cache_wbuf[FATFS_CACHE_WRITE_BLOCKS > 0 ?
+                           FATFS_CACHE_WRITE_BLOCKS * MMCSD_BLOCK_SIZE / 4 :
+                           1];
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* Correspondence between physical drive number and physical drive.      */
 
@@ -51,6 +81,12 @@ DSTATUS disk_initialize (
       stat |= STA_NOINIT;
     if (mmcIsWriteProtected(&MMCD1))
       stat |=  STA_PROTECT;
+#if FATFS_USE_CACHE
+    /* Any cached content belongs to the previous mount.*/
+    bcacheObjectInit(&cache, (BaseBlockDevice *)&MMCD1,
+                     cache_lines, FATFS_CACHE_LINES,
+                     (uint8_t *)cache_wbuf, FATFS_CACHE_WRITE_BLOCKS);
+#endif
     return stat;
 #else
   case SDC:
@@ -60,6 +96,12 @@ DSTATUS disk_initialize (
       stat |= STA_NOINIT;
     if (sdcIsWriteProtected(&SDCD1))
       stat |=  STA_PROTECT;
+#if FATFS_USE_CACHE
+    /* Any cached content belongs to the previous mount.*/
+    bcacheObjectInit(&cache, (BaseBlockDevice *)&SDCD1,
+                     cache_lines, FATFS_CACHE_LINES,
+                     (uint8_t *)cache_wbuf, FATFS_CACHE_WRITE_BLOCKS);
+#endif
     return stat;
 #endif
   }
@@ -118,6 +160,10 @@ DRESULT disk_read (
   case MMC:
     if (blkGetDriverState(&MMCD1) != BLK_READY)
       return RES_NOTRDY;
+#if FATFS_USE_CACHE
+    if (blkRead(&cache, sector, buff, count))
+      return RES_ERROR;
+#else
     if (mmcStartSequentialRead(&MMCD1, sector))
       return RES_ERROR;
     while (count > 0) {
@@ -128,12 +174,17 @@ DRESULT disk_read (
     }
     if (mmcStopSequentialRead(&MMCD1))
         return RES_ERROR;
+#endif
     return RES_OK;
 #else
   case SDC:
     if (blkGetDriverState(&SDCD1) != BLK_READY)
       return RES_NOTRDY;
+#if FATFS_USE_CACHE
+    if (blkRead(&cache, sector, buff, count))
+#else
     if (sdcRead(&SDCD1, sector, buff, count))
+#endif
       return RES_ERROR;
     return RES_OK;
 #endif
@@ -161,6 +212,10 @@ DRESULT disk_write (
         return RES_NOTRDY;
     if (mmcIsWriteProtected(&MMCD1))
         return RES_WRPRT;
+#if FATFS_USE_CACHE
+    if (blkWrite(&cache, sector, buff, count))
+        return RES_ERROR;
+#else
     if (mmcStartSequentialWrite(&MMCD1, sector))
         return RES_ERROR;
     while (count > 0) {
@@ -171,12 +226,17 @@ DRESULT disk_write (
     }
     if (mmcStopSequentialWrite(&MMCD1))
         return RES_ERROR;
+#endif
     return RES_OK;
 #else
   case SDC:
     if (blkGetDriverState(&SDCD1) != BLK_READY)
       return RES_NOTRDY;
+#if FATFS_USE_CACHE
+    if (blkWrite(&cache, sector, buff, count))
+#else
     if (sdcWrite(&SDCD1, sector, buff, count))
+#endif
       return RES_ERROR;
     return RES_OK;
 #endif
@@ -202,12 +262,22 @@ DRESULT disk_ioctl (
   case MMC:
     switch (cmd) {
     case CTRL_SYNC:
+#if FATFS_USE_CACHE
+        if (blkSync(&cache))
+            return RES_ERROR;
+#endif
         return RES_OK;
     case GET_SECTOR_SIZE:
         *((WORD *)buff) = MMCSD_BLOCK_SIZE;
         return RES_OK;
 #if _USE_ERASE
     case CTRL_ERASE_SECTOR:
+#if FATFS_USE_CACHE
+        /* Pending writes must not overwrite the erased area.*/
+        if (bcacheFlush(&cache))
+            return RES_ERROR;
+        bcacheInvalidate(&cache);
+#endif
         mmcErase(&MMCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
         return RES_OK;
 #endif
@@ -218,6 +288,10 @@ DRESULT disk_ioctl (
   case SDC:
     switch (cmd) {
     case CTRL_SYNC:
+#if FATFS_USE_CACHE
+        if (blkSync(&cache))
+            return RES_ERROR;
+#endif
         return RES_OK;
     case GET_SECTOR_COUNT:
         *((DWORD *)buff) = mmcsdGetCardCapacity(&SDCD1);
@@ -230,6 +304,12 @@ DRESULT disk_ioctl (
         return RES_OK;
 #if _USE_ERASE
     case CTRL_ERASE_SECTOR:
+#if FATFS_USE_CACHE
+        /* Pending writes must not overwrite the erased area.*/
+        if (bcacheFlush(&cache))
+            return RES_ERROR;
+        bcacheInvalidate(&cache);
+#endif
         sdcErase(&SDCD1, *((DWORD *)buff), *((DWORD *)buff + 1));
         return RES_OK;
 #endif
@@ -68,7 +68,10 @@ typedef uint32_t        mem_ptr_t;
   osalSysHalt(x);                                                          \
 }
 
+/* Host builds (simulator) can get it from the C library headers.*/
+#if !defined(BYTE_ORDER)
 #define BYTE_ORDER LITTLE_ENDIAN
+#endif
 #define LWIP_PROVIDE_ERRNO
 
 #endif /* __CC_H__ */
@@ -60,13 +60,64 @@
 #include "arch/cc.h"
 #include "arch/sys_arch.h"
 
+#if SYS_ARCH_USE_POOLS
+/* Mailbox objects with their messages buffer.*/
+typedef struct {
+  mailbox_t mb;
+  msg_t     buffer[SYS_ARCH_MBOX_SIZE];
+} sys_arch_mbox_t;
+
+static semaphore_t sems[SYS_ARCH_SEMS];
+static sys_arch_mbox_t mboxes[SYS_ARCH_MBOXES];
+static THD_WORKING_AREA(was[SYS_ARCH_THREADS], SYS_ARCH_THREAD_STACK_SIZE);
+
+static MEMORYPOOL_DECL(sems_pool, sizeof (semaphore_t), NULL);
+static MEMORYPOOL_DECL(mboxes_pool, sizeof (sys_arch_mbox_t), NULL);
+static MEMORYPOOL_DECL(was_pool, sizeof (was[0]), NULL);
+
+#if LWIP_STATS && SYS_STATS
+struct stats_syselem sys_arch_thread_stats;
+
+/* Accounts the working areas in use, the free ones are linked in the
+   pool.*/
+void sys_arch_thread_stats_update(void) {
+  struct pool_header *php;
+  STAT_COUNTER used = SYS_ARCH_THREADS;
+
+  osalSysLock();
+  for (php = was_pool.mp_next; php != NULL; php = php->ph_next)
+    used--;
+  osalSysUnlock();
+
+  sys_arch_thread_stats.used = used;
+  if (used > sys_arch_thread_stats.max)
+    sys_arch_thread_stats.max = used;
+}
+
+#define THREAD_STATS_INC_ERR() (sys_arch_thread_stats.err++)
+#define THREAD_STATS_UPDATE()  sys_arch_thread_stats_update()
+#else
+#define THREAD_STATS_INC_ERR()
+#define THREAD_STATS_UPDATE()
+#endif
+#endif
+
 void sys_init(void) {
 
+#if SYS_ARCH_USE_POOLS
+  chPoolLoadArray(&sems_pool, sems, SYS_ARCH_SEMS);
+  chPoolLoadArray(&mboxes_pool, mboxes, SYS_ARCH_MBOXES);
+  chPoolLoadArray(&was_pool, was, SYS_ARCH_THREADS);
+#endif
 }
 
 err_t sys_sem_new(sys_sem_t *sem, u8_t count) {
 
+#if SYS_ARCH_USE_POOLS
+  *sem = chPoolAlloc(&sems_pool);
+#else
   *sem = chHeapAlloc(NULL, sizeof(semaphore_t));
+#endif
   if (*sem == 0) {
     SYS_STATS_INC(sem.err);
     return ERR_MEM;
@@ -80,7 +131,11 @@ err_t sys_sem_new(sys_sem_t *sem, u8_t count) {
 
 void sys_sem_free(sys_sem_t *sem) {
 
+#if SYS_ARCH_USE_POOLS
+  chPoolFree(&sems_pool, *sem);
+#else
   chHeapFree(*sem);
+#endif
   *sem = SYS_SEM_NULL;
   SYS_STATS_DEC(sem.used);
 }
@@ -125,6 +180,22 @@ void sys_sem_set_invalid(sys_sem_t *sem) {
 
 err_t sys_mbox_new(sys_mbox_t *mbox, int size) {
   
+#if SYS_ARCH_USE_POOLS
+  /* All the pool mailboxes have the same capacity, smaller mailboxes just
+     use part of it.*/
+  if (size <= 0)
+    size = SYS_ARCH_MBOX_SIZE;
+  *mbox = size <= SYS_ARCH_MBOX_SIZE ? chPoolAlloc(&mboxes_pool) : NULL;
+  if (*mbox == 0) {
+    SYS_STATS_INC(mbox.err);
+    return ERR_MEM;
+  }
+  else {
+    chMBObjectInit(*mbox, ((sys_arch_mbox_t *)*mbox)->buffer, size);
+    SYS_STATS_INC_USED(mbox);
+    return ERR_OK;
+  }
+#else
   *mbox = chHeapAlloc(NULL, sizeof(mailbox_t) + sizeof(msg_t) * size);
   if (*mbox == 0) {
     SYS_STATS_INC(mbox.err);
@@ -132,9 +203,10 @@ err_t sys_mbox_new(sys_mbox_t *mbox, int size) {
   }
   else {
     chMBObjectInit(*mbox, (void *)(((uint8_t *)*mbox) + sizeof(mailbox_t)), size);
-    SYS_STATS_INC(mbox.used);
+    SYS_STATS_INC_USED(mbox);
     return ERR_OK;
   }
+#endif
 }
 
 void sys_mbox_free(sys_mbox_t *mbox) {
@@ -151,7 +223,11 @@ void sys_mbox_free(sys_mbox_t *mbox) {
     SYS_STATS_INC(mbox.err);
     chMBReset(*mbox);
   }
+#if SYS_ARCH_USE_POOLS
+  chPoolFree(&mboxes_pool, *mbox);
+#else
   chHeapFree(*mbox);
+#endif
   *mbox = SYS_MBOX_NULL;
   SYS_STATS_DEC(mbox.used);
 }
@@ -204,6 +280,25 @@ void sys_mbox_set_invalid(sys_mbox_t *mbox) {
 
 sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread,
                             void *arg, int stacksize, int prio) {
+#if SYS_ARCH_USE_POOLS
+  thread_t *tp;
+
+  /* The working area is returned to the pool when the thread terminates
+     and chThdWait() is invoked on it.*/
+  if (THD_WORKING_AREA_SIZE(stacksize) > sizeof (was[0])) {
+    THREAD_STATS_INC_ERR();
+    return NULL;
+  }
+  tp = chThdCreateFromMemoryPool(&was_pool, prio, (tfunc_t)thread, arg);
+  if (tp == NULL) {
+    THREAD_STATS_INC_ERR();
+    return NULL;
+  }
+  chRegSetThreadNameX(tp, name);
+  THREAD_STATS_UPDATE();
+
+  return (sys_thread_t)tp;
+#else
   size_t wsz;
   void *wsp;
   syssts_t sts;
@@ -231,6 +326,7 @@ sys_thread_t sys_thread_new(const char *name, lwip_thread_fn thread,
   chSysRestoreStatusX(sts);
 
   return (sys_thread_t)tp;
+#endif
 }
 
 sys_prot_t sys_arch_protect(void) {
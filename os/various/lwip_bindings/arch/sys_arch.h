@@ -65,4 +65,94 @@ typedef syssts_t        sys_prot_t;
 /* let sys.h use binary semaphores for mutexes */
 #define LWIP_COMPAT_MUTEX 1
 
+/**
+ * @brief   Static pools for the lwIP objects.
+ * @details If enabled the semaphores, mailboxes and threads working areas
+ *          are allocated from fixed size memory pools instead of the heap,
+ *          the pools are sized from the lwIP options by default. Usage and
+ *          high water marks of semaphores and mailboxes are accounted in
+ *          the @p SYS_STATS statistics, those of the threads working areas
+ *          in @p sys_arch_thread_stats.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS and @p CH_CFG_USE_DYNAMIC.
+ */
+#if !defined(SYS_ARCH_USE_POOLS) || defined(__DOXYGEN__)
+#define SYS_ARCH_USE_POOLS              FALSE
+#endif
+
+#if SYS_ARCH_USE_POOLS || defined(__DOXYGEN__)
+#define SYS_ARCH_MAX(a, b)              ((a) > (b) ? (a) : (b))
+
+/**
+ * @brief   Number of semaphores in the pool.
+ * @details One for each netconn plus the ones used by the sockets select
+ *          and the core locking.
+ */
+#if !defined(SYS_ARCH_SEMS) || defined(__DOXYGEN__)
+#define SYS_ARCH_SEMS                   (MEMP_NUM_NETCONN + 4)
+#endif
+
+/**
+ * @brief   Number of mailboxes in the pool.
+ * @details Receive and accept mailboxes for each netconn plus the
+ *          tcpip thread mailbox.
+ */
+#if !defined(SYS_ARCH_MBOXES) || defined(__DOXYGEN__)
+#define SYS_ARCH_MBOXES                 ((2 * MEMP_NUM_NETCONN) + 1)
+#endif
+
+/**
+ * @brief   Capacity of the pool mailboxes.
+ */
+#if !defined(SYS_ARCH_MBOX_SIZE) || defined(__DOXYGEN__)
+#define SYS_ARCH_MBOX_SIZE                                                  \
+  SYS_ARCH_MAX(TCPIP_MBOX_SIZE,                                             \
+  SYS_ARCH_MAX(DEFAULT_TCP_RECVMBOX_SIZE,                                   \
+  SYS_ARCH_MAX(DEFAULT_UDP_RECVMBOX_SIZE,                                   \
+  SYS_ARCH_MAX(DEFAULT_RAW_RECVMBOX_SIZE, DEFAULT_ACCEPTMBOX_SIZE))))
+#endif
+
+/**
+ * @brief   Number of thread working areas in the pool.
+ */
+#if !defined(SYS_ARCH_THREADS) || defined(__DOXYGEN__)
+#define SYS_ARCH_THREADS                1
+#endif
+
+/**
+ * @brief   Stack size of the pool working areas.
+ */
+#if !defined(SYS_ARCH_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define SYS_ARCH_THREAD_STACK_SIZE                                          \
+  SYS_ARCH_MAX(TCPIP_THREAD_STACKSIZE, DEFAULT_THREAD_STACKSIZE)
+#endif
+
+#if (SYS_ARCH_MBOX_SIZE <= 0) || (SYS_ARCH_THREAD_STACK_SIZE <= 0)
+#error "SYS_ARCH_USE_POOLS requires the mailboxes and stacks sizes"
+#endif
+
+#if !CH_CFG_USE_MEMPOOLS || !CH_CFG_USE_DYNAMIC
+#error "SYS_ARCH_USE_POOLS requires CH_CFG_USE_MEMPOOLS and CH_CFG_USE_DYNAMIC"
+#endif
+
+#if (LWIP_STATS && SYS_STATS) || defined(__DOXYGEN__)
+/**
+ * @brief   Threads working areas pool statistics.
+ * @details Same layout of the @p SYS_STATS elements. The usage is updated
+ *          on each thread creation and by
+ *          @p sys_arch_thread_stats_update(), working areas returned to
+ *          the pool by terminated threads are accounted at the next
+ *          update.
+ */
+extern struct stats_syselem sys_arch_thread_stats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void sys_arch_thread_stats_update(void);
+#ifdef __cplusplus
+}
+#endif
+#endif
+#endif /* SYS_ARCH_USE_POOLS */
+
 #endif /* __SYS_ARCH_H__ */
@@ -56,7 +56,6 @@
  */
 
 #include "hal.h"
-#include "evtimer.h"
 
 #include "lwipthread.h"
 
@@ -76,8 +75,46 @@
 #include <lwip/dhcp.h>
 #endif
 
-#define PERIODIC_TIMER_ID       1
-#define FRAME_RECEIVED_ID       2
+#if MAC_USE_ZERO_COPY
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "MAC_USE_ZERO_COPY requires LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+#if ETH_PAD_SIZE
+#error "MAC_USE_ZERO_COPY requires ETH_PAD_SIZE == 0"
+#endif
+
+#if !CH_CFG_USE_MEMPOOLS
+#error "MAC_USE_ZERO_COPY requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+/*
+ * Custom pbuf wrapping a MAC receive buffer.
+ */
+typedef struct {
+  struct pbuf_custom    pc;
+  MACReceiveDescriptor  rd;
+} rx_pbuf_t;
+
+/*
+ * Pool of the custom pbufs lent to the stack.
+ */
+static rx_pbuf_t rx_pbufs[LWIP_RX_ZERO_COPY_PBUFS];
+static MEMORYPOOL_DECL(rx_pbufs_pool, sizeof (rx_pbuf_t), NULL);
+#endif /* MAC_USE_ZERO_COPY */
+
+#if MAC_SUPPORTS_CHECKSUM_OFFLOAD
+/*
+ * Checksums delegated to the MAC, those not handled by the stack according
+ * to the lwIP CHECKSUM_GEN_ and CHECKSUM_CHECK_ options.
+ */
+#define LWIP_MAC_CHECKSUM                                                   \
+  ((CHECKSUM_GEN_IP ? 0U : MAC_CHECKSUM_GEN_IP) |                           \
+   ((CHECKSUM_GEN_TCP && CHECKSUM_GEN_UDP) ? 0U : MAC_CHECKSUM_GEN_PROTO) | \
+   (CHECKSUM_CHECK_IP ? 0U : MAC_CHECKSUM_CHECK_IP) |                       \
+   ((CHECKSUM_CHECK_TCP && CHECKSUM_CHECK_UDP) ? 0U :                       \
+                                                 MAC_CHECKSUM_CHECK_PROTO))
+#endif
 
 /*
  * Suspension point for initialization procedure.
@@ -89,6 +126,29 @@ thread_reference_t lwip_trp = NULL;
  */
 static THD_WORKING_AREA(wa_lwip_thread, LWIP_THREAD_STACK_SIZE);
 
+/*
+ * Interfaces served by the LWIP-MAC thread.
+ */
+static lwipthread_if_t *lwip_ifs;
+static unsigned lwip_nifs;
+
+/*
+ * Interface used by lwipInit().
+ */
+static lwipthread_if_t default_if;
+
+#if MAC_USE_ZERO_COPY
+/*
+ * Custom pbuf free function, the receive buffer is given back to the MAC.
+ */
+static void rx_pbuf_free(struct pbuf *p) {
+  rx_pbuf_t *rpp = (rx_pbuf_t *)p;
+
+  macReleaseReceiveDescriptor(&rpp->rd);
+  chPoolFree(&rx_pbufs_pool, rpp);
+}
+#endif /* MAC_USE_ZERO_COPY */
+
 /*
  * Initialization.
  */
@@ -110,20 +170,45 @@ static void low_level_init(struct netif *netif) {
  * Transmits a frame.
  */
 static err_t low_level_output(struct netif *netif, struct pbuf *p) {
+#if MAC_USE_ZERO_COPY
+  uint8_t *buf;
+  size_t n;
+  u16_t offset, remaining;
+#else
   struct pbuf *q;
+#endif
   MACTransmitDescriptor td;
+  lwipthread_if_t *ifp = netif->state;
 
-  (void)netif;
-  if (macWaitTransmitDescriptor(&ETHD1, &td, MS2ST(LWIP_SEND_TIMEOUT)) != MSG_OK)
+  if (macWaitTransmitDescriptor(ifp->macp, &td,
+                                MS2ST(LWIP_SEND_TIMEOUT)) != MSG_OK)
     return ERR_TIMEOUT;
 
 #if ETH_PAD_SIZE
   pbuf_header(p, -ETH_PAD_SIZE);        /* drop the padding word */
 #endif
 
+#if MAC_USE_ZERO_COPY
+  /* The pbuf chain is gathered directly into the MAC transmit buffers, this
+     is still a copy: mapping the pbufs on the transmit descriptors would
+     require holding them until the transmission is complete.*/
+  offset    = 0;
+  remaining = p->tot_len;
+  while (remaining > 0) {
+    buf = macGetNextTransmitBuffer(&td, remaining, &n);
+    if (buf == NULL)
+      break;
+    if (n > remaining)
+      n = remaining;
+    (void)pbuf_copy_partial(p, buf, (u16_t)n, offset);
+    offset    += (u16_t)n;
+    remaining -= (u16_t)n;
+  }
+#else
   /* Iterates through the pbuf chain. */
   for(q = p; q != NULL; q = q->next)
     macWriteTransmitDescriptor(&td, (uint8_t *)q->payload, (size_t)q->len);
+#endif
   macReleaseTransmitDescriptor(&td);
 
 #if ETH_PAD_SIZE
@@ -142,11 +227,40 @@ static struct pbuf *low_level_input(struct netif *netif) {
   MACReceiveDescriptor rd;
   struct pbuf *p, *q;
   u16_t len;
+  lwipthread_if_t *ifp = netif->state;
 
-  (void)netif;
-  if (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_IMMEDIATE) == MSG_OK) {
+  if (macWaitReceiveDescriptor(ifp->macp, &rd, TIME_IMMEDIATE) == MSG_OK) {
     len = (u16_t)rd.size;
 
+#if MAC_USE_ZERO_COPY
+    /* If a custom pbuf is available then the frame is passed to the stack
+       without copying it, the receive buffer is given back to the MAC when
+       the pbuf is freed.*/
+    {
+      MACReceiveDescriptor zrd = rd;
+      const uint8_t *buf;
+      size_t n;
+      rx_pbuf_t *rpp;
+
+      /* Frames spanning multiple receive buffers are copied.*/
+      buf = macGetNextReceiveBuffer(&zrd, &n);
+      rpp = n >= len ? chPoolAlloc(&rx_pbufs_pool) : NULL;
+      if (rpp != NULL) {
+        rpp->rd = rd;
+        rpp->pc.custom_free_function = rx_pbuf_free;
+        p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &rpp->pc,
+                                (void *)buf, (u16_t)n);
+        if (p != NULL) {
+          LINK_STATS_INC(link.recv);
+          return p;
+        }
+
+        /* The descriptor is still owned here, the frame is copied.*/
+        chPoolFree(&rx_pbufs_pool, rpp);
+      }
+    }
+#endif
+
 #if ETH_PAD_SIZE
     len += ETH_PAD_SIZE;        /* allow room for Ethernet padding */
 #endif
@@ -197,7 +311,6 @@ static err_t ethernetif_init(struct netif *netif) {
    */
   NETIF_INIT_SNMP(netif, snmp_ifType_ethernet_csmacd, LWIP_LINK_SPEED);
 
-  netif->state = NULL;
   netif->name[0] = LWIP_IFNAME0;
   netif->name[1] = LWIP_IFNAME1;
   /* We directly use etharp_output() here to save a function call.
@@ -213,111 +326,168 @@ static err_t ethernetif_init(struct netif *netif) {
   return ERR_OK;
 }
 
+/*
+ * Link status polling of all the interfaces.
+ */
+static void lwip_poll_links(void) {
+  unsigned i;
+
+  for (i = 0; i < lwip_nifs; i++) {
+    struct netif *netif = &lwip_ifs[i].netif;
+    bool current_link_status = macPollLinkStatus(lwip_ifs[i].macp);
+
+    if (current_link_status != netif_is_link_up(netif)) {
+      if (current_link_status) {
+        tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_up,
+                                   netif, 0);
+#if LWIP_DHCP
+        dhcp_start(netif);
+#endif
+      }
+      else {
+        tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_down,
+                                   netif, 0);
+#if LWIP_DHCP
+        dhcp_stop(netif);
+#endif
+      }
+    }
+  }
+}
+
+/*
+ * Passes the received frames of an interface to the stack, up to
+ * LWIP_RX_BUDGET frames. Returns true if the budget has been exhausted.
+ */
+static bool lwip_receive(struct netif *netif) {
+  struct pbuf *p;
+  unsigned n;
+
+  for (n = 0; n < LWIP_RX_BUDGET; n++) {
+    struct eth_hdr *ethhdr;
+
+    if ((p = low_level_input(netif)) == NULL)
+      return false;
+    ethhdr = p->payload;
+    switch (htons(ethhdr->type)) {
+    /* IP or ARP packet? */
+    case ETHTYPE_IP:
+    case ETHTYPE_ARP:
+#if PPPOE_SUPPORT
+    /* PPPoE packet? */
+    case ETHTYPE_PPPOEDISC:
+    case ETHTYPE_PPPOE:
+#endif /* PPPOE_SUPPORT */
+      /* full packet send to tcpip_thread to process */
+      if (netif->input(p, netif) == ERR_OK)
+        break;
+      LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
+    default:
+      pbuf_free(p);
+    }
+  }
+  return true;
+}
+
 /**
  * @brief LWIP handling thread.
+ * @details The thread serves all the interfaces passed to
+ *          @p lwipInitInterfaces(), the receive event of the interface
+ *          with index @p i is mapped on the event flag @p EVENT_MASK(i).
+ *          The link status is polled every @p LWIP_LINK_POLL_INTERVAL
+ *          using the events wait timeout.
  *
- * @param[in] p pointer to a @p lwipthread_opts structure or @p NULL
+ * @param[in] p         not used
  * @return The function does not return.
  */
 static THD_FUNCTION(lwip_thread, p) {
-  event_timer_t evt;
-  event_listener_t el0, el1;
   struct ip_addr ip, gateway, netmask;
-  static struct netif thisif;
-  static const MACConfig mac_config = {thisif.hwaddr};
+  systime_t last_poll;
+  unsigned i;
 
+  (void)p;
   chRegSetThreadName("lwipthread");
 
+#if MAC_USE_ZERO_COPY
+  chPoolLoadArray(&rx_pbufs_pool, rx_pbufs, LWIP_RX_ZERO_COPY_PBUFS);
+#endif
+
   /* Initializes the thing.*/
   tcpip_init(NULL, NULL);
 
-  /* TCP/IP parameters, runtime or compile time.*/
-  if (p) {
-    struct lwipthread_opts *opts = p;
-    unsigned i;
-
-    for (i = 0; i < 6; i++)
-      thisif.hwaddr[i] = opts->macaddress[i];
-    ip.addr = opts->address;
-    gateway.addr = opts->gateway;
-    netmask.addr = opts->netmask;
-  }
-  else {
-    thisif.hwaddr[0] = LWIP_ETHADDR_0;
-    thisif.hwaddr[1] = LWIP_ETHADDR_1;
-    thisif.hwaddr[2] = LWIP_ETHADDR_2;
-    thisif.hwaddr[3] = LWIP_ETHADDR_3;
-    thisif.hwaddr[4] = LWIP_ETHADDR_4;
-    thisif.hwaddr[5] = LWIP_ETHADDR_5;
-    LWIP_IPADDR(&ip);
-    LWIP_GATEWAY(&gateway);
-    LWIP_NETMASK(&netmask);
-  }
-  macStart(&ETHD1, &mac_config);
-  netif_add(&thisif, &ip, &netmask, &gateway, NULL, ethernetif_init, tcpip_input);
+  for (i = 0; i < lwip_nifs; i++) {
+    lwipthread_if_t *ifp = &lwip_ifs[i];
+    struct netif *netif = &ifp->netif;
 
-  netif_set_default(&thisif);
-  netif_set_up(&thisif);
+    /* TCP/IP parameters, runtime or compile time.*/
+    if (ifp->opts != NULL) {
+      unsigned j;
 
-  /* Setup event sources.*/
-  evtObjectInit(&evt, LWIP_LINK_POLL_INTERVAL);
-  evtStart(&evt);
-  chEvtRegisterMask(&evt.et_es, &el0, PERIODIC_TIMER_ID);
-  chEvtRegisterMask(macGetReceiveEventSource(&ETHD1), &el1, FRAME_RECEIVED_ID);
-  chEvtAddEvents(PERIODIC_TIMER_ID | FRAME_RECEIVED_ID);
+      for (j = 0; j < 6; j++)
+        netif->hwaddr[j] = ifp->opts->macaddress[j];
+      ip.addr = ifp->opts->address;
+      gateway.addr = ifp->opts->gateway;
+      netmask.addr = ifp->opts->netmask;
+    }
+    else {
+      netif->hwaddr[0] = LWIP_ETHADDR_0;
+      netif->hwaddr[1] = LWIP_ETHADDR_1;
+      netif->hwaddr[2] = LWIP_ETHADDR_2;
+      netif->hwaddr[3] = LWIP_ETHADDR_3;
+      netif->hwaddr[4] = LWIP_ETHADDR_4;
+      netif->hwaddr[5] = LWIP_ETHADDR_5;
+      LWIP_IPADDR(&ip);
+      LWIP_GATEWAY(&gateway);
+      LWIP_NETMASK(&netmask);
+    }
+    ifp->mac_config.mac_address = netif->hwaddr;
+#if MAC_SUPPORTS_CHECKSUM_OFFLOAD
+    ifp->mac_config.checksum = LWIP_MAC_CHECKSUM;
+#endif
+    macStart(ifp->macp, &ifp->mac_config);
+    netif_add(netif, &ip, &netmask, &gateway, ifp, ethernetif_init,
+              tcpip_input);
+
+    /* The first interface is the default one.*/
+    if (i == 0)
+      netif_set_default(netif);
+    netif_set_up(netif);
+
+    /* Setup event sources.*/
+    chEvtRegisterMask(macGetReceiveEventSource(ifp->macp), &ifp->el,
+                      EVENT_MASK(i));
+    chEvtAddEvents(EVENT_MASK(i));
+  }
 
   /* Resumes the caller and goes to the final priority.*/
   chThdResume(&lwip_trp, MSG_OK);
   chThdSetPriority(LWIP_THREAD_PRIORITY);
 
+  lwip_poll_links();
+  last_poll = chVTGetSystemTimeX();
   while (true) {
-    eventmask_t mask = chEvtWaitAny(ALL_EVENTS);
-    if (mask & PERIODIC_TIMER_ID) {
-      bool current_link_status = macPollLinkStatus(&ETHD1);
-      if (current_link_status != netif_is_link_up(&thisif)) {
-        if (current_link_status) {
-          tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_up,
-                                     &thisif, 0);
-#if LWIP_DHCP
-          dhcp_start(&thisif);
-#endif
-        }
-        else {
-          tcpip_callback_with_block((tcpip_callback_fn) netif_set_link_down,
-                                     &thisif, 0);
-#if LWIP_DHCP
-          dhcp_stop(&thisif);
-#endif
-        }
-      }
+    eventmask_t mask;
+    systime_t elapsed = chVTTimeElapsedSinceX(last_poll);
+
+    if (elapsed >= LWIP_LINK_POLL_INTERVAL) {
+      lwip_poll_links();
+      last_poll = chVTGetSystemTimeX();
+      elapsed = (systime_t)0;
     }
-    if (mask & FRAME_RECEIVED_ID) {
-      struct pbuf *p;
-      while ((p = low_level_input(&thisif)) != NULL) {
-        struct eth_hdr *ethhdr = p->payload;
-        switch (htons(ethhdr->type)) {
-        /* IP or ARP packet? */
-        case ETHTYPE_IP:
-        case ETHTYPE_ARP:
-#if PPPOE_SUPPORT
-        /* PPPoE packet? */
-        case ETHTYPE_PPPOEDISC:
-        case ETHTYPE_PPPOE:
-#endif /* PPPOE_SUPPORT */
-          /* full packet send to tcpip_thread to process */
-          if (thisif.input(p, &thisif) == ERR_OK)
-            break;
-          LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
-        default:
-          pbuf_free(p);
-        }
-      }
+
+    mask = chEvtWaitAnyTimeout(ALL_EVENTS, LWIP_LINK_POLL_INTERVAL - elapsed);
+    for (i = 0; i < lwip_nifs; i++) {
+      /* If the budget is exhausted then the event is posted again, the
+         interface is served again after the others.*/
+      if ((mask & EVENT_MASK(i)) && lwip_receive(&lwip_ifs[i].netif))
+        chEvtAddEvents(EVENT_MASK(i));
     }
   }
 }
 
 /**
  * @brief   Initializes the lwIP subsystem.
+ * @details A single interface is served, attached to @p ETHD1.
  * @note    The function exits after the initialization is finished.
  *
  * @param[in] opts      pointer to the configuration structure, if @p NULL
@@ -325,9 +495,35 @@ static THD_FUNCTION(lwip_thread, p) {
  */
 void lwipInit(const lwipthread_opts_t *opts) {
 
+  default_if.macp = &ETHD1;
+  default_if.opts = opts;
+  lwipInitInterfaces(&default_if, 1);
+}
+
+/**
+ * @brief   Initializes the lwIP subsystem on multiple interfaces.
+ * @details Each interface is served by its own MAC driver, the first
+ *          interface of the array becomes the default one.
+ * @note    The function exits after the initialization is finished.
+ * @note    Interfaces without settings get the static configuration, this
+ *          is only meaningful for one interface.
+ *
+ * @param[in] ifs       array of interface objects, the @p macp and @p opts
+ *                      fields must be initialized, the objects must remain
+ *                      valid while the stack is running
+ * @param[in] n         number of interfaces in the array
+ */
+void lwipInitInterfaces(lwipthread_if_t *ifs, unsigned n) {
+
+  chDbgCheck((ifs != NULL) && (n > 0U) &&
+             (n <= sizeof (eventmask_t) * 8U));
+
+  lwip_ifs  = ifs;
+  lwip_nifs = n;
+
   /* Creating the lwIP thread (it changes priority internally).*/
   chThdCreateStatic(wa_lwip_thread, sizeof (wa_lwip_thread),
-                    chThdGetPriorityX() - 1, lwip_thread, (void *)opts);
+                    chThdGetPriorityX() - 1, lwip_thread, NULL);
 
   /* Waiting for the lwIP thread complete initialization. Note,
      this thread reaches the thread reference object first because
@@ -25,6 +25,7 @@
 #define _LWIPTHREAD_H_
 
 #include <lwip/opt.h>
+#include <lwip/netif.h>
 
 /**
  * @brief   lwIP thread priority.
@@ -75,6 +76,39 @@
 #define LWIP_SEND_TIMEOUT                   50
 #endif
 
+/**
+ * @brief   Receive budget.
+ * @details Maximum number of frames passed to the stack for each interface
+ *          on each wakeup of the lwIP thread, the remaining frames are
+ *          processed after serving the other interfaces. This bounds the
+ *          time spent on a flooded interface.
+ */
+#if !defined(LWIP_RX_BUDGET) || defined(__DOXYGEN__)
+#define LWIP_RX_BUDGET                      16
+#endif
+
+/**
+ * @brief   Number of receive buffers lent to the stack.
+ * @details When the MAC driver is built with @p MAC_USE_ZERO_COPY enabled
+ *          the received frames are passed to lwIP as custom pbufs pointing
+ *          directly into the MAC receive buffers, the buffers are given
+ *          back to the MAC when the pbufs are freed. This is the maximum
+ *          number of frames that can be held by the stack at any time,
+ *          further frames are copied into pool pbufs.
+ * @note    A lent buffer is not available to the MAC until the pbuf is
+ *          freed, when the receive ring wraps onto it the reception is
+ *          suspended. Frames held for long by the stack, for example in
+ *          the TCP out of sequence queue or in a netconn receive mailbox
+ *          not read by the application, stop the reception until they
+ *          are freed. Disable @p MAC_USE_ZERO_COPY if this is not
+ *          acceptable.
+ * @note    The transmitted frames are always copied into the MAC
+ *          transmit buffers.
+ */
+#if !defined(LWIP_RX_ZERO_COPY_PBUFS) || defined(__DOXYGEN__)
+#define LWIP_RX_ZERO_COPY_PBUFS             2
+#endif
+
 /**
  * @brief   Link speed.
  */
@@ -148,10 +182,40 @@ typedef struct lwipthread_opts {
   uint32_t      gateway;
 } lwipthread_opts_t;
 
+/**
+ * @brief   Network interface object.
+ * @details Binds a lwIP network interface to a MAC driver, an array of
+ *          these objects is passed to @p lwipInitInterfaces().
+ */
+typedef struct lwipthread_if {
+  /**
+   * @brief   MAC driver serving the interface.
+   */
+  MACDriver                 *macp;
+  /**
+   * @brief   TCP/IP settings or @p NULL for the static configuration.
+   */
+  const lwipthread_opts_t   *opts;
+  /* End of the configuration fields.*/
+  /**
+   * @brief   lwIP network interface.
+   */
+  struct netif              netif;
+  /**
+   * @brief   MAC driver configuration.
+   */
+  MACConfig                 mac_config;
+  /**
+   * @brief   Receive event listener.
+   */
+  event_listener_t          el;
+} lwipthread_if_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
   void lwipInit(const lwipthread_opts_t *opts);
+  void lwipInitInterfaces(lwipthread_if_t *ifs, unsigned n);
 #ifdef __cplusplus
 }
 #endif
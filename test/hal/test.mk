@@ -0,0 +1,34 @@
+# List of all the ChibiOS/HAL test files.
+TESTSRC = ${CHIBIOS}/test/lib/ch_test.c \
+          ${CHIBIOS}/test/hal/test_root.c \
+          ${CHIBIOS}/test/hal/test_sequence_001.c \
+          ${CHIBIOS}/test/hal/test_sequence_002.c \
+          ${CHIBIOS}/test/hal/test_sequence_003.c \
+          ${CHIBIOS}/test/hal/test_sequence_004.c \
+          ${CHIBIOS}/test/hal/test_sequence_005.c \
+          ${CHIBIOS}/test/hal/test_sequence_006.c \
+          ${CHIBIOS}/test/hal/test_sequence_007.c \
+          ${CHIBIOS}/test/hal/test_sequence_009.c \
+          ${CHIBIOS}/test/hal/test_sequence_010.c \
+          ${CHIBIOS}/test/hal/test_sequence_011.c \
+          ${CHIBIOS}/test/hal/test_sequence_014.c \
+          ${CHIBIOS}/os/hal/lib/blocks/blkcache.c \
+          ${CHIBIOS}/os/hal/lib/blocks/blkqueue.c \
+          ${CHIBIOS}/os/hal/lib/flash/ramflash.c \
+          ${CHIBIOS}/os/hal/lib/flash/kvstore.c \
+          ${CHIBIOS}/os/hal/lib/flash/flfs.c
+
+# Required include directories
+TESTINC = ${CHIBIOS}/test/lib \
+          ${CHIBIOS}/test/hal \
+          ${CHIBIOS}/os/hal/lib/blocks \
+          ${CHIBIOS}/os/hal/lib/flash
+
+# List of the ChibiOS/HAL test files running on the STM32 peripherals
+# models.
+TESTSTM32SRC = ${CHIBIOS}/test/lib/ch_test.c \
+               ${CHIBIOS}/test/hal/test_root.c \
+               ${CHIBIOS}/test/hal/test_sequence_008.c \
+               ${CHIBIOS}/test/hal/test_sequence_012.c \
+               ${CHIBIOS}/test/hal/test_sequence_013.c \
+               ${CHIBIOS}/test/hal/test_sequence_015.c
@@ -0,0 +1,167 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.c
+ * @brief   Test Suite root structures code.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Array of all the test sequences.
+ */
+const testcase_t * const *test_suite[] = {
+#if !defined(SIMULATOR_STM32)
+  test_sequence_001,
+  test_sequence_002,
+  test_sequence_003,
+  test_sequence_004,
+  test_sequence_005,
+  test_sequence_006,
+  test_sequence_007,
+  test_sequence_009,
+  test_sequence_010,
+  test_sequence_011,
+  test_sequence_014,
+#else
+  test_sequence_008,
+  test_sequence_012,
+  test_sequence_013,
+  test_sequence_015,
+#endif
+  NULL
+};
+
+/*===========================================================================*/
+/* Shared code.                                                              */
+/*===========================================================================*/
+
+RamBlockDevice ramblk1;
+
+static bool ramblk_is_inserted(void *instance) {
+
+  (void)instance;
+
+  return true;
+}
+
+static bool ramblk_is_protected(void *instance) {
+
+  (void)instance;
+
+  return false;
+}
+
+static bool ramblk_connect(void *instance) {
+  RamBlockDevice *rbdp = (RamBlockDevice *)instance;
+
+  rbdp->state = BLK_READY;
+
+  return HAL_SUCCESS;
+}
+
+static bool ramblk_disconnect(void *instance) {
+  RamBlockDevice *rbdp = (RamBlockDevice *)instance;
+
+  rbdp->state = BLK_ACTIVE;
+
+  return HAL_SUCCESS;
+}
+
+static bool ramblk_read(void *instance, uint32_t startblk,
+                        uint8_t *buffer, uint32_t n) {
+  RamBlockDevice *rbdp = (RamBlockDevice *)instance;
+
+  rbdp->reads++;
+  rbdp->time += RAMBLK_OP_TIME + (n * RAMBLK_BLOCK_TIME);
+  if (rbdp->fail || (startblk + n > RAMBLK_BLOCKS)) {
+    return HAL_FAILED;
+  }
+  memcpy(buffer, &rbdp->data[startblk * RAMBLK_BLOCK_SIZE],
+         n * RAMBLK_BLOCK_SIZE);
+
+  return HAL_SUCCESS;
+}
+
+static bool ramblk_write(void *instance, uint32_t startblk,
+                         const uint8_t *buffer, uint32_t n) {
+  RamBlockDevice *rbdp = (RamBlockDevice *)instance;
+
+  rbdp->writes++;
+  rbdp->time += RAMBLK_OP_TIME + (n * RAMBLK_BLOCK_TIME);
+  if (rbdp->fail || (startblk + n > RAMBLK_BLOCKS)) {
+    return HAL_FAILED;
+  }
+  memcpy(&rbdp->data[startblk * RAMBLK_BLOCK_SIZE], buffer,
+         n * RAMBLK_BLOCK_SIZE);
+
+  return HAL_SUCCESS;
+}
+
+static bool ramblk_sync(void *instance) {
+  RamBlockDevice *rbdp = (RamBlockDevice *)instance;
+
+  return rbdp->fail ? HAL_FAILED : HAL_SUCCESS;
+}
+
+static bool ramblk_get_info(void *instance, BlockDeviceInfo *bdip) {
+
+  (void)instance;
+
+  bdip->blk_size = RAMBLK_BLOCK_SIZE;
+  bdip->blk_num  = RAMBLK_BLOCKS;
+
+  return HAL_SUCCESS;
+}
+
+static const struct BaseBlockDeviceVMT ramblk_vmt = {
+  ramblk_is_inserted,
+  ramblk_is_protected,
+  ramblk_connect,
+  ramblk_disconnect,
+  ramblk_read,
+  ramblk_write,
+  ramblk_sync,
+  ramblk_get_info
+};
+
+/*
+ * Initializes a RAM block device, the content is cleared.
+ */
+void ramblkObjectInit(RamBlockDevice *rbdp) {
+
+  rbdp->vmt    = &ramblk_vmt;
+  rbdp->state  = BLK_ACTIVE;
+  rbdp->reads  = 0U;
+  rbdp->writes = 0U;
+  rbdp->time   = 0U;
+  rbdp->fail   = false;
+  memset(rbdp->data, 0, sizeof(rbdp->data));
+}
+
+/** @} */
@@ -0,0 +1,100 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    test_root.h
+ * @brief   Test Suite root structures header.
+ *
+ * @addtogroup CH_TEST_ROOT
+ * @{
+ */
+
+#ifndef _TEST_ROOT_H_
+#define _TEST_ROOT_H_
+
+#include "ch.h"
+
+#include "test_sequence_001.h"
+#include "test_sequence_002.h"
+#include "test_sequence_003.h"
+#include "test_sequence_004.h"
+#include "test_sequence_005.h"
+#include "test_sequence_006.h"
+#include "test_sequence_007.h"
+#include "test_sequence_008.h"
+#include "test_sequence_009.h"
+#include "test_sequence_010.h"
+#include "test_sequence_011.h"
+#include "test_sequence_012.h"
+#include "test_sequence_013.h"
+#include "test_sequence_014.h"
+#include "test_sequence_015.h"
+
+/*===========================================================================*/
+/* Default definitions.                                                      */
+/*===========================================================================*/
+
+/* Global test suite name, it is printed on top of the test
+   report header.*/
+#define TEST_SUITE_NAME                     "ChibiOS/HAL Test Suite"
+
+/*===========================================================================*/
+/* Shared definitions.                                                       */
+/*===========================================================================*/
+
+/* Geometry of the RAM block device.*/
+#define RAMBLK_BLOCK_SIZE                   512U
+#define RAMBLK_BLOCKS                       64U
+
+/* Simulated timings of the RAM block device in microseconds, a fixed
+   overhead per operation plus the transfer time of each block.*/
+#define RAMBLK_OP_TIME                      1000U
+#define RAMBLK_BLOCK_TIME                   50U
+
+/* RAM block device used by the tests, failures can be injected.*/
+typedef struct {
+  const struct BaseBlockDeviceVMT *vmt;
+  _base_block_device_data
+  /* Read operations performed.*/
+  uint32_t              reads;
+  /* Write operations performed.*/
+  uint32_t              writes;
+  /* Simulated device busy time in microseconds.*/
+  uint32_t              time;
+  /* All the operations fail when set.*/
+  bool                  fail;
+  /* Device content.*/
+  uint8_t               data[RAMBLK_BLOCKS * RAMBLK_BLOCK_SIZE];
+} RamBlockDevice;
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern const testcase_t * const *test_suite[];
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  extern RamBlockDevice ramblk1;
+  void ramblkObjectInit(RamBlockDevice *rbdp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TEST_ROOT_H_ */
+
+/** @} */
@@ -0,0 +1,650 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_001 USB Mass Storage driver
+ *
+ * File: @ref test_sequence_001.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the USB Mass Storage driver. Two drivers are bound
+ * to the interfaces of a composite device on the simulated USB driver,
+ * the test thread acts as the USB host.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_001_001
+ * - @subpage test_001_002
+ * - @subpage test_001_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define EP_IN1                  1U
+#define EP_OUT1                 2U
+#define EP_IN2                  3U
+#define EP_OUT2                 4U
+
+static USBMassStorageDriver msd1, msd2;
+static uint8_t data[8U * RAMBLK_BLOCK_SIZE];
+static uint8_t rxdata[8U * RAMBLK_BLOCK_SIZE];
+static uint32_t tag;
+static uint8_t lun;
+static THD_WORKING_AREA(wa_server, 256);
+
+static const USBMassStorageConfig msdcfg1 = {
+  &USBD1,
+  EP_IN1,
+  EP_OUT1,
+  0U,
+  (BaseBlockDevice *)&ramblk1,
+  "ChibiOS",
+  "Test Disk",
+  "1.0"
+};
+
+static const USBMassStorageConfig msdcfg2 = {
+  &USBD1,
+  EP_IN2,
+  EP_OUT2,
+  1U,
+  (BaseBlockDevice *)&ramblk1,
+  "ChibiOS",
+  "Test Disk 2",
+  "1.0"
+};
+
+static USBInEndpointState ep1instate, ep3instate;
+static USBOutEndpointState ep2outstate, ep4outstate;
+
+static const USBEndpointConfig ep1config = {
+  USB_EP_MODE_TYPE_BULK, NULL, msdDataTransmitted, NULL,
+  0x40, 0x00, &ep1instate, NULL
+};
+
+static const USBEndpointConfig ep2config = {
+  USB_EP_MODE_TYPE_BULK, NULL, NULL, msdDataReceived,
+  0x00, 0x40, NULL, &ep2outstate
+};
+
+static const USBEndpointConfig ep3config = {
+  USB_EP_MODE_TYPE_BULK, NULL, msdDataTransmitted, NULL,
+  0x40, 0x00, &ep3instate, NULL
+};
+
+static const USBEndpointConfig ep4config = {
+  USB_EP_MODE_TYPE_BULK, NULL, NULL, msdDataReceived,
+  0x00, 0x40, NULL, &ep4outstate
+};
+
+static const USBDescriptor *get_descriptor(USBDriver *usbp, uint8_t dtype,
+                                           uint8_t dindex, uint16_t lang) {
+
+  (void)usbp;
+  (void)dtype;
+  (void)dindex;
+  (void)lang;
+
+  return NULL;
+}
+
+static void usb_event(USBDriver *usbp, usbevent_t event) {
+
+  osalSysLockFromISR();
+  switch (event) {
+  case USB_EVENT_RESET:
+    msdDisconnectI(&msd1);
+    msdDisconnectI(&msd2);
+    break;
+  case USB_EVENT_CONFIGURED:
+    usbInitEndpointI(usbp, EP_IN1, &ep1config);
+    usbInitEndpointI(usbp, EP_OUT1, &ep2config);
+    usbInitEndpointI(usbp, EP_IN2, &ep3config);
+    usbInitEndpointI(usbp, EP_OUT2, &ep4config);
+    msdConfigureHookI(&msd1);
+    msdConfigureHookI(&msd2);
+    break;
+  default:
+    break;
+  }
+  osalSysUnlockFromISR();
+}
+
+static bool requests_hook(USBDriver *usbp) {
+
+  (void)usbp;
+
+  return msdRequestsHook(&msd1) || msdRequestsHook(&msd2);
+}
+
+static const USBConfig usbcfg = {
+  usb_event,
+  get_descriptor,
+  requests_hook,
+  NULL
+};
+
+static THD_FUNCTION(server, arg) {
+  USBMassStorageDriver *msdp = (USBMassStorageDriver *)arg;
+
+  while (msdp->state != MSD_STOP) {
+    (void)msdServeCommand(msdp);
+  }
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t get_be32(const uint8_t *p) {
+
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/*
+ * Bus reset followed by SET_CONFIGURATION(1).
+ */
+static msg_t host_configure(void) {
+  static const uint8_t set_configuration[8] = {
+    0x00, USB_REQ_SET_CONFIGURATION, 1, 0, 0, 0, 0, 0
+  };
+
+  usb_lld_host_reset(&USBD1);
+  return usb_lld_host_control(&USBD1, set_configuration, NULL);
+}
+
+/*
+ * Clears the halt condition of an endpoint.
+ */
+static msg_t host_clear_halt(uint8_t epaddr) {
+  uint8_t setup[8] = {
+    0x02, USB_REQ_CLEAR_FEATURE, 0, 0, 0, 0, 0, 0
+  };
+
+  setup[4] = epaddr;
+  return usb_lld_host_control(&USBD1, setup, NULL);
+}
+
+/*
+ * Bulk-Only command transport on the first interface, the data phase is
+ * performed on the data buffer. Returns the CSW status or -1 on transport
+ * errors, the residue is stored in @p residuep. The command is addressed
+ * to the LUN in @p lun.
+ */
+static int host_command(const uint8_t *cb, size_t cblen, uint32_t len,
+                        bool in, uint8_t *buf, uint32_t *residuep) {
+  uint8_t cbw[MSD_CBW_SIZE], csw[MSD_CSW_SIZE];
+  uint32_t done = 0U;
+  size_t n;
+  msg_t msg;
+
+  memset(cbw, 0, sizeof(cbw));
+  put_le32(&cbw[0], MSD_CBW_SIGNATURE);
+  put_le32(&cbw[4], ++tag);
+  put_le32(&cbw[8], len);
+  cbw[12] = in ? 0x80U : 0x00U;
+  cbw[13] = lun;
+  cbw[14] = (uint8_t)cblen;
+  memcpy(&cbw[15], cb, cblen < 16U ? cblen : 16U);
+  if (usb_lld_host_out(&USBD1, EP_OUT1, cbw, sizeof(cbw)) != MSG_OK) {
+    return -1;
+  }
+
+  /* Data phase, the device transfers up to a buffer per transaction,
+     a short transfer is terminated by halting the endpoint.*/
+  while (done < len) {
+    n = len - done;
+    if (n > USB_MSD_BUFFERS_SIZE) {
+      n = USB_MSD_BUFFERS_SIZE;
+    }
+    if (in) {
+      msg = usb_lld_host_in(&USBD1, EP_IN1, &buf[done], &n);
+    }
+    else {
+      msg = usb_lld_host_out(&USBD1, EP_OUT1, &buf[done], n);
+    }
+    if (msg == MSG_RESET) {
+      if (host_clear_halt(in ? (0x80U | EP_IN1) : EP_OUT1) != MSG_OK) {
+        return -1;
+      }
+      break;
+    }
+    if (msg != MSG_OK) {
+      return -1;
+    }
+    done += (uint32_t)n;
+  }
+
+  /* Status phase.*/
+  n = sizeof(csw);
+  msg = usb_lld_host_in(&USBD1, EP_IN1, csw, &n);
+  if (msg == MSG_RESET) {
+    if (host_clear_halt(0x80U | EP_IN1) != MSG_OK) {
+      return -1;
+    }
+    n = sizeof(csw);
+    msg = usb_lld_host_in(&USBD1, EP_IN1, csw, &n);
+  }
+  if ((msg != MSG_OK) || (n != MSD_CSW_SIZE) ||
+      (get_le32(&csw[0]) != MSD_CSW_SIGNATURE) ||
+      (get_le32(&csw[4]) != tag)) {
+    return -1;
+  }
+  *residuep = get_le32(&csw[8]);
+
+  return (int)csw[12];
+}
+
+static void rw10(uint8_t *cb, uint8_t op, uint32_t lba, uint16_t n) {
+
+  memset(cb, 0, 10U);
+  cb[0] = op;
+  cb[2] = (uint8_t)(lba >> 24);
+  cb[3] = (uint8_t)(lba >> 16);
+  cb[4] = (uint8_t)(lba >> 8);
+  cb[5] = (uint8_t)lba;
+  cb[7] = (uint8_t)(n >> 8);
+  cb[8] = (uint8_t)n;
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_001_001 Start and stop
+ *
+ * <h2>Description</h2>
+ * The driver state transitions and the endpoints binding are tested.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A driver never started is stopped, the configuration is not accessed
+ *   and commands are refused.
+ * - Two drivers are started, each one is bound to its own endpoints.
+ * - One driver is stopped, only its endpoints are released.
+ * .
+ */
+
+static void test_001_001_setup(void) {
+
+  ramblkObjectInit(&ramblk1);
+  msdObjectInit(&msd1);
+  msdObjectInit(&msd2);
+}
+
+static void test_001_001_teardown(void) {
+
+  msdStop(&msd1);
+  msdStop(&msd2);
+}
+
+static void test_001_001_execute(void) {
+
+  /* A driver never started is stopped, the configuration is not accessed
+     and commands are refused.*/
+  test_set_step(1);
+  {
+    msdStop(&msd1);
+    test_assert(msd1.state == MSD_STOP, "not stopped");
+    test_assert(msdServeCommand(&msd1) == MSG_RESET, "command served");
+  }
+
+  /* Two drivers are started, each one is bound to its own endpoints.*/
+  test_set_step(2);
+  {
+    msdStart(&msd1, &msdcfg1);
+    msdStart(&msd2, &msdcfg2);
+    test_assert((msd1.state == MSD_READY) && (msd2.state == MSD_READY),
+                "not ready");
+    test_assert((USBD1.in_params[EP_IN1 - 1U] == &msd1) &&
+                (USBD1.out_params[EP_OUT1 - 1U] == &msd1) &&
+                (USBD1.in_params[EP_IN2 - 1U] == &msd2) &&
+                (USBD1.out_params[EP_OUT2 - 1U] == &msd2),
+                "wrong binding");
+  }
+
+  /* One driver is stopped, only its endpoints are released.*/
+  test_set_step(3);
+  {
+    msdStop(&msd1);
+    test_assert((USBD1.in_params[EP_IN1 - 1U] == NULL) &&
+                (USBD1.out_params[EP_OUT1 - 1U] == NULL), "not released");
+    test_assert((USBD1.in_params[EP_IN2 - 1U] == &msd2) &&
+                (USBD1.out_params[EP_OUT2 - 1U] == &msd2), "released");
+  }
+}
+
+static const testcase_t test_001_001 = {
+  "start and stop",
+  test_001_001_setup,
+  test_001_001_teardown,
+  test_001_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_001_002 Class requests
+ *
+ * <h2>Description</h2>
+ * The class requests are sent to both the interfaces of the device.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The device is configured.
+ * - Get Max LUN is sent to both the interfaces, each driver answers from
+ *   its own storage.
+ * - A class request to an interface without driver is stalled.
+ * - Bulk-Only Mass Storage Reset is accepted.
+ * .
+ */
+
+static void test_001_002_setup(void) {
+
+  ramblkObjectInit(&ramblk1);
+  msdObjectInit(&msd1);
+  msdObjectInit(&msd2);
+  msdStart(&msd1, &msdcfg1);
+  msdStart(&msd2, &msdcfg2);
+  usbStart(&USBD1, &usbcfg);
+}
+
+static void test_001_002_teardown(void) {
+
+  msdStop(&msd1);
+  msdStop(&msd2);
+  usbStop(&USBD1);
+}
+
+static void test_001_002_execute(void) {
+  uint8_t setup[8] = {0xA1, MSD_REQ_GET_MAX_LUN, 0, 0, 0, 0, 1, 0};
+  uint8_t lun;
+
+  /* The device is configured.*/
+  test_set_step(1);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+    test_assert(usbGetDriverStateI(&USBD1) == USB_ACTIVE, "not active");
+  }
+
+  /* Get Max LUN is sent to both the interfaces, each driver answers from
+     its own storage.*/
+  test_set_step(2);
+  {
+    lun = 0xFFU;
+    setup[4] = 0U;
+    test_assert(usb_lld_host_control(&USBD1, setup, &lun) == MSG_OK,
+                "request failed");
+    test_assert(lun == 0U, "wrong max LUN");
+    test_assert(USBD1.ep0next == &msd1.max_lun,
+                "not sent from the first driver");
+
+    lun = 0xFFU;
+    setup[4] = 1U;
+    test_assert(usb_lld_host_control(&USBD1, setup, &lun) == MSG_OK,
+                "request failed");
+    test_assert(lun == 0U, "wrong max LUN");
+    test_assert(USBD1.ep0next == &msd2.max_lun,
+                "not sent from the second driver");
+  }
+
+  /* A class request to an interface without driver is stalled.*/
+  test_set_step(3);
+  {
+    setup[4] = 2U;
+    test_assert(usb_lld_host_control(&USBD1, setup, &lun) == MSG_RESET,
+                "not stalled");
+  }
+
+  /* Bulk-Only Mass Storage Reset is accepted.*/
+  test_set_step(4);
+  {
+    static const uint8_t reset[8] = {0x21, MSD_REQ_RESET, 0, 0, 1, 0, 0, 0};
+
+    test_assert(usb_lld_host_control(&USBD1, reset, NULL) == MSG_OK,
+                "reset failed");
+    test_assert(msd2.state == MSD_READY, "not ready");
+  }
+}
+
+static const testcase_t test_001_002 = {
+  "class requests",
+  test_001_002_setup,
+  test_001_002_teardown,
+  test_001_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_001_003 SCSI commands
+ *
+ * <h2>Description</h2>
+ * SCSI commands are sent to a driver served by a dedicated thread and
+ * backed by a RAM block device.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - INQUIRY returns the identification strings.
+ * - READ CAPACITY(10) returns the block device geometry.
+ * - WRITE(10) of multiple buffers, the data reaches the block device.
+ * - READ(10) of multiple buffers, the data is read back.
+ * - READ(10) out of range fails, the sense data reports the error.
+ * - READ(10) with a short data phase, the residue is reported.
+ * - Commands with a not existing LUN or an invalid command block length
+ *   fail without executing, the data phase is not performed.
+ * .
+ */
+
+static thread_t *tp_server;
+
+static void test_001_003_setup(void) {
+
+  ramblkObjectInit(&ramblk1);
+  msdObjectInit(&msd1);
+  msdObjectInit(&msd2);
+  msdStart(&msd1, &msdcfg1);
+  usbStart(&USBD1, &usbcfg);
+  lun = 0U;
+  tp_server = chThdCreateStatic(wa_server, sizeof(wa_server),
+                                chThdGetPriorityX() + 1, server, &msd1);
+}
+
+static void test_001_003_teardown(void) {
+
+  msdStop(&msd1);
+  chThdWait(tp_server);
+  usbStop(&USBD1);
+}
+
+static void test_001_003_execute(void) {
+  uint8_t cb[10];
+  uint32_t residue, i;
+
+  test_assert(host_configure() == MSG_OK, "not configured");
+
+  /* INQUIRY returns the identification strings.*/
+  test_set_step(1);
+  {
+    static const uint8_t inquiry[6] = {SCSI_CMD_INQUIRY, 0, 0, 0, 36, 0};
+
+    test_assert(host_command(inquiry, sizeof(inquiry), 36U, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert(residue == 0U, "wrong residue");
+    test_assert(memcmp(&rxdata[8], "ChibiOS Test Disk       1.0 ", 28U) == 0,
+                "wrong identification");
+  }
+
+  /* READ CAPACITY(10) returns the block device geometry.*/
+  test_set_step(2);
+  {
+    static const uint8_t capacity[10] = {SCSI_CMD_READ_CAPACITY_10};
+
+    test_assert(host_command(capacity, sizeof(capacity), 8U, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert((get_be32(&rxdata[0]) == RAMBLK_BLOCKS - 1U) &&
+                (get_be32(&rxdata[4]) == RAMBLK_BLOCK_SIZE),
+                "wrong capacity");
+  }
+
+  /* WRITE(10) of multiple buffers, the data reaches the block device.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < sizeof(data); i++) {
+      data[i] = (uint8_t)(i * 7U + (i >> 9));
+    }
+    rw10(cb, SCSI_CMD_WRITE_10, 3U, 8U);
+    test_assert(host_command(cb, sizeof(cb), sizeof(data), false,
+                             data, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert(residue == 0U, "wrong residue");
+    test_assert(memcmp(&ramblk1.data[3U * RAMBLK_BLOCK_SIZE], data,
+                       sizeof(data)) == 0, "data not written");
+  }
+
+  /* READ(10) of multiple buffers, the data is read back.*/
+  test_set_step(4);
+  {
+    memset(rxdata, 0, sizeof(rxdata));
+    rw10(cb, SCSI_CMD_READ_10, 3U, 8U);
+    test_assert(host_command(cb, sizeof(cb), sizeof(rxdata), true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert(residue == 0U, "wrong residue");
+    test_assert(memcmp(rxdata, data, sizeof(data)) == 0, "wrong data");
+  }
+
+  /* READ(10) out of range fails, the sense data reports the error.*/
+  test_set_step(5);
+  {
+    static const uint8_t sense[6] = {SCSI_CMD_REQUEST_SENSE, 0, 0, 0, 18, 0};
+
+    rw10(cb, SCSI_CMD_READ_10, RAMBLK_BLOCKS - 1U, 2U);
+    test_assert(host_command(cb, sizeof(cb), 2U * RAMBLK_BLOCK_SIZE, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_FAILED,
+                "command not failed");
+    test_assert(residue == 2U * RAMBLK_BLOCK_SIZE, "wrong residue");
+    test_assert(host_command(sense, sizeof(sense), 18U, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert((rxdata[2] == SCSI_SENSE_ILLEGAL_REQUEST) &&
+                (rxdata[12] == SCSI_ASC_LBA_OUT_OF_RANGE), "wrong sense");
+  }
+
+  /* READ(10) with a short data phase, the residue is reported.*/
+  test_set_step(6);
+  {
+    rw10(cb, SCSI_CMD_READ_10, 0U, 1U);
+    test_assert(host_command(cb, sizeof(cb), 2U * RAMBLK_BLOCK_SIZE, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert(residue == RAMBLK_BLOCK_SIZE, "wrong residue");
+  }
+
+  /* Commands with a not existing LUN or an invalid command block length
+     fail without executing, the data phase is not performed.*/
+  test_set_step(7);
+  {
+    static const uint8_t sense[6] = {SCSI_CMD_REQUEST_SENSE, 0, 0, 0, 18, 0};
+
+    memset(&ramblk1.data[0], 0xA5, RAMBLK_BLOCK_SIZE);
+    rw10(cb, SCSI_CMD_WRITE_10, 0U, 1U);
+    lun = 1U;
+    test_assert(host_command(cb, sizeof(cb), RAMBLK_BLOCK_SIZE, false,
+                             data, &residue) == MSD_CSW_STATUS_FAILED,
+                "command not failed");
+    lun = 0U;
+    test_assert(residue == RAMBLK_BLOCK_SIZE, "wrong residue");
+    test_assert(ramblk1.data[0] == 0xA5U, "command executed");
+    test_assert(host_command(sense, sizeof(sense), 18U, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert((rxdata[2] == SCSI_SENSE_ILLEGAL_REQUEST) &&
+                (rxdata[12] == SCSI_ASC_LUN_NOT_SUPPORTED), "wrong sense");
+
+    test_assert(host_command(cb, 0U, RAMBLK_BLOCK_SIZE, false,
+                             data, &residue) == MSD_CSW_STATUS_FAILED,
+                "command not failed");
+    test_assert(host_command(cb, 17U, RAMBLK_BLOCK_SIZE, false,
+                             data, &residue) == MSD_CSW_STATUS_FAILED,
+                "command not failed");
+    test_assert(residue == RAMBLK_BLOCK_SIZE, "wrong residue");
+    test_assert(ramblk1.data[0] == 0xA5U, "command executed");
+    test_assert(host_command(sense, sizeof(sense), 18U, true,
+                             rxdata, &residue) == MSD_CSW_STATUS_PASSED,
+                "command failed");
+    test_assert((rxdata[2] == SCSI_SENSE_ILLEGAL_REQUEST) &&
+                (rxdata[12] == SCSI_ASC_INVALID_FIELD_IN_CDB),
+                "wrong sense");
+  }
+}
+
+static const testcase_t test_001_003 = {
+  "SCSI commands",
+  test_001_003_setup,
+  test_001_003_teardown,
+  test_001_003_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   USB Mass Storage driver.
+ */
+const testcase_t * const test_sequence_001[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_001_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_001_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_001_003,
+#endif
+  NULL
+};
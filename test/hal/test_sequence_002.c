@@ -0,0 +1,417 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_002 I2C transactions queue
+ *
+ * File: @ref test_sequence_002.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the I2C transactions queue on the simulated I2C
+ * driver, the queue is served from ISR context. Busy bus conditions, stuck
+ * transfers and bus errors are injected in the driver.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_002_001
+ * - @subpage test_002_002
+ * - @subpage test_002_003
+ * - @subpage test_002_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define SLAVE_ADDR              0x50U
+
+static const I2CConfig i2ccfg = {
+  OSAL_MS2ST(2)
+};
+
+static I2CTransaction tr[4];
+static uint8_t txdata[4][8];
+static uint8_t rxdata[8];
+static I2CTransaction *order[4];
+static unsigned norder;
+
+static void tr_cb(I2CDriver *i2cp, I2CTransaction *trp) {
+
+  (void)i2cp;
+
+  if (norder < 4U) {
+    order[norder++] = trp;
+  }
+}
+
+/*
+ * Prepares a transaction writing @p n bytes at @p offset in the slave
+ * memory.
+ */
+static void tr_write(I2CTransaction *trp, uint8_t *buf, uint8_t offset,
+                     size_t n, uint32_t prio, systime_t timeout) {
+  size_t i;
+
+  buf[0] = offset;
+  for (i = 1U; i <= n; i++) {
+    buf[i] = (uint8_t)(offset + i * 3U);
+  }
+  memset(trp, 0, sizeof(*trp));
+  trp->prio    = prio;
+  trp->addr    = SLAVE_ADDR;
+  trp->txbuf   = buf;
+  trp->txbytes = n + 1U;
+  trp->timeout = timeout;
+  trp->cb      = tr_cb;
+}
+
+/*
+ * Prepares a transaction reading @p n bytes at @p offset from the slave
+ * memory.
+ */
+static void tr_read(I2CTransaction *trp, uint8_t *buf, uint8_t offset,
+                    size_t n, systime_t timeout) {
+
+  buf[0] = offset;
+  memset(trp, 0, sizeof(*trp));
+  trp->addr    = SLAVE_ADDR;
+  trp->txbuf   = buf;
+  trp->txbytes = 1U;
+  trp->rxbuf   = rxdata;
+  trp->rxbytes = n;
+  trp->timeout = timeout;
+}
+
+static void test_002_setup(void) {
+
+  memset(I2CD1.memory, 0, sizeof(I2CD1.memory));
+  I2CD1.busy      = 0U;
+  I2CD1.stuck     = 0U;
+  I2CD1.fault     = I2C_NO_ERROR;
+  I2CD1.attempts  = 0U;
+  I2CD1.transfers = 0U;
+  I2CD1.resets    = 0U;
+  norder = 0U;
+  i2cStart(&I2CD1, &i2ccfg);
+}
+
+static void test_002_teardown(void) {
+
+  i2cStop(&I2CD1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_002_001 Priority ordering
+ *
+ * <h2>Description</h2>
+ * Transactions are submitted while the queue is busy, they are executed
+ * back-to-back in priority order.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Four write transactions are queued, the last one is waited for.
+ * - The transactions completed in priority order, FIFO for the same
+ *   priority.
+ * - The written data is read back.
+ * - The statistics account all the transactions.
+ * .
+ */
+
+static void test_002_001_execute(void) {
+  i2c_queue_stats_t stats;
+  unsigned i;
+
+  i2cQueueGetStats(&I2CD1, &stats);
+
+  /* Four write transactions are queued, the last one is waited for.*/
+  test_set_step(1);
+  {
+    tr_write(&tr[0], txdata[0], 0x00U, 4U, 0U, TIME_INFINITE);
+    tr_write(&tr[1], txdata[1], 0x10U, 4U, 1U, TIME_INFINITE);
+    tr_write(&tr[2], txdata[2], 0x20U, 4U, 5U, TIME_INFINITE);
+    tr_write(&tr[3], txdata[3], 0x30U, 4U, 0U, TIME_INFINITE);
+    for (i = 0U; i < 3U; i++) {
+      test_assert(i2cQueueSubmit(&I2CD1, &tr[i]) == MSG_OK,
+                  "submit failed");
+    }
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[3]) == MSG_OK,
+                "transfer failed");
+  }
+
+  /* The transactions completed in priority order, FIFO for the same
+     priority.*/
+  test_set_step(2);
+  {
+    test_assert(norder == 4U, "missing callbacks");
+    test_assert((order[0] == &tr[0]) && (order[1] == &tr[2]) &&
+                (order[2] == &tr[1]) && (order[3] == &tr[3]),
+                "wrong order");
+    for (i = 0U; i < 4U; i++) {
+      test_assert(tr[i].result == MSG_OK, "transaction failed");
+    }
+    test_assert(I2CD1.transfers == 4U, "wrong number of transfers");
+  }
+
+  /* The written data is read back.*/
+  test_set_step(3);
+  {
+    uint8_t buf[1];
+
+    for (i = 0U; i < 4U; i++) {
+      tr_read(&tr[0], buf, (uint8_t)(i * 0x10U), 4U, TIME_INFINITE);
+      test_assert(i2cQueueTransfer(&I2CD1, &tr[0]) == MSG_OK,
+                  "transfer failed");
+      test_assert(memcmp(rxdata, &txdata[i][1], 4U) == 0, "wrong data");
+    }
+  }
+
+  /* The statistics account all the transactions.*/
+  test_set_step(4);
+  {
+    i2cQueueGetStats(&I2CD1, &stats);
+    test_assert((stats.completed == 8U) && (stats.failed == 0U),
+                "wrong statistics");
+    test_assert(stats.busy > 0U, "busy time not accounted");
+    test_assert(stats.max_wait > (rtcnt_t)0, "wait time not accounted");
+  }
+}
+
+static const testcase_t test_002_001 = {
+  "priority ordering",
+  test_002_setup,
+  test_002_teardown,
+  test_002_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_002_002 Busy bus
+ *
+ * <h2>Description</h2>
+ * Transactions finding the bus busy are retried, the pending transactions
+ * are not dropped.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The bus is busy for the first attempts, the transaction is retried
+ *   and the queued one is executed after it.
+ * - The bus is busy before a queued transaction is chained, it is retried
+ *   too.
+ * .
+ */
+
+static void test_002_002_execute(void) {
+
+  /* The bus is busy for the first attempts, the transaction is retried
+     and the queued one is executed after it.*/
+  test_set_step(1);
+  {
+    I2CD1.busy = 3U;
+    tr_write(&tr[0], txdata[0], 0x00U, 2U, 0U, OSAL_MS2ST(100));
+    tr_write(&tr[1], txdata[1], 0x10U, 2U, 0U, OSAL_MS2ST(100));
+    test_assert(i2cQueueSubmit(&I2CD1, &tr[0]) == MSG_OK, "submit failed");
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[1]) == MSG_OK,
+                "transfer failed");
+    test_assert(tr[0].result == MSG_OK, "transaction failed");
+    test_assert((I2CD1.attempts == 5U) && (I2CD1.transfers == 2U),
+                "wrong number of attempts");
+    test_assert(norder == 2U, "missing callbacks");
+  }
+
+  /* The bus is busy before a queued transaction is chained, it is retried
+     too.*/
+  test_set_step(2);
+  {
+    tr_write(&tr[0], txdata[0], 0x00U, 2U, 0U, OSAL_MS2ST(100));
+    tr_write(&tr[1], txdata[1], 0x10U, 2U, 0U, OSAL_MS2ST(100));
+    test_assert(i2cQueueSubmit(&I2CD1, &tr[0]) == MSG_OK, "submit failed");
+    I2CD1.busy = 2U;
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[1]) == MSG_OK,
+                "transfer failed");
+    test_assert(tr[0].result == MSG_OK, "transaction failed");
+    test_assert((I2CD1.attempts == 9U) && (I2CD1.transfers == 4U),
+                "wrong number of attempts");
+  }
+}
+
+static const testcase_t test_002_002 = {
+  "busy bus",
+  test_002_setup,
+  test_002_teardown,
+  test_002_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_002_003 Timeouts
+ *
+ * <h2>Description</h2>
+ * Transactions not completed within their timeout are terminated, the
+ * driver is recovered for the next transactions.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A stuck transfer times out, the driver is reset and the queued
+ *   transaction is executed.
+ * - A transaction finding the bus always busy times out without being
+ *   started.
+ * - The statistics account the failed transactions.
+ * .
+ */
+
+static void test_002_003_execute(void) {
+  i2c_queue_stats_t stats;
+  systime_t start;
+
+  i2cQueueGetStats(&I2CD1, &stats);
+
+  /* A stuck transfer times out, the driver is reset and the queued
+     transaction is executed.*/
+  test_set_step(1);
+  {
+    I2CD1.stuck = 1U;
+    tr_write(&tr[0], txdata[0], 0x00U, 2U, 0U, OSAL_MS2ST(10));
+    tr_write(&tr[1], txdata[1], 0x10U, 2U, 0U, TIME_INFINITE);
+    start = osalOsGetSystemTimeX();
+    test_assert(i2cQueueSubmit(&I2CD1, &tr[0]) == MSG_OK, "submit failed");
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[1]) == MSG_OK,
+                "transfer failed");
+    test_assert(tr[0].result == MSG_TIMEOUT, "not timed out");
+    test_assert(osalOsGetSystemTimeX() - start >= OSAL_MS2ST(10),
+                "timed out too early");
+    test_assert(I2CD1.resets == 1U, "driver not reset");
+    test_assert(I2CD1.transfers == 2U, "wrong number of transfers");
+  }
+
+  /* A transaction finding the bus always busy times out without being
+     started.*/
+  test_set_step(2);
+  {
+    I2CD1.busy = 0xFFFFFFFFU;
+    tr_write(&tr[0], txdata[0], 0x00U, 2U, 0U, OSAL_MS2ST(10));
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[0]) == MSG_TIMEOUT,
+                "not timed out");
+    test_assert(I2CD1.transfers == 2U, "transfer started");
+    I2CD1.busy = 0U;
+  }
+
+  /* The statistics account the failed transactions.*/
+  test_set_step(3);
+  {
+    i2cQueueGetStats(&I2CD1, &stats);
+    test_assert((stats.completed == 3U) && (stats.failed == 2U),
+                "wrong statistics");
+  }
+}
+
+static const testcase_t test_002_003 = {
+  "timeouts",
+  test_002_setup,
+  test_002_teardown,
+  test_002_003_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_002_004 Bus errors
+ *
+ * <h2>Description</h2>
+ * Bus errors terminate the transaction, the errors are reported in the
+ * transaction object.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A transfer fails, the errors are reported.
+ * - The next transaction is executed normally.
+ * .
+ */
+
+static void test_002_004_execute(void) {
+
+  /* A transfer fails, the errors are reported.*/
+  test_set_step(1);
+  {
+    I2CD1.fault = I2C_ACK_FAILURE;
+    tr_write(&tr[0], txdata[0], 0x00U, 2U, 0U, OSAL_MS2ST(100));
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[0]) == MSG_RESET,
+                "not failed");
+    test_assert(tr[0].errors == I2C_ACK_FAILURE, "wrong errors");
+    test_assert(I2CD1.resets == 0U, "driver reset");
+  }
+
+  /* The next transaction is executed normally.*/
+  test_set_step(2);
+  {
+    I2CD1.fault = I2C_NO_ERROR;
+    tr_write(&tr[0], txdata[0], 0x00U, 2U, 0U, OSAL_MS2ST(100));
+    test_assert(i2cQueueTransfer(&I2CD1, &tr[0]) == MSG_OK,
+                "transfer failed");
+    test_assert(tr[0].errors == I2C_NO_ERROR, "wrong errors");
+  }
+}
+
+static const testcase_t test_002_004 = {
+  "bus errors",
+  test_002_setup,
+  test_002_teardown,
+  test_002_004_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   I2C transactions queue.
+ */
+const testcase_t * const test_sequence_002[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_002_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_002_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_002_003,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_002_004,
+#endif
+  NULL
+};
@@ -0,0 +1,310 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+#include "blkcache.h"
+
+/**
+ * @page test_sequence_003 Block cache
+ *
+ * File: @ref test_sequence_003.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the block cache in front of the RAM block device.
+ * The benchmark scores are computed on the simulated device busy time so
+ * they do not depend on the host speed.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_003_001
+ * - @subpage test_003_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define CACHE_LINES             16U
+#define CACHE_WRITE_BLOCKS      8U
+
+static BlockCache bcache;
+static blkcache_line_t lines[CACHE_LINES];
+static uint8_t wbuf[CACHE_WRITE_BLOCKS * RAMBLK_BLOCK_SIZE];
+static uint8_t buf[RAMBLK_BLOCK_SIZE];
+
+static void fill(uint8_t *p, uint32_t blk, uint8_t seed) {
+  unsigned i;
+
+  for (i = 0U; i < RAMBLK_BLOCK_SIZE; i++) {
+    p[i] = (uint8_t)(blk + (i * 3U) + seed);
+  }
+}
+
+static bool check(const uint8_t *p, uint32_t blk, uint8_t seed) {
+  unsigned i;
+
+  for (i = 0U; i < RAMBLK_BLOCK_SIZE; i++) {
+    if (p[i] != (uint8_t)(blk + (i * 3U) + seed)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_003_setup(void) {
+
+  ramblkObjectInit(&ramblk1);
+  bcacheObjectInit(&bcache, (BaseBlockDevice *)&ramblk1,
+                   lines, CACHE_LINES, wbuf, CACHE_WRITE_BLOCKS);
+  (void) blkConnect(&bcache);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_003_001 Write failures
+ *
+ * <h2>Description</h2>
+ * Device write failures do not leave the cache lines out of sync with the
+ * device content.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A cached block is overwritten by a failed direct write, the next read
+ *   returns the device content.
+ * - A cached block is written in the write-behind buffer, the flush fails
+ *   and the block is still read from the buffer.
+ * - The flush is retried, the device holds the written data.
+ * - A cached block is written in the write-behind buffer, after the flush
+ *   the block is served by the updated cache line.
+ * .
+ */
+
+static void test_003_001_execute(void) {
+  blkcache_stats_t *sp = bcacheGetStatistics(&bcache);
+  uint8_t data[CACHE_WRITE_BLOCKS * RAMBLK_BLOCK_SIZE];
+  uint32_t i, hits;
+
+  /* A cached block is overwritten by a failed direct write, the next read
+     returns the device content.*/
+  test_set_step(1);
+  {
+    fill(&ramblk1.data[5U * RAMBLK_BLOCK_SIZE], 5U, 0U);
+    test_assert(blkRead(&bcache, 5U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    for (i = 0U; i < CACHE_WRITE_BLOCKS; i++) {
+      fill(&data[i * RAMBLK_BLOCK_SIZE], 4U + i, 1U);
+    }
+    ramblk1.fail = true;
+    test_assert(blkWrite(&bcache, 4U, data, CACHE_WRITE_BLOCKS) ==
+                HAL_FAILED, "write not failed");
+    ramblk1.fail = false;
+    test_assert(blkRead(&bcache, 5U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(buf, 5U, 0U), "not the device content");
+  }
+
+  /* A cached block is written in the write-behind buffer, the flush fails
+     and the block is still read from the buffer.*/
+  test_set_step(2);
+  {
+    test_assert(blkRead(&bcache, 10U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    fill(data, 10U, 2U);
+    test_assert(blkWrite(&bcache, 10U, data, 1U) == HAL_SUCCESS,
+                "write failed");
+    ramblk1.fail = true;
+    test_assert(blkSync(&bcache) == HAL_FAILED, "sync not failed");
+    ramblk1.fail = false;
+    test_assert(blkRead(&bcache, 10U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(buf, 10U, 2U), "written data lost");
+  }
+
+  /* The flush is retried, the device holds the written data.*/
+  test_set_step(3);
+  {
+    test_assert(blkSync(&bcache) == HAL_SUCCESS, "sync failed");
+    test_assert(check(&ramblk1.data[10U * RAMBLK_BLOCK_SIZE], 10U, 2U),
+                "not written");
+    test_assert(blkRead(&bcache, 10U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(buf, 10U, 2U), "wrong data");
+  }
+
+  /* A cached block is written in the write-behind buffer, after the flush
+     the block is served by the updated cache line.*/
+  test_set_step(4);
+  {
+    test_assert(blkRead(&bcache, 20U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    fill(data, 20U, 3U);
+    test_assert(blkWrite(&bcache, 20U, data, 1U) == HAL_SUCCESS,
+                "write failed");
+    test_assert(blkSync(&bcache) == HAL_SUCCESS, "sync failed");
+    hits = sp->hits;
+    test_assert(blkRead(&bcache, 20U, buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(buf, 20U, 3U), "wrong data");
+    test_assert(sp->hits == hits + 1U, "not served by the cache");
+  }
+}
+
+static const testcase_t test_003_001 = {
+  "write failures",
+  test_003_setup,
+  NULL,
+  test_003_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_003_002 Benchmark
+ *
+ * <h2>Description</h2>
+ * Single block operations, as performed by FatFS, are executed on the
+ * device directly and through the cache. The IOPS and MB/s scores are
+ * computed on the simulated device busy time.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Sequential single block writes, the cache coalesces them.
+ * - Random single block reads on a working set fitting the cache.
+ * .
+ */
+
+#define BMK_WRITES              (4U * RAMBLK_BLOCKS)
+#define BMK_READS               1024U
+#define BMK_WORKING_SET         CACHE_LINES
+
+static uint32_t bmk_writes(BaseBlockDevice *bdp) {
+  uint32_t i, time;
+
+  time = ramblk1.time;
+  for (i = 0U; i < BMK_WRITES; i++) {
+    fill(buf, i % RAMBLK_BLOCKS, (uint8_t)(i / RAMBLK_BLOCKS));
+    if (blkWrite(bdp, i % RAMBLK_BLOCKS, buf, 1U)) {
+      return 0U;
+    }
+  }
+  if (blkSync(bdp)) {
+    return 0U;
+  }
+  return ramblk1.time - time;
+}
+
+static uint32_t bmk_reads(BaseBlockDevice *bdp) {
+  uint32_t i, blk, time;
+
+  time = ramblk1.time;
+  blk = 0U;
+  for (i = 0U; i < BMK_READS; i++) {
+    blk = ((blk * 13U) + 7U) % BMK_WORKING_SET;
+    if (blkRead(bdp, blk, buf, 1U)) {
+      return 0U;
+    }
+  }
+  return ramblk1.time - time;
+}
+
+static uint32_t print_score(const char *name, uint32_t ops, uint32_t time) {
+  uint32_t iops, mbs10;
+
+  iops  = (uint32_t)(((uint64_t)ops * 1000000U) / time);
+  mbs10 = (uint32_t)(((uint64_t)ops * RAMBLK_BLOCK_SIZE * 10U) / time);
+  test_print("--- ");
+  test_print(name);
+  test_printn(iops);
+  test_print(" IOPS, ");
+  test_printn(mbs10 / 10U);
+  test_print(".");
+  test_printn(mbs10 % 10U);
+  test_println(" MB/S");
+
+  return iops;
+}
+
+static void test_003_002_execute(void) {
+  uint32_t direct, cached;
+
+  /* Sequential single block writes, the cache coalesces them.*/
+  test_set_step(1);
+  {
+    uint32_t i;
+
+    direct = bmk_writes((BaseBlockDevice *)&ramblk1);
+    test_assert(direct > 0U, "write failed");
+    cached = bmk_writes((BaseBlockDevice *)&bcache);
+    test_assert(cached > 0U, "write failed");
+    for (i = 0U; i < RAMBLK_BLOCKS; i++) {
+      test_assert(check(&ramblk1.data[i * RAMBLK_BLOCK_SIZE], i,
+                        (uint8_t)((BMK_WRITES - 1U) / RAMBLK_BLOCKS)),
+                  "wrong device content");
+    }
+    direct = print_score("Seq. writes, direct : ", BMK_WRITES, direct);
+    cached = print_score("Seq. writes, cached : ", BMK_WRITES, cached);
+    test_assert(cached >= direct * 4U, "writes not coalesced");
+  }
+
+  /* Random single block reads on a working set fitting the cache.*/
+  test_set_step(2);
+  {
+    direct = bmk_reads((BaseBlockDevice *)&ramblk1);
+    test_assert(direct > 0U, "read failed");
+    cached = bmk_reads((BaseBlockDevice *)&bcache);
+    test_assert(cached > 0U, "read failed");
+    direct = print_score("Rnd. reads, direct  : ", BMK_READS, direct);
+    cached = print_score("Rnd. reads, cached  : ", BMK_READS, cached);
+    test_assert(cached >= direct * 4U, "reads not cached");
+  }
+}
+
+static const testcase_t test_003_002 = {
+  "benchmark",
+  test_003_setup,
+  NULL,
+  test_003_002_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Block cache.
+ */
+const testcase_t * const test_sequence_003[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_003_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_003_002,
+#endif
+  NULL
+};
@@ -0,0 +1,291 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+#include "blkqueue.h"
+
+/**
+ * @page test_sequence_004 Block requests queue
+ *
+ * File: @ref test_sequence_004.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the block requests queue in front of the RAM block
+ * device. The queue is served by a thread with lower priority than the
+ * test thread so the requests submitted before waiting are queued
+ * together. The benchmark scores are computed on the simulated device
+ * busy time so they do not depend on the host speed.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_004_001
+ * - @subpage test_004_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define MERGE_BLOCKS            8U
+#define QD_MAX                  4U
+
+static BlockQueue bq;
+static uint8_t mbuf[MERGE_BLOCKS * RAMBLK_BLOCK_SIZE];
+static blk_request_t rq[QD_MAX];
+static uint8_t rqbuf[QD_MAX][RAMBLK_BLOCK_SIZE];
+static volatile bool stop;
+static thread_t *tp_server;
+static THD_WORKING_AREA(wa_server, 256);
+
+static THD_FUNCTION(server, arg) {
+
+  (void)arg;
+
+  while (!stop) {
+    (void) bqServe(&bq, OSAL_MS2ST(10));
+  }
+}
+
+static void fill(uint8_t *p, uint32_t blk) {
+  unsigned i;
+
+  for (i = 0U; i < RAMBLK_BLOCK_SIZE; i++) {
+    p[i] = (uint8_t)(blk * 5U + i);
+  }
+}
+
+static bool check(const uint8_t *p, uint32_t blk) {
+  unsigned i;
+
+  for (i = 0U; i < RAMBLK_BLOCK_SIZE; i++) {
+    if (p[i] != (uint8_t)(blk * 5U + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_004_setup(void) {
+  uint32_t i;
+
+  ramblkObjectInit(&ramblk1);
+  for (i = 0U; i < RAMBLK_BLOCKS; i++) {
+    fill(&ramblk1.data[i * RAMBLK_BLOCK_SIZE], i);
+  }
+  bqObjectInit(&bq, (BaseBlockDevice *)&ramblk1, mbuf, MERGE_BLOCKS);
+  stop = false;
+  tp_server = chThdCreateStatic(wa_server, sizeof(wa_server),
+                                chThdGetPriorityX() - 1, server, NULL);
+}
+
+static void test_004_teardown(void) {
+
+  stop = true;
+  chThdWait(tp_server);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_004_001 Completion callbacks
+ *
+ * <h2>Description</h2>
+ * The callback of a request is invoked before the request is done, a
+ * request resubmitted by its callback is waited until its last operation.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A read is waited, the callback sees the result before the request is
+ *   done.
+ * - A read resubmitted three times by its callback is waited, the waiting
+ *   thread is awakened at the end of the last read.
+ * .
+ */
+
+static unsigned ncalls;
+static bool cb_done;
+static bool cb_result;
+
+static void cb_check(blk_request_t *rqp) {
+
+  ncalls++;
+  cb_done   = bqIsRequestDone(rqp);
+  cb_result = rqp->result;
+}
+
+static void cb_chain(blk_request_t *rqp) {
+
+  ncalls++;
+  if ((rqp->result == HAL_SUCCESS) && check(rqp->buf, rqp->startblk) &&
+      (ncalls < 4U)) {
+    bqStartRead(&bq, rqp, rqp->startblk + 1U, rqp->buf, 1U, cb_chain);
+  }
+}
+
+static void test_004_001_execute(void) {
+
+  /* A read is waited, the callback sees the result before the request is
+     done.*/
+  test_set_step(1);
+  {
+    ncalls  = 0U;
+    cb_done = true;
+    bqStartRead(&bq, &rq[0], 5U, rqbuf[0], 1U, cb_check);
+    test_assert(bqWaitRequest(&rq[0]) == HAL_SUCCESS, "read failed");
+    test_assert(ncalls == 1U, "callback not invoked");
+    test_assert(!cb_done, "done before the callback");
+    test_assert(cb_result == HAL_SUCCESS, "result not available");
+    test_assert(bqIsRequestDone(&rq[0]), "not done");
+    test_assert(check(rqbuf[0], 5U), "wrong data");
+  }
+
+  /* A read resubmitted three times by its callback is waited, the waiting
+     thread is awakened at the end of the last read.*/
+  test_set_step(2);
+  {
+    ncalls = 0U;
+    bqStartRead(&bq, &rq[0], 10U, rqbuf[0], 1U, cb_chain);
+    test_assert(bqWaitRequest(&rq[0]) == HAL_SUCCESS, "read failed");
+    test_assert(ncalls == 4U, "awakened before the last read");
+    test_assert((rq[0].startblk == 13U) && check(rqbuf[0], 13U),
+                "wrong data");
+    test_assert(ramblk1.reads == 5U, "wrong number of reads");
+  }
+}
+
+static const testcase_t test_004_001 = {
+  "completion callbacks",
+  test_004_setup,
+  test_004_teardown,
+  test_004_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_004_002 Benchmark
+ *
+ * <h2>Description</h2>
+ * Sequential single block reads are executed keeping one and four
+ * requests in flight. With queue depth four the adjacent requests are
+ * merged into multi-block operations. The IOPS and MB/s scores are
+ * computed on the simulated device busy time.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Reads with queue depth one.
+ * - Reads with queue depth four, the score is at least twice the queue
+ *   depth one score.
+ * .
+ */
+
+#define BMK_READS               (4U * RAMBLK_BLOCKS)
+
+static uint32_t bmk_reads(unsigned qd) {
+  uint32_t i, k, time;
+
+  time = ramblk1.time;
+  for (i = 0U; i < BMK_READS + qd; i++) {
+    k = i % qd;
+    if (i >= qd) {
+      if ((bqWaitRequest(&rq[k]) != HAL_SUCCESS) ||
+          !check(rqbuf[k], (i - qd) % RAMBLK_BLOCKS)) {
+        return 0U;
+      }
+    }
+    if (i < BMK_READS) {
+      bqStartRead(&bq, &rq[k], i % RAMBLK_BLOCKS, rqbuf[k], 1U, NULL);
+    }
+  }
+  return ramblk1.time - time;
+}
+
+static uint32_t print_score(const char *name, uint32_t ops, uint32_t time) {
+  uint32_t iops, mbs10;
+
+  iops  = (uint32_t)(((uint64_t)ops * 1000000U) / time);
+  mbs10 = (uint32_t)(((uint64_t)ops * RAMBLK_BLOCK_SIZE * 10U) / time);
+  test_print("--- ");
+  test_print(name);
+  test_printn(iops);
+  test_print(" IOPS, ");
+  test_printn(mbs10 / 10U);
+  test_print(".");
+  test_printn(mbs10 % 10U);
+  test_println(" MB/S");
+
+  return iops;
+}
+
+static void test_004_002_execute(void) {
+  uint32_t qd1, qd4;
+
+  /* Reads with queue depth one.*/
+  test_set_step(1);
+  {
+    qd1 = bmk_reads(1U);
+    test_assert(qd1 > 0U, "read failed");
+    test_assert(bq.stats.merged == 0U, "merged");
+    qd1 = print_score("Seq. reads, QD1 : ", BMK_READS, qd1);
+  }
+
+  /* Reads with queue depth four, the score is at least twice the queue
+     depth one score.*/
+  test_set_step(2);
+  {
+    qd4 = bmk_reads(QD_MAX);
+    test_assert(qd4 > 0U, "read failed");
+    test_assert(bq.stats.merged > 0U, "not merged");
+    qd4 = print_score("Seq. reads, QD4 : ", BMK_READS, qd4);
+    test_assert(qd4 >= qd1 * 2U, "no queue depth benefit");
+  }
+}
+
+static const testcase_t test_004_002 = {
+  "benchmark",
+  test_004_setup,
+  test_004_teardown,
+  test_004_002_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Block requests queue.
+ */
+const testcase_t * const test_sequence_004[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_004_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_004_002,
+#endif
+  NULL
+};
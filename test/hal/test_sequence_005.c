@@ -0,0 +1,445 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+#include "ramflash.h"
+#include "kvstore.h"
+
+/**
+ * @page test_sequence_005 Key/value store
+ *
+ * File: @ref test_sequence_005.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the key/value store on a RAM emulated flash. The
+ * store content is checked against a model of the expected values. The
+ * power losses are emulated by the flash, the interrupted operations are
+ * left incomplete and the interrupted erases leave the sectors partially
+ * erased.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_005_001
+ * - @subpage test_005_002
+ * - @subpage test_005_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define FLASH_PAGE_SIZE         8U
+#define FLASH_SECTOR_SIZE       512U
+#define FLASH_SECTORS           8U
+
+#define KEYS                    16U
+#define VALUE_MAX               16U
+#define NO_VALUE                0U
+
+static const flash_descriptor_t flash_descriptor = {
+  0U,
+  FLASH_PAGE_SIZE,
+  FLASH_SECTORS,
+  FLASH_SECTOR_SIZE,
+  NULL
+};
+
+static RAMFlash rflash;
+static uint8_t flash_buffer[FLASH_SECTORS * FLASH_SECTOR_SIZE];
+static KVStore kvs;
+static uint32_t kvs_index[FLASH_SECTORS * FLASH_SECTOR_SIZE / 16U];
+
+static const KVSConfig kvscfg = {
+  (BaseFlash *)&rflash,
+  0U,
+  3U,
+  kvs_index,
+  KEYS
+};
+
+static uint32_t versions[KEYS];
+static uint32_t nextver;
+static uint32_t rnd;
+static uint8_t buf[VALUE_MAX + 1U];
+
+static uint32_t next_rnd(void) {
+
+  rnd = (rnd * 1103515245U) + 12345U;
+  return rnd >> 16;
+}
+
+static size_t value_size(unsigned key, uint32_t ver) {
+
+  return 1U + ((key + ver) % VALUE_MAX);
+}
+
+static void fill(uint8_t *p, unsigned key, uint32_t ver) {
+  size_t i;
+
+  for (i = 0U; i < value_size(key, ver); i++) {
+    p[i] = (uint8_t)((key * 17U) + (ver * 5U) + i);
+  }
+}
+
+static bool check_key(unsigned key) {
+  uint8_t value[VALUE_MAX];
+  size_t n;
+
+  n = kvsGet(&kvs, (kvs_key_t)key, buf, sizeof buf);
+  if (versions[key] == NO_VALUE) {
+    return (n == 0U) && !kvsHasKey(&kvs, key);
+  }
+  fill(value, key, versions[key]);
+  return (n == value_size(key, versions[key])) &&
+         (memcmp(buf, value, n) == 0);
+}
+
+static bool check_all(void) {
+  unsigned key;
+
+  for (key = 0U; key < KEYS; key++) {
+    if (!check_key(key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* A random put or delete, the key and the new version are returned.*/
+static bool random_op(unsigned *keyp, uint32_t *verp) {
+  unsigned key = next_rnd() % KEYS;
+
+  *keyp = key;
+  if ((next_rnd() % 4U) == 0U) {
+    *verp = NO_VALUE;
+    return kvsDelete(&kvs, (kvs_key_t)key);
+  }
+  *verp = nextver++;
+  fill(buf, key, *verp);
+  return kvsPut(&kvs, (kvs_key_t)key, buf, value_size(key, *verp));
+}
+
+static bool remount(const KVSConfig *config) {
+
+  kvsUnmount(&kvs);
+  return kvsMount(&kvs, config);
+}
+
+static void test_005_setup(void) {
+
+  rflashObjectInit(&rflash, &flash_descriptor, flash_buffer);
+  rflashErase(&rflash);
+  kvsObjectInit(&kvs);
+  memset(versions, 0, sizeof versions);
+  nextver = 1U;
+  rnd     = 1U;
+}
+
+static void test_005_teardown(void) {
+
+  kvsUnmount(&kvs);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_005_001 Randomized operations
+ *
+ * <h2>Description</h2>
+ * Random puts and deletes are executed, the store is periodically
+ * remounted. The values always match the model.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The store is formatted.
+ * - Random operations are executed, the modified key is checked after
+ *   each operation and all the keys after each remount.
+ * .
+ */
+
+#define RND_OPS                 2000U
+
+static void test_005_001_execute(void) {
+
+  /* The store is formatted.*/
+  test_set_step(1);
+  {
+    test_assert(kvsFormat(&kvs, &kvscfg) == HAL_SUCCESS, "format failed");
+    test_assert(check_all(), "not empty");
+  }
+
+  /* Random operations are executed, the modified key is checked after
+     each operation and all the keys after each remount.*/
+  test_set_step(2);
+  {
+    unsigned i, key;
+    uint32_t ver;
+
+    for (i = 1U; i <= RND_OPS; i++) {
+      test_assert(random_op(&key, &ver) == HAL_SUCCESS, "operation failed");
+      versions[key] = ver;
+      test_assert(check_key(key), "wrong value");
+      if ((i % 100U) == 0U) {
+        test_assert(remount(&kvscfg) == HAL_SUCCESS, "mount failed");
+        test_assert(check_all(), "wrong value after mount");
+      }
+    }
+    test_assert(rflashGetStatistics(&rflash)->erased > kvscfg.sectors,
+                "not collected");
+  }
+}
+
+static const testcase_t test_005_001 = {
+  "randomized operations",
+  test_005_setup,
+  test_005_teardown,
+  test_005_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_005_002 Power loss
+ *
+ * <h2>Description</h2>
+ * A sequence of random operations is repeated with a power loss injected
+ * at each possible page program and sector erase, garbage collections
+ * included. After each power loss the store is mounted again, the key
+ * being updated has either the previous or the new value and all the
+ * other keys are unchanged.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The sequence is repeated with increasing power loss points until it
+ *   completes, the store is checked after each power loss and then used
+ *   again.
+ * .
+ */
+
+#define PL_OPS                  500U
+#define PL_MORE_OPS             50U
+
+static void test_005_002_execute(void) {
+
+  /* The sequence is repeated with increasing power loss points until it
+     completes, the store is checked after each power loss and then used
+     again.*/
+  test_set_step(1);
+  {
+    unsigned i, key;
+    uint32_t cut, ver, old;
+
+    for (cut = 0U; ; cut++) {
+      rflashSetPowerLoss(&rflash, RFLASH_NO_POWER_LOSS);
+      kvsUnmount(&kvs);
+      test_assert(kvsFormat(&kvs, &kvscfg) == HAL_SUCCESS, "format failed");
+      memset(versions, 0, sizeof versions);
+      nextver = 1U;
+      rnd     = 1U;
+
+      rflashSetPowerLoss(&rflash, cut);
+      for (i = 0U; i < PL_OPS; i++) {
+        if (random_op(&key, &ver) != HAL_SUCCESS) {
+          break;
+        }
+        versions[key] = ver;
+      }
+      if (i == PL_OPS) {
+        test_print("--- Power loss points : ");
+        test_printn(cut);
+        test_println("");
+        break;
+      }
+      test_assert(rflash.lost, "failed without power loss");
+
+      rflashSetPowerLoss(&rflash, RFLASH_NO_POWER_LOSS);
+      test_assert(remount(&kvscfg) == HAL_SUCCESS, "mount failed");
+      old = versions[key];
+      versions[key] = ver;
+      if (!check_key(key)) {
+        versions[key] = old;
+      }
+      test_assert(check_all(), "data lost");
+
+      for (i = 0U; i < PL_MORE_OPS; i++) {
+        test_assert(random_op(&key, &ver) == HAL_SUCCESS,
+                    "operation failed after power loss");
+        versions[key] = ver;
+      }
+      test_assert(remount(&kvscfg) == HAL_SUCCESS, "mount failed");
+      test_assert(check_all(), "wrong value after power loss");
+    }
+    test_assert(kvsGetStatistics(&kvs)->collected > 0U, "not collected");
+  }
+}
+
+static const testcase_t test_005_002 = {
+  "power loss",
+  test_005_setup,
+  test_005_teardown,
+  test_005_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_005_003 Benchmark
+ *
+ * <h2>Description</h2>
+ * The write amplification of random updates is measured as the ratio
+ * between the bytes programmed on the flash and the value bytes written
+ * by the application. The mount cost is measured as the bytes read from
+ * the flash for increasing numbers of records in the store, the free
+ * sectors are fully read for checking that they are erased.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Random updates, the write amplification is below four.
+ * - Mount with increasing numbers of records, each flash location is read
+ *   about once.
+ * .
+ */
+
+#define BMK_WRITES              2000U
+#define BMK_VALUE_SIZE          8U
+
+static const KVSConfig kvscfg_bmk = {
+  (BaseFlash *)&rflash,
+  0U,
+  FLASH_SECTORS,
+  kvs_index,
+  FLASH_SECTORS * FLASH_SECTOR_SIZE / 16U
+};
+
+static void print_ratio(const char *name, uint32_t ratio100) {
+
+  test_print("--- ");
+  test_print(name);
+  test_printn(ratio100 / 100U);
+  test_print(".");
+  test_printn((ratio100 / 10U) % 10U);
+  test_printn(ratio100 % 10U);
+  test_println("");
+}
+
+static uint32_t bmk_mount(unsigned records) {
+  unsigned key;
+
+  kvsUnmount(&kvs);
+  if (kvsFormat(&kvs, &kvscfg_bmk)) {
+    return 0U;
+  }
+  memset(buf, 0x55, BMK_VALUE_SIZE);
+  for (key = 0U; key < records; key++) {
+    if (kvsPut(&kvs, (kvs_key_t)key, buf, BMK_VALUE_SIZE)) {
+      return 0U;
+    }
+  }
+  rflashGetStatistics(&rflash)->read = 0U;
+  if (remount(&kvscfg_bmk)) {
+    return 0U;
+  }
+  return rflashGetStatistics(&rflash)->read;
+}
+
+static void test_005_003_execute(void) {
+
+  /* Random updates, the write amplification is below four.*/
+  test_set_step(1);
+  {
+    kvs_stats_t *sp = kvsGetStatistics(&kvs);
+    unsigned i, key;
+    uint32_t ver, wa;
+
+    test_assert(kvsFormat(&kvs, &kvscfg) == HAL_SUCCESS, "format failed");
+    for (i = 0U; i < BMK_WRITES; i++) {
+      key = next_rnd() % KEYS;
+      ver = nextver++;
+      fill(buf, key, ver);
+      test_assert(kvsPut(&kvs, (kvs_key_t)key, buf,
+                         value_size(key, ver)) == HAL_SUCCESS,
+                  "put failed");
+    }
+    wa = (uint32_t)(((uint64_t)rflashGetStatistics(&rflash)->programmed *
+                     100U) / sp->written);
+    print_ratio("Write amplification   : ", wa);
+    print_ratio("Erases per 100 writes : ", (sp->erased * 10000U) /
+                                            BMK_WRITES);
+    test_assert(wa < 400U, "write amplification too high");
+  }
+
+  /* Mount with increasing numbers of records, each flash location is read
+     about once.*/
+  test_set_step(2);
+  {
+    static const unsigned records[] = {0U, 50U, 100U, 200U};
+    uint32_t read;
+    unsigned i;
+
+    for (i = 0U; i < sizeof records / sizeof records[0]; i++) {
+      read = bmk_mount(records[i]);
+      test_assert(read > 0U, "mount failed");
+      test_print("--- Mount, ");
+      test_printn(records[i]);
+      test_print(" records : ");
+      test_printn(read);
+      test_println(" bytes read");
+      test_assert(read <= FLASH_SECTORS * (FLASH_SECTOR_SIZE + 32U),
+                  "flash read more than once");
+    }
+  }
+}
+
+static const testcase_t test_005_003 = {
+  "benchmark",
+  test_005_setup,
+  test_005_teardown,
+  test_005_003_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Key/value store.
+ */
+const testcase_t * const test_sequence_005[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_005_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_005_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_005_003,
+#endif
+  NULL
+};
@@ -0,0 +1,432 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+#include "ramflash.h"
+#include "flfs.h"
+
+/**
+ * @page test_sequence_006 Flash log file system
+ *
+ * File: @ref test_sequence_006.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the flash log file system on a RAM emulated flash.
+ * The power losses are emulated by the flash, the interrupted operations
+ * are left incomplete and the interrupted erases leave the sectors
+ * partially erased. The benchmark scores are computed on a simulated page
+ * programming time so they do not depend on the host speed.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_006_001
+ * - @subpage test_006_002
+ * - @subpage test_006_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define FLASH_PAGE_SIZE         8U
+#define FLASH_SECTOR_SIZE       1024U
+#define FLASH_SECTORS           8U
+
+/* Simulated page programming time in microseconds.*/
+#define FLASH_PAGE_TIME         20U
+
+static const flash_descriptor_t flash_descriptor = {
+  0U,
+  FLASH_PAGE_SIZE,
+  FLASH_SECTORS,
+  FLASH_SECTOR_SIZE,
+  NULL
+};
+
+static RAMFlash rflash;
+static uint8_t flash_buffer[FLASH_SECTORS * FLASH_SECTOR_SIZE];
+static FLFS fs;
+static FLFSFile file;
+static uint8_t buf[128];
+
+static const FLFSConfig fscfg = {
+  (BaseFlash *)&rflash,
+  0U,
+  FLASH_SECTORS
+};
+
+static uint8_t pattern(uint32_t offset, uint32_t ver) {
+
+  return (uint8_t)((offset * 7U) + (offset >> 8) + (ver * 13U));
+}
+
+/* Appends data following the pattern of the specified version.*/
+static bool write_file(const char *name, unsigned mode,
+                       uint32_t size, uint32_t ver) {
+  uint32_t offset, i;
+  size_t n;
+  bool result = HAL_SUCCESS;
+
+  if (flfsOpen(&fs, &file, name, mode)) {
+    return HAL_FAILED;
+  }
+  offset = (uint32_t)fileStreamGetSize(&file);
+  while (size > 0U) {
+    n = size < sizeof buf ? size : sizeof buf;
+    for (i = 0U; i < n; i++) {
+      buf[i] = pattern(offset + i, ver);
+    }
+    if (fileStreamWrite(&file, buf, n) != n) {
+      result = HAL_FAILED;
+      break;
+    }
+    offset += n;
+    size   -= n;
+  }
+  if (fileStreamClose(&file) != FILE_OK) {
+    result = HAL_FAILED;
+  }
+  return result;
+}
+
+static bool file_exists(const char *name) {
+
+  if (flfsOpen(&fs, &file, name, FLFS_READ)) {
+    return false;
+  }
+  (void) fileStreamClose(&file);
+  return true;
+}
+
+/* Checks that a file follows the pattern of the specified version, the
+   file size is returned.*/
+static bool check_file(const char *name, uint32_t ver, uint32_t *sizep) {
+  uint32_t offset, size, i;
+  size_t n;
+
+  if (flfsOpen(&fs, &file, name, FLFS_READ)) {
+    return false;
+  }
+  size = (uint32_t)fileStreamGetSize(&file);
+  for (offset = 0U; offset < size; offset += n) {
+    n = size - offset < sizeof buf ? size - offset : sizeof buf;
+    if (fileStreamRead(&file, buf, n) != n) {
+      (void) fileStreamClose(&file);
+      return false;
+    }
+    for (i = 0U; i < n; i++) {
+      if (buf[i] != pattern(offset + i, ver)) {
+        (void) fileStreamClose(&file);
+        return false;
+      }
+    }
+  }
+  *sizep = size;
+  return fileStreamClose(&file) == FILE_OK;
+}
+
+static bool remount(void) {
+
+  flfsUnmount(&fs);
+  return flfsMount(&fs, &fscfg);
+}
+
+static void test_006_setup(void) {
+
+  rflashObjectInit(&rflash, &flash_descriptor, flash_buffer);
+  rflashErase(&rflash);
+  flfsObjectInit(&fs);
+}
+
+static void test_006_teardown(void) {
+
+  flfsUnmount(&fs);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_006_001 Partially erased sectors
+ *
+ * <h2>Description</h2>
+ * A data sector left by an interrupted erase with the header erased and
+ * data in the rest of the sector is erased before being allocated.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The file system is formatted and the second half of the first data
+ *   sector is programmed as if its erase had been interrupted.
+ * - A file spanning several sectors is written and read back.
+ * .
+ */
+
+static void test_006_001_execute(void) {
+
+  /* The file system is formatted and the second half of the first data
+     sector is programmed as if its erase had been interrupted.*/
+  test_set_step(1);
+  {
+    test_assert(flfsFormat(&fs, &fscfg) == HAL_SUCCESS, "format failed");
+    memset(&flash_buffer[(2U * FLASH_SECTOR_SIZE) + (FLASH_SECTOR_SIZE / 2U)],
+           0x00, FLASH_SECTOR_SIZE / 2U);
+  }
+
+  /* A file spanning several sectors is written and read back.*/
+  test_set_step(2);
+  {
+    uint32_t size;
+
+    test_assert(write_file("a", FLFS_WRITE, 3000U, 1U) == HAL_SUCCESS,
+                "write failed");
+    test_assert(remount() == HAL_SUCCESS, "mount failed");
+    test_assert(check_file("a", 1U, &size), "wrong data");
+    test_assert(size == 3000U, "wrong size");
+  }
+}
+
+static const testcase_t test_006_001 = {
+  "partially erased sectors",
+  test_006_setup,
+  test_006_teardown,
+  test_006_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_006_002 Power loss
+ *
+ * <h2>Description</h2>
+ * A sequence of appends and file replacements is repeated with a power
+ * loss injected at each possible page program and sector erase. After
+ * each power loss the file system is mounted again, the data committed
+ * before the interrupted operation is retained, the files are never
+ * corrupted and can be written again.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The sequence is repeated with increasing power loss points until it
+ *   completes, the files are checked after each power loss and then
+ *   written again.
+ * .
+ */
+
+#define PL_STEPS                16U
+#define PL_RECORD               100U
+#define PL_REPLACED             300U
+
+static void test_006_002_execute(void) {
+
+  /* The sequence is repeated with increasing power loss points until it
+     completes, the files are checked after each power loss and then
+     written again.*/
+  test_set_step(1);
+  {
+    uint32_t cut, asize, bver, size;
+    unsigned i;
+
+    for (cut = 0U; ; cut++) {
+      rflashSetPowerLoss(&rflash, RFLASH_NO_POWER_LOSS);
+      flfsUnmount(&fs);
+      test_assert(flfsFormat(&fs, &fscfg) == HAL_SUCCESS, "format failed");
+      asize = 0U;
+      bver  = 0U;
+
+      /* File "a" is appended in records, file "b" is replaced every four
+         steps.*/
+      rflashSetPowerLoss(&rflash, cut);
+      for (i = 0U; i < PL_STEPS; i++) {
+        if ((i % 4U) == 3U) {
+          if (write_file("b", FLFS_WRITE, PL_REPLACED, i)) {
+            break;
+          }
+          bver = i;
+        }
+        else {
+          if (write_file("a", FLFS_APPEND, PL_RECORD, 0U)) {
+            break;
+          }
+          asize += PL_RECORD;
+        }
+      }
+      if (i == PL_STEPS) {
+        test_print("--- Power loss points : ");
+        test_printn(cut);
+        test_println("");
+        break;
+      }
+      test_assert(rflash.lost, "failed without power loss");
+
+      rflashSetPowerLoss(&rflash, RFLASH_NO_POWER_LOSS);
+      test_assert(remount() == HAL_SUCCESS, "mount failed");
+      size = 0U;
+      test_assert(((asize == 0U) && !file_exists("a")) ||
+                  check_file("a", 0U, &size), "file a corrupted");
+      test_assert((size >= asize) && (size <= asize + PL_RECORD),
+                  "file a wrong size");
+      asize = size;
+
+      /* A replaced file has the old content or a part of the new.*/
+      test_assert(((bver == 0U) && !file_exists("b")) ||
+                  (((i % 4U) == 3U) && check_file("b", i, &size)) ||
+                  (check_file("b", bver, &size) && (size == PL_REPLACED)),
+                  "file b corrupted");
+
+      test_assert(write_file("a", FLFS_APPEND, PL_RECORD, 0U) ==
+                  HAL_SUCCESS, "write failed after power loss");
+      test_assert(write_file("b", FLFS_WRITE, PL_REPLACED, PL_STEPS) ==
+                  HAL_SUCCESS, "write failed after power loss");
+      test_assert(remount() == HAL_SUCCESS, "mount failed");
+      test_assert(check_file("a", 0U, &size) &&
+                  (size == asize + PL_RECORD), "file a corrupted");
+      test_assert(check_file("b", PL_STEPS, &size) &&
+                  (size == PL_REPLACED), "file b corrupted");
+    }
+  }
+}
+
+static const testcase_t test_006_002 = {
+  "power loss",
+  test_006_setup,
+  test_006_teardown,
+  test_006_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_006_003 Benchmark
+ *
+ * <h2>Description</h2>
+ * Data is appended to a file in small records committed one by one and
+ * in buffered writes committed in full frames. The KB/s scores are
+ * computed on the simulated programming time of the pages written on the
+ * flash, frame overhead and sector headers included.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Appends of records committed one by one.
+ * - Buffered appends, the score is at least one and half times the
+ *   score of the smaller committed records.
+ * .
+ */
+
+#define BMK_BYTES               2048U
+
+static uint32_t bmk_append(size_t record, bool sync) {
+  uint32_t n;
+
+  flfsUnmount(&fs);
+  if (flfsFormat(&fs, &fscfg) ||
+      flfsOpen(&fs, &file, "log", FLFS_APPEND)) {
+    return 0U;
+  }
+  rflashGetStatistics(&rflash)->programmed = 0U;
+  memset(buf, 0x55, sizeof buf);
+  for (n = 0U; n < BMK_BYTES; n += record) {
+    if ((fileStreamWrite(&file, buf, record) != record) ||
+        (sync && flfsSync(&file))) {
+      (void) fileStreamClose(&file);
+      return 0U;
+    }
+  }
+  if (fileStreamClose(&file) != FILE_OK) {
+    return 0U;
+  }
+  return (rflashGetStatistics(&rflash)->programmed / FLASH_PAGE_SIZE) *
+         FLASH_PAGE_TIME;
+}
+
+static uint32_t print_score(const char *name, uint32_t time) {
+  uint32_t kbs10;
+
+  kbs10 = (uint32_t)(((uint64_t)BMK_BYTES * 1000000U * 10U) /
+                     ((uint64_t)time * 1024U));
+  test_print("--- ");
+  test_print(name);
+  test_printn(kbs10 / 10U);
+  test_print(".");
+  test_printn(kbs10 % 10U);
+  test_println(" KB/S");
+
+  return kbs10;
+}
+
+static void test_006_003_execute(void) {
+  uint32_t small, time;
+
+  /* Appends of records committed one by one.*/
+  test_set_step(1);
+  {
+    time = bmk_append(16U, true);
+    test_assert(time > 0U, "append failed");
+    small = print_score("Append, 16 B records  : ", time);
+    time = bmk_append(128U, true);
+    test_assert(time > 0U, "append failed");
+    (void) print_score("Append, 128 B records : ", time);
+  }
+
+  /* Buffered appends, the score is at least one and half times the score
+     of the smaller committed records.*/
+  test_set_step(2);
+  {
+    time = bmk_append(16U, false);
+    test_assert(time > 0U, "append failed");
+    time = print_score("Append, buffered      : ", time);
+    test_assert(time * 2U >= small * 3U, "frames overhead too high");
+  }
+}
+
+static const testcase_t test_006_003 = {
+  "benchmark",
+  test_006_setup,
+  test_006_teardown,
+  test_006_003_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Flash log file system.
+ */
+const testcase_t * const test_sequence_006[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_006_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_006_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_006_003,
+#endif
+  NULL
+};
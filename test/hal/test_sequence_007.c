@@ -0,0 +1,374 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_007 Serial over USB driver
+ *
+ * File: @ref test_sequence_007.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the Serial over USB driver on the simulated USB
+ * driver, the test thread acts as a CDC host writing packets of maximum
+ * size without terminating zero sized packets. The benchmark score is
+ * computed on a simulated full speed bus timing so it does not depend on
+ * the host speed.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_007_001
+ * - @subpage test_007_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define EP_DATA                 1U
+#define EP_PACKET_SIZE          64U
+
+/* Simulated bus timings in microseconds, the time of a packet of maximum
+   size and the overhead of a transaction completion, the endpoint NAKs
+   until the next transaction is started by the callback.*/
+#define BUS_PACKET_TIME         50U
+#define BUS_TRANSACTION_TIME    100U
+
+static SerialUSBDriver sdu1;
+static uint8_t txbuf[SERIAL_USB_BUFFERS_SIZE * 2U];
+static uint8_t rxbuf[SERIAL_USB_BUFFERS_SIZE * 2U];
+static uint32_t out_transactions, in_transactions;
+static THD_WORKING_AREA(wa_echo, 256);
+
+static const SerialUSBConfig serusbcfg = {
+  &USBD1,
+  EP_DATA,
+  EP_DATA,
+  0U
+};
+
+static void data_transmitted(USBDriver *usbp, usbep_t ep) {
+
+  in_transactions++;
+  sduDataTransmitted(usbp, ep);
+}
+
+static void data_received(USBDriver *usbp, usbep_t ep) {
+
+  out_transactions++;
+  sduDataReceived(usbp, ep);
+}
+
+static USBInEndpointState ep1instate;
+static USBOutEndpointState ep1outstate;
+
+static const USBEndpointConfig ep1config = {
+  USB_EP_MODE_TYPE_BULK, NULL, data_transmitted, data_received,
+  EP_PACKET_SIZE, EP_PACKET_SIZE, &ep1instate, &ep1outstate
+};
+
+static const USBDescriptor *get_descriptor(USBDriver *usbp, uint8_t dtype,
+                                           uint8_t dindex, uint16_t lang) {
+
+  (void)usbp;
+  (void)dtype;
+  (void)dindex;
+  (void)lang;
+
+  return NULL;
+}
+
+static void usb_event(USBDriver *usbp, usbevent_t event) {
+
+  osalSysLockFromISR();
+  switch (event) {
+  case USB_EVENT_RESET:
+    sduDisconnectI(&sdu1);
+    break;
+  case USB_EVENT_CONFIGURED:
+    usbInitEndpointI(usbp, EP_DATA, &ep1config);
+    sduConfigureHookI(&sdu1);
+    break;
+  default:
+    break;
+  }
+  osalSysUnlockFromISR();
+}
+
+static const USBConfig usbcfg = {
+  usb_event,
+  get_descriptor,
+  sduRequestsHook,
+  NULL
+};
+
+/*
+ * Bus reset followed by SET_CONFIGURATION(1).
+ */
+static msg_t host_configure(void) {
+  static const uint8_t set_configuration[8] = {
+    0x00, USB_REQ_SET_CONFIGURATION, 1, 0, 0, 0, 0, 0
+  };
+
+  usb_lld_host_reset(&USBD1);
+  return usb_lld_host_control(&USBD1, set_configuration, NULL);
+}
+
+/*
+ * Reads data from the IN endpoint until the requested size has been
+ * received, zero sized packets are skipped.
+ */
+static msg_t host_read(uint8_t *buf, size_t n, uint32_t *packetsp) {
+
+  while (n > 0U) {
+    size_t k = n;
+    msg_t msg;
+
+    msg = usb_lld_host_in(&USBD1, EP_DATA, buf, &k);
+    if (msg != MSG_OK) {
+      return msg;
+    }
+    *packetsp += k > 0U ? (uint32_t)((k + EP_PACKET_SIZE - 1U) /
+                                     EP_PACKET_SIZE) : 1U;
+    buf += k;
+    n   -= k;
+  }
+
+  return MSG_OK;
+}
+
+static void fill(uint8_t *buf, size_t n, uint32_t seed) {
+  size_t i;
+
+  for (i = 0U; i < n; i++) {
+    buf[i] = (uint8_t)((i * 11U) + (i >> 8) + (seed * 3U));
+  }
+}
+
+static void sdu_setup(void) {
+
+  sduObjectInit(&sdu1);
+  sduStart(&sdu1, &serusbcfg);
+  usbStart(&USBD1, &usbcfg);
+  out_transactions = 0U;
+  in_transactions  = 0U;
+}
+
+static void sdu_teardown(void) {
+
+  sduStop(&sdu1);
+  usbStop(&USBD1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_007_001 Transfers without zero sized packets
+ *
+ * <h2>Description</h2>
+ * The host writes data ending on packet boundaries without sending zero
+ * sized packets, the data must reach the application.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The device is configured.
+ * - A buffer made of packets of maximum size is delivered.
+ * - Two buffers made of packets of maximum size are delivered.
+ * - A short transfer is delivered.
+ * .
+ */
+
+static void test_007_001_execute(void) {
+  size_t n;
+
+  /* The device is configured.*/
+  test_set_step(1);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+    test_assert(usbGetReceiveStatusI(&USBD1, EP_DATA), "not receiving");
+  }
+
+  /* A buffer made of packets of maximum size is delivered.*/
+  test_set_step(2);
+  {
+    fill(txbuf, SERIAL_USB_BUFFERS_SIZE, 1U);
+    test_assert(usb_lld_host_write(&USBD1, EP_DATA, txbuf,
+                                   SERIAL_USB_BUFFERS_SIZE) == MSG_OK,
+                "write failed");
+    n = chnReadTimeout(&sdu1, rxbuf, SERIAL_USB_BUFFERS_SIZE, MS2ST(10));
+    test_assert(n == SERIAL_USB_BUFFERS_SIZE, "data not delivered");
+    test_assert(memcmp(rxbuf, txbuf, n) == 0, "wrong data");
+  }
+
+  /* Two buffers made of packets of maximum size are delivered.*/
+  test_set_step(3);
+  {
+    fill(txbuf, sizeof txbuf, 2U);
+    test_assert(usb_lld_host_write(&USBD1, EP_DATA, txbuf,
+                                   sizeof txbuf) == MSG_OK,
+                "write failed");
+    n = chnReadTimeout(&sdu1, rxbuf, sizeof rxbuf, MS2ST(10));
+    test_assert(n == sizeof rxbuf, "data not delivered");
+    test_assert(memcmp(rxbuf, txbuf, n) == 0, "wrong data");
+  }
+
+  /* A short transfer is delivered.*/
+  test_set_step(4);
+  {
+    fill(txbuf, 100U, 3U);
+    test_assert(usb_lld_host_write(&USBD1, EP_DATA, txbuf,
+                                   100U) == MSG_OK, "write failed");
+    n = chnReadTimeout(&sdu1, rxbuf, 100U, MS2ST(10));
+    test_assert(n == 100U, "data not delivered");
+    test_assert(memcmp(rxbuf, txbuf, n) == 0, "wrong data");
+  }
+}
+
+static const testcase_t test_007_001 = {
+  "transfers without zero sized packets",
+  sdu_setup,
+  sdu_teardown,
+  test_007_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_007_002 Loopback throughput benchmark
+ *
+ * <h2>Description</h2>
+ * A thread echoes the received data back to the host, the throughput is
+ * computed on the simulated bus time of the packets and transactions.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The device is configured and the echo thread is started.
+ * - Data is written and read back one buffer at time, the data is
+ *   echoed unchanged.
+ * .
+ */
+
+#define BMK_BYTES               16384U
+
+static THD_FUNCTION(echo, arg) {
+  static uint8_t buf[SERIAL_USB_BUFFERS_SIZE];
+  size_t n;
+
+  (void)arg;
+
+  while (true) {
+    n = chnReadTimeout(&sdu1, buf, sizeof buf, TIME_INFINITE);
+    if (n == 0U) {
+      break;
+    }
+    (void)chnWriteTimeout(&sdu1, buf, n, TIME_INFINITE);
+  }
+}
+
+static thread_t *tp_echo;
+
+static void test_007_002_setup(void) {
+
+  sdu_setup();
+  tp_echo = NULL;
+}
+
+static void test_007_002_teardown(void) {
+
+  sdu_teardown();
+  if (tp_echo != NULL) {
+    chThdWait(tp_echo);
+  }
+}
+
+static void test_007_002_execute(void) {
+  uint32_t done, packets, time, kbs10;
+
+  /* The device is configured and the echo thread is started.*/
+  test_set_step(1);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+    tp_echo = chThdCreateStatic(wa_echo, sizeof(wa_echo),
+                                chThdGetPriorityX() + 1, echo, NULL);
+  }
+
+  /* Data is written and read back one buffer at time, the data is echoed
+     unchanged.*/
+  test_set_step(2);
+  {
+    packets = 0U;
+    for (done = 0U; done < BMK_BYTES; done += SERIAL_USB_BUFFERS_SIZE) {
+      fill(txbuf, SERIAL_USB_BUFFERS_SIZE, done);
+      test_assert(usb_lld_host_write(&USBD1, EP_DATA, txbuf,
+                                     SERIAL_USB_BUFFERS_SIZE) == MSG_OK,
+                  "write failed");
+      packets += SERIAL_USB_BUFFERS_SIZE / EP_PACKET_SIZE;
+      test_assert(host_read(rxbuf, SERIAL_USB_BUFFERS_SIZE,
+                            &packets) == MSG_OK, "read failed");
+      test_assert(memcmp(rxbuf, txbuf, SERIAL_USB_BUFFERS_SIZE) == 0,
+                  "wrong data");
+    }
+
+    time = (packets * BUS_PACKET_TIME) +
+           ((out_transactions + in_transactions) * BUS_TRANSACTION_TIME);
+    kbs10 = (uint32_t)(((uint64_t)BMK_BYTES * 2U * 1000000U * 10U) /
+                       ((uint64_t)time * 1024U));
+    test_print("--- Transactions : ");
+    test_printn(out_transactions + in_transactions);
+    test_println("");
+    test_print("--- Loopback     : ");
+    test_printn(kbs10 / 10U);
+    test_print(".");
+    test_printn(kbs10 % 10U);
+    test_println(" KB/S");
+  }
+}
+
+static const testcase_t test_007_002 = {
+  "loopback throughput benchmark",
+  test_007_002_setup,
+  test_007_002_teardown,
+  test_007_002_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Serial over USB driver.
+ */
+const testcase_t * const test_sequence_007[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_007_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_007_002,
+#endif
+  NULL
+};
@@ -0,0 +1,568 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_008 STM32 OTG driver in DMA mode
+ *
+ * File: @ref test_sequence_008.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the STM32 OTGv1 USB driver with the internal DMA
+ * enabled, the driver runs on the register level model of the OTG_HS core
+ * and the test thread acts as the USB host. The model moves the data from
+ * and to the addresses programmed in the DMA registers and updates the
+ * transfer size registers packet by packet like the real core.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_008_001
+ * - @subpage test_008_002
+ * - @subpage test_008_003
+ * - @subpage test_008_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define EP_DATA                 1U
+#define EP_PACKET_SIZE          64U
+#define VENDOR_REQ_WRITE        0x01U
+#define DESCRIPTOR_SIZE         128U
+#define BUFFER_SIZE             256U
+
+/* The DMA buffers must be aligned to a word boundary.*/
+static uint32_t txbuf32[BUFFER_SIZE / 4U];
+static uint32_t rxbuf32[(BUFFER_SIZE + EP_PACKET_SIZE) / 4U];
+#define txbuf                   ((uint8_t *)txbuf32)
+#define rxbuf                   ((uint8_t *)rxbuf32)
+
+static uint8_t hostbuf[BUFFER_SIZE];
+static uint8_t ctrlbuf[DESCRIPTOR_SIZE];
+static uint8_t descriptor_data[DESCRIPTOR_SIZE];
+static const USBDescriptor descriptor = {
+  DESCRIPTOR_SIZE,
+  descriptor_data
+};
+
+static unsigned in_completions, out_completions;
+
+static void data_transmitted(USBDriver *usbp, usbep_t ep) {
+
+  (void)usbp;
+  (void)ep;
+
+  in_completions++;
+}
+
+static void data_received(USBDriver *usbp, usbep_t ep) {
+
+  (void)usbp;
+  (void)ep;
+
+  out_completions++;
+}
+
+static USBInEndpointState ep1instate;
+static USBOutEndpointState ep1outstate;
+
+static const USBEndpointConfig ep1config = {
+  USB_EP_MODE_TYPE_BULK, NULL, data_transmitted, data_received,
+  EP_PACKET_SIZE, EP_PACKET_SIZE, &ep1instate, &ep1outstate, 1, NULL
+};
+
+static const USBDescriptor *get_descriptor(USBDriver *usbp, uint8_t dtype,
+                                           uint8_t dindex, uint16_t lang) {
+
+  (void)usbp;
+  (void)dindex;
+  (void)lang;
+
+  if (dtype == USB_DESCRIPTOR_CONFIGURATION) {
+    return &descriptor;
+  }
+
+  return NULL;
+}
+
+static bool requests_hook(USBDriver *usbp) {
+  size_t n = (size_t)usbp->setup[6] | ((size_t)usbp->setup[7] << 8);
+
+  if ((usbp->setup[0] == (USB_RTYPE_DIR_HOST2DEV | USB_RTYPE_TYPE_VENDOR)) &&
+      (usbp->setup[1] == VENDOR_REQ_WRITE) && (n <= sizeof ctrlbuf)) {
+    usbSetupTransfer(usbp, ctrlbuf, n, NULL);
+    return true;
+  }
+
+  return false;
+}
+
+static void usb_event(USBDriver *usbp, usbevent_t event) {
+
+  if (event == USB_EVENT_CONFIGURED) {
+    osalSysLockFromISR();
+    usbInitEndpointI(usbp, EP_DATA, &ep1config);
+    osalSysUnlockFromISR();
+  }
+}
+
+static const USBConfig usbcfg = {
+  usb_event,
+  get_descriptor,
+  requests_hook,
+  NULL
+};
+
+static void fill(uint8_t *buf, size_t n, uint32_t seed) {
+  size_t i;
+
+  for (i = 0U; i < n; i++) {
+    buf[i] = (uint8_t)((i * 7U) + (seed * 13U) + 1U);
+  }
+}
+
+/*
+ * Bus reset followed by SET_CONFIGURATION(1).
+ */
+static msg_t host_configure(void) {
+  static const uint8_t set_configuration[8] = {
+    0x00, USB_REQ_SET_CONFIGURATION, 1, 0, 0, 0, 0, 0
+  };
+
+  otg_model_host_reset();
+  return otg_model_host_control(set_configuration, NULL);
+}
+
+/*
+ * Starts a receive operation on the data endpoint.
+ */
+static void start_receive(size_t n) {
+
+  memset(rxbuf, 0x55, sizeof rxbuf32);
+  osalSysLock();
+  usbStartReceiveI(&USBD2, EP_DATA, rxbuf, n);
+  osalSysUnlock();
+}
+
+static void otg_setup(void) {
+
+  otg_model_init();
+  fill(descriptor_data, sizeof descriptor_data, 0U);
+  in_completions  = 0U;
+  out_completions = 0U;
+  usbStart(&USBD2, &usbcfg);
+}
+
+static void otg_teardown(void) {
+
+  usbStop(&USBD2);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_008_001 Setup packets read back from memory
+ *
+ * <h2>Description</h2>
+ * The core writes the setup packets at the address in DOEPDMA and
+ * advances it, the driver must take the last packet written, also when
+ * more packets are received back-to-back before the interrupt is served.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - After a bus reset the endpoint zero is ready for three setup packets.
+ * - A SET_CONFIGURATION request is served.
+ * - Two setup packets are received back-to-back, the last one is served.
+ * - The endpoint zero is ready again for setup packets.
+ * .
+ */
+
+static void test_008_001_execute(void) {
+
+  /* After a bus reset the endpoint zero is ready for three setup
+     packets.*/
+  test_set_step(1);
+  {
+    otg_model_host_reset();
+    test_assert((otg_model.oe[0].DOEPCTL & DOEPCTL_EPENA) != 0U,
+                "not enabled");
+    test_assert((otg_model.oe[0].DOEPTSIZ & DOEPTSIZ_STUPCNT_MASK) ==
+                DOEPTSIZ_STUPCNT(3), "wrong setup count");
+    test_assert((otg_model.oe[0].DOEPDMA & 3U) == 0U, "unaligned buffer");
+  }
+
+  /* A SET_CONFIGURATION request is served.*/
+  test_set_step(2);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+    test_assert(usbGetDriverStateI(&USBD2) == USB_ACTIVE, "not active");
+    test_assert((otg_model.oe[EP_DATA].DOEPCTL & DOEPCTL_USBAEP) != 0U,
+                "endpoint not activated");
+  }
+
+  /* Two setup packets are received back-to-back, the last one is
+     served.*/
+  test_set_step(3);
+  {
+    static const uint8_t setups[16] = {
+      0x80, USB_REQ_GET_DESCRIPTOR, 0, USB_DESCRIPTOR_CONFIGURATION, 0, 0,
+      8, 0,
+      0x80, USB_REQ_GET_DESCRIPTOR, 0, USB_DESCRIPTOR_CONFIGURATION, 0, 0,
+      18, 0
+    };
+    size_t n = sizeof hostbuf;
+
+    test_assert(otg_model_host_setup(setups, 2U) == MSG_OK,
+                "setup not accepted");
+    test_assert(otg_model_counters.setup_packets == 3U, "wrong count");
+    test_assert(otg_model_host_in(0U, hostbuf, &n) == MSG_OK,
+                "data stage failed");
+    test_assert(n == 18U, "wrong request served");
+    test_assert(memcmp(hostbuf, descriptor_data, n) == 0, "wrong data");
+    test_assert(otg_model_host_out(0U, NULL, 0U) == MSG_OK,
+                "status stage failed");
+  }
+
+  /* The endpoint zero is ready again for setup packets.*/
+  test_set_step(4);
+  {
+    test_assert((otg_model.oe[0].DOEPCTL & DOEPCTL_EPENA) != 0U,
+                "not enabled");
+    test_assert((otg_model.oe[0].DOEPTSIZ & DOEPTSIZ_STUPCNT_MASK) ==
+                DOEPTSIZ_STUPCNT(3), "wrong setup count");
+  }
+}
+
+static const testcase_t test_008_001 = {
+  "setup packets read back from memory",
+  otg_setup,
+  otg_teardown,
+  test_008_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_008_002 Control transfers through the bounce buffer
+ *
+ * <h2>Description</h2>
+ * The data stages of the endpoint zero are copied through the driver
+ * DMA buffer, transfers larger than a packet are split in multiple
+ * transactions.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The device is configured.
+ * - A descriptor larger than a packet is read.
+ * - A descriptor is read with a larger request length, a zero sized
+ *   packet terminates the transfer.
+ * - A data stage larger than a packet is written.
+ * .
+ */
+
+static void test_008_002_execute(void) {
+  uint8_t setup[8];
+  uint32_t packets;
+
+  /* The device is configured.*/
+  test_set_step(1);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+  }
+
+  /* A descriptor larger than a packet is read.*/
+  test_set_step(2);
+  {
+    static const uint8_t get_descriptor[8] = {
+      0x80, USB_REQ_GET_DESCRIPTOR, 0, USB_DESCRIPTOR_CONFIGURATION, 0, 0,
+      100, 0
+    };
+
+    memset(hostbuf, 0, sizeof hostbuf);
+    packets = otg_model_counters.in_packets;
+    test_assert(otg_model_host_control(get_descriptor, hostbuf) == MSG_OK,
+                "request failed");
+    test_assert(memcmp(hostbuf, descriptor_data, 100U) == 0, "wrong data");
+    test_assert(otg_model_counters.in_packets - packets == 2U,
+                "wrong packets count");
+  }
+
+  /* A descriptor is read with a larger request length, a zero sized
+     packet terminates the transfer.*/
+  test_set_step(3);
+  {
+    static const uint8_t get_descriptor[8] = {
+      0x80, USB_REQ_GET_DESCRIPTOR, 0, USB_DESCRIPTOR_CONFIGURATION, 0, 0,
+      255, 0
+    };
+
+    memset(hostbuf, 0, sizeof hostbuf);
+    packets = otg_model_counters.in_packets;
+    test_assert(otg_model_host_control(get_descriptor, hostbuf) == MSG_OK,
+                "request failed");
+    test_assert(memcmp(hostbuf, descriptor_data, DESCRIPTOR_SIZE) == 0,
+                "wrong data");
+    test_assert(otg_model_counters.in_packets - packets == 2U + 1U,
+                "wrong packets count");
+  }
+
+  /* A data stage larger than a packet is written.*/
+  test_set_step(4);
+  {
+    setup[0] = USB_RTYPE_DIR_HOST2DEV | USB_RTYPE_TYPE_VENDOR;
+    setup[1] = VENDOR_REQ_WRITE;
+    setup[2] = 0U;
+    setup[3] = 0U;
+    setup[4] = 0U;
+    setup[5] = 0U;
+    setup[6] = 100U;
+    setup[7] = 0U;
+    fill(hostbuf, 100U, 1U);
+    memset(ctrlbuf, 0, sizeof ctrlbuf);
+    packets = otg_model_counters.out_packets;
+    test_assert(otg_model_host_control(setup, hostbuf) == MSG_OK,
+                "request failed");
+    test_assert(memcmp(ctrlbuf, hostbuf, 100U) == 0, "wrong data");
+    test_assert(ctrlbuf[100] == 0U, "buffer overflow");
+    test_assert(otg_model_counters.out_packets - packets == 2U,
+                "wrong packets count");
+  }
+}
+
+static const testcase_t test_008_002 = {
+  "control transfers through the bounce buffer",
+  otg_setup,
+  otg_teardown,
+  test_008_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_008_003 Bulk transfers of multiple packets
+ *
+ * <h2>Description</h2>
+ * Transfers larger than a packet are programmed as a single DMA
+ * transaction, the completion callbacks are invoked once at the end.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The device is configured.
+ * - An IN transfer of four packets, the last one short, is received.
+ * - An OUT transfer of four packets is sent.
+ * .
+ */
+
+static void test_008_003_execute(void) {
+  uint32_t packets;
+  size_t n;
+
+  /* The device is configured.*/
+  test_set_step(1);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+  }
+
+  /* An IN transfer of four packets, the last one short, is received.*/
+  test_set_step(2);
+  {
+    fill(txbuf, 200U, 2U);
+    osalSysLock();
+    usbStartTransmitI(&USBD2, EP_DATA, txbuf, 200U);
+    osalSysUnlock();
+    test_assert((otg_model.ie[EP_DATA].DIEPTSIZ & DIEPTSIZ_PKTCNT_MASK) ==
+                DIEPTSIZ_PKTCNT(4), "wrong packet count");
+    test_assert(otg_model.ie[EP_DATA].DIEPDMA == (uint32_t)txbuf,
+                "wrong DMA address");
+
+    packets = otg_model_counters.in_packets;
+    n = sizeof hostbuf;
+    test_assert(otg_model_host_in(EP_DATA, hostbuf, &n) == MSG_OK,
+                "transfer failed");
+    test_assert(n == 200U, "wrong size");
+    test_assert(memcmp(hostbuf, txbuf, n) == 0, "wrong data");
+    test_assert(otg_model_counters.in_packets - packets == 4U,
+                "wrong packets count");
+    test_assert(in_completions == 1U, "wrong completions count");
+    test_assert(!usbGetTransmitStatusI(&USBD2, EP_DATA), "still transmitting");
+  }
+
+  /* An OUT transfer of four packets is sent.*/
+  test_set_step(3);
+  {
+    start_receive(BUFFER_SIZE);
+    test_assert(otg_model.oe[EP_DATA].DOEPDMA == (uint32_t)rxbuf,
+                "wrong DMA address");
+
+    fill(hostbuf, BUFFER_SIZE, 3U);
+    packets = otg_model_counters.out_packets;
+    test_assert(otg_model_host_out(EP_DATA, hostbuf,
+                                   BUFFER_SIZE) == MSG_OK,
+                "transfer failed");
+    test_assert(otg_model_counters.out_packets - packets == 4U,
+                "wrong packets count");
+    test_assert(out_completions == 1U, "wrong completions count");
+    test_assert(usbGetReceiveTransactionSizeX(&USBD2, EP_DATA) ==
+                BUFFER_SIZE, "wrong size");
+    test_assert(memcmp(rxbuf, hostbuf, BUFFER_SIZE) == 0, "wrong data");
+  }
+}
+
+static const testcase_t test_008_003 = {
+  "bulk transfers of multiple packets",
+  otg_setup,
+  otg_teardown,
+  test_008_003_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_008_004 OUT transfers size accounting
+ *
+ * <h2>Description</h2>
+ * The received size is computed from the remaining transfer size left
+ * in DOEPTSIZ, the programmed size is rounded to whole packets.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The device is configured.
+ * - A transfer not multiple of the packet size is received whole.
+ * - A transfer terminated early by a short packet is received.
+ * - A zero sized packet completes a transfer.
+ * - A transfer of packets of maximum size completes on the last packet.
+ * .
+ */
+
+static void test_008_004_execute(void) {
+
+  /* The device is configured.*/
+  test_set_step(1);
+  {
+    test_assert(host_configure() == MSG_OK, "not configured");
+  }
+
+  /* A transfer not multiple of the packet size is received whole.*/
+  test_set_step(2);
+  {
+    start_receive(100U);
+    test_assert((otg_model.oe[EP_DATA].DOEPTSIZ & DOEPTSIZ_XFRSIZ_MASK) ==
+                128U, "size not rounded");
+    fill(hostbuf, 100U, 4U);
+    test_assert(otg_model_host_out(EP_DATA, hostbuf, 100U) == MSG_OK,
+                "transfer failed");
+    test_assert(out_completions == 1U, "not completed");
+    test_assert(usbGetReceiveTransactionSizeX(&USBD2, EP_DATA) == 100U,
+                "wrong size");
+    test_assert(memcmp(rxbuf, hostbuf, 100U) == 0, "wrong data");
+    test_assert(rxbuf[100] == 0x55U, "buffer overflow");
+  }
+
+  /* A transfer terminated early by a short packet is received.*/
+  test_set_step(3);
+  {
+    start_receive(BUFFER_SIZE);
+    fill(hostbuf, 74U, 5U);
+    test_assert(otg_model_host_out(EP_DATA, hostbuf, 74U) == MSG_OK,
+                "transfer failed");
+    test_assert(out_completions == 2U, "not completed");
+    test_assert(usbGetReceiveTransactionSizeX(&USBD2, EP_DATA) == 74U,
+                "wrong size");
+    test_assert(memcmp(rxbuf, hostbuf, 74U) == 0, "wrong data");
+    test_assert(rxbuf[74] == 0x55U, "buffer overflow");
+  }
+
+  /* A zero sized packet completes a transfer.*/
+  test_set_step(4);
+  {
+    start_receive(EP_PACKET_SIZE);
+    test_assert(otg_model_host_out(EP_DATA, NULL, 0U) == MSG_OK,
+                "transfer failed");
+    test_assert(out_completions == 3U, "not completed");
+    test_assert(usbGetReceiveTransactionSizeX(&USBD2, EP_DATA) == 0U,
+                "wrong size");
+  }
+
+  /* A transfer of packets of maximum size completes on the last
+     packet.*/
+  test_set_step(5);
+  {
+    start_receive(2U * EP_PACKET_SIZE);
+    fill(hostbuf, EP_PACKET_SIZE, 6U);
+    test_assert(otg_model_host_out(EP_DATA, hostbuf,
+                                   EP_PACKET_SIZE) == MSG_OK,
+                "transfer failed");
+    test_assert(out_completions == 3U, "completed early");
+    test_assert(usbGetReceiveStatusI(&USBD2, EP_DATA), "not receiving");
+    fill(hostbuf + EP_PACKET_SIZE, EP_PACKET_SIZE, 7U);
+    test_assert(otg_model_host_out(EP_DATA, hostbuf + EP_PACKET_SIZE,
+                                   EP_PACKET_SIZE) == MSG_OK,
+                "transfer failed");
+    test_assert(out_completions == 4U, "not completed");
+    test_assert(usbGetReceiveTransactionSizeX(&USBD2, EP_DATA) ==
+                2U * EP_PACKET_SIZE, "wrong size");
+    test_assert(memcmp(rxbuf, hostbuf, 2U * EP_PACKET_SIZE) == 0,
+                "wrong data");
+  }
+}
+
+static const testcase_t test_008_004 = {
+  "OUT transfers size accounting",
+  otg_setup,
+  otg_teardown,
+  test_008_004_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   STM32 OTG driver in DMA mode.
+ */
+const testcase_t * const test_sequence_008[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_008_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_008_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_008_003,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_008_004,
+#endif
+  NULL
+};
@@ -0,0 +1,377 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_009 SPI transfer lists
+ *
+ * File: @ref test_sequence_009.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the SPI transfer lists on the simulated SPI driver,
+ * the driver logs the transfers on a simulated bus timeline so the gaps
+ * between the segments can be measured without depending on the host
+ * speed.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_009_001
+ * - @subpage test_009_002
+ * - @subpage test_009_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+/* Simulated bus clock of 8MHz.*/
+#define WORD_TIME               1000U
+
+static const SPIConfig spicfg = {
+  NULL,
+  WORD_TIME
+};
+
+static uint8_t txbuf[128];
+static uint8_t rxbuf[128];
+static binary_semaphore_t end_sem;
+static uint32_t end_calls;
+
+static void end_cb(SPIDriver *spip) {
+
+  (void)spip;
+
+  end_calls++;
+  chSysLockFromISR();
+  chBSemSignalI(&end_sem);
+  chSysUnlockFromISR();
+}
+
+static const SPIConfig spicfg_cb = {
+  end_cb,
+  WORD_TIME
+};
+
+static void fill(uint8_t *buf, size_t n, uint32_t seed) {
+  size_t i;
+
+  for (i = 0U; i < n; i++) {
+    buf[i] = (uint8_t)((i * 7U) + (seed * 5U));
+  }
+}
+
+/*
+ * Average gap between the logged transfers from @p first to @p last.
+ */
+static uint32_t log_gap(unsigned first, unsigned last) {
+  uint32_t gaps = 0U;
+  unsigned i;
+
+  for (i = first + 1U; i <= last; i++) {
+    gaps += SPID1.log[i].start - SPID1.log[i - 1U].end;
+  }
+
+  return gaps / (last - first);
+}
+
+static void test_009_setup(void) {
+
+  memset(rxbuf, 0, sizeof rxbuf);
+  chBSemObjectInit(&end_sem, true);
+  end_calls = 0U;
+}
+
+static void test_009_teardown(void) {
+
+  spiStop(&SPID1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_009_001 Segments executed back-to-back
+ *
+ * <h2>Description</h2>
+ * A command header, a payload and a response are transferred in a single
+ * list with the slave selected for the whole list, each segment is
+ * started from the completion interrupt of the previous one.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The list is executed synchronously.
+ * - The segments were executed in order with the slave selected once.
+ * - The segments after the first one were started from the completion
+ *   interrupt, the gaps are the interrupt latency only.
+ * - The response has been received.
+ * .
+ */
+
+static void test_009_001_execute(void) {
+  const SPISegment list[3] = {
+    {txbuf,        NULL,   4U,  SPI_SEGMENT_SELECT},
+    {&txbuf[4],    NULL,   32U, 0U},
+    {NULL,         rxbuf,  16U, SPI_SEGMENT_UNSELECT}
+  };
+  unsigned i;
+
+  /* The list is executed synchronously.*/
+  test_set_step(1);
+  {
+    fill(txbuf, 36U, 1U);
+    spiStart(&SPID1, &spicfg);
+    spi_lld_reset_log(&SPID1);
+    spiTransferList(&SPID1, list, 3U);
+    test_assert(SPID1.state == SPI_READY, "not ready");
+    test_assert(SPID1.segp == NULL, "list still in progress");
+  }
+
+  /* The segments were executed in order with the slave selected once.*/
+  test_set_step(2);
+  {
+    test_assert(SPID1.nlog == 3U, "wrong number of transfers");
+    test_assert(SPID1.interrupts == 3U, "wrong number of interrupts");
+    for (i = 0U; i < 3U; i++) {
+      test_assert(SPID1.log[i].n == list[i].n, "wrong segment size");
+      test_assert(SPID1.log[i].selected, "slave not selected");
+    }
+    test_assert((SPID1.selects == 1U) && (SPID1.unselects == 1U),
+                "wrong slave select handling");
+    test_assert(!SPID1.selected, "slave still selected");
+  }
+
+  /* The segments after the first one were started from the completion
+     interrupt, the gaps are the interrupt latency only.*/
+  test_set_step(3);
+  {
+    test_assert(!SPID1.log[0].isr, "first segment started from ISR");
+    test_assert(SPID1.log[1].isr && SPID1.log[2].isr,
+                "segment started from thread");
+    test_assert(log_gap(0U, 2U) == SPI_SIM_ISR_LATENCY, "wrong gap");
+    test_assert(SPID1.log[2].end - SPID1.log[0].start ==
+                (52U * WORD_TIME) + (2U * SPI_SIM_ISR_LATENCY),
+                "wrong list duration");
+  }
+
+  /* The response has been received.*/
+  test_set_step(4);
+  {
+    for (i = 0U; i < 16U; i++) {
+      test_assert(rxbuf[i] == (uint8_t)i, "wrong response");
+    }
+  }
+}
+
+static const testcase_t test_009_001 = {
+  "segments executed back-to-back",
+  test_009_setup,
+  test_009_teardown,
+  test_009_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_009_002 Slave select per segment
+ *
+ * <h2>Description</h2>
+ * Each segment of the list selects and unselects the slave, the
+ * completion callback is invoked once at the end of the list.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The list is started asynchronously and the callback is waited for.
+ * - The slave has been selected and unselected for each segment.
+ * - The exchanged data has been looped back.
+ * .
+ */
+
+static void test_009_002_execute(void) {
+  const SPISegment list[3] = {
+    {txbuf,       rxbuf,       8U, SPI_SEGMENT_SELECT | SPI_SEGMENT_UNSELECT},
+    {&txbuf[8],   &rxbuf[8],   8U, SPI_SEGMENT_SELECT | SPI_SEGMENT_UNSELECT},
+    {&txbuf[16],  &rxbuf[16],  8U, SPI_SEGMENT_SELECT | SPI_SEGMENT_UNSELECT}
+  };
+  unsigned i;
+
+  /* The list is started asynchronously and the callback is waited for.*/
+  test_set_step(1);
+  {
+    fill(txbuf, 24U, 2U);
+    spiStart(&SPID1, &spicfg_cb);
+    spi_lld_reset_log(&SPID1);
+    spiStartTransferList(&SPID1, list, 3U);
+    test_assert(chBSemWaitTimeout(&end_sem, MS2ST(100)) == MSG_OK,
+                "callback not invoked");
+    test_assert(end_calls == 1U, "wrong number of callbacks");
+    test_assert(SPID1.state == SPI_READY, "not ready");
+  }
+
+  /* The slave has been selected and unselected for each segment.*/
+  test_set_step(2);
+  {
+    test_assert(SPID1.nlog == 3U, "wrong number of transfers");
+    test_assert((SPID1.selects == 3U) && (SPID1.unselects == 3U),
+                "wrong slave select handling");
+    for (i = 0U; i < 3U; i++) {
+      test_assert(SPID1.log[i].selected, "slave not selected");
+    }
+    test_assert(!SPID1.selected, "slave still selected");
+  }
+
+  /* The exchanged data has been looped back.*/
+  test_set_step(3);
+  {
+    test_assert(memcmp(rxbuf, txbuf, 24U) == 0, "wrong data");
+  }
+}
+
+static const testcase_t test_009_002 = {
+  "slave select per segment",
+  test_009_setup,
+  test_009_teardown,
+  test_009_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_009_003 Inter-segment gaps benchmark
+ *
+ * <h2>Description</h2>
+ * The same sequence of transfers is executed as a transfer list and as
+ * separate synchronous transfers, the gaps between the transfers and the
+ * bus throughput are measured on the simulated bus timeline.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The transfers are executed as a transfer list.
+ * - The transfers are executed as separate synchronous transfers.
+ * - The gaps are compared.
+ * .
+ */
+
+#define BMK_SEGMENTS            8U
+#define BMK_SEGMENT_SIZE        16U
+
+static void print_gap(const char *msgp, uint32_t gap) {
+  uint32_t bytes, time, kbs10;
+
+  bytes = BMK_SEGMENTS * BMK_SEGMENT_SIZE;
+  time  = (bytes * WORD_TIME) + ((BMK_SEGMENTS - 1U) * gap);
+  kbs10 = (uint32_t)(((uint64_t)bytes * 1000000000U * 10U) /
+                     ((uint64_t)time * 1024U));
+  test_print(msgp);
+  test_printn(gap);
+  test_print(" ns, ");
+  test_printn(kbs10 / 10U);
+  test_print(".");
+  test_printn(kbs10 % 10U);
+  test_println(" KB/S");
+}
+
+static void test_009_003_execute(void) {
+  SPISegment list[BMK_SEGMENTS];
+  uint32_t list_gap, thread_gap;
+  unsigned i;
+
+  /* The transfers are executed as a transfer list.*/
+  test_set_step(1);
+  {
+    fill(txbuf, sizeof txbuf, 3U);
+    for (i = 0U; i < BMK_SEGMENTS; i++) {
+      list[i].txbuf = &txbuf[i * BMK_SEGMENT_SIZE];
+      list[i].rxbuf = NULL;
+      list[i].n     = BMK_SEGMENT_SIZE;
+      list[i].flags = 0U;
+    }
+    list[0].flags                = SPI_SEGMENT_SELECT;
+    list[BMK_SEGMENTS - 1].flags = SPI_SEGMENT_UNSELECT;
+
+    spiStart(&SPID1, &spicfg);
+    spi_lld_reset_log(&SPID1);
+    spiTransferList(&SPID1, list, BMK_SEGMENTS);
+    test_assert(SPID1.nlog == BMK_SEGMENTS, "wrong number of transfers");
+    test_assert(SPID1.interrupts == BMK_SEGMENTS,
+                "wrong number of interrupts");
+    list_gap = log_gap(0U, BMK_SEGMENTS - 1U);
+  }
+
+  /* The transfers are executed as separate synchronous transfers.*/
+  test_set_step(2);
+  {
+    spi_lld_reset_log(&SPID1);
+    spiSelect(&SPID1);
+    for (i = 0U; i < BMK_SEGMENTS; i++) {
+      spiSend(&SPID1, BMK_SEGMENT_SIZE, &txbuf[i * BMK_SEGMENT_SIZE]);
+    }
+    spiUnselect(&SPID1);
+    test_assert(SPID1.nlog == BMK_SEGMENTS, "wrong number of transfers");
+    for (i = 0U; i < BMK_SEGMENTS; i++) {
+      test_assert(!SPID1.log[i].isr, "transfer started from ISR");
+    }
+    thread_gap = log_gap(0U, BMK_SEGMENTS - 1U);
+  }
+
+  /* The gaps are compared.*/
+  test_set_step(3);
+  {
+    test_assert(list_gap < thread_gap, "list slower than single transfers");
+    print_gap("--- List gap   : ", list_gap);
+    print_gap("--- Thread gap : ", thread_gap);
+  }
+}
+
+static const testcase_t test_009_003 = {
+  "inter-segment gaps benchmark",
+  test_009_setup,
+  test_009_teardown,
+  test_009_003_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   SPI transfer lists.
+ */
+const testcase_t * const test_sequence_009[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_009_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_009_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_009_003,
+#endif
+  NULL
+};
@@ -0,0 +1,358 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_010 SPI transactions queue
+ *
+ * File: @ref test_sequence_010.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the SPI transactions queue on the simulated SPI
+ * driver, the queued transactions are started from the completion
+ * interrupt of the previous one and the driver is reconfigured from ISR
+ * context when the configuration changes.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_010_001
+ * - @subpage test_010_002
+ * - @subpage test_010_003
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+/* Simulated bus clocks of 8MHz and 1MHz.*/
+#define FAST_WORD_TIME          1000U
+#define SLOW_WORD_TIME          8000U
+
+static const SPIConfig fastcfg = {
+  NULL,
+  FAST_WORD_TIME
+};
+
+static const SPIConfig slowcfg = {
+  NULL,
+  SLOW_WORD_TIME
+};
+
+static SPITransaction tr[4];
+static SPISegment seg[4][2];
+static uint8_t txdata[4][16];
+static uint8_t rxdata[4][16];
+static SPITransaction *order[4];
+static unsigned norder;
+
+static void tr_cb(SPIDriver *spip, SPITransaction *trp) {
+
+  (void)spip;
+
+  if (norder < 4U) {
+    order[norder++] = trp;
+  }
+}
+
+/*
+ * Prepares a transaction made of a command byte followed by an exchange
+ * of @p n bytes with the slave selected for the whole transaction.
+ */
+static void tr_prepare(unsigned i, const SPIConfig *config,
+                       uint32_t prio, size_t n) {
+  size_t j;
+
+  for (j = 0U; j < sizeof txdata[i]; j++) {
+    txdata[i][j] = (uint8_t)((i << 4) + j);
+  }
+  memset(rxdata[i], 0, sizeof rxdata[i]);
+  seg[i][0].txbuf = &txdata[i][0];
+  seg[i][0].rxbuf = NULL;
+  seg[i][0].n     = 1U;
+  seg[i][0].flags = SPI_SEGMENT_SELECT;
+  seg[i][1].txbuf = &txdata[i][1];
+  seg[i][1].rxbuf = rxdata[i];
+  seg[i][1].n     = n;
+  seg[i][1].flags = SPI_SEGMENT_UNSELECT;
+  memset(&tr[i], 0, sizeof tr[i]);
+  tr[i].prio   = prio;
+  tr[i].config = config;
+  tr[i].list   = seg[i];
+  tr[i].n      = 2U;
+  tr[i].cb     = tr_cb;
+}
+
+static void test_010_setup(void) {
+  spi_queue_stats_t stats;
+
+  norder = 0U;
+  spiStart(&SPID1, &fastcfg);
+  spiQueueGetStats(&SPID1, &stats);
+  spi_lld_reset_log(&SPID1);
+}
+
+static void test_010_teardown(void) {
+
+  /* Transactions left in the queue by a failed test are completed.*/
+  while ((SPID1.queue.current != NULL) || (SPID1.queue.head != NULL)) {
+    osalThreadSleepMilliseconds(1);
+  }
+  spiStop(&SPID1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_010_001 Priority ordering
+ *
+ * <h2>Description</h2>
+ * Transactions are submitted while the bus is busy, they are executed
+ * back-to-back in priority order.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Four transactions are submitted, the last one is waited for then
+ *   the lowest priority one is waited for.
+ * - The transactions completed in priority order, FIFO for the same
+ *   priority.
+ * - The queued transactions were started from the completion interrupt.
+ * - The exchanged data has been looped back.
+ * .
+ */
+
+static void test_010_001_execute(void) {
+  unsigned i;
+
+  /* Four transactions are submitted, the last one is waited for then the
+     lowest priority one is waited for.*/
+  test_set_step(1);
+  {
+    tr_prepare(0U, &fastcfg, 0U, 15U);
+    tr_prepare(1U, &fastcfg, 1U, 15U);
+    tr_prepare(2U, &fastcfg, 3U, 15U);
+    tr_prepare(3U, &fastcfg, 3U, 15U);
+    spiQueueSubmit(&SPID1, &tr[0]);
+    spiQueueSubmit(&SPID1, &tr[1]);
+    spiQueueSubmit(&SPID1, &tr[2]);
+    spiQueueTransfer(&SPID1, &tr[3]);
+    test_assert(norder == 3U, "wrong number of completed transactions");
+    test_assert(SPID1.queue.current == &tr[1], "wrong transaction started");
+    osalThreadSleepMilliseconds(10);
+    test_assert(norder == 4U, "not all transactions completed");
+    test_assert(SPID1.queue.head == NULL, "queue not empty");
+    test_assert(SPID1.queue.current == NULL, "transaction in progress");
+  }
+
+  /* The transactions completed in priority order, FIFO for the same
+     priority.*/
+  test_set_step(2);
+  {
+    test_assert((order[0] == &tr[0]) && (order[1] == &tr[2]) &&
+                (order[2] == &tr[3]) && (order[3] == &tr[1]),
+                "wrong order");
+  }
+
+  /* The queued transactions were started from the completion
+     interrupt.*/
+  test_set_step(3);
+  {
+    test_assert(SPID1.nlog == 8U, "wrong number of transfers");
+    test_assert(!SPID1.log[0].isr, "first transfer started from ISR");
+    for (i = 1U; i < 8U; i++) {
+      test_assert(SPID1.log[i].isr, "transfer started from thread");
+      test_assert(SPID1.log[i].start - SPID1.log[i - 1U].end ==
+                  SPI_SIM_ISR_LATENCY, "wrong gap");
+    }
+    test_assert((SPID1.selects == 4U) && (SPID1.unselects == 4U),
+                "wrong slave select handling");
+  }
+
+  /* The exchanged data has been looped back.*/
+  test_set_step(4);
+  {
+    for (i = 0U; i < 4U; i++) {
+      test_assert(memcmp(rxdata[i], &txdata[i][1], 15U) == 0,
+                  "wrong data");
+    }
+  }
+}
+
+static const testcase_t test_010_001 = {
+  "priority ordering",
+  test_010_setup,
+  test_010_teardown,
+  test_010_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_010_002 Reconfiguration between transactions
+ *
+ * <h2>Description</h2>
+ * Queued transactions use different configurations, the driver is
+ * reconfigured from the completion interrupt only when the configuration
+ * changes.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Transactions alternating two configurations are submitted, the last
+ *   one is waited for.
+ * - The driver has been reconfigured only on configuration changes.
+ * - Each transfer used the configuration of its transaction.
+ * .
+ */
+
+static void test_010_002_execute(void) {
+  unsigned i;
+
+  /* Transactions alternating two configurations are submitted, the last
+     one is waited for.*/
+  test_set_step(1);
+  {
+    tr_prepare(0U, &fastcfg, 0U, 8U);
+    tr_prepare(1U, &fastcfg, 0U, 8U);
+    tr_prepare(2U, &slowcfg, 0U, 8U);
+    tr_prepare(3U, &fastcfg, 0U, 8U);
+    spiQueueSubmit(&SPID1, &tr[0]);
+    spiQueueSubmit(&SPID1, &tr[1]);
+    spiQueueSubmit(&SPID1, &tr[2]);
+    spiQueueTransfer(&SPID1, &tr[3]);
+    test_assert(norder == 4U, "not all transactions completed");
+  }
+
+  /* The driver has been reconfigured only on configuration changes.*/
+  test_set_step(2);
+  {
+    test_assert(SPID1.starts == 2U, "wrong number of reconfigurations");
+    test_assert(SPID1.config == &fastcfg, "wrong final configuration");
+  }
+
+  /* Each transfer used the configuration of its transaction.*/
+  test_set_step(3);
+  {
+    test_assert(SPID1.nlog == 8U, "wrong number of transfers");
+    for (i = 0U; i < 8U; i++) {
+      const SPIConfig *config = tr[i / 2U].config;
+
+      test_assert(SPID1.log[i].config == config, "wrong configuration");
+      test_assert(SPID1.log[i].end - SPID1.log[i].start ==
+                  SPID1.log[i].n * config->word_time, "wrong duration");
+    }
+  }
+}
+
+static const testcase_t test_010_002 = {
+  "reconfiguration between transactions",
+  test_010_setup,
+  test_010_teardown,
+  test_010_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_010_003 Queue statistics
+ *
+ * <h2>Description</h2>
+ * The statistics account the completed transactions, the time spent on
+ * the bus and in the queue, the statistics are reset after being read.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Four transactions are executed back-to-back.
+ * - The statistics are read.
+ * - The statistics have been reset.
+ * .
+ */
+
+static void test_010_003_execute(void) {
+  spi_queue_stats_t stats;
+
+  /* Four transactions are executed back-to-back.*/
+  test_set_step(1);
+  {
+    tr_prepare(0U, &fastcfg, 0U, 4U);
+    tr_prepare(1U, &fastcfg, 0U, 4U);
+    tr_prepare(2U, &fastcfg, 0U, 4U);
+    tr_prepare(3U, &fastcfg, 0U, 4U);
+    spiQueueSubmit(&SPID1, &tr[0]);
+    spiQueueSubmit(&SPID1, &tr[1]);
+    spiQueueSubmit(&SPID1, &tr[2]);
+    spiQueueTransfer(&SPID1, &tr[3]);
+  }
+
+  /* The statistics are read.*/
+  test_set_step(2);
+  {
+    spiQueueGetStats(&SPID1, &stats);
+    test_assert(stats.completed == 4U, "wrong completed count");
+    test_assert(stats.busy > 0U, "no busy time");
+    test_assert(stats.wait > 0U, "no wait time");
+    test_assert((uint64_t)stats.max_wait <= stats.wait, "wrong max wait");
+  }
+
+  /* The statistics have been reset.*/
+  test_set_step(3);
+  {
+    spiQueueGetStats(&SPID1, &stats);
+    test_assert((stats.completed == 0U) && (stats.busy == 0U) &&
+                (stats.wait == 0U) && (stats.max_wait == 0U),
+                "statistics not reset");
+  }
+}
+
+static const testcase_t test_010_003 = {
+  "queue statistics",
+  test_010_setup,
+  test_010_teardown,
+  test_010_003_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   SPI transactions queue.
+ */
+const testcase_t * const test_sequence_010[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_010_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_010_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_010_003,
+#endif
+  NULL
+};
@@ -0,0 +1,427 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_011 ADC streaming
+ *
+ * File: @ref test_sequence_011.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ADC streaming on the simulated ADC driver, the
+ * channels sample synthetic waveforms so the content of each block can be
+ * checked against its sequence number. Lagging consumers and conversion
+ * errors are simulated.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_011_001
+ * - @subpage test_011_002
+ * - @subpage test_011_003
+ * - @subpage test_011_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define NUM_CHANNELS            3U
+#define BLOCK_DEPTH             8U
+#define NUM_BLOCKS              4U
+
+static ADCStream stream;
+static ADCStreamBlock blocks[NUM_BLOCKS];
+static adcsample_t ring[NUM_BLOCKS * BLOCK_DEPTH * NUM_CHANNELS];
+static adcsample_t dmabuf[2U * BLOCK_DEPTH * NUM_CHANNELS];
+static uint32_t errors;
+static adcerror_t last_error;
+
+static void error_cb(ADCDriver *adcp, adcerror_t err) {
+
+  (void)adcp;
+
+  errors++;
+  last_error = err;
+}
+
+static const ADCConversionGroup adcgrp = {
+  true,
+  NUM_CHANNELS,
+  NULL,
+  error_cb,
+  (systime_t)1
+};
+
+/*
+ * Checks that the block samples are the waveforms rows following the
+ * rows of the previous blocks, dropped blocks included.
+ */
+static bool block_is_valid(const ADCStreamBlock *bp) {
+  uint32_t row;
+  unsigned ch;
+
+  for (row = 0U; row < BLOCK_DEPTH; row++) {
+    for (ch = 0U; ch < NUM_CHANNELS; ch++) {
+      if (bp->samples[(row * NUM_CHANNELS) + ch] !=
+          adc_lld_waveform(ch, (bp->seq * BLOCK_DEPTH) + row)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+static void test_011_setup(void) {
+
+  adcStreamObjectInit(&stream, blocks, NUM_BLOCKS, ring, dmabuf,
+                      BLOCK_DEPTH);
+  ADCD1.events = 0U;
+  ADCD1.fault  = 0U;
+  errors = 0U;
+  adcStart(&ADCD1, NULL);
+}
+
+static void test_011_teardown(void) {
+
+  adcStopConversion(&ADCD1);
+  adcStop(&ADCD1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_011_001 Blocks delivered in order
+ *
+ * <h2>Description</h2>
+ * A consumer keeping up with the conversion receives all the blocks in
+ * order, time stamped when the conversion completed them.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The stream is started.
+ * - Blocks are received in order, without overruns, and contain the
+ *   expected waveforms rows.
+ * - The stream is stopped, no more blocks are returned.
+ * .
+ */
+
+static void test_011_001_execute(void) {
+  ADCStreamBlock *bp;
+  rtcnt_t start, last;
+  uint32_t i;
+
+  /* The stream is started.*/
+  test_set_step(1);
+  {
+    start = osalOsGetRealtimeCounterX();
+    adcStartStream(&ADCD1, &adcgrp, &stream);
+  }
+
+  /* Blocks are received in order, without overruns, and contain the
+     expected waveforms rows.*/
+  test_set_step(2);
+  {
+    last = start;
+    for (i = 0U; i < 16U; i++) {
+      test_assert(adcStreamGet(&stream, &bp, MS2ST(100)) == MSG_OK,
+                  "no block");
+      test_assert(bp->seq == i, "wrong sequence number");
+      test_assert(block_is_valid(bp), "wrong samples");
+      test_assert((rtcnt_t)(bp->stamp - start) >= (rtcnt_t)(last - start),
+                  "time stamp not monotonic");
+      test_assert((rtcnt_t)(bp->stamp - start) <=
+                  (rtcnt_t)(osalOsGetRealtimeCounterX() - start),
+                  "time stamp in the future");
+      last = bp->stamp;
+      adcStreamRelease(&stream);
+    }
+    test_assert(adcStreamGetOverruns(&stream) == 0U, "overruns");
+  }
+
+  /* The stream is stopped, no more blocks are returned.*/
+  test_set_step(3);
+  {
+    adcStopConversion(&ADCD1);
+    while (adcStreamGet(&stream, &bp, TIME_IMMEDIATE) == MSG_OK) {
+      adcStreamRelease(&stream);
+    }
+    test_assert(adcStreamGet(&stream, &bp, TIME_INFINITE) == MSG_RESET,
+                "stream not stopped");
+  }
+}
+
+static const testcase_t test_011_001 = {
+  "blocks delivered in order",
+  test_011_setup,
+  test_011_teardown,
+  test_011_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_011_002 Overrun accounting
+ *
+ * <h2>Description</h2>
+ * The consumer does not read the stream, once the ring is full the new
+ * blocks are dropped and accounted as overruns.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The stream runs without consumer then it is stopped.
+ * - Every converted block has been either stored or dropped.
+ * - The ring contains the oldest blocks.
+ * .
+ */
+
+static void test_011_002_execute(void) {
+  ADCStreamBlock *bp;
+  uint32_t i;
+
+  /* The stream runs without consumer then it is stopped.*/
+  test_set_step(1);
+  {
+    adcStartStream(&ADCD1, &adcgrp, &stream);
+    osalThreadSleepMilliseconds(20);
+    adcStopConversion(&ADCD1);
+  }
+
+  /* Every converted block has been either stored or dropped.*/
+  test_set_step(2);
+  {
+    test_assert(ADCD1.events > NUM_BLOCKS, "ring not filled");
+    test_assert(adcStreamGetOverruns(&stream) == ADCD1.events - NUM_BLOCKS,
+                "wrong overruns count");
+  }
+
+  /* The ring contains the oldest blocks.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < NUM_BLOCKS; i++) {
+      test_assert(adcStreamGet(&stream, &bp, TIME_IMMEDIATE) == MSG_OK,
+                  "no block");
+      test_assert(bp->seq == i, "wrong sequence number");
+      test_assert(block_is_valid(bp), "wrong samples");
+      adcStreamRelease(&stream);
+    }
+    test_assert(adcStreamGet(&stream, &bp, TIME_IMMEDIATE) == MSG_RESET,
+                "unexpected block");
+  }
+}
+
+static const testcase_t test_011_002 = {
+  "overrun accounting",
+  test_011_setup,
+  test_011_teardown,
+  test_011_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_011_003 Sequence gaps
+ *
+ * <h2>Description</h2>
+ * The consumer lags behind the conversion then catches up, the dropped
+ * blocks appear as gaps in the sequence numbers of the received blocks
+ * and the received blocks keep their own samples and time stamps.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The stream runs without consumer.
+ * - The blocks are consumed until the stream is stopped.
+ * - The gaps in the sequence numbers match the overruns.
+ * - The blocks stored while the consumer was lagging were time stamped
+ *   at conversion time.
+ * .
+ */
+
+static void test_011_003_execute(void) {
+  ADCStreamBlock *bp;
+  rtcnt_t start, wakeup;
+  uint32_t received, gaps, next, i;
+  bool stamps_ok;
+
+  /* The stream runs without consumer.*/
+  test_set_step(1);
+  {
+    start = osalOsGetRealtimeCounterX();
+    adcStartStream(&ADCD1, &adcgrp, &stream);
+    osalThreadSleepMilliseconds(10);
+    wakeup = osalOsGetRealtimeCounterX();
+    test_assert(adcStreamGetOverruns(&stream) > 0U, "no overruns");
+  }
+
+  /* The blocks are consumed until the stream is stopped.*/
+  test_set_step(2);
+  {
+    received  = 0U;
+    gaps      = 0U;
+    next      = 0U;
+    stamps_ok = true;
+    for (i = 0U; i < 2U * NUM_BLOCKS; i++) {
+      test_assert(adcStreamGet(&stream, &bp, MS2ST(100)) == MSG_OK,
+                  "no block");
+      test_assert(bp->seq >= next, "sequence number not increasing");
+      test_assert(block_is_valid(bp), "wrong samples");
+      if ((i < NUM_BLOCKS) &&
+          ((rtcnt_t)(bp->stamp - start) > (rtcnt_t)(wakeup - start))) {
+        stamps_ok = false;
+      }
+      gaps += bp->seq - next;
+      next  = bp->seq + 1U;
+      received++;
+      adcStreamRelease(&stream);
+    }
+    adcStopConversion(&ADCD1);
+    while (adcStreamGet(&stream, &bp, TIME_IMMEDIATE) == MSG_OK) {
+      test_assert(block_is_valid(bp), "wrong samples");
+      gaps += bp->seq - next;
+      next  = bp->seq + 1U;
+      received++;
+      adcStreamRelease(&stream);
+    }
+  }
+
+  /* The gaps in the sequence numbers match the overruns.*/
+  test_set_step(3);
+  {
+    gaps += ADCD1.events - next;
+    test_assert(gaps > 0U, "no gaps");
+    test_assert(gaps == adcStreamGetOverruns(&stream),
+                "gaps not matching the overruns");
+    test_assert(received + gaps == ADCD1.events, "blocks lost");
+  }
+
+  /* The blocks stored while the consumer was lagging were time stamped
+     at conversion time.*/
+  test_set_step(4);
+  {
+    test_assert(stamps_ok, "time stamped at retrieval");
+  }
+}
+
+static const testcase_t test_011_003 = {
+  "sequence gaps",
+  test_011_setup,
+  test_011_teardown,
+  test_011_003_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_011_004 Conversion error
+ *
+ * <h2>Description</h2>
+ * A conversion error terminates the stream, the waiting consumer is
+ * resumed with a timeout and the error callback is invoked.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - An error is injected on the sixth conversion event.
+ * - The blocks before the error are received, then the consumer is
+ *   resumed with a timeout.
+ * - The error has been reported and the stream is terminated.
+ * .
+ */
+
+static void test_011_004_execute(void) {
+  ADCStreamBlock *bp;
+  uint32_t received;
+  msg_t msg;
+
+  /* An error is injected on the sixth conversion event.*/
+  test_set_step(1);
+  {
+    ADCD1.fault = 6U;
+    adcStartStream(&ADCD1, &adcgrp, &stream);
+  }
+
+  /* The blocks before the error are received, then the consumer is
+     resumed with a timeout.*/
+  test_set_step(2);
+  {
+    received = 0U;
+    while ((msg = adcStreamGet(&stream, &bp, MS2ST(100))) == MSG_OK) {
+      test_assert(bp->seq == received, "wrong sequence number");
+      test_assert(block_is_valid(bp), "wrong samples");
+      received++;
+      adcStreamRelease(&stream);
+    }
+    test_assert(received == 5U, "wrong number of blocks");
+    test_assert(msg == MSG_TIMEOUT, "wrong message");
+  }
+
+  /* The error has been reported and the stream is terminated.*/
+  test_set_step(3);
+  {
+    test_assert((errors == 1U) && (last_error == ADC_ERR_OVERFLOW),
+                "error not reported");
+    test_assert(ADCD1.state == ADC_READY, "not ready");
+    test_assert(ADCD1.stream == NULL, "stream still attached");
+    test_assert(adcStreamGet(&stream, &bp, TIME_IMMEDIATE) == MSG_RESET,
+                "stream not terminated");
+  }
+}
+
+static const testcase_t test_011_004 = {
+  "conversion error",
+  test_011_setup,
+  test_011_teardown,
+  test_011_004_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   ADC streaming.
+ */
+const testcase_t * const test_sequence_011[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_011_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_011_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_011_003,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_011_004,
+#endif
+  NULL
+};
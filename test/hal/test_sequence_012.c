@@ -0,0 +1,522 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_012 STM32 CAN driver
+ *
+ * File: @ref test_sequence_012.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the STM32 CANv1 CAN driver on the bxCAN cell model,
+ * the frames are either sent by the driver in loop back mode or injected
+ * by the test thread acting as another node on the bus. The software
+ * receive FIFO, the overflow of the cell receive FIFOs and the filters
+ * allocator are covered.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_012_001
+ * - @subpage test_012_002
+ * - @subpage test_012_003
+ * - @subpage test_012_004
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define RX_FIFO_SIZE            8U
+#define CAN2_START_BANK         (STM32_CAN_MAX_FILTERS / 2U)
+
+static CANRxTimedFrame rxbuf[RX_FIFO_SIZE];
+static CANRxFifo rxfifo;
+static CANRxTimedFrame frames[16];
+static event_listener_t el;
+
+static const CANConfig loopbackcfg = {
+  CAN_MCR_ABOM | CAN_MCR_AWUM | CAN_MCR_TXFP,
+  CAN_BTR_LBKM | CAN_BTR_SJW(0) | CAN_BTR_TS2(1) |
+  CAN_BTR_TS1(8) | CAN_BTR_BRP(6)
+};
+
+static const CANConfig buscfg = {
+  CAN_MCR_ABOM | CAN_MCR_AWUM | CAN_MCR_TXFP,
+  CAN_BTR_SJW(0) | CAN_BTR_TS2(1) | CAN_BTR_TS1(8) | CAN_BTR_BRP(6)
+};
+
+static const CANConfig lockedcfg = {
+  CAN_MCR_ABOM | CAN_MCR_AWUM | CAN_MCR_TXFP | CAN_MCR_RFLM,
+  CAN_BTR_SJW(0) | CAN_BTR_TS2(1) | CAN_BTR_TS1(8) | CAN_BTR_BRP(6)
+};
+
+/*
+ * A node on the bus sends a standard frame carrying a sequence number.
+ */
+static void bus_send(uint32_t sid, uint32_t seq) {
+  uint8_t data[4];
+
+  data[0] = (uint8_t)seq;
+  data[1] = (uint8_t)(seq >> 8);
+  data[2] = (uint8_t)(seq >> 16);
+  data[3] = (uint8_t)(seq >> 24);
+  can_model_bus_send(false, sid, data, sizeof data);
+}
+
+/*
+ * Fetches frames from the software FIFO until the requested number has
+ * been received or a timeout occurs.
+ */
+static size_t receive_many(size_t n) {
+  size_t i, k;
+
+  for (i = 0U; i < n; i += k) {
+    k = canReceiveMany(&CAND1, &frames[i], n - i, MS2ST(10));
+    if (k == 0U) {
+      break;
+    }
+  }
+
+  return i;
+}
+
+static void can_setup(void) {
+
+  canRxFifoObjectInit(&rxfifo, rxbuf, RX_FIFO_SIZE);
+  canSetRxFifo(&CAND1, &rxfifo);
+  chEvtRegister(&CAND1.error_event, &el, 0);
+  memset(&can_model_counters, 0, sizeof can_model_counters);
+}
+
+static void can_teardown(void) {
+
+  chEvtUnregister(&CAND1.error_event, &el);
+  canStop(&CAND1);
+  canSetRxFifo(&CAND1, NULL);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_012_001 Loop back transfers
+ *
+ * <h2>Description</h2>
+ * The driver transmits more frames than the available mailboxes in loop
+ * back mode, the frames are received back through the default filter in
+ * transmission order.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Six frames are transmitted.
+ * - The frames are received in order and unchanged.
+ * .
+ */
+
+static void test_012_001_execute(void) {
+  unsigned i;
+
+  canStart(&CAND1, &loopbackcfg);
+
+  /* Six frames are transmitted.*/
+  test_set_step(1);
+  {
+    CANTxFrame ctf;
+
+    for (i = 0U; i < 6U; i++) {
+      ctf.IDE       = CAN_IDE_STD;
+      ctf.RTR       = CAN_RTR_DATA;
+      ctf.SID       = 0x100U + i;
+      ctf.DLC       = 8U;
+      ctf.data32[0] = i;
+      ctf.data32[1] = ~i;
+      test_assert(canTransmit(&CAND1, CAN_ANY_MAILBOX, &ctf,
+                              MS2ST(10)) == MSG_OK, "transmission failed");
+    }
+  }
+
+  /* The frames are received in order and unchanged.*/
+  test_set_step(2);
+  {
+    test_assert(receive_many(6U) == 6U, "frames not received");
+    for (i = 0U; i < 6U; i++) {
+      test_assert(frames[i].frame.SID == 0x100U + i, "wrong identifier");
+      test_assert(frames[i].frame.DLC == 8U, "wrong length");
+      test_assert((frames[i].frame.data32[0] == i) &&
+                  (frames[i].frame.data32[1] == ~i), "wrong data");
+      test_assert(frames[i].frame.FMI == 0U, "wrong filter");
+    }
+    test_assert(can_model_counters.sent == 6U, "wrong frames count");
+    test_assert(canRxFifoGetOverruns(&rxfifo) == 0U, "unexpected overruns");
+  }
+}
+
+static const testcase_t test_012_001 = {
+  "loop back transfers",
+  can_setup,
+  can_teardown,
+  test_012_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_012_002 Software FIFO overflow
+ *
+ * <h2>Description</h2>
+ * Frames are injected faster than the application reads them, the
+ * frames not fitting the software FIFO are dropped and counted as
+ * overruns while the cell FIFO never overflows because the receive
+ * interrupt drains it.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Twelve frames are injected, four frames are dropped and the overflow
+ *   is signaled.
+ * - The first eight frames are read.
+ * - A frame injected after the FIFO has been emptied is not dropped.
+ * .
+ */
+
+static void test_012_002_execute(void) {
+  unsigned i;
+
+  canStart(&CAND1, &buscfg);
+
+  /* Twelve frames are injected, four frames are dropped and the overflow
+     is signaled.*/
+  test_set_step(1);
+  {
+    for (i = 0U; i < 12U; i++) {
+      bus_send(0x200U, i);
+    }
+    test_assert(canRxFifoGetOverruns(&rxfifo) == 4U, "wrong overruns");
+    test_assert((chEvtGetAndClearFlags(&el) & CAN_OVERFLOW_ERROR) != 0U,
+                "overflow not signaled");
+    test_assert(can_model_counters.overruns == 0U, "cell FIFO overflow");
+  }
+
+  /* The first eight frames are read.*/
+  test_set_step(2);
+  {
+    test_assert(receive_many(RX_FIFO_SIZE) == RX_FIFO_SIZE,
+                "frames not received");
+    for (i = 0U; i < RX_FIFO_SIZE; i++) {
+      test_assert(frames[i].frame.data32[0] == i, "wrong frame");
+    }
+    test_assert(canReceiveMany(&CAND1, frames, 1U, TIME_IMMEDIATE) == 0U,
+                "FIFO not empty");
+  }
+
+  /* A frame injected after the FIFO has been emptied is not dropped.*/
+  test_set_step(3);
+  {
+    bus_send(0x200U, 12U);
+    test_assert(receive_many(1U) == 1U, "frame not received");
+    test_assert(frames[0].frame.data32[0] == 12U, "wrong frame");
+    test_assert(canRxFifoGetOverruns(&rxfifo) == 4U, "wrong overruns");
+    test_assert(chEvtGetAndClearFlags(&el) == 0U, "unexpected error");
+  }
+}
+
+static const testcase_t test_012_002 = {
+  "software FIFO overflow",
+  can_setup,
+  can_teardown,
+  test_012_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_012_003 Cell FIFO overflow
+ *
+ * <h2>Description</h2>
+ * Without a software FIFO the frames remain in the cell FIFO until the
+ * application reads them, the frames exceeding its depth overwrite the
+ * last frame or are discarded in locked mode, the overflow is signaled.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Five frames are injected, the last frame received replaces the third
+ *   one.
+ * - Five frames are injected in locked mode, the last two frames are
+ *   discarded.
+ * .
+ */
+
+/*
+ * Injects five frames and reads back the frames left in the cell FIFO,
+ * the FIFO must be empty after the expected frames.
+ */
+static bool overflow_check(const CANConfig *config, const uint32_t *seq) {
+  CANRxFrame crf;
+  unsigned i;
+
+  canStart(&CAND1, config);
+  for (i = 0U; i < 5U; i++) {
+    bus_send(0x300U, i);
+  }
+  for (i = 0U; i < 3U; i++) {
+    if ((canReceive(&CAND1, CAN_ANY_MAILBOX, &crf,
+                    TIME_IMMEDIATE) != MSG_OK) ||
+        (crf.data32[0] != seq[i])) {
+      return false;
+    }
+  }
+
+  return canReceive(&CAND1, CAN_ANY_MAILBOX, &crf,
+                    TIME_IMMEDIATE) == MSG_TIMEOUT;
+}
+
+static void test_012_003_setup(void) {
+
+  chEvtRegister(&CAND1.error_event, &el, 0);
+  memset(&can_model_counters, 0, sizeof can_model_counters);
+}
+
+static void test_012_003_execute(void) {
+
+  /* Five frames are injected, the last frame received replaces the third
+     one.*/
+  test_set_step(1);
+  {
+    static const uint32_t seq[3] = {0U, 1U, 4U};
+
+    test_assert(overflow_check(&buscfg, seq), "wrong frames");
+    test_assert(can_model_counters.overruns == 2U, "wrong overruns");
+    test_assert((chEvtGetAndClearFlags(&el) & CAN_OVERFLOW_ERROR) != 0U,
+                "overflow not signaled");
+    canStop(&CAND1);
+  }
+
+  /* Five frames are injected in locked mode, the last two frames are
+     discarded.*/
+  test_set_step(2);
+  {
+    static const uint32_t seq[3] = {0U, 1U, 2U};
+
+    test_assert(overflow_check(&lockedcfg, seq), "wrong frames");
+    test_assert(can_model_counters.overruns == 4U, "wrong overruns");
+    test_assert((chEvtGetAndClearFlags(&el) & CAN_OVERFLOW_ERROR) != 0U,
+                "overflow not signaled");
+  }
+}
+
+static const testcase_t test_012_003 = {
+  "cell FIFO overflow",
+  test_012_003_setup,
+  can_teardown,
+  test_012_003_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_012_004 Filters allocation and release
+ *
+ * <h2>Description</h2>
+ * Filters are allocated among the banks assigned to CAN1, the first
+ * allocation replaces the default filter and the release of the last
+ * filter restores it. The frames are accepted and tagged according to
+ * the allocated filters.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The default filter accepts any frame.
+ * - A list filter replaces the default filter.
+ * - A mask filter for extended identifiers is assigned to the FIFO 1.
+ * - The remaining filters are allocated until exhaustion.
+ * - A released filter is allocated again.
+ * - Releasing all the filters restores the default filter.
+ * .
+ */
+
+static uint32_t filters;
+
+static void test_012_004_setup(void) {
+
+  can_setup();
+  filters = 0U;
+}
+
+static void test_012_004_teardown(void) {
+  uint32_t i;
+
+  for (i = 0U; i < CAN2_START_BANK; i++) {
+    if ((filters & (1U << i)) != 0U) {
+      canSTM32RemoveFilter(&CAND1, i);
+    }
+  }
+  can_teardown();
+}
+
+static void test_012_004_execute(void) {
+  CANFilter cf;
+  uint32_t i, filtered;
+
+  canStart(&CAND1, &buscfg);
+
+  /* The default filter accepts any frame.*/
+  test_set_step(1);
+  {
+    test_assert(CAN1->FA1R == (1U | (1U << CAN2_START_BANK)),
+                "no default filters");
+    bus_send(0x124U, 0U);
+    test_assert(receive_many(1U) == 1U, "frame not received");
+    test_assert(frames[0].frame.FMI == 0U, "wrong filter");
+  }
+
+  /* A list filter replaces the default filter.*/
+  test_set_step(2);
+  {
+    cf.mode       = 1U;
+    cf.scale      = 1U;
+    cf.assignment = 0U;
+    cf.register1  = 0x123U << 21;
+    cf.register2  = 0x125U << 21;
+    test_assert(canSTM32AddFilter(&CAND1, &cf) == false, "no filter");
+    filters |= 1U << cf.filter;
+    test_assert(cf.filter == 0U, "wrong filter number");
+
+    filtered = can_model_counters.filtered;
+    bus_send(0x123U, 1U);
+    bus_send(0x124U, 2U);
+    bus_send(0x125U, 3U);
+    test_assert(receive_many(2U) == 2U, "frames not received");
+    test_assert((frames[0].frame.SID == 0x123U) &&
+                (frames[0].frame.FMI == 0U), "wrong first frame");
+    test_assert((frames[1].frame.SID == 0x125U) &&
+                (frames[1].frame.FMI == 1U), "wrong second frame");
+    test_assert(can_model_counters.filtered == filtered + 1U,
+                "frame not filtered");
+  }
+
+  /* A mask filter for extended identifiers is assigned to the FIFO 1.*/
+  test_set_step(3);
+  {
+    static const uint8_t data[1] = {0x5AU};
+
+    cf.mode       = 0U;
+    cf.scale      = 1U;
+    cf.assignment = 1U;
+    cf.register1  = (0x10000U << 3) | CAN_RI0R_IDE;
+    cf.register2  = (0x1FFFFF00U << 3) | CAN_RI0R_IDE;
+    test_assert(canSTM32AddFilter(&CAND1, &cf) == false, "no filter");
+    filters |= 1U << cf.filter;
+    test_assert(cf.filter == 1U, "wrong filter number");
+
+    filtered = can_model_counters.filtered;
+    can_model_bus_send(true, 0x10042U, data, sizeof data);
+    can_model_bus_send(true, 0x10142U, data, sizeof data);
+    test_assert(receive_many(1U) == 1U, "frame not received");
+    test_assert((frames[0].frame.IDE == CAN_IDE_EXT) &&
+                (frames[0].frame.EID == 0x10042U), "wrong frame");
+    test_assert(frames[0].frame.FMI == 0U, "wrong filter");
+    test_assert(can_model_counters.filtered == filtered + 1U,
+                "frame not filtered");
+  }
+
+  /* The remaining filters are allocated until exhaustion.*/
+  test_set_step(4);
+  {
+    cf.mode       = 0U;
+    cf.scale      = 1U;
+    cf.assignment = 0U;
+    cf.register1  = 0U;
+    cf.register2  = 0xFFFFFFFFU;
+    for (i = 2U; i < CAN2_START_BANK; i++) {
+      test_assert(canSTM32AddFilter(&CAND1, &cf) == false, "no filter");
+      filters |= 1U << cf.filter;
+      test_assert(cf.filter == i, "wrong filter number");
+    }
+    test_assert(canSTM32AddFilter(&CAND1, &cf) == true, "not exhausted");
+    test_assert((CAN1->FA1R & (1U << CAN2_START_BANK)) != 0U,
+                "CAN2 filter changed");
+  }
+
+  /* A released filter is allocated again.*/
+  test_set_step(5);
+  {
+    canSTM32RemoveFilter(&CAND1, 5U);
+    filters &= ~(1U << 5);
+    test_assert((CAN1->FA1R & (1U << 5)) == 0U, "filter active");
+    test_assert(canSTM32AddFilter(&CAND1, &cf) == false, "no filter");
+    filters |= 1U << cf.filter;
+    test_assert(cf.filter == 5U, "wrong filter number");
+  }
+
+  /* Releasing all the filters restores the default filter.*/
+  test_set_step(6);
+  {
+    for (i = 0U; i < CAN2_START_BANK; i++) {
+      canSTM32RemoveFilter(&CAND1, i);
+      filters &= ~(1U << i);
+    }
+    test_assert(CAN1->FA1R == (1U | (1U << CAN2_START_BANK)),
+                "no default filters");
+    bus_send(0x124U, 4U);
+    test_assert(receive_many(1U) == 1U, "frame not received");
+    test_assert((frames[0].frame.SID == 0x124U) &&
+                (frames[0].frame.FMI == 0U), "wrong frame");
+  }
+}
+
+static const testcase_t test_012_004 = {
+  "filters allocation and release",
+  test_012_004_setup,
+  test_012_004_teardown,
+  test_012_004_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   STM32 CAN driver.
+ */
+const testcase_t * const test_sequence_012[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_012_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_012_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_012_003,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_012_004,
+#endif
+  NULL
+};
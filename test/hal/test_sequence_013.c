@@ -0,0 +1,788 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_013 STM32 MAC driver
+ *
+ * File: @ref test_sequence_013.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the descriptors rings handling of the STM32 MACv1
+ * MAC driver on the Ethernet MAC model, the frames are injected by the
+ * test thread acting as the wire and the transmitted frames are recorded
+ * by the model. The buffers are smaller than the largest frame so that
+ * the frames span several descriptors.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_013_001
+ * - @subpage test_013_002
+ * - @subpage test_013_003
+ * - @subpage test_013_004
+ * - @subpage test_013_005
+ * - @subpage test_013_006
+ * - @subpage test_013_007
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+/* Buffers size and descriptors required by the largest frame, as computed
+   by the driver.*/
+#define BUFFER_BYTES            ((((STM32_MAC_BUFFERS_SIZE - 1) | 3) + 1))
+#define FRAME_DESCRIPTORS                                                   \
+  ((STM32_MAC_MAX_FRAME_SIZE + BUFFER_BYTES - 1) / BUFFER_BYTES)
+
+/* Largest frame, the FCS excluded.*/
+#define MAX_FRAME               (STM32_MAC_MAX_FRAME_SIZE - 8U)
+
+#define ETHERTYPE_IPV4          0x0800U
+
+static const MACConfig config = {
+  NULL,
+  0U
+};
+
+static const MACConfig csumcfg = {
+  NULL,
+  MAC_CHECKSUM_GEN_IP | MAC_CHECKSUM_GEN_PROTO |
+  MAC_CHECKSUM_CHECK_IP | MAC_CHECKSUM_CHECK_PROTO
+};
+
+static uint8_t frame[ETH_MODEL_MAX_FRAME_SIZE];
+static uint8_t buf[ETH_MODEL_MAX_FRAME_SIZE];
+
+/*
+ * Builds a broadcast frame whose payload depends on a sequence number.
+ */
+static void frame_make(size_t n, uint16_t type, unsigned seq) {
+  size_t i;
+
+  memset(&frame[0], 0xFF, 6U);
+  memset(&frame[6], 0x02, 6U);
+  frame[12] = (uint8_t)(type >> 8);
+  frame[13] = (uint8_t)type;
+  for (i = 14U; i < n; i++) {
+    frame[i] = (uint8_t)(seq + i);
+  }
+}
+
+/*
+ * The wire delivers a frame carrying a sequence number.
+ */
+static void inject(size_t n, unsigned seq, uint32_t status) {
+
+  frame_make(n, ETHERTYPE_IPV4, seq);
+  eth_model_receive(frame, n, status);
+}
+
+/*
+ * Gets a received frame, compares it with the expected one and releases
+ * it.
+ */
+static bool receive_check(size_t n, unsigned seq) {
+  MACReceiveDescriptor rd;
+  bool ok;
+
+  if (macWaitReceiveDescriptor(&ETHD1, &rd, TIME_IMMEDIATE) != MSG_OK) {
+    return false;
+  }
+  frame_make(n, ETHERTYPE_IPV4, seq);
+  ok = (rd.size == n) &&
+       (macReadReceiveDescriptor(&rd, buf, sizeof buf) == n) &&
+       (memcmp(buf, frame, n) == 0);
+  macReleaseReceiveDescriptor(&rd);
+
+  return ok;
+}
+
+/*
+ * Checks that no frame is pending in the receive ring.
+ */
+static bool receive_none(void) {
+  MACReceiveDescriptor rd;
+
+  return macWaitReceiveDescriptor(&ETHD1, &rd, TIME_IMMEDIATE) ==
+         MSG_TIMEOUT;
+}
+
+/*
+ * Transmits a frame carrying a sequence number.
+ */
+static msg_t transmit(size_t n, unsigned seq, systime_t timeout) {
+  MACTransmitDescriptor td;
+  msg_t msg;
+
+  msg = macWaitTransmitDescriptor(&ETHD1, &td, timeout);
+  if (msg == MSG_OK) {
+    frame_make(n, ETHERTYPE_IPV4, seq);
+    (void)macWriteTransmitDescriptor(&td, frame, n);
+    macReleaseTransmitDescriptor(&td);
+  }
+
+  return msg;
+}
+
+/*
+ * Waits for the model to send the frames given to the DMA and compares
+ * the last one with the expected one.
+ */
+static bool sent_check(uint32_t sent, size_t n, unsigned seq) {
+  unsigned i;
+
+  for (i = 0U; (i < 10U) && (eth_model_counters.sent < sent); i++) {
+    chThdSleepMilliseconds(1);
+  }
+  frame_make(n, ETHERTYPE_IPV4, seq);
+
+  return (eth_model_counters.sent == sent) &&
+         (eth_model_sent.size == n) &&
+         (memcmp(eth_model_sent.data, frame, n) == 0);
+}
+
+static void mac_start(const MACConfig *cfg) {
+
+  macStart(&ETHD1, cfg);
+  (void)macPollLinkStatus(&ETHD1);
+}
+
+static void mac_setup(void) {
+
+  memset(&eth_model_counters, 0, sizeof eth_model_counters);
+  eth_model_tx_hold(false);
+  mac_start(&config);
+}
+
+static void mac_teardown(void) {
+
+  eth_model_tx_hold(false);
+  macStop(&ETHD1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_013_001 Receive ring wrap
+ *
+ * <h2>Description</h2>
+ * Frames are received around the receive ring several times, then the
+ * ring is filled and the frame not fitting is missed, the receive process
+ * is resumed when the descriptors are released.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Frames are received one at time around the ring three times.
+ * - The ring is filled, the exceeding frame is missed.
+ * - The frames in the ring are read in order, the receive process is
+ *   resumed.
+ * - A frame received after the ring has been emptied is not missed.
+ * .
+ */
+
+static void test_013_001_execute(void) {
+  unsigned i;
+
+  /* Frames are received one at time around the ring three times.*/
+  test_set_step(1);
+  {
+    test_assert(macPollLinkStatus(&ETHD1), "link down");
+    for (i = 0U; i < 3U * STM32_MAC_RECEIVE_BUFFERS; i++) {
+      inject(60U + i, i, 0U);
+      test_assert(receive_check(60U + i, i), "wrong frame");
+    }
+    test_assert(receive_none(), "ring not empty");
+    test_assert(eth_model_counters.received == 3U * STM32_MAC_RECEIVE_BUFFERS,
+                "wrong frames count");
+  }
+
+  /* The ring is filled, the exceeding frame is missed.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i <= STM32_MAC_RECEIVE_BUFFERS; i++) {
+      inject(100U, i, 0U);
+    }
+    test_assert(eth_model_counters.missed == 1U, "frame not missed");
+    test_assert((ETH->DMASR & ETH_DMASR_RPS) == ETH_DMASR_RPS_Suspended,
+                "receive process not suspended");
+  }
+
+  /* The frames in the ring are read in order, the receive process is
+     resumed.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
+      test_assert(receive_check(100U, i), "wrong frame");
+    }
+    test_assert(receive_none(), "ring not empty");
+    test_assert((ETH->DMASR & ETH_DMASR_RPS) != ETH_DMASR_RPS_Suspended,
+                "receive process not resumed");
+  }
+
+  /* A frame received after the ring has been emptied is not missed.*/
+  test_set_step(4);
+  {
+    inject(100U, 99U, 0U);
+    test_assert(receive_check(100U, 99U), "wrong frame");
+    test_assert(eth_model_counters.missed == 1U, "frame missed");
+  }
+}
+
+static const testcase_t test_013_001 = {
+  "receive ring wrap",
+  mac_setup,
+  mac_teardown,
+  test_013_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_013_002 Frames spanning descriptors
+ *
+ * <h2>Description</h2>
+ * Frames of the largest size are received and transmitted, each frame
+ * spans several descriptors and the second one wraps around the ring end.
+ * The frames are accessed both through the streams and the zero-copy
+ * buffers.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A frame is received and read in chunks not aligned to the buffers.
+ * - A frame wrapping around the ring end is read buffer by buffer.
+ * - A frame is transmitted in chunks not aligned to the buffers.
+ * - A frame wrapping around the ring end is transmitted buffer by buffer.
+ * .
+ */
+
+static void test_013_002_execute(void) {
+  MACReceiveDescriptor rd;
+  MACTransmitDescriptor td;
+  size_t n, done;
+
+  /* A frame is received and read in chunks not aligned to the buffers.*/
+  test_set_step(1);
+  {
+    inject(MAX_FRAME, 1U, 0U);
+    test_assert(macWaitReceiveDescriptor(&ETHD1, &rd,
+                                         TIME_IMMEDIATE) == MSG_OK,
+                "frame not received");
+    test_assert(rd.size == MAX_FRAME, "wrong size");
+    test_assert(rd.ndesc == FRAME_DESCRIPTORS, "wrong descriptors count");
+    for (done = 0U; done < MAX_FRAME; done += n) {
+      n = macReadReceiveDescriptor(&rd, &buf[done], 100U);
+      test_assert(n > 0U, "stream ended");
+    }
+    test_assert(macReadReceiveDescriptor(&rd, buf, 1U) == 0U,
+                "stream not ended");
+    macReleaseReceiveDescriptor(&rd);
+    test_assert(memcmp(buf, frame, MAX_FRAME) == 0, "wrong data");
+  }
+
+  /* A frame wrapping around the ring end is read buffer by buffer.*/
+  test_set_step(2);
+  {
+    const uint8_t *p;
+    unsigned buffers = 0U;
+
+    inject(MAX_FRAME, 2U, 0U);
+    test_assert(macWaitReceiveDescriptor(&ETHD1, &rd,
+                                         TIME_IMMEDIATE) == MSG_OK,
+                "frame not received");
+    done = 0U;
+    while ((p = macGetNextReceiveBuffer(&rd, &n)) != NULL) {
+      test_assert(n <= BUFFER_BYTES, "buffer too large");
+      memcpy(&buf[done], p, n);
+      done += n;
+      buffers++;
+    }
+    macReleaseReceiveDescriptor(&rd);
+    test_assert(done == MAX_FRAME, "wrong size");
+    test_assert(buffers == FRAME_DESCRIPTORS, "wrong buffers count");
+    test_assert(memcmp(buf, frame, MAX_FRAME) == 0, "wrong data");
+  }
+
+  /* A frame is transmitted in chunks not aligned to the buffers.*/
+  test_set_step(3);
+  {
+    test_assert(macWaitTransmitDescriptor(&ETHD1, &td,
+                                          TIME_IMMEDIATE) == MSG_OK,
+                "descriptor not available");
+    frame_make(MAX_FRAME, ETHERTYPE_IPV4, 3U);
+    for (done = 0U; done < MAX_FRAME; done += n) {
+      n = MAX_FRAME - done < 100U ? MAX_FRAME - done : 100U;
+      test_assert(macWriteTransmitDescriptor(&td, &frame[done], n) == n,
+                  "stream ended");
+    }
+    macReleaseTransmitDescriptor(&td);
+    test_assert(sent_check(1U, MAX_FRAME, 3U), "wrong frame");
+    test_assert(eth_model_sent.ndesc == FRAME_DESCRIPTORS,
+                "wrong descriptors count");
+  }
+
+  /* A frame wrapping around the ring end is transmitted buffer by
+     buffer.*/
+  test_set_step(4);
+  {
+    uint8_t *p;
+
+    test_assert(macWaitTransmitDescriptor(&ETHD1, &td,
+                                          TIME_IMMEDIATE) == MSG_OK,
+                "descriptor not available");
+    frame_make(MAX_FRAME, ETHERTYPE_IPV4, 4U);
+    for (done = 0U; done < MAX_FRAME; done += n) {
+      p = macGetNextTransmitBuffer(&td, MAX_FRAME - done, &n);
+      test_assert((p != NULL) && (n <= BUFFER_BYTES), "wrong buffer");
+      memcpy(p, &frame[done], n);
+    }
+    macReleaseTransmitDescriptor(&td);
+    test_assert(sent_check(2U, MAX_FRAME, 4U), "wrong frame");
+    test_assert(eth_model_sent.ndesc == FRAME_DESCRIPTORS,
+                "wrong descriptors count");
+  }
+}
+
+static const testcase_t test_013_002 = {
+  "frames spanning descriptors",
+  mac_setup,
+  mac_teardown,
+  test_013_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_013_003 Errored and truncated frames
+ *
+ * <h2>Description</h2>
+ * Frames received with errors are purged from the ring. A frame running
+ * out of descriptors is truncated, it is not returned and its descriptors
+ * are purged when the next frame is received.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Errored frames are discarded, the following frame is received.
+ * - With three frames lent to the application a large frame is
+ *   truncated and not returned.
+ * - After the release of the lent frames the truncated frame is purged
+ *   and the next frame is received.
+ * .
+ */
+
+static void test_013_003_execute(void) {
+  MACReceiveDescriptor rds[3];
+  unsigned i;
+
+  /* Errored frames are discarded, the following frame is received.*/
+  test_set_step(1);
+  {
+    inject(100U, 1U, STM32_RDES0_ES | STM32_RDES0_CE);
+    inject(100U, 2U, STM32_RDES0_AFM);
+    inject(100U, 3U, 0U);
+    test_assert(receive_check(100U, 3U), "wrong frame");
+    test_assert(receive_none(), "ring not empty");
+  }
+
+  /* With three frames lent to the application a large frame is truncated
+     and not returned.*/
+  test_set_step(2);
+  {
+    for (i = 0U; i < 3U; i++) {
+      inject(100U, 4U + i, 0U);
+      test_assert(macWaitReceiveDescriptor(&ETHD1, &rds[i],
+                                           TIME_IMMEDIATE) == MSG_OK,
+                  "frame not received");
+    }
+    inject(MAX_FRAME, 7U, 0U);
+    test_assert(eth_model_counters.truncated == 1U, "frame not truncated");
+    test_assert(receive_none(), "truncated frame returned");
+  }
+
+  /* After the release of the lent frames the truncated frame is purged
+     and the next frame is received.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < 3U; i++) {
+      macReleaseReceiveDescriptor(&rds[i]);
+    }
+    inject(100U, 8U, 0U);
+    test_assert(receive_check(100U, 8U), "wrong frame");
+    test_assert(receive_none(), "ring not empty");
+  }
+}
+
+static const testcase_t test_013_003 = {
+  "errored and truncated frames",
+  mac_setup,
+  mac_teardown,
+  test_013_003_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_013_004 Checksum offload
+ *
+ * <h2>Description</h2>
+ * With the checksum verification enabled the frames flagged with checksum
+ * errors and the frames whose checksum cannot be verified are discarded,
+ * the transmitted frames request the checksum insertion. Without the
+ * offload the checksum status is ignored.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Frames with checksum errors and a frame without an ethertype are
+ *   discarded.
+ * - The transmitted frames request the checksums insertion.
+ * - Without the offload the checksum status is ignored.
+ * .
+ */
+
+static void test_013_004_setup(void) {
+
+  memset(&eth_model_counters, 0, sizeof eth_model_counters);
+  eth_model_tx_hold(false);
+  mac_start(&csumcfg);
+}
+
+static void test_013_004_execute(void) {
+
+  /* Frames with checksum errors and a frame without an ethertype are
+     discarded.*/
+  test_set_step(1);
+  {
+    inject(100U, 1U, STM32_RDES0_IPHCE);
+    inject(100U, 2U, STM32_RDES0_PCE);
+    frame_make(100U, 100U - 14U, 3U);
+    eth_model_receive(frame, 100U, 0U);
+    inject(100U, 4U, 0U);
+    test_assert(receive_check(100U, 4U), "wrong frame");
+    test_assert(receive_none(), "ring not empty");
+  }
+
+  /* The transmitted frames request the checksums insertion.*/
+  test_set_step(2);
+  {
+    test_assert(transmit(100U, 5U, TIME_IMMEDIATE) == MSG_OK,
+                "descriptor not available");
+    test_assert(sent_check(1U, 100U, 5U), "wrong frame");
+    test_assert((eth_model_sent.tdes0 & STM32_TDES0_CIC_MASK) ==
+                STM32_TDES0_CIC(3U), "checksum insertion not requested");
+  }
+
+  /* Without the offload the checksum status is ignored.*/
+  test_set_step(3);
+  {
+    macStop(&ETHD1);
+    mac_start(&config);
+    inject(100U, 6U, STM32_RDES0_IPHCE | STM32_RDES0_PCE);
+    test_assert(receive_check(100U, 6U), "wrong frame");
+    test_assert(transmit(100U, 7U, TIME_IMMEDIATE) == MSG_OK,
+                "descriptor not available");
+    test_assert(sent_check(2U, 100U, 7U), "wrong frame");
+    test_assert((eth_model_sent.tdes0 & STM32_TDES0_CIC_MASK) == 0U,
+                "checksum insertion requested");
+  }
+}
+
+static const testcase_t test_013_004 = {
+  "checksum offload",
+  test_013_004_setup,
+  mac_teardown,
+  test_013_004_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_013_005 Transmit descriptors reservation
+ *
+ * <h2>Description</h2>
+ * The transmit process is held so that the frames remain in the ring,
+ * a transmit descriptor is returned only if the descriptors required by
+ * the largest frame are available and one at time. A thread waiting for
+ * a descriptor is woken up by the transmit interrupt.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - While a descriptor is being composed no other descriptor is
+ *   returned.
+ * - Frames are queued until the free descriptors cannot hold the largest
+ *   frame.
+ * - The transmit process is released, the waiting thread gets a
+ *   descriptor and all the frames are sent.
+ * .
+ */
+
+static void test_013_005_execute(void) {
+  MACTransmitDescriptor td;
+  unsigned n;
+
+  /* While a descriptor is being composed no other descriptor is
+     returned.*/
+  test_set_step(1);
+  {
+    eth_model_tx_hold(true);
+    test_assert(macWaitTransmitDescriptor(&ETHD1, &td,
+                                          TIME_IMMEDIATE) == MSG_OK,
+                "descriptor not available");
+    test_assert(transmit(60U, 0U, TIME_IMMEDIATE) == MSG_TIMEOUT,
+                "second descriptor returned");
+    frame_make(60U, ETHERTYPE_IPV4, 0U);
+    (void)macWriteTransmitDescriptor(&td, frame, 60U);
+    macReleaseTransmitDescriptor(&td);
+  }
+
+  /* Frames are queued until the free descriptors cannot hold the largest
+     frame.*/
+  test_set_step(2);
+  {
+    for (n = 1U; n < STM32_MAC_TRANSMIT_BUFFERS; n++) {
+      if (transmit(60U, n, TIME_IMMEDIATE) != MSG_OK) {
+        break;
+      }
+    }
+    test_assert(n == STM32_MAC_TRANSMIT_BUFFERS - FRAME_DESCRIPTORS + 1U,
+                "wrong frames count");
+    test_assert(eth_model_counters.sent == 0U, "frames sent");
+  }
+
+  /* The transmit process is released, the waiting thread gets a
+     descriptor and all the frames are sent.*/
+  test_set_step(3);
+  {
+    eth_model_tx_hold(false);
+    test_assert(transmit(60U, n, MS2ST(100)) == MSG_OK,
+                "descriptor not available");
+    test_assert(sent_check(n + 1U, 60U, n), "wrong frame");
+  }
+}
+
+static const testcase_t test_013_005 = {
+  "transmit descriptors reservation",
+  mac_setup,
+  mac_teardown,
+  test_013_005_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_013_006 Lent receive descriptors
+ *
+ * <h2>Description</h2>
+ * The descriptors of a frame returned to the application and not yet
+ * released stop both the DMA and the ring scan, when the ring wraps the
+ * frame is not overwritten and not returned twice.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A frame is received and not released.
+ * - The ring is filled, the frame reaching the lent descriptor is missed.
+ * - The other frames are read in order, the lent frame is not returned
+ *   again.
+ * - After the release a new frame is received.
+ * .
+ */
+
+static void test_013_006_execute(void) {
+  MACReceiveDescriptor rd;
+  unsigned i;
+
+  /* A frame is received and not released.*/
+  test_set_step(1);
+  {
+    inject(100U, 0U, 0U);
+    test_assert(macWaitReceiveDescriptor(&ETHD1, &rd,
+                                         TIME_IMMEDIATE) == MSG_OK,
+                "frame not received");
+  }
+
+  /* The ring is filled, the frame reaching the lent descriptor is
+     missed.*/
+  test_set_step(2);
+  {
+    for (i = 1U; i <= STM32_MAC_RECEIVE_BUFFERS; i++) {
+      inject(100U, i, 0U);
+    }
+    test_assert(eth_model_counters.received == STM32_MAC_RECEIVE_BUFFERS,
+                "wrong frames count");
+    test_assert(eth_model_counters.missed == 1U, "frame not missed");
+  }
+
+  /* The other frames are read in order, the lent frame is not returned
+     again.*/
+  test_set_step(3);
+  {
+    for (i = 1U; i < STM32_MAC_RECEIVE_BUFFERS; i++) {
+      test_assert(receive_check(100U, i), "wrong frame");
+    }
+    test_assert(receive_none(), "lent frame returned");
+  }
+
+  /* After the release a new frame is received.*/
+  test_set_step(4);
+  {
+    frame_make(100U, ETHERTYPE_IPV4, 0U);
+    test_assert(macReadReceiveDescriptor(&rd, buf, sizeof buf) == 100U,
+                "wrong size");
+    test_assert(memcmp(buf, frame, 100U) == 0, "lent frame overwritten");
+    macReleaseReceiveDescriptor(&rd);
+    inject(100U, 99U, 0U);
+    test_assert(receive_check(100U, 99U), "wrong frame");
+  }
+}
+
+static const testcase_t test_013_006 = {
+  "lent receive descriptors",
+  mac_setup,
+  mac_teardown,
+  test_013_006_execute
+};
+#endif /* TRUE */
+
+#if MAC_USE_RX_MITIGATION || defined(__DOXYGEN__)
+/**
+ * @page test_013_007 Receive interrupt mitigation
+ *
+ * <h2>Description</h2>
+ * The receive interrupt is disabled by the first received frame until
+ * the ring is emptied, a transmit interrupt served meanwhile is not
+ * accounted as a receive interrupt.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - MAC_USE_RX_MITIGATION
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - Two frames are received with a single receive interrupt.
+ * - A transmit interrupt is not accounted as a receive interrupt.
+ * - The frames are read in a single burst, the receive interrupt is
+ *   enabled again.
+ * - The next frame raises a receive interrupt.
+ * .
+ */
+
+static void test_013_007_execute(void) {
+  mac_rx_stats_t *sp = macGetReceiveStatistics(&ETHD1);
+  uint32_t interrupts = sp->interrupts, frames = sp->frames;
+
+  /* Two frames are received with a single receive interrupt.*/
+  test_set_step(1);
+  {
+    inject(100U, 1U, 0U);
+    inject(100U, 2U, 0U);
+    test_assert(sp->interrupts == interrupts + 1U, "wrong interrupts");
+    test_assert(eth_model_counters.irqs == 1U, "wrong model interrupts");
+    test_assert((ETH->DMAIER & ETH_DMAIER_RIE) == 0U,
+                "receive interrupt enabled");
+  }
+
+  /* A transmit interrupt is not accounted as a receive interrupt.*/
+  test_set_step(2);
+  {
+    test_assert(transmit(60U, 3U, TIME_IMMEDIATE) == MSG_OK,
+                "descriptor not available");
+    test_assert(sent_check(1U, 60U, 3U), "wrong frame");
+    test_assert(eth_model_counters.irqs == 2U, "wrong model interrupts");
+    test_assert(sp->interrupts == interrupts + 1U,
+                "transmit interrupt accounted");
+  }
+
+  /* The frames are read in a single burst, the receive interrupt is
+     enabled again.*/
+  test_set_step(3);
+  {
+    test_assert(receive_check(100U, 1U), "wrong frame");
+    test_assert(receive_check(100U, 2U), "wrong frame");
+    test_assert(receive_none(), "ring not empty");
+    test_assert((sp->frames == frames + 2U) && (sp->burst == 2U),
+                "wrong burst");
+    test_assert((ETH->DMAIER & ETH_DMAIER_RIE) != 0U,
+                "receive interrupt disabled");
+  }
+
+  /* The next frame raises a receive interrupt.*/
+  test_set_step(4);
+  {
+    inject(100U, 4U, 0U);
+    test_assert(sp->interrupts == interrupts + 2U, "wrong interrupts");
+    test_assert(receive_check(100U, 4U), "wrong frame");
+  }
+}
+
+static const testcase_t test_013_007 = {
+  "receive interrupt mitigation",
+  mac_setup,
+  mac_teardown,
+  test_013_007_execute
+};
+#endif /* MAC_USE_RX_MITIGATION */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   STM32 MAC driver.
+ */
+const testcase_t * const test_sequence_013[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_013_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_013_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_013_003,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_013_004,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_013_005,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_013_006,
+#endif
+#if MAC_USE_RX_MITIGATION || defined(__DOXYGEN__)
+  &test_013_007,
+#endif
+  NULL
+};
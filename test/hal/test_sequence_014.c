@@ -0,0 +1,555 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+#include "mmc_model.h"
+
+/**
+ * @page test_sequence_014 MMC over SPI driver
+ *
+ * File: @ref test_sequence_014.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the MMC over SPI driver on the SD card model
+ * attached to the simulated SPI bus. The model checks the CRC of the
+ * commands and of the data blocks, CRC errors are injected in order to
+ * exercise the retry paths of the driver. The transfer rates are computed
+ * on the simulated bus timeline.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_014_001
+ * - @subpage test_014_002
+ * - @subpage test_014_003
+ * - @subpage test_014_004
+ * - @subpage test_014_005
+ * - @subpage test_014_006
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+/* Simulated bus clocks of 400kHz and 8MHz.*/
+#define SLOW_WORD_TIME          20000U
+#define FAST_WORD_TIME          1000U
+
+#define TEST_BLOCKS             8U
+
+static const SPIConfig lscfg = {
+  NULL,
+  SLOW_WORD_TIME
+};
+
+static const SPIConfig hscfg = {
+  NULL,
+  FAST_WORD_TIME
+};
+
+static const MMCConfig mmccfg = {
+  &SPID1,
+  &lscfg,
+  &hscfg
+};
+
+static MMCDriver mmcd;
+static uint8_t buf[TEST_BLOCKS * MMCSD_BLOCK_SIZE];
+
+/*
+ * Fills blocks with a pattern depending on the block number and a seed.
+ */
+static void fill(uint8_t *p, uint32_t blk, uint32_t n, uint8_t seed) {
+  uint32_t i;
+
+  for (i = 0U; i < n * MMCSD_BLOCK_SIZE; i++) {
+    p[i] = (uint8_t)((blk + (i / MMCSD_BLOCK_SIZE)) * 7U + i + seed);
+  }
+}
+
+/*
+ * Checks blocks against the pattern.
+ */
+static bool check(const uint8_t *p, uint32_t blk, uint32_t n, uint8_t seed) {
+  uint32_t i;
+
+  for (i = 0U; i < n * MMCSD_BLOCK_SIZE; i++) {
+    if (p[i] != (uint8_t)((blk + (i / MMCSD_BLOCK_SIZE)) * 7U + i + seed)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Inserts a card and connects it.
+ */
+static bool connect(bool hc) {
+
+  mmc_model_insert(&SPID1, hc);
+  return mmcConnect(&mmcd) == HAL_SUCCESS;
+}
+
+static void mmc_setup(void) {
+
+  mmcObjectInit(&mmcd);
+  mmcStart(&mmcd, &mmccfg);
+}
+
+static void mmc_teardown(void) {
+
+  (void) mmcDisconnect(&mmcd);
+  mmcStop(&mmcd);
+  mmc_model_remove(&SPID1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_014_001 Card initialization
+ *
+ * <h2>Description</h2>
+ * High capacity and standard capacity cards are initialized, the
+ * addressing mode and the capacity are detected.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A high capacity card is connected, block addressing is used.
+ * - A standard capacity card is connected, byte addressing is used.
+ * .
+ */
+
+static void test_014_001_execute(void) {
+  BlockDeviceInfo bdi;
+
+  /* A high capacity card is connected, block addressing is used.*/
+  test_set_step(1);
+  {
+    test_assert(connect(true), "connection failed");
+    test_assert(mmcd.block_addresses, "byte addressing");
+    test_assert(mmcGetInfo(&mmcd, &bdi) == HAL_SUCCESS, "no info");
+    test_assert(bdi.blk_num == MMC_MODEL_BLOCKS, "wrong capacity");
+    test_assert(bdi.blk_size == MMCSD_BLOCK_SIZE, "wrong block size");
+#if MMC_USE_DATA_CRC == TRUE
+    test_assert(mmc_model.commands[MMCSD_CMD_CRC_ON_OFF] == 1U,
+                "CRC not enabled");
+#endif
+    test_assert(mmcDisconnect(&mmcd) == HAL_SUCCESS, "disconnection failed");
+  }
+
+  /* A standard capacity card is connected, byte addressing is used.*/
+  test_set_step(2);
+  {
+    test_assert(connect(false), "connection failed");
+    test_assert(!mmcd.block_addresses, "block addressing");
+    test_assert(mmcGetInfo(&mmcd, &bdi) == HAL_SUCCESS, "no info");
+    test_assert(bdi.blk_num == MMC_MODEL_BLOCKS, "wrong capacity");
+  }
+}
+
+static const testcase_t test_014_001 = {
+  "card initialization",
+  mmc_setup,
+  mmc_teardown,
+  test_014_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_014_002 Multiple blocks transfers
+ *
+ * <h2>Description</h2>
+ * Blocks are written and read back with single multiple blocks
+ * operations on both cards types.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Blocks are written and read back on a high capacity card.
+ * - Blocks are written and read back on a standard capacity card.
+ * .
+ */
+
+static void test_014_002_execute(void) {
+  unsigned i;
+
+  for (i = 0U; i < 2U; i++) {
+    bool hc = i == 0U;
+
+    /* Blocks are written and read back on a high capacity card, then on
+       a standard capacity card.*/
+    test_set_step(i + 1U);
+    {
+      test_assert(connect(hc), "connection failed");
+      fill(buf, 100U, TEST_BLOCKS, (uint8_t)i);
+      test_assert(blkWrite(&mmcd, 100U, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                  "write failed");
+      test_assert(mmc_model.blocks_written == TEST_BLOCKS,
+                  "wrong blocks count");
+      test_assert(check(mmc_model.data[100], 100U, TEST_BLOCKS, (uint8_t)i),
+                  "wrong card data");
+      memset(buf, 0, sizeof buf);
+      test_assert(blkRead(&mmcd, 100U, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                  "read failed");
+      test_assert(check(buf, 100U, TEST_BLOCKS, (uint8_t)i), "wrong data");
+      test_assert(mmc_model.commands[MMCSD_CMD_WRITE_MULTIPLE_BLOCK] == 1U,
+                  "wrong write commands count");
+      test_assert(mmc_model.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] == 1U,
+                  "wrong read commands count");
+      test_assert(mmc_model.protocol_errors == 0U, "protocol error");
+      test_assert(mmcDisconnect(&mmcd) == HAL_SUCCESS,
+                  "disconnection failed");
+    }
+  }
+}
+
+static const testcase_t test_014_002 = {
+  "multiple blocks transfers",
+  mmc_setup,
+  mmc_teardown,
+  test_014_002_execute
+};
+#endif /* TRUE */
+
+#if MMC_USE_DATA_CRC || defined(__DOXYGEN__)
+/**
+ * @page test_014_003 Commands CRC errors
+ *
+ * <h2>Description</h2>
+ * The card receives corrupted command frames, the commands are sent again
+ * up to @p MMC_CRC_RETRY times.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - MMC_USE_DATA_CRC
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - Two corrupted commands, the read succeeds.
+ * - The command is corrupted more times than retried, the read fails.
+ * - The card is still usable.
+ * .
+ */
+
+static void test_014_003_execute(void) {
+
+  test_assert(connect(true), "connection failed");
+  fill(mmc_model.data[10], 10U, 1U, 0U);
+
+  /* Two corrupted commands, the read succeeds.*/
+  test_set_step(1);
+  {
+    mmc_model.cmd_crc_faults = 2U;
+    test_assert(blkRead(&mmcd, 10U, buf, 1U) == HAL_SUCCESS, "read failed");
+    test_assert(check(buf, 10U, 1U, 0U), "wrong data");
+    test_assert(mmc_model.cmd_crc_errors == 2U, "wrong errors count");
+    test_assert(mmc_model.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] == 1U,
+                "wrong commands count");
+  }
+
+  /* The command is corrupted more times than retried, the read fails.*/
+  test_set_step(2);
+  {
+    mmc_model.cmd_crc_faults = MMC_CRC_RETRY + 1U;
+    test_assert(blkRead(&mmcd, 10U, buf, 1U) == HAL_FAILED, "read succeeded");
+    test_assert(mmc_model.cmd_crc_errors == 2U + MMC_CRC_RETRY + 1U,
+                "wrong errors count");
+    test_assert(mmcd.state == BLK_READY, "wrong state");
+  }
+
+  /* The card is still usable.*/
+  test_set_step(3);
+  {
+    memset(buf, 0, MMCSD_BLOCK_SIZE);
+    test_assert(blkRead(&mmcd, 10U, buf, 1U) == HAL_SUCCESS, "read failed");
+    test_assert(check(buf, 10U, 1U, 0U), "wrong data");
+    test_assert(mmc_model.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_014_003 = {
+  "commands CRC errors",
+  mmc_setup,
+  mmc_teardown,
+  test_014_003_execute
+};
+#endif /* MMC_USE_DATA_CRC */
+
+#if MMC_USE_DATA_CRC || defined(__DOXYGEN__)
+/**
+ * @page test_014_004 Read CRC errors
+ *
+ * <h2>Description</h2>
+ * The card sends data blocks with a wrong CRC, the transmission is
+ * restarted from the failed block up to @p MMC_CRC_RETRY times.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - MMC_USE_DATA_CRC
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - Two blocks with a wrong CRC, the read succeeds.
+ * - A block fails more times than retried, the read fails.
+ * - The card is still usable.
+ * .
+ */
+
+static void test_014_004_execute(void) {
+
+  test_assert(connect(true), "connection failed");
+  fill(mmc_model.data[200], 200U, TEST_BLOCKS, 1U);
+
+  /* Two blocks with a wrong CRC, the read succeeds.*/
+  test_set_step(1);
+  {
+    mmc_model.read_crc_faults = 2U;
+    test_assert(blkRead(&mmcd, 200U, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(buf, 200U, TEST_BLOCKS, 1U), "wrong data");
+    test_assert(mmc_model.read_crc_faults == 0U, "faults left");
+    test_assert(mmc_model.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] == 3U,
+                "wrong read commands count");
+    test_assert(mmc_model.commands[MMCSD_CMD_STOP_TRANSMISSION] == 3U,
+                "wrong stop commands count");
+  }
+
+  /* A block fails more times than retried, the read fails.*/
+  test_set_step(2);
+  {
+    mmc_model.read_crc_faults = MMC_CRC_RETRY + 1U;
+    test_assert(blkRead(&mmcd, 200U, buf, TEST_BLOCKS) == HAL_FAILED,
+                "read succeeded");
+    test_assert(mmc_model.read_crc_faults == 0U, "faults left");
+    test_assert(mmc_model.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] ==
+                3U + MMC_CRC_RETRY + 1U, "wrong read commands count");
+    test_assert(mmcd.state == BLK_READY, "wrong state");
+  }
+
+  /* The card is still usable.*/
+  test_set_step(3);
+  {
+    memset(buf, 0, sizeof buf);
+    test_assert(blkRead(&mmcd, 200U, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(buf, 200U, TEST_BLOCKS, 1U), "wrong data");
+    test_assert(mmc_model.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_014_004 = {
+  "read CRC errors",
+  mmc_setup,
+  mmc_teardown,
+  test_014_004_execute
+};
+#endif /* MMC_USE_DATA_CRC */
+
+#if MMC_USE_DATA_CRC || defined(__DOXYGEN__)
+/**
+ * @page test_014_005 Write CRC errors
+ *
+ * <h2>Description</h2>
+ * The card receives corrupted data blocks and rejects them, the
+ * transmission is restarted from the rejected block up to
+ * @p MMC_CRC_RETRY times.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - MMC_USE_DATA_CRC
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - Two blocks are rejected, the write succeeds.
+ * - A block is rejected more times than retried, the write fails.
+ * - The card is still usable.
+ * .
+ */
+
+static void test_014_005_execute(void) {
+
+  test_assert(connect(true), "connection failed");
+
+  /* Two blocks are rejected, the write succeeds.*/
+  test_set_step(1);
+  {
+    mmc_model.write_crc_faults = 2U;
+    fill(buf, 300U, TEST_BLOCKS, 2U);
+    test_assert(blkWrite(&mmcd, 300U, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(mmc_model.data[300], 300U, TEST_BLOCKS, 2U),
+                "wrong card data");
+    test_assert(mmc_model.data_crc_errors == 2U, "wrong errors count");
+    test_assert(mmc_model.blocks_written == TEST_BLOCKS,
+                "wrong blocks count");
+    test_assert(mmc_model.commands[MMCSD_CMD_WRITE_MULTIPLE_BLOCK] == 3U,
+                "wrong write commands count");
+  }
+
+  /* A block is rejected more times than retried, the write fails.*/
+  test_set_step(2);
+  {
+    mmc_model.write_crc_faults = MMC_CRC_RETRY + 1U;
+    test_assert(blkWrite(&mmcd, 300U, buf, TEST_BLOCKS) == HAL_FAILED,
+                "write succeeded");
+    test_assert(mmc_model.data_crc_errors == 2U + MMC_CRC_RETRY + 1U,
+                "wrong errors count");
+    test_assert(mmcd.state == BLK_READY, "wrong state");
+  }
+
+  /* The card is still usable.*/
+  test_set_step(3);
+  {
+    fill(buf, 300U, TEST_BLOCKS, 3U);
+    test_assert(blkWrite(&mmcd, 300U, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(mmc_model.data[300], 300U, TEST_BLOCKS, 3U),
+                "wrong card data");
+    test_assert(mmc_model.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_014_005 = {
+  "write CRC errors",
+  mmc_setup,
+  mmc_teardown,
+  test_014_005_execute
+};
+#endif /* MMC_USE_DATA_CRC */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_014_006 Benchmark
+ *
+ * <h2>Description</h2>
+ * Multiple blocks writes and reads are executed, the blocks/s and KB/s
+ * scores are computed on the simulated bus time. The bus is clocked at
+ * 8MHz, the raw bus rate is 1953 blocks/s.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Sequential multiple blocks writes.
+ * - Sequential multiple blocks reads.
+ * .
+ */
+
+#define BMK_BLOCKS              256U
+
+/* Minimum score, 70% of the raw bus rate.*/
+#define BMK_MIN_SCORE           ((1000000000U / (MMCSD_BLOCK_SIZE *        \
+                                                 FAST_WORD_TIME)) * 7U / 10U)
+
+static uint32_t print_score(const char *name, uint32_t time) {
+  uint32_t bps, kbs10;
+
+  bps   = (uint32_t)(((uint64_t)BMK_BLOCKS * 1000000000U) / time);
+  kbs10 = (bps * MMCSD_BLOCK_SIZE * 10U) / 1024U;
+  test_print("--- ");
+  test_print(name);
+  test_printn(bps);
+  test_print(" blocks/S, ");
+  test_printn(kbs10 / 10U);
+  test_print(".");
+  test_printn(kbs10 % 10U);
+  test_println(" KB/S");
+
+  return bps;
+}
+
+static void test_014_006_execute(void) {
+  uint32_t i, time;
+
+  test_assert(connect(true), "connection failed");
+
+  /* Sequential multiple blocks writes.*/
+  test_set_step(1);
+  {
+    time = SPID1.time;
+    for (i = 0U; i < BMK_BLOCKS; i += TEST_BLOCKS) {
+      fill(buf, i, TEST_BLOCKS, 4U);
+      test_assert(blkWrite(&mmcd, i, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                  "write failed");
+    }
+    test_assert(blkSync(&mmcd) == HAL_SUCCESS, "sync failed");
+    test_assert(print_score("Write : ", SPID1.time - time) >= BMK_MIN_SCORE,
+                "write too slow");
+  }
+
+  /* Sequential multiple blocks reads.*/
+  test_set_step(2);
+  {
+    time = SPID1.time;
+    for (i = 0U; i < BMK_BLOCKS; i += TEST_BLOCKS) {
+      test_assert(blkRead(&mmcd, i, buf, TEST_BLOCKS) == HAL_SUCCESS,
+                  "read failed");
+      test_assert(check(buf, i, TEST_BLOCKS, 4U), "wrong data");
+    }
+    test_assert(print_score("Read  : ", SPID1.time - time) >= BMK_MIN_SCORE,
+                "read too slow");
+  }
+}
+
+static const testcase_t test_014_006 = {
+  "benchmark",
+  mmc_setup,
+  mmc_teardown,
+  test_014_006_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   MMC over SPI driver.
+ */
+const testcase_t * const test_sequence_014[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_014_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_014_002,
+#endif
+#if MMC_USE_DATA_CRC || defined(__DOXYGEN__)
+  &test_014_003,
+#endif
+#if MMC_USE_DATA_CRC || defined(__DOXYGEN__)
+  &test_014_004,
+#endif
+#if MMC_USE_DATA_CRC || defined(__DOXYGEN__)
+  &test_014_005,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_014_006,
+#endif
+  NULL
+};
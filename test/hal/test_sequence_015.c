@@ -0,0 +1,743 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "hal.h"
+#include "ch_test.h"
+#include "test_root.h"
+
+/**
+ * @page test_sequence_015 STM32 SDC driver
+ *
+ * File: @ref test_sequence_015.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the STM32 SDIOv1 SDC driver on the SDIO cell and SD
+ * card models. CRC errors are injected in the responses and in the data
+ * blocks in order to exercise the retry path of the driver, the card clock
+ * divider recorded by the model at each data transfer verifies the clock
+ * step-down performed before each retry.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage test_015_001
+ * - @subpage test_015_002
+ * - @subpage test_015_003
+ * - @subpage test_015_004
+ * - @subpage test_015_005
+ * - @subpage test_015_006
+ * - @subpage test_015_007
+ * - @subpage test_015_008
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define TEST_BLOCKS             8U
+
+/* Blocks of the unaligned transfers, not a multiple of the driver
+   bounce buffer.*/
+#define UNALIGNED_BLOCKS        ((2U * STM32_SDC_SDIO_UNALIGNED_BLOCKS) + 2U)
+
+static union {
+  uint32_t  alignment;
+  uint8_t   buf[(UNALIGNED_BLOCKS * MMCSD_BLOCK_SIZE) + 4U];
+} u;
+
+/*
+ * Fills blocks with a pattern depending on the block number and a seed.
+ */
+static void fill(uint8_t *p, uint32_t blk, uint32_t n, uint8_t seed) {
+  uint32_t i;
+
+  for (i = 0U; i < n * MMCSD_BLOCK_SIZE; i++) {
+    p[i] = (uint8_t)((blk + (i / MMCSD_BLOCK_SIZE)) * 7U + i + seed);
+  }
+}
+
+/*
+ * Checks blocks against the pattern.
+ */
+static bool check(const uint8_t *p, uint32_t blk, uint32_t n, uint8_t seed) {
+  uint32_t i;
+
+  for (i = 0U; i < n * MMCSD_BLOCK_SIZE; i++) {
+    if (p[i] != (uint8_t)((blk + (i / MMCSD_BLOCK_SIZE)) * 7U + i + seed)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Checks the card clock dividers of the data transfers following the
+ * first ones, no other transfer is expected.
+ */
+static bool clkdivs_check(uint32_t first, const uint32_t *divs, uint32_t n) {
+  uint32_t i;
+
+  if (sdio_model_card.transfers != first + n) {
+    return false;
+  }
+  for (i = 0U; i < n; i++) {
+    if (sdio_model_card.clkdivs[first + i] != divs[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Inserts a card and connects it.
+ */
+static bool connect(bool hc) {
+
+  sdio_model_insert(hc);
+  return sdcConnect(&SDCD1) == HAL_SUCCESS;
+}
+
+static void sdc_setup(void) {
+
+  sdcStart(&SDCD1, NULL);
+}
+
+static void sdc_teardown(void) {
+
+  (void) sdcDisconnect(&SDCD1);
+  sdcStop(&SDCD1);
+  sdio_model_remove();
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_001 Card initialization
+ *
+ * <h2>Description</h2>
+ * High capacity and standard capacity cards are initialized, the
+ * addressing mode, the capacity and the bus width are detected and the
+ * data clock runs at full speed.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - A high capacity card is connected, the switch functions are read.
+ * - A standard capacity card is connected.
+ * .
+ */
+
+static void test_015_001_execute(void) {
+
+  /* A high capacity card is connected, the switch functions are read.*/
+  test_set_step(1);
+  {
+    static const uint32_t divs[] = {STM32_SDIO_DIV_LS, STM32_SDIO_DIV_LS};
+
+    test_assert(connect(true), "connection failed");
+    test_assert((SDCD1.cardmode & SDC_MODE_HIGH_CAPACITY) != 0U,
+                "not high capacity");
+    test_assert(SDCD1.capacity == SDIO_MODEL_BLOCKS, "wrong capacity");
+    test_assert((SDIO->CLKCR & SDIO_CLKCR_WIDBUS) == SDIO_CLKCR_WIDBUS_0,
+                "not 4 bits mode");
+    test_assert(SDCD1.clkdiv == STM32_SDIO_DIV_HS, "wrong clock divider");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_APP_OP_COND] ==
+                SDIO_MODEL_INIT_POLLS + 1U, "wrong init commands count");
+    test_assert(clkdivs_check(0U, divs, 2U), "wrong transfers");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+    test_assert(sdcDisconnect(&SDCD1) == HAL_SUCCESS, "disconnection failed");
+  }
+
+  /* A standard capacity card is connected.*/
+  test_set_step(2);
+  {
+    test_assert(connect(false), "connection failed");
+    test_assert((SDCD1.cardmode & SDC_MODE_HIGH_CAPACITY) == 0U,
+                "high capacity");
+    test_assert(SDCD1.capacity == SDIO_MODEL_BLOCKS, "wrong capacity");
+    test_assert(SDCD1.clkdiv == STM32_SDIO_DIV_HS, "wrong clock divider");
+    test_assert(sdio_model_card.transfers == 0U, "unexpected transfers");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_001 = {
+  "card initialization",
+  sdc_setup,
+  sdc_teardown,
+  test_015_001_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_002 Blocks transfers
+ *
+ * <h2>Description</h2>
+ * Single and multiple blocks are written and read back at full speed on
+ * both card types.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Multiple blocks are written and read back on a high capacity card.
+ * - A single block is written and read back on a high capacity card.
+ * - Blocks are written and read back on a standard capacity card, byte
+ *   addressing is used.
+ * .
+ */
+
+static void test_015_002_execute(void) {
+  static const uint32_t divs[] = {STM32_SDIO_DIV_HS, STM32_SDIO_DIV_HS};
+  uint32_t first;
+
+  test_assert(connect(true), "connection failed");
+  first = sdio_model_card.transfers;
+
+  /* Multiple blocks are written and read back on a high capacity card.*/
+  test_set_step(1);
+  {
+    fill(u.buf, 100U, TEST_BLOCKS, 1U);
+    test_assert(sdcWrite(&SDCD1, 100U, u.buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(sdio_model_card.data[100], 100U, TEST_BLOCKS, 1U),
+                "wrong card data");
+    memset(u.buf, 0, sizeof u.buf);
+    test_assert(sdcRead(&SDCD1, 100U, u.buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 100U, TEST_BLOCKS, 1U), "wrong data");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_WRITE_MULTIPLE_BLOCK] == 1U,
+                "wrong write commands count");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] == 1U,
+                "wrong read commands count");
+    test_assert(clkdivs_check(first, divs, 2U), "wrong transfers");
+  }
+
+  /* A single block is written and read back on a high capacity card.*/
+  test_set_step(2);
+  {
+    fill(u.buf, 7U, 1U, 2U);
+    test_assert(sdcWrite(&SDCD1, 7U, u.buf, 1U) == HAL_SUCCESS,
+                "write failed");
+    memset(u.buf, 0, sizeof u.buf);
+    test_assert(sdcRead(&SDCD1, 7U, u.buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 7U, 1U, 2U), "wrong data");
+    test_assert(check(sdio_model_card.data[7], 7U, 1U, 2U),
+                "wrong card data");
+    test_assert(sdio_model_card.blocks_written == TEST_BLOCKS + 1U,
+                "wrong written blocks count");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+
+  /* Blocks are written and read back on a standard capacity card, byte
+     addressing is used.*/
+  test_set_step(3);
+  {
+    test_assert(sdcDisconnect(&SDCD1) == HAL_SUCCESS, "disconnection failed");
+    test_assert(connect(false), "connection failed");
+    fill(u.buf, 5U, 2U, 3U);
+    test_assert(sdcWrite(&SDCD1, 5U, u.buf, 2U) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(sdio_model_card.data[5], 5U, 2U, 3U),
+                "wrong card data");
+    memset(u.buf, 0, sizeof u.buf);
+    test_assert(sdcRead(&SDCD1, 5U, u.buf, 2U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 5U, 2U, 3U), "wrong data");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_002 = {
+  "blocks transfers",
+  sdc_setup,
+  sdc_teardown,
+  test_015_002_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_003 Read CRC errors
+ *
+ * <h2>Description</h2>
+ * The card sends data blocks with a wrong CRC, the read is retried up to
+ * @p STM32_SDC_SDIO_CRC_RETRIES times and the card clock divider is
+ * stepped down before each retry. The reduced clock is kept until the
+ * next connection.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Two transfers fail with a CRC error, the read succeeds at the third
+ *   divider.
+ * - The following read runs at the reduced clock.
+ * - The transfers fail more times than retried, the read fails.
+ * - The full speed is restored on the next connection.
+ * .
+ */
+
+static void test_015_003_execute(void) {
+  uint32_t first;
+
+  test_assert(connect(true), "connection failed");
+  fill(sdio_model_card.data[200], 200U, TEST_BLOCKS, 1U);
+  first = sdio_model_card.transfers;
+
+  /* Two transfers fail with a CRC error, the read succeeds at the third
+     divider.*/
+  test_set_step(1);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U};
+
+    sdio_model_card.read_crc_faults = 2U;
+    test_assert(sdcRead(&SDCD1, 200U, u.buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 200U, TEST_BLOCKS, 1U), "wrong data");
+    test_assert(sdio_model_card.read_crc_faults == 0U, "faults left");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] == 3U,
+                "wrong read commands count");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_STOP_TRANSMISSION] == 3U,
+                "wrong stop commands count");
+    test_assert(clkdivs_check(first, divs, 3U), "wrong clock dividers");
+    test_assert((sdcGetAndClearErrors(&SDCD1) & SDC_DATA_CRC_ERROR) != 0U,
+                "error not reported");
+  }
+
+  /* The following read runs at the reduced clock.*/
+  test_set_step(2);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U, 6U};
+
+    memset(u.buf, 0, sizeof u.buf);
+    test_assert(sdcRead(&SDCD1, 200U, u.buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 200U, TEST_BLOCKS, 1U), "wrong data");
+    test_assert(SDCD1.clkdiv == 6U, "wrong clock divider");
+    test_assert(clkdivs_check(first, divs, 4U), "wrong clock dividers");
+  }
+
+  /* The transfers fail more times than retried, the read fails.*/
+  test_set_step(3);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U, 6U, 6U, 14U, 30U};
+
+    sdio_model_card.read_crc_faults = STM32_SDC_SDIO_CRC_RETRIES + 1U;
+    test_assert(sdcRead(&SDCD1, 200U, u.buf, TEST_BLOCKS) == HAL_FAILED,
+                "read succeeded");
+    test_assert(sdio_model_card.read_crc_faults == 0U, "faults left");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] ==
+                4U + STM32_SDC_SDIO_CRC_RETRIES + 1U,
+                "wrong read commands count");
+    test_assert(clkdivs_check(first, divs, 7U), "wrong clock dividers");
+    test_assert(SDCD1.state == BLK_READY, "wrong state");
+    test_assert((sdcGetAndClearErrors(&SDCD1) & SDC_DATA_CRC_ERROR) != 0U,
+                "error not reported");
+  }
+
+  /* The full speed is restored on the next connection.*/
+  test_set_step(4);
+  {
+    test_assert(sdcDisconnect(&SDCD1) == HAL_SUCCESS, "disconnection failed");
+    test_assert(sdcConnect(&SDCD1) == HAL_SUCCESS, "connection failed");
+    test_assert(SDCD1.clkdiv == STM32_SDIO_DIV_HS, "wrong clock divider");
+    memset(u.buf, 0, sizeof u.buf);
+    test_assert(sdcRead(&SDCD1, 200U, u.buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 200U, TEST_BLOCKS, 1U), "wrong data");
+    test_assert(sdio_model_card.clkdivs[sdio_model_card.transfers - 1U] ==
+                STM32_SDIO_DIV_HS, "wrong clock divider");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_003 = {
+  "read CRC errors",
+  sdc_setup,
+  sdc_teardown,
+  test_015_003_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_004 Write CRC errors
+ *
+ * <h2>Description</h2>
+ * The card receives data blocks with a wrong CRC, the write is retried
+ * up to @p STM32_SDC_SDIO_CRC_RETRIES times and the card clock divider is
+ * stepped down before each retry.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Two multiple blocks transfers fail with a CRC error, the write
+ *   succeeds at the third divider.
+ * - A single block transfer fails with a CRC error, the write succeeds
+ *   at the next divider.
+ * - The transfers fail more times than retried, the write fails.
+ * .
+ */
+
+static void test_015_004_execute(void) {
+  uint32_t first;
+
+  test_assert(connect(true), "connection failed");
+  first = sdio_model_card.transfers;
+
+  /* Two multiple blocks transfers fail with a CRC error, the write
+     succeeds at the third divider.*/
+  test_set_step(1);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U};
+
+    fill(u.buf, 300U, TEST_BLOCKS, 2U);
+    sdio_model_card.write_crc_faults = 2U;
+    test_assert(sdcWrite(&SDCD1, 300U, u.buf, TEST_BLOCKS) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(sdio_model_card.data[300], 300U, TEST_BLOCKS, 2U),
+                "wrong card data");
+    test_assert(sdio_model_card.write_crc_faults == 0U, "faults left");
+    test_assert(sdio_model_card.data_crc_errors == 2U, "wrong errors count");
+    test_assert(sdio_model_card.blocks_written == TEST_BLOCKS,
+                "wrong written blocks count");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_WRITE_MULTIPLE_BLOCK] == 3U,
+                "wrong write commands count");
+    test_assert(clkdivs_check(first, divs, 3U), "wrong clock dividers");
+    test_assert((sdcGetAndClearErrors(&SDCD1) & SDC_DATA_CRC_ERROR) != 0U,
+                "error not reported");
+  }
+
+  /* A single block transfer fails with a CRC error, the write succeeds
+     at the next divider.*/
+  test_set_step(2);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U, 6U, 14U};
+
+    fill(u.buf, 50U, 1U, 3U);
+    sdio_model_card.write_crc_faults = 1U;
+    test_assert(sdcWrite(&SDCD1, 50U, u.buf, 1U) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(sdio_model_card.data[50], 50U, 1U, 3U),
+                "wrong card data");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_WRITE_BLOCK] == 2U,
+                "wrong write commands count");
+    test_assert(clkdivs_check(first, divs, 5U), "wrong clock dividers");
+  }
+
+  /* The transfers fail more times than retried, the write fails.*/
+  test_set_step(3);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U, 6U, 14U, 14U, 30U, 62U};
+
+    fill(u.buf, 300U, TEST_BLOCKS, 4U);
+    sdio_model_card.write_crc_faults = STM32_SDC_SDIO_CRC_RETRIES + 1U;
+    test_assert(sdcWrite(&SDCD1, 300U, u.buf, TEST_BLOCKS) == HAL_FAILED,
+                "write succeeded");
+    test_assert(sdio_model_card.write_crc_faults == 0U, "faults left");
+    test_assert(check(sdio_model_card.data[300], 300U, TEST_BLOCKS, 2U),
+                "card data changed");
+    test_assert(clkdivs_check(first, divs, 8U), "wrong clock dividers");
+    test_assert(SDCD1.state == BLK_READY, "wrong state");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_004 = {
+  "write CRC errors",
+  sdc_setup,
+  sdc_teardown,
+  test_015_004_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_005 Command CRC errors
+ *
+ * <h2>Description</h2>
+ * A response is received with a wrong CRC before the data transfer, the
+ * transfer is retried at the next divider.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The status response preceding a read is corrupted, the read succeeds
+ *   at the next divider.
+ * .
+ */
+
+static void test_015_005_execute(void) {
+  uint32_t first;
+
+  test_assert(connect(true), "connection failed");
+  fill(sdio_model_card.data[10], 10U, 1U, 5U);
+  first = sdio_model_card.transfers;
+
+  /* The status response preceding a read is corrupted, the read succeeds
+     at the next divider.*/
+  test_set_step(1);
+  {
+    static const uint32_t divs[] = {2U};
+
+    sdio_model_card.cmd_crc_faults = 1U;
+    test_assert(sdcRead(&SDCD1, 10U, u.buf, 1U) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(u.buf, 10U, 1U, 5U), "wrong data");
+    test_assert(sdio_model_card.cmd_crc_errors == 1U, "wrong errors count");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_READ_SINGLE_BLOCK] == 1U,
+                "wrong read commands count");
+    test_assert(clkdivs_check(first, divs, 1U), "wrong clock dividers");
+    test_assert((sdcGetAndClearErrors(&SDCD1) & SDC_CMD_CRC_ERROR) != 0U,
+                "error not reported");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_005 = {
+  "command CRC errors",
+  sdc_setup,
+  sdc_teardown,
+  test_015_005_execute
+};
+#endif /* TRUE */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_006 Clock step-down limit
+ *
+ * <h2>Description</h2>
+ * Repeated CRC errors walk the card clock divider down to the
+ * initialization divider, a transfer failing at that divider is not
+ * retried.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - Three reads with two CRC errors each step the divider down to the
+ *   initialization divider.
+ * - A CRC error at the initialization divider is not retried.
+ * .
+ */
+
+static void test_015_006_execute(void) {
+  uint32_t first;
+  unsigned i;
+
+  test_assert(connect(true), "connection failed");
+  fill(sdio_model_card.data[0], 0U, 2U, 6U);
+  first = sdio_model_card.transfers;
+
+  /* Three reads with two CRC errors each step the divider down to the
+     initialization divider.*/
+  test_set_step(1);
+  {
+    static const uint32_t divs[] = {0U, 2U, 6U, 6U, 14U, 30U,
+                                    30U, 62U, STM32_SDIO_DIV_LS};
+
+    for (i = 0U; i < 3U; i++) {
+      sdio_model_card.read_crc_faults = 2U;
+      memset(u.buf, 0, sizeof u.buf);
+      test_assert(sdcRead(&SDCD1, 0U, u.buf, 2U) == HAL_SUCCESS,
+                  "read failed");
+      test_assert(check(u.buf, 0U, 2U, 6U), "wrong data");
+    }
+    test_assert(SDCD1.clkdiv == STM32_SDIO_DIV_LS, "wrong clock divider");
+    test_assert(clkdivs_check(first, divs, 9U), "wrong clock dividers");
+  }
+
+  /* A CRC error at the initialization divider is not retried.*/
+  test_set_step(2);
+  {
+    sdio_model_card.read_crc_faults = 1U;
+    test_assert(sdcRead(&SDCD1, 0U, u.buf, 2U) == HAL_FAILED,
+                "read succeeded");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] ==
+                10U, "wrong read commands count");
+    test_assert(sdio_model_card.transfers == first + 10U,
+                "wrong transfers count");
+    test_assert(SDCD1.clkdiv == STM32_SDIO_DIV_LS, "wrong clock divider");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_006 = {
+  "clock step-down limit",
+  sdc_setup,
+  sdc_teardown,
+  test_015_006_execute
+};
+#endif /* TRUE */
+
+#if STM32_SDC_SDIO_UNALIGNED_SUPPORT || defined(__DOXYGEN__)
+/**
+ * @page test_015_007 Unaligned buffers
+ *
+ * <h2>Description</h2>
+ * Blocks are transferred from and to buffers not aligned to a word, the
+ * transfers are split in chunks of the driver bounce buffer and each
+ * chunk is retried on its own.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - STM32_SDC_SDIO_UNALIGNED_SUPPORT
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - Blocks are written from an unaligned buffer, a chunk fails with a
+ *   CRC error.
+ * - Blocks are read into an unaligned buffer, a chunk fails with a CRC
+ *   error.
+ * .
+ */
+
+static void test_015_007_execute(void) {
+  uint8_t *p = &u.buf[1];
+
+  test_assert(connect(true), "connection failed");
+
+  /* Blocks are written from an unaligned buffer, a chunk fails with a
+     CRC error.*/
+  test_set_step(1);
+  {
+    fill(p, 400U, UNALIGNED_BLOCKS, 7U);
+    sdio_model_card.write_crc_faults = 1U;
+    test_assert(sdcWrite(&SDCD1, 400U, p, UNALIGNED_BLOCKS) == HAL_SUCCESS,
+                "write failed");
+    test_assert(check(sdio_model_card.data[400], 400U, UNALIGNED_BLOCKS, 7U),
+                "wrong card data");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_WRITE_MULTIPLE_BLOCK] == 4U,
+                "wrong write commands count");
+    test_assert(SDCD1.clkdiv == 2U, "wrong clock divider");
+  }
+
+  /* Blocks are read into an unaligned buffer, a chunk fails with a CRC
+     error.*/
+  test_set_step(2);
+  {
+    memset(u.buf, 0, sizeof u.buf);
+    sdio_model_card.read_crc_faults = 1U;
+    test_assert(sdcRead(&SDCD1, 400U, p, UNALIGNED_BLOCKS) == HAL_SUCCESS,
+                "read failed");
+    test_assert(check(p, 400U, UNALIGNED_BLOCKS, 7U), "wrong data");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_READ_MULTIPLE_BLOCK] == 4U,
+                "wrong read commands count");
+    test_assert(SDCD1.clkdiv == 6U, "wrong clock divider");
+    test_assert(sdio_model_card.protocol_errors == 0U, "protocol error");
+  }
+}
+
+static const testcase_t test_015_007 = {
+  "unaligned buffers",
+  sdc_setup,
+  sdc_teardown,
+  test_015_007_execute
+};
+#endif /* STM32_SDC_SDIO_UNALIGNED_SUPPORT */
+
+#if TRUE || defined(__DOXYGEN__)
+/**
+ * @page test_015_008 Other errors
+ *
+ * <h2>Description</h2>
+ * Errors other than CRC errors are not retried and leave the card clock
+ * divider unchanged.
+ *
+ * <h2>Conditions</h2>
+ * None.
+ *
+ * <h2>Test Steps</h2>
+ * - The card is removed, the read fails with a command timeout.
+ * .
+ */
+
+static void test_015_008_execute(void) {
+  uint32_t first;
+  uint32_t status;
+
+  test_assert(connect(true), "connection failed");
+  first  = sdio_model_card.transfers;
+  status = sdio_model_card.commands[MMCSD_CMD_SEND_STATUS];
+
+  /* The card is removed, the read fails with a command timeout.*/
+  test_set_step(1);
+  {
+    sdio_model_remove();
+    test_assert(sdcRead(&SDCD1, 0U, u.buf, 1U) == HAL_FAILED,
+                "read succeeded");
+    test_assert((sdcGetAndClearErrors(&SDCD1) & SDC_COMMAND_TIMEOUT) != 0U,
+                "error not reported");
+    test_assert(SDCD1.clkdiv == STM32_SDIO_DIV_HS, "wrong clock divider");
+    test_assert(sdio_model_card.commands[MMCSD_CMD_SEND_STATUS] == status,
+                "command executed");
+    test_assert(sdio_model_card.transfers == first, "unexpected transfers");
+  }
+}
+
+static const testcase_t test_015_008 = {
+  "other errors",
+  sdc_setup,
+  sdc_teardown,
+  test_015_008_execute
+};
+#endif /* TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   STM32 SDC driver.
+ */
+const testcase_t * const test_sequence_015[] = {
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_001,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_002,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_003,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_004,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_005,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_006,
+#endif
+#if STM32_SDC_SDIO_UNALIGNED_SUPPORT || defined(__DOXYGEN__)
+  &test_015_007,
+#endif
+#if TRUE || defined(__DOXYGEN__)
+  &test_015_008,
+#endif
+  NULL
+};
@@ -0,0 +1,235 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    adc_lld.c
+ * @brief   Simulated ADC subsystem low level driver source.
+ *
+ * @addtogroup ADC
+ * @{
+ */
+
+#include "hal.h"
+
+#if (HAL_USE_ADC == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   ADC1 driver identifier.
+ */
+#if (PLATFORM_ADC_USE_ADC1 == TRUE) || defined(__DOXYGEN__)
+ADCDriver ADCD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Converts a number of samples rows.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ * @param[out] buf      pointer to the first row to be converted
+ * @param[in] rows      number of rows to be converted
+ */
+static void convert(ADCDriver *adcp, adcsample_t *buf, size_t rows) {
+  adc_channels_num_t ch;
+
+  while (rows > 0U) {
+    for (ch = 0U; ch < adcp->grpp->num_channels; ch++) {
+      *buf++ = adc_lld_waveform(ch, adcp->index);
+    }
+    adcp->index++;
+    rows--;
+  }
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Conversion event, the virtual timer emulates the interrupt.
+ *
+ * @param[in] p         pointer to the @p ADCDriver object
+ */
+static void adc_lld_serve_interrupt(void *p) {
+  ADCDriver *adcp = (ADCDriver *)p;
+
+  adcp->events++;
+  adcp->isr     = true;
+  adcp->stopped = false;
+  if ((adcp->fault > 0U) && (--adcp->fault == 0U)) {
+    _adc_isr_error_code(adcp, ADC_ERR_OVERFLOW);
+  }
+  else if (adcp->grpp->circular && (adcp->depth > 1U)) {
+    size_t half = adcp->depth / 2U;
+
+    if (!adcp->half) {
+      convert(adcp, adcp->samples, half);
+      adcp->half = true;
+      _adc_isr_half_code(adcp);
+    }
+    else {
+      convert(adcp, adcp->samples + (half * adcp->grpp->num_channels),
+              half);
+      adcp->half = false;
+      _adc_isr_full_code(adcp);
+    }
+  }
+  else {
+    convert(adcp, adcp->samples, adcp->depth);
+    _adc_isr_full_code(adcp);
+  }
+  adcp->isr = false;
+
+  /* Next conversion event unless the conversion has been stopped by the
+     handler or a callback.*/
+  if (!adcp->stopped) {
+    osalSysLockFromISR();
+    osalTimerSetI(&adcp->vt, adcp->grpp->period,
+                  adc_lld_serve_interrupt, adcp);
+    osalSysUnlockFromISR();
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level ADC driver initialization.
+ *
+ * @notapi
+ */
+void adc_lld_init(void) {
+
+#if PLATFORM_ADC_USE_ADC1 == TRUE
+  adcObjectInit(&ADCD1);
+  osalTimerObjectInit(&ADCD1.vt);
+  ADCD1.isr    = false;
+  ADCD1.fault  = 0U;
+  ADCD1.events = 0U;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the ADC peripheral.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_start(ADCDriver *adcp) {
+
+  (void)adcp;
+}
+
+/**
+ * @brief   Deactivates the ADC peripheral.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_stop(ADCDriver *adcp) {
+
+  (void)adcp;
+}
+
+/**
+ * @brief   Starts an ADC conversion.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_start_conversion(ADCDriver *adcp) {
+
+  osalDbgAssert(adcp->grpp->period != TIME_IMMEDIATE, "invalid period");
+
+  adcp->index = 0U;
+  adcp->half  = false;
+  osalTimerSetI(&adcp->vt, adcp->grpp->period,
+                adc_lld_serve_interrupt, adcp);
+}
+
+/**
+ * @brief   Stops an ongoing conversion.
+ * @note    The function can be invoked from the conversion interrupt, the
+ *          next conversion event is not scheduled in that case.
+ *
+ * @param[in] adcp      pointer to the @p ADCDriver object
+ *
+ * @notapi
+ */
+void adc_lld_stop_conversion(ADCDriver *adcp) {
+
+  if (adcp->isr) {
+    adcp->stopped = true;
+  }
+  else {
+    osalTimerResetI(&adcp->vt);
+  }
+}
+
+/**
+ * @brief   Returns the value of a synthetic waveform.
+ * @details The channels sample the following waveforms, repeating every
+ *          four channels:
+ *          - A sawtooth rising one unit per row.
+ *          - A triangle rising and falling 64 units per row.
+ *          - A square wave with a period of 32 rows.
+ *          - A constant at mid scale.
+ *          .
+ *
+ * @param[in] channel   channel index in the conversion group
+ * @param[in] index     absolute index of the samples row
+ * @return              The sample value.
+ *
+ * @notapi
+ */
+adcsample_t adc_lld_waveform(unsigned channel, uint32_t index) {
+  uint32_t phase;
+
+  switch (channel % 4U) {
+  case 0U:
+    return (adcsample_t)(index % (ADC_SIM_MAX_VALUE + 1U));
+  case 1U:
+    phase = (index * 64U) % (2U * (ADC_SIM_MAX_VALUE + 1U));
+    return (adcsample_t)(phase <= ADC_SIM_MAX_VALUE ? phase :
+                         (2U * ADC_SIM_MAX_VALUE) + 1U - phase);
+  case 2U:
+    return (adcsample_t)((index & 16U) != 0U ? ADC_SIM_MAX_VALUE : 0U);
+  default:
+    return (adcsample_t)((ADC_SIM_MAX_VALUE + 1U) / 2U);
+  }
+}
+
+#endif /* HAL_USE_ADC == TRUE */
+
+/** @} */
@@ -0,0 +1,300 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    i2c_lld.c
+ * @brief   Simulated I2C subsystem low level driver source.
+ *
+ * @addtogroup I2C
+ * @{
+ */
+
+#include "hal.h"
+
+#if (HAL_USE_I2C == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   I2C1 driver identifier.
+ */
+#if (PLATFORM_I2C_USE_I2C1 == TRUE) || defined(__DOXYGEN__)
+I2CDriver I2CD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts a transfer.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @return              The operation status.
+ * @retval MSG_OK       if the transfer has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ */
+static msg_t start_transfer(I2CDriver *i2cp);
+
+/*===========================================================================*/
+/* Driver interrupt handlers and threads.                                    */
+/*===========================================================================*/
+
+/**
+ * @brief   Transfer completion, the virtual timer emulates the interrupt.
+ *
+ * @param[in] p         pointer to the @p I2CDriver object
+ */
+static void i2c_lld_serve_interrupt(void *p) {
+  I2CDriver *i2cp = (I2CDriver *)p;
+  size_t i;
+
+  i2cp->errors = i2cp->fault;
+  if (i2cp->errors != I2C_NO_ERROR) {
+    _i2c_wakeup_error_isr(i2cp);
+    return;
+  }
+
+  /* Slave memory access.*/
+  for (i = 0U; i < i2cp->txbytes; i++) {
+    if (i == 0U) {
+      i2cp->ptr = i2cp->txbuf[0];
+    }
+    else {
+      i2cp->memory[i2cp->ptr++] = i2cp->txbuf[i];
+    }
+  }
+  for (i = 0U; i < i2cp->rxbytes; i++) {
+    i2cp->rxbuf[i] = i2cp->memory[i2cp->ptr++];
+  }
+  _i2c_wakeup_isr(i2cp);
+}
+
+static msg_t start_transfer(I2CDriver *i2cp) {
+
+  i2cp->attempts++;
+  if (i2cp->busy > 0U) {
+    i2cp->busy--;
+    return MSG_TIMEOUT;
+  }
+
+  i2cp->transfers++;
+  i2cp->errors = I2C_NO_ERROR;
+  if (i2cp->stuck > 0U) {
+    i2cp->stuck--;
+    return MSG_OK;
+  }
+  osalTimerSetI(&i2cp->vt, i2cp->config->duration,
+                i2c_lld_serve_interrupt, i2cp);
+
+  return MSG_OK;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level I2C driver initialization.
+ *
+ * @notapi
+ */
+void i2c_lld_init(void) {
+
+#if PLATFORM_I2C_USE_I2C1 == TRUE
+  i2cObjectInit(&I2CD1);
+  I2CD1.thread = NULL;
+  osalTimerObjectInit(&I2CD1.vt);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_start(I2CDriver *i2cp) {
+
+  osalDbgAssert(i2cp->config->duration != TIME_IMMEDIATE,
+                "invalid duration");
+}
+
+/**
+ * @brief   Deactivates the I2C peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_stop(I2CDriver *i2cp) {
+
+  osalTimerResetI(&i2cp->vt);
+}
+
+/**
+ * @brief   Receives data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                     uint8_t *rxbuf, size_t rxbytes,
+                                     systime_t timeout) {
+  msg_t msg;
+
+  msg = i2c_lld_start_receive(i2cp, addr, rxbuf, rxbytes);
+  if (msg == MSG_OK) {
+    msg = osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
+  }
+  if (msg == MSG_TIMEOUT) {
+    osalTimerResetI(&i2cp->vt);
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Transmits data via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the function succeeded.
+ * @retval MSG_RESET    if one or more I2C errors occurred, the errors can
+ *                      be retrieved using @p i2cGetErrors().
+ * @retval MSG_TIMEOUT  if a timeout occurred before operation end.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                      const uint8_t *txbuf, size_t txbytes,
+                                      uint8_t *rxbuf, size_t rxbytes,
+                                      systime_t timeout) {
+  msg_t msg;
+
+  msg = i2c_lld_start_transmit(i2cp, addr, txbuf, txbytes, rxbuf, rxbytes);
+  if (msg == MSG_OK) {
+    msg = osalThreadSuspendTimeoutS(&i2cp->thread, timeout);
+  }
+  if (msg == MSG_TIMEOUT) {
+    osalTimerResetI(&i2cp->vt);
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Starts a transmission via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[in] txbuf     pointer to the transmit buffer
+ * @param[in] txbytes   number of bytes to be transmitted
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_start_transmit(I2CDriver *i2cp, i2caddr_t addr,
+                             const uint8_t *txbuf, size_t txbytes,
+                             uint8_t *rxbuf, size_t rxbytes) {
+
+  i2cp->addr    = addr;
+  i2cp->txbuf   = txbuf;
+  i2cp->txbytes = txbytes;
+  i2cp->rxbuf   = rxbuf;
+  i2cp->rxbytes = rxbytes;
+
+  return start_transfer(i2cp);
+}
+
+/**
+ * @brief   Starts a reception via the I2C bus as master.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ * @param[in] addr      slave device address
+ * @param[out] rxbuf    pointer to the receive buffer
+ * @param[in] rxbytes   number of bytes to be received
+ * @return              The operation status.
+ * @retval MSG_OK       if the operation has been started.
+ * @retval MSG_TIMEOUT  if the bus is busy.
+ *
+ * @notapi
+ */
+msg_t i2c_lld_start_receive(I2CDriver *i2cp, i2caddr_t addr,
+                            uint8_t *rxbuf, size_t rxbytes) {
+
+  i2cp->addr    = addr;
+  i2cp->txbuf   = NULL;
+  i2cp->txbytes = 0U;
+  i2cp->rxbuf   = rxbuf;
+  i2cp->rxbytes = rxbytes;
+
+  return start_transfer(i2cp);
+}
+
+/**
+ * @brief   Aborts the operation in progress and resets the peripheral.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+void i2c_lld_reset(I2CDriver *i2cp) {
+
+  osalTimerResetI(&i2cp->vt);
+  i2cp->resets++;
+}
+
+#endif /* HAL_USE_I2C == TRUE */
+
+/** @} */
@@ -0,0 +1,235 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    i2c_lld.h
+ * @brief   Simulated I2C subsystem low level driver header.
+ * @details The driver emulates a master with a single memory slave device
+ *          on the bus, the first transmitted byte of each transaction sets
+ *          the memory pointer. Transfers are completed by a virtual timer
+ *          after a configurable time, busy bus conditions, stuck transfers
+ *          and bus errors can be injected by the test code.
+ *
+ * @addtogroup I2C
+ * @{
+ */
+
+#ifndef _I2C_LLD_H_
+#define _I2C_LLD_H_
+
+#if (HAL_USE_I2C == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Callback support in the driver.
+ */
+#define I2C_SUPPORTS_CALLBACKS      TRUE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   I2C1 driver enable switch.
+ */
+#if !defined(PLATFORM_I2C_USE_I2C1) || defined(__DOXYGEN__)
+#define PLATFORM_I2C_USE_I2C1       TRUE
+#endif
+
+/**
+ * @brief   Size of the simulated slave memory.
+ */
+#if !defined(I2C_SIM_MEMORY_SIZE) || defined(__DOXYGEN__)
+#define I2C_SIM_MEMORY_SIZE         256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type representing an I2C address.
+ */
+typedef uint16_t i2caddr_t;
+
+/**
+ * @brief   Type of I2C Driver condition flags.
+ */
+typedef uint32_t i2cflags_t;
+
+/**
+ * @brief   Type of I2C driver configuration structure.
+ */
+typedef struct {
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Duration of each transfer in system ticks.
+   */
+  systime_t                 duration;
+} I2CConfig;
+
+/**
+ * @brief   Type of a structure representing an I2C driver.
+ */
+typedef struct I2CDriver I2CDriver;
+
+/**
+ * @brief   I2C notification callback type.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object triggering the
+ *                      callback
+ */
+typedef void (*i2ccallback_t)(I2CDriver *i2cp);
+
+/**
+ * @brief   Structure representing an I2C driver.
+ */
+struct I2CDriver {
+  /**
+   * @brief   Driver state.
+   */
+  i2cstate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const I2CConfig           *config;
+  /**
+   * @brief   Error flags.
+   */
+  i2cflags_t                errors;
+  /**
+   * @brief   Asynchronous operation end callback or @p NULL.
+   */
+  i2ccallback_t             end_cb;
+#if (I2C_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
+  mutex_t                   mutex;
+#endif
+#if (I2C_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transactions queue.
+   */
+  i2c_queue_t               queue;
+#endif
+#if defined(I2C_DRIVER_EXT_FIELDS)
+  I2C_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Thread waiting for I/O completion.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   Transfer completion timer.
+   */
+  virtual_timer_t           vt;
+  /**
+   * @brief   Transfer in progress.
+   */
+  i2caddr_t                 addr;
+  const uint8_t             *txbuf;
+  size_t                    txbytes;
+  uint8_t                   *rxbuf;
+  size_t                    rxbytes;
+  /**
+   * @brief   Number of the next start attempts finding the bus busy.
+   */
+  uint32_t                  busy;
+  /**
+   * @brief   Number of the next transfers never ending.
+   */
+  uint32_t                  stuck;
+  /**
+   * @brief   Errors reported at the end of the next transfers.
+   */
+  i2cflags_t                fault;
+  /**
+   * @brief   Number of start attempts.
+   */
+  uint32_t                  attempts;
+  /**
+   * @brief   Number of started transfers.
+   */
+  uint32_t                  transfers;
+  /**
+   * @brief   Number of peripheral resets.
+   */
+  uint32_t                  resets;
+  /**
+   * @brief   Slave memory pointer.
+   */
+  uint8_t                   ptr;
+  /**
+   * @brief   Slave memory.
+   */
+  uint8_t                   memory[I2C_SIM_MEMORY_SIZE];
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Get errors from I2C driver.
+ *
+ * @param[in] i2cp      pointer to the @p I2CDriver object
+ *
+ * @notapi
+ */
+#define i2c_lld_get_errors(i2cp) ((i2cp)->errors)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (PLATFORM_I2C_USE_I2C1 == TRUE) && !defined(__DOXYGEN__)
+extern I2CDriver I2CD1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void i2c_lld_init(void);
+  void i2c_lld_start(I2CDriver *i2cp);
+  void i2c_lld_stop(I2CDriver *i2cp);
+  msg_t i2c_lld_master_transmit_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                        const uint8_t *txbuf, size_t txbytes,
+                                        uint8_t *rxbuf, size_t rxbytes,
+                                        systime_t timeout);
+  msg_t i2c_lld_master_receive_timeout(I2CDriver *i2cp, i2caddr_t addr,
+                                       uint8_t *rxbuf, size_t rxbytes,
+                                       systime_t timeout);
+  msg_t i2c_lld_start_transmit(I2CDriver *i2cp, i2caddr_t addr,
+                               const uint8_t *txbuf, size_t txbytes,
+                               uint8_t *rxbuf, size_t rxbytes);
+  msg_t i2c_lld_start_receive(I2CDriver *i2cp, i2caddr_t addr,
+                              uint8_t *rxbuf, size_t rxbytes);
+  void i2c_lld_reset(I2CDriver *i2cp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_I2C == TRUE */
+
+#endif /* _I2C_LLD_H_ */
+
+/** @} */
@@ -0,0 +1,174 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    inject.c
+ * @brief   Host side frames injector code.
+ * @note    This module runs on the host, it does not include the lwIP
+ *          headers because they clash with the host sockets ones.
+ *
+ * @addtogroup INJECT
+ * @{
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "inject.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/* Batches period in nanoseconds.*/
+#define BATCH_PERIOD_NS         1000000L
+
+/* Batches per second.*/
+#define BATCHES_PER_SECOND      1000U
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables and types.                                         */
+/*===========================================================================*/
+
+static pthread_t inject_thread;
+static int inject_socket = -1;
+static struct sockaddr_in destinations[INJECT_MAX_DESTINATIONS];
+static unsigned ndestinations;
+static volatile unsigned inject_rate;
+static volatile unsigned long inject_sent;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Injector thread.
+ * @details The datagrams due in each period are sent back-to-back, the
+ *          fractional part of the rate is carried to the next period. If
+ *          the host falls behind the missed periods are recovered at once.
+ */
+static void *injection(void *arg) {
+  uint8_t payload[INJECT_PAYLOAD_SIZE];
+  struct timespec next;
+  unsigned credit = 0U;
+
+  (void)arg;
+
+  memset(payload, 0x55, sizeof payload);
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (true) {
+    unsigned n, i, rate = inject_rate;
+
+    if (rate == 0U) {
+      credit = 0U;
+    }
+    credit += rate;
+    n = credit / BATCHES_PER_SECOND;
+    credit %= BATCHES_PER_SECOND;
+    while (n > 0U) {
+      for (i = 0U; i < ndestinations; i++) {
+        if (sendto(inject_socket, payload, sizeof payload, 0,
+                   (const struct sockaddr *)&destinations[i],
+                   sizeof destinations[i]) > 0) {
+          inject_sent++;
+        }
+      }
+      n--;
+    }
+
+    next.tv_nsec += BATCH_PERIOD_NS;
+    if (next.tv_nsec >= 1000000000L) {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+    (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+  }
+
+  return NULL;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts the injector, the rate is initially zero.
+ *
+ * @param[in] addresses array of destination addresses in dotted notation
+ * @param[in] n         number of destination addresses
+ * @param[in] port      destination UDP port
+ */
+void inject_start(const char * const *addresses, unsigned n,
+                  unsigned port) {
+  unsigned i;
+
+  if (n > INJECT_MAX_DESTINATIONS) {
+    n = INJECT_MAX_DESTINATIONS;
+  }
+  for (i = 0U; i < n; i++) {
+    memset(&destinations[i], 0, sizeof destinations[i]);
+    destinations[i].sin_family = AF_INET;
+    destinations[i].sin_port   = htons((uint16_t)port);
+    if (inet_pton(AF_INET, addresses[i], &destinations[i].sin_addr) != 1) {
+      printf("inject: invalid address %s\n", addresses[i]);
+      exit(1);
+    }
+  }
+  ndestinations = n;
+
+  inject_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (inject_socket < 0) {
+    printf("inject: unable to create the socket\n");
+    exit(1);
+  }
+  (void)pthread_create(&inject_thread, NULL, injection, NULL);
+}
+
+/**
+ * @brief   Sets the injection rate.
+ *
+ * @param[in] rate      datagrams per second for each destination, zero
+ *                      stops the injection
+ */
+void inject_set_rate(unsigned rate) {
+
+  inject_rate = rate;
+}
+
+/**
+ * @brief   Returns the number of datagrams sent since the start.
+ *
+ * @return              The datagrams sent to all the destinations.
+ */
+unsigned long inject_get_sent(void) {
+
+  return inject_sent;
+}
+
+/** @} */
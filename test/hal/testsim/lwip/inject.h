@@ -0,0 +1,82 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    inject.h
+ * @brief   Host side frames injector header.
+ * @details A host thread sends UDP datagrams to the simulated interfaces
+ *          through the TAP devices at a programmed rate, each datagram is
+ *          received as a single frame. The datagrams are sent in batches
+ *          every millisecond, the rate is the same for all the
+ *          destinations.
+ *
+ * @addtogroup INJECT
+ * @{
+ */
+
+#ifndef _INJECT_H_
+#define _INJECT_H_
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of destinations.
+ */
+#define INJECT_MAX_DESTINATIONS             2U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the injected datagrams payload.
+ */
+#if !defined(INJECT_PAYLOAD_SIZE) || defined(__DOXYGEN__)
+#define INJECT_PAYLOAD_SIZE                 64U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void inject_start(const char * const *addresses, unsigned n,
+                    unsigned port);
+  void inject_set_rate(unsigned rate);
+  unsigned long inject_get_sent(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _INJECT_H_ */
+
+/** @} */
@@ -0,0 +1,83 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    lwipopts.h
+ * @brief   lwIP configuration of the benchmark, the options not listed
+ *          here keep the lwIP defaults.
+ */
+
+#ifndef __LWIPOPTS_H__
+#define __LWIPOPTS_H__
+
+/* The stack runs in its own thread on top of the ChibiOS bindings.*/
+#define NO_SYS                          0
+#define SYS_LIGHTWEIGHT_PROT            0
+
+/* Memory, sized for a window of a few segments.*/
+#define MEM_ALIGNMENT                   4
+#define MEM_SIZE                        16000
+#define MEMP_NUM_PBUF                   32
+#define MEMP_NUM_TCP_PCB                8
+#define MEMP_NUM_NETCONN                8
+#define MEMP_NUM_NETBUF                 16
+#define PBUF_POOL_SIZE                  32
+
+/* TCP, the window covers four full segments.*/
+#define TCP_MSS                         1460
+#define TCP_WND                         (4 * TCP_MSS)
+#define TCP_SND_BUF                     (4 * TCP_MSS)
+#define TCP_SND_QUEUELEN                (4 * TCP_SND_BUF / TCP_MSS)
+#define TCP_QUEUE_OOSEQ                 1
+
+/* The zero copy receive path of the bindings requires the custom pbufs,
+   they are enabled by the default fragmentation settings.*/
+#define IP_FRAG                         1
+#define IP_FRAG_USES_STATIC_BUF         0
+
+/* Only the netconn API is used.*/
+#define LWIP_NETCONN                    1
+#define LWIP_SOCKET                     0
+#define LWIP_DHCP                       0
+
+/* Threads and mailboxes, allocated from the sys_arch pools.*/
+#define SYS_ARCH_USE_POOLS              TRUE
+#define TCPIP_THREAD_STACKSIZE          8192
+#define TCPIP_THREAD_PRIO               (LOWPRIO + 1)
+#define TCPIP_MBOX_SIZE                 32
+#define DEFAULT_TCP_RECVMBOX_SIZE       32
+#define DEFAULT_ACCEPTMBOX_SIZE         4
+#define DEFAULT_UDP_RECVMBOX_SIZE       32
+
+/* Static address of the benchmark, the host side of the TAP device is
+   10.0.0.1.*/
+#define LWIP_IPADDR(p)                  IP4_ADDR(p, 10, 0, 0, 2)
+#define LWIP_GATEWAY(p)                 IP4_ADDR(p, 10, 0, 0, 1)
+#define LWIP_NETMASK(p)                 IP4_ADDR(p, 255, 255, 255, 0)
+
+/* ChibiOS bindings thread, the simulator requires larger stacks.*/
+#define LWIP_THREAD_STACK_SIZE          8192
+
+/* The link, resources and memory pools counters are printed by the
+   benchmark.*/
+#define LWIP_STATS                      1
+#define LINK_STATS                      1
+#define SYS_STATS                       1
+#define MEMP_STATS                      1
+#define LWIP_STATS_LARGE                1
+#define LWIP_STATS_DISPLAY              0
+
+#endif /* __LWIPOPTS_H__ */
@@ -0,0 +1,438 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+#include "console.h"
+#include "chprintf.h"
+
+#include "lwipthread.h"
+
+#include "lwip/api.h"
+#include "lwip/stats.h"
+#include "lwip/tcpip.h"
+
+#include "inject.h"
+
+/*
+ * Port of the TCP sink, the received data is discarded.
+ */
+#define BENCH_SINK_PORT         5001
+
+/*
+ * Port of the TCP source, the data is sent until the peer closes the
+ * connection or for BENCH_SOURCE_TIME.
+ */
+#define BENCH_SOURCE_PORT       5002
+
+/*
+ * Duration of a source session.
+ */
+#define BENCH_SOURCE_TIME       S2ST(10)
+
+/*
+ * Port of the connect/close stress server, the connections are closed as
+ * soon as they are accepted.
+ */
+#define BENCH_STRESS_PORT       5003
+
+/*
+ * Interval of the stress server reports.
+ */
+#define BENCH_STRESS_INTERVAL   S2ST(5)
+
+/*
+ * Injection test, frames are injected on ETHD1 and ETHD2 at increasing
+ * rates, the receive statistics and the interleaving of the interfaces
+ * are printed for each rate.
+ */
+#if !defined(BENCH_INJECTION)
+#define BENCH_INJECTION         FALSE
+#endif
+
+#if BENCH_INJECTION
+#if !MAC_USE_RX_MITIGATION
+#error "the injection test requires MAC_USE_RX_MITIGATION"
+#endif
+
+/*
+ * Port of the UDP sink receiving the injected frames.
+ */
+#define BENCH_INJECTION_PORT    5004
+
+/*
+ * Duration of each injection step.
+ */
+#define BENCH_INJECTION_TIME    S2ST(2)
+#endif
+
+#define chp ((BaseSequentialStream *)&CD1)
+
+/*
+ * Data sent by the source.
+ */
+static uint8_t source_data[4 * TCP_MSS];
+
+/*
+ * Connections served by the stress server.
+ */
+static volatile uint32_t stress_connections;
+
+#if BENCH_INJECTION
+/*
+ * Injection rates, frames per second on each interface.
+ */
+static const unsigned injection_rates[] = {1000, 5000, 20000, 50000};
+
+/*
+ * Destinations of the injected frames.
+ */
+static const char * const injection_addresses[] = {"10.0.0.2", "10.0.1.2"};
+
+/*
+ * Settings of the second interface, the first one has the static settings.
+ */
+static uint8_t if2_macaddress[6] = {LWIP_ETHADDR_0, LWIP_ETHADDR_1,
+                                    LWIP_ETHADDR_2, LWIP_ETHADDR_3,
+                                    LWIP_ETHADDR_4, LWIP_ETHADDR_5 + 1};
+static const lwipthread_opts_t if2_opts = {
+  if2_macaddress,
+  PP_HTONL(0x0A000102UL),
+  PP_HTONL(0xFFFFFF00UL),
+  PP_HTONL(0x0A000101UL)
+};
+
+static lwipthread_if_t bench_ifs[2];
+
+/*
+ * Interleaving of the interfaces, a run is a sequence of frames passed to
+ * the stack by an interface while the other one has frames waiting.
+ */
+static unsigned run_if, run_length, max_run;
+#endif
+
+/*
+ * Prints the session results and the link counters.
+ */
+static void report(const char *what, uint32_t bytes, systime_t time) {
+  uint32_t ms = ST2MS(time);
+
+  if (ms == 0U)
+    ms = 1U;
+  chprintf(chp, "%s: %U bytes in %U ms, %U kbit/s\r\n", what,
+           (unsigned long)bytes, (unsigned long)ms,
+           (unsigned long)(((uint64_t)bytes * 8U) / ms));
+  chprintf(chp, "link: recv %U, xmit %U, drop %U, memerr %U\r\n",
+           (unsigned long)lwip_stats.link.recv,
+           (unsigned long)lwip_stats.link.xmit,
+           (unsigned long)lwip_stats.link.drop,
+           (unsigned long)lwip_stats.link.memerr);
+}
+
+/*
+ * Creates a listening connection.
+ */
+static struct netconn *listen_on(u16_t port) {
+  struct netconn *nc;
+
+  nc = netconn_new(NETCONN_TCP);
+  if ((nc == NULL) ||
+      (netconn_bind(nc, NULL, port) != ERR_OK) ||
+      (netconn_listen(nc) != ERR_OK)) {
+    chSysHalt("listen failed");
+  }
+  return nc;
+}
+
+/*
+ * TCP sink thread, measures the receive path.
+ */
+static THD_WORKING_AREA(waSink, 8192);
+static THD_FUNCTION(Sink, arg) {
+  struct netconn *lnc, *nc;
+
+  (void)arg;
+  chRegSetThreadName("sink");
+
+  lnc = listen_on(BENCH_SINK_PORT);
+  while (true) {
+    struct netbuf *nb;
+    systime_t start;
+    uint32_t bytes;
+
+    if (netconn_accept(lnc, &nc) != ERR_OK)
+      continue;
+
+    bytes = 0U;
+    start = chVTGetSystemTime();
+    while (netconn_recv(nc, &nb) == ERR_OK) {
+      bytes += netbuf_len(nb);
+      netbuf_delete(nb);
+    }
+    report("RX", bytes, chVTTimeElapsedSinceX(start));
+    netconn_close(nc);
+    netconn_delete(nc);
+  }
+}
+
+/*
+ * TCP source thread, measures the transmit path.
+ */
+static THD_WORKING_AREA(waSource, 8192);
+static THD_FUNCTION(Source, arg) {
+  struct netconn *lnc, *nc;
+
+  (void)arg;
+  chRegSetThreadName("source");
+
+  lnc = listen_on(BENCH_SOURCE_PORT);
+  while (true) {
+    systime_t start;
+    uint32_t bytes;
+
+    if (netconn_accept(lnc, &nc) != ERR_OK)
+      continue;
+
+    bytes = 0U;
+    start = chVTGetSystemTime();
+    while (chVTTimeElapsedSinceX(start) < BENCH_SOURCE_TIME) {
+      if (netconn_write(nc, source_data, sizeof source_data,
+                        NETCONN_NOCOPY) != ERR_OK)
+        break;
+      bytes += sizeof source_data;
+    }
+    report("TX", bytes, chVTTimeElapsedSinceX(start));
+    netconn_close(nc);
+    netconn_delete(nc);
+  }
+}
+
+/*
+ * Connect/close stress thread, measures the connections setup and the
+ * allocation of the netconn resources.
+ */
+static THD_WORKING_AREA(waStress, 8192);
+static THD_FUNCTION(Stress, arg) {
+  struct netconn *lnc, *nc;
+
+  (void)arg;
+  chRegSetThreadName("stress");
+
+  lnc = listen_on(BENCH_STRESS_PORT);
+  while (true) {
+    if (netconn_accept(lnc, &nc) != ERR_OK)
+      continue;
+    netconn_close(nc);
+    netconn_delete(nc);
+    stress_connections++;
+  }
+}
+
+#if BENCH_INJECTION
+/*
+ * Input function of the interfaces, it tracks the runs then passes the
+ * frames to the stack thread. The ring of the other interface is checked
+ * directly in the simulated driver.
+ */
+static err_t injection_input(struct pbuf *p, struct netif *netif) {
+  unsigned i = netif == &bench_ifs[0].netif ? 0U : 1U;
+  MACDriver *macp = bench_ifs[1U - i].macp;
+
+  if (i != run_if) {
+    run_if = i;
+    run_length = 0U;
+  }
+  if (macp->rxbufs[macp->rxrd].state == SIM_MAC_BUFFER_FILLED) {
+    run_length++;
+    if (run_length > max_run)
+      max_run = run_length;
+  }
+  else
+    run_length = 0U;
+
+  return tcpip_input(p, netif);
+}
+
+/*
+ * UDP sink thread, the injected frames are discarded.
+ */
+static THD_WORKING_AREA(waUdpSink, 8192);
+static THD_FUNCTION(UdpSink, arg) {
+  struct netconn *nc;
+
+  (void)arg;
+  chRegSetThreadName("udpsink");
+
+  nc = netconn_new(NETCONN_UDP);
+  if ((nc == NULL) ||
+      (netconn_bind(nc, NULL, BENCH_INJECTION_PORT) != ERR_OK)) {
+    chSysHalt("bind failed");
+  }
+  while (true) {
+    struct netbuf *nb;
+
+    if (netconn_recv(nc, &nb) == ERR_OK)
+      netbuf_delete(nb);
+  }
+}
+
+/*
+ * Injects frames at the specified rate and prints the receive statistics
+ * of the interfaces.
+ */
+static void injection_step(unsigned rate) {
+  mac_rx_stats_t start[2];
+  unsigned long sent;
+  unsigned i;
+
+  chSysLock();
+  for (i = 0U; i < 2U; i++) {
+    mac_rx_stats_t *rsp = macGetReceiveStatistics(bench_ifs[i].macp);
+
+    rsp->max_burst = 0U;
+    start[i] = *rsp;
+  }
+  max_run = 0U;
+  chSysUnlock();
+
+  sent = inject_get_sent();
+  inject_set_rate(rate);
+  chThdSleep(BENCH_INJECTION_TIME);
+  inject_set_rate(0U);
+  sent = inject_get_sent() - sent;
+
+  /* The frames still in flight are drained.*/
+  chThdSleepMilliseconds(200);
+
+  chprintf(chp, "inject: %U frames/s, sent %U\r\n",
+           (unsigned long)rate, sent);
+  for (i = 0U; i < 2U; i++) {
+    mac_rx_stats_t *rsp = macGetReceiveStatistics(bench_ifs[i].macp);
+    uint32_t frames = rsp->frames - start[i].frames;
+    uint32_t irqs = rsp->interrupts - start[i].interrupts;
+
+    if (irqs == 0U)
+      irqs = 1U;
+    chprintf(chp, "eth%U: frames %U, interrupts %U, frames/interrupt "
+                  "%U.%02U, max burst %U\r\n",
+             (unsigned long)(i + 1U), (unsigned long)frames,
+             (unsigned long)(rsp->interrupts - start[i].interrupts),
+             (unsigned long)(frames / irqs),
+             (unsigned long)(((frames % irqs) * 100U) / irqs),
+             (unsigned long)rsp->max_burst);
+  }
+  chprintf(chp, "max run %U, budget %U\r\n",
+           (unsigned long)max_run, (unsigned long)LWIP_RX_BUDGET);
+}
+#endif
+
+/*
+ * Prints the stress server results and the sys_arch resources usage.
+ */
+static void stress_report(uint32_t n, systime_t time) {
+  uint32_t ms = ST2MS(time);
+
+  chprintf(chp, "conn: %U in %U ms, %U/s\r\n",
+           (unsigned long)n, (unsigned long)ms,
+           (unsigned long)(((uint64_t)n * 1000U) / ms));
+  chprintf(chp, "sem: used %U, max %U, err %U\r\n",
+           (unsigned long)lwip_stats.sys.sem.used,
+           (unsigned long)lwip_stats.sys.sem.max,
+           (unsigned long)lwip_stats.sys.sem.err);
+  chprintf(chp, "mbox: used %U, max %U, err %U\r\n",
+           (unsigned long)lwip_stats.sys.mbox.used,
+           (unsigned long)lwip_stats.sys.mbox.max,
+           (unsigned long)lwip_stats.sys.mbox.err);
+#if SYS_ARCH_USE_POOLS
+  sys_arch_thread_stats_update();
+  chprintf(chp, "threads: used %U, max %U, err %U\r\n",
+           (unsigned long)sys_arch_thread_stats.used,
+           (unsigned long)sys_arch_thread_stats.max,
+           (unsigned long)sys_arch_thread_stats.err);
+#endif
+  chprintf(chp, "tcp pcb: used %U, max %U, err %U\r\n",
+           (unsigned long)lwip_stats.memp[MEMP_TCP_PCB].used,
+           (unsigned long)lwip_stats.memp[MEMP_TCP_PCB].max,
+           (unsigned long)lwip_stats.memp[MEMP_TCP_PCB].err);
+}
+
+/*
+ * Simulator main.
+ */
+int main(int argc, char *argv[]) {
+
+  (void)argc;
+  (void)argv;
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  conInit();
+  chSysInit();
+
+  /*
+   * TCP/IP stack on ETHD1.
+   */
+#if BENCH_INJECTION
+  bench_ifs[0].macp = &ETHD1;
+  bench_ifs[0].opts = NULL;
+  bench_ifs[1].macp = &ETHD2;
+  bench_ifs[1].opts = &if2_opts;
+  lwipInitInterfaces(bench_ifs, 2U);
+  chSysLock();
+  bench_ifs[0].netif.input = injection_input;
+  bench_ifs[1].netif.input = injection_input;
+  chSysUnlock();
+#else
+  lwipInit(NULL);
+#endif
+  chprintf(chp, "lwIP benchmark, zero copy %s\r\n",
+           MAC_USE_ZERO_COPY ? "on" : "off");
+
+  chThdCreateStatic(waSink, sizeof(waSink), NORMALPRIO, Sink, NULL);
+  chThdCreateStatic(waSource, sizeof(waSource), NORMALPRIO, Source, NULL);
+  chThdCreateStatic(waStress, sizeof(waStress), NORMALPRIO, Stress, NULL);
+
+#if BENCH_INJECTION
+  {
+    unsigned i;
+
+    chThdCreateStatic(waUdpSink, sizeof(waUdpSink), NORMALPRIO, UdpSink,
+                      NULL);
+    inject_start(injection_addresses, 2U, BENCH_INJECTION_PORT);
+    for (i = 0U; i < sizeof injection_rates / sizeof injection_rates[0]; i++)
+      injection_step(injection_rates[i]);
+  }
+#endif
+
+  /*
+   * The stress server results are printed periodically while connections
+   * are being served.
+   */
+  while (true) {
+    systime_t start = chVTGetSystemTime();
+    uint32_t n = stress_connections;
+
+    chThdSleep(BENCH_STRESS_INTERVAL);
+    if (stress_connections != n)
+      stress_report(stress_connections - n, chVTTimeElapsedSinceX(start));
+  }
+}
@@ -0,0 +1,625 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    mmc_model.c
+ * @brief   SD card SPI mode model code.
+ *
+ * @addtogroup MMC_MODEL
+ * @{
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "hal.h"
+#include "mmc_model.h"
+
+#if (HAL_USE_MMC_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* R1 response bits.*/
+#define R1_IDLE                 0x01U
+#define R1_ILLEGAL_COMMAND      0x04U
+#define R1_COM_CRC_ERROR        0x08U
+#define R1_ADDRESS_ERROR        0x20U
+#define R1_PARAMETER_ERROR      0x40U
+
+/* Data tokens and responses.*/
+#define TOKEN_START_BLOCK       0xFEU
+#define TOKEN_START_MULTIPLE    0xFCU
+#define TOKEN_STOP_TRAN         0xFDU
+#define TOKEN_OUT_OF_RANGE      0x08U
+#define DATA_ACCEPTED           0xE5U
+#define DATA_CRC_ERROR          0xEBU
+#define DATA_WRITE_ERROR        0xEDU
+
+/* Size of a data block with its CRC.*/
+#define FRAME_SIZE              (MMCSD_BLOCK_SIZE + 2U)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Card model.
+ */
+mmc_model_t mmc_model;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Data transfer modes.
+ */
+typedef enum {
+  MODE_NONE = 0,                    /**< Waiting for commands.              */
+  MODE_READ = 1,                    /**< Streaming data blocks.             */
+  MODE_WRITE = 2,                   /**< Waiting for data tokens.           */
+  MODE_WRITE_DATA = 3,              /**< Receiving a data block.            */
+  MODE_REJECTED = 4                 /**< Block rejected, waiting the stop.  */
+} card_mode_t;
+
+static bool inserted;
+static bool selected;
+static bool idle;
+static bool acmd;
+static bool crc_on;
+static unsigned polls;
+static card_mode_t mode;
+static uint32_t blk;
+static uint32_t erase_start;
+static uint32_t erase_end;
+static uint32_t ready_time;
+static uint32_t busy_time;
+
+/* Command frame being received.*/
+static uint8_t cmd[6];
+static unsigned ncmd;
+
+/* Response being sent.*/
+static uint8_t out[4U + FRAME_SIZE];
+static unsigned nout;
+static unsigned iout;
+
+/* Data block being streamed or received, -1 while waiting the token.*/
+static uint8_t frame[FRAME_SIZE];
+static int iframe;
+
+static const uint8_t cid[16] = {
+  0x03, 'S', 'D', 'C', 'H', 'S', 'I', 'M',
+  0x10, 0x12, 0x34, 0x56, 0x78, 0x01, 0x0A, 0x01
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*
+ * Bitwise CRCs, a different implementation than the table-based ones of
+ * the driver under test.
+ */
+static uint8_t crc7(const uint8_t *p, size_t n) {
+  uint8_t crc = 0U;
+  unsigned i;
+
+  while (n-- > 0U) {
+    uint8_t b = *p++;
+    for (i = 0U; i < 8U; i++) {
+      crc = (uint8_t)(crc << 1);
+      if (((b ^ crc) & 0x80U) != 0U) {
+        crc ^= 0x09U;
+      }
+      b = (uint8_t)(b << 1);
+    }
+  }
+  return crc & 0x7FU;
+}
+
+static uint16_t crc16(const uint8_t *p, size_t n) {
+  uint16_t crc = 0U;
+  unsigned i;
+
+  while (n-- > 0U) {
+    crc ^= (uint16_t)((uint16_t)*p++ << 8);
+    for (i = 0U; i < 8U; i++) {
+      if ((crc & 0x8000U) != 0U) {
+        crc = (uint16_t)((crc << 1) ^ 0x1021U);
+      }
+      else {
+        crc = (uint16_t)(crc << 1);
+      }
+    }
+  }
+  return crc;
+}
+
+/*
+ * Sets a field of a register, the bits are numbered as in the
+ * specification with bit 127 being the MSB of the first byte.
+ */
+static void set_field(uint8_t *reg, unsigned end, unsigned start,
+                      uint32_t value) {
+  unsigned bit;
+
+  for (bit = start; bit <= end; bit++) {
+    uint8_t mask = (uint8_t)(1U << (bit % 8U));
+    if ((value & 1U) != 0U) {
+      reg[(127U - bit) / 8U] |= mask;
+    }
+    else {
+      reg[(127U - bit) / 8U] &= (uint8_t)~mask;
+    }
+    value >>= 1;
+  }
+}
+
+/*
+ * Queues a response byte.
+ */
+static void put(uint8_t b) {
+
+  osalDbgAssert(nout < sizeof out, "response overflow");
+
+  out[nout++] = b;
+}
+
+/*
+ * Queues a response with the Ncr delay.
+ */
+static void respond(uint8_t r1) {
+
+  nout = 0U;
+  iout = 0U;
+  put(0xFFU);
+  put(r1);
+}
+
+/*
+ * Queues a data block after the R1 response.
+ */
+static void put_block(const uint8_t *p, size_t n) {
+  uint16_t crc = crc16(p, n);
+  size_t i;
+
+  put(0xFFU);
+  put(TOKEN_START_BLOCK);
+  for (i = 0U; i < n; i++) {
+    put(p[i]);
+  }
+  if (mmc_model.read_crc_faults > 0U) {
+    mmc_model.read_crc_faults--;
+    crc ^= 0x0001U;
+  }
+  put((uint8_t)(crc >> 8));
+  put((uint8_t)crc);
+}
+
+/*
+ * Converts a command address in a block number.
+ */
+static bool address(uint32_t arg, uint32_t *blkp) {
+
+  if (!mmc_model.hc) {
+    if ((arg % MMCSD_BLOCK_SIZE) != 0U) {
+      return false;
+    }
+    arg /= MMCSD_BLOCK_SIZE;
+  }
+  *blkp = arg;
+  return arg < MMC_MODEL_BLOCKS;
+}
+
+/*
+ * Command execution.
+ */
+static void execute(uint32_t time) {
+  uint8_t index = cmd[0] & 0x3FU;
+  uint32_t arg = ((uint32_t)cmd[1] << 24) | ((uint32_t)cmd[2] << 16) |
+                 ((uint32_t)cmd[3] << 8) | (uint32_t)cmd[4];
+  uint8_t r1 = idle ? R1_IDLE : 0U;
+  uint8_t reg[16];
+  bool app = acmd;
+
+  /* CRC check of the command frame.*/
+  if (crc_on || (index == MMCSD_CMD_GO_IDLE_STATE) ||
+      (index == MMCSD_CMD_SEND_IF_COND)) {
+    if (mmc_model.cmd_crc_faults > 0U) {
+      mmc_model.cmd_crc_faults--;
+      cmd[4] ^= 0x01U;
+    }
+    if (cmd[5] != (uint8_t)((crc7(cmd, 5U) << 1) | 1U)) {
+      mmc_model.cmd_crc_errors++;
+      respond(r1 | R1_COM_CRC_ERROR);
+      return;
+    }
+  }
+
+  acmd = false;
+
+  /* Commands accepted before the initialization is complete.*/
+  if (idle && (index != MMCSD_CMD_GO_IDLE_STATE) &&
+      (index != MMCSD_CMD_INIT) && (index != MMCSD_CMD_SEND_IF_COND) &&
+      (index != MMCSD_CMD_APP_CMD) && (index != MMCSD_CMD_APP_OP_COND) &&
+      (index != MMCSD_CMD_READ_OCR) && (index != MMCSD_CMD_CRC_ON_OFF)) {
+    respond(r1 | R1_ILLEGAL_COMMAND);
+    return;
+  }
+
+  /* During a multiple blocks read only CMD12 is expected.*/
+  if ((mode == MODE_READ) && (index != MMCSD_CMD_STOP_TRANSMISSION)) {
+    mmc_model.protocol_errors++;
+    return;
+  }
+
+  mmc_model.commands[index]++;
+  switch (index) {
+  case MMCSD_CMD_GO_IDLE_STATE:
+    idle   = true;
+    crc_on = false;
+    polls  = MMC_MODEL_INIT_POLLS;
+    mode   = MODE_NONE;
+    respond(R1_IDLE);
+    break;
+  case MMCSD_CMD_INIT:
+    idle = false;
+    respond(0U);
+    break;
+  case MMCSD_CMD_SEND_IF_COND:
+    /* R7, voltage accepted and check pattern echoed.*/
+    respond(r1);
+    put(0x00U);
+    put(0x00U);
+    put((uint8_t)((arg >> 8) & 0x0FU));
+    put((uint8_t)arg);
+    break;
+  case MMCSD_CMD_APP_CMD:
+    acmd = true;
+    respond(r1);
+    break;
+  case MMCSD_CMD_APP_OP_COND:
+    if (!app) {
+      respond(r1 | R1_ILLEGAL_COMMAND);
+    }
+    else if (polls > 0U) {
+      polls--;
+      respond(R1_IDLE);
+    }
+    else {
+      idle = false;
+      respond(0U);
+    }
+    break;
+  case MMCSD_CMD_READ_OCR:
+    /* R3, power up status and capacity status.*/
+    respond(r1);
+    put(mmc_model.hc ? 0xC0U : 0x80U);
+    put(0xFFU);
+    put(0x80U);
+    put(0x00U);
+    break;
+  case MMCSD_CMD_CRC_ON_OFF:
+    crc_on = (arg & 1U) != 0U;
+    respond(r1);
+    break;
+  case MMCSD_CMD_SET_BLOCKLEN:
+    respond(arg == MMCSD_BLOCK_SIZE ? 0U : R1_PARAMETER_ERROR);
+    break;
+  case MMCSD_CMD_SEND_CSD:
+    memset(reg, 0, sizeof reg);
+    if (mmc_model.hc) {
+      set_field(reg, 127U, 126U, 1U);
+      set_field(reg, 69U, 48U, (MMC_MODEL_BLOCKS / 1024U) - 1U);
+    }
+    else {
+      /* Capacity is (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) blocks.*/
+      set_field(reg, 83U, 80U, 9U);
+      set_field(reg, 73U, 62U, (MMC_MODEL_BLOCKS / 512U) - 1U);
+      set_field(reg, 49U, 47U, 7U);
+    }
+    set_field(reg, 0U, 0U, 1U);
+    respond(0U);
+    put_block(reg, sizeof reg);
+    break;
+  case MMCSD_CMD_SEND_CID:
+    respond(0U);
+    put_block(cid, sizeof cid);
+    break;
+  case MMCSD_CMD_STOP_TRANSMISSION:
+    /* A stuff byte follows the command.*/
+    mode = MODE_NONE;
+    respond(0xFFU);
+    put(0U);
+    break;
+  case MMCSD_CMD_SEND_STATUS:
+    respond(0U);
+    put(0U);
+    break;
+  case MMCSD_CMD_READ_MULTIPLE_BLOCK:
+    if (!address(arg, &blk)) {
+      respond(R1_ADDRESS_ERROR);
+      break;
+    }
+    mode       = MODE_READ;
+    iframe     = -1;
+    ready_time = time + MMC_MODEL_ACCESS_TIME;
+    respond(0U);
+    break;
+  case MMCSD_CMD_WRITE_MULTIPLE_BLOCK:
+    if (!address(arg, &blk)) {
+      respond(R1_ADDRESS_ERROR);
+      break;
+    }
+    mode = MODE_WRITE;
+    respond(0U);
+    break;
+  case MMCSD_CMD_ERASE_RW_BLK_START:
+    respond(address(arg, &erase_start) ? 0U : R1_ADDRESS_ERROR);
+    break;
+  case MMCSD_CMD_ERASE_RW_BLK_END:
+    respond(address(arg, &erase_end) ? 0U : R1_ADDRESS_ERROR);
+    break;
+  case MMCSD_CMD_ERASE:
+    if (erase_start <= erase_end) {
+      memset(mmc_model.data[erase_start], 0xFF,
+             (erase_end - erase_start + 1U) * MMCSD_BLOCK_SIZE);
+    }
+    busy_time = time + MMC_MODEL_BUSY_TIME;
+    respond(0U);
+    break;
+  default:
+    mmc_model.commands[index]--;
+    respond(r1 | R1_ILLEGAL_COMMAND);
+    break;
+  }
+}
+
+/*
+ * Next byte of a multiple blocks read.
+ */
+static uint8_t stream(uint32_t time) {
+
+  if (iframe < 0) {
+    uint16_t crc;
+
+    if ((int32_t)(time - ready_time) < 0) {
+      return 0xFFU;
+    }
+    if (blk >= MMC_MODEL_BLOCKS) {
+      mode = MODE_NONE;
+      return TOKEN_OUT_OF_RANGE;
+    }
+    memcpy(frame, mmc_model.data[blk], MMCSD_BLOCK_SIZE);
+    crc = crc16(frame, MMCSD_BLOCK_SIZE);
+    if (mmc_model.read_crc_faults > 0U) {
+      mmc_model.read_crc_faults--;
+      crc ^= 0x0001U;
+    }
+    frame[MMCSD_BLOCK_SIZE]      = (uint8_t)(crc >> 8);
+    frame[MMCSD_BLOCK_SIZE + 1U] = (uint8_t)crc;
+    iframe = 0;
+    return TOKEN_START_BLOCK;
+  }
+
+  if (iframe == (int)FRAME_SIZE - 1) {
+    mmc_model.blocks_read++;
+    blk++;
+    iframe     = -1;
+    ready_time = time + MMC_MODEL_ACCESS_TIME;
+    return frame[FRAME_SIZE - 1U];
+  }
+  return frame[iframe++];
+}
+
+/*
+ * Reception of a data block byte during a multiple blocks write.
+ */
+static void receive(uint32_t time, uint8_t mosi) {
+  uint16_t crc;
+
+  frame[iframe++] = mosi;
+  if (iframe < (int)FRAME_SIZE) {
+    return;
+  }
+
+  if (crc_on && (mmc_model.write_crc_faults > 0U)) {
+    mmc_model.write_crc_faults--;
+    frame[0] ^= 0x01U;
+  }
+  crc = (uint16_t)(((uint16_t)frame[MMCSD_BLOCK_SIZE] << 8) |
+                   (uint16_t)frame[MMCSD_BLOCK_SIZE + 1U]);
+  nout = 0U;
+  iout = 0U;
+  if (crc_on && (crc16(frame, MMCSD_BLOCK_SIZE) != crc)) {
+    /* The block is rejected, the host is expected to stop the
+       transmission.*/
+    mmc_model.data_crc_errors++;
+    mode = MODE_REJECTED;
+    put(DATA_CRC_ERROR);
+    return;
+  }
+  if (blk >= MMC_MODEL_BLOCKS) {
+    mode = MODE_REJECTED;
+    put(DATA_WRITE_ERROR);
+    return;
+  }
+
+  /* The data response is followed by the busy signaling.*/
+  memcpy(mmc_model.data[blk], frame, MMCSD_BLOCK_SIZE);
+  mmc_model.blocks_written++;
+  blk++;
+  mode      = MODE_WRITE;
+  busy_time = time + MMC_MODEL_PROGRAM_TIME;
+  put(DATA_ACCEPTED);
+}
+
+/*
+ * Slave select line change.
+ */
+static void mmc_select(bool state) {
+
+  /* A partially received command and a pending response are lost.*/
+  selected = state;
+  ncmd     = 0U;
+  nout     = 0U;
+  iout     = 0U;
+}
+
+/*
+ * Word clocked on the bus.
+ */
+static uint8_t mmc_exchange(uint32_t time, uint8_t mosi) {
+  uint8_t miso;
+
+  if (!inserted || !selected) {
+    return 0xFFU;
+  }
+
+  /* Word sent by the card.*/
+  if (iout < nout) {
+    miso = out[iout++];
+  }
+  else if (mode == MODE_READ) {
+    miso = stream(time);
+  }
+  else if ((int32_t)(time - busy_time) < 0) {
+    miso = 0x00U;
+  }
+  else {
+    miso = 0xFFU;
+  }
+
+  /* Word received by the card.*/
+  switch (mode) {
+  case MODE_WRITE_DATA:
+    receive(time, mosi);
+    break;
+  case MODE_WRITE:
+  case MODE_REJECTED:
+    if (mosi == TOKEN_START_MULTIPLE) {
+      if ((mode == MODE_REJECTED) || (iout < nout) ||
+          ((int32_t)(time - busy_time) < 0)) {
+        mmc_model.protocol_errors++;
+      }
+      else {
+        mode   = MODE_WRITE_DATA;
+        iframe = 0;
+      }
+    }
+    else if (mosi == TOKEN_STOP_TRAN) {
+      if (mode == MODE_WRITE) {
+        busy_time = time + MMC_MODEL_BUSY_TIME;
+      }
+      mode = MODE_NONE;
+    }
+    break;
+  default:
+    if (ncmd > 0U) {
+      cmd[ncmd++] = mosi;
+      if (ncmd == sizeof cmd) {
+        ncmd = 0U;
+        execute(time);
+      }
+    }
+    else if ((mosi & 0xC0U) == 0x40U) {
+      cmd[ncmd++] = mosi;
+    }
+    break;
+  }
+
+  return miso;
+}
+
+static const spi_sim_slave_t mmc_slave = {
+  mmc_select,
+  mmc_exchange
+};
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Inserts a powered off card, the card is attached to the bus.
+ * @details The counters and the faults injection counters are cleared,
+ *          the card memory is retained.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] hc        high capacity card
+ */
+void mmc_model_insert(SPIDriver *spip, bool hc) {
+
+  memset(&mmc_model, 0, offsetof(mmc_model_t, data));
+  mmc_model.hc = hc;
+  inserted     = true;
+  selected     = false;
+  idle         = true;
+  acmd         = false;
+  crc_on       = false;
+  polls        = MMC_MODEL_INIT_POLLS;
+  mode         = MODE_NONE;
+  ncmd         = 0U;
+  nout         = 0U;
+  iout         = 0U;
+  busy_time    = spip->time;
+  ready_time   = spip->time;
+  spip->slave  = &mmc_slave;
+}
+
+/**
+ * @brief   Removes the card, the bus is detached.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ */
+void mmc_model_remove(SPIDriver *spip) {
+
+  inserted = false;
+  spip->slave = NULL;
+}
+
+/**
+ * @brief   Card insertion status.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              The card state.
+ */
+bool mmc_lld_is_card_inserted(MMCDriver *mmcp) {
+
+  (void)mmcp;
+
+  return inserted;
+}
+
+/**
+ * @brief   Card write protection status.
+ *
+ * @param[in] mmcp      pointer to the @p MMCDriver object
+ * @return              The card state.
+ */
+bool mmc_lld_is_write_protected(MMCDriver *mmcp) {
+
+  (void)mmcp;
+
+  return false;
+}
+
+#endif /* HAL_USE_MMC_SPI == TRUE */
+
+/** @} */
@@ -0,0 +1,170 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    mmc_model.h
+ * @brief   SD card SPI mode model header.
+ * @details The model is attached to the simulated SPI bus and emulates an
+ *          SD card in SPI mode, word by word: command frames with their
+ *          CRC-7, R1/R3/R7 responses, multiple blocks reads streaming data
+ *          blocks with their CRC-16 until @p CMD12, multiple blocks writes
+ *          with data responses and busy signaling until the stop token.
+ *          The card access and programming delays are measured on the
+ *          simulated bus timeline.<br>
+ *          The CRC of the commands is checked on @p CMD0 and @p CMD8 and,
+ *          after @p CMD59, on all the commands and on the received data
+ *          blocks. The test code can inject CRC errors in the commands,
+ *          in the data blocks sent by the card and in the data blocks
+ *          received by the card.
+ *
+ * @addtogroup MMC_MODEL
+ * @{
+ */
+
+#ifndef _MMC_MODEL_H_
+#define _MMC_MODEL_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Card capacity in blocks.
+ * @note    Must be a multiple of 1024 blocks, the SDHC cards capacity
+ *          granularity.
+ */
+#if !defined(MMC_MODEL_BLOCKS) || defined(__DOXYGEN__)
+#define MMC_MODEL_BLOCKS            1024U
+#endif
+
+/**
+ * @brief   Number of @p ACMD41 commands answered with the idle state.
+ */
+#if !defined(MMC_MODEL_INIT_POLLS) || defined(__DOXYGEN__)
+#define MMC_MODEL_INIT_POLLS        2U
+#endif
+
+/**
+ * @brief   Delay before each data block sent by the card, in nanoseconds.
+ */
+#if !defined(MMC_MODEL_ACCESS_TIME) || defined(__DOXYGEN__)
+#define MMC_MODEL_ACCESS_TIME       20000U
+#endif
+
+/**
+ * @brief   Programming time of a data block, in nanoseconds.
+ */
+#if !defined(MMC_MODEL_PROGRAM_TIME) || defined(__DOXYGEN__)
+#define MMC_MODEL_PROGRAM_TIME      100000U
+#endif
+
+/**
+ * @brief   Busy time after the stop token or an erase command, in
+ *          nanoseconds.
+ */
+#if !defined(MMC_MODEL_BUSY_TIME) || defined(__DOXYGEN__)
+#define MMC_MODEL_BUSY_TIME         20000U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (MMC_MODEL_BLOCKS % 1024U) != 0U
+#error "invalid MMC_MODEL_BLOCKS value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Card model.
+ */
+typedef struct {
+  /**
+   * @brief   High capacity card, addresses are block numbers.
+   */
+  bool                      hc;
+  /**
+   * @brief   Number of the next CRC checked commands received corrupted.
+   */
+  uint32_t                  cmd_crc_faults;
+  /**
+   * @brief   Number of the next data blocks sent with a wrong CRC.
+   */
+  uint32_t                  read_crc_faults;
+  /**
+   * @brief   Number of the next CRC checked data blocks received
+   *          corrupted.
+   */
+  uint32_t                  write_crc_faults;
+  /**
+   * @brief   Accepted commands, by command index.
+   */
+  uint32_t                  commands[64];
+  /**
+   * @brief   Commands rejected because of a CRC error.
+   */
+  uint32_t                  cmd_crc_errors;
+  /**
+   * @brief   Data blocks rejected because of a CRC error.
+   */
+  uint32_t                  data_crc_errors;
+  /**
+   * @brief   Data blocks sent by the card.
+   */
+  uint32_t                  blocks_read;
+  /**
+   * @brief   Data blocks programmed.
+   */
+  uint32_t                  blocks_written;
+  /**
+   * @brief   Protocol violations by the host.
+   */
+  uint32_t                  protocol_errors;
+  /**
+   * @brief   Card memory.
+   */
+  uint8_t                   data[MMC_MODEL_BLOCKS][MMCSD_BLOCK_SIZE];
+} mmc_model_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern mmc_model_t mmc_model;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void mmc_model_insert(SPIDriver *spip, bool hc);
+  void mmc_model_remove(SPIDriver *spip);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MMC_MODEL_H_ */
+
+/** @} */
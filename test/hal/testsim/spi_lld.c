@@ -0,0 +1,337 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    spi_lld.c
+ * @brief   Simulated SPI subsystem low level driver source.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#include "hal.h"
+
+#if (HAL_USE_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   SPI1 driver identifier.
+ */
+#if (PLATFORM_SPI_USE_SPI1 == TRUE) || defined(__DOXYGEN__)
+SPIDriver SPID1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Starts a transfer.
+ * @details Transfers started from the completion interrupt are armed at
+ *          the end of the interrupt, other transfers are armed immediately
+ *          and the caller is holding the system lock.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be transferred
+ * @param[in] txbuf     the pointer to the transmit buffer or @p NULL
+ * @param[out] rxbuf    the pointer to the receive buffer or @p NULL
+ */
+static void start_transfer(SPIDriver *spip, size_t n,
+                           const void *txbuf, void *rxbuf);
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Transfer completion, the virtual timer emulates the interrupt.
+ *
+ * @param[in] p         pointer to the @p SPIDriver object
+ */
+static void spi_lld_serve_interrupt(void *p) {
+  SPIDriver *spip = (SPIDriver *)p;
+  size_t i;
+
+  /* Data exchanged with the slave.*/
+  if (spip->slave != NULL) {
+    uint32_t t = spip->time - ((uint32_t)spip->n * spip->config->word_time);
+
+    for (i = 0U; i < spip->n; i++) {
+      uint8_t miso;
+
+      t += spip->config->word_time;
+      miso = spip->slave->exchange(t, spip->txbuf != NULL ? spip->txbuf[i] :
+                                                            0xFFU);
+      if (spip->rxbuf != NULL) {
+        spip->rxbuf[i] = miso;
+      }
+    }
+  }
+  else if (spip->rxbuf != NULL) {
+    for (i = 0U; i < spip->n; i++) {
+      spip->rxbuf[i] = spip->txbuf != NULL ? spip->txbuf[i] : spip->miso++;
+    }
+  }
+
+  spip->interrupts++;
+  spip->isr     = true;
+  spip->restart = false;
+  _spi_isr_code(spip);
+  spip->isr     = false;
+
+  if (spip->restart) {
+    osalSysLockFromISR();
+    osalTimerSetI(&spip->vt, (systime_t)1, spi_lld_serve_interrupt, spip);
+    osalSysUnlockFromISR();
+  }
+}
+
+static void start_transfer(SPIDriver *spip, size_t n,
+                           const void *txbuf, void *rxbuf) {
+  uint32_t start;
+
+  start = spip->time + (spip->isr ? SPI_SIM_ISR_LATENCY :
+                                    SPI_SIM_THREAD_LATENCY);
+  spip->time  = start + ((uint32_t)n * spip->config->word_time);
+  spip->txbuf = (const uint8_t *)txbuf;
+  spip->rxbuf = (uint8_t *)rxbuf;
+  spip->n     = n;
+
+  if (spip->nlog < SPI_SIM_LOG_SIZE) {
+    spi_sim_transfer_t *tp = &spip->log[spip->nlog++];
+
+    tp->config   = spip->config;
+    tp->n        = n;
+    tp->start    = start;
+    tp->end      = spip->time;
+    tp->selected = spip->selected;
+    tp->isr      = spip->isr;
+  }
+
+  if (spip->isr) {
+    spip->restart = true;
+  }
+  else {
+    osalTimerSetI(&spip->vt, (systime_t)1, spi_lld_serve_interrupt, spip);
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+#if PLATFORM_SPI_USE_SPI1 == TRUE
+  spiObjectInit(&SPID1);
+  osalTimerObjectInit(&SPID1.vt);
+  SPID1.isr      = false;
+  SPID1.selected = false;
+  SPID1.slave    = NULL;
+  spi_lld_reset_log(&SPID1);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ * @note    The function can be invoked from the completion interrupt in
+ *          order to switch configuration between queued transactions.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_start(SPIDriver *spip) {
+
+  osalDbgAssert(spip->config->word_time > 0U, "invalid word time");
+
+  spip->starts++;
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+
+  osalTimerResetI(&spip->vt);
+  spip->selected = false;
+  if (spip->slave != NULL) {
+    spip->slave->select(false);
+  }
+}
+
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+
+  spip->selected = true;
+  spip->selects++;
+  if (spip->slave != NULL) {
+    spip->slave->select(true);
+  }
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ * @details The previously selected peripheral is unselected.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+
+  spip->selected = false;
+  spip->unselects++;
+  if (spip->slave != NULL) {
+    spip->slave->select(false);
+  }
+}
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ * @details This asynchronous function starts the transmission of a series of
+ *          idle words on the SPI bus and ignores the received data.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ *
+ * @notapi
+ */
+void spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  start_transfer(spip, n, NULL, NULL);
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ * @details This asynchronous function starts a simultaneous transmit/receive
+ *          operation, the slave returns the transmitted data.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_exchange(SPIDriver *spip, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  start_transfer(spip, n, txbuf, rxbuf);
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ * @details This asynchronous function starts a transmit operation.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  start_transfer(spip, n, txbuf, NULL);
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ * @details This asynchronous function starts a receive operation, the
+ *          slave returns a running counter.
+ * @post    At the end of the operation the configured callback is invoked.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  start_transfer(spip, n, NULL, rxbuf);
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ * @details This synchronous function exchanges one frame using a polled
+ *          synchronization method, the slave returns the transmitted frame
+ *          unless a slave model is attached.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+
+  if (spip->slave != NULL) {
+    spip->time += SPI_SIM_THREAD_LATENCY + spip->config->word_time;
+    return (uint16_t)spip->slave->exchange(spip->time, (uint8_t)frame);
+  }
+
+  return frame;
+}
+
+/**
+ * @brief   Clears the transfers log and restarts the bus timeline.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_reset_log(SPIDriver *spip) {
+
+  spip->miso       = 0U;
+  spip->time       = 0U;
+  spip->starts     = 0U;
+  spip->selects    = 0U;
+  spip->unselects  = 0U;
+  spip->interrupts = 0U;
+  spip->nlog       = 0U;
+}
+
+#endif /* HAL_USE_SPI == TRUE */
+
+/** @} */
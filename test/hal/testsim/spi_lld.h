@@ -0,0 +1,311 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    spi_lld.h
+ * @brief   Simulated SPI subsystem low level driver header.
+ * @details The driver emulates a master with the MISO line returning the
+ *          MOSI data during exchanges and a running counter during
+ *          receptions, unless a slave model is attached to the bus.
+ *          Transfers are completed by a virtual timer, the
+ *          driver also keeps a simulated bus timeline where each word
+ *          takes the configured time and the gap before a transfer depends
+ *          on the transfer being started from the completion interrupt of
+ *          the previous one or by a thread. The segments executed on the
+ *          timeline are logged for the test code.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#ifndef _SPI_LLD_H_
+#define _SPI_LLD_H_
+
+#if (HAL_USE_SPI == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Reconfiguration from ISR context support in the driver.
+ */
+#define SPI_SUPPORTS_ISR_RECONFIG   TRUE
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   SPI1 driver enable switch.
+ */
+#if !defined(PLATFORM_SPI_USE_SPI1) || defined(__DOXYGEN__)
+#define PLATFORM_SPI_USE_SPI1       TRUE
+#endif
+
+/**
+ * @brief   Number of entries in the transfers log.
+ */
+#if !defined(SPI_SIM_LOG_SIZE) || defined(__DOXYGEN__)
+#define SPI_SIM_LOG_SIZE            16
+#endif
+
+/**
+ * @brief   Bus gap before a transfer started from the completion
+ *          interrupt of the previous one, in nanoseconds.
+ */
+#if !defined(SPI_SIM_ISR_LATENCY) || defined(__DOXYGEN__)
+#define SPI_SIM_ISR_LATENCY         500U
+#endif
+
+/**
+ * @brief   Bus gap before a transfer started by a thread, in nanoseconds.
+ * @details The time includes the completion interrupt, the wakeup of the
+ *          waiting thread and the context switch.
+ */
+#if !defined(SPI_SIM_THREAD_LATENCY) || defined(__DOXYGEN__)
+#define SPI_SIM_THREAD_LATENCY      5000U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a structure representing an SPI driver.
+ */
+typedef struct SPIDriver SPIDriver;
+
+/**
+ * @brief   SPI notification callback type.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object triggering the
+ *                      callback
+ */
+typedef void (*spicallback_t)(SPIDriver *spip);
+
+/**
+ * @brief   Driver configuration structure.
+ * @note    The simulated driver only handles 8 bits words.
+ */
+typedef struct {
+  /**
+   * @brief Operation complete callback or @p NULL.
+   */
+  spicallback_t             end_cb;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Duration of a word on the simulated bus in nanoseconds.
+   */
+  uint32_t                  word_time;
+} SPIConfig;
+
+/**
+ * @brief   Slave model attached to the bus.
+ */
+typedef struct {
+  /**
+   * @brief   Slave select line change.
+   *
+   * @param[in] selected    the new slave select state
+   */
+  void                      (*select)(bool selected);
+  /**
+   * @brief   Exchange of a word, invoked for each word clocked on the bus.
+   *
+   * @param[in] time        bus time of the word end in nanoseconds
+   * @param[in] mosi        word sent by the master, 0xFF when the master
+   *                        is not transmitting
+   * @return                The word returned by the slave.
+   */
+  uint8_t                   (*exchange)(uint32_t time, uint8_t mosi);
+} spi_sim_slave_t;
+
+/**
+ * @brief   Entry of the transfers log.
+ */
+typedef struct {
+  /**
+   * @brief   Configuration used for the transfer.
+   */
+  const SPIConfig           *config;
+  /**
+   * @brief   Number of words.
+   */
+  size_t                    n;
+  /**
+   * @brief   Bus time of the transfer start in nanoseconds.
+   */
+  uint32_t                  start;
+  /**
+   * @brief   Bus time of the transfer end in nanoseconds.
+   */
+  uint32_t                  end;
+  /**
+   * @brief   Slave selected during the transfer.
+   */
+  bool                      selected;
+  /**
+   * @brief   Transfer started from the completion interrupt.
+   */
+  bool                      isr;
+} spi_sim_transfer_t;
+
+/**
+ * @brief   Structure representing an SPI driver.
+ */
+struct SPIDriver {
+  /**
+   * @brief Driver state.
+   */
+  spistate_t                state;
+  /**
+   * @brief Current configuration data.
+   */
+  const SPIConfig           *config;
+#if (SPI_USE_WAIT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Waiting thread.
+   */
+  thread_reference_t        thread;
+#endif
+#if (SPI_USE_MUTUAL_EXCLUSION == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Mutex protecting the peripheral.
+   */
+  mutex_t                   mutex;
+#endif
+#if (SPI_USE_TRANSFER_LIST == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Segment of the transfer list in progress or @p NULL.
+   */
+  const SPISegment          *segp;
+  /**
+   * @brief   Segments of the transfer list not yet completed.
+   */
+  size_t                    segcnt;
+#endif
+#if (SPI_USE_QUEUE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Transactions queue.
+   */
+  spi_queue_t               queue;
+#endif
+#if defined(SPI_DRIVER_EXT_FIELDS)
+  SPI_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Transfer completion timer.
+   */
+  virtual_timer_t           vt;
+  /**
+   * @brief   Completion interrupt in progress.
+   */
+  bool                      isr;
+  /**
+   * @brief   Transfer started from the completion interrupt.
+   */
+  bool                      restart;
+  /**
+   * @brief   Transfer in progress.
+   */
+  const uint8_t             *txbuf;
+  uint8_t                   *rxbuf;
+  size_t                    n;
+  /**
+   * @brief   Slave select state.
+   */
+  bool                      selected;
+  /**
+   * @brief   Attached slave model or @p NULL.
+   */
+  const spi_sim_slave_t     *slave;
+  /**
+   * @brief   Next word returned by the slave during receptions.
+   */
+  uint8_t                   miso;
+  /**
+   * @brief   Bus time of the last transfer end in nanoseconds.
+   */
+  uint32_t                  time;
+  /**
+   * @brief   Number of peripheral configurations.
+   */
+  uint32_t                  starts;
+  /**
+   * @brief   Number of slave selections.
+   */
+  uint32_t                  selects;
+  /**
+   * @brief   Number of slave deselections.
+   */
+  uint32_t                  unselects;
+  /**
+   * @brief   Number of completion interrupts.
+   */
+  uint32_t                  interrupts;
+  /**
+   * @brief   Number of logged transfers.
+   */
+  unsigned                  nlog;
+  /**
+   * @brief   Transfers log, the transfers exceeding its size are executed
+   *          but not logged.
+   */
+  spi_sim_transfer_t        log[SPI_SIM_LOG_SIZE];
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (PLATFORM_SPI_USE_SPI1 == TRUE) && !defined(__DOXYGEN__)
+extern SPIDriver SPID1;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void spi_lld_init(void);
+  void spi_lld_start(SPIDriver *spip);
+  void spi_lld_stop(SPIDriver *spip);
+  void spi_lld_select(SPIDriver *spip);
+  void spi_lld_unselect(SPIDriver *spip);
+  void spi_lld_ignore(SPIDriver *spip, size_t n);
+  void spi_lld_exchange(SPIDriver *spip, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf);
+  void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf);
+  uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame);
+  void spi_lld_reset_log(SPIDriver *spip);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SPI == TRUE */
+
+#endif /* _SPI_LLD_H_ */
+
+/** @} */
@@ -0,0 +1,591 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    can_model.c
+ * @brief   bxCAN cell register level model code.
+ *
+ * @addtogroup CAN_MODEL
+ * @{
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Registers reset values.*/
+#define MCR_RESET               0x00010002U
+#define MSR_RESET               0x00000C02U
+#define TSR_RESET               0x1C000000U
+#define FMR_RESET               0x2A1C0E01U
+
+/* Per mailbox TSR bits.*/
+#define TSR_RQCP(n)             (CAN_TSR_RQCP0 << ((n) * 8U))
+#define TSR_TXOK(n)             (CAN_TSR_TXOK0 << ((n) * 8U))
+#define TSR_ABRQ(n)             (CAN_TSR_ABRQ0 << ((n) * 8U))
+#define TSR_STATUS(n)           ((CAN_TSR_RQCP0 | CAN_TSR_TXOK0 |           \
+                                  CAN_TSR_ALST0 | CAN_TSR_TERR0) << ((n) * 8U))
+#define TSR_TME(n)              (CAN_TSR_TME0 << (n))
+
+/* Per FIFO IER bits, the FIFO 1 bits follow the FIFO 0 ones.*/
+#define IER_FMPIE(f)            (CAN_IER_FMPIE0 << ((f) * 3U))
+#define IER_FFIE(f)             (CAN_IER_FFIE0 << ((f) * 3U))
+#define IER_FOVIE(f)            (CAN_IER_FOVIE0 << ((f) * 3U))
+
+/* Start bank of CAN2 in the FMR register.*/
+#define FMR_CAN2SB(fmr)         (((fmr) & CAN_FMR_CAN2SB) >> 8)
+
+/* Number of transmit mailboxes.*/
+#define TX_MAILBOXES            3U
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   CAN1 registers block.
+ */
+can_model_page_t can_model __attribute__((aligned(CAN_MODEL_PAGE_SIZE)));
+
+/**
+ * @brief   Model counters.
+ */
+can_model_counters_t can_model_counters;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Frame as stored in a receive FIFO mailbox.
+ */
+typedef struct {
+  uint32_t                      rir;
+  uint32_t                      rdtr;
+  uint32_t                      rdlr;
+  uint32_t                      rdhr;
+} frame_t;
+
+/**
+ * @brief   Receive FIFO.
+ */
+typedef struct {
+  frame_t                       frames[CAN_MODEL_FIFO_DEPTH];
+  unsigned                      count;
+} fifo_t;
+
+static fifo_t fifos[2];
+static unsigned tx_order[TX_MAILBOXES];
+static unsigned tx_pending;
+static uint16_t bus_time;
+static bool irq_check;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+CH_IRQ_HANDLER(STM32_CAN1_TX_HANDLER);
+CH_IRQ_HANDLER(STM32_CAN1_RX0_HANDLER);
+CH_IRQ_HANDLER(STM32_CAN1_RX1_HANDLER);
+
+/**
+ * @brief   Registers access by the model.
+ */
+static void regs_unlock(void) {
+
+  regs_trap_unlock(&can_model, sizeof can_model);
+}
+
+/**
+ * @brief   Registers access by the driver, each access is trapped.
+ */
+static void regs_lock(void) {
+
+  regs_trap_lock(&can_model, sizeof can_model);
+}
+
+/**
+ * @brief   Returns the receive FIFO status register.
+ *
+ * @param[in] f         FIFO number
+ */
+static volatile uint32_t *fifo_rfr(unsigned f) {
+
+  return f == 0U ? &can_model.regs.RF0R : &can_model.regs.RF1R;
+}
+
+/**
+ * @brief   Updates the registers of a receive FIFO, the output mailbox
+ *          exposes the oldest frame.
+ *
+ * @param[in] f         FIFO number
+ */
+static void fifo_update(unsigned f) {
+  fifo_t *fp = &fifos[f];
+  CAN_FIFOMailBox_TypeDef *mbp = &can_model.regs.sFIFOMailBox[f];
+
+  *fifo_rfr(f) = (*fifo_rfr(f) & ~CAN_RF0R_FMP0) | fp->count;
+  if (fp->count > 0U) {
+    mbp->RIR  = fp->frames[0].rir;
+    mbp->RDTR = fp->frames[0].rdtr;
+    mbp->RDLR = fp->frames[0].rdlr;
+    mbp->RDHR = fp->frames[0].rdhr;
+  }
+  irq_check = true;
+}
+
+/**
+ * @brief   Stores a frame in a receive FIFO.
+ * @details If the FIFO is full the new frame is discarded in locked mode or
+ *          it replaces the last stored frame.
+ *
+ * @param[in] f         FIFO number
+ * @param[in] framep    the frame
+ */
+static void fifo_store(unsigned f, const frame_t *framep) {
+  fifo_t *fp = &fifos[f];
+
+  if (fp->count < CAN_MODEL_FIFO_DEPTH) {
+    fp->frames[fp->count++] = *framep;
+    if (fp->count == CAN_MODEL_FIFO_DEPTH) {
+      *fifo_rfr(f) |= CAN_RF0R_FULL0;
+    }
+    can_model_counters.received++;
+  }
+  else {
+    *fifo_rfr(f) |= CAN_RF0R_FOVR0;
+    if ((can_model.regs.MCR & CAN_MCR_RFLM) == 0U) {
+      fp->frames[CAN_MODEL_FIFO_DEPTH - 1U] = *framep;
+    }
+    can_model_counters.overruns++;
+  }
+  fifo_update(f);
+}
+
+/**
+ * @brief   Releases the output mailbox of a receive FIFO.
+ *
+ * @param[in] f         FIFO number
+ */
+static void fifo_release(unsigned f) {
+  fifo_t *fp = &fifos[f];
+  unsigned i;
+
+  if (fp->count > 0U) {
+    fp->count--;
+    for (i = 0U; i < fp->count; i++) {
+      fp->frames[i] = fp->frames[i + 1U];
+    }
+  }
+  fifo_update(f);
+}
+
+/**
+ * @brief   Matches an identifier against a filter.
+ *
+ * @param[in] rir       identifier in the @p RIR register format
+ * @param[in] frp       the filter bank registers
+ * @param[in] scale32   @p true for a 32 bits scale bank
+ * @param[in] list      @p true for a bank in list mode
+ * @param[in] i         filter number inside the bank
+ * @return              The match result.
+ */
+static bool filter_hit(uint32_t rir, const CAN_FilterRegister_TypeDef *frp,
+                       bool scale32, bool list, unsigned i) {
+  uint32_t h[4], id16;
+
+  if (scale32) {
+    if (list) {
+      return ((rir ^ (i == 0U ? frp->FR1 : frp->FR2)) & ~1U) == 0U;
+    }
+    return ((rir ^ frp->FR1) & frp->FR2 & ~1U) == 0U;
+  }
+
+  /* 16 bits scale, STID[10:0], RTR, IDE and EXID[17:15].*/
+  id16 = ((rir >> 16) & 0xFFE0U) | ((rir << 3) & 0x0010U) |
+         ((rir << 1) & 0x0008U) | ((rir >> 18) & 0x0007U);
+  h[0] = frp->FR1 & 0xFFFFU;
+  h[1] = frp->FR1 >> 16;
+  h[2] = frp->FR2 & 0xFFFFU;
+  h[3] = frp->FR2 >> 16;
+  if (list) {
+    return id16 == h[i];
+  }
+  return ((id16 ^ h[i * 2U]) & h[(i * 2U) + 1U]) == 0U;
+}
+
+/**
+ * @brief   Finds the filter accepting an identifier.
+ * @details The filters of the banks assigned to CAN1 are scanned, the
+ *          32 bits scale filters take precedence over the 16 bits ones,
+ *          then the list mode takes precedence over the mask mode and then
+ *          the lowest filter number wins. Filter numbers are counted per
+ *          FIFO over all the banks, active or not.
+ *
+ * @param[in] rir       identifier in the @p RIR register format
+ * @param[out] fifop    the FIFO of the matching filter
+ * @param[out] fmip     the filter match index
+ * @return              The match result.
+ */
+static bool filter_match(uint32_t rir, unsigned *fifop, unsigned *fmip) {
+  CAN_TypeDef *cp = &can_model.regs;
+  unsigned numbers[2] = {0U, 0U};
+  unsigned bank, rank, best = 4U;
+
+  /* Reception is deactivated while the filters are initialized.*/
+  if ((cp->FMR & CAN_FMR_FINIT) != 0U) {
+    return false;
+  }
+
+  for (bank = 0U; bank < FMR_CAN2SB(cp->FMR); bank++) {
+    uint32_t bit = 1U << bank;
+    unsigned f = (cp->FFA1R & bit) != 0U ? 1U : 0U;
+    bool scale32 = (cp->FS1R & bit) != 0U;
+    bool list = (cp->FM1R & bit) != 0U;
+    unsigned i, n = (scale32 ? 1U : 2U) * (list ? 2U : 1U);
+
+    if ((cp->FA1R & bit) != 0U) {
+      rank = (scale32 ? 0U : 2U) + (list ? 0U : 1U);
+      for (i = 0U; (i < n) && (rank < best); i++) {
+        if (filter_hit(rir, &cp->sFilterRegister[bank], scale32, list, i)) {
+          best   = rank;
+          *fifop = f;
+          *fmip  = numbers[f] + i;
+        }
+      }
+    }
+    numbers[f] += n;
+  }
+
+  return best < 4U;
+}
+
+/**
+ * @brief   Frame received from the bus.
+ *
+ * @param[in] framep    the frame, the match index is filled by the model
+ */
+static void receive(frame_t *framep) {
+  unsigned f, fmi;
+
+  if ((can_model.regs.MSR & (CAN_MSR_INAK | CAN_MSR_SLAK)) != 0U) {
+    return;
+  }
+
+  if (!filter_match(framep->rir, &f, &fmi)) {
+    can_model_counters.filtered++;
+    return;
+  }
+  framep->rdtr |= (fmi << 8) | ((uint32_t)bus_time << 16);
+  fifo_store(f, framep);
+}
+
+/**
+ * @brief   Updates the mailbox code field, the first empty mailbox.
+ */
+static void tx_update_code(void) {
+  CAN_TypeDef *cp = &can_model.regs;
+  unsigned n;
+
+  for (n = 0U; n < TX_MAILBOXES; n++) {
+    if ((cp->TSR & TSR_TME(n)) != 0U) {
+      cp->TSR = (cp->TSR & ~CAN_TSR_CODE) | (n << 24);
+      break;
+    }
+  }
+}
+
+/**
+ * @brief   Removes a mailbox from the pending ones.
+ *
+ * @param[in] i         position of the mailbox in the requests order
+ */
+static void tx_remove(unsigned i) {
+
+  tx_pending--;
+  for (; i < tx_pending; i++) {
+    tx_order[i] = tx_order[i + 1U];
+  }
+}
+
+/**
+ * @brief   Transmission request on a mailbox.
+ *
+ * @param[in] n         mailbox number
+ * @param[in] tsr       the @p TSR register value
+ */
+static void tx_request(unsigned n, uint32_t tsr) {
+
+  /* Requests on non empty mailboxes are ignored.*/
+  if ((tsr & TSR_TME(n)) == 0U) {
+    return;
+  }
+  can_model.regs.TSR &= ~TSR_TME(n);
+  tx_order[tx_pending++] = n;
+  tx_update_code();
+}
+
+/**
+ * @brief   Transmission abort request on a mailbox.
+ *
+ * @param[in] n         mailbox number
+ */
+static void tx_abort(unsigned n) {
+  unsigned i;
+
+  for (i = 0U; i < tx_pending; i++) {
+    if (tx_order[i] == n) {
+      tx_remove(i);
+      can_model.regs.sTxMailBox[n].TIR &= ~CAN_TI0R_TXRQ;
+      can_model.regs.TSR |= TSR_RQCP(n) | TSR_TME(n);
+      tx_update_code();
+      break;
+    }
+  }
+}
+
+/**
+ * @brief   Sends the next pending frame on the bus.
+ * @details The mailboxes are served in request order if the transmit FIFO
+ *          priority is enabled, else the lowest identifier wins.
+ */
+static void tx_send(void) {
+  CAN_TypeDef *cp = &can_model.regs;
+  CAN_TxMailBox_TypeDef *mbp;
+  frame_t frame;
+  unsigned i, sel = 0U, n;
+
+  if ((cp->MCR & CAN_MCR_TXFP) == 0U) {
+    for (i = 1U; i < tx_pending; i++) {
+      if ((cp->sTxMailBox[tx_order[i]].TIR & ~CAN_TI0R_TXRQ) <
+          (cp->sTxMailBox[tx_order[sel]].TIR & ~CAN_TI0R_TXRQ)) {
+        sel = i;
+      }
+    }
+  }
+  n = tx_order[sel];
+  tx_remove(sel);
+
+  mbp = &cp->sTxMailBox[n];
+  frame.rir  = mbp->TIR & ~CAN_TI0R_TXRQ;
+  frame.rdtr = mbp->TDTR & CAN_TDT0R_DLC;
+  frame.rdlr = mbp->TDLR;
+  frame.rdhr = mbp->TDHR;
+  mbp->TIR   = frame.rir;
+
+  bus_time++;
+  can_model_counters.sent++;
+  cp->TSR |= TSR_RQCP(n) | TSR_TXOK(n) | TSR_TME(n);
+  tx_update_code();
+  irq_check = true;
+
+  /* In loop back mode the transmitted frames are received back.*/
+  if ((cp->BTR & CAN_BTR_LBKM) != 0U) {
+    receive(&frame);
+  }
+}
+
+/**
+ * @brief   Applies the side effects of a register write.
+ *
+ * @param[in] offset    offset of the written register
+ * @param[in] old       the register value before the write
+ */
+static void reg_written(size_t offset, uint32_t old) {
+  CAN_TypeDef *cp = &can_model.regs;
+  uint32_t w = *(volatile uint32_t *)(can_model.page + offset);
+  unsigned n;
+
+  irq_check = true;
+  if (offset == offsetof(CAN_TypeDef, MCR)) {
+    /* Modes are entered and left immediately.*/
+    cp->MSR &= ~(CAN_MSR_INAK | CAN_MSR_SLAK);
+    if ((w & CAN_MCR_INRQ) != 0U) {
+      cp->MSR |= CAN_MSR_INAK;
+    }
+    else if ((w & CAN_MCR_SLEEP) != 0U) {
+      cp->MSR |= CAN_MSR_SLAK;
+    }
+  }
+  else if (offset == offsetof(CAN_TypeDef, MSR)) {
+    cp->MSR = old & ~(w & (CAN_MSR_ERRI | CAN_MSR_WKUI | CAN_MSR_SLAKI));
+  }
+  else if (offset == offsetof(CAN_TypeDef, TSR)) {
+    cp->TSR = old;
+    for (n = 0U; n < TX_MAILBOXES; n++) {
+      if ((w & TSR_RQCP(n)) != 0U) {
+        cp->TSR &= ~TSR_STATUS(n);
+      }
+      if ((w & TSR_ABRQ(n)) != 0U) {
+        tx_abort(n);
+      }
+    }
+  }
+  else if ((offset == offsetof(CAN_TypeDef, RF0R)) ||
+           (offset == offsetof(CAN_TypeDef, RF1R))) {
+    n = offset == offsetof(CAN_TypeDef, RF0R) ? 0U : 1U;
+    *fifo_rfr(n) = old & ~(w & (CAN_RF0R_FULL0 | CAN_RF0R_FOVR0));
+    if ((w & CAN_RF0R_RFOM0) != 0U) {
+      fifo_release(n);
+    }
+  }
+  else if ((offset >= offsetof(CAN_TypeDef, sTxMailBox)) &&
+           (offset < offsetof(CAN_TypeDef, sFIFOMailBox)) &&
+           ((offset % sizeof (CAN_TxMailBox_TypeDef)) == 0U)) {
+    n = (unsigned)((offset - offsetof(CAN_TypeDef, sTxMailBox)) /
+                   sizeof (CAN_TxMailBox_TypeDef));
+    if ((w & CAN_TI0R_TXRQ) != 0U) {
+      tx_request(n, cp->TSR);
+    }
+  }
+}
+
+/**
+ * @brief   Returns the handler of the highest priority active interrupt.
+ * @note    The status change and error interrupts are not emulated.
+ */
+static void (*irq_active(void))(void) {
+  CAN_TypeDef *cp = &can_model.regs;
+  unsigned f;
+
+  if (((cp->IER & CAN_IER_TMEIE) != 0U) &&
+      ((cp->TSR & (TSR_RQCP(0) | TSR_RQCP(1) | TSR_RQCP(2))) != 0U)) {
+    return STM32_CAN1_TX_HANDLER;
+  }
+  for (f = 0U; f < 2U; f++) {
+    uint32_t rfr = *fifo_rfr(f);
+
+    if ((((cp->IER & IER_FMPIE(f)) != 0U) && ((rfr & CAN_RF0R_FMP0) != 0U)) ||
+        (((cp->IER & IER_FFIE(f)) != 0U) && ((rfr & CAN_RF0R_FULL0) != 0U)) ||
+        (((cp->IER & IER_FOVIE(f)) != 0U) && ((rfr & CAN_RF0R_FOVR0) != 0U))) {
+      return f == 0U ? STM32_CAN1_RX0_HANDLER : STM32_CAN1_RX1_HANDLER;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Raises the active interrupts.
+ * @details The handlers are invoked as long as an interrupt source is
+ *          active, a reschedule is performed after each handler like on
+ *          the exit of a real interrupt.
+ * @note    Must be invoked with the registers locked.
+ */
+static void raise_irqs(void) {
+  void (*handler)(void);
+
+  while (irq_check) {
+    irq_check = false;
+    regs_unlock();
+    handler = irq_active();
+    regs_lock();
+    if (handler == NULL) {
+      break;
+    }
+
+    can_model_counters.irqs++;
+    irq_check = true;
+    handler();
+
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Model initialization, the registers take their reset values.
+ */
+void can_model_init(void) {
+
+  regs_unlock();
+  memset(&can_model, 0, sizeof can_model);
+  memset(&can_model_counters, 0, sizeof can_model_counters);
+  memset(fifos, 0, sizeof fifos);
+  can_model.regs.MCR = MCR_RESET;
+  can_model.regs.MSR = MSR_RESET;
+  can_model.regs.TSR = TSR_RESET;
+  can_model.regs.FMR = FMR_RESET;
+  tx_pending = 0U;
+  bus_time   = 0U;
+  irq_check  = false;
+
+  regs_trap_register(&can_model, sizeof can_model, reg_written);
+}
+
+/**
+ * @brief   Interrupts check.
+ * @details A pending frame is sent on the bus then the active interrupts
+ *          are raised.
+ */
+void can_model_check_for_interrupts(void) {
+
+  if (tx_pending > 0U) {
+    regs_unlock();
+    if ((can_model.regs.MSR & (CAN_MSR_INAK | CAN_MSR_SLAK)) == 0U) {
+      tx_send();
+    }
+    regs_lock();
+  }
+  raise_irqs();
+}
+
+/**
+ * @brief   A node on the bus sends a data frame.
+ * @note    In loop back mode the cell is disconnected from the bus and the
+ *          frame is ignored.
+ *
+ * @param[in] ide       @p true for an extended identifier
+ * @param[in] id        the identifier
+ * @param[in] data      the frame data
+ * @param[in] dlc       the data length, up to eight bytes
+ */
+void can_model_bus_send(bool ide, uint32_t id,
+                        const uint8_t *data, unsigned dlc) {
+  frame_t frame;
+  uint8_t buf[8];
+
+  osalDbgCheck(dlc <= 8U);
+
+  memset(buf, 0, sizeof buf);
+  memcpy(buf, data, dlc);
+  frame.rir  = ide ? ((id << 3) | CAN_RI0R_IDE) : (id << 21);
+  frame.rdtr = dlc;
+  memcpy(&frame.rdlr, &buf[0], 4U);
+  memcpy(&frame.rdhr, &buf[4], 4U);
+
+  regs_unlock();
+  bus_time++;
+  if ((can_model.regs.BTR & CAN_BTR_LBKM) == 0U) {
+    receive(&frame);
+  }
+  regs_lock();
+  raise_irqs();
+}
+
+/** @} */
@@ -0,0 +1,131 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    can_model.h
+ * @brief   bxCAN cell register level model header.
+ * @details The model emulates the CAN1 cell and the filter banks shared
+ *          with CAN2. The registers accesses are trapped in order to apply
+ *          the side effects of the writes when the accessing instruction
+ *          completes: transmission requests, output mailbox releases and
+ *          the write-one-to-clear flags act immediately like on the real
+ *          cell.<br>
+ *          The requested frames are sent on the bus one for each interrupts
+ *          check, in loop back mode they are received back through the
+ *          filters, frames from other nodes are injected by the
+ *          @p can_model_bus_send() function. The interrupt handlers are
+ *          invoked in the context of the thread injecting the frames or
+ *          of the interrupts check.
+ *
+ * @addtogroup CAN_MODEL
+ * @{
+ */
+
+#ifndef _CAN_MODEL_H_
+#define _CAN_MODEL_H_
+
+#include "stm32f4xx.h"
+#include "regs_trap.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the protected page containing the registers block.
+ */
+#define CAN_MODEL_PAGE_SIZE                 REGS_TRAP_PAGE_SIZE
+
+/**
+ * @brief   Depth of the receive FIFOs of the cell.
+ */
+#define CAN_MODEL_FIFO_DEPTH                3U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers block page.
+ */
+typedef union {
+  CAN_TypeDef                   regs;
+  uint8_t                       page[CAN_MODEL_PAGE_SIZE];
+} can_model_page_t;
+
+/**
+ * @brief   Model counters.
+ */
+typedef struct {
+  /**
+   * @brief   Frames sent on the bus by the cell.
+   */
+  uint32_t                      sent;
+  /**
+   * @brief   Frames stored in the receive FIFOs.
+   */
+  uint32_t                      received;
+  /**
+   * @brief   Frames not matching any filter.
+   */
+  uint32_t                      filtered;
+  /**
+   * @brief   Frames lost because a receive FIFO was full.
+   */
+  uint32_t                      overruns;
+  /**
+   * @brief   Interrupts raised.
+   */
+  uint32_t                      irqs;
+} can_model_counters_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/* The CAN1 registers block is the model.*/
+#undef CAN1
+#define CAN1                                (&can_model.regs)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern can_model_page_t can_model;
+extern can_model_counters_t can_model_counters;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void can_model_init(void);
+  void can_model_check_for_interrupts(void);
+  void can_model_bus_send(bool ide, uint32_t id,
+                          const uint8_t *data, unsigned dlc);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CAN_MODEL_H_ */
+
+/** @} */
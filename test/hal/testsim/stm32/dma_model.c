@@ -0,0 +1,295 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    dma_model.c
+ * @brief   DMA controllers register level model code.
+ *
+ * @addtogroup DMA_MODEL
+ * @{
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Streams of each controller and their registers layout.*/
+#define STREAMS_PER_DMA         8U
+#define STREAMS                 (2U * STREAMS_PER_DMA)
+#define STREAMS_OFFSET          0x10U
+#define STREAM_SIZE             0x18U
+
+/* Registers reset values.*/
+#define FCR_RESET               0x00000021U
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   DMA1 and DMA2 registers blocks.
+ */
+dma_model_page_t dma_model __attribute__((aligned(DMA_MODEL_PAGE_SIZE)));
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/* Offsets of the streams flags in the xISR registers.*/
+static const uint8_t ishifts[4] = {0U, 6U, 16U, 22U};
+
+/* Current memory address of each stream.*/
+static uint8_t *memp[STREAMS];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers access by the model.
+ */
+static void regs_unlock(void) {
+
+  regs_trap_unlock(&dma_model, sizeof dma_model);
+}
+
+/**
+ * @brief   Registers access by the driver, each access is trapped.
+ */
+static void regs_lock(void) {
+
+  regs_trap_lock(&dma_model, sizeof dma_model);
+}
+
+/**
+ * @brief   Returns the registers block of a controller.
+ *
+ * @param[in] id        the stream identifier
+ */
+static DMA_TypeDef *controller(unsigned id) {
+
+  return (DMA_TypeDef *)&dma_model.page[(id / STREAMS_PER_DMA) *
+                                        DMA_MODEL_DMA2_OFFSET];
+}
+
+/**
+ * @brief   Returns the registers block of a stream.
+ *
+ * @param[in] id        the stream identifier
+ */
+static DMA_Stream_TypeDef *stream(unsigned id) {
+
+  return (DMA_Stream_TypeDef *)((uint8_t *)controller(id) + STREAMS_OFFSET +
+                                ((id % STREAMS_PER_DMA) * STREAM_SIZE));
+}
+
+/**
+ * @brief   Size of the peripheral data items of a stream.
+ *
+ * @param[in] sp        the stream registers
+ */
+static size_t item_size(const DMA_Stream_TypeDef *sp) {
+
+  switch (sp->CR & STM32_DMA_CR_PSIZE_MASK) {
+  case STM32_DMA_CR_PSIZE_HWORD:
+    return 2U;
+  case STM32_DMA_CR_PSIZE_WORD:
+    return 4U;
+  default:
+    return 1U;
+  }
+}
+
+/**
+ * @brief   Selects the stream serving a peripheral request.
+ *
+ * @param[in] streams   mask of the streams the request is routed to
+ * @param[in] chn       channel of the request
+ * @param[in] dir       direction of the transfer, @p CR register format
+ * @param[in] n         number of bytes to be transferred
+ * @param[out] idp      the selected stream
+ * @return              The number of bytes the stream can transfer, zero if
+ *                      no stream is enabled for the request.
+ */
+static size_t stream_take(uint32_t streams, uint32_t chn, uint32_t dir,
+                          size_t n, unsigned *idp) {
+  unsigned id;
+
+  for (id = 0U; id < STREAMS; id++) {
+    DMA_Stream_TypeDef *sp = stream(id);
+    size_t size;
+
+    if (((streams & (1U << id)) == 0U) ||
+        ((sp->CR & STM32_DMA_CR_EN) == 0U) ||
+        ((sp->CR & STM32_DMA_CR_CHSEL_MASK) != STM32_DMA_CR_CHSEL(chn)) ||
+        ((sp->CR & STM32_DMA_CR_DIR_MASK) != dir)) {
+      continue;
+    }
+
+    size = (size_t)sp->NDTR * item_size(sp);
+    *idp = id;
+    return n < size ? n - (n % item_size(sp)) : size;
+  }
+  return 0U;
+}
+
+/**
+ * @brief   Accounts the data moved by a stream.
+ * @details The stream is disabled and its transfer complete flag raised
+ *          when the data items count reaches zero.
+ *
+ * @param[in] id        the stream identifier
+ * @param[in] size      number of bytes moved
+ */
+static void stream_advance(unsigned id, size_t size) {
+  DMA_Stream_TypeDef *sp = stream(id);
+  DMA_TypeDef *dp = controller(id);
+  uint32_t tcif = STM32_DMA_ISR_TCIF << ishifts[id % 4U];
+
+  if ((sp->CR & STM32_DMA_CR_MINC) != 0U) {
+    memp[id] += size;
+  }
+  sp->NDTR -= (uint32_t)(size / item_size(sp));
+  if (sp->NDTR == 0U) {
+    sp->CR &= ~STM32_DMA_CR_EN;
+    if ((id % STREAMS_PER_DMA) < 4U) {
+      dp->LISR |= tcif;
+    }
+    else {
+      dp->HISR |= tcif;
+    }
+  }
+}
+
+/**
+ * @brief   Applies the side effects of a register write.
+ *
+ * @param[in] offset    offset of the written register
+ * @param[in] old       the register value before the write
+ */
+static void reg_written(size_t offset, uint32_t old) {
+  uint32_t w = *(volatile uint32_t *)(dma_model.page + offset);
+  size_t reg = offset % DMA_MODEL_DMA2_OFFSET;
+  unsigned id = (unsigned)(offset / DMA_MODEL_DMA2_OFFSET) * STREAMS_PER_DMA;
+  DMA_TypeDef *dp;
+
+  if (id >= STREAMS) {
+    return;
+  }
+
+  dp = controller(id);
+  if (reg == offsetof(DMA_TypeDef, LIFCR)) {
+    dp->LISR &= ~w;
+    dp->LIFCR = 0U;
+  }
+  else if (reg == offsetof(DMA_TypeDef, HIFCR)) {
+    dp->HISR &= ~w;
+    dp->HIFCR = 0U;
+  }
+  else if ((reg >= STREAMS_OFFSET) &&
+           (reg < STREAMS_OFFSET + (STREAMS_PER_DMA * STREAM_SIZE))) {
+    id += (unsigned)((reg - STREAMS_OFFSET) / STREAM_SIZE);
+    reg = (reg - STREAMS_OFFSET) % STREAM_SIZE;
+
+    /* The memory address is latched when the stream is enabled.*/
+    if ((reg == offsetof(DMA_Stream_TypeDef, CR)) &&
+        ((w & STM32_DMA_CR_EN) != 0U) && ((old & STM32_DMA_CR_EN) == 0U)) {
+      memp[id] = (uint8_t *)(uintptr_t)stream(id)->M0AR;
+    }
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Model initialization, the registers take their reset values.
+ */
+void dma_model_init(void) {
+  unsigned id;
+
+  regs_unlock();
+  memset(&dma_model, 0, sizeof dma_model);
+  for (id = 0U; id < STREAMS; id++) {
+    stream(id)->FCR = FCR_RESET;
+    memp[id] = NULL;
+  }
+
+  regs_trap_register(&dma_model, sizeof dma_model, reg_written);
+}
+
+/**
+ * @brief   A peripheral to memory request.
+ *
+ * @param[in] streams   mask of the streams the request is routed to
+ * @param[in] chn       channel of the request
+ * @param[in] src       the data from the peripheral
+ * @param[in] n         number of bytes to be transferred
+ * @return              The number of bytes transferred, less than @p n if
+ *                      the stream ran out of data items or zero if no
+ *                      stream is enabled for the request.
+ */
+size_t dma_model_p2m(uint32_t streams, uint32_t chn,
+                     const void *src, size_t n) {
+  unsigned id;
+  size_t size;
+
+  regs_unlock();
+  size = stream_take(streams, chn, STM32_DMA_CR_DIR_P2M, n, &id);
+  if (size > 0U) {
+    memcpy(memp[id], src, size);
+    stream_advance(id, size);
+  }
+  regs_lock();
+
+  return size;
+}
+
+/**
+ * @brief   A memory to peripheral request.
+ *
+ * @param[in] streams   mask of the streams the request is routed to
+ * @param[in] chn       channel of the request
+ * @param[out] dst      the data for the peripheral
+ * @param[in] n         number of bytes to be transferred
+ * @return              The number of bytes transferred, less than @p n if
+ *                      the stream ran out of data items or zero if no
+ *                      stream is enabled for the request.
+ */
+size_t dma_model_m2p(uint32_t streams, uint32_t chn,
+                     void *dst, size_t n) {
+  unsigned id;
+  size_t size;
+
+  regs_unlock();
+  size = stream_take(streams, chn, STM32_DMA_CR_DIR_M2P, n, &id);
+  if (size > 0U) {
+    memcpy(dst, memp[id], size);
+    stream_advance(id, size);
+  }
+  regs_lock();
+
+  return size;
+}
+
+/** @} */
@@ -0,0 +1,108 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    dma_model.h
+ * @brief   DMA controllers register level model header.
+ * @details The model emulates the streams of the DMA1 and DMA2 controllers
+ *          on behalf of the peripherals models. A peripheral model issues
+ *          its requests with @p dma_model_p2m() and @p dma_model_m2p(), the
+ *          data is moved by the enabled stream selecting the peripheral
+ *          channel: the memory address programmed when the stream has been
+ *          enabled is incremented, the @p NDTR register counts down and the
+ *          stream is disabled with the transfer complete flag raised when
+ *          it reaches zero.<br>
+ *          The registers accesses are trapped, the flags clear registers
+ *          act immediately. The streams interrupts are not raised, the
+ *          drivers under test poll the streams.
+ *
+ * @addtogroup DMA_MODEL
+ * @{
+ */
+
+#ifndef _DMA_MODEL_H_
+#define _DMA_MODEL_H_
+
+#include "stm32f4xx.h"
+#include "regs_trap.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the protected page containing the registers blocks.
+ */
+#define DMA_MODEL_PAGE_SIZE                 REGS_TRAP_PAGE_SIZE
+
+/**
+ * @brief   Offset of the DMA2 registers block, as on the device.
+ */
+#define DMA_MODEL_DMA2_OFFSET               0x400U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers blocks page.
+ */
+typedef union {
+  DMA_TypeDef                   regs;
+  uint8_t                       page[DMA_MODEL_PAGE_SIZE];
+} dma_model_page_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/* The DMA1 and DMA2 registers blocks are the model, the streams registers
+   follow the blocks bases.*/
+#undef DMA1_BASE
+#define DMA1_BASE                           ((uintptr_t)&dma_model.page[0])
+#undef DMA2_BASE
+#define DMA2_BASE                                                           \
+  ((uintptr_t)&dma_model.page[DMA_MODEL_DMA2_OFFSET])
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern dma_model_page_t dma_model;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void dma_model_init(void);
+  size_t dma_model_p2m(uint32_t streams, uint32_t chn,
+                       const void *src, size_t n);
+  size_t dma_model_m2p(uint32_t streams, uint32_t chn,
+                       void *dst, size_t n);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DMA_MODEL_H_ */
+
+/** @} */
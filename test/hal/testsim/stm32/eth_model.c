@@ -0,0 +1,533 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    eth_model.c
+ * @brief   Ethernet MAC register level model code.
+ *
+ * @addtogroup ETH_MODEL
+ * @{
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+#include "mii.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Descriptors bits handled by the DMA.*/
+#define DES0_OWN                0x80000000U
+#define RDES0_FL_POS            16U
+#define RDES0_FS                0x00000200U
+#define RDES0_LS                0x00000100U
+#define RDES0_FT                0x00000020U
+#define RDES1_RBS1              0x00001FFFU
+#define TDES0_IC                0x40000000U
+#define TDES0_LS                0x20000000U
+#define TDES0_FS                0x10000000U
+#define TDES1_TBS1              0x00001FFFU
+
+/* Write-one-to-clear bits of the DMASR register.*/
+#define DMASR_W1C               0x0001E7FFU
+
+/* Normal and abnormal interrupt sources.*/
+#define DMASR_NORMAL            (ETH_DMASR_TS | ETH_DMASR_TBUS |            \
+                                 ETH_DMASR_RS | ETH_DMASR_ERS)
+#define DMASR_ABNORMAL          (ETH_DMASR_TPSS | ETH_DMASR_TJTS |          \
+                                 ETH_DMASR_ROS | ETH_DMASR_TUS |            \
+                                 ETH_DMASR_RBUS | ETH_DMASR_RPSS |          \
+                                 ETH_DMASR_RWTS | ETH_DMASR_ETS |           \
+                                 ETH_DMASR_FBES)
+
+/* Size of the frame check sequence stored after the frame data.*/
+#define FCS_SIZE                4U
+
+/* Smallest ethertype value, lower values are lengths.*/
+#define ETHERTYPE_MIN           0x0600U
+
+/* PHY registers reset values.*/
+#define PHY_BMCR_RESET          (BMCR_ANENABLE | BMCR_SPEED100 |            \
+                                 BMCR_FULLDPLX)
+#define PHY_BMSR                (BMSR_100FULL | BMSR_100HALF |              \
+                                 BMSR_10FULL | BMSR_10HALF |                \
+                                 BMSR_ANEGCAPABLE)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   ETH registers block.
+ */
+eth_model_pages_t eth_model __attribute__((aligned(REGS_TRAP_PAGE_SIZE)));
+
+/**
+ * @brief   SYSCFG registers block.
+ */
+SYSCFG_TypeDef eth_model_syscfg;
+
+/**
+ * @brief   Last frame sent on the wire.
+ */
+eth_model_frame_t eth_model_sent;
+
+/**
+ * @brief   Model counters.
+ */
+eth_model_counters_t eth_model_counters;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   DMA descriptor, receive and transmit descriptors share the
+ *          layout.
+ */
+typedef struct {
+  volatile uint32_t             des0;
+  volatile uint32_t             des1;
+  volatile uint32_t             des2;
+  volatile uint32_t             des3;
+} descriptor_t;
+
+static descriptor_t *rx_current;
+static descriptor_t *tx_current;
+static eth_model_frame_t tx_frame;
+static bool tx_held;
+static uint16_t phy_bmcr;
+static bool irq_check;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+CH_IRQ_HANDLER(STM32_ETH_HANDLER);
+
+/**
+ * @brief   Registers access by the model.
+ */
+static void regs_unlock(void) {
+
+  regs_trap_unlock(&eth_model, sizeof eth_model);
+}
+
+/**
+ * @brief   Registers access by the driver, each access is trapped.
+ */
+static void regs_lock(void) {
+
+  regs_trap_lock(&eth_model, sizeof eth_model);
+}
+
+/**
+ * @brief   Returns the next descriptor in the chain.
+ *
+ * @param[in] dp        the descriptor
+ */
+static descriptor_t *next_descriptor(const descriptor_t *dp) {
+
+  return (descriptor_t *)(uintptr_t)dp->des3;
+}
+
+/**
+ * @brief   Sets the state of the receive process.
+ *
+ * @param[in] rps       the state in the @p DMASR register format
+ */
+static void rx_set_state(uint32_t rps) {
+
+  eth_model.regs.DMASR = (eth_model.regs.DMASR & ~ETH_DMASR_RPS) | rps;
+}
+
+/**
+ * @brief   Sets the state of the transmit process.
+ *
+ * @param[in] tps       the state in the @p DMASR register format
+ */
+static void tx_set_state(uint32_t tps) {
+
+  eth_model.regs.DMASR = (eth_model.regs.DMASR & ~ETH_DMASR_TPS) | tps;
+}
+
+/**
+ * @brief   Checks if the transmit process is fetching descriptors.
+ */
+static bool tx_is_running(void) {
+  uint32_t tps = eth_model.regs.DMASR & ETH_DMASR_TPS;
+
+  return (tps != ETH_DMASR_TPS_Stopped) && (tps != ETH_DMASR_TPS_Suspended);
+}
+
+/**
+ * @brief   Updates the interrupt summary bits.
+ */
+static void status_update(void) {
+  ETH_TypeDef *ep = &eth_model.regs;
+
+  ep->DMASR &= ~(ETH_DMASR_NIS | ETH_DMASR_AIS);
+  if ((ep->DMASR & DMASR_NORMAL) != 0U) {
+    ep->DMASR |= ETH_DMASR_NIS;
+  }
+  if ((ep->DMASR & DMASR_ABNORMAL) != 0U) {
+    ep->DMASR |= ETH_DMASR_AIS;
+  }
+  irq_check = true;
+}
+
+/**
+ * @brief   Suspends the receive process, no descriptor is available.
+ */
+static void rx_suspend(void) {
+
+  eth_model.regs.DMASR |= ETH_DMASR_RBUS;
+  rx_set_state(ETH_DMASR_RPS_Suspended);
+  status_update();
+}
+
+/**
+ * @brief   Stores a frame in the receive descriptors.
+ * @details The frame is written starting from the current descriptor, if
+ *          the descriptors run out in the middle of the frame the written
+ *          descriptors are closed without the last segment flag and the
+ *          remaining data is discarded.
+ *
+ * @param[in] data      the frame data
+ * @param[in] n         the frame size, the FCS excluded
+ * @param[in] status    error bits of the last descriptor
+ */
+static void rx_store(const uint8_t *data, size_t n, uint32_t status) {
+  descriptor_t *dp = rx_current;
+  size_t len = n + FCS_SIZE, offset = 0U;
+  uint32_t des0 = RDES0_FS;
+
+  if ((dp->des0 & DES0_OWN) == 0U) {
+    eth_model_counters.missed++;
+    rx_suspend();
+    return;
+  }
+
+  while (true) {
+    size_t chunk = dp->des1 & RDES1_RBS1;
+
+    if (chunk > len - offset) {
+      chunk = len - offset;
+    }
+    if (offset < n) {
+      memcpy((uint8_t *)(uintptr_t)dp->des2, data + offset,
+             chunk < n - offset ? chunk : n - offset);
+    }
+    offset += chunk;
+
+    if (offset == len) {
+      des0 |= RDES0_LS | ((uint32_t)len << RDES0_FL_POS) | status;
+      if ((n >= 14U) &&
+          ((((uint32_t)data[12] << 8) | data[13]) >= ETHERTYPE_MIN)) {
+        des0 |= RDES0_FT;
+      }
+      dp->des0   = des0;
+      rx_current = next_descriptor(dp);
+      eth_model_counters.received++;
+      eth_model.regs.DMASR |= ETH_DMASR_RS;
+      rx_set_state(ETH_DMASR_RPS_Waiting);
+      status_update();
+      return;
+    }
+
+    dp->des0   = des0;
+    rx_current = next_descriptor(dp);
+    if ((rx_current->des0 & DES0_OWN) == 0U) {
+      eth_model_counters.truncated++;
+      rx_suspend();
+      return;
+    }
+    dp   = rx_current;
+    des0 = 0U;
+  }
+}
+
+/**
+ * @brief   Sends the frames in the transmit descriptors owned by the DMA.
+ * @details The transmit process is suspended on the first descriptor not
+ *          owned by the DMA.
+ */
+static void tx_send(void) {
+  descriptor_t *dp;
+
+  while (true) {
+    size_t n;
+
+    dp = tx_current;
+    if ((dp->des0 & DES0_OWN) == 0U) {
+      eth_model.regs.DMASR |= ETH_DMASR_TBUS;
+      tx_set_state(ETH_DMASR_TPS_Suspended);
+      status_update();
+      return;
+    }
+
+    if ((dp->des0 & TDES0_FS) != 0U) {
+      tx_frame.tdes0 = dp->des0;
+      tx_frame.ndesc = 0U;
+      tx_frame.size  = 0U;
+    }
+    n = dp->des1 & TDES1_TBS1;
+    if (tx_frame.size + n <= ETH_MODEL_MAX_FRAME_SIZE) {
+      memcpy(&tx_frame.data[tx_frame.size],
+             (const uint8_t *)(uintptr_t)dp->des2, n);
+    }
+    tx_frame.size += n;
+    tx_frame.ndesc++;
+
+    dp->des0  &= ~DES0_OWN;
+    tx_current = next_descriptor(dp);
+    if ((dp->des0 & TDES0_LS) != 0U) {
+      eth_model_sent = tx_frame;
+      eth_model_counters.sent++;
+      if ((dp->des0 & TDES0_IC) != 0U) {
+        eth_model.regs.DMASR |= ETH_DMASR_TS;
+        status_update();
+      }
+    }
+  }
+}
+
+/**
+ * @brief   Access to the PHY through the MII management interface.
+ * @details Only the PHY at @p ETH_MODEL_PHY_ADDRESS answers, the link is
+ *          up unless the PHY is powered down.
+ */
+static void mii_access(void) {
+  ETH_TypeDef *ep = &eth_model.regs;
+  uint32_t pa = (ep->MACMIIAR & ETH_MACMIIAR_PA) >> 11;
+  uint32_t mr = (ep->MACMIIAR & ETH_MACMIIAR_MR) >> 6;
+  uint32_t value = 0xFFFFU;
+
+  ep->MACMIIAR &= ~ETH_MACMIIAR_MB;
+  if (pa != ETH_MODEL_PHY_ADDRESS) {
+    if ((ep->MACMIIAR & ETH_MACMIIAR_MW) == 0U) {
+      ep->MACMIIDR = value;
+    }
+    return;
+  }
+
+  if ((ep->MACMIIAR & ETH_MACMIIAR_MW) != 0U) {
+    if (mr == MII_BMCR) {
+      /* The reset completes immediately.*/
+      phy_bmcr = (ep->MACMIIDR & BMCR_RESET) != 0U ?
+                 PHY_BMCR_RESET : (uint16_t)ep->MACMIIDR;
+    }
+    return;
+  }
+
+  switch (mr) {
+  case MII_BMCR:
+    value = phy_bmcr;
+    break;
+  case MII_BMSR:
+    value = PHY_BMSR;
+    if ((phy_bmcr & BMCR_PDOWN) == 0U) {
+      value |= BMSR_LSTATUS | BMSR_ANEGCOMPLETE;
+    }
+    break;
+  case MII_PHYSID1:
+    value = BOARD_PHY_ID >> 16;
+    break;
+  case MII_PHYSID2:
+    value = BOARD_PHY_ID & 0xFFFFU;
+    break;
+  case MII_LPA:
+    value = LPA_100FULL | LPA_100HALF | LPA_10FULL | LPA_10HALF;
+    break;
+  default:
+    value = 0U;
+    break;
+  }
+  ep->MACMIIDR = value;
+}
+
+/**
+ * @brief   Applies the side effects of a register write.
+ *
+ * @param[in] offset    offset of the written register
+ * @param[in] old       the register value before the write
+ */
+static void reg_written(size_t offset, uint32_t old) {
+  ETH_TypeDef *ep = &eth_model.regs;
+  uint32_t w = *(volatile uint32_t *)(eth_model.pages + offset);
+
+  irq_check = true;
+  if (offset == offsetof(ETH_TypeDef, MACMIIAR)) {
+    if ((w & ETH_MACMIIAR_MB) != 0U) {
+      mii_access();
+    }
+  }
+  else if (offset == offsetof(ETH_TypeDef, DMABMR)) {
+    ep->DMABMR &= ~ETH_DMABMR_SR;
+  }
+  else if (offset == offsetof(ETH_TypeDef, DMASR)) {
+    ep->DMASR = old & ~(w & DMASR_W1C);
+    status_update();
+  }
+  else if (offset == offsetof(ETH_TypeDef, DMAOMR)) {
+    /* The transmit FIFO is flushed immediately.*/
+    ep->DMAOMR &= ~ETH_DMAOMR_FTF;
+    if ((w & ETH_DMAOMR_ST) == 0U) {
+      tx_set_state(ETH_DMASR_TPS_Stopped);
+    }
+    else if ((old & ETH_DMAOMR_ST) == 0U) {
+      tx_current = (descriptor_t *)(uintptr_t)ep->DMATDLAR;
+      tx_set_state(ETH_DMASR_TPS_Fetching);
+    }
+    if ((w & ETH_DMAOMR_SR) == 0U) {
+      rx_set_state(ETH_DMASR_RPS_Stopped);
+    }
+    else if ((old & ETH_DMAOMR_SR) == 0U) {
+      rx_current = (descriptor_t *)(uintptr_t)ep->DMARDLAR;
+      rx_set_state(ETH_DMASR_RPS_Waiting);
+    }
+  }
+  else if (offset == offsetof(ETH_TypeDef, DMATPDR)) {
+    if ((ep->DMASR & ETH_DMASR_TPS) == ETH_DMASR_TPS_Suspended) {
+      tx_set_state(ETH_DMASR_TPS_Fetching);
+    }
+  }
+  else if (offset == offsetof(ETH_TypeDef, DMARPDR)) {
+    if (((ep->DMASR & ETH_DMASR_RPS) == ETH_DMASR_RPS_Suspended) &&
+        ((rx_current->des0 & DES0_OWN) != 0U)) {
+      rx_set_state(ETH_DMASR_RPS_Waiting);
+    }
+  }
+}
+
+/**
+ * @brief   Checks for an active interrupt.
+ */
+static bool irq_active(void) {
+  ETH_TypeDef *ep = &eth_model.regs;
+
+  return (((ep->DMAIER & ETH_DMAIER_NISE) != 0U) &&
+          ((ep->DMASR & ep->DMAIER & DMASR_NORMAL) != 0U)) ||
+         (((ep->DMAIER & ETH_DMAIER_AISE) != 0U) &&
+          ((ep->DMASR & ep->DMAIER & DMASR_ABNORMAL) != 0U));
+}
+
+/**
+ * @brief   Raises the active interrupt.
+ * @details The handler is invoked as long as an interrupt source is
+ *          active, a reschedule is performed after each invocation like on
+ *          the exit of a real interrupt.
+ * @note    Must be invoked with the registers locked.
+ */
+static void raise_irqs(void) {
+  bool active;
+
+  while (irq_check) {
+    irq_check = false;
+    regs_unlock();
+    active = irq_active();
+    regs_lock();
+    if (!active) {
+      break;
+    }
+
+    eth_model_counters.irqs++;
+    irq_check = true;
+    STM32_ETH_HANDLER();
+
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Model initialization, the registers take their reset values.
+ */
+void eth_model_init(void) {
+
+  regs_unlock();
+  memset(&eth_model, 0, sizeof eth_model);
+  memset(&eth_model_syscfg, 0, sizeof eth_model_syscfg);
+  memset(&eth_model_sent, 0, sizeof eth_model_sent);
+  memset(&eth_model_counters, 0, sizeof eth_model_counters);
+  rx_current = NULL;
+  tx_current = NULL;
+  tx_held    = false;
+  phy_bmcr   = PHY_BMCR_RESET;
+  irq_check  = false;
+
+  regs_trap_register(&eth_model, sizeof eth_model, reg_written);
+}
+
+/**
+ * @brief   Interrupts check.
+ * @details The frames pending in the transmit descriptors are sent then
+ *          the active interrupt is raised.
+ */
+void eth_model_check_for_interrupts(void) {
+
+  regs_unlock();
+  if (!tx_held && tx_is_running()) {
+    tx_send();
+  }
+  regs_lock();
+  raise_irqs();
+}
+
+/**
+ * @brief   A frame is received from the wire.
+ * @note    The frame is ignored if the receiver or the receive process
+ *          are stopped.
+ *
+ * @param[in] data      the frame data, the FCS excluded
+ * @param[in] n         the frame size
+ * @param[in] status    error bits to be reported in the last descriptor of
+ *                      the frame, @p RDES0 format
+ */
+void eth_model_receive(const uint8_t *data, size_t n, uint32_t status) {
+
+  regs_unlock();
+  if (((eth_model.regs.MACCR & ETH_MACCR_RE) != 0U) &&
+      ((eth_model.regs.DMAOMR & ETH_DMAOMR_SR) != 0U)) {
+    rx_store(data, n, status);
+  }
+  regs_lock();
+  raise_irqs();
+}
+
+/**
+ * @brief   Holds the transmit process.
+ * @details While held the descriptors given to the DMA are not sent, like
+ *          on a congested link.
+ *
+ * @param[in] hold      @p true in order to hold the transmit process
+ */
+void eth_model_tx_hold(bool hold) {
+
+  tx_held = hold;
+}
+
+/** @} */
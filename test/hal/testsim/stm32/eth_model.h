@@ -0,0 +1,164 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    eth_model.h
+ * @brief   Ethernet MAC register level model header.
+ * @details The model emulates the DMA of the Ethernet MAC walking chained
+ *          descriptor rings and a PHY on the MII management interface.
+ *          Frames from the wire are injected by the
+ *          @p eth_model_receive() function, they are stored in the
+ *          descriptors owned by the DMA like on the real cell: frames
+ *          larger than a buffer span several descriptors, a frame finding
+ *          no descriptor is missed and a frame running out of descriptors
+ *          is truncated.<br>
+ *          The transmit descriptors owned by the DMA are sent on the wire
+ *          on the interrupts check, the last sent frame is recorded. The
+ *          interrupt handler is invoked in the context of the thread
+ *          injecting the frames or of the interrupts check.
+ *
+ * @addtogroup ETH_MODEL
+ * @{
+ */
+
+#ifndef _ETH_MODEL_H_
+#define _ETH_MODEL_H_
+
+#include "stm32f4xx.h"
+#include "regs_trap.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the protected pages containing the registers block.
+ */
+#define ETH_MODEL_PAGES_SIZE                (2U * REGS_TRAP_PAGE_SIZE)
+
+/**
+ * @brief   Address of the PHY on the MII management interface.
+ */
+#define ETH_MODEL_PHY_ADDRESS               1U
+
+/**
+ * @brief   Largest frame recorded on transmission.
+ */
+#define ETH_MODEL_MAX_FRAME_SIZE            2048U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers block pages.
+ */
+typedef union {
+  ETH_TypeDef                   regs;
+  uint8_t                       pages[ETH_MODEL_PAGES_SIZE];
+} eth_model_pages_t;
+
+/**
+ * @brief   Frame sent on the wire.
+ */
+typedef struct {
+  /**
+   * @brief   @p TDES0 of the first descriptor of the frame.
+   */
+  uint32_t                      tdes0;
+  /**
+   * @brief   Number of descriptors holding the frame.
+   */
+  unsigned                      ndesc;
+  /**
+   * @brief   Frame size.
+   */
+  size_t                        size;
+  /**
+   * @brief   Frame data, the frames exceeding the buffer are clipped.
+   */
+  uint8_t                       data[ETH_MODEL_MAX_FRAME_SIZE];
+} eth_model_frame_t;
+
+/**
+ * @brief   Model counters.
+ */
+typedef struct {
+  /**
+   * @brief   Frames stored in the receive descriptors.
+   */
+  uint32_t                      received;
+  /**
+   * @brief   Frames lost because no receive descriptor was available.
+   */
+  uint32_t                      missed;
+  /**
+   * @brief   Frames truncated because the receive descriptors ran out.
+   */
+  uint32_t                      truncated;
+  /**
+   * @brief   Frames sent on the wire.
+   */
+  uint32_t                      sent;
+  /**
+   * @brief   Interrupts raised.
+   */
+  uint32_t                      irqs;
+} eth_model_counters_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/* The ETH registers block is the model.*/
+#undef ETH
+#define ETH                                 (&eth_model.regs)
+
+/* The MII/RMII selection of the SYSCFG block has no effect.*/
+#undef SYSCFG
+#define SYSCFG                              (&eth_model_syscfg)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern eth_model_pages_t eth_model;
+extern SYSCFG_TypeDef eth_model_syscfg;
+extern eth_model_frame_t eth_model_sent;
+extern eth_model_counters_t eth_model_counters;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void eth_model_init(void);
+  void eth_model_check_for_interrupts(void);
+  void eth_model_receive(const uint8_t *data, size_t n, uint32_t status);
+  void eth_model_tx_hold(bool hold);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ETH_MODEL_H_ */
+
+/** @} */
@@ -0,0 +1,106 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_lld.c
+ * @brief   STM32 peripherals models platform code.
+ *
+ * @addtogroup HAL
+ * @{
+ */
+
+#include <sys/time.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static struct timeval nextcnt;
+static struct timeval tick = {0UL, 1000000UL / CH_CFG_ST_FREQUENCY};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief Low level HAL driver initialization.
+ */
+void hal_lld_init(void) {
+
+  printf("ChibiOS/RT simulator (Linux), STM32 models\n");
+  gettimeofday(&nextcnt, NULL);
+  timeradd(&nextcnt, &tick, &nextcnt);
+
+  fflush(stdout);
+
+  /* Peripherals models.*/
+  can_model_init();
+  otg_model_init();
+  eth_model_init();
+  dma_model_init();
+  sdio_model_init();
+
+#if defined(STM32_DMA_REQUIRED)
+  dmaInit();
+#endif
+}
+
+/**
+ * @brief   Interrupt simulation.
+ */
+void _sim_check_for_interrupts(void) {
+  struct timeval tv;
+
+  /* Peripherals models.*/
+  can_model_check_for_interrupts();
+  eth_model_check_for_interrupts();
+  sdio_model_check_for_interrupts();
+
+  /* Interrupt Timer simulation.*/
+  gettimeofday(&tv, NULL);
+  if (timercmp(&tv, &nextcnt, >=)) {
+    timeradd(&nextcnt, &tick, &nextcnt);
+
+    CH_IRQ_PROLOGUE();
+
+    chSysLockFromISR();
+    chSysTimerHandlerI();
+    chSysUnlockFromISR();
+
+    CH_IRQ_EPILOGUE();
+
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+  }
+}
+
+/** @} */
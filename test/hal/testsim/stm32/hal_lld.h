@@ -0,0 +1,198 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_lld.h
+ * @brief   STM32 peripherals models platform header.
+ * @details The platform runs the STM32 low level drivers on the Linux
+ *          simulator, the peripherals are replaced by register level
+ *          models, the system tick and the console are provided by the
+ *          posix platform.
+ *
+ * @addtogroup HAL
+ * @{
+ */
+
+#ifndef _HAL_LLD_H_
+#define _HAL_LLD_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+#define PLATFORM_NAME   "STM32 Models on Linux Simulator"
+
+/**
+ * @name    Emulated device and its capabilities
+ * @{
+ */
+#define STM32F4XX
+#define STM32F407xx
+#define STM32_HAS_CAN1                      TRUE
+#define STM32_HAS_CAN2                      TRUE
+#define STM32_CAN_MAX_FILTERS               28
+#define STM32_HAS_OTG1                      FALSE
+#define STM32_HAS_OTG2                      TRUE
+#define STM32_HAS_SDIO                      TRUE
+#define STM32_SDC_SDIO_DMA_MSK              (STM32_DMA_STREAM_ID_MSK(2, 3) |\
+                                             STM32_DMA_STREAM_ID_MSK(2, 6))
+#define STM32_SDC_SDIO_DMA_CHN              0x04004000
+#define STM32_ADVANCED_DMA                  TRUE
+#define STM32_DMA_CACHE_HANDLING            FALSE
+#define STM32_HAS_DMA1                      TRUE
+#define STM32_HAS_DMA2                      TRUE
+/** @} */
+
+/**
+ * @name    Emulated clocks
+ * @{
+ */
+#define STM32_HCLK                          168000000
+#define STM32_PLL48CLK                      48000000
+/** @} */
+
+/**
+ * @name    Emulated vectors
+ * @{
+ */
+#define STM32_CAN1_TX_HANDLER               Vector8C
+#define STM32_CAN1_RX0_HANDLER              Vector90
+#define STM32_CAN1_RX1_HANDLER              Vector94
+#define STM32_CAN1_SCE_HANDLER              Vector98
+#define STM32_CAN1_TX_NUMBER                19
+#define STM32_CAN1_RX0_NUMBER               20
+#define STM32_CAN1_RX1_NUMBER               21
+#define STM32_CAN1_SCE_NUMBER               22
+#define STM32_OTG2_HANDLER                  Vector174
+#define STM32_OTG2_NUMBER                   77
+#define STM32_ETH_HANDLER                   Vector134
+#define STM32_ETH_NUMBER                    61
+#define STM32_SDIO_HANDLER                  Vector104
+#define STM32_SDIO_NUMBER                   49
+#define STM32_DMA1_CH0_HANDLER              Vector6C
+#define STM32_DMA1_CH1_HANDLER              Vector70
+#define STM32_DMA1_CH2_HANDLER              Vector74
+#define STM32_DMA1_CH3_HANDLER              Vector78
+#define STM32_DMA1_CH4_HANDLER              Vector7C
+#define STM32_DMA1_CH5_HANDLER              Vector80
+#define STM32_DMA1_CH6_HANDLER              Vector84
+#define STM32_DMA1_CH7_HANDLER              VectorFC
+#define STM32_DMA2_CH0_HANDLER              Vector120
+#define STM32_DMA2_CH1_HANDLER              Vector124
+#define STM32_DMA2_CH2_HANDLER              Vector128
+#define STM32_DMA2_CH3_HANDLER              Vector12C
+#define STM32_DMA2_CH4_HANDLER              Vector130
+#define STM32_DMA2_CH5_HANDLER              Vector150
+#define STM32_DMA2_CH6_HANDLER              Vector154
+#define STM32_DMA2_CH7_HANDLER              Vector158
+#define STM32_DMA1_CH0_NUMBER               11
+#define STM32_DMA1_CH1_NUMBER               12
+#define STM32_DMA1_CH2_NUMBER               13
+#define STM32_DMA1_CH3_NUMBER               14
+#define STM32_DMA1_CH4_NUMBER               15
+#define STM32_DMA1_CH5_NUMBER               16
+#define STM32_DMA1_CH6_NUMBER               17
+#define STM32_DMA1_CH7_NUMBER               47
+#define STM32_DMA2_CH0_NUMBER               56
+#define STM32_DMA2_CH1_NUMBER               57
+#define STM32_DMA2_CH2_NUMBER               58
+#define STM32_DMA2_CH3_NUMBER               59
+#define STM32_DMA2_CH4_NUMBER               60
+#define STM32_DMA2_CH5_NUMBER               68
+#define STM32_DMA2_CH6_NUMBER               69
+#define STM32_DMA2_CH7_NUMBER               70
+/** @} */
+
+/**
+ * @name    Emulated board
+ * @note    The PHY address is detected by the MAC driver.
+ * @{
+ */
+#define BOARD_PHY_ID                        0x0007C0F0
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/* All the priorities are accepted, the simulator has no priority levels.*/
+#undef OSAL_IRQ_IS_VALID_PRIORITY
+#define OSAL_IRQ_IS_VALID_PRIORITY(n)       true
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    RCC and NVIC emulation
+ * @note    The models have no clock gating and the interrupts are raised
+ *          by the models themselves.
+ * @{
+ */
+#define rccEnableCAN1(lp)                   (void)(lp)
+#define rccDisableCAN1(lp)                  (void)(lp)
+#define rccEnableOTG_HS(lp)                 (void)(lp)
+#define rccDisableOTG_HS(lp)                (void)(lp)
+#define rccResetOTG_HS()
+#define rccEnableOTG_HSULPI(lp)             (void)(lp)
+#define rccDisableOTG_HSULPI(lp)            (void)(lp)
+#define rccEnableETH(lp)                    (void)(lp)
+#define rccDisableETH(lp)                   (void)(lp)
+#define rccResetETH()
+#define rccEnableSDIO(lp)                   (void)(lp)
+#define rccDisableSDIO(lp)                  (void)(lp)
+#define rccEnableDMA1(lp)                   (void)(lp)
+#define rccDisableDMA1(lp)                  (void)(lp)
+#define rccEnableDMA2(lp)                   (void)(lp)
+#define rccDisableDMA2(lp)                  (void)(lp)
+#define nvicEnableVector(n, prio)           (void)(n), (void)(prio)
+#define nvicDisableVector(n)                (void)(n)
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#include "can_model.h"
+#include "otg_model.h"
+#include "eth_model.h"
+#include "dma_model.h"
+#include "stm32_dma.h"
+#include "sdio_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void hal_lld_init(void);
+  void _sim_check_for_interrupts(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_LLD_H_ */
+
+/** @} */
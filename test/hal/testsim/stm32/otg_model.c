@@ -0,0 +1,425 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    otg_model.c
+ * @brief   OTG_HS core register level model code.
+ *
+ * @addtogroup OTG_MODEL
+ * @{
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Bits of GRSTCTL cleared by the core when the operation is complete.*/
+#define GRSTCTL_SELF_CLEARING   (GRSTCTL_CSRST | GRSTCTL_RXFFLSH |          \
+                                 GRSTCTL_TXFFLSH)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   OTG_HS registers block.
+ */
+stm32_otg_t otg_model;
+
+/**
+ * @brief   Model counters.
+ */
+otg_model_counters_t otg_model_counters;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+static pthread_t core_thread;
+static bool core_started = false;
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+CH_IRQ_HANDLER(STM32_OTG2_HANDLER);
+
+/**
+ * @brief   Core internal state machine.
+ * @details Resets and FIFO flushes complete asynchronously while the driver
+ *          polls the @p GRSTCTL register, like on the real core.
+ */
+static void *core_emulation(void *arg) {
+
+  (void)arg;
+
+  while (true) {
+    if ((otg_model.GRSTCTL & GRSTCTL_SELF_CLEARING) != 0U) {
+      otg_model.GRSTCTL = GRSTCTL_AHBIDL;
+    }
+    usleep(10);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Raises the core interrupt.
+ * @details The sources are deasserted after the handler returned because the
+ *          model has no write-one-to-clear registers, a reschedule is then
+ *          performed like on the exit of a real interrupt.
+ *
+ * @param[in] sts       the @p GINTSTS interrupt sources
+ */
+static void raise_irq(uint32_t sts) {
+
+  osalDbgAssert((otg_model.GAHBCFG & GAHBCFG_GINTMSK) != 0U,
+                "interrupts disabled");
+
+  otg_model_counters.irqs++;
+  otg_model.GINTSTS = sts;
+  STM32_OTG2_HANDLER();
+  otg_model.GINTSTS = 0U;
+  otg_model.DAINT   = 0U;
+
+  _dbg_check_lock();
+  if (chSchIsPreemptionRequired())
+    chSchDoReschedule();
+  _dbg_check_unlock();
+}
+
+/**
+ * @brief   Raises an OUT endpoint interrupt.
+ *
+ * @param[in] ep        endpoint number
+ * @param[in] epint     the @p DOEPINT interrupt sources
+ */
+static void raise_out_irq(unsigned ep, uint32_t epint) {
+
+  otg_model.oe[ep].DOEPINT = epint;
+  otg_model.DAINT = DAINT_OEPINT(1U << ep);
+  raise_irq(GINTSTS_OEPINT);
+  otg_model.oe[ep].DOEPINT = 0U;
+}
+
+/**
+ * @brief   Raises an IN endpoint interrupt.
+ *
+ * @param[in] ep        endpoint number
+ * @param[in] epint     the @p DIEPINT interrupt sources
+ */
+static void raise_in_irq(unsigned ep, uint32_t epint) {
+
+  otg_model.ie[ep].DIEPINT = epint;
+  otg_model.DAINT = DAINT_IEPINT(1U << ep);
+  raise_irq(GINTSTS_IEPINT);
+  otg_model.ie[ep].DIEPINT = 0U;
+}
+
+/**
+ * @brief   Returns the maximum packet size of an endpoint.
+ * @note    The endpoint zero size is encoded on two bits.
+ *
+ * @param[in] ep        endpoint number
+ * @param[in] ctl       the endpoint control register value
+ */
+static size_t ep_maxsize(unsigned ep, uint32_t ctl) {
+  size_t mps = (size_t)(ctl & DOEPCTL_MPSIZ_MASK);
+
+  if ((ep == 0U) && (mps < 4U)) {
+    return (size_t)64U >> mps;
+  }
+
+  return mps;
+}
+
+/**
+ * @brief   Waits for the device to enable an endpoint, the host is NAKed
+ *          meanwhile.
+ *
+ * @param[in] ctlp      pointer to the endpoint control register
+ * @return              The wait result.
+ * @retval MSG_OK       if the endpoint is enabled.
+ * @retval MSG_RESET    if the endpoint is stalled.
+ * @retval MSG_TIMEOUT  if the device did not enable the endpoint.
+ */
+static msg_t host_wait(volatile uint32_t *ctlp) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)OTG_MODEL_HOST_TIMEOUT; i++) {
+    if ((*ctlp & DOEPCTL_STALL) != 0U) {
+      return MSG_RESET;
+    }
+    if ((*ctlp & DOEPCTL_EPENA) != 0U) {
+      return MSG_OK;
+    }
+    osalThreadSleepMilliseconds(1);
+  }
+
+  return MSG_TIMEOUT;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Model initialization, the registers take their reset values.
+ */
+void otg_model_init(void) {
+
+  memset(&otg_model, 0, sizeof otg_model);
+  memset(&otg_model_counters, 0, sizeof otg_model_counters);
+  otg_model.GRSTCTL = GRSTCTL_AHBIDL;
+
+  if (!core_started) {
+    core_started = true;
+    (void)pthread_create(&core_thread, NULL, core_emulation, NULL);
+  }
+}
+
+/**
+ * @brief   Host side, resets the bus.
+ */
+void otg_model_host_reset(void) {
+
+  raise_irq(GINTSTS_USBRST);
+}
+
+/**
+ * @brief   Host side, sends setup packets to the endpoint zero.
+ * @details The packets are written back-to-back at the address in
+ *          @p DOEPDMA, the core disables the endpoint and raises a single
+ *          setup phase done interrupt.
+ *
+ * @param[in] setup     the setup packets, 8 bytes each
+ * @param[in] n         number of setup packets
+ * @return              The transfer result.
+ * @retval MSG_OK       if the packets have been accepted.
+ * @retval MSG_TIMEOUT  if the endpoint zero is not enabled.
+ */
+msg_t otg_model_host_setup(const uint8_t *setup, unsigned n) {
+  stm32_otg_out_ep_t *oep = &otg_model.oe[0];
+  msg_t msg;
+
+  /* A setup packet always clears the halt condition of the endpoint
+     zero.*/
+  oep->DOEPCTL &= ~DOEPCTL_STALL;
+  otg_model.ie[0].DIEPCTL &= ~DIEPCTL_STALL;
+
+  msg = host_wait(&oep->DOEPCTL);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  while (n > 0U) {
+    uint32_t tsiz = oep->DOEPTSIZ;
+    uint32_t cnt  = (tsiz & DOEPTSIZ_STUPCNT_MASK) >> 29;
+
+    memcpy((uint8_t *)(uintptr_t)oep->DOEPDMA, setup, 8U);
+    oep->DOEPDMA += 8U;
+    if (cnt > 0U) {
+      cnt--;
+    }
+    oep->DOEPTSIZ = (tsiz & ~DOEPTSIZ_STUPCNT_MASK) | DOEPTSIZ_STUPCNT(cnt);
+    otg_model_counters.setup_packets++;
+    setup += 8;
+    n--;
+  }
+
+  oep->DOEPCTL &= ~DOEPCTL_EPENA;
+  raise_out_irq(0U, DOEPINT_STUP);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Host side, performs a control transfer on the endpoint zero.
+ *
+ * @param[in] setup     the setup packet, the data phase length is taken
+ *                      from its @p wLength field
+ * @param[in,out] buf   the data phase buffer
+ * @return              The transfer result.
+ * @retval MSG_OK       if the request has been accepted.
+ * @retval MSG_RESET    if the request has been stalled by the device.
+ * @retval MSG_TIMEOUT  if the device did not answer.
+ */
+msg_t otg_model_host_control(const uint8_t *setup, uint8_t *buf) {
+  size_t n = (size_t)setup[6] | ((size_t)setup[7] << 8);
+  size_t zlp = 0U;
+  msg_t msg;
+
+  msg = otg_model_host_setup(setup, 1U);
+  if ((setup[0] & USB_RTYPE_DIR_MASK) == USB_RTYPE_DIR_DEV2HOST) {
+    if ((msg == MSG_OK) && (n > 0U)) {
+      msg = otg_model_host_in(0U, buf, &n);
+
+      /* Zero sized packet terminating a short transfer, if any.*/
+      if ((msg == MSG_OK) &&
+          ((otg_model.ie[0].DIEPCTL & DIEPCTL_EPENA) != 0U)) {
+        msg = otg_model_host_in(0U, NULL, &zlp);
+      }
+    }
+    if (msg == MSG_OK) {
+      msg = otg_model_host_out(0U, NULL, 0U);
+    }
+  }
+  else {
+    if ((msg == MSG_OK) && (n > 0U)) {
+      msg = otg_model_host_out(0U, buf, n);
+    }
+    if (msg == MSG_OK) {
+      msg = otg_model_host_in(0U, NULL, &zlp);
+    }
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Host side, sends data to an OUT endpoint.
+ * @details The data is split in packets of the endpoint maximum size, each
+ *          packet is written at the address in @p DOEPDMA and decreases the
+ *          transfer size and packet count in @p DOEPTSIZ. A short packet or
+ *          the last programmed packet completes the transfer. A zero sized
+ *          packet is sent if @p n is zero.
+ *
+ * @param[in] ep        endpoint number
+ * @param[in] buf       data to be sent
+ * @param[in] n         number of bytes to be sent
+ * @return              The transfer result.
+ * @retval MSG_OK       if the data has been accepted.
+ * @retval MSG_RESET    if the endpoint is stalled.
+ * @retval MSG_TIMEOUT  if the device did not enable the endpoint.
+ */
+msg_t otg_model_host_out(unsigned ep, const uint8_t *buf, size_t n) {
+  stm32_otg_out_ep_t *oep = &otg_model.oe[ep];
+
+  do {
+    uint32_t tsiz, pcnt, xfrsiz;
+    size_t mps, k;
+    msg_t msg;
+
+    msg = host_wait(&oep->DOEPCTL);
+    if (msg != MSG_OK) {
+      return msg;
+    }
+
+    tsiz   = oep->DOEPTSIZ;
+    pcnt   = (tsiz & DOEPTSIZ_PKTCNT_MASK) >> 19;
+    xfrsiz = tsiz & DOEPTSIZ_XFRSIZ_MASK;
+    mps    = ep_maxsize(ep, oep->DOEPCTL);
+    k      = n < mps ? n : mps;
+
+    /* Data exceeding the programmed size is discarded.*/
+    if (k > xfrsiz) {
+      k = xfrsiz;
+    }
+    if (k > 0U) {
+      memcpy((uint8_t *)(uintptr_t)oep->DOEPDMA, buf, k);
+    }
+    oep->DOEPDMA += (uint32_t)k;
+    xfrsiz -= (uint32_t)k;
+    if (pcnt > 0U) {
+      pcnt--;
+    }
+    oep->DOEPTSIZ = (tsiz & ~(DOEPTSIZ_PKTCNT_MASK | DOEPTSIZ_XFRSIZ_MASK)) |
+                    DOEPTSIZ_PKTCNT(pcnt) | DOEPTSIZ_XFRSIZ(xfrsiz);
+    otg_model_counters.out_packets++;
+    buf += k;
+    n   -= k;
+
+    if ((k < mps) || (pcnt == 0U)) {
+      oep->DOEPCTL &= ~DOEPCTL_EPENA;
+      raise_out_irq(ep, DOEPINT_XFRC);
+    }
+  } while (n > 0U);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Host side, receives data from an IN endpoint.
+ * @details Packets are fetched from the address in @p DIEPDMA until a short
+ *          packet is received or the buffer is full, the transfer completes
+ *          when the programmed packet count reaches zero.
+ *
+ * @param[in] ep        endpoint number
+ * @param[out] buf      buffer for the received data
+ * @param[in,out] np    size of the buffer on entry, number of received
+ *                      bytes on exit
+ * @return              The transfer result.
+ * @retval MSG_OK       if data has been received.
+ * @retval MSG_RESET    if the endpoint is stalled.
+ * @retval MSG_TIMEOUT  if the device did not enable the endpoint.
+ */
+msg_t otg_model_host_in(unsigned ep, uint8_t *buf, size_t *np) {
+  stm32_otg_in_ep_t *iep = &otg_model.ie[ep];
+  size_t n = 0U;
+
+  while (true) {
+    uint32_t tsiz, pcnt, xfrsiz;
+    size_t mps, k;
+    msg_t msg;
+
+    msg = host_wait(&iep->DIEPCTL);
+    if (msg != MSG_OK) {
+      *np = n;
+      return msg;
+    }
+
+    tsiz   = iep->DIEPTSIZ;
+    pcnt   = (tsiz & DIEPTSIZ_PKTCNT_MASK) >> 19;
+    xfrsiz = tsiz & DIEPTSIZ_XFRSIZ_MASK;
+    mps    = ep_maxsize(ep, iep->DIEPCTL);
+    k      = xfrsiz < mps ? xfrsiz : mps;
+
+    /* Data exceeding the buffer size is discarded.*/
+    if (k > 0U) {
+      memcpy(buf + n, (const uint8_t *)(uintptr_t)iep->DIEPDMA,
+             k < *np - n ? k : *np - n);
+    }
+    iep->DIEPDMA += (uint32_t)k;
+    xfrsiz -= (uint32_t)k;
+    if (pcnt > 0U) {
+      pcnt--;
+    }
+    iep->DIEPTSIZ = (tsiz & ~(DIEPTSIZ_PKTCNT_MASK | DIEPTSIZ_XFRSIZ_MASK)) |
+                    DIEPTSIZ_PKTCNT(pcnt) | DIEPTSIZ_XFRSIZ(xfrsiz);
+    otg_model_counters.in_packets++;
+    n += k < *np - n ? k : *np - n;
+
+    if (pcnt == 0U) {
+      iep->DIEPCTL &= ~DIEPCTL_EPENA;
+      raise_in_irq(ep, DIEPINT_XFRC);
+    }
+    if ((k < mps) || (n >= *np)) {
+      break;
+    }
+  }
+
+  *np = n;
+  return MSG_OK;
+}
+
+/** @} */
@@ -0,0 +1,112 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    otg_model.h
+ * @brief   OTG_HS core register level model header.
+ * @details The model emulates the device mode of the OTG core with the
+ *          internal DMA enabled, the bus is driven by the
+ *          @p otg_model_host_*() functions acting as the USB host. The core
+ *          moves the data from and to the addresses programmed in the
+ *          @p DOEPDMA and @p DIEPDMA registers and updates the transfer
+ *          size registers packet by packet, the interrupt handler is
+ *          invoked in the context of the thread calling the host functions.
+ *
+ * @addtogroup OTG_MODEL
+ * @{
+ */
+
+#ifndef _OTG_MODEL_H_
+#define _OTG_MODEL_H_
+
+#include "stm32_otg.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Time the host waits for an endpoint to become ready.
+ */
+#if !defined(OTG_MODEL_HOST_TIMEOUT) || defined(__DOXYGEN__)
+#define OTG_MODEL_HOST_TIMEOUT              1000
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Model counters.
+ */
+typedef struct {
+  /**
+   * @brief   Setup packets written in memory.
+   */
+  uint32_t                      setup_packets;
+  /**
+   * @brief   OUT data packets written in memory.
+   */
+  uint32_t                      out_packets;
+  /**
+   * @brief   IN data packets fetched from memory.
+   */
+  uint32_t                      in_packets;
+  /**
+   * @brief   Interrupts raised.
+   */
+  uint32_t                      irqs;
+} otg_model_counters_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/* The OTG_HS registers block is the model.*/
+#undef OTG_HS
+#define OTG_HS                              (&otg_model)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern stm32_otg_t otg_model;
+extern otg_model_counters_t otg_model_counters;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void otg_model_init(void);
+  void otg_model_host_reset(void);
+  msg_t otg_model_host_setup(const uint8_t *setup, unsigned n);
+  msg_t otg_model_host_control(const uint8_t *setup, uint8_t *buf);
+  msg_t otg_model_host_out(unsigned ep, const uint8_t *buf, size_t n);
+  msg_t otg_model_host_in(unsigned ep, uint8_t *buf, size_t *np);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OTG_MODEL_H_ */
+
+/** @} */
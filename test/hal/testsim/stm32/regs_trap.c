@@ -0,0 +1,207 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    regs_trap.c
+ * @brief   Registers access traps code.
+ *
+ * @addtogroup REGS_TRAP
+ * @{
+ */
+
+/* Required for the registers names in the signal context.*/
+#define _GNU_SOURCE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Trap flag of the EFLAGS register.*/
+#define EFLAGS_TF               0x00000100
+
+/* Write access bit of the page fault error code.*/
+#define PF_ERR_WRITE            0x00000002
+
+/* Size of the signals stack.*/
+#define SIGNALS_STACK_SIZE      65536U
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Registered registers block.
+ */
+typedef struct {
+  uint8_t                       *base;
+  size_t                        size;
+  regs_trap_written_t           written;
+} block_t;
+
+static block_t blocks[REGS_TRAP_MAX_BLOCKS];
+static unsigned nblocks;
+
+static block_t *trap_block;
+static size_t trap_offset;
+static uint32_t trap_old;
+static bool trap_write;
+static uint8_t signals_stack[SIGNALS_STACK_SIZE];
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers access trap.
+ * @details The registers are made accessible and the accessing instruction
+ *          is restarted in single step mode.
+ */
+static void access_trap(int sig, siginfo_t *sip, void *ctx) {
+  ucontext_t *ucp = (ucontext_t *)ctx;
+  uint8_t *addr = (uint8_t *)sip->si_addr;
+  unsigned i;
+
+  (void)sig;
+
+  for (i = 0U; i < nblocks; i++) {
+    if ((addr >= blocks[i].base) &&
+        (addr < blocks[i].base + blocks[i].size)) {
+      break;
+    }
+  }
+  if (i == nblocks) {
+    /* Not a model access, the fault is raised again with the default
+       action.*/
+    (void)signal(SIGSEGV, SIG_DFL);
+    return;
+  }
+
+  trap_block  = &blocks[i];
+  regs_trap_unlock(trap_block->base, trap_block->size);
+  trap_offset = (size_t)(addr - trap_block->base) & ~(size_t)3U;
+  trap_old    = *(volatile uint32_t *)(trap_block->base + trap_offset);
+  trap_write  = (ucp->uc_mcontext.gregs[REG_ERR] & PF_ERR_WRITE) != 0;
+  ucp->uc_mcontext.gregs[REG_EFL] |= EFLAGS_TF;
+}
+
+/**
+ * @brief   Single step trap, the accessing instruction has been executed.
+ */
+static void step_trap(int sig, siginfo_t *sip, void *ctx) {
+  ucontext_t *ucp = (ucontext_t *)ctx;
+
+  (void)sig;
+  (void)sip;
+
+  ucp->uc_mcontext.gregs[REG_EFL] &= ~EFLAGS_TF;
+  if (trap_write) {
+    trap_block->written(trap_offset, trap_old);
+  }
+  regs_trap_lock(trap_block->base, trap_block->size);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers a registers block, the block is protected.
+ * @details The traps are installed on the first registration, registering
+ *          a block again updates the write notification only.
+ *
+ * @param[in] base      base of the block, page aligned
+ * @param[in] size      size of the block, multiple of the page size
+ * @param[in] written   write notification of the model
+ */
+void regs_trap_register(void *base, size_t size,
+                        regs_trap_written_t written) {
+  unsigned i;
+
+  osalDbgCheck((((uintptr_t)base % REGS_TRAP_PAGE_SIZE) == 0U) &&
+               ((size % REGS_TRAP_PAGE_SIZE) == 0U));
+
+  if (nblocks == 0U) {
+    struct sigaction sa;
+    stack_t ss;
+
+    /* The traps run on their own stack, the threads stacks are too small
+       for the signal frames.*/
+    ss.ss_sp    = signals_stack;
+    ss.ss_size  = sizeof signals_stack;
+    ss.ss_flags = 0;
+    (void)sigaltstack(&ss, NULL);
+
+    memset(&sa, 0, sizeof sa);
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags     = SA_SIGINFO | SA_ONSTACK;
+    sa.sa_sigaction = access_trap;
+    (void)sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = step_trap;
+    (void)sigaction(SIGTRAP, &sa, NULL);
+  }
+
+  for (i = 0U; i < nblocks; i++) {
+    if (blocks[i].base == (uint8_t *)base) {
+      break;
+    }
+  }
+  if (i == nblocks) {
+    osalDbgAssert(nblocks < REGS_TRAP_MAX_BLOCKS, "too many blocks");
+    nblocks++;
+  }
+  blocks[i].base    = (uint8_t *)base;
+  blocks[i].size    = size;
+  blocks[i].written = written;
+
+  regs_trap_lock(base, size);
+}
+
+/**
+ * @brief   Registers access by the model.
+ *
+ * @param[in] base      base of the block
+ * @param[in] size      size of the block
+ */
+void regs_trap_unlock(void *base, size_t size) {
+
+  (void)mprotect(base, size, PROT_READ | PROT_WRITE);
+}
+
+/**
+ * @brief   Registers access by the driver, each access is trapped.
+ *
+ * @param[in] base      base of the block
+ * @param[in] size      size of the block
+ */
+void regs_trap_lock(void *base, size_t size) {
+
+  (void)mprotect(base, size, PROT_NONE);
+}
+
+/** @} */
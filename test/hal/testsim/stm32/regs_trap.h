@@ -0,0 +1,90 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    regs_trap.h
+ * @brief   Registers access traps header.
+ * @details The registers blocks of the models lie in pages of their own
+ *          that are kept protected, each access by the drivers raises a
+ *          fault. The block is made accessible and the accessing
+ *          instruction is restarted in single step mode, when it completes
+ *          the model is notified of the writes and the block is protected
+ *          again. This allows the models to apply the side effects of the
+ *          writes immediately, write-one-to-clear flags included.
+ *
+ * @addtogroup REGS_TRAP
+ * @{
+ */
+
+#ifndef _REGS_TRAP_H_
+#define _REGS_TRAP_H_
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the protected pages.
+ */
+#define REGS_TRAP_PAGE_SIZE                 4096U
+
+/**
+ * @brief   Maximum number of registers blocks.
+ */
+#define REGS_TRAP_MAX_BLOCKS                4U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Register write notification.
+ *
+ * @param[in] offset    offset of the written register, word aligned
+ * @param[in] old       the register value before the write
+ */
+typedef void (*regs_trap_written_t)(size_t offset, uint32_t old);
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void regs_trap_register(void *base, size_t size,
+                          regs_trap_written_t written);
+  void regs_trap_unlock(void *base, size_t size);
+  void regs_trap_lock(void *base, size_t size);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _REGS_TRAP_H_ */
+
+/** @} */
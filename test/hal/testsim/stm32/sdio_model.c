@@ -0,0 +1,768 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    sdio_model.c
+ * @brief   SDIO cell and SD card register level model code.
+ *
+ * @addtogroup SDIO_MODEL
+ * @{
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Card status bits.*/
+#define R1_OUT_OF_RANGE         0x80000000U
+#define R1_ADDRESS_ERROR        0x40000000U
+#define R1_BLOCK_LEN_ERROR      0x20000000U
+#define R1_READY_FOR_DATA       0x00000100U
+#define R1_APP_CMD              0x00000020U
+#define R1_STATE(s)             ((uint32_t)(s) << 9)
+
+/* Status bits reported in the R6 response.*/
+#define R6_STATUS_MASK          0x00001FFFU
+
+/* OCR bits.*/
+#define OCR_BUSY                0x80000000U
+#define OCR_CCS                 0x40000000U
+#define OCR_VOLTAGES            0x00FF8000U
+
+/* Echoed bits of the CMD8 argument.*/
+#define IF_COND_MASK            0x00000FFFU
+
+/* Static flags of the STA register, cleared through the ICR register.*/
+#define STA_STATIC              0x00C007FFU
+
+/* Requests of the cell to the DMA2 controller, channel 4 on streams 3
+   and 6.*/
+#define DMA_STREAMS             (STM32_DMA_STREAM_ID_MSK(2U, 3U) |          \
+                                 STM32_DMA_STREAM_ID_MSK(2U, 6U))
+#define DMA_CHANNEL             4U
+
+/* Size of the switch function status.*/
+#define SWITCH_STATUS_SIZE      64U
+
+/* Read-only registers of the cell, written by the model.*/
+#define RO(reg)                 (*(volatile uint32_t *)&sdio_model.regs.reg)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   SDIO registers block.
+ */
+sdio_model_page_t sdio_model __attribute__((aligned(SDIO_MODEL_PAGE_SIZE)));
+
+/**
+ * @brief   Card model.
+ */
+sdio_model_card_t sdio_model_card;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Responses of the card.
+ */
+typedef enum {
+  RESP_NONE = 0,                    /**< No response on the line.           */
+  RESP_SHORT = 1,                   /**< R1, R6 or R7 response.             */
+  RESP_OCR = 2,                     /**< R3 response, no CRC.               */
+  RESP_LONG = 3                     /**< R2 response.                       */
+} resp_t;
+
+static bool inserted;
+static bool acmd;
+static unsigned polls;
+static uint32_t state;
+static uint32_t blk;
+static bool multiple;
+static bool switching;
+static uint32_t written;
+static unsigned prg_polls;
+static bool data_armed;
+static bool irq_check;
+
+/* Data block being transferred.*/
+static uint8_t block[SDIO_MODEL_BLOCK_SIZE];
+
+/* Switch function status being transferred.*/
+static uint8_t switch_status[SWITCH_STATUS_SIZE];
+
+static const uint8_t cid[16] = {
+  0x03, 'S', 'D', 'S', 'D', 'I', 'O', 'M',
+  0x10, 0x12, 0x34, 0x56, 0x78, 0x01, 0x0A, 0x01
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+CH_IRQ_HANDLER(STM32_SDIO_HANDLER);
+
+/**
+ * @brief   Registers access by the model.
+ */
+static void regs_unlock(void) {
+
+  regs_trap_unlock(&sdio_model, sizeof sdio_model);
+}
+
+/**
+ * @brief   Registers access by the driver, each access is trapped.
+ */
+static void regs_lock(void) {
+
+  regs_trap_lock(&sdio_model, sizeof sdio_model);
+}
+
+/*
+ * Sets a field of a register, the bits are numbered as in the
+ * specification with bit 127 being the MSB of the first byte.
+ */
+static void set_field(uint8_t *reg, unsigned end, unsigned start,
+                      uint32_t value) {
+  unsigned bit;
+
+  for (bit = start; bit <= end; bit++) {
+    uint8_t mask = (uint8_t)(1U << (bit % 8U));
+    if ((value & 1U) != 0U) {
+      reg[(127U - bit) / 8U] |= mask;
+    }
+    else {
+      reg[(127U - bit) / 8U] &= (uint8_t)~mask;
+    }
+    value >>= 1;
+  }
+}
+
+/*
+ * Loads a long response, the cell returns the bits 127..1 of the register.
+ */
+static void set_long(uint32_t *resp, const uint8_t *reg) {
+  unsigned i;
+
+  for (i = 0U; i < 4U; i++) {
+    resp[i] = ((uint32_t)reg[i * 4U] << 24) |
+              ((uint32_t)reg[(i * 4U) + 1U] << 16) |
+              ((uint32_t)reg[(i * 4U) + 2U] << 8) |
+              (uint32_t)reg[(i * 4U) + 3U];
+  }
+  resp[3] &= ~1U;
+}
+
+/*
+ * Card status as reported in the R1 response.
+ */
+static uint32_t status(bool app) {
+  uint32_t r1 = R1_STATE(state);
+
+  if ((state == MMCSD_STS_TRAN) || (state == MMCSD_STS_RCV)) {
+    r1 |= R1_READY_FOR_DATA;
+  }
+  if (app) {
+    r1 |= R1_APP_CMD;
+  }
+  return r1;
+}
+
+/*
+ * Checks the address of a data command, the block is selected.
+ */
+static uint32_t address(uint32_t arg) {
+
+  if (!sdio_model_card.hc) {
+    if ((arg % SDIO_MODEL_BLOCK_SIZE) != 0U) {
+      return R1_ADDRESS_ERROR;
+    }
+    arg /= SDIO_MODEL_BLOCK_SIZE;
+  }
+  if (arg >= SDIO_MODEL_BLOCKS) {
+    return R1_OUT_OF_RANGE;
+  }
+  blk = arg;
+  return 0U;
+}
+
+/*
+ * Programming of the received blocks, the busy state is reported to the
+ * next status requests.
+ */
+static void program(void) {
+
+  prg_polls = SDIO_MODEL_PROGRAM_POLLS;
+  state = prg_polls > 0U ? MMCSD_STS_PRG : MMCSD_STS_TRAN;
+}
+
+/*
+ * Builds the switch function status, only the access mode group is
+ * implemented with the default and high speed functions.
+ */
+static void switch_function(uint32_t arg) {
+  uint32_t fn = arg & 0xFU;
+  unsigned i;
+
+  memset(switch_status, 0, sizeof switch_status);
+  switch_status[1] = 100U;
+  for (i = 2U; i <= 12U; i += 2U) {
+    switch_status[i]      = 0x80U;
+    switch_status[i + 1U] = 0x01U;
+  }
+  switch_status[13] = 0x03U;
+  switch_status[14] = 0U;
+  switch_status[15] = 0U;
+  switch_status[16] = (uint8_t)(fn == 0xFU ? 0U : (fn <= 1U ? fn : 0xFU));
+}
+
+/*
+ * Card side of a command, the state is updated and the response built.
+ * The commands illegal in the current state are ignored.
+ */
+static resp_t card_command(uint32_t index, uint32_t arg, uint32_t *resp) {
+  bool app = acmd;
+  bool own = (arg >> 16) == SDIO_MODEL_RCA;
+  uint32_t r1 = status(app);
+  uint8_t reg[16];
+
+  acmd = false;
+  if (app && (index == MMCSD_CMD_APP_OP_COND)) {
+    if ((state != MMCSD_STS_IDLE) && (state != MMCSD_STS_READY)) {
+      return RESP_NONE;
+    }
+    resp[0] = OCR_VOLTAGES;
+    if ((++polls > SDIO_MODEL_INIT_POLLS) &&
+        (!sdio_model_card.hc || ((arg & OCR_CCS) != 0U))) {
+      resp[0] |= OCR_BUSY | (sdio_model_card.hc ? OCR_CCS : 0U);
+      state = MMCSD_STS_READY;
+    }
+    sdio_model_card.commands[index]++;
+    return RESP_OCR;
+  }
+  if (app && (index == MMCSD_CMD_SET_BUS_WIDTH)) {
+    if (state != MMCSD_STS_TRAN) {
+      return RESP_NONE;
+    }
+    resp[0] = r1;
+    sdio_model_card.commands[index]++;
+    return RESP_SHORT;
+  }
+
+  switch (index) {
+  case MMCSD_CMD_GO_IDLE_STATE:
+    state = MMCSD_STS_IDLE;
+    polls = 0U;
+    sdio_model_card.commands[index]++;
+    return RESP_NONE;
+  case MMCSD_CMD_SEND_IF_COND:
+    if (state != MMCSD_STS_IDLE) {
+      return RESP_NONE;
+    }
+    resp[0] = arg & IF_COND_MASK;
+    break;
+  case MMCSD_CMD_APP_CMD:
+    if ((state != MMCSD_STS_IDLE) && (state != MMCSD_STS_READY) && !own) {
+      return RESP_NONE;
+    }
+    acmd = true;
+    resp[0] = r1 | R1_APP_CMD;
+    break;
+  case MMCSD_CMD_ALL_SEND_CID:
+    if (state != MMCSD_STS_READY) {
+      return RESP_NONE;
+    }
+    state = MMCSD_STS_IDENT;
+    set_long(resp, cid);
+    sdio_model_card.commands[index]++;
+    return RESP_LONG;
+  case MMCSD_CMD_SEND_RELATIVE_ADDR:
+    if ((state != MMCSD_STS_IDENT) && (state != MMCSD_STS_STBY)) {
+      return RESP_NONE;
+    }
+    state = MMCSD_STS_STBY;
+    resp[0] = (SDIO_MODEL_RCA << 16) | (r1 & R6_STATUS_MASK);
+    break;
+  case MMCSD_CMD_SEND_CSD:
+    if ((state != MMCSD_STS_STBY) || !own) {
+      return RESP_NONE;
+    }
+    memset(reg, 0, sizeof reg);
+    if (sdio_model_card.hc) {
+      set_field(reg, 127U, 126U, 1U);
+      set_field(reg, 69U, 48U, (SDIO_MODEL_BLOCKS / 1024U) - 1U);
+    }
+    else {
+      /* Capacity is (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) blocks.*/
+      set_field(reg, 83U, 80U, 9U);
+      set_field(reg, 73U, 62U, (SDIO_MODEL_BLOCKS / 512U) - 1U);
+      set_field(reg, 49U, 47U, 7U);
+    }
+    set_long(resp, reg);
+    sdio_model_card.commands[index]++;
+    return RESP_LONG;
+  case MMCSD_CMD_SEL_DESEL_CARD:
+    if (!own) {
+      /* Deselected cards do not answer.*/
+      if (state == MMCSD_STS_TRAN) {
+        state = MMCSD_STS_STBY;
+      }
+      return RESP_NONE;
+    }
+    if (state != MMCSD_STS_STBY) {
+      return RESP_NONE;
+    }
+    state = MMCSD_STS_TRAN;
+    resp[0] = r1;
+    break;
+  case MMCSD_CMD_SEND_STATUS:
+    if ((state < MMCSD_STS_STBY) || !own) {
+      return RESP_NONE;
+    }
+    resp[0] = r1;
+    if ((state == MMCSD_STS_PRG) && (--prg_polls == 0U)) {
+      state = MMCSD_STS_TRAN;
+    }
+    break;
+  case MMCSD_CMD_SET_BLOCKLEN:
+    if (state != MMCSD_STS_TRAN) {
+      return RESP_NONE;
+    }
+    resp[0] = r1 | (arg != SDIO_MODEL_BLOCK_SIZE ? R1_BLOCK_LEN_ERROR : 0U);
+    break;
+  case MMCSD_CMD_SWITCH:
+    if (state != MMCSD_STS_TRAN) {
+      return RESP_NONE;
+    }
+    switch_function(arg);
+    switching = true;
+    state = MMCSD_STS_DATA;
+    resp[0] = r1;
+    break;
+  case MMCSD_CMD_READ_SINGLE_BLOCK:
+  case MMCSD_CMD_READ_MULTIPLE_BLOCK:
+  case MMCSD_CMD_WRITE_BLOCK:
+  case MMCSD_CMD_WRITE_MULTIPLE_BLOCK:
+    if (state != MMCSD_STS_TRAN) {
+      return RESP_NONE;
+    }
+    resp[0] = r1 | address(arg);
+    if (resp[0] == r1) {
+      multiple = (index == MMCSD_CMD_READ_MULTIPLE_BLOCK) ||
+                 (index == MMCSD_CMD_WRITE_MULTIPLE_BLOCK);
+      written  = 0U;
+      state    = (index == MMCSD_CMD_READ_SINGLE_BLOCK) ||
+                 (index == MMCSD_CMD_READ_MULTIPLE_BLOCK) ?
+                 MMCSD_STS_DATA : MMCSD_STS_RCV;
+    }
+    break;
+  case MMCSD_CMD_STOP_TRANSMISSION:
+    if (state == MMCSD_STS_DATA) {
+      state = MMCSD_STS_TRAN;
+    }
+    else if (state == MMCSD_STS_RCV) {
+      if (written > 0U) {
+        program();
+      }
+      else {
+        state = MMCSD_STS_TRAN;
+      }
+    }
+    else {
+      return RESP_NONE;
+    }
+    resp[0] = r1;
+    break;
+  default:
+    return RESP_NONE;
+  }
+
+  sdio_model_card.commands[index]++;
+  return RESP_SHORT;
+}
+
+/*
+ * Checks if the card is powered and clocked.
+ */
+static bool clocked(void) {
+  SDIO_TypeDef *sp = &sdio_model.regs;
+
+  return inserted &&
+         ((sp->POWER & SDIO_POWER_PWRCTRL) == SDIO_POWER_PWRCTRL) &&
+         ((sp->CLKCR & SDIO_CLKCR_CLKEN) != 0U);
+}
+
+/*
+ * Command path, the command is sent and its response received.
+ */
+static void cmd_execute(void) {
+  SDIO_TypeDef *sp = &sdio_model.regs;
+  uint32_t index = sp->CMD & SDIO_CMD_CMDINDEX;
+  uint32_t wait = sp->CMD & SDIO_CMD_WAITRESP;
+  uint32_t resp[4] = {0U, 0U, 0U, 0U};
+  resp_t type = RESP_NONE;
+
+  if (clocked()) {
+    type = card_command(index, sp->ARG, resp);
+  }
+
+  if (wait == 0U) {
+    RO(STA) |= SDIO_STA_CMDSENT;
+    return;
+  }
+  if (type == RESP_NONE) {
+    RO(STA) |= SDIO_STA_CTIMEOUT;
+    return;
+  }
+
+  /* The long responses must be expected as such.*/
+  if ((wait == SDIO_CMD_WAITRESP) != (type == RESP_LONG)) {
+    sdio_model_card.protocol_errors++;
+  }
+
+  RO(RESPCMD) = (type == RESP_SHORT) ? index : SDIO_CMD_CMDINDEX;
+  RO(RESP1)   = resp[0];
+  RO(RESP2)   = resp[1];
+  RO(RESP3)   = resp[2];
+  RO(RESP4)   = resp[3];
+  if (type == RESP_OCR) {
+    /* The R3 response has no CRC, the check always fails.*/
+    RO(STA) |= SDIO_STA_CCRCFAIL;
+  }
+  else if (sdio_model_card.cmd_crc_faults > 0U) {
+    sdio_model_card.cmd_crc_faults--;
+    sdio_model_card.cmd_crc_errors++;
+    RO(STA) |= SDIO_STA_CCRCFAIL;
+  }
+  else {
+    RO(STA) |= SDIO_STA_CMDREND;
+  }
+}
+
+/*
+ * Data path, blocks sent by the card. The path stops on the first block
+ * received corrupted while the card keeps its state.
+ */
+static void data_send(size_t bsize) {
+  uint32_t len = sdio_model.regs.DLEN;
+
+  while (len > 0U) {
+    size_t n = len < bsize ? len : bsize;
+    bool corrupted = false;
+
+    if (switching) {
+      memcpy(block, switch_status, n);
+    }
+    else if (blk < SDIO_MODEL_BLOCKS) {
+      memcpy(block, sdio_model_card.data[blk], n);
+    }
+    else {
+      RO(STA) |= SDIO_STA_DTIMEOUT;
+      break;
+    }
+    if (sdio_model_card.read_crc_faults > 0U) {
+      sdio_model_card.read_crc_faults--;
+      sdio_model_card.data_crc_errors++;
+      block[0] ^= 0xFFU;
+      corrupted = true;
+    }
+    if (dma_model_p2m(DMA_STREAMS, DMA_CHANNEL, block, n) != n) {
+      sdio_model_card.protocol_errors++;
+      RO(STA) |= SDIO_STA_RXOVERR;
+      break;
+    }
+
+    if (switching) {
+      switching = false;
+      state = MMCSD_STS_TRAN;
+    }
+    else {
+      sdio_model_card.blocks_read++;
+      if (multiple) {
+        blk++;
+      }
+      else {
+        state = MMCSD_STS_TRAN;
+      }
+    }
+    if (corrupted) {
+      RO(STA) |= SDIO_STA_DCRCFAIL;
+      break;
+    }
+    len -= (uint32_t)n;
+    RO(STA) |= SDIO_STA_DBCKEND;
+  }
+
+  RO(DCOUNT) = len;
+  if (len == 0U) {
+    RO(STA) |= SDIO_STA_DATAEND;
+  }
+}
+
+/*
+ * Data path, blocks received by the card. The path stops on the first
+ * block received corrupted, the card ignores the data until stopped.
+ */
+static void data_receive(size_t bsize) {
+  uint32_t len = sdio_model.regs.DLEN;
+
+  if (bsize != SDIO_MODEL_BLOCK_SIZE) {
+    sdio_model_card.protocol_errors++;
+    RO(STA) |= SDIO_STA_DTIMEOUT;
+    return;
+  }
+
+  while (len > 0U) {
+    if (dma_model_m2p(DMA_STREAMS, DMA_CHANNEL, block, bsize) != bsize) {
+      sdio_model_card.protocol_errors++;
+      RO(STA) |= SDIO_STA_TXUNDERR;
+      break;
+    }
+
+    if (sdio_model_card.write_crc_faults > 0U) {
+      sdio_model_card.write_crc_faults--;
+      sdio_model_card.data_crc_errors++;
+      if (!multiple) {
+        state = MMCSD_STS_TRAN;
+      }
+      RO(STA) |= SDIO_STA_DCRCFAIL;
+      break;
+    }
+    if (blk >= SDIO_MODEL_BLOCKS) {
+      RO(STA) |= SDIO_STA_DTIMEOUT;
+      break;
+    }
+    memcpy(sdio_model_card.data[blk], block, bsize);
+    len -= (uint32_t)bsize;
+    sdio_model_card.blocks_written++;
+    written++;
+    if (multiple) {
+      blk++;
+    }
+    else {
+      program();
+    }
+    RO(STA) |= SDIO_STA_DBCKEND;
+  }
+
+  RO(DCOUNT) = len;
+  if (len == 0U) {
+    RO(STA) |= SDIO_STA_DATAEND;
+  }
+}
+
+/*
+ * Starts the armed data path as soon as the card is in the data state
+ * matching the direction, the blocks are moved at once.
+ */
+static void data_run(void) {
+  SDIO_TypeDef *sp = &sdio_model.regs;
+  bool send = (sp->DCTRL & SDIO_DCTRL_DTDIR) != 0U;
+  size_t bsize;
+
+  if (!data_armed || !clocked() ||
+      (state != (send ? MMCSD_STS_DATA : MMCSD_STS_RCV))) {
+    return;
+  }
+  data_armed = false;
+
+  if (sdio_model_card.transfers < SDIO_MODEL_CLKDIV_LOG) {
+    sdio_model_card.clkdivs[sdio_model_card.transfers] =
+      sp->CLKCR & SDIO_CLKCR_CLKDIV;
+  }
+  sdio_model_card.transfers++;
+
+  /* Only the DMA mode is modeled.*/
+  if ((sp->DCTRL & SDIO_DCTRL_DMAEN) == 0U) {
+    sdio_model_card.protocol_errors++;
+    RO(STA) |= SDIO_STA_DTIMEOUT;
+    return;
+  }
+
+  if ((sp->DCTRL & SDIO_DCTRL_DTMODE) != 0U) {
+    bsize = sp->DLEN;
+  }
+  else {
+    bsize = (size_t)1U << ((sp->DCTRL & SDIO_DCTRL_DBLOCKSIZE) >> 4);
+  }
+  if (send) {
+    data_send(bsize);
+  }
+  else {
+    data_receive(bsize);
+  }
+}
+
+/**
+ * @brief   Applies the side effects of a register write.
+ *
+ * @param[in] offset    offset of the written register
+ * @param[in] old       the register value before the write
+ */
+static void reg_written(size_t offset, uint32_t old) {
+  SDIO_TypeDef *sp = &sdio_model.regs;
+  uint32_t w = *(volatile uint32_t *)(sdio_model.page + offset);
+
+  (void)old;
+
+  irq_check = true;
+  if (offset == offsetof(SDIO_TypeDef, POWER)) {
+    /* The card is reset when the power is removed.*/
+    if ((w & SDIO_POWER_PWRCTRL) != SDIO_POWER_PWRCTRL) {
+      state = MMCSD_STS_IDLE;
+      acmd  = false;
+      polls = 0U;
+    }
+  }
+  else if (offset == offsetof(SDIO_TypeDef, CMD)) {
+    if ((w & SDIO_CMD_CPSMEN) != 0U) {
+      cmd_execute();
+      data_run();
+    }
+  }
+  else if (offset == offsetof(SDIO_TypeDef, DCTRL)) {
+    data_armed = (w & SDIO_DCTRL_DTEN) != 0U;
+    data_run();
+  }
+  else if (offset == offsetof(SDIO_TypeDef, ICR)) {
+    RO(STA) &= ~(w & STA_STATIC);
+    sp->ICR = 0U;
+  }
+}
+
+/**
+ * @brief   Raises the active interrupt.
+ * @details The handler is invoked as long as an interrupt source is
+ *          active, a reschedule is performed after each invocation like on
+ *          the exit of a real interrupt.
+ * @note    Must be invoked with the registers locked.
+ */
+static void raise_irqs(void) {
+  bool active;
+
+  while (irq_check) {
+    irq_check = false;
+    regs_unlock();
+    active = (sdio_model.regs.STA & sdio_model.regs.MASK) != 0U;
+    regs_lock();
+    if (!active) {
+      break;
+    }
+
+    irq_check = true;
+    STM32_SDIO_HANDLER();
+
+    _dbg_check_lock();
+    if (chSchIsPreemptionRequired())
+      chSchDoReschedule();
+    _dbg_check_unlock();
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Model initialization, the registers take their reset values and
+ *          no card is inserted.
+ */
+void sdio_model_init(void) {
+
+  regs_unlock();
+  memset(&sdio_model, 0, sizeof sdio_model);
+  memset(&sdio_model_card, 0, sizeof sdio_model_card);
+  inserted   = false;
+  acmd       = false;
+  polls      = 0U;
+  state      = MMCSD_STS_IDLE;
+  switching  = false;
+  data_armed = false;
+  irq_check  = false;
+
+  regs_trap_register(&sdio_model, sizeof sdio_model, reg_written);
+}
+
+/**
+ * @brief   Interrupts check.
+ */
+void sdio_model_check_for_interrupts(void) {
+
+  raise_irqs();
+}
+
+/**
+ * @brief   Inserts a card, the counters are cleared and the card memory is
+ *          preserved.
+ *
+ * @param[in] hc        @p true for a high capacity card
+ */
+void sdio_model_insert(bool hc) {
+
+  memset(&sdio_model_card, 0, offsetof(sdio_model_card_t, data));
+  sdio_model_card.hc = hc;
+  inserted  = true;
+  acmd      = false;
+  polls     = 0U;
+  state     = MMCSD_STS_IDLE;
+  switching = false;
+}
+
+/**
+ * @brief   Removes the card, the commands are no more answered.
+ */
+void sdio_model_remove(void) {
+
+  inserted = false;
+}
+
+#if (HAL_USE_SDC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Card insertion status.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @return              The card state.
+ */
+bool sdc_lld_is_card_inserted(SDCDriver *sdcp) {
+
+  (void)sdcp;
+
+  return inserted;
+}
+
+/**
+ * @brief   Card write protection status.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @return              The card state.
+ */
+bool sdc_lld_is_write_protected(SDCDriver *sdcp) {
+
+  (void)sdcp;
+
+  return false;
+}
+#endif /* HAL_USE_SDC == TRUE */
+
+/** @} */
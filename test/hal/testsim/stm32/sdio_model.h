@@ -0,0 +1,203 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    sdio_model.h
+ * @brief   SDIO cell and SD card register level model header.
+ * @details The model emulates the SDIO cell with an SD card attached. The
+ *          commands are executed when written in the @p CMD register, the
+ *          card walks the states of the SD specification and answers with
+ *          the responses of its states. The data blocks are moved through
+ *          the DMA streams of the DMA model as soon as both the data path
+ *          and the card are ready, the cell flags are raised accordingly
+ *          and the interrupt handler is invoked on the interrupts check.
+ *          <br>
+ *          The test code can inject CRC errors in the command responses,
+ *          in the data blocks sent by the card and in the data blocks
+ *          received by the card. The card clock divider in effect at each
+ *          data transfer is recorded.
+ *
+ * @addtogroup SDIO_MODEL
+ * @{
+ */
+
+#ifndef _SDIO_MODEL_H_
+#define _SDIO_MODEL_H_
+
+#include "stm32f4xx.h"
+#include "regs_trap.h"
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of the protected page containing the registers block.
+ */
+#define SDIO_MODEL_PAGE_SIZE                REGS_TRAP_PAGE_SIZE
+
+/**
+ * @brief   Size of the card data blocks.
+ */
+#define SDIO_MODEL_BLOCK_SIZE               512U
+
+/**
+ * @brief   Relative address published by the card.
+ */
+#define SDIO_MODEL_RCA                      0x1234U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Card capacity in blocks.
+ * @note    Must be a multiple of 1024 blocks, the SDHC cards capacity
+ *          granularity.
+ */
+#if !defined(SDIO_MODEL_BLOCKS) || defined(__DOXYGEN__)
+#define SDIO_MODEL_BLOCKS                   1024U
+#endif
+
+/**
+ * @brief   Number of @p ACMD41 commands answered with the busy bit clear.
+ */
+#if !defined(SDIO_MODEL_INIT_POLLS) || defined(__DOXYGEN__)
+#define SDIO_MODEL_INIT_POLLS               2U
+#endif
+
+/**
+ * @brief   Number of status requests answered with the programming state
+ *          after a write.
+ */
+#if !defined(SDIO_MODEL_PROGRAM_POLLS) || defined(__DOXYGEN__)
+#define SDIO_MODEL_PROGRAM_POLLS            1U
+#endif
+
+/**
+ * @brief   Number of data transfers whose clock divider is recorded.
+ */
+#if !defined(SDIO_MODEL_CLKDIV_LOG) || defined(__DOXYGEN__)
+#define SDIO_MODEL_CLKDIV_LOG               16U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (SDIO_MODEL_BLOCKS % 1024U) != 0U
+#error "invalid SDIO_MODEL_BLOCKS value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Registers block page.
+ */
+typedef union {
+  SDIO_TypeDef                  regs;
+  uint8_t                       page[SDIO_MODEL_PAGE_SIZE];
+} sdio_model_page_t;
+
+/**
+ * @brief   Card model.
+ */
+typedef struct {
+  /**
+   * @brief   High capacity card, addresses are block numbers.
+   */
+  bool                          hc;
+  /**
+   * @brief   Number of the next CRC checked responses received corrupted.
+   */
+  uint32_t                      cmd_crc_faults;
+  /**
+   * @brief   Number of the next data blocks sent with a wrong CRC.
+   */
+  uint32_t                      read_crc_faults;
+  /**
+   * @brief   Number of the next data blocks received corrupted.
+   */
+  uint32_t                      write_crc_faults;
+  /**
+   * @brief   Executed commands, by command index.
+   */
+  uint32_t                      commands[64];
+  /**
+   * @brief   Responses received corrupted.
+   */
+  uint32_t                      cmd_crc_errors;
+  /**
+   * @brief   Data blocks transferred corrupted.
+   */
+  uint32_t                      data_crc_errors;
+  /**
+   * @brief   Data blocks sent by the card.
+   */
+  uint32_t                      blocks_read;
+  /**
+   * @brief   Data blocks programmed.
+   */
+  uint32_t                      blocks_written;
+  /**
+   * @brief   Protocol violations by the host.
+   */
+  uint32_t                      protocol_errors;
+  /**
+   * @brief   Data transfers started.
+   */
+  uint32_t                      transfers;
+  /**
+   * @brief   Card clock divider of the first data transfers.
+   */
+  uint32_t                      clkdivs[SDIO_MODEL_CLKDIV_LOG];
+  /**
+   * @brief   Card memory.
+   */
+  uint8_t                       data[SDIO_MODEL_BLOCKS][SDIO_MODEL_BLOCK_SIZE];
+} sdio_model_card_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/* The SDIO registers block is the model.*/
+#undef SDIO
+#define SDIO                                (&sdio_model.regs)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+extern sdio_model_page_t sdio_model;
+extern sdio_model_card_t sdio_model_card;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void sdio_model_init(void);
+  void sdio_model_check_for_interrupts(void);
+  void sdio_model_insert(bool hc);
+  void sdio_model_remove(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SDIO_MODEL_H_ */
+
+/** @} */
@@ -0,0 +1,610 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    usb_lld.c
+ * @brief   Simulated USB subsystem low level driver source.
+ *
+ * @addtogroup USB
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if (HAL_USE_USB == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   USB1 driver identifier.
+ */
+#if (PLATFORM_USB_USE_USB1 == TRUE) || defined(__DOXYGEN__)
+USBDriver USBD1;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   EP0 state.
+ * @note    It is an union because IN and OUT endpoints are never used at the
+ *          same time for EP0.
+ */
+static union {
+  /**
+   * @brief   IN EP0 state.
+   */
+  USBInEndpointState in;
+  /**
+   * @brief   OUT EP0 state.
+   */
+  USBOutEndpointState out;
+} ep0_state;
+
+/**
+ * @brief   EP0 initialization structure.
+ */
+static const USBEndpointConfig ep0config = {
+  USB_EP_MODE_TYPE_CTRL,
+  _usb_ep0setup,
+  _usb_ep0in,
+  _usb_ep0out,
+  0x40,
+  0x40,
+  &ep0_state.in,
+  &ep0_state.out
+};
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Enters the emulated interrupt context.
+ */
+static void irq_enter(void) {
+
+  CH_IRQ_PROLOGUE();
+}
+
+/**
+ * @brief   Leaves the emulated interrupt context.
+ * @details A reschedule is performed like on the exit of a real interrupt.
+ */
+static void irq_exit(void) {
+
+  CH_IRQ_EPILOGUE();
+
+  _dbg_check_lock();
+  if (chSchIsPreemptionRequired())
+    chSchDoReschedule();
+  _dbg_check_unlock();
+}
+
+/**
+ * @brief   Waits for the device to start a transaction on an endpoint.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[in] in        @p true for an IN endpoint
+ * @return              The wait result.
+ * @retval MSG_OK       if a transaction is ready.
+ * @retval MSG_RESET    if the endpoint is halted.
+ * @retval MSG_TIMEOUT  if the device did not start a transaction.
+ */
+static msg_t host_wait(USBDriver *usbp, usbep_t ep, bool in) {
+  uint16_t mask = (uint16_t)(1U << ep);
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)USB_HOST_TIMEOUT; i++) {
+    msg_t msg = MSG_TIMEOUT;
+
+    osalSysLock();
+    if ((in ? usbp->halted_in : usbp->halted_out) & mask) {
+      msg = MSG_RESET;
+    }
+    else if ((in ? usbp->transmitting : usbp->receiving) & mask) {
+      msg = MSG_OK;
+    }
+    osalSysUnlock();
+    if (msg != MSG_TIMEOUT) {
+      return msg;
+    }
+    osalThreadSleepMilliseconds(1);
+  }
+
+  return MSG_TIMEOUT;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers and threads.                                    */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level USB driver initialization.
+ *
+ * @notapi
+ */
+void usb_lld_init(void) {
+
+#if PLATFORM_USB_USE_USB1 == TRUE
+  /* Driver initialization.*/
+  usbObjectInit(&USBD1);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the USB peripheral.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+void usb_lld_start(USBDriver *usbp) {
+
+  usbp->halted_in  = 0U;
+  usbp->halted_out = 0U;
+}
+
+/**
+ * @brief   Deactivates the USB peripheral.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+void usb_lld_stop(USBDriver *usbp) {
+
+  (void)usbp;
+}
+
+/**
+ * @brief   USB low level reset routine.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+void usb_lld_reset(USBDriver *usbp) {
+
+  usbp->halted_in  = 0U;
+  usbp->halted_out = 0U;
+
+  /* EP0 initialization.*/
+  usbp->epc[0] = &ep0config;
+  usb_lld_init_endpoint(usbp, 0);
+}
+
+/**
+ * @brief   Sets the USB address.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+void usb_lld_set_address(USBDriver *usbp) {
+
+  (void)usbp;
+}
+
+/**
+ * @brief   Enables an endpoint.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_init_endpoint(USBDriver *usbp, usbep_t ep) {
+
+  usbp->halted_in  &= (uint16_t)~(1U << ep);
+  usbp->halted_out &= (uint16_t)~(1U << ep);
+}
+
+/**
+ * @brief   Disables all the active endpoints except the endpoint zero.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ *
+ * @notapi
+ */
+void usb_lld_disable_endpoints(USBDriver *usbp) {
+
+  usbp->halted_in  &= 1U;
+  usbp->halted_out &= 1U;
+}
+
+/**
+ * @brief   Returns the status of an OUT endpoint.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @return              The endpoint status.
+ *
+ * @notapi
+ */
+usbepstatus_t usb_lld_get_status_out(USBDriver *usbp, usbep_t ep) {
+
+  if (usbp->epc[ep] == NULL) {
+    return EP_STATUS_DISABLED;
+  }
+  if ((usbp->halted_out & (1U << ep)) != 0U) {
+    return EP_STATUS_STALLED;
+  }
+  return EP_STATUS_ACTIVE;
+}
+
+/**
+ * @brief   Returns the status of an IN endpoint.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @return              The endpoint status.
+ *
+ * @notapi
+ */
+usbepstatus_t usb_lld_get_status_in(USBDriver *usbp, usbep_t ep) {
+
+  if (usbp->epc[ep] == NULL) {
+    return EP_STATUS_DISABLED;
+  }
+  if ((usbp->halted_in & (1U << ep)) != 0U) {
+    return EP_STATUS_STALLED;
+  }
+  return EP_STATUS_ACTIVE;
+}
+
+/**
+ * @brief   Reads a setup packet from the dedicated packet buffer.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[out] buf      buffer where to copy the packet data
+ *
+ * @notapi
+ */
+void usb_lld_read_setup(USBDriver *usbp, usbep_t ep, uint8_t *buf) {
+
+  (void)ep;
+
+  memcpy(buf, usbp->bus_setup, 8U);
+}
+
+/**
+ * @brief   Prepares for a receive operation.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_prepare_receive(USBDriver *usbp, usbep_t ep) {
+
+  (void)usbp;
+  (void)ep;
+}
+
+/**
+ * @brief   Prepares for a transmit operation.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_prepare_transmit(USBDriver *usbp, usbep_t ep) {
+
+  (void)usbp;
+  (void)ep;
+}
+
+/**
+ * @brief   Starts a receive operation on an OUT endpoint.
+ * @note    The transaction is completed by @p usb_lld_host_out().
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_start_out(USBDriver *usbp, usbep_t ep) {
+
+  (void)usbp;
+  (void)ep;
+}
+
+/**
+ * @brief   Starts a transmit operation on an IN endpoint.
+ * @note    The transaction is completed by @p usb_lld_host_in().
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_start_in(USBDriver *usbp, usbep_t ep) {
+
+  (void)usbp;
+  (void)ep;
+}
+
+/**
+ * @brief   Brings an OUT endpoint in the stalled state.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_stall_out(USBDriver *usbp, usbep_t ep) {
+
+  usbp->halted_out |= (uint16_t)(1U << ep);
+}
+
+/**
+ * @brief   Brings an IN endpoint in the stalled state.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_stall_in(USBDriver *usbp, usbep_t ep) {
+
+  usbp->halted_in |= (uint16_t)(1U << ep);
+}
+
+/**
+ * @brief   Brings an OUT endpoint in the active state.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_clear_out(USBDriver *usbp, usbep_t ep) {
+
+  usbp->halted_out &= (uint16_t)~(1U << ep);
+}
+
+/**
+ * @brief   Brings an IN endpoint in the active state.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ *
+ * @notapi
+ */
+void usb_lld_clear_in(USBDriver *usbp, usbep_t ep) {
+
+  usbp->halted_in &= (uint16_t)~(1U << ep);
+}
+
+/**
+ * @brief   Host side, resets the bus.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ */
+void usb_lld_host_reset(USBDriver *usbp) {
+
+  irq_enter();
+  _usb_reset(usbp);
+  irq_exit();
+}
+
+/**
+ * @brief   Host side, performs a control transfer on the endpoint zero.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] setup     the setup packet, the data phase length is taken
+ *                      from its @p wLength field
+ * @param[in,out] buf   the data phase buffer
+ * @return              The transfer result.
+ * @retval MSG_OK       if the request has been accepted.
+ * @retval MSG_RESET    if the request has been stalled by the device.
+ * @retval MSG_TIMEOUT  if the device did not answer.
+ */
+msg_t usb_lld_host_control(USBDriver *usbp, const uint8_t *setup,
+                           uint8_t *buf) {
+  size_t n = (size_t)setup[6] | ((size_t)setup[7] << 8);
+  size_t zlp = 0U;
+  msg_t msg = MSG_OK;
+
+  /* A setup packet always clears the halt condition of the endpoint
+     zero.*/
+  osalSysLock();
+  memcpy(usbp->bus_setup, setup, 8U);
+  usbp->halted_in  &= (uint16_t)~1U;
+  usbp->halted_out &= (uint16_t)~1U;
+  osalSysUnlock();
+
+  irq_enter();
+  _usb_isr_invoke_setup_cb(usbp, 0);
+  irq_exit();
+
+  if ((setup[0] & USB_RTYPE_DIR_MASK) == USB_RTYPE_DIR_DEV2HOST) {
+    if (n > 0U) {
+      msg = usb_lld_host_in(usbp, 0, buf, &n);
+
+      /* Zero sized packet terminating a short transfer, if any.*/
+      if ((msg == MSG_OK) && ((usbp->transmitting & 1U) != 0U)) {
+        msg = usb_lld_host_in(usbp, 0, NULL, &zlp);
+      }
+    }
+    if (msg == MSG_OK) {
+      msg = usb_lld_host_out(usbp, 0, NULL, 0U);
+    }
+  }
+  else {
+    if (n > 0U) {
+      msg = usb_lld_host_out(usbp, 0, buf, n);
+    }
+    if (msg == MSG_OK) {
+      msg = usb_lld_host_in(usbp, 0, NULL, &zlp);
+    }
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Host side, sends data to an OUT endpoint.
+ * @details The data completes the receive transaction started by the
+ *          device, data exceeding the transaction size is discarded.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[in] buf       data to be sent
+ * @param[in] n         number of bytes to be sent
+ * @return              The transfer result.
+ * @retval MSG_OK       if the data has been accepted.
+ * @retval MSG_RESET    if the endpoint is halted.
+ * @retval MSG_TIMEOUT  if the device did not start a transaction.
+ */
+msg_t usb_lld_host_out(USBDriver *usbp, usbep_t ep,
+                       const uint8_t *buf, size_t n) {
+  USBOutEndpointState *osp;
+  msg_t msg;
+
+  msg = host_wait(usbp, ep, false);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  osp = usbp->epc[ep]->out_state;
+  if (n > osp->rxsize) {
+    n = osp->rxsize;
+  }
+  if (n > 0U) {
+    memcpy(osp->rxbuf, buf, n);
+  }
+  osp->rxcnt = n;
+
+  irq_enter();
+  _usb_isr_invoke_out_cb(usbp, ep);
+  irq_exit();
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Host side, writes data to an OUT endpoint packet by packet.
+ * @details The data is split in packets of the endpoint maximum size, the
+ *          receive transaction started by the device is completed by a
+ *          short packet or when its whole size has been received. No zero
+ *          sized packet is sent after a last packet of maximum size, like
+ *          CDC hosts do, so the transaction can stay pending after return.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[in] buf       data to be sent
+ * @param[in] n         number of bytes to be sent
+ * @return              The transfer result.
+ * @retval MSG_OK       if the data has been accepted.
+ * @retval MSG_RESET    if the endpoint is halted.
+ * @retval MSG_TIMEOUT  if the device did not start a transaction.
+ */
+msg_t usb_lld_host_write(USBDriver *usbp, usbep_t ep,
+                         const uint8_t *buf, size_t n) {
+
+  while (n > 0U) {
+    USBOutEndpointState *osp;
+    size_t mps, k;
+    msg_t msg;
+
+    msg = host_wait(usbp, ep, false);
+    if (msg != MSG_OK) {
+      return msg;
+    }
+
+    osp = usbp->epc[ep]->out_state;
+    mps = (size_t)usbp->epc[ep]->out_maxsize;
+    k = n < mps ? n : mps;
+    if (k > osp->rxsize - osp->rxcnt) {
+      k = osp->rxsize - osp->rxcnt;
+    }
+    memcpy(&osp->rxbuf[osp->rxcnt], buf, k);
+    osp->rxcnt += k;
+    buf += k;
+    n -= k;
+
+    if ((k < mps) || (osp->rxcnt >= osp->rxsize)) {
+      irq_enter();
+      _usb_isr_invoke_out_cb(usbp, ep);
+      irq_exit();
+    }
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Host side, receives data from an IN endpoint.
+ * @details The transmit transaction started by the device is completed,
+ *          data exceeding the buffer size is discarded.
+ *
+ * @param[in] usbp      pointer to the @p USBDriver object
+ * @param[in] ep        endpoint number
+ * @param[out] buf      buffer for the received data
+ * @param[in,out] np    size of the buffer on entry, number of received
+ *                      bytes on exit
+ * @return              The transfer result.
+ * @retval MSG_OK       if data has been received.
+ * @retval MSG_RESET    if the endpoint is halted.
+ * @retval MSG_TIMEOUT  if the device did not start a transaction.
+ */
+msg_t usb_lld_host_in(USBDriver *usbp, usbep_t ep,
+                      uint8_t *buf, size_t *np) {
+  USBInEndpointState *isp;
+  msg_t msg;
+
+  msg = host_wait(usbp, ep, true);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  isp = usbp->epc[ep]->in_state;
+  if (*np > isp->txsize) {
+    *np = isp->txsize;
+  }
+  if (*np > 0U) {
+    memcpy(buf, isp->txbuf, *np);
+  }
+  isp->txcnt = *np;
+
+  irq_enter();
+  _usb_isr_invoke_in_cb(usbp, ep);
+  irq_exit();
+
+  return MSG_OK;
+}
+
+#endif /* HAL_USE_USB == TRUE */
+
+/** @} */
@@ -49,6 +49,9 @@
  * - @subpage test_benchmarks_011
  * - @subpage test_benchmarks_012
  * - @subpage test_benchmarks_013
+ * - @subpage test_benchmarks_014
+ * - @subpage test_benchmarks_015
+ * - @subpage test_benchmarks_016
  * .
  * @file testbmk.c Kernel Benchmarks
  * @brief Kernel Benchmarks source file
@@ -62,6 +65,9 @@ static semaphore_t sem1;
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
 static mutex_t mtx1;
 #endif
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+static condition_variable_t cnd1;
+#endif
 
 static THD_FUNCTION(thread1, p) {
 
@@ -628,6 +634,179 @@ ROMCONST struct testcase testbmk12 = {
   NULL,
   bmk12_execute
 };
+
+/**
+ * @page test_benchmarks_015 Mutexes contended lock, priority inheritance
+ *
+ * <h2>Description</h2>
+ * The tester thread locks a mutex and resumes an higher priority thread
+ * that tries to lock the same mutex, the mutex is then unlocked and handed
+ * over to the other thread into a continuous loop. The priority inheritance
+ * protocol is used.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static thread_reference_t tr15;
+
+static THD_FUNCTION(thread15, p) {
+
+  (void)p;
+  chSysLock();
+  while (!chThdShouldTerminateX()) {
+    (void) chThdSuspendS(&tr15);
+    chSysUnlock();
+    chMtxLock(&mtx1);
+    chMtxUnlock(&mtx1);
+    chSysLock();
+  }
+  chSysUnlock();
+}
+
+static void bmk15_setup(void) {
+
+  chMtxObjectInit(&mtx1);
+}
+
+static void bmk15_execute(void) {
+  uint32_t n = 0;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, thread15, NULL);
+
+  test_wait_tick();
+  test_start_timer(1000);
+  do {
+    chMtxLock(&mtx1);
+    chThdResume(&tr15, MSG_OK);
+    chMtxUnlock(&mtx1);
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (!test_timer_done);
+  test_terminate_threads();
+  chThdResume(&tr15, MSG_OK);
+  test_wait_threads();
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" lock+unlock/S");
+}
+
+ROMCONST struct testcase testbmk15 = {
+  "Benchmark, mutexes contended, inheritance",
+  bmk15_setup,
+  NULL,
+  bmk15_execute
+};
+
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_016 Mutexes contended lock, priority ceiling
+ *
+ * <h2>Description</h2>
+ * Same scenario of @ref test_benchmarks_015 but the mutex uses the priority
+ * ceiling protocol, the ceiling is the priority of the other thread so the
+ * tester thread is not preempted while owning the mutex.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations.
+ */
+
+static void bmk16_setup(void) {
+
+  chMtxObjectInitCeiling(&mtx1, chThdGetPriorityX()+1);
+}
+
+ROMCONST struct testcase testbmk16 = {
+  "Benchmark, mutexes contended, ceiling",
+  bmk16_setup,
+  NULL,
+  bmk15_execute
+};
+#endif
+#endif
+
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+/**
+ * @page test_benchmarks_014 Condition Variables broadcast performance
+ *
+ * <h2>Description</h2>
+ * Four threads, with priority higher than the tester thread, wait on a
+ * condition variable, the tester thread broadcasts the condition variable
+ * while holding the associated mutex into a continuous loop.<br>
+ * The performance is calculated by measuring the number of iterations after
+ * a second of continuous operations. If the kernel statistics are enabled
+ * then the average number of context switches per broadcast is also
+ * printed, the ideal value is the number of waiters plus one.
+ */
+
+static THD_FUNCTION(thread14, p) {
+
+  (void)p;
+  chMtxLock(&mtx1);
+  while (!chThdShouldTerminateX())
+    chCondWait(&cnd1);
+  chMtxUnlock(&mtx1);
+}
+
+static void bmk14_setup(void) {
+
+  chMtxObjectInit(&mtx1);
+  chCondObjectInit(&cnd1);
+}
+
+static void bmk14_execute(void) {
+  uint32_t n;
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+  ucnt_t ctxswc;
+#endif
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+4, thread14, NULL);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()+3, thread14, NULL);
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX()+2, thread14, NULL);
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, chThdGetPriorityX()+1, thread14, NULL);
+
+  n = 0;
+  test_wait_tick();
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+  ctxswc = ch.kernel_stats.n_ctxswc;
+#endif
+  test_start_timer(1000);
+  do {
+    chMtxLock(&mtx1);
+    chCondBroadcast(&cnd1);
+    chMtxUnlock(&mtx1);
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (!test_timer_done);
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+  ctxswc = ch.kernel_stats.n_ctxswc - ctxswc;
+#endif
+  test_terminate_threads();
+  chMtxLock(&mtx1);
+  chCondBroadcast(&cnd1);
+  chMtxUnlock(&mtx1);
+  test_wait_threads();
+
+  test_print("--- Score : ");
+  test_printn(n);
+  test_println(" broadcasts/S");
+#if CH_DBG_STATISTICS || defined(__DOXYGEN__)
+  test_print("--- Ctxsw.: ");
+  test_printn((uint32_t)ctxswc / n);
+  test_print(".");
+  test_printn((((uint32_t)ctxswc % n) * 10U) / n);
+  test_println(" ctxswc/broadcast, 4 waiters");
+#endif
+}
+
+ROMCONST struct testcase testbmk14 = {
+  "Benchmark, condvar broadcast, 4 waiters",
+  bmk14_setup,
+  NULL,
+  bmk14_execute
+};
 #endif
 
 /**
@@ -716,6 +895,13 @@ ROMCONST struct testcase * ROMCONST patternbmk[] = {
 #endif
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
   &testbmk12,
+  &testbmk15,
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  &testbmk16,
+#endif
+#endif
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+  &testbmk14,
 #endif
   &testbmk13,
 #endif
@@ -115,6 +115,18 @@
 #define CH_CFG_NO_IDLE_THREAD               FALSE
 #endif
 
+/**
+ * @brief   Integrity check step size.
+ * @details Maximum number of list nodes validated by each invocation of
+ *          @p chSysIntegrityCheckStep(), this is the length of the critical
+ *          zone used by the incremental integrity checker.
+ *
+ * @note    The default is @p 4.
+ */
+#if !defined(CH_CFG_INTEGRITY_STEP_NODES) || defined(__DOXIGEN__)
+#define CH_CFG_INTEGRITY_STEP_NODES         4
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -136,6 +148,23 @@
 #define CH_CFG_OPTIMIZE_SPEED               TRUE
 #endif
 
+/**
+ * @brief   Lock-free fast paths for semaphores and mutexes.
+ * @details If enabled then uncontended semaphore wait/signal and mutex
+ *          lock/unlock operations are performed using exclusive load/store
+ *          operations without entering the kernel critical zone, the
+ *          normal code path is used only on contention.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires a port supporting exclusive access, for example
+ *          ARMv7-M cores.
+ * @note    The mutexes fast path is not available when
+ *          @p CH_CFG_USE_MUTEXES_RECURSIVE is enabled.
+ */
+#if !defined(CH_CFG_USE_ATOMIC_FASTPATH) || defined(__DOXIGEN__)
+#define CH_CFG_USE_ATOMIC_FASTPATH          FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -166,6 +195,18 @@
 #define CH_CFG_USE_REGISTRY                 TRUE
 #endif
 
+/**
+ * @brief   Registry hash table size.
+ * @details If greater than zero then the registry keeps an hash table of
+ *          the thread names and @p chRegFindThreadByName() does not need
+ *          to scan the whole registry.
+ * @note    The value must be zero or a power of two.
+ * @note    The default is @p 0.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE) || defined(__DOXIGEN__)
+#define CH_CFG_REGISTRY_HASH_SIZE           0
+#endif
+
 /**
  * @brief   Threads synchronization APIs.
  * @details If enabled then the @p chThdWait() function is included in
@@ -222,6 +263,19 @@
 #define CH_CFG_USE_MUTEXES_RECURSIVE        FALSE
 #endif
 
+/**
+ * @brief   Enables priority ceiling mutexes.
+ * @details If enabled then mutexes can be initialized as immediate priority
+ *          ceiling mutexes using @p chMtxObjectInitCeiling(), the normal
+ *          mutexes keep using the priority inheritance protocol.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#if !defined(CH_CFG_USE_MUTEXES_CEILING) || defined(__DOXIGEN__)
+#define CH_CFG_USE_MUTEXES_CEILING          FALSE
+#endif
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -533,11 +587,25 @@
 /**
  * @brief   Idle Loop hook.
  * @details This hook is continuously invoked by the idle thread loop.
+ * @note    @p chSysIntegrityCheckStep() can be invoked from here in order
+ *          to continuously check the system integrity.
  */
 #define CH_CFG_IDLE_LOOP_HOOK() {                                           \
   /* Idle loop code here.*/                                                 \
 }
 
+/**
+ * @brief   Integrity check failure hook.
+ * @details This hook is invoked by @p chSysIntegrityCheckStep() when a
+ *          corruption is detected, the parameter is the mask of the failed
+ *          check.
+ * @note    This hook is invoked within a critical zone.
+ * @note    If this hook is not defined then the system is halted.
+ */
+#define CH_CFG_INTEGRITY_CHECK_HOOK(testmask) {                             \
+  (void)(testmask);                                                         \
+}
+
 /**
  * @brief   System tick event hook.
  * @details This hook is invoked in the system tick handler immediately
@@ -117,6 +117,12 @@ test cfg26 "-DCH_DBG_ENABLE_TRACE=TRUE"
 test cfg28 "-DCH_DBG_FILL_THREADS=TRUE"
 test cfg29 "-DCH_DBG_THREADS_PROFILING=FALSE"
 test cfg30 "-DCH_DBG_SYSTEM_STATE_CHECK=TRUE -DCH_DBG_ENABLE_CHECKS=TRUE -DCH_DBG_ENABLE_ASSERTS=TRUE -DCH_DBG_ENABLE_TRACE=TRUE -DCH_DBG_FILL_THREADS=TRUE"
+test cfg31 "-DCH_CFG_USE_ATOMIC_FASTPATH=TRUE"
+test cfg32 "-DCH_CFG_USE_ATOMIC_FASTPATH=TRUE -DCH_DBG_ENABLE_ASSERTS=TRUE"
+test cfg33 "-DCH_CFG_REGISTRY_HASH_SIZE=8"
+test cfg34 "-DCH_CFG_REGISTRY_HASH_SIZE=8 -DCH_DBG_ENABLE_ASSERTS=TRUE -DCH_CFG_USE_DYNAMIC=FALSE"
+test cfg35 "-DCH_CFG_USE_MUTEXES_CEILING=TRUE"
+test cfg36 "-DCH_CFG_USE_MUTEXES_CEILING=TRUE -DCH_CFG_USE_MUTEXES_RECURSIVE=TRUE -DCH_DBG_ENABLE_ASSERTS=TRUE"
 
 rm *log.txt 2> /dev/null
 echo
@@ -137,6 +137,14 @@ static void heap1_execute(void) {
 
   test_assert(11, chHeapStatus(&test_heap, &n) == 1, "heap fragmented");
   test_assert(12, n == sz, "size changed");
+
+  /* Integrity check on a fragmented heap.*/
+  p1 = chHeapAlloc(&test_heap, SIZE);
+  p2 = chHeapAlloc(&test_heap, SIZE);
+  chHeapFree(p1);
+  test_assert(13, chHeapIntegrityCheck(&test_heap) == false,
+              "integrity check failed");
+  chHeapFree(p2);
 }
 
 ROMCONST struct testcase testheap1 = {
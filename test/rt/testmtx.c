@@ -49,6 +49,9 @@
  * - @subpage test_mtx_006
  * - @subpage test_mtx_007
  * - @subpage test_mtx_008
+ * - @subpage test_mtx_009
+ * - @subpage test_mtx_010
+ * - @subpage test_mtx_011
  * .
  * @file testmtx.c
  * @brief Mutexes and CondVars test source file
@@ -599,6 +602,167 @@ ROMCONST struct testcase testmtx8 = {
   mtx8_execute
 };
 #endif /* CH_CFG_USE_CONDVARS */
+
+/**
+ * @page test_mtx_009 Contention stress test
+ *
+ * <h2>Description</h2>
+ * Four threads, two at a lower and two at an higher priority, lock a mutex
+ * in order to update a shared counter, each thread yields while owning the
+ * mutex in order to force contention and priority inheritance.<br>
+ * The test expects the counter to be consistent, the mutex to be free and
+ * the threads priorities to be restored, this exercises the interactions
+ * between the uncontended and contended code paths.
+ */
+
+#define MTX_STRESS_LOOPS    1000
+
+static uint32_t mtx9_counter;
+
+static void mtx9_setup(void) {
+
+  chMtxObjectInit(&m1);
+  mtx9_counter = 0;
+}
+
+static THD_FUNCTION(thread13, p) {
+  unsigned i;
+
+  (void)p;
+  for (i = 0; i < MTX_STRESS_LOOPS; i++) {
+    uint32_t n;
+
+    chMtxLock(&m1);
+    n = mtx9_counter;
+    if ((i & 1U) == 0U)
+      chThdYield();
+    mtx9_counter = n + 1U;
+    chMtxUnlock(&m1);
+    if (chThdGetSelfX()->p_prio != chThdGetSelfX()->p_realprio)
+      test_emit_token('X');
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static void mtx9_execute(void) {
+
+  tprio_t prio = chThdGetPriorityX();
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio-2, thread13, NULL);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio-2, thread13, NULL);
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio-1, thread13, NULL);
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio-1, thread13, NULL);
+  test_wait_threads();
+  test_assert(1, mtx9_counter == MTX_STRESS_LOOPS * 4U, "counter mismatch");
+  test_assert(2, queue_isempty(&m1.m_queue), "queue not empty");
+  test_assert(3, m1.m_owner == NULL, "still owned");
+  test_assert_sequence(4, "");
+}
+
+ROMCONST struct testcase testmtx9 = {
+  "Mutexes, contention stress",
+  mtx9_setup,
+  NULL,
+  mtx9_execute
+};
+
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+/**
+ * @page test_mtx_010 Priority ceiling
+ *
+ * <h2>Description</h2>
+ * The tester thread locks a priority ceiling mutex while two higher priority
+ * threads, below the ceiling, are started and try to lock the same mutex.
+ * The sequence is repeated nesting the priority ceiling mutex into a
+ * priority inheritance mutex.<br>
+ * The test expects the owner priority to be raised to the ceiling on lock
+ * and restored on unlock, the other threads must not be able to preempt the
+ * owner and must perform their operations in decreasing priority order.
+ */
+
+static void mtx10_setup(void) {
+
+  chMtxObjectInitCeiling(&m1, chThdGetPriorityX()+3);
+  chMtxObjectInit(&m2);
+}
+
+static THD_FUNCTION(thread14, p) {
+
+  chMtxLock(&m1);
+  if (chThdGetPriorityX() != m1.m_ceiling)
+    test_emit_token('X');
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&m1);
+}
+
+static void mtx10_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* Single mutex.*/
+  chMtxLock(&m1);
+  test_assert(1, chThdGetPriorityX() == prio+3, "not at ceiling");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread14, "B");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, thread14, "A");
+  test_assert_sequence(2, "");
+  chMtxUnlock(&m1);
+  test_assert(3, chThdGetPriorityX() == prio, "wrong priority level");
+  test_wait_threads();
+  test_assert_sequence(4, "AB");
+
+  /* Nested into a priority inheritance mutex.*/
+  chMtxLock(&m2);
+  chMtxLock(&m1);
+  test_assert(5, chThdGetPriorityX() == prio+3, "not at ceiling");
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread14, "D");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, thread14, "C");
+  chSysLock();
+  chMtxUnlockS(&m1);
+  chSchRescheduleS();
+  chSysUnlock();
+  test_assert(6, chThdGetPriorityX() == prio, "wrong priority level");
+  chMtxUnlock(&m2);
+  test_wait_threads();
+  test_assert_sequence(7, "CD");
+
+  /* Try-lock and unlock all.*/
+  test_assert(8, chMtxTryLock(&m1), "already locked");
+  test_assert(9, chThdGetPriorityX() == prio+3, "not at ceiling");
+  chMtxUnlockAll();
+  test_assert(10, chThdGetPriorityX() == prio, "wrong priority level");
+  test_assert(11, m1.m_owner == NULL, "still owned");
+}
+
+ROMCONST struct testcase testmtx10 = {
+  "Mutexes, priority ceiling",
+  mtx10_setup,
+  NULL,
+  mtx10_execute
+};
+
+/**
+ * @page test_mtx_011 Priority ceiling contention stress test
+ *
+ * <h2>Description</h2>
+ * Same scenario of @ref test_mtx_009 using a priority ceiling mutex, the
+ * ceiling is the priority of the higher priority threads.<br>
+ * The test expects the counter to be consistent, the mutex to be free and
+ * the threads priorities to be restored.
+ */
+
+static void mtx11_setup(void) {
+
+  chMtxObjectInitCeiling(&m1, chThdGetPriorityX()-1);
+  mtx9_counter = 0;
+}
+
+ROMCONST struct testcase testmtx11 = {
+  "Mutexes, priority ceiling contention stress",
+  mtx11_setup,
+  NULL,
+  mtx9_execute
+};
+#endif /* CH_CFG_USE_MUTEXES_CEILING */
 #endif /* CH_CFG_USE_MUTEXES */
 
 /**
@@ -617,6 +781,11 @@ ROMCONST struct testcase * ROMCONST patternmtx[] = {
   &testmtx6,
   &testmtx7,
   &testmtx8,
+#endif
+  &testmtx9,
+#if CH_CFG_USE_MUTEXES_CEILING || defined(__DOXYGEN__)
+  &testmtx10,
+  &testmtx11,
 #endif
 #endif
   NULL
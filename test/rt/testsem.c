@@ -40,6 +40,7 @@
  * - @subpage test_sem_002
  * - @subpage test_sem_003
  * - @subpage test_sem_004
+ * - @subpage test_sem_005
  * .
  * @file testsem.c
  * @brief Semaphores test source file
@@ -279,6 +280,67 @@ ROMCONST struct testcase testsem4 = {
   NULL,
   sem4_execute
 };
+
+/**
+ * @page test_sem_005 Contention stress test
+ *
+ * <h2>Description</h2>
+ * Four threads with equal priority use a semaphore as a mutual exclusion
+ * guard for a shared counter, each thread yields while inside the guarded
+ * zone in order to force contention.<br>
+ * The test expects the counter to be consistent and the semaphore to be
+ * back to its initial state, this exercises the interactions between the
+ * uncontended and contended code paths.
+ */
+
+#define SEM_STRESS_LOOPS    1000
+
+static uint32_t sem5_counter;
+
+static void sem5_setup(void) {
+
+  chSemObjectInit(&sem1, 1);
+  sem5_counter = 0;
+}
+
+static THD_FUNCTION(thread5, p) {
+  unsigned i;
+
+  (void)p;
+  for (i = 0; i < SEM_STRESS_LOOPS; i++) {
+    uint32_t n;
+
+    chSemWait(&sem1);
+    n = sem5_counter;
+    if ((i & 1U) == 0U)
+      chThdYield();
+    sem5_counter = n + 1U;
+    chSemSignal(&sem1);
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static void sem5_execute(void) {
+
+  tprio_t prio = chThdGetPriorityX();
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio-1, thread5, NULL);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio-1, thread5, NULL);
+  threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio-1, thread5, NULL);
+  threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio-1, thread5, NULL);
+  test_wait_threads();
+  test_assert(1, sem5_counter == SEM_STRESS_LOOPS * 4U, "counter mismatch");
+  test_assert_lock(2, chSemGetCounterI(&sem1) == 1, "unexpected counter");
+  test_assert(3, queue_isempty(&sem1.s_queue), "queue not empty");
+}
+
+ROMCONST struct testcase testsem5 = {
+  "Semaphores, contention stress",
+  sem5_setup,
+  NULL,
+  sem5_execute
+};
 #endif /* CH_CFG_USE_SEMAPHORES */
 
 /**
@@ -290,6 +352,7 @@ ROMCONST struct testcase * ROMCONST patternsem[] = {
   &testsem2,
   &testsem3,
   &testsem4,
+  &testsem5,
 #endif
   NULL
 };
@@ -36,6 +36,8 @@
  * - @subpage test_sys_001
  * - @subpage test_sys_002
  * - @subpage test_sys_003
+ * - @subpage test_sys_004
+ * - @subpage test_sys_005
  * .
  * @file testsys.c
  * @brief System test source file
@@ -166,6 +168,130 @@ ROMCONST struct testcase testsys3 = {
   sys3_execute
 };
 
+/**
+ * @page test_sys_004 Incremental system integrity check
+ *
+ * <h2>Description</h2>
+ * The chSysIntegrityCheckStep() API is invoked repeatedly while threads and
+ * virtual timers are active, several full check cycles are performed.
+ */
+
+static void sys4_vtcb(void *p) {
+
+  (void)p;
+}
+
+static THD_FUNCTION(thread4, p) {
+
+  (void)p;
+  while (!chThdShouldTerminateX()) {
+    chThdSleepMilliseconds(1);
+  }
+}
+
+static void sys4_execute(void) {
+  virtual_timer_t vt1, vt2;
+  bool result = false;
+  unsigned i;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, thread4, NULL);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()+1, thread4, NULL);
+  chVTObjectInit(&vt1);
+  chVTObjectInit(&vt2);
+  chVTSet(&vt1, MS2ST(1000), sys4_vtcb, NULL);
+  chVTSet(&vt2, MS2ST(2000), sys4_vtcb, NULL);
+
+  for (i = 0U; i < 1000U; i++) {
+    result |= chSysIntegrityCheckStep();
+  }
+
+  chVTReset(&vt1);
+  chVTReset(&vt2);
+  chThdTerminate(threads[0]);
+  chThdTerminate(threads[1]);
+  test_wait_threads();
+  test_assert(1, result == false, "integrity check failed");
+}
+
+ROMCONST struct testcase testsys4 = {
+  "System, incremental integrity",
+  NULL,
+  NULL,
+  sys4_execute
+};
+
+#if defined(CH_CFG_INTEGRITY_CHECK_HOOK) || defined(__DOXYGEN__)
+/**
+ * @page test_sys_005 Integrity check corruption detection
+ *
+ * <h2>Description</h2>
+ * The ready list and the registry are deliberately corrupted, the
+ * chSysIntegrityCheckStep() API is invoked until a failure is reported
+ * then the lists are restored. The test is performed only if the
+ * @p CH_CFG_INTEGRITY_CHECK_HOOK() hook is defined, the system would be
+ * halted otherwise.
+ */
+
+static bool sys5_detect(void) {
+  unsigned i;
+
+  for (i = 0U; i < 100U; i++) {
+    if (chSysIntegrityCheckStep()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void sys5_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+  bool rlist_result, reg_result = true;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio-2, thread4, NULL);
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio-3, thread4, NULL);
+
+  /* Ready list priority order violation, the priority is kept lower than
+     the current one so the corrupted thread cannot preempt.*/
+  chSysLock();
+  threads[1]->p_prio = prio-1;
+  chSysUnlock();
+  rlist_result = sys5_detect();
+  chSysLock();
+  threads[1]->p_prio = prio-3;
+  chSysUnlock();
+
+#if CH_CFG_USE_REGISTRY == TRUE
+  {
+    thread_t *tp;
+
+    /* Registry broken backward link.*/
+    chSysLock();
+    tp = threads[0]->p_older;
+    threads[0]->p_older = threads[0];
+    chSysUnlock();
+    reg_result = sys5_detect();
+    chSysLock();
+    threads[0]->p_older = tp;
+    chSysUnlock();
+  }
+#endif
+
+  chThdTerminate(threads[0]);
+  chThdTerminate(threads[1]);
+  test_wait_threads();
+  test_assert(1, rlist_result, "ready list corruption not detected");
+  test_assert(2, reg_result, "registry corruption not detected");
+  test_assert(3, sys5_detect() == false, "false positive after restore");
+}
+
+ROMCONST struct testcase testsys5 = {
+  "System, integrity corruption detection",
+  NULL,
+  NULL,
+  sys5_execute
+};
+#endif /* defined(CH_CFG_INTEGRITY_CHECK_HOOK) */
+
 /**
  * @brief   Test sequence for messages.
  */
@@ -173,5 +299,9 @@ ROMCONST struct testcase * ROMCONST patternsys[] = {
   &testsys1,
   &testsys2,
   &testsys3,
+  &testsys4,
+#if defined(CH_CFG_INTEGRITY_CHECK_HOOK)
+  &testsys5,
+#endif
   NULL
 };
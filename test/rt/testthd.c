@@ -40,6 +40,7 @@
  * - @subpage test_threads_002
  * - @subpage test_threads_003
  * - @subpage test_threads_004
+ * - @subpage test_threads_005
  * .
  * @file testthd.c
  * @brief Threads and Scheduler test source file
@@ -226,6 +227,97 @@ ROMCONST struct testcase testthd4 = {
   thd4_execute
 };
 
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page test_threads_005 Registry lookup
+ *
+ * <h2>Description</h2>
+ * Two threads name themselves and are then searched in the registry by
+ * name and by working area, a snapshot of the registry is also taken.<br>
+ * The test expects the lookups to return the correct threads, a renamed
+ * thread to be found only under its new name and the snapshot to contain
+ * both threads.
+ */
+
+static THD_FUNCTION(thread5, p) {
+
+  chRegSetThreadName((const char *)p);
+  while (!chThdShouldTerminateX()) {
+    chThdSleepMilliseconds(10);
+  }
+}
+
+static void thd5_release(thread_t *tp) {
+
+#if CH_CFG_USE_DYNAMIC == TRUE
+  if (tp != NULL) {
+    chThdRelease(tp);
+  }
+#else
+  (void)tp;
+#endif
+}
+
+static void thd5_execute(void) {
+  thread_info_t ti[MAX_THREADS + 4];
+  thread_t *tp;
+  size_t i, n;
+  unsigned found;
+
+  threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1, thread5, "A");
+  threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX()+1, thread5, "B");
+
+  /* Lookup by name.*/
+  tp = chRegFindThreadByName("A");
+  test_assert(1, tp == threads[0], "wrong thread");
+  thd5_release(tp);
+  tp = chRegFindThreadByName("B");
+  test_assert(2, tp == threads[1], "wrong thread");
+  thd5_release(tp);
+  tp = chRegFindThreadByName("Z");
+  test_assert(3, tp == NULL, "unexpected thread");
+
+  /* Lookup by working area.*/
+  tp = chRegFindThreadByWorkingArea(wa[1]);
+  test_assert(4, tp == threads[1], "wrong thread");
+  thd5_release(tp);
+  tp = chRegFindThreadByWorkingArea(wa[2]);
+  test_assert(5, tp == NULL, "unexpected thread");
+
+  /* Renaming, the old name must no more be found.*/
+  chRegSetThreadNameX(threads[0], "C");
+  tp = chRegFindThreadByName("A");
+  test_assert(6, tp == NULL, "old name found");
+  tp = chRegFindThreadByName("C");
+  test_assert(7, tp == threads[0], "wrong thread");
+  thd5_release(tp);
+
+  /* Snapshot.*/
+  n = chRegSnapshot(ti, sizeof ti / sizeof ti[0]);
+  found = 0U;
+  for (i = 0U; i < n; i++) {
+    if (ti[i].ti_tp == threads[0]) {
+      found |= 1U;
+    }
+    if (ti[i].ti_tp == threads[1]) {
+      found |= 2U;
+    }
+  }
+  test_assert(8, found == 3U, "threads missing from snapshot");
+
+  chThdTerminate(threads[0]);
+  chThdTerminate(threads[1]);
+  test_wait_threads();
+}
+
+ROMCONST struct testcase testthd5 = {
+  "Threads, registry lookup",
+  NULL,
+  NULL,
+  thd5_execute
+};
+#endif /* CH_CFG_USE_REGISTRY == TRUE */
+
 /**
  * @brief   Test sequence for threads.
  */
@@ -234,5 +326,8 @@ ROMCONST struct testcase * ROMCONST patternthd[] = {
   &testthd2,
   &testthd3,
   &testthd4,
+#if CH_CFG_USE_REGISTRY == TRUE
+  &testthd5,
+#endif
   NULL
 };
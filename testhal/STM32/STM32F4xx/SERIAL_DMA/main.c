@@ -0,0 +1,192 @@
+/*
+    ChibiOS - Copyright (C) 2006..2015 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+
+/*
+ * Loopback speed and amount of data transferred by each test.
+ */
+#define LOOPBACK_SPEED          460800
+#define TRANSFER_SIZE           65536U
+
+/*
+ * Duration of the critical zone used to stall the receiver, about three
+ * RX DMA buffers at the loopback speed.
+ */
+#define STALL_US                (3000000U / (LOOPBACK_SPEED / 10U) *        \
+                                 STM32_SERIAL_DMA_RX_BUFFER_SIZE)
+
+static const SerialConfig loopback_cfg = {
+  LOOPBACK_SPEED,
+  0,
+  USART_CR2_STOP1_BITS,
+  0
+};
+
+static BaseSequentialStream *console = (BaseSequentialStream *)&SD6;
+
+/*
+ * Writer thread, it sends a known pattern on the loopback under test.
+ */
+static SerialDriver *writer_sdp;
+static size_t writer_n;
+
+static THD_WORKING_AREA(waWriter, 256);
+static THD_FUNCTION(Writer, arg) {
+  static uint8_t pattern[256];
+  size_t i, n;
+
+  (void)arg;
+  chRegSetThreadName("writer");
+  for (i = 0; i < sizeof(pattern); i++)
+    pattern[i] = (uint8_t)i;
+  for (n = 0; n < writer_n; n += sizeof(pattern))
+    sdWrite(writer_sdp, pattern, sizeof(pattern));
+}
+
+/*
+ * Spinner thread, it runs at the lowest priority and its counter measures
+ * the CPU time left by the driver under test.
+ */
+static volatile uint32_t spins;
+
+static THD_WORKING_AREA(waSpinner, 128);
+static THD_FUNCTION(Spinner, arg) {
+
+  (void)arg;
+  chRegSetThreadName("spinner");
+  while (true)
+    spins++;
+}
+
+/*
+ * Transfers TRANSFER_SIZE bytes through a loopback, optionally stalling the
+ * receiver once, and prints throughput, spare CPU, pattern discontinuities
+ * and whether an overrun has been reported.
+ */
+static void test_loopback(SerialDriver *sdp, const char *name, bool stall) {
+  static uint8_t buf[256];
+  event_listener_t el;
+  thread_t *tp;
+  systime_t start, elapsed;
+  uint32_t received = 0, errors = 0, spins0, ms;
+  bool stalled = false;
+  uint8_t expected = 0;
+  eventflags_t flags;
+
+  sdStart(sdp, &loopback_cfg);
+  chEvtRegisterMaskWithFlags(chnGetEventSource(sdp), &el, EVENT_MASK(0),
+                             SD_OVERRUN_ERROR | SD_FRAMING_ERROR |
+                             SD_NOISE_ERROR | SD_PARITY_ERROR);
+  (void)chEvtGetAndClearFlags(&el);
+
+  writer_sdp = sdp;
+  writer_n = TRANSFER_SIZE;
+  spins0 = spins;
+  start = chVTGetSystemTime();
+  tp = chThdCreateStatic(waWriter, sizeof(waWriter), NORMALPRIO + 1,
+                         Writer, NULL);
+  while (received < TRANSFER_SIZE) {
+    size_t i, n;
+
+    if (stall && (received >= TRANSFER_SIZE / 2U)) {
+      /* Blocking all the interrupts while data is flowing.*/
+      stall = false;
+      stalled = true;
+      chSysLock();
+      chSysPolledDelayX(US2RTC(STM32_HCLK, STALL_US));
+      chSysUnlock();
+    }
+    n = sdReadTimeout(sdp, buf, sizeof(buf), MS2ST(100));
+    if (n == 0U)
+      break;
+    for (i = 0; i < n; i++) {
+      if (buf[i] != expected) {
+        errors++;
+        expected = buf[i];
+      }
+      expected++;
+    }
+    received += n;
+  }
+  elapsed = chVTTimeElapsedSinceX(start);
+  spins0 = spins - spins0;
+  ms = (uint32_t)ST2MS(elapsed);
+  if (ms == 0U)
+    ms = 1U;
+  chThdWait(tp);
+  flags = chEvtGetAndClearFlags(&el);
+  chEvtUnregister(chnGetEventSource(sdp), &el);
+  sdStop(sdp);
+
+  chprintf(console, "%s%s: %U bytes in %U ms, %U bytes/S, %U spins/mS, "
+                    "%U discontinuities%s\r\n",
+           name, stalled ? " stalled" : "",
+           received, ms, (received * 1000U) / ms, spins0 / ms, errors,
+           (flags & SD_OVERRUN_ERROR) != 0 ? ", overrun reported" : "");
+}
+
+/*
+ * Application entry point.
+ */
+int main(void) {
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /*
+   * Console on SD6, PC6(TX).
+   */
+  sdStart(&SD6, NULL);
+  palSetPadMode(GPIOC, 6, PAL_MODE_ALTERNATE(8));
+
+  /*
+   * Loopbacks, SD2 in DMA mode on PA2(TX) and PA3(RX), SD3 in interrupt
+   * mode on PD8(TX) and PD9(RX).
+   */
+  palSetPadMode(GPIOA, 2, PAL_MODE_ALTERNATE(7));
+  palSetPadMode(GPIOA, 3, PAL_MODE_ALTERNATE(7));
+  palSetPadMode(GPIOD, 8, PAL_MODE_ALTERNATE(7));
+  palSetPadMode(GPIOD, 9, PAL_MODE_ALTERNATE(7));
+
+  chThdCreateStatic(waSpinner, sizeof(waSpinner), LOWPRIO, Spinner, NULL);
+
+  /*
+   * Normal main() thread activity, the tests are repeated each time the
+   * button is pressed.
+   */
+  while (true) {
+    palSetPad(GPIOD, GPIOD_LED4);
+    chprintf(console, "\r\n*** Serial loopback, %U baud\r\n", LOOPBACK_SPEED);
+    test_loopback(&SD2, "SD2 DMA", false);
+    test_loopback(&SD3, "SD3 IRQ", false);
+    test_loopback(&SD2, "SD2 DMA", true);
+    test_loopback(&SD3, "SD3 IRQ", true);
+    palClearPad(GPIOD, GPIOD_LED4);
+    while (!palReadPad(GPIOA, GPIOA_BUTTON))
+      chThdSleepMilliseconds(100);
+  }
+}